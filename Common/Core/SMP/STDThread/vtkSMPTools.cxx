@@ -0,0 +1,424 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSMPTools.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Implementation based on a persistent pool of std::thread workers. Each
+// participating thread owns a double-ended task queue. A For() call starts as
+// a single task covering the whole range; whichever thread executes a task
+// splits it in halves, keeping one half and pushing the other on the back of
+// its own queue, until the range is no larger than the grain. Owners pop from
+// the back of their queue (depth first, cache friendly) while idle threads
+// steal from the front of the other queues, where the largest ranges are.
+// A thread that waits for a For() to complete keeps executing tasks in the
+// meantime, so nested For() calls cannot deadlock the pool.
+
+namespace
+{
+
+struct vtkSMPJob
+{
+  vtk::detail::smp::ExecuteFunctorPtrType Executer;
+  void *Functor;
+  vtkIdType Grain;
+  std::atomic<vtkIdType> Remaining; // number of items not processed yet
+};
+
+struct vtkSMPTask
+{
+  vtkSMPJob *Job;
+  vtkIdType First;
+  vtkIdType Last;
+};
+
+class vtkSMPTaskQueue
+{
+public:
+  void Push(const vtkSMPTask &task)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Tasks.push_back(task);
+  }
+
+  // Used by the owning thread.
+  bool Pop(vtkSMPTask &task)
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    if (this->Tasks.empty())
+    {
+      return false;
+    }
+    task = this->Tasks.back();
+    this->Tasks.pop_back();
+    return true;
+  }
+
+  // Used by the other threads.
+  bool Steal(vtkSMPTask &task)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex, std::try_to_lock);
+    if (!lock.owns_lock() || this->Tasks.empty())
+    {
+      return false;
+    }
+    task = this->Tasks.front();
+    this->Tasks.pop_front();
+    return true;
+  }
+
+private:
+  std::mutex Mutex;
+  std::deque<vtkSMPTask> Tasks;
+};
+
+// Queue of the calling thread, set for the pool workers and for external
+// threads while they are inside a For() call.
+thread_local vtkSMPTaskQueue *vtkSMPCurrentQueue = NULL;
+
+class vtkSMPThreadPool;
+
+// Pool the calling thread is executing tasks of, set along with
+// vtkSMPCurrentQueue.
+thread_local vtkSMPThreadPool *vtkSMPCurrentPool = NULL;
+
+class vtkSMPThreadPool
+{
+public:
+  explicit vtkSMPThreadPool(int numThreads);
+  ~vtkSMPThreadPool();
+
+  int GetNumberOfThreads() const
+  {
+    return static_cast<int>(this->Workers.size()) + 1;
+  }
+
+  void Run(vtkIdType first, vtkIdType last, vtkIdType grain,
+           vtk::detail::smp::ExecuteFunctorPtrType executer, void *functor);
+
+private:
+  void WorkerLoop(vtkSMPTaskQueue *queue);
+  void Push(vtkSMPTaskQueue *queue, const vtkSMPTask &task);
+  bool Acquire(vtkSMPTaskQueue *queue, vtkSMPTask &task);
+  void Execute(vtkSMPTaskQueue *queue, vtkSMPTask task);
+  void AddQueue(vtkSMPTaskQueue *queue);
+  void RemoveQueue(vtkSMPTaskQueue *queue);
+
+  std::vector<std::thread> Workers;
+  std::vector<vtkSMPTaskQueue*> WorkerQueues;
+
+  // All the queues tasks can be stolen from, including the ones of external
+  // threads currently executing a For().
+  std::vector<vtkSMPTaskQueue*> Queues;
+  std::mutex QueuesMutex;
+
+  // Idle workers sleep on WakeCondition until new tasks are queued.
+  std::atomic<vtkIdType> NumberOfQueuedTasks;
+  std::atomic<int> NumberOfSleepingWorkers;
+  std::mutex WakeMutex;
+  std::condition_variable WakeCondition;
+  bool Done;
+
+  vtkSMPThreadPool(const vtkSMPThreadPool&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkSMPThreadPool&) VTK_DELETE_FUNCTION;
+};
+
+//--------------------------------------------------------------------------------
+vtkSMPThreadPool::vtkSMPThreadPool(int numThreads)
+  : NumberOfQueuedTasks(0), NumberOfSleepingWorkers(0), Done(false)
+{
+  // The thread calling For() is a participant as well.
+  int numWorkers = std::max(numThreads, 1) - 1;
+  for (int i = 0; i < numWorkers; ++i)
+  {
+    this->WorkerQueues.push_back(new vtkSMPTaskQueue);
+    this->Queues.push_back(this->WorkerQueues.back());
+  }
+  for (int i = 0; i < numWorkers; ++i)
+  {
+    this->Workers.push_back(
+      std::thread(&vtkSMPThreadPool::WorkerLoop, this, this->WorkerQueues[i]));
+  }
+}
+
+//--------------------------------------------------------------------------------
+vtkSMPThreadPool::~vtkSMPThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->WakeMutex);
+    this->Done = true;
+  }
+  this->WakeCondition.notify_all();
+  for (size_t i = 0; i < this->Workers.size(); ++i)
+  {
+    this->Workers[i].join();
+  }
+  for (size_t i = 0; i < this->WorkerQueues.size(); ++i)
+  {
+    delete this->WorkerQueues[i];
+  }
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::AddQueue(vtkSMPTaskQueue *queue)
+{
+  std::lock_guard<std::mutex> lock(this->QueuesMutex);
+  this->Queues.push_back(queue);
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::RemoveQueue(vtkSMPTaskQueue *queue)
+{
+  std::lock_guard<std::mutex> lock(this->QueuesMutex);
+  this->Queues.erase(
+    std::find(this->Queues.begin(), this->Queues.end(), queue));
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::Push(vtkSMPTaskQueue *queue, const vtkSMPTask &task)
+{
+  queue->Push(task);
+  ++this->NumberOfQueuedTasks;
+  if (this->NumberOfSleepingWorkers > 0)
+  {
+    // Taking the lock guarantees that a worker about to sleep either sees the
+    // new task or receives the notification.
+    std::lock_guard<std::mutex> lock(this->WakeMutex);
+    this->WakeCondition.notify_one();
+  }
+}
+
+//--------------------------------------------------------------------------------
+bool vtkSMPThreadPool::Acquire(vtkSMPTaskQueue *queue, vtkSMPTask &task)
+{
+  if (queue->Pop(task))
+  {
+    --this->NumberOfQueuedTasks;
+    return true;
+  }
+  if (this->NumberOfQueuedTasks <= 0)
+  {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->QueuesMutex);
+  size_t numQueues = this->Queues.size();
+  // Start at the position of the thief so that thieves spread over victims.
+  size_t start = std::find(this->Queues.begin(), this->Queues.end(), queue) -
+    this->Queues.begin();
+  for (size_t i = 1; i <= numQueues; ++i)
+  {
+    vtkSMPTaskQueue *victim = this->Queues[(start + i) % numQueues];
+    if (victim != queue && victim->Steal(task))
+    {
+      --this->NumberOfQueuedTasks;
+      return true;
+    }
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::Execute(vtkSMPTaskQueue *queue, vtkSMPTask task)
+{
+  vtkSMPJob *job = task.Job;
+  while (task.Last - task.First > job->Grain)
+  {
+    vtkIdType middle = task.First + (task.Last - task.First) / 2;
+    vtkSMPTask other = { job, middle, task.Last };
+    this->Push(queue, other);
+    task.Last = middle;
+  }
+  job->Executer(job->Functor, task.First, task.Last);
+  // This must be the last access to the job: the thread waiting for it may
+  // return as soon as Remaining reaches zero.
+  job->Remaining -= task.Last - task.First;
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::WorkerLoop(vtkSMPTaskQueue *queue)
+{
+  vtkSMPCurrentQueue = queue;
+  vtkSMPCurrentPool = this;
+  vtkSMPTask task;
+  for (;;)
+  {
+    if (this->Acquire(queue, task))
+    {
+      this->Execute(queue, task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(this->WakeMutex);
+    ++this->NumberOfSleepingWorkers;
+    this->WakeCondition.wait(lock, [this]()
+      {
+        return this->Done || this->NumberOfQueuedTasks > 0;
+      });
+    --this->NumberOfSleepingWorkers;
+    if (this->Done)
+    {
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------
+void vtkSMPThreadPool::Run(vtkIdType first, vtkIdType last, vtkIdType grain,
+  vtk::detail::smp::ExecuteFunctorPtrType executer, void *functor)
+{
+  vtkSMPJob job;
+  job.Executer = executer;
+  job.Functor = functor;
+  job.Grain = grain;
+  job.Remaining = last - first;
+
+  // External threads (not part of the pool) get a temporary queue so that the
+  // tasks they split off can be stolen. Nested calls reuse the current one.
+  vtkSMPTaskQueue externalQueue;
+  vtkSMPTaskQueue *queue = vtkSMPCurrentQueue;
+  bool external = (queue == NULL);
+  if (external)
+  {
+    queue = &externalQueue;
+    vtkSMPCurrentQueue = queue;
+    vtkSMPCurrentPool = this;
+    this->AddQueue(queue);
+  }
+
+  vtkSMPTask root = { &job, first, last };
+  this->Execute(queue, root);
+
+  vtkSMPTask task;
+  while (job.Remaining > 0)
+  {
+    if (this->Acquire(queue, task))
+    {
+      this->Execute(queue, task);
+    }
+    else
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  if (external)
+  {
+    // While waiting, this thread may have helped other jobs and queued some
+    // of their tasks. Finish them before the queue goes away.
+    while (queue->Pop(task))
+    {
+      --this->NumberOfQueuedTasks;
+      this->Execute(queue, task);
+    }
+    this->RemoveQueue(queue);
+    vtkSMPCurrentQueue = NULL;
+    vtkSMPCurrentPool = NULL;
+  }
+}
+
+//--------------------------------------------------------------------------------
+// Atomic since GetEstimatedNumberOfThreads reads it without the pool lock.
+std::atomic<int> vtkSMPNumberOfSpecifiedThreads(0);
+// Shared with the For() calls running on it, so that Initialize can replace
+// the pool without destroying it under them. The last of them destroys it.
+std::shared_ptr<vtkSMPThreadPool> vtkSMPPool;
+std::mutex vtkSMPPoolMutex;
+
+std::shared_ptr<vtkSMPThreadPool> GetThreadPool()
+{
+  std::lock_guard<std::mutex> lock(vtkSMPPoolMutex);
+  if (!vtkSMPPool)
+  {
+    vtkSMPPool = std::make_shared<vtkSMPThreadPool>(
+      vtk::detail::smp::GetNumberOfThreads());
+  }
+  return vtkSMPPool;
+}
+
+} // anonymous namespace
+
+//--------------------------------------------------------------------------------
+void vtkSMPTools::Initialize(int numThreads)
+{
+  std::lock_guard<std::mutex> lock(vtkSMPPoolMutex);
+  if (numThreads && numThreads != vtkSMPNumberOfSpecifiedThreads)
+  {
+    vtkSMPNumberOfSpecifiedThreads = numThreads;
+    // Workers are created lazily with the new count on the next For(). The
+    // For() calls running on the current pool keep it until they return.
+    vtkSMPPool.reset();
+  }
+}
+
+//--------------------------------------------------------------------------------
+int vtkSMPTools::GetEstimatedNumberOfThreads()
+{
+  return vtk::detail::smp::GetNumberOfThreads();
+}
+
+//--------------------------------------------------------------------------------
+int vtk::detail::smp::GetNumberOfThreads()
+{
+  int specifiedThreads = vtkSMPNumberOfSpecifiedThreads;
+  if (specifiedThreads)
+  {
+    return specifiedThreads;
+  }
+  int numThreads = static_cast<int>(std::thread::hardware_concurrency());
+  return numThreads > 0 ? numThreads : 1;
+}
+
+//--------------------------------------------------------------------------------
+void vtk::detail::smp::vtkSMPTools_Impl_For_STDThread(vtkIdType first,
+  vtkIdType last, vtkIdType grain, ExecuteFunctorPtrType functorExecuter,
+  void *functor)
+{
+  // Nested calls run on the pool of the calling thread, which the outermost
+  // call keeps alive, even if Initialize has replaced it since.
+  std::shared_ptr<vtkSMPThreadPool> outerPool;
+  vtkSMPThreadPool *pool = vtkSMPCurrentPool;
+  if (!pool)
+  {
+    outerPool = GetThreadPool();
+    pool = outerPool.get();
+  }
+  int numThreads = pool->GetNumberOfThreads();
+
+  if (grain <= 0)
+  {
+    vtkIdType estimateGrain = (last - first) / (numThreads * 4);
+    grain = (estimateGrain > 0) ? estimateGrain : 1;
+  }
+
+  if (numThreads == 1)
+  {
+    for (vtkIdType from = first; from < last; from += grain)
+    {
+      functorExecuter(functor, from, std::min(from + grain, last));
+    }
+    return;
+  }
+
+  pool->Run(first, last, grain, functorExecuter, functor);
+}
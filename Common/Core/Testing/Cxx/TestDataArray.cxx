@@ -1,6 +1,8 @@
 #include "vtkIntArray.h"
 #include "vtkDoubleArray.h"
 #include "vtkMathUtilities.h"
+#include <algorithm>
+#include <cmath>
 
 // Define this to run benchmarking tests on some vtkDataArray methods:
 #undef BENCHMARK
@@ -211,6 +213,99 @@ int TestDataArray(int,char *[])
   }
   cout << endl;
   farray->Delete();
+
+  // Ranges of large arrays, which are computed in parallel. Use a number of
+  // components handled by a specialized code path and one which is not.
+  const int numComps[2] = {3, 11};
+  for (int k = 0; k < 2; ++k)
+  {
+    const vtkIdType numTuples = 100000;
+    farray = vtkDoubleArray::New();
+    farray->SetNumberOfComponents(numComps[k]);
+    farray->SetNumberOfTuples(numTuples);
+    double normRange[2] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+    for (vtkIdType t = 0; t < numTuples; ++t)
+    {
+      double norm2 = 0.0;
+      for (int c = 0; c < numComps[k]; ++c)
+      {
+        double value = static_cast<double>(t % 1000 - 500 + c);
+        farray->SetComponent(t, c, value);
+        norm2 += value * value;
+      }
+      if (t > 9)
+      {
+        normRange[0] = std::min(normRange[0], norm2);
+        normRange[1] = std::max(normRange[1], norm2);
+      }
+    }
+    farray->SetComponent(0, 0, vtkMath::Nan());
+    farray->SetComponent(7, 1, vtkMath::Inf());
+    farray->SetComponent(9, 2, vtkMath::NegInf());
+
+    for (int c = 0; c < numComps[k]; ++c)
+    {
+      double expected[2] = {-500.0 + c, 499.0 + c};
+      double finite[2] = {expected[0], expected[1]};
+      if (c == 1)
+      {
+        expected[1] = vtkMath::Inf();
+      }
+      else if (c == 2)
+      {
+        expected[0] = vtkMath::NegInf();
+      }
+      farray->GetRange(range, c);
+      if (range[0] != expected[0] || range[1] != expected[1])
+      {
+        cerr << "Wrong range (" << range[0] << "," << range[1]
+             << ") for component " << c << " of " << numComps[k] << endl;
+        farray->Delete();
+        return 1;
+      }
+      farray->GetFiniteRange(range, c);
+      if (range[0] != finite[0] || range[1] != finite[1])
+      {
+        cerr << "Wrong finite range (" << range[0] << "," << range[1]
+             << ") for component " << c << " of " << numComps[k] << endl;
+        farray->Delete();
+        return 1;
+      }
+    }
+
+    // The tuples 0, 7 and 9 hold non-finite values; the values of the other
+    // tuples in [0,9] are repeated further in the array.
+    farray->GetFiniteRange(range, -1);
+    if (!vtkMathUtilities::FuzzyCompare(range[0], sqrt(normRange[0])) ||
+        !vtkMathUtilities::FuzzyCompare(range[1], sqrt(normRange[1])))
+    {
+      cerr << "Wrong finite L2 norm range (" << range[0] << "," << range[1]
+           << ") for " << numComps[k] << " components" << endl;
+      farray->Delete();
+      return 1;
+    }
+    farray->GetRange(range, -1);
+    if (range[1] != vtkMath::Inf())
+    {
+      cerr << "Wrong L2 norm range (" << range[0] << "," << range[1]
+           << ") for " << numComps[k] << " components" << endl;
+      farray->Delete();
+      return 1;
+    }
+
+    // The cached ranges are updated when the array is modified.
+    farray->SetComponent(500, 0, 1000.0);
+    farray->Modified();
+    farray->GetRange(range, 0);
+    if (range[1] != 1000.0)
+    {
+      cerr << "Range not updated after modification" << endl;
+      farray->Delete();
+      return 1;
+    }
+    farray->Delete();
+  }
+
   return 0;
 }
 
@@ -91,9 +91,49 @@ public:
 
 };
 
+class NestedFunctor
+{
+public:
+  ARangeFunctor Inner;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i=begin; i<end; i++)
+      vtkSMPTools::For(0, 100, this->Inner);
+  }
+};
+
+// Changes the number of threads while other iterations run nested For()
+// calls on the current pool.
+struct ReinitializeFunctor
+{
+  ARangeFunctor Inner;
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i=begin; i<end; i++)
+    {
+      if (i % 50 == 0)
+      {
+        vtkSMPTools::Initialize(2 + static_cast<int>(i / 50) % 3);
+      }
+      vtkSMPTools::For(0, 100, this->Inner);
+    }
+  }
+};
+
 // For sorting comparison
 bool myComp (double a, double b) { return (a<b); }
 
+// For transform and reduce
+struct Square
+{
+  vtkIdType operator()(vtkIdType a) const { return a*a; }
+};
+struct Max
+{
+  vtkIdType operator()(vtkIdType a, vtkIdType b) const { return a<b ? b : a; }
+};
+
 int TestSMP(int, char*[])
 {
   //vtkSMPTools::Initialize(8);
@@ -140,6 +180,27 @@ int TestSMP(int, char*[])
     return 1;
   }
 
+  // Test nested For
+  NestedFunctor functor3;
+
+  vtkSMPTools::For(0, Target / 100, 1, functor3);
+
+  vtkSMPThreadLocal<int>::iterator itr3 = functor3.Inner.Counter.begin();
+  vtkSMPThreadLocal<int>::iterator end3 = functor3.Inner.Counter.end();
+
+  total = 0;
+  while(itr3 != end3)
+  {
+    total += *itr3;
+    ++itr3;
+  }
+
+  if (total != Target)
+  {
+    cerr << "Error: NestedFunctor did not generate " << Target << endl;
+    return 1;
+  }
+
   // Test sorting
   double data0[] = {2,1,0,3,9,6,7,3,8,4,5};
   std::vector<double> myvector (data0, data0+11);
@@ -167,5 +228,99 @@ int TestSMP(int, char*[])
     }
   }
 
+  // Sort enough values, with duplicates, for the range to be split.
+  const vtkIdType numSorted = 1000003;
+  std::vector<vtkIdType> sorted(numSorted);
+  for (vtkIdType i=0; i<numSorted; ++i)
+  {
+    sorted[i] = (i * 7919) % numSorted / 3;
+  }
+  vtkSMPTools::Sort(sorted.begin(), sorted.end());
+  for (vtkIdType i=0; i<numSorted; ++i)
+  {
+    if ( sorted[i] != i / 3 )
+    {
+      cerr << "Error: Bad large sort!" << endl;
+      return 1;
+    }
+  }
+
+  // Test transform, fill, reduce and scan. Use enough values for the range
+  // to be split in several blocks.
+  const vtkIdType numValues = 100000;
+  std::vector<vtkIdType> values(numValues);
+  std::vector<vtkIdType> results(numValues);
+  vtkSMPTools::Fill(values.begin(), values.end(), 3);
+  vtkSMPTools::Transform(values.begin(), values.end(), results.begin(),
+                         Square());
+  for (vtkIdType i=0; i<numValues; ++i)
+  {
+    if ( values[i] != 3 || results[i] != 9 )
+    {
+      cerr << "Error: Bad fill or transform!" << endl;
+      return 1;
+    }
+  }
+
+  for (vtkIdType i=0; i<numValues; ++i)
+  {
+    values[i] = i;
+  }
+  vtkSMPTools::Transform(values.begin(), values.end(), values.begin(),
+                         results.begin(), std::plus<vtkIdType>());
+  if ( results[numValues-1] != 2*(numValues-1) )
+  {
+    cerr << "Error: Bad binary transform!" << endl;
+    return 1;
+  }
+
+  vtkIdType sum = vtkSMPTools::Reduce(values.begin(), values.end(),
+                                      static_cast<vtkIdType>(10));
+  vtkIdType max = vtkSMPTools::Reduce(values.begin(), values.end(),
+                                      static_cast<vtkIdType>(-1), Max());
+  if ( sum != 10 + numValues*(numValues-1)/2 || max != numValues-1 )
+  {
+    cerr << "Error: Bad reduction!" << endl;
+    return 1;
+  }
+
+  // In place scan
+  vtkIdType scanTotal = vtkSMPTools::ExclusiveScan(
+    values.begin(), values.end(), values.begin(), static_cast<vtkIdType>(0));
+  if ( scanTotal != numValues*(numValues-1)/2 )
+  {
+    cerr << "Error: Bad scan total!" << endl;
+    return 1;
+  }
+  for (vtkIdType i=0; i<numValues; ++i)
+  {
+    if ( values[i] != i*(i-1)/2 )
+    {
+      cerr << "Error: Bad exclusive scan!" << endl;
+      return 1;
+    }
+  }
+
+  // Test changing the number of threads while For() calls are running.
+  ReinitializeFunctor functor4;
+
+  vtkSMPTools::For(0, Target / 100, 1, functor4);
+
+  vtkSMPThreadLocal<int>::iterator itr4 = functor4.Inner.Counter.begin();
+  vtkSMPThreadLocal<int>::iterator end4 = functor4.Inner.Counter.end();
+
+  total = 0;
+  while(itr4 != end4)
+  {
+    total += *itr4;
+    ++itr4;
+  }
+
+  if (total != Target)
+  {
+    cerr << "Error: ReinitializeFunctor did not generate " << Target << endl;
+    return 1;
+  }
+
   return 0;
 }
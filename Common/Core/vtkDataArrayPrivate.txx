@@ -18,9 +18,12 @@
 #include "vtkAssume.h"
 #include "vtkDataArray.h"
 #include "vtkDataArrayAccessor.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkTypeTraits.h"
 #include <algorithm>
 #include <cassert> // for assert()
+#include <vector>
 
 namespace vtkDataArrayPrivate
 {
@@ -103,93 +106,151 @@ bool isinf(T x)
 }
 
 //----------------------------------------------------------------------------
-template <class APIType, int NumComps, int RangeSize>
-struct ComputeScalarRange
+// NaN and infinite values are skipped by the finite range computations.
+namespace detail {
+template <typename T>
+bool isfinite(T x)
 {
-  template<class ArrayT>
-  bool operator()(ArrayT *array, double *ranges)
-  {
-    VTK_ASSUME(array->GetNumberOfComponents() == NumComps);
+  // NaN is the only value which does not compare equal to itself.
+  return x == x && !detail::isinf(x);
+}
+}
 
-    vtkDataArrayAccessor<ArrayT> access(array);
-    APIType tempRange[RangeSize];
+//----------------------------------------------------------------------------
+// The range computations are performed with vtkSMPTools::For() using a
+// per-thread range which is merged in Reduce(). Arrays that are not handled
+// by vtkArrayDispatch are accessed through the vtkDataArray API, which does
+// not need to be thread safe (e.g. mapped arrays), so they are processed in a
+// single chunk, as are small arrays which are not worth the overhead.
+template <typename ArrayT>
+vtkIdType GetRangeGrain(ArrayT *, vtkIdType numTuples, int numComps)
+{
+  return (numTuples * numComps < 65536) ? numTuples : 0;
+}
 
-    for(int i = 0, j = 0; i < NumComps; ++i, j+=2)
-    {
-      tempRange[j] = vtkTypeTraits<APIType>::Max();
-      tempRange[j+1] = vtkTypeTraits<APIType>::Min();
-    }
+inline vtkIdType GetRangeGrain(vtkDataArray *, vtkIdType numTuples, int)
+{
+  return numTuples;
+}
 
-    //compute the range for each component of the data array at the same time
-    const vtkIdType numTuples = array->GetNumberOfTuples();
-    for(vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
+//----------------------------------------------------------------------------
+// Update the min/max pairs in range with the tuples [begin,end). numComps is
+// a compile time constant for the common cases, which lets the compiler
+// unroll the inner loop.
+template <bool FiniteOnly, typename AccessorT, typename APIType>
+inline void UpdateScalarRange(AccessorT &access, vtkIdType begin,
+                              vtkIdType end, int numComps, APIType *range)
+{
+  for (vtkIdType tupleIdx = begin; tupleIdx < end; ++tupleIdx)
+  {
+    for (int compIdx = 0, j = 0; compIdx < numComps; ++compIdx, j+=2)
     {
-      for(int compIdx = 0, j = 0; compIdx < NumComps; ++compIdx, j+=2)
+      APIType value = access.Get(tupleIdx, compIdx);
+      if (!FiniteOnly || detail::isfinite(value))
       {
-        APIType value = access.Get(tupleIdx, compIdx);
-        tempRange[j]   = detail::min(tempRange[j], value);
-        tempRange[j+1] = detail::max(tempRange[j+1], value);
+        range[j]   = detail::min(range[j], value);
+        range[j+1] = detail::max(range[j+1], value);
       }
     }
-
-    //convert the range to doubles
-    for (int i = 0, j = 0; i < NumComps; ++i, j+=2)
-    {
-      ranges[j] = static_cast<double>(tempRange[j]);
-      ranges[j+1] = static_cast<double>(tempRange[j+1]);
-    }
-    return true;
   }
-};
+}
 
 //----------------------------------------------------------------------------
-template <class APIType, int NumComps, int RangeSize>
-struct ComputeScalarFiniteRange
+// Compute the range of each component. NumComps is 0 when the number of
+// components is only known at run time.
+template <typename ArrayT, typename APIType, int NumComps, bool FiniteOnly>
+class ScalarRangeFunctor
 {
-  template<class ArrayT>
-  bool operator()(ArrayT *array, double *ranges)
+  ArrayT *Array;
+  int NumberOfComponents;
+  double *Ranges;
+  vtkSMPThreadLocal<std::vector<APIType> > TLRange;
+
+public:
+  ScalarRangeFunctor(ArrayT *array, double *ranges)
+    : Array(array), NumberOfComponents(array->GetNumberOfComponents()),
+      Ranges(ranges)
   {
-    VTK_ASSUME(array->GetNumberOfComponents() == NumComps);
+  }
 
-    vtkDataArrayAccessor<ArrayT> access(array);
-    APIType tempRange[RangeSize];
+  void Initialize()
+  {
+    std::vector<APIType> &range = this->TLRange.Local();
+    range.resize(2 * this->NumberOfComponents);
+    for (int i = 0, j = 0; i < this->NumberOfComponents; ++i, j+=2)
+    {
+      range[j] = vtkTypeTraits<APIType>::Max();
+      range[j+1] = vtkTypeTraits<APIType>::Min();
+    }
+  }
 
-    for(int i = 0, j = 0; i < NumComps; ++i, j+=2)
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataArrayAccessor<ArrayT> access(this->Array);
+    std::vector<APIType> &range = this->TLRange.Local();
+    if (NumComps > 0)
+    {
+      // Work on a local copy so that the range stays in registers.
+      VTK_ASSUME(this->Array->GetNumberOfComponents() == NumComps);
+      APIType tempRange[2 * (NumComps > 0 ? NumComps : 1)];
+      std::copy(range.begin(), range.end(), tempRange);
+      UpdateScalarRange<FiniteOnly>(access, begin, end, NumComps, tempRange);
+      std::copy(tempRange, tempRange + 2 * NumComps, range.begin());
+    }
+    else
     {
-      tempRange[j] = vtkTypeTraits<APIType>::Max();
-      tempRange[j+1] = vtkTypeTraits<APIType>::Min();
+      UpdateScalarRange<FiniteOnly>(access, begin, end,
+                                    this->NumberOfComponents, &range[0]);
     }
+  }
 
-    //compute the range for each component of the data array at the same time
-    const vtkIdType numTuples = array->GetNumberOfTuples();
-    for(vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
+  void Reduce()
+  {
+    const int numComps = this->NumberOfComponents;
+    std::vector<APIType> result(2 * numComps);
+    for (int i = 0, j = 0; i < numComps; ++i, j+=2)
+    {
+      result[j] = vtkTypeTraits<APIType>::Max();
+      result[j+1] = vtkTypeTraits<APIType>::Min();
+    }
+    typedef typename vtkSMPThreadLocal<std::vector<APIType> >::iterator
+      IteratorType;
+    for (IteratorType itr = this->TLRange.begin();
+         itr != this->TLRange.end(); ++itr)
     {
-      for(int compIdx = 0, j = 0; compIdx < NumComps; ++compIdx, j+=2)
+      const std::vector<APIType> &range = *itr;
+      for (int j = 0; j < 2 * numComps; j+=2)
       {
-        APIType value = access.Get(tupleIdx, compIdx);
-        if (!detail::isinf(value))
-        {
-          tempRange[j]   = detail::min(tempRange[j], value);
-          tempRange[j+1] = detail::max(tempRange[j+1], value);
-        }
+        result[j]   = detail::min(result[j], range[j]);
+        result[j+1] = detail::max(result[j+1], range[j+1]);
       }
     }
 
     //convert the range to doubles
-    for (int i = 0, j = 0; i < NumComps; ++i, j+=2)
+    for (int j = 0; j < 2 * numComps; ++j)
     {
-      ranges[j] = static_cast<double>(tempRange[j]);
-      ranges[j+1] = static_cast<double>(tempRange[j+1]);
+      this->Ranges[j] = static_cast<double>(result[j]);
     }
-    return true;
   }
 };
 
 //----------------------------------------------------------------------------
-template <typename ArrayT>
-bool DoComputeScalarFiniteRange(ArrayT *array, double *ranges)
+template <typename ArrayT, typename APIType, int NumComps, bool FiniteOnly>
+bool ExecuteScalarRange(ArrayT *array, double *ranges)
+{
+  const vtkIdType numTuples = array->GetNumberOfTuples();
+  const int numComps = array->GetNumberOfComponents();
+  ScalarRangeFunctor<ArrayT, APIType, NumComps, FiniteOnly>
+    functor(array, ranges);
+  vtkSMPTools::For(0, numTuples,
+                   GetRangeGrain(array, numTuples, numComps), functor);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <bool FiniteOnly, typename ArrayT>
+bool ComputeScalarRange(ArrayT *array, double *ranges)
 {
-  vtkDataArrayAccessor<ArrayT> access(array);
   typedef typename vtkDataArrayAccessor<ArrayT>::APIType APIType;
 
   const vtkIdType numTuples = array->GetNumberOfTuples();
@@ -208,184 +269,118 @@ bool DoComputeScalarFiniteRange(ArrayT *array, double *ranges)
     return false;
   }
 
-  //Special case for single value scalar range. This is done to help the
+  //Special case for small numbers of components. This is done to help the
   //compiler detect it can perform loop optimizations.
-  if (numComp == 1)
-  {
-    return ComputeScalarFiniteRange<APIType,1,2>()(array, ranges);
-  }
-  else if (numComp == 2)
-  {
-    return ComputeScalarFiniteRange<APIType,2,4>()(array, ranges);
-  }
-  else if (numComp == 3)
-  {
-    return ComputeScalarFiniteRange<APIType,3,6>()(array, ranges);
-  }
-  else if (numComp == 4)
-  {
-    return ComputeScalarFiniteRange<APIType,4,8>()(array, ranges);
-  }
-  else if (numComp == 5)
-  {
-    return ComputeScalarFiniteRange<APIType,5,10>()(array, ranges);
-  }
-  else if (numComp == 6)
-  {
-    return ComputeScalarFiniteRange<APIType,6,12>()(array, ranges);
-  }
-  else if (numComp == 7)
-  {
-    return ComputeScalarFiniteRange<APIType,7,14>()(array, ranges);
-  }
-  else if (numComp == 8)
-  {
-    return ComputeScalarFiniteRange<APIType,8,16>()(array, ranges);
-  }
-  else if (numComp == 9)
-  {
-    return ComputeScalarFiniteRange<APIType,9,18>()(array, ranges);
+  switch (numComp)
+  {
+    case 1:
+      return ExecuteScalarRange<ArrayT,APIType,1,FiniteOnly>(array, ranges);
+    case 2:
+      return ExecuteScalarRange<ArrayT,APIType,2,FiniteOnly>(array, ranges);
+    case 3:
+      return ExecuteScalarRange<ArrayT,APIType,3,FiniteOnly>(array, ranges);
+    case 4:
+      return ExecuteScalarRange<ArrayT,APIType,4,FiniteOnly>(array, ranges);
+    case 5:
+      return ExecuteScalarRange<ArrayT,APIType,5,FiniteOnly>(array, ranges);
+    case 6:
+      return ExecuteScalarRange<ArrayT,APIType,6,FiniteOnly>(array, ranges);
+    case 7:
+      return ExecuteScalarRange<ArrayT,APIType,7,FiniteOnly>(array, ranges);
+    case 8:
+      return ExecuteScalarRange<ArrayT,APIType,8,FiniteOnly>(array, ranges);
+    case 9:
+      return ExecuteScalarRange<ArrayT,APIType,9,FiniteOnly>(array, ranges);
+    default:
+      return ExecuteScalarRange<ArrayT,APIType,0,FiniteOnly>(array, ranges);
   }
-  else
-  {
-    //initialize the temp range storage to min/max pairs
-    APIType* tempRange = new APIType[numComp*2];
-    for (int i = 0, j = 0; i < numComp; ++i, j+=2)
-    {
-      tempRange[j] = vtkTypeTraits<APIType>::Max();
-      tempRange[j+1] = vtkTypeTraits<APIType>::Min();
-    }
-
-    //compute the range for each component of the data array at the same time
-    for (vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
-    {
-      for(int compIdx = 0, j = 0; compIdx < numComp; ++compIdx, j+=2)
-      {
-        APIType value = access.Get(tupleIdx, compIdx);
-        if (!detail::isinf(value))
-        {
-          tempRange[j]   = detail::min(tempRange[j],value);
-          tempRange[j+1] = detail::max(tempRange[j+1],value);
-        }
-      }
-    }
-
-    //convert the range to doubles
-    for (int i = 0, j = 0; i < numComp; ++i, j+=2)
-    {
-      ranges[j] = static_cast<double>(tempRange[j]);
-      ranges[j+1] = static_cast<double>(tempRange[j+1]);
-    }
-
-    //cleanup temp range storage
-    delete[] tempRange;
+}
 
-    return true;
-  }
+//----------------------------------------------------------------------------
+template <typename ArrayT>
+bool DoComputeScalarFiniteRange(ArrayT *array, double *ranges)
+{
+  return ComputeScalarRange<true>(array, ranges);
 }
 
 //----------------------------------------------------------------------------
 template <typename ArrayT>
 bool DoComputeScalarRange(ArrayT *array, double *ranges)
 {
-  vtkDataArrayAccessor<ArrayT> access(array);
-  typedef typename vtkDataArrayAccessor<ArrayT>::APIType APIType;
+  return ComputeScalarRange<false>(array, ranges);
+}
 
-  const vtkIdType numTuples = array->GetNumberOfTuples();
-  const int numComp = array->GetNumberOfComponents();
+//----------------------------------------------------------------------------
+// Compute the range of the squared L2 norm of the tuples.
+template <typename ArrayT, bool FiniteOnly>
+class VectorRangeFunctor
+{
+  ArrayT *Array;
+  double *Range;
+  vtkSMPThreadLocal<std::vector<double> > TLRange;
 
-  //setup the initial ranges to be the max,min for double
-  for (int i = 0, j = 0; i < numComp; ++i, j+=2)
+public:
+  VectorRangeFunctor(ArrayT *array, double range[2])
+    : Array(array), Range(range)
   {
-    ranges[j] =  vtkTypeTraits<double>::Max();
-    ranges[j+1] = vtkTypeTraits<double>::Min();
   }
 
-  //do this after we make sure range is max to min
-  if (numTuples == 0)
+  void Initialize()
   {
-    return false;
+    std::vector<double> &range = this->TLRange.Local();
+    range.resize(2);
+    range[0] = vtkTypeTraits<double>::Max();
+    range[1] = vtkTypeTraits<double>::Min();
   }
 
-  //Special case for single value scalar range. This is done to help the
-  //compiler detect it can perform loop optimizations.
-  if (numComp == 1)
-  {
-    return ComputeScalarRange<APIType,1,2>()(array, ranges);
-  }
-  else if (numComp == 2)
-  {
-    return ComputeScalarRange<APIType,2,4>()(array, ranges);
-  }
-  else if (numComp == 3)
-  {
-    return ComputeScalarRange<APIType,3,6>()(array, ranges);
-  }
-  else if (numComp == 4)
+  void operator()(vtkIdType begin, vtkIdType end)
   {
-    return ComputeScalarRange<APIType,4,8>()(array, ranges);
-  }
-  else if (numComp == 5)
-  {
-    return ComputeScalarRange<APIType,5,10>()(array, ranges);
-  }
-  else if (numComp == 6)
-  {
-    return ComputeScalarRange<APIType,6,12>()(array, ranges);
-  }
-  else if (numComp == 7)
-  {
-    return ComputeScalarRange<APIType,7,14>()(array, ranges);
-  }
-  else if (numComp == 8)
-  {
-    return ComputeScalarRange<APIType,8,16>()(array, ranges);
-  }
-  else if (numComp == 9)
-  {
-    return ComputeScalarRange<APIType,9,18>()(array, ranges);
-  }
-  else
-  {
-    //initialize the temp range storage to min/max pairs
-    APIType* tempRange = new APIType[numComp*2];
-    for (int i = 0, j = 0; i < numComp; ++i, j+=2)
-    {
-      tempRange[j] = vtkTypeTraits<APIType>::Max();
-      tempRange[j+1] = vtkTypeTraits<APIType>::Min();
-    }
-
-    //compute the range for each component of the data array at the same time
-    for (vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
+    vtkDataArrayAccessor<ArrayT> access(this->Array);
+    const int numComps = this->Array->GetNumberOfComponents();
+    std::vector<double> &range = this->TLRange.Local();
+    double minimum = range[0];
+    double maximum = range[1];
+    for (vtkIdType tupleIdx = begin; tupleIdx < end; ++tupleIdx)
     {
-      for(int compIdx = 0, j = 0; compIdx < numComp; ++compIdx, j+=2)
+      double squaredSum = 0.0;
+      for (int compIdx = 0; compIdx < numComps; ++compIdx)
       {
-        APIType value = access.Get(tupleIdx, compIdx);
-        tempRange[j]   = detail::min(tempRange[j],value);
-        tempRange[j+1] = detail::max(tempRange[j+1],value);
+        const double t = static_cast<double>(access.Get(tupleIdx, compIdx));
+        squaredSum += t * t;
+      }
+      if (!FiniteOnly || detail::isfinite(squaredSum))
+      {
+        minimum = detail::min(minimum, squaredSum);
+        maximum = detail::max(maximum, squaredSum);
       }
     }
+    range[0] = minimum;
+    range[1] = maximum;
+  }
 
-    //convert the range to doubles
-    for (int i = 0, j = 0; i < numComp; ++i, j+=2)
+  void Reduce()
+  {
+    this->Range[0] = vtkTypeTraits<double>::Max();
+    this->Range[1] = vtkTypeTraits<double>::Min();
+    typedef vtkSMPThreadLocal<std::vector<double> >::iterator IteratorType;
+    for (IteratorType itr = this->TLRange.begin();
+         itr != this->TLRange.end(); ++itr)
     {
-      ranges[j] = static_cast<double>(tempRange[j]);
-      ranges[j+1] = static_cast<double>(tempRange[j+1]);
+      this->Range[0] = detail::min(this->Range[0], (*itr)[0]);
+      this->Range[1] = detail::max(this->Range[1], (*itr)[1]);
     }
 
-    //cleanup temp range storage
-    delete[] tempRange;
-
-    return true;
+    //now that we have computed the smallest and largest value, take the
+    //square root of that value.
+    this->Range[0] = sqrt(this->Range[0]);
+    this->Range[1] = sqrt(this->Range[1]);
   }
-}
+};
 
 //----------------------------------------------------------------------------
-template <typename ArrayT>
-bool DoComputeVectorRange(ArrayT *array, double range[2])
+template <bool FiniteOnly, typename ArrayT>
+bool ComputeVectorRange(ArrayT *array, double range[2])
 {
-  vtkDataArrayAccessor<ArrayT> access(array);
-
   const vtkIdType numTuples = array->GetNumberOfTuples();
   const int numComps = array->GetNumberOfComponents();
 
@@ -398,69 +393,28 @@ bool DoComputeVectorRange(ArrayT *array, double range[2])
     return false;
   }
 
-  //iterate over all the tuples
-  for (vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
-  {
-    double squaredSum = 0.0;
-    for (int compIdx = 0; compIdx < numComps; ++compIdx)
-    {
-      const double t = static_cast<double>(access.Get(tupleIdx, compIdx));
-      squaredSum += t * t;
-    }
-    range[0] = detail::min(range[0], squaredSum);
-    range[1] = detail::max(range[1], squaredSum);
-  }
-
-  //now that we have computed the smallest and largest value, take the
-  //square root of that value.
-  range[0] = sqrt(range[0]);
-  range[1] = sqrt(range[1]);
+  VectorRangeFunctor<ArrayT, FiniteOnly> functor(array, range);
+  vtkSMPTools::For(0, numTuples,
+                   GetRangeGrain(array, numTuples, numComps), functor);
 
   return true;
 }
 
 //----------------------------------------------------------------------------
 template <typename ArrayT>
-bool DoComputeVectorFiniteRange(ArrayT *array, double range[2])
+bool DoComputeVectorRange(ArrayT *array, double range[2])
 {
-  vtkDataArrayAccessor<ArrayT> access(array);
-
-  const vtkIdType numTuples = array->GetNumberOfTuples();
-  const int numComps = array->GetNumberOfComponents();
-
-  range[0] = vtkTypeTraits<double>::Max();
-  range[1] = vtkTypeTraits<double>::Min();
-
-  //do this after we make sure range is max to min
-  if (numTuples == 0)
-  {
-    return false;
-  }
-
-  //iterate over all the tuples
-  for (vtkIdType tupleIdx = 0; tupleIdx < numTuples; ++tupleIdx)
-  {
-    double squaredSum = 0.0;
-    for (int compIdx = 0; compIdx < numComps; ++compIdx)
-    {
-      const double t = static_cast<double>(access.Get(tupleIdx, compIdx));
-      squaredSum += t * t;
-    }
-    if (!detail::isinf(squaredSum))
-    {
-      range[0] = detail::min(range[0], squaredSum);
-      range[1] = detail::max(range[1], squaredSum);
-    }
-  }
-
-  //now that we have computed the smallest and largest value, take the
-  //square root of that value.
-  range[0] = sqrt(range[0]);
-  range[1] = sqrt(range[1]);
+  return ComputeVectorRange<false>(array, range);
+}
 
-  return true;
+//----------------------------------------------------------------------------
+template <typename ArrayT>
+bool DoComputeVectorFiniteRange(ArrayT *array, double range[2])
+{
+  return ComputeVectorRange<true>(array, range);
 }
 
+
 } // end namespace vtkDataArrayPrivate
 #endif
 // VTK-HeaderTest-Exclude: vtkDataArrayPrivate.txx
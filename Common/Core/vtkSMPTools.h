@@ -19,8 +19,10 @@
  * vtkSMPTools provides a set of utility functions that can
  * be used to parallelize parts of VTK code using multiple threads.
  * There are several back-end implementations of parallel functionality
- * (currently Sequential, TBB and X-Kaapi) that actual execution is
- * delegated to.
+ * (currently Sequential, STDThread, OpenMP and TBB) that actual execution is
+ * delegated to. The STDThread back-end has no external dependency: it keeps
+ * a pool of std::thread workers alive between calls and balances the load
+ * with work stealing, which also makes nested For() calls safe.
 */
 
 #ifndef vtkSMPTools_h
@@ -32,6 +34,10 @@
 #include "vtkSMPThreadLocal.h" // For Initialized
 #include "vtkSMPToolsInternal.h"
 
+#include <algorithm> // For std::fill
+#include <functional> // For std::plus
+#include <vector> // For Reduce and ExclusiveScan
+
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 #ifndef __VTK_WRAP__
@@ -129,6 +135,151 @@ class vtkSMPTools_Lookup_For<Functor const>
 public:
   typedef vtkSMPTools_FunctorInternal<Functor const, init> type;
 };
+
+// Number of blocks used by the block based algorithms (Reduce and
+// ExclusiveScan). It only depends on the size of the range so that the
+// grouping of the operations, and thus the result of non-associative
+// operations such as floating point sums, does not change with the number
+// of threads.
+inline vtkIdType vtkSMPTools_NumberOfBlocks(vtkIdType n)
+{
+  const vtkIdType minBlockSize = 4096;
+  const vtkIdType maxNumberOfBlocks = 4096;
+  vtkIdType numBlocks = n / minBlockSize;
+  if (numBlocks < 1)
+  {
+    numBlocks = 1;
+  }
+  return numBlocks < maxNumberOfBlocks ? numBlocks : maxNumberOfBlocks;
+}
+
+template <typename InputIt, typename OutputIt, typename UnaryOp>
+struct vtkSMPTools_UnaryTransformFunctor
+{
+  InputIt In;
+  OutputIt Out;
+  UnaryOp& Op;
+
+  vtkSMPTools_UnaryTransformFunctor(InputIt in, OutputIt out, UnaryOp& op)
+    : In(in), Out(out), Op(op) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    InputIt in = this->In + begin;
+    OutputIt out = this->Out + begin;
+    for (vtkIdType i = begin; i < end; ++i, ++in, ++out)
+    {
+      *out = this->Op(*in);
+    }
+  }
+};
+
+template <typename InputIt1, typename InputIt2, typename OutputIt,
+  typename BinaryOp>
+struct vtkSMPTools_BinaryTransformFunctor
+{
+  InputIt1 In1;
+  InputIt2 In2;
+  OutputIt Out;
+  BinaryOp& Op;
+
+  vtkSMPTools_BinaryTransformFunctor(InputIt1 in1, InputIt2 in2,
+    OutputIt out, BinaryOp& op)
+    : In1(in1), In2(in2), Out(out), Op(op) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    InputIt1 in1 = this->In1 + begin;
+    InputIt2 in2 = this->In2 + begin;
+    OutputIt out = this->Out + begin;
+    for (vtkIdType i = begin; i < end; ++i, ++in1, ++in2, ++out)
+    {
+      *out = this->Op(*in1, *in2);
+    }
+  }
+};
+
+template <typename Iterator, typename T>
+struct vtkSMPTools_FillFunctor
+{
+  Iterator Begin;
+  const T& Value;
+
+  vtkSMPTools_FillFunctor(Iterator begin, const T& value)
+    : Begin(begin), Value(value) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    std::fill(this->Begin + begin, this->Begin + end, this->Value);
+  }
+};
+
+// Reduces each block of the range into one partial value.
+template <typename InputIt, typename T, typename BinaryOp>
+struct vtkSMPTools_BlockReduceFunctor
+{
+  InputIt In;
+  vtkIdType N;
+  vtkIdType NumberOfBlocks;
+  T* Partials;
+  BinaryOp& Op;
+
+  vtkSMPTools_BlockReduceFunctor(InputIt in, vtkIdType n,
+    vtkIdType numBlocks, T* partials, BinaryOp& op)
+    : In(in), N(n), NumberOfBlocks(numBlocks), Partials(partials), Op(op) {}
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock)
+  {
+    for (vtkIdType block = beginBlock; block < endBlock; ++block)
+    {
+      vtkIdType begin = block * this->N / this->NumberOfBlocks;
+      vtkIdType end = (block + 1) * this->N / this->NumberOfBlocks;
+      InputIt in = this->In + begin;
+      T value = *in;
+      for (++in, ++begin; begin < end; ++begin, ++in)
+      {
+        value = this->Op(value, *in);
+      }
+      this->Partials[block] = value;
+    }
+  }
+};
+
+// Scans each block of the range starting from the block offset.
+template <typename InputIt, typename OutputIt, typename T, typename BinaryOp>
+struct vtkSMPTools_BlockScanFunctor
+{
+  InputIt In;
+  OutputIt Out;
+  vtkIdType N;
+  vtkIdType NumberOfBlocks;
+  const T* Offsets;
+  BinaryOp& Op;
+
+  vtkSMPTools_BlockScanFunctor(InputIt in, OutputIt out, vtkIdType n,
+    vtkIdType numBlocks, const T* offsets, BinaryOp& op)
+    : In(in), Out(out), N(n), NumberOfBlocks(numBlocks), Offsets(offsets),
+      Op(op) {}
+
+  void operator()(vtkIdType beginBlock, vtkIdType endBlock)
+  {
+    for (vtkIdType block = beginBlock; block < endBlock; ++block)
+    {
+      vtkIdType begin = block * this->N / this->NumberOfBlocks;
+      vtkIdType end = (block + 1) * this->N / this->NumberOfBlocks;
+      InputIt in = this->In + begin;
+      OutputIt out = this->Out + begin;
+      T sum = this->Offsets[block];
+      for (; begin < end; ++begin, ++in, ++out)
+      {
+        // Read before writing so that the scan can be done in place.
+        T value = *in;
+        *out = sum;
+        sum = this->Op(sum, value);
+      }
+    }
+  }
+};
 } // namespace smp
 } // namespace detail
 } // namespace vtk
@@ -210,10 +361,12 @@ public:
    * not required as it is automatically called before the first
    * execution of any parallel code. However, it can be used to
    * control the maximum number of threads used when the back-end
-   * supports it (currently Simple and TBB only). Make sure to call
+   * supports it (currently STDThread, OpenMP and TBB). Make sure to call
    * it before any other parallel operation.
-   * When using Kaapi, use the KAAPI_CPUCOUNT env. variable to control
-   * the number of threads used in the thread pool.
+   * With STDThread, the thread pool otherwise uses as many threads as
+   * std::thread::hardware_concurrency(), and a different numThreads
+   * recreates the pool on the next parallel operation. The operations
+   * running at that time complete on the previous pool.
    */
   static void Initialize(int numThreads=0);
 
@@ -228,7 +381,8 @@ public:
   /**
    * A convenience method for sorting data. It is a drop in replacement for
    * std::sort(). Under the hood different methods are used. For example,
-   * tbb::parallel_sort is used in TBB.
+   * tbb::parallel_sort is used in TBB, and STDThread sorts one chunk per
+   * thread in parallel before merging them.
    */
   template<typename RandomAccessIterator>
     static void Sort(RandomAccessIterator begin, RandomAccessIterator end)
@@ -249,6 +403,136 @@ public:
     vtk::detail::smp::vtkSMPTools_Impl_Sort(begin,end,comp);
   }
 
+  /**
+   * A convenience method for transforming data. It is a drop in replacement
+   * for std::transform(): op is applied to every element of [inBegin, inEnd)
+   * and the result is written to the range starting at outBegin. The
+   * iterators must be random access iterators, and op must be safe to call
+   * concurrently. The input and output ranges may be the same.
+   */
+  template <typename InputIt, typename OutputIt, typename UnaryOp>
+  static void Transform(InputIt inBegin, InputIt inEnd, OutputIt outBegin,
+                        UnaryOp op)
+  {
+    vtk::detail::smp::vtkSMPTools_UnaryTransformFunctor<
+      InputIt, OutputIt, UnaryOp> fi(inBegin, outBegin, op);
+    vtkSMPTools::For(0, inEnd - inBegin, fi);
+  }
+
+  /**
+   * A convenience method for transforming data. It is a drop in replacement
+   * for the binary version of std::transform(): the result of
+   * op(*in1, *in2) is written to the range starting at outBegin for every
+   * pair of elements of [inBegin1, inEnd1) and of the range starting at
+   * inBegin2.
+   */
+  template <typename InputIt1, typename InputIt2, typename OutputIt,
+    typename BinaryOp>
+  static void Transform(InputIt1 inBegin1, InputIt1 inEnd1, InputIt2 inBegin2,
+                        OutputIt outBegin, BinaryOp op)
+  {
+    vtk::detail::smp::vtkSMPTools_BinaryTransformFunctor<
+      InputIt1, InputIt2, OutputIt, BinaryOp> fi(
+        inBegin1, inBegin2, outBegin, op);
+    vtkSMPTools::For(0, inEnd1 - inBegin1, fi);
+  }
+
+  /**
+   * A convenience method for filling data. It is a drop in replacement for
+   * std::fill(): value is assigned to every element of [begin, end).
+   */
+  template <typename Iterator, typename T>
+  static void Fill(Iterator begin, Iterator end, const T& value)
+  {
+    vtk::detail::smp::vtkSMPTools_FillFunctor<Iterator, T> fi(begin, value);
+    vtkSMPTools::For(0, end - begin, fi);
+  }
+
+  /**
+   * Parallel reduction: returns init combined with all the elements of
+   * [begin, end) using the associative operation op, like std::reduce().
+   * The range is split into blocks whose number only depends on the size of
+   * the range, and the partial results are combined in block order. Hence
+   * the result is the same whatever the number of threads, even for
+   * floating point sums.
+   */
+  template <typename Iterator, typename T, typename BinaryOp>
+  static T Reduce(Iterator begin, Iterator end, T init, BinaryOp op)
+  {
+    vtkIdType n = end - begin;
+    if (n <= 0)
+    {
+      return init;
+    }
+    vtkIdType numBlocks = vtk::detail::smp::vtkSMPTools_NumberOfBlocks(n);
+    std::vector<T> partials(numBlocks);
+    vtk::detail::smp::vtkSMPTools_BlockReduceFunctor<Iterator, T, BinaryOp>
+      fi(begin, n, numBlocks, &partials[0], op);
+    vtkSMPTools::For(0, numBlocks, 1, fi);
+    for (vtkIdType block = 0; block < numBlocks; ++block)
+    {
+      init = op(init, partials[block]);
+    }
+    return init;
+  }
+
+  /**
+   * Parallel sum of the elements of [begin, end), starting from init.
+   */
+  template <typename Iterator, typename T>
+  static T Reduce(Iterator begin, Iterator end, T init)
+  {
+    return vtkSMPTools::Reduce(begin, end, init, std::plus<T>());
+  }
+
+  /**
+   * Parallel exclusive prefix scan, like std::exclusive_scan(): the i-th
+   * output element is init combined with the first i elements of the input
+   * range using the associative operation op. Returns the combination of
+   * init with all the input elements, which is handy to size the output of
+   * "count then write" algorithms. The output range may be the input range.
+   * The scan is done in two passes over fixed size blocks, so its result
+   * does not depend on the number of threads either.
+   */
+  template <typename InputIt, typename OutputIt, typename T,
+    typename BinaryOp>
+  static T ExclusiveScan(InputIt inBegin, InputIt inEnd, OutputIt outBegin,
+                         T init, BinaryOp op)
+  {
+    vtkIdType n = inEnd - inBegin;
+    if (n <= 0)
+    {
+      return init;
+    }
+    vtkIdType numBlocks = vtk::detail::smp::vtkSMPTools_NumberOfBlocks(n);
+    std::vector<T> offsets(numBlocks);
+    vtk::detail::smp::vtkSMPTools_BlockReduceFunctor<InputIt, T, BinaryOp>
+      reduce(inBegin, n, numBlocks, &offsets[0], op);
+    vtkSMPTools::For(0, numBlocks, 1, reduce);
+    for (vtkIdType block = 0; block < numBlocks; ++block)
+    {
+      T value = offsets[block];
+      offsets[block] = init;
+      init = op(init, value);
+    }
+    vtk::detail::smp::vtkSMPTools_BlockScanFunctor<InputIt, OutputIt, T,
+      BinaryOp> scan(inBegin, outBegin, n, numBlocks, &offsets[0], op);
+    vtkSMPTools::For(0, numBlocks, 1, scan);
+    return init;
+  }
+
+  /**
+   * Parallel exclusive prefix sum of [inBegin, inEnd) starting at init.
+   * Returns the total sum.
+   */
+  template <typename InputIt, typename OutputIt, typename T>
+  static T ExclusiveScan(InputIt inBegin, InputIt inEnd, OutputIt outBegin,
+                         T init)
+  {
+    return vtkSMPTools::ExclusiveScan(inBegin, inEnd, outBegin, init,
+                                      std::plus<T>());
+  }
+
 };
 
 #endif
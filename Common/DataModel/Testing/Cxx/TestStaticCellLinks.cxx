@@ -18,6 +18,8 @@
 #include "vtkImageData.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkIdList.h"
 #include "vtkExtractGeometry.h"
 #include "vtkSphere.h"
 #include "vtkSphereSource.h"
@@ -191,5 +193,50 @@ int TestStaticCellLinks( int, char *[] )
     return EXIT_FAILURE;
   }
 
+  //----------------------------------------------------------------------------
+  // Polydata with vertices, lines and polygons. The cells of each cell array
+  // are numbered after those of the previous ones, and the cells using a
+  // point are listed in decreasing order.
+  vtkSmartPointer<vtkPolyData> mixed =
+    vtkSmartPointer<vtkPolyData>::New();
+  mixed->DeepCopy(pdata);
+  vtkSmartPointer<vtkCellArray> verts =
+    vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> lines =
+    vtkSmartPointer<vtkCellArray>::New();
+  for (vtkIdType ptId=0; ptId < mixed->GetNumberOfPoints(); ptId += 3)
+  {
+    verts->InsertNextCell(1, &ptId);
+    vtkIdType line[2] = {ptId, (ptId + 7) % mixed->GetNumberOfPoints()};
+    lines->InsertNextCell(2, line);
+  }
+  mixed->SetVerts(verts);
+  mixed->SetLines(lines);
+  mixed->BuildLinks();
+
+  slinks.Initialize();
+  slinks.BuildLinks(mixed);
+  vtkSmartPointer<vtkIdList> pointCells =
+    vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType ptId=0; ptId < mixed->GetNumberOfPoints(); ++ptId)
+  {
+    mixed->GetPointCells(ptId, pointCells);
+    numCells = slinks.GetNumberOfCells(ptId);
+    cells = slinks.GetCells(ptId);
+    if ( numCells != pointCells->GetNumberOfIds() )
+    {
+      cout << "Wrong number of cells for point " << ptId << "\n";
+      return EXIT_FAILURE;
+    }
+    for (int i=0; i<numCells; ++i)
+    {
+      if ( cells[i] != pointCells->GetId(numCells-1-i) )
+      {
+        cout << "Wrong cells for point " << ptId << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,197 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestStaticCellLocator.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkCellLocator.h"
+#include "vtkGenericCell.h"
+#include "vtkIdList.h"
+#include "vtkImageData.h"
+#include "vtkMath.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkStaticCellLocator.h"
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+
+// Locate many points concurrently, each thread using its own generic cell.
+struct FindCells
+{
+  vtkStaticCellLocator *Locator;
+  const double *Points;
+  vtkIdType *CellIds;
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+
+  void operator()(vtkIdType ptId, vtkIdType end)
+  {
+    vtkGenericCell *cell = this->Cell.Local();
+    double pcoords[3], weights[8], x[3];
+    for ( ; ptId < end; ++ptId)
+    {
+      std::copy(this->Points + 3*ptId, this->Points + 3*ptId + 3, x);
+      this->CellIds[ptId] =
+        this->Locator->FindCell(x, 0.0, cell, pcoords, weights);
+    }
+  }
+};
+
+}
+
+// Compare the results of the static cell locator with the image data own
+// (analytic) cell location and with vtkCellLocator.
+int TestStaticCellLocator(int, char *[])
+{
+  vtkSmartPointer<vtkImageData> volume =
+    vtkSmartPointer<vtkImageData>::New();
+  volume->SetDimensions(21,16,11);
+  volume->SetSpacing(0.5,1.0,2.0);
+  volume->SetOrigin(-1.0,2.0,0.0);
+
+  vtkSmartPointer<vtkStaticCellLocator> locator =
+    vtkSmartPointer<vtkStaticCellLocator>::New();
+  locator->SetDataSet(volume);
+  locator->BuildLocator();
+
+  vtkSmartPointer<vtkCellLocator> cellLocator =
+    vtkSmartPointer<vtkCellLocator>::New();
+  cellLocator->SetDataSet(volume);
+  cellLocator->BuildLocator();
+
+  double bounds[6];
+  volume->GetBounds(bounds);
+
+  // Random points within the volume, located concurrently
+  const vtkIdType numPts = 5000;
+  std::vector<double> points(3*numPts);
+  vtkMath::RandomSeed(31415);
+  for (vtkIdType i=0; i < numPts; ++i)
+  {
+    for (int j=0; j < 3; ++j)
+    {
+      points[3*i+j] = vtkMath::Random(bounds[2*j], bounds[2*j+1]);
+    }
+  }
+  std::vector<vtkIdType> cellIds(numPts);
+  FindCells finder;
+  finder.Locator = locator;
+  finder.Points = &points[0];
+  finder.CellIds = &cellIds[0];
+  vtkSMPTools::For(0, numPts, finder);
+
+  vtkSmartPointer<vtkGenericCell> cell =
+    vtkSmartPointer<vtkGenericCell>::New();
+  double pcoords[3], weights[8];
+  int subId;
+  for (vtkIdType i=0; i < numPts; ++i)
+  {
+    vtkIdType expected = volume->FindCell(&points[3*i], NULL, cell, -1,
+                                          0.0, subId, pcoords, weights);
+    if ( cellIds[i] != expected )
+    {
+      cerr << "FindCell: expected cell " << expected << " but got "
+           << cellIds[i] << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A point outside the volume is not located
+  double outside[3] = {-5.0, 0.0, 0.0};
+  if ( locator->FindCell(outside) != -1 )
+  {
+    cerr << "FindCell: found a cell for a point outside the volume\n";
+    return EXIT_FAILURE;
+  }
+
+  // Closest points of points outside the volume
+  double closest[3], closest2[3], dist2, dist22;
+  vtkIdType cellId, cellId2;
+  for (int i=0; i < 20; ++i)
+  {
+    double x[3];
+    for (int j=0; j < 3; ++j)
+    {
+      x[j] = vtkMath::Random(bounds[2*j] - 10.0, bounds[2*j+1] + 10.0);
+    }
+    locator->FindClosestPoint(x, closest, cell, cellId, subId, dist2);
+    cellLocator->FindClosestPoint(x, closest2, cell, cellId2, subId, dist22);
+    if ( cellId < 0 || fabs(dist2 - dist22) > 1.0e-6 * (1.0 + dist22) )
+    {
+      cerr << "FindClosestPoint: distance " << dist2 << " (cell " << cellId
+           << ") instead of " << dist22 << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Within a radius
+  int inside;
+  double x[3] = {bounds[0] - 1.0, bounds[2], bounds[4]};
+  if ( locator->FindClosestPointWithinRadius(x, 0.5, closest, cell, cellId,
+                                             subId, dist2, inside) != 0 ||
+       locator->FindClosestPointWithinRadius(x, 1.5, closest, cell, cellId,
+                                             subId, dist2, inside) != 1 ||
+       cellId != 0 || fabs(dist2 - 1.0) > 1.0e-9 || inside != 0 )
+  {
+    cerr << "FindClosestPointWithinRadius: wrong result\n";
+    return EXIT_FAILURE;
+  }
+
+  // The cells along a line must contain the cells containing points of the
+  // line.
+  double p1[3] = {bounds[0] - 1.0, bounds[2] + 0.3, bounds[4] + 0.7};
+  double p2[3] = {bounds[1] + 1.0, bounds[3] - 0.1, bounds[5] - 3.3};
+  vtkSmartPointer<vtkIdList> lineCells = vtkSmartPointer<vtkIdList>::New();
+  locator->FindCellsAlongLine(p1, p2, 0.0, lineCells);
+  for (int i=0; i <= 100; ++i)
+  {
+    double t = i / 100.0;
+    for (int j=0; j < 3; ++j)
+    {
+      x[j] = p1[j] + t * (p2[j] - p1[j]);
+    }
+    cellId = volume->FindCell(x, NULL, cell, -1, 0.0, subId, pcoords,
+                              weights);
+    if ( cellId >= 0 && lineCells->IsId(cellId) < 0 )
+    {
+      cerr << "FindCellsAlongLine: missing cell " << cellId << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // The first cell hit by the line
+  double t, t2;
+  if ( !locator->IntersectWithLine(p1, p2, 0.0, t, x, pcoords, subId,
+                                   cellId, cell) ||
+       !cellLocator->IntersectWithLine(p1, p2, 0.0, t2, closest, pcoords,
+                                       subId, cellId2, cell) ||
+       fabs(t - t2) > 1.0e-9 || fabs(x[0] - bounds[0]) > 1.0e-9 )
+  {
+    cerr << "IntersectWithLine: wrong intersection\n";
+    return EXIT_FAILURE;
+  }
+
+  // All the cells within some bounds
+  double bbox[6] = {0.1, 0.9, 2.1, 3.9, 0.1, 0.2};
+  locator->FindCellsWithinBounds(bbox, lineCells);
+  if ( lineCells->GetNumberOfIds() != 4 )
+  {
+    cerr << "FindCellsWithinBounds: found " << lineCells->GetNumberOfIds()
+         << " cells instead of 4\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,7 @@
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkQuad.h"
+#include "vtkTypeInt32Array.h"
 
 #include <sstream>
 
@@ -72,10 +73,102 @@ int TestCellArray(ostream& strm)
   strm << "ca->GetSize() = " << ca->GetSize() << endl;
   strm << "ca->GetNumberOfConnectivityEntries() = " << ca->GetNumberOfConnectivityEntries() << endl;
 
+  // Random access through the cell locations
+  ca->BuildCellLocations();
+  strm << "ca->HasCellLocations() = " << ca->HasCellLocations() << endl;
+  vtkIdType nextCell[4] = {6, 7, 8, 9};
+  ca->InsertNextCell(4, nextCell);
+  vtkIdType expectedLocations[4] = {0, 4, 8, 12};
+  vtkIdType *cellPts;
+  for (vtkIdType cellId = 0; cellId < 4; ++cellId)
+  {
+    ca->GetCellAtId(cellId, npts, cellPts);
+    if (ca->GetCellLocation(cellId) != expectedLocations[cellId] ||
+        cellPts != ca->GetPointer() + expectedLocations[cellId] + 1)
+    {
+      strm << "Bad location for cell " << cellId << endl;
+      return 1;
+    }
+  }
+
+  // Offsets + connectivity round trip, with 32-bit ids
+  vtkTypeInt32Array *offsets = vtkTypeInt32Array::New();
+  vtkTypeInt32Array *connectivity = vtkTypeInt32Array::New();
+  if (!ca->ExportOffsetsAndConnectivity(offsets, connectivity) ||
+      offsets->GetNumberOfTuples() != 5 ||
+      offsets->GetValue(4) != 13 ||
+      connectivity->GetNumberOfTuples() != 13 ||
+      connectivity->GetValue(12) != 9)
+  {
+    strm << "Bad offsets and connectivity export" << endl;
+    return 1;
+  }
+  vtkCellArray *ca2 = vtkCellArray::New();
+  if (!ca2->SetData(offsets, connectivity) ||
+      ca2->GetNumberOfCells() != 4 ||
+      !ca2->HasCellLocations() ||
+      ca2->GetNumberOfConnectivityEntries() !=
+        ca->GetNumberOfConnectivityEntries())
+  {
+    strm << "Bad offsets and connectivity import" << endl;
+    return 1;
+  }
+  for (vtkIdType i = 0; i < ca->GetNumberOfConnectivityEntries(); ++i)
+  {
+    if (ca->GetPointer()[i] != ca2->GetPointer()[i])
+    {
+      strm << "Bad connectivity after import" << endl;
+      return 1;
+    }
+  }
+  ca2->GetCellAtId(3, ids);
+  if (ids->GetNumberOfIds() != 4 || ids->GetId(0) != 6)
+  {
+    strm << "Bad cell after import" << endl;
+    return 1;
+  }
+
+  // Invalid offsets are rejected, leaving the cells unchanged
+  vtkTypeInt32 validOffsets[5] = {0, 3, 6, 9, 13};
+  vtkTypeInt32 invalidOffsets[3][5] = {
+    {1, 3, 6, 9, 13}, {0, 6, 3, 9, 13}, {0, 3, 6, 9, 14}};
+  for (int i = 0; i < 3; ++i)
+  {
+    for (vtkIdType j = 0; j < 5; ++j)
+    {
+      offsets->SetValue(j, invalidOffsets[i][j]);
+    }
+    if (ca2->SetData(offsets, connectivity) || ca2->GetNumberOfCells() != 4)
+    {
+      strm << "Invalid offsets accepted" << endl;
+      return 1;
+    }
+  }
+  for (vtkIdType j = 0; j < 5; ++j)
+  {
+    offsets->SetValue(j, validOffsets[j]);
+  }
+  if (!ca2->SetData(offsets, connectivity))
+  {
+    strm << "Valid offsets rejected" << endl;
+    return 1;
+  }
+
+  // Reallocating the connectivity list discards the cell locations
+  ca2->Allocate(100);
+  if (ca2->HasCellLocations())
+  {
+    strm << "Cell locations kept after Allocate()" << endl;
+    return 1;
+  }
+
   ca->Delete();
+  ca2->Delete();
   cell->Delete();
   ids->Delete();
   cells->Delete();
+  offsets->Delete();
+  connectivity->Delete();
   strm << "Test CellArray Complete" << endl;
 
   return 0;
@@ -14,9 +14,235 @@
 =========================================================================*/
 #include "vtkCellArray.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPTools.h"
+#include "vtkTypeInt64Array.h"
 
 vtkStandardNewMacro(vtkCellArray);
 
+namespace {
+
+// Largest connectivity list that can be indexed with 32-bit locations.
+const vtkIdType VTK_CELL_ARRAY_MAX_LOCATION32 = VTK_TYPE_INT32_MAX;
+
+//----------------------------------------------------------------------------
+// Converts the offsets + connectivity layout into the interleaved one, cell
+// by cell. Cell i starts at offsets[i]+i in the interleaved list, which also
+// gives the cell locations for free.
+template <typename TIds>
+struct ImportCells
+{
+  const TIds *Offsets;
+  const TIds *Connectivity;
+  vtkIdType *Ia;
+  vtkTypeInt32 *Locations32;
+  vtkIdType *Locations64;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      vtkIdType offset = static_cast<vtkIdType>(this->Offsets[cellId]);
+      vtkIdType npts =
+        static_cast<vtkIdType>(this->Offsets[cellId+1]) - offset;
+      if (this->Locations32)
+      {
+        this->Locations32[cellId] = static_cast<vtkTypeInt32>(offset + cellId);
+      }
+      else
+      {
+        this->Locations64[cellId] = offset + cellId;
+      }
+      vtkIdType *cell = this->Ia + offset + cellId;
+      *cell++ = npts;
+      const TIds *ids = this->Connectivity + offset;
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        cell[i] = static_cast<vtkIdType>(ids[i]);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// The reverse operation, using the cell locations.
+template <typename TIds>
+struct ExportCells
+{
+  vtkCellArray *Array;
+  TIds *Offsets;
+  TIds *Connectivity;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts, *pts;
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      vtkIdType offset = this->Array->GetCellLocation(cellId) - cellId;
+      this->Array->GetCellAtId(cellId, npts, pts);
+      this->Offsets[cellId] = static_cast<TIds>(offset);
+      TIds *ids = this->Connectivity + offset;
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        ids[i] = static_cast<TIds>(pts[i]);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Largest point id, used to check that the ids fit in 32 bits.
+struct MaxPointId
+{
+  vtkCellArray *Array;
+  vtkSMPThreadLocal<vtkIdType> LocalMax;
+
+  MaxPointId() : LocalMax(-1) {}
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType &maxId = this->LocalMax.Local();
+    vtkIdType npts, *pts;
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      this->Array->GetCellAtId(cellId, npts, pts);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        maxId = (pts[i] > maxId ? pts[i] : maxId);
+      }
+    }
+  }
+
+  vtkIdType Reduce()
+  {
+    vtkIdType maxId = -1;
+    vtkSMPThreadLocal<vtkIdType>::iterator itr;
+    for (itr = this->LocalMax.begin(); itr != this->LocalMax.end(); ++itr)
+    {
+      maxId = (*itr > maxId ? *itr : maxId);
+    }
+    return maxId;
+  }
+};
+
+//----------------------------------------------------------------------------
+// Check that the offsets never decrease.
+template <typename TIds>
+struct CheckOffsets
+{
+  const TIds *Offsets;
+  vtkSMPThreadLocal<bool> LocalValid;
+
+  CheckOffsets() : LocalValid(true) {}
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    bool &valid = this->LocalValid.Local();
+    for ( ; valid && cellId < endCellId; ++cellId)
+    {
+      valid = this->Offsets[cellId] <= this->Offsets[cellId+1];
+    }
+  }
+
+  bool Reduce()
+  {
+    vtkSMPThreadLocal<bool>::iterator itr;
+    for (itr = this->LocalValid.begin(); itr != this->LocalValid.end(); ++itr)
+    {
+      if (!*itr)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+//----------------------------------------------------------------------------
+template <typename TIds, typename TArray>
+bool ImportCellArray(TArray *offsets, vtkDataArray *connectivity,
+                     vtkIdTypeArray *ia, vtkDataArray *&locations)
+{
+  TArray *conn = vtkArrayDownCast<TArray>(connectivity);
+  if (!conn || offsets->GetNumberOfTuples() < 1)
+  {
+    return false;
+  }
+  vtkIdType numCells = offsets->GetNumberOfTuples() - 1;
+  const TIds *o = offsets->GetPointer(0);
+  vtkIdType connSize = static_cast<vtkIdType>(o[numCells]);
+  if (o[0] != 0 || connSize > conn->GetNumberOfTuples())
+  {
+    return false;
+  }
+  CheckOffsets<TIds> check;
+  check.Offsets = o;
+  vtkSMPTools::For(0, numCells, check);
+  if (!check.Reduce())
+  {
+    return false;
+  }
+
+  ImportCells<TIds> import;
+  import.Offsets = o;
+  import.Connectivity = conn->GetPointer(0);
+  import.Ia = ia->WritePointer(0, connSize + numCells);
+  import.Locations32 = NULL;
+  import.Locations64 = NULL;
+  if (connSize + numCells <= VTK_CELL_ARRAY_MAX_LOCATION32)
+  {
+    vtkTypeInt32Array *locs = vtkTypeInt32Array::New();
+    import.Locations32 = locs->WritePointer(0, numCells);
+    locations = locs;
+  }
+  else
+  {
+    vtkIdTypeArray *locs = vtkIdTypeArray::New();
+    import.Locations64 = locs->WritePointer(0, numCells);
+    locations = locs;
+  }
+  vtkSMPTools::For(0, numCells, import);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+template <typename TIds, typename TArray>
+bool ExportCellArray(TArray *offsets, vtkDataArray *connectivity,
+                     vtkCellArray *ca, vtkIdType numCells)
+{
+  TArray *conn = vtkArrayDownCast<TArray>(connectivity);
+  if (!conn)
+  {
+    return false;
+  }
+  vtkIdType connSize = ca->GetNumberOfConnectivityEntries() - numCells;
+  if (sizeof(TIds) < sizeof(vtkIdType))
+  {
+    MaxPointId maxPointId;
+    maxPointId.Array = ca;
+    vtkSMPTools::For(0, numCells, maxPointId);
+    if (connSize > VTK_CELL_ARRAY_MAX_LOCATION32 ||
+        maxPointId.Reduce() > VTK_CELL_ARRAY_MAX_LOCATION32)
+    {
+      return false;
+    }
+  }
+
+  offsets->SetNumberOfComponents(1);
+  offsets->SetNumberOfTuples(numCells + 1);
+  conn->SetNumberOfComponents(1);
+  conn->SetNumberOfTuples(connSize);
+
+  ExportCells<TIds> exporter;
+  exporter.Array = ca;
+  exporter.Offsets = offsets->GetPointer(0);
+  exporter.Connectivity = conn->GetPointer(0);
+  vtkSMPTools::For(0, numCells, exporter);
+  exporter.Offsets[numCells] = static_cast<TIds>(connSize);
+  return true;
+}
+
+} // anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkCellArray::vtkCellArray()
 {
@@ -24,6 +250,8 @@ vtkCellArray::vtkCellArray()
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
+  this->Locations32 = NULL;
+  this->Locations64 = NULL;
 }
 
 //----------------------------------------------------------------------------
@@ -35,21 +263,34 @@ void vtkCellArray::DeepCopy (vtkCellArray *ca)
     return;
   }
 
+  this->DeleteCellLocations();
   this->Ia->DeepCopy(ca->Ia);
   this->NumberOfCells = ca->NumberOfCells;
   this->InsertLocation = ca->InsertLocation;
   this->TraversalLocation = ca->TraversalLocation;
+  if (ca->Locations32)
+  {
+    this->Locations32 = vtkTypeInt32Array::New();
+    this->Locations32->DeepCopy(ca->Locations32);
+  }
+  else if (ca->Locations64)
+  {
+    this->Locations64 = vtkIdTypeArray::New();
+    this->Locations64->DeepCopy(ca->Locations64);
+  }
 }
 
 //----------------------------------------------------------------------------
 vtkCellArray::~vtkCellArray()
 {
+  this->DeleteCellLocations();
   this->Ia->Delete();
 }
 
 //----------------------------------------------------------------------------
 void vtkCellArray::Initialize()
 {
+  this->DeleteCellLocations();
   this->Ia->Initialize();
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
@@ -80,6 +321,7 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
   if ( cells && cells != this->Ia )
   {
     this->Modified();
+    this->DeleteCellLocations();
     this->Ia->Delete();
     this->Ia = cells;
     this->Ia->Register(this);
@@ -90,10 +332,200 @@ void vtkCellArray::SetCells(vtkIdType ncells, vtkIdTypeArray *cells)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkCellArray::BuildCellLocations()
+{
+  if (this->HasCellLocations())
+  {
+    return;
+  }
+
+  // The locations can only be found by walking the list, but this is a
+  // one time cost that makes all subsequent cell accesses O(1).
+  vtkIdType numCells = this->NumberOfCells;
+  const vtkIdType *ia = this->Ia->GetPointer(0);
+  vtkIdType loc = 0;
+  if (this->Ia->GetMaxId() < VTK_CELL_ARRAY_MAX_LOCATION32)
+  {
+    this->Locations32 = vtkTypeInt32Array::New();
+    vtkTypeInt32 *locs = this->Locations32->WritePointer(0, numCells);
+    for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+    {
+      locs[cellId] = static_cast<vtkTypeInt32>(loc);
+      loc += ia[loc] + 1;
+    }
+  }
+  else
+  {
+    this->Locations64 = vtkIdTypeArray::New();
+    vtkIdType *locs = this->Locations64->WritePointer(0, numCells);
+    for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+    {
+      locs[cellId] = loc;
+      loc += ia[loc] + 1;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::DeleteCellLocations()
+{
+  if (this->Locations32)
+  {
+    this->Locations32->Delete();
+    this->Locations32 = NULL;
+  }
+  if (this->Locations64)
+  {
+    this->Locations64->Delete();
+    this->Locations64 = NULL;
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkDataArray* vtkCellArray::GetCellLocationsArray()
+{
+  if (this->Locations32)
+  {
+    return this->Locations32;
+  }
+  return this->Locations64;
+}
+
+//----------------------------------------------------------------------------
+// Append the location of a new cell, switching to 64-bit locations when the
+// connectivity list outgrows the 32-bit range.
+void vtkCellArray::InsertCellLocation(vtkIdType loc)
+{
+  if (this->Locations32 && loc > VTK_CELL_ARRAY_MAX_LOCATION32)
+  {
+    vtkIdType numLocs = this->Locations32->GetNumberOfTuples();
+    this->Locations64 = vtkIdTypeArray::New();
+    this->Locations64->Allocate(2 * (numLocs + 1));
+    vtkIdType *locs = this->Locations64->WritePointer(0, numLocs);
+    const vtkTypeInt32 *locs32 = this->Locations32->GetPointer(0);
+    std::copy(locs32, locs32 + numLocs, locs);
+    this->Locations32->Delete();
+    this->Locations32 = NULL;
+  }
+
+  if (this->Locations32)
+  {
+    this->Locations32->InsertNextValue(static_cast<vtkTypeInt32>(loc));
+  }
+  else
+  {
+    this->Locations64->InsertNextValue(loc);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdList *pts)
+{
+  vtkIdType npts, *ppts;
+  this->GetCellAtId(cellId, npts, ppts);
+  pts->SetNumberOfIds(npts);
+  for (vtkIdType i = 0; i < npts; i++)
+  {
+    pts->SetId(i, ppts[i]);
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkCellArray::SetData(vtkDataArray *offsets, vtkDataArray *connectivity)
+{
+  if (!offsets || !connectivity ||
+      offsets->GetNumberOfComponents() != 1 ||
+      connectivity->GetNumberOfComponents() != 1)
+  {
+    return false;
+  }
+
+  vtkIdTypeArray *ia = vtkIdTypeArray::New();
+  vtkDataArray *locations = NULL;
+  bool success = false;
+  if (vtkTypeInt32Array *o32 = vtkArrayDownCast<vtkTypeInt32Array>(offsets))
+  {
+    success = ImportCellArray<vtkTypeInt32>(o32, connectivity, ia, locations);
+  }
+  else if (vtkIdTypeArray *oId = vtkArrayDownCast<vtkIdTypeArray>(offsets))
+  {
+    success = ImportCellArray<vtkIdType>(oId, connectivity, ia, locations);
+  }
+  else if (vtkTypeInt64Array *o64 =
+           vtkArrayDownCast<vtkTypeInt64Array>(offsets))
+  {
+    success = ImportCellArray<vtkTypeInt64>(o64, connectivity, ia, locations);
+  }
+
+  if (success)
+  {
+    this->SetCells(offsets->GetNumberOfTuples() - 1, ia);
+    this->Locations32 = vtkArrayDownCast<vtkTypeInt32Array>(locations);
+    this->Locations64 = vtkArrayDownCast<vtkIdTypeArray>(locations);
+  }
+  else if (locations)
+  {
+    locations->Delete();
+  }
+  ia->Delete();
+  return success;
+}
+
+//----------------------------------------------------------------------------
+bool vtkCellArray::ExportOffsetsAndConnectivity(vtkDataArray *offsets,
+                                                vtkDataArray *connectivity)
+{
+  if (!offsets || !connectivity)
+  {
+    return false;
+  }
+
+  this->BuildCellLocations();
+  vtkIdType numCells = this->NumberOfCells;
+  if (vtkTypeInt32Array *o32 = vtkArrayDownCast<vtkTypeInt32Array>(offsets))
+  {
+    return ExportCellArray<vtkTypeInt32>(o32, connectivity, this, numCells);
+  }
+  else if (vtkIdTypeArray *oId = vtkArrayDownCast<vtkIdTypeArray>(offsets))
+  {
+    return ExportCellArray<vtkIdType>(oId, connectivity, this, numCells);
+  }
+  else if (vtkTypeInt64Array *o64 =
+           vtkArrayDownCast<vtkTypeInt64Array>(offsets))
+  {
+    return ExportCellArray<vtkTypeInt64>(o64, connectivity, this, numCells);
+  }
+  return false;
+}
+
+//----------------------------------------------------------------------------
+void vtkCellArray::Squeeze()
+{
+  this->Ia->Squeeze();
+  if (this->Locations32)
+  {
+    this->Locations32->Squeeze();
+  }
+  if (this->Locations64)
+  {
+    this->Locations64->Squeeze();
+  }
+}
+
 //----------------------------------------------------------------------------
 unsigned long vtkCellArray::GetActualMemorySize()
 {
-  return this->Ia->GetActualMemorySize();
+  unsigned long size = this->Ia->GetActualMemorySize();
+  if (this->Locations32)
+  {
+    size += this->Locations32->GetActualMemorySize();
+  }
+  if (this->Locations64)
+  {
+    size += this->Locations64->GetActualMemorySize();
+  }
+  return size;
 }
 
 //----------------------------------------------------------------------------
@@ -132,4 +564,7 @@ void vtkCellArray::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Number Of Cells: " << this->NumberOfCells << endl;
   os << indent << "Insert Location: " << this->InsertLocation << endl;
   os << indent << "Traversal Location: " << this->TraversalLocation << endl;
+  os << indent << "Cell Locations: "
+     << (this->Locations32 ? "32-bit" : (this->Locations64 ? "64-bit" : "(none)"))
+     << endl;
 }
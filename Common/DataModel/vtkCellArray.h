@@ -28,6 +28,21 @@
  * using the vtkCellTypes and vtkCellLinks objects to extend the definition of
  * the data structure.
  *
+ * Alternatively, an index of cell locations (the offset of each cell in the
+ * connectivity list) can be built with BuildCellLocations(). The locations
+ * are stored with 32-bit integers whenever the connectivity list is small
+ * enough, and they are kept up to date as cells are appended. Once built,
+ * GetCellAtId() provides O(1) random access to any cell. It does not touch
+ * the traversal state, so it can be called concurrently, e.g. from
+ * vtkSMPTools functors splitting work by cell id.
+ *
+ * Cells can also be exchanged with the offsets + connectivity layout used
+ * by many external codes (see SetData() and ExportOffsetsAndConnectivity()),
+ * where the offsets array has one entry per cell plus a final entry equal to
+ * the connectivity size, and the connectivity array holds the point ids of
+ * all the cells without the point counts. Both directions are threaded, and
+ * 32-bit arrays can be used when the mesh fits, halving memory use.
+ *
  * @sa
  * vtkCellTypes vtkCellLinks
 */
@@ -39,8 +54,11 @@
 #include "vtkObject.h"
 
 #include "vtkIdTypeArray.h" // Needed for inline methods
+#include "vtkTypeInt32Array.h" // Needed for inline methods
 #include "vtkCell.h" // Needed for inline methods
 
+class vtkDataArray;
+
 class VTKCOMMONDATAMODEL_EXPORT vtkCellArray : public vtkObject
 {
 public:
@@ -53,10 +71,11 @@ public:
   static vtkCellArray *New();
 
   /**
-   * Allocate memory and set the size to extend by.
+   * Allocate memory and set the size to extend by. This discards the cell
+   * locations.
    */
   int Allocate(const vtkIdType sz, const int ext=1000)
-    {return this->Ia->Allocate(sz,ext);}
+    {this->DeleteCellLocations(); return this->Ia->Allocate(sz,ext);}
 
   /**
    * Free any memory and reset to an empty state.
@@ -136,6 +155,68 @@ public:
    */
   void GetCell(vtkIdType loc, vtkIdList* pts);
 
+  //@{
+  /**
+   * Build an index of the cell locations, enabling random access to the
+   * cells with GetCellAtId() and GetCellLocation(). The index is maintained
+   * as cells are inserted with InsertNextCell(), and discarded by methods
+   * that replace the whole connectivity list (SetCells(), WritePointer(),
+   * Allocate(), Reset() and Initialize()). It is not updated when the list
+   * is modified through GetPointer() or GetData(): call
+   * DeleteCellLocations() after changing the cell sizes that way.
+   * BuildCellLocations() does nothing if the index is already available.
+   * These methods are not thread safe.
+   */
+  void BuildCellLocations();
+  void DeleteCellLocations();
+  bool HasCellLocations()
+    {return this->Locations32 != NULL || this->Locations64 != NULL;}
+  //@}
+
+  /**
+   * Return the array of cell locations, a vtkTypeInt32Array when the
+   * connectivity list fits in 32-bit integers and a vtkIdTypeArray
+   * otherwise. Returns NULL if BuildCellLocations() has not been called.
+   */
+  vtkDataArray* GetCellLocationsArray();
+
+  /**
+   * Return the location of the cell cellId in the connectivity list, for use
+   * with GetCell(loc,...), ReverseCell() or ReplaceCell().
+   * BuildCellLocations() must have been called. Thread safe.
+   */
+  vtkIdType GetCellLocation(vtkIdType cellId);
+
+  /**
+   * Random access to the cell cellId. BuildCellLocations() must have been
+   * called. Unlike GetNextCell() these methods do not modify the state of
+   * the cell array and are therefore thread safe.
+   */
+  void GetCellAtId(vtkIdType cellId, vtkIdType &npts, vtkIdType* &pts);
+  void GetCellAtId(vtkIdType cellId, vtkIdList *pts);
+
+  /**
+   * Define the cells from an offsets + connectivity layout. The offsets
+   * array has numberOfCells+1 entries, cell i being made of the point ids
+   * connectivity[offsets[i]] to connectivity[offsets[i+1]-1]. Both arrays
+   * must be single component vtkTypeInt32Array, vtkTypeInt64Array or
+   * vtkIdTypeArray. The connectivity list is built in parallel and the cell
+   * locations are available afterwards. Returns false (leaving the cell
+   * array unchanged) if the arrays are not supported, or if the offsets do
+   * not start at 0, decrease, or exceed the size of the connectivity.
+   */
+  bool SetData(vtkDataArray *offsets, vtkDataArray *connectivity);
+
+  /**
+   * Fill the given arrays with the offsets + connectivity layout of the
+   * cells (see SetData()). Use vtkTypeInt32Array instances to store the
+   * layout with 32-bit integers; this fails if some point id or the
+   * connectivity size cannot be represented. Builds the cell locations if
+   * needed. Returns false if the arrays are not supported.
+   */
+  bool ExportOffsetsAndConnectivity(vtkDataArray *offsets,
+                                    vtkDataArray *connectivity);
+
   /**
    * Insert a cell object. Return the cell id of the cell.
    */
@@ -216,7 +297,9 @@ public:
   int GetMaxCellSize();
 
   /**
-   * Get pointer to array of cell data.
+   * Get pointer to array of cell data. The cell locations are not updated
+   * when cells are modified through this pointer (see
+   * DeleteCellLocations()).
    */
   vtkIdType *GetPointer()
     {return this->Ia->GetPointer(0);}
@@ -245,7 +328,9 @@ public:
   void DeepCopy(vtkCellArray *ca);
 
   /**
-   * Return the underlying data as a data array.
+   * Return the underlying data as a data array. The cell locations are not
+   * updated when cells are modified through this array (see
+   * DeleteCellLocations()).
    */
   vtkIdTypeArray* GetData()
     {return this->Ia;}
@@ -258,8 +343,7 @@ public:
   /**
    * Reclaim any extra memory.
    */
-  void Squeeze()
-    {this->Ia->Squeeze();}
+  void Squeeze();
 
   /**
    * Return the memory in kibibytes (1024 bytes) consumed by this cell array. Used to
@@ -280,6 +364,12 @@ protected:
   vtkIdType TraversalLocation;   //keep track of traversal position
   vtkIdTypeArray *Ia;
 
+  // Optional index of the cell locations in Ia. At most one of them is
+  // allocated, the 32-bit version being used while Ia is small enough.
+  vtkTypeInt32Array *Locations32;
+  vtkIdTypeArray *Locations64;
+  void InsertCellLocation(vtkIdType loc);
+
 private:
   vtkCellArray(const vtkCellArray&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCellArray&) VTK_DELETE_FUNCTION;
@@ -299,6 +389,10 @@ inline vtkIdType vtkCellArray::InsertNextCell(vtkIdType npts,
   }
 
   this->NumberOfCells++;
+  if (this->HasCellLocations())
+  {
+    this->InsertCellLocation(this->Ia->GetMaxId() - npts);
+  }
   this->InsertLocation += npts + 1;
 
   return this->NumberOfCells - 1;
@@ -309,6 +403,10 @@ inline vtkIdType vtkCellArray::InsertNextCell(int npts)
 {
   this->InsertLocation = this->Ia->InsertNextValue(npts) + 1;
   this->NumberOfCells++;
+  if (this->HasCellLocations())
+  {
+    this->InsertCellLocation(this->InsertLocation - 1);
+  }
 
   return this->NumberOfCells - 1;
 }
@@ -341,6 +439,7 @@ inline vtkIdType vtkCellArray::InsertNextCell(vtkCell *cell)
 //----------------------------------------------------------------------------
 inline void vtkCellArray::Reset()
 {
+  this->DeleteCellLocations();
   this->NumberOfCells = 0;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
@@ -371,6 +470,23 @@ inline void vtkCellArray::GetCell(vtkIdType loc, vtkIdType &npts,
   pts  = this->Ia->GetPointer(loc);
 }
 
+//----------------------------------------------------------------------------
+inline vtkIdType vtkCellArray::GetCellLocation(vtkIdType cellId)
+{
+  return this->Locations32 ?
+    static_cast<vtkIdType>(this->Locations32->GetValue(cellId)) :
+    this->Locations64->GetValue(cellId);
+}
+
+//----------------------------------------------------------------------------
+inline void vtkCellArray::GetCellAtId(vtkIdType cellId, vtkIdType &npts,
+                                      vtkIdType* &pts)
+{
+  vtkIdType *cell = this->Ia->GetPointer(this->GetCellLocation(cellId));
+  npts = cell[0];
+  pts = cell + 1;
+}
+
 //----------------------------------------------------------------------------
 inline void vtkCellArray::ReverseCell(vtkIdType loc)
 {
@@ -401,6 +517,7 @@ inline void vtkCellArray::ReplaceCell(vtkIdType loc, int npts,
 inline vtkIdType *vtkCellArray::WritePointer(const vtkIdType ncells,
                                              const vtkIdType size)
 {
+  this->DeleteCellLocations();
   this->NumberOfCells = ncells;
   this->InsertLocation = 0;
   this->TraversalLocation = 0;
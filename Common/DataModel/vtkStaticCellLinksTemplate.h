@@ -38,6 +38,10 @@
  * although it uses vtkIdType and thereby loses some speed and memory
  * advantage.
  *
+ * The links of vtkPolyData and vtkUnstructuredGrid are built in parallel
+ * (via vtkSMPTools). Whatever the number of threads, the cells using a point
+ * are listed in decreasing cell id order.
+ *
  * @sa
  * vtkCellLinks vtkStaticCellLinks
 */
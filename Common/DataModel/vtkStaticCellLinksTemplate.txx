@@ -19,14 +19,212 @@
 
 #include "vtkCellArray.h"
 #include "vtkDataSet.h"
+#include "vtkIdTypeArray.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
 //----------------------------------------------------------------------------
-// Note: this class is a faster, serial version of vtkCellLinks. Future work
-// to parallelize this class is possible. This includes:
-// = using a parallel prefix sum operation
-// = using atomics to update counts (i.e., number of cells using a point)
+// Note: this class is a faster version of vtkCellLinks. The links of
+// polydata and unstructured grids are built in parallel: the uses of each
+// point are counted with atomics, a parallel prefix sum gives the offsets,
+// and the cells are then inserted concurrently. Each run of cell ids is
+// finally sorted so that the links are the same as when built serially
+// (i.e., in decreasing cell id order), whatever the number of threads. With
+// a single thread, plain counters are used and no sorting is needed.
+namespace vtk
+{
+namespace detail
+{
+namespace links
+{
+
+// Count the number of uses of each point by the cells of a cell array.
+// TCount is either TIds or std::atomic<TIds>.
+template <typename TCount>
+struct CountUses
+{
+  const vtkIdType *Cells;
+  const vtkIdType *Locations;
+  TCount *Counts;
+
+  CountUses(const vtkIdType *cells, const vtkIdType *locs, TCount *counts) :
+    Cells(cells), Locations(locs), Counts(counts)
+  {
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      const vtkIdType *cell = this->Cells + this->Locations[cellId];
+      vtkIdType npts = *cell++;
+      for (vtkIdType i=0; i < npts; ++i)
+      {
+        ++this->Counts[cell[i]];
+      }
+    }
+  }
+};
+
+// Insert the cells of a cell array in the runs of the points they use. Each
+// run is filled backwards from its end, the cursors pointing just past the
+// last free location.
+template <typename TIds, typename TCount>
+struct InsertLinks
+{
+  const vtkIdType *Cells;
+  const vtkIdType *Locations;
+  vtkIdType CellOffset;
+  TCount *Cursors;
+  TIds *Links;
+
+  InsertLinks(const vtkIdType *cells, const vtkIdType *locs,
+              vtkIdType cellOffset, TCount *cursors, TIds *links) :
+    Cells(cells), Locations(locs), CellOffset(cellOffset), Cursors(cursors),
+    Links(links)
+  {
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      const vtkIdType *cell = this->Cells + this->Locations[cellId];
+      vtkIdType npts = *cell++;
+      for (vtkIdType i=0; i < npts; ++i)
+      {
+        this->Links[--this->Cursors[cell[i]]] =
+          static_cast<TIds>(this->CellOffset + cellId);
+      }
+    }
+  }
+};
+
+// Point the cursors to the end of the runs of cell ids.
+template <typename TIds, typename TCount>
+struct InitializeCursors
+{
+  const TIds *Offsets;
+  TCount *Cursors;
+
+  InitializeCursors(const TIds *offsets, TCount *cursors) :
+    Offsets(offsets), Cursors(cursors)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      this->Cursors[ptId] = this->Offsets[ptId+1];
+    }
+  }
+};
+
+// Sort each run of cell ids in decreasing order.
+template <typename TIds>
+struct SortLinks
+{
+  const TIds *Offsets;
+  TIds *Links;
+
+  SortLinks(const TIds *offsets, TIds *links) :
+    Offsets(offsets), Links(links)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      // The runs are short and mostly sorted already since the threads
+      // insert contiguous ranges of cells: use an insertion sort.
+      TIds *links = this->Links + this->Offsets[ptId];
+      TIds *linksEnd = this->Links + this->Offsets[ptId+1];
+      for (TIds *link = links + 1; link < linksEnd; ++link)
+      {
+        TIds cellId = *link;
+        TIds *pos = link;
+        for ( ; pos > links && *(pos-1) < cellId; --pos)
+        {
+          *pos = *(pos-1);
+        }
+        *pos = cellId;
+      }
+    }
+  }
+};
+
+// Build the offsets and links from a set of cell arrays, the cells of each
+// array being numbered after those of the previous arrays. locs gives the
+// location of each cell in its cell array. The offsets must hold numPts+1
+// values, and the links as many values as there are point uses.
+template <typename TIds, typename TCount>
+void BuildLinks(vtkIdType numPts, int numArrays, const vtkIdType *numCells,
+                const vtkIdType *const *cells, const vtkIdType *const *locs,
+                TIds *offsets, TIds *links, bool sort)
+{
+  // The counts are value initialized, i.e. zeroed. They are then reused as
+  // the insertion cursors.
+  std::vector<TCount> counts(numPts);
+
+  int i;
+  for (i=0; i < numArrays; ++i)
+  {
+    CountUses<TCount> count(cells[i], locs[i], &counts[0]);
+    vtkSMPTools::For(0, numCells[i], count);
+  }
+
+  offsets[numPts] = vtkSMPTools::ExclusiveScan(counts.begin(), counts.end(),
+                                               offsets, static_cast<TIds>(0));
+
+  InitializeCursors<TIds, TCount> initialize(offsets, &counts[0]);
+  vtkSMPTools::For(0, numPts, initialize);
+  vtkIdType cellOffset = 0;
+  for (i=0; i < numArrays; ++i)
+  {
+    InsertLinks<TIds, TCount> insert(cells[i], locs[i], cellOffset,
+                                     &counts[0], links);
+    vtkSMPTools::For(0, numCells[i], insert);
+    cellOffset += numCells[i];
+  }
+
+  if ( sort )
+  {
+    SortLinks<TIds> sortLinks(offsets, links);
+    vtkSMPTools::For(0, numPts, sortLinks);
+  }
+}
+
+template <typename TIds>
+void BuildLinks(vtkIdType numPts, int numArrays, const vtkIdType *numCells,
+                const vtkIdType *const *cells, const vtkIdType *const *locs,
+                TIds *offsets, TIds *links)
+{
+  if ( numPts < 1 )
+  {
+    offsets[0] = 0;
+  }
+  else if ( vtkSMPTools::GetEstimatedNumberOfThreads() > 1 )
+  {
+    BuildLinks<TIds, std::atomic<TIds> >(numPts, numArrays, numCells, cells,
+                                         locs, offsets, links, true);
+  }
+  else
+  {
+    BuildLinks<TIds, TIds>(numPts, numArrays, numCells, cells, locs,
+                           offsets, links, false);
+  }
+}
+
+} // namespace links
+} // namespace detail
+} // namespace vtk
 
 //----------------------------------------------------------------------------
 // Clean up any previously allocated memory
@@ -129,60 +327,34 @@ BuildLinks(vtkUnstructuredGrid *ugrid)
 
   // We're going to get into the guts of the class
   vtkCellArray *cellArray = ugrid->GetCells();
-  const vtkIdType *cells = cellArray->GetPointer();
+  vtkIdType numCells = this->NumCells;
+  const vtkIdType *cells = NULL;
+  const vtkIdType *locs = NULL;
+  if ( cellArray != NULL && numCells > 0 )
+  {
+    cells = cellArray->GetPointer();
+    locs = ugrid->GetCellLocationsArray()->GetPointer(0);
+  }
 
   // I love this trick: the size of the Links array is equal to
   // the size of the cell array, minus the number of cells.
-  this->LinksSize =
-    cellArray->GetNumberOfConnectivityEntries() - this->NumCells;
+  this->LinksSize = ( cells == NULL ? 0 :
+    cellArray->GetNumberOfConnectivityEntries() - this->NumCells );
 
   // Extra one allocated to simplify later pointer manipulation
   this->Links = new TIds[this->LinksSize+1];
   this->Links[this->LinksSize] = this->NumPts;
   this->Offsets = new TIds[this->NumPts+1];
-  std::fill_n(this->Offsets, this->NumPts, 0);
 
   // Now create the links.
-  vtkIdType npts, cellId, ptId;
-  const vtkIdType *cell=cells;
-  int i;
-
-  // Count number of point uses
-  for ( cellId=0; cellId < this->NumCells; ++cellId )
-  {
-    npts = *cell++;
-    for (i=0; i<npts; ++i)
-    {
-      this->Offsets[*cell++]++;
-    }
-  }
-
-  // Perform prefix sum
-  for ( ptId=0; ptId < this->NumPts; ++ptId )
-  {
-    npts = this->Offsets[ptId+1];
-    this->Offsets[ptId+1] = this->Offsets[ptId] + npts;
-  }
-
-  // Now build the links. The summation from the prefix sum indicates where
-  // the cells are to be inserted. Each time a cell is inserted, the offset
-  // is decremented. In the end, the offset array is also constructed as it
-  // points to the beginning of each cell run.
-  for ( cell=cells, cellId=0; cellId < this->NumCells; ++cellId )
-  {
-    npts = *cell++;
-    for (i=0; i<npts; ++i)
-    {
-      this->Offsets[*cell]--;
-      this->Links[this->Offsets[*cell++]] = cellId;
-    }
-  }
-  this->Offsets[this->NumPts] = this->LinksSize;
+  vtk::detail::links::BuildLinks(this->NumPts, 1, &numCells, &cells, &locs,
+                                 this->Offsets, this->Links);
 }
 
 //----------------------------------------------------------------------------
 // Build the link list array for poly data. This is more complex because there
-// are potentially fout different cell arrays to contend with.
+// are potentially four different cell arrays to contend with. The cells of
+// each array are numbered after those of the previous arrays.
 template <typename TIds> void vtkStaticCellLinksTemplate<TIds>::
 BuildLinks(vtkPolyData *pd)
 {
@@ -192,82 +364,48 @@ BuildLinks(vtkPolyData *pd)
 
   vtkCellArray *cellArrays[4];
   vtkIdType numCells[4];
-  vtkIdType sizes[4];
-  int i, j;
+  const vtkIdType *cells[4];
+  std::vector<vtkIdType> locations[4];
+  const vtkIdType *locs[4];
+  int i;
 
   cellArrays[0] = pd->GetVerts();
   cellArrays[1] = pd->GetLines();
   cellArrays[2] = pd->GetPolys();
   cellArrays[3] = pd->GetStrips();
 
+  // The cell arrays do not store the location of their cells; find them
+  // with a quick traversal.
+  this->LinksSize = 0;
   for (i=0; i<4; ++i)
   {
-    if ( cellArrays[i] != NULL )
+    numCells[i] = 0;
+    cells[i] = NULL;
+    locs[i] = NULL;
+    if ( cellArrays[i] != NULL && cellArrays[i]->GetNumberOfCells() > 0 )
     {
       numCells[i] = cellArrays[i]->GetNumberOfCells();
-      sizes[i] = cellArrays[i]->GetNumberOfConnectivityEntries() - numCells[i];
-    }
-    else
-    {
-      numCells[i] = 0;
-      sizes[i] = 0;
+      cells[i] = cellArrays[i]->GetPointer();
+      this->LinksSize +=
+        cellArrays[i]->GetNumberOfConnectivityEntries() - numCells[i];
+      locations[i].resize(numCells[i]);
+      for (vtkIdType cellId=0, loc=0; cellId < numCells[i]; ++cellId)
+      {
+        locations[i][cellId] = loc;
+        loc += cells[i][loc] + 1;
+      }
+      locs[i] = &locations[i][0];
     }
   }//for the four polydata arrays
 
   // Allocate
-  this->LinksSize = sizes[0] + sizes[1] + sizes[2] + sizes[3];
   this->Links = new TIds[this->LinksSize+1];
   this->Links[this->LinksSize] = this->NumPts;
   this->Offsets = new TIds[this->NumPts+1];
-  this->Offsets[this->NumPts] = this->LinksSize;
-  std::fill_n(this->Offsets, this->NumPts, 0);
 
   // Now create the links.
-  vtkIdType npts, cellId, CellId, ptId;
-  const vtkIdType *cell;
-
-  // Visit the four arrays
-  for ( CellId=0, j=0; j < 4; ++j )
-  {
-    // Count number of point uses
-    cell = cellArrays[j]->GetPointer();
-    for ( cellId=0; cellId < numCells[j]; ++cellId )
-    {
-      npts = *cell++;
-      for (i=0; i<npts; ++i)
-      {
-        this->Offsets[CellId+(*cell++)]++;
-      }
-    }
-    CellId += numCells[j];
-  } //for each of the four polydata cell arrays
-
-  // Perform prefix sum
-  for ( ptId=0; ptId < this->NumPts; ++ptId )
-  {
-    npts = this->Offsets[ptId+1];
-    this->Offsets[ptId+1] = this->Offsets[ptId] + npts;
-  }
-
-  // Now build the links. The summation from the prefix sum indicates where
-  // the cells are to be inserted. Each time a cell is inserted, the offset
-  // is decremented. In the end, the offset array is also constructed as it
-  // points to the beginning of each cell run.
-  for ( CellId=0, j=0; j < 4; ++j )
-  {
-    cell = cellArrays[j]->GetPointer();
-    for ( cellId=0; cellId < numCells[j]; ++cellId )
-    {
-      npts = *cell++;
-      for (i=0; i<npts; ++i)
-      {
-        this->Offsets[*cell]--;
-        this->Links[this->Offsets[*cell++]] = CellId+cellId;
-      }
-    }
-    CellId += numCells[j];
-  }//for each of the four polydata arrays
-  this->Offsets[this->NumPts] = this->LinksSize;
+  vtk::detail::links::BuildLinks(this->NumPts, 4, numCells, cells, locs,
+                                 this->Offsets, this->Links);
 }
 
 #endif
@@ -0,0 +1,208 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkStaticCellLocator.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkStaticCellLocator
+ * @brief   perform fast cell location operations
+ *
+ * vtkStaticCellLocator is a type of vtkAbstractCellLocator that accelerates
+ * certain operations when performing spatial operations on cells. These
+ * operations include finding a point that contains a cell, and intersecting
+ * cells with a line.
+ *
+ * vtkStaticCellLocator is an accelerated version of vtkCellLocator. It is
+ * threaded (via vtkSMPTools), and supports one-time static construction
+ * (i.e., incremental cell insertion is not supported). It works by dividing
+ * a specified region of space into a regular array of cuboid buckets, and
+ * then keeping a list of the cells whose bounding box intersects each
+ * bucket. The construction mirrors vtkStaticPointLocator: the cell bounds
+ * are computed in parallel, each (cell,bucket) pair is recorded in a map
+ * which is sorted with vtkSMPTools::Sort(), and the offsets of each bucket
+ * into the sorted map are then computed in parallel.
+ *
+ * Once built, the query methods taking a vtkGenericCell (or returning only
+ * cell ids) do not modify the locator and may be invoked concurrently, for
+ * example from within a vtkSMPTools functor, provided that each thread uses
+ * its own vtkGenericCell. The other signatures use an internal cell and are
+ * not thread safe.
+ *
+ * @warning
+ * This class is templated. It may run slower than serial execution if the code
+ * is not optimized during compilation. Build in Release or ReleaseWithDebugInfo.
+ *
+ * @warning
+ * The cell bounds are always cached (i.e., the CacheCellBounds flag is
+ * ignored), which requires 48 bytes per cell.
+ *
+ * @warning
+ * The thread safe query methods call vtkDataSet::GetCell(cellId,genericCell).
+ * BuildLocator() makes sure that the internal structures of the dataset
+ * needed by this method are built (e.g., vtkPolyData::BuildCells()).
+ *
+ * @sa
+ * vtkAbstractCellLocator vtkCellLocator vtkCellTreeLocator vtkModifiedBSPTree
+ * vtkStaticPointLocator
+*/
+
+#ifndef vtkStaticCellLocator_h
+#define vtkStaticCellLocator_h
+
+#include "vtkCommonDataModelModule.h" // For export macro
+#include "vtkAbstractCellLocator.h"
+
+class vtkCellBinner;
+
+
+class VTKCOMMONDATAMODEL_EXPORT vtkStaticCellLocator : public vtkAbstractCellLocator
+{
+friend class vtkCellBinner;
+public:
+  /**
+   * Construct with automatic computation of divisions, averaging
+   * 10 cells per bucket.
+   */
+  static vtkStaticCellLocator *New();
+
+  //@{
+  /**
+   * Standard type and print methods.
+   */
+  vtkTypeMacro(vtkStaticCellLocator,vtkAbstractCellLocator);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+  //@}
+
+  //@{
+  /**
+   * Set the number of divisions in x-y-z directions. If the Automatic data
+   * member is enabled, the Divisions are set according to the
+   * NumberOfCellsPerNode data member.
+   */
+  vtkSetVector3Macro(Divisions,int);
+  vtkGetVectorMacro(Divisions,int,3);
+  //@}
+
+  // Re-use any superclass signatures that we don't override.
+  using vtkAbstractCellLocator::IntersectWithLine;
+  using vtkAbstractCellLocator::FindClosestPoint;
+  using vtkAbstractCellLocator::FindClosestPointWithinRadius;
+  using vtkAbstractCellLocator::FindCell;
+
+  /**
+   * Find the cell containing the point x. Returns -1 if no cell is found.
+   * tol2 is used to expand the cell bounds when looking for candidate cells.
+   * The parametric coordinates and interpolation weights of the point are
+   * returned in pcoords and weights, and the cell is copied into GenCell.
+   * This method is thread safe if BuildLocator() is directly or indirectly
+   * called from a single thread first.
+   */
+  vtkIdType FindCell(double x[3], double tol2, vtkGenericCell *GenCell,
+                     double pcoords[3], double *weights) VTK_OVERRIDE;
+
+  /**
+   * Return the closest point and the cell which is closest to the point x.
+   * The closest point is somewhere on a cell, it need not be one of the
+   * vertices of the cell. cellId is set to -1 if no cell is found. This
+   * method is thread safe if BuildLocator() is directly or indirectly called
+   * from a single thread first.
+   */
+  void FindClosestPoint(double x[3], double closestPoint[3],
+                        vtkGenericCell *cell, vtkIdType &cellId,
+                        int &subId, double& dist2) VTK_OVERRIDE;
+
+  /**
+   * Return the closest point within a specified radius and the cell which is
+   * closest to the point x. Returns 1 if a point is found within the radius,
+   * and 0 otherwise. See vtkAbstractCellLocator for a description of the
+   * parameters. This method is thread safe if BuildLocator() is directly or
+   * indirectly called from a single thread first.
+   */
+  vtkIdType FindClosestPointWithinRadius(
+    double x[3], double radius, double closestPoint[3],
+    vtkGenericCell *cell, vtkIdType &cellId,
+    int &subId, double& dist2, int &inside) VTK_OVERRIDE;
+
+  /**
+   * Return the intersection point (if any) AND the cell which was
+   * intersected by the finite line. The cell closest to p1 along the line is
+   * returned. The buckets are traversed in the order in which they are
+   * crossed by the line, so the search stops as soon as possible. This
+   * method is thread safe if BuildLocator() is directly or indirectly called
+   * from a single thread first.
+   */
+  int IntersectWithLine(double p1[3], double p2[3], double tol, double& t,
+                        double x[3], double pcoords[3], int &subId,
+                        vtkIdType &cellId, vtkGenericCell *cell) VTK_OVERRIDE;
+
+  /**
+   * Return a list of unique cell ids whose bounding box intersects the
+   * given bounding box. This method is thread safe if BuildLocator() is
+   * directly or indirectly called from a single thread first.
+   */
+  void FindCellsWithinBounds(double *bbox, vtkIdList *cells) VTK_OVERRIDE;
+
+  /**
+   * Given a finite line defined by the two points (p1,p2), return the list
+   * of unique cell ids in the buckets crossed by the line. It is possible
+   * that an empty cell list is returned. The tolerance is not used. This
+   * method is thread safe if BuildLocator() is directly or indirectly called
+   * from a single thread first.
+   */
+  void FindCellsAlongLine(double p1[3], double p2[3], double tolerance,
+                          vtkIdList *cells) VTK_OVERRIDE;
+
+  /**
+   * Quickly test if a point is inside the bounds of a particular cell,
+   * using the cached cell bounds.
+   */
+  bool InsideCellBounds(double x[3], vtkIdType cellId) VTK_OVERRIDE;
+
+  //@{
+  /**
+   * Satisfy vtkLocator abstract interface. These methods are not thread
+   * safe.
+   */
+  void Initialize() VTK_OVERRIDE;
+  void FreeSearchStructure() VTK_OVERRIDE;
+  void BuildLocator() VTK_OVERRIDE;
+  void GenerateRepresentation(int level, vtkPolyData *pd) VTK_OVERRIDE;
+  //@}
+
+  /**
+   * Inform the user as to whether large ids are being used. This flag only
+   * has meaning after the locator has been built. Large ids are used when the
+   * number of cells, or the number of buckets, is >= the signed integer
+   * max value.
+   */
+  bool GetLargeIds() {return this->LargeIds;}
+
+protected:
+  vtkStaticCellLocator();
+  ~vtkStaticCellLocator() VTK_OVERRIDE;
+
+  // Compute the cell bounds in parallel.
+  bool StoreCellBounds() VTK_OVERRIDE;
+
+  double Bounds[6]; // Bounding box of the whole dataset
+  int Divisions[3]; // Number of sub-divisions in x-y-z directions
+  double H[3]; // Width of each bucket in x-y-z directions
+  vtkCellBinner *Buckets; // Lists of cell ids in each bucket
+  bool LargeIds; //indicate whether integer ids are small or large
+
+private:
+  vtkStaticCellLocator(const vtkStaticCellLocator&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkStaticCellLocator&) VTK_DELETE_FUNCTION;
+
+};
+
+#endif
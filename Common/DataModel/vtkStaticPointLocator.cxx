@@ -21,8 +21,10 @@
 #include "vtkObjectFactory.h"
 #include "vtkPoints.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
 #include "vtkSMPTools.h"
 
+#include <algorithm>
 #include <vector>
 
 vtkStandardNewMacro(vtkStaticPointLocator);
@@ -485,6 +487,7 @@ public:
   void FindClosestNPoints(int N, const double x[3], vtkIdList *result);
   void FindPointsWithinRadius(double R, const double x[3], vtkIdList *result);
   void GenerateRepresentation(int vtkNotUsed(level), vtkPolyData *pd);
+  void MergePoints(double tol, vtkIdType *mergeMap);
 
   // Internal methods
   void GetOverlappingBuckets(NeighborBuckets* buckets, const double x[3],
@@ -615,6 +618,75 @@ public:
       }//operator()
   };
 
+  // Merge exactly coincident points. Coincident points necessarily lie in
+  // the same bucket, so the buckets can be processed independently. The
+  // points of a bucket are sorted by coordinates (then by id), so that
+  // coincident points form runs whose first point has the smallest id.
+  // Sorting avoids comparing all pairs of points, which matters for
+  // surfaces where the occupied buckets hold many points.
+  struct MergeTuple
+  {
+    double X[3];
+    vtkIdType PtId;
+
+    bool operator< (const MergeTuple& tuple) const
+    {
+      if ( X[0] != tuple.X[0] ) return X[0] < tuple.X[0];
+      if ( X[1] != tuple.X[1] ) return X[1] < tuple.X[1];
+      if ( X[2] != tuple.X[2] ) return X[2] < tuple.X[2];
+      return PtId < tuple.PtId;
+    }
+    bool Coincident(const MergeTuple& tuple) const
+    {
+      return X[0] == tuple.X[0] && X[1] == tuple.X[1] && X[2] == tuple.X[2];
+    }
+  };
+
+  template <typename T>
+  class MergePrecise
+  {
+    public:
+      BucketList<T> *BList;
+      vtkIdType *MergeMap;
+      vtkSMPThreadLocal<std::vector<MergeTuple> > Tuples;
+
+      MergePrecise(BucketList<T> *blist, vtkIdType *mergeMap) :
+        BList(blist), MergeMap(mergeMap)
+      {
+      }
+
+      void  operator()(vtkIdType bucket, vtkIdType endBucket)
+      {
+        std::vector<MergeTuple> &tuples = this->Tuples.Local();
+        vtkDataSet *ds = this->BList->DataSet;
+        for ( ; bucket < endBucket; ++bucket )
+        {
+          vtkIdType numIds = this->BList->GetNumberOfIds(bucket);
+          if ( numIds < 1 )
+          {
+            continue;
+          }
+          const LocatorTuple<T> *ids = this->BList->GetIds(bucket);
+          tuples.resize(numIds);
+          for (vtkIdType i=0; i < numIds; ++i)
+          {
+            tuples[i].PtId = ids[i].PtId;
+            ds->GetPoint(ids[i].PtId, tuples[i].X);
+          }
+          std::sort(tuples.begin(), tuples.end());
+          vtkIdType first = 0;
+          for (vtkIdType i=0; i < numIds; ++i)
+          {
+            if ( !tuples[i].Coincident(tuples[first]) )
+            {
+              first = i;
+            }
+            this->MergeMap[tuples[i].PtId] = tuples[first].PtId;
+          }
+        }//for all buckets in this batch
+      }
+  };
+
   // Build the map and other structures to support locator operations
   void BuildLocator() VTK_OVERRIDE
   {
@@ -923,6 +995,71 @@ FindClosestPointWithinRadius(double radius, const double x[3],
   return closest;
 }
 
+//-----------------------------------------------------------------------------
+// Merge points, producing a map from each point to the point it is merged
+// with. Exact merging is threaded; merging within a tolerance is order
+// dependent (a point absorbs its neighbors only if it has not been absorbed
+// itself) and therefore proceeds serially in point id order.
+template <typename TIds> void BucketList<TIds>::
+MergePoints(double tol, vtkIdType *mergeMap)
+{
+  vtkSMPTools::Fill(mergeMap, mergeMap + this->NumPts, -1);
+
+  if ( tol <= 0.0 )
+  {
+    MergePrecise<TIds> merge(this, mergeMap);
+    vtkSMPTools::For(0, this->NumBuckets, merge);
+    return;
+  }
+
+  double tol2 = tol*tol;
+  double x[3], y[3], xMin[3], xMax[3];
+  int i, j, k, ijkMin[3], ijkMax[3];
+  vtkIdType ptId, ii, cno, numIds;
+  const LocatorTuple<TIds> *ids;
+  for ( ptId=0; ptId < this->NumPts; ++ptId )
+  {
+    if ( mergeMap[ptId] >= 0 )
+    {
+      continue;
+    }
+    mergeMap[ptId] = ptId;
+
+    this->DataSet->GetPoint(ptId, x);
+    for ( i=0; i < 3; ++i )
+    {
+      xMin[i] = x[i] - tol;
+      xMax[i] = x[i] + tol;
+    }
+    this->GetBucketIndices(xMin, ijkMin);
+    this->GetBucketIndices(xMax, ijkMax);
+
+    for ( k=ijkMin[2]; k <= ijkMax[2]; ++k )
+    {
+      for ( j=ijkMin[1]; j <= ijkMax[1]; ++j )
+      {
+        for ( i=ijkMin[0]; i <= ijkMax[0]; ++i )
+        {
+          cno = i + j*this->xD + k*this->xyD;
+          numIds = this->GetNumberOfIds(cno);
+          ids = this->GetIds(cno);
+          for ( ii=0; ii < numIds; ++ii )
+          {
+            if ( mergeMap[ids[ii].PtId] < 0 )
+            {
+              this->DataSet->GetPoint(ids[ii].PtId, y);
+              if ( vtkMath::Distance2BetweenPoints(x,y) <= tol2 )
+              {
+                mergeMap[ids[ii].PtId] = ptId;
+              }
+            }
+          }//for all points in bucket
+        }//i-footprint
+      }//j-footprint
+    }//k-footprint
+  }//for all points
+}
+
 namespace {
 //-----------------------------------------------------------------------------
 // Obtaining closest points requires sorting nearby points
@@ -1661,6 +1798,26 @@ GetBucketIds(vtkIdType bNum, vtkIdList *bList)
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkStaticPointLocator::MergePoints(double tol, vtkIdType *mergeMap)
+{
+  this->BuildLocator(); // will subdivide if modified; otherwise returns
+  if ( !this->Buckets )
+  {
+    return;
+  }
+
+  if ( this->LargeIds )
+  {
+    static_cast<BucketList<vtkIdType>*>(this->Buckets)->
+      MergePoints(tol,mergeMap);
+  }
+  else
+  {
+    static_cast<BucketList<int>*>(this->Buckets)->MergePoints(tol,mergeMap);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkStaticPointLocator::PrintSelf(ostream& os, vtkIndent indent)
 {
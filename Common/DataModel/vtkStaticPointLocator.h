@@ -168,6 +168,20 @@ public:
    */
   void GetBucketIds(vtkIdType bNum, vtkIdList *bList);
 
+  /**
+   * Merge points in the locator given a tolerance. The user must provide a
+   * merge map of size numPts (the number of points in the dataset) which
+   * on return maps each point to the point it is merged with; points which
+   * are not merged map to themselves. A point always maps to a point of
+   * smaller or equal id, so the first point of each group of merged points
+   * is the one kept. When tol == 0, exactly coincident points are merged,
+   * and the buckets are processed in parallel. When tol > 0, the points are
+   * visited in increasing id order and each point not yet merged absorbs
+   * the points lying within the tolerance. Either way the result does not
+   * depend on the number of threads.
+   */
+  void MergePoints(double tol, vtkIdType *mergeMap);
+
   /**
    * Inform the user as to whether large ids are being used. This flag only
    * has meaning after the locator has been built. Large ids are used when the
@@ -0,0 +1,192 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestAppendFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded vtkAppendPolyData and vtkAppendFilter produce
+// the same output as the serial ones, and that vtkAppendFilter shares the
+// geometry and arrays of a single unstructured grid.
+
+#include "vtkAppendFilter.h"
+#include "vtkAppendPolyData.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkStringArray.h"
+#include "vtkStripper.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnstructuredGrid.h"
+#include "vtkVariant.h"
+
+namespace
+{
+// Add to dsa an int array (the active scalars), a double
+// array and a string array.
+void AddArrays(vtkDataSetAttributes *dsa, vtkIdType numTuples, int seed)
+{
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("ints");
+  ints->SetNumberOfTuples(numTuples);
+  vtkNew<vtkDoubleArray> doubles;
+  doubles->SetName("doubles");
+  doubles->SetNumberOfComponents(2);
+  doubles->SetNumberOfTuples(numTuples);
+  vtkNew<vtkStringArray> strings;
+  strings->SetName("strings");
+  strings->SetNumberOfTuples(numTuples);
+  for (vtkIdType i = 0; i < numTuples; ++i)
+  {
+    ints->SetValue(i, seed * 1000 + static_cast<int>(i));
+    doubles->SetTypedComponent(i, 0, 0.5 * i + seed);
+    doubles->SetTypedComponent(i, 1, -0.25 * i);
+    strings->SetValue(i, vtkVariant(seed * 1000 + i).ToString());
+  }
+  dsa->SetScalars(ints.Get());
+  dsa->AddArray(doubles.Get());
+  dsa->AddArray(strings.Get());
+}
+
+// A sphere, stripped if strips is true, with a polyline and vertices.
+vtkSmartPointer<vtkPolyData> MakePolyData(int seed, bool strips,
+                                          bool doublePoints)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(8 + seed);
+  sphere->SetPhiResolution(6 + seed);
+  sphere->SetCenter(seed, 0.0, 0.0);
+  sphere->SetOutputPointsPrecision(doublePoints ?
+    vtkAlgorithm::DOUBLE_PRECISION : vtkAlgorithm::SINGLE_PRECISION);
+  sphere->Update();
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  if (strips)
+  {
+    vtkNew<vtkStripper> stripper;
+    stripper->SetInputConnection(sphere->GetOutputPort());
+    stripper->Update();
+    polyData->DeepCopy(stripper->GetOutput());
+  }
+  else
+  {
+    polyData->DeepCopy(sphere->GetOutput());
+  }
+
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(4);
+  for (vtkIdType i = 0; i < 4; ++i)
+  {
+    verts->InsertNextCell(1, &i);
+    lines->InsertCellPoint(i + 2);
+  }
+  polyData->SetVerts(verts.Get());
+  polyData->SetLines(lines.Get());
+  polyData->GetPointData()->Initialize();
+  polyData->GetCellData()->Initialize();
+  AddArrays(polyData->GetPointData(), polyData->GetNumberOfPoints(), seed);
+  AddArrays(polyData->GetCellData(), polyData->GetNumberOfCells(), seed);
+  return polyData;
+}
+
+vtkSmartPointer<vtkImageData> MakeImage(int seed)
+{
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->SetDimensions(4 + seed, 3, 2);
+  image->SetOrigin(0.0, seed, 0.0);
+  AddArrays(image->GetPointData(), image->GetNumberOfPoints(), seed);
+  AddArrays(image->GetCellData(), image->GetNumberOfCells(), seed);
+  return image;
+}
+
+bool CheckAppendPolyData()
+{
+  vtkNew<vtkAppendPolyData> serial;
+  vtkNew<vtkAppendPolyData> threaded;
+  vtkAppendPolyData *appenders[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; ++i)
+  {
+    for (int seed = 0; seed < 6; ++seed)
+    {
+      appenders[i]->AddInputData(
+        MakePolyData(seed, seed % 2 != 0, seed == 3));
+    }
+    appenders[i]->AddInputData(vtkSmartPointer<vtkPolyData>::New());
+    appenders[i]->SetEnableSMP(i);
+    appenders[i]->Update();
+  }
+  return vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                               threaded->GetOutput());
+}
+
+bool CheckAppendFilter()
+{
+  vtkNew<vtkAppendFilter> serial;
+  vtkNew<vtkAppendFilter> threaded;
+  vtkAppendFilter *appenders[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; ++i)
+  {
+    for (int seed = 0; seed < 4; ++seed)
+    {
+      appenders[i]->AddInputData(MakePolyData(seed, seed % 2 != 0, false));
+      appenders[i]->AddInputData(MakeImage(seed));
+    }
+    appenders[i]->SetEnableSMP(i);
+    appenders[i]->Update();
+  }
+  if (!vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                             threaded->GetOutput()))
+  {
+    return false;
+  }
+
+  // A single unstructured grid is passed by reference.
+  vtkUnstructuredGrid *grid = serial->GetOutput();
+  vtkNew<vtkAppendFilter> single;
+  single->SetInputData(grid);
+  single->SetEnableSMP(1);
+  single->Update();
+  vtkUnstructuredGrid *output = single->GetOutput();
+  if (output->GetPoints() != grid->GetPoints() ||
+      output->GetCells() != grid->GetCells() ||
+      output->GetPointData()->GetArray("doubles") !=
+        grid->GetPointData()->GetArray("doubles"))
+  {
+    cerr << "The single input is not passed by reference" << endl;
+    return false;
+  }
+  return vtkTestDataSetUtilities::SameDataSets(grid, output);
+}
+}
+
+int TestAppendFilterSMP(int, char *[])
+{
+  if (!CheckAppendPolyData())
+  {
+    cerr << "Threaded vtkAppendPolyData differs" << endl;
+    return EXIT_FAILURE;
+  }
+  if (!CheckAppendFilter())
+  {
+    cerr << "Threaded vtkAppendFilter differs" << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
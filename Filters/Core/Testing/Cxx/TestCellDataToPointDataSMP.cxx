@@ -0,0 +1,176 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCellDataToPointDataSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded vtkCellDataToPointData and vtkPointDataToCellData
+// produce the same output as the serial filters.
+
+#include "vtkCell.h"
+#include "vtkCellData.h"
+#include "vtkCellDataToPointData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPointDataToCellData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+bool CheckCellDataToPointData(vtkDataSet *input, bool exact)
+{
+  vtkNew<vtkCellDataToPointData> serial;
+  vtkNew<vtkCellDataToPointData> threaded;
+  vtkCellDataToPointData *filters[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    filters[j]->SetInputData(input);
+    filters[j]->SetEnableSMP(j);
+    filters[j]->PassCellDataOn();
+    filters[j]->Update();
+  }
+  // Unless exact, integral values may differ by one and real values by a
+  // relative tolerance.
+  return vtkTestDataSetUtilities::SameFieldData(
+      serial->GetOutput()->GetPointData(),
+      threaded->GetOutput()->GetPointData(), exact ? 0.0 : 1.0e-5) &&
+    vtkTestDataSetUtilities::SameFieldData(
+      serial->GetOutput()->GetCellData(),
+      threaded->GetOutput()->GetCellData());
+}
+
+bool CheckPointDataToCellData(vtkDataSet *input, bool categorical)
+{
+  vtkNew<vtkPointDataToCellData> serial;
+  vtkNew<vtkPointDataToCellData> threaded;
+  vtkPointDataToCellData *filters[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    filters[j]->SetInputData(input);
+    filters[j]->SetEnableSMP(j);
+    filters[j]->SetCategoricalData(categorical);
+    filters[j]->PassPointDataOn();
+    filters[j]->Update();
+  }
+  return vtkTestDataSetUtilities::SameFieldData(
+      serial->GetOutput()->GetCellData(),
+      threaded->GetOutput()->GetCellData()) &&
+    vtkTestDataSetUtilities::SameFieldData(
+      serial->GetOutput()->GetPointData(),
+      threaded->GetOutput()->GetPointData());
+}
+
+// Add scalars, vectors and an integral array to the attributes.
+void AddArrays(vtkDataSet *ds, vtkDataSetAttributes *attributes, bool cells)
+{
+  vtkIdType num = cells ? ds->GetNumberOfCells() : ds->GetNumberOfPoints();
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vtkNew<vtkIntArray> labels;
+  labels->SetName("Labels");
+  double x[3];
+  for (vtkIdType i = 0; i < num; ++i)
+  {
+    if (cells)
+    {
+      ds->GetPoint(ds->GetCell(i)->GetPointId(0), x);
+    }
+    else
+    {
+      ds->GetPoint(i, x);
+    }
+    scalars->InsertNextValue(sin(3.0 * x[0]) * cos(2.0 * x[1]) + x[2]);
+    vectors->InsertNextTuple3(x[1], -x[0], 0.5 * x[2]);
+    labels->InsertNextValue(static_cast<int>(floor(4.0 * x[0] + 2.0 * x[1])));
+  }
+  attributes->SetScalars(scalars.Get());
+  attributes->SetVectors(vectors.Get());
+  attributes->AddArray(labels.Get());
+}
+}
+
+int TestCellDataToPointDataSMP(int, char *[])
+{
+  // An image, a structured grid with blanked cells, a grid of tetrahedra
+  // and a sphere.
+  vtkNew<vtkImageData> image;
+  image->SetExtent(-8, 8, -8, 8, -8, 8);
+  image->SetSpacing(1.0 / 8, 1.0 / 8, 1.0 / 8);
+  AddArrays(image.Get(), image->GetPointData(), false);
+  AddArrays(image.Get(), image->GetCellData(), true);
+
+  vtkNew<vtkStructuredGrid> grid;
+  vtkNew<vtkPoints> points;
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    points->InsertNextPoint(image->GetPoint(i));
+  }
+  grid->SetExtent(image->GetExtent());
+  grid->SetPoints(points.Get());
+  grid->GetPointData()->ShallowCopy(image->GetPointData());
+  grid->GetCellData()->ShallowCopy(image->GetCellData());
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); i += 7)
+  {
+    grid->BlankCell(i);
+  }
+
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image.Get());
+  tetrahedra->Update();
+  vtkUnstructuredGrid *tets = tetrahedra->GetOutput();
+  tets->GetCellData()->Initialize();
+  AddArrays(tets, tets->GetCellData(), true);
+
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(40);
+  sphereSource->SetPhiResolution(30);
+  sphereSource->Update();
+  vtkPolyData *sphere = sphereSource->GetOutput();
+  AddArrays(sphere, sphere->GetPointData(), false);
+  AddArrays(sphere, sphere->GetCellData(), true);
+
+  vtkDataSet *inputs[4] = {image.Get(), grid.Get(), tets, sphere};
+  for (int i = 0; i < 4; ++i)
+  {
+    // The serial filter averages the cell data of unstructured grids in the
+    // type of the arrays.
+    if (!CheckCellDataToPointData(inputs[i], i != 2))
+    {
+      cerr << "Threaded cell data to point data differs for input " << i
+           << endl;
+      return EXIT_FAILURE;
+    }
+    for (int categorical = 0; categorical < 2; ++categorical)
+    {
+      if (!CheckPointDataToCellData(inputs[i], categorical != 0))
+      {
+        cerr << "Threaded point data to cell data differs for input " << i
+             << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -14,9 +14,14 @@
 =========================================================================*/
 
 #include <vtkCellArray.h>
+#include <vtkCellData.h>
 #include <vtkCleanPolyData.h>
+#include <vtkFloatArray.h>
+#include <vtkIdList.h>
 #include <vtkMinimalStandardRandomSequence.h>
+#include <vtkPointData.h>
 #include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
 
 namespace
 {
@@ -65,7 +70,7 @@ void InitializePolyData(vtkPolyData *polyData, int dataType)
   polyData->SetVerts(verts);
 }
 
-int CleanPolyData(int dataType, int outputPointsPrecision)
+int CleanPolyData(int dataType, int outputPointsPrecision, int enableSMP)
 {
   vtkSmartPointer<vtkPolyData> inputPolyData
     = vtkSmartPointer<vtkPolyData>::New();
@@ -74,6 +79,7 @@ int CleanPolyData(int dataType, int outputPointsPrecision)
   vtkSmartPointer<vtkCleanPolyData> cleanPolyData
     = vtkSmartPointer<vtkCleanPolyData>::New();
   cleanPolyData->SetOutputPointsPrecision(outputPointsPrecision);
+  cleanPolyData->SetEnableSMP(enableSMP);
   cleanPolyData->SetInputData(inputPolyData);
 
   cleanPolyData->Update();
@@ -83,48 +89,218 @@ int CleanPolyData(int dataType, int outputPointsPrecision)
 
   return points->GetDataType();
 }
-}
 
-int TestCleanPolyData(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+// A triangulated sphere whose triangles do not share their points, plus a
+// few cells which become degenerate once the points are merged. The point
+// data is a function of the coordinates, so it does not depend on which
+// of the coincident points is kept.
+vtkSmartPointer<vtkPolyData> MakeUnmergedSphere()
 {
-  int dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::DEFAULT_PRECISION);
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(60);
+  sphere->SetPhiResolution(60);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
 
-  if(dataType != VTK_FLOAT)
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkFloatArray> scalars =
+    vtkSmartPointer<vtkFloatArray>::New();
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkCellArray> strips = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType npts, *pts;
+  double x[3];
+  vtkCellArray *inPolys = input->GetPolys();
+  for (inPolys->InitTraversal(); inPolys->GetNextCell(npts, pts); )
   {
-    return EXIT_FAILURE;
+    polys->InsertNextCell(npts);
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      input->GetPoint(pts[i], x);
+      polys->InsertCellPoint(points->InsertNextPoint(x));
+      scalars->InsertNextValue(static_cast<float>(x[0] + 2.0 * x[2]));
+    }
   }
+  // A quad with two coincident points becomes a triangle, a triangle
+  // with two coincident points becomes a line, a line whose points are
+  // coincident becomes a vertex and a strip of 4 points with two
+  // coincident points becomes a triangle.
+  input->GetPoint(10, x);
+  vtkIdType a = points->InsertNextPoint(x);
+  scalars->InsertNextValue(static_cast<float>(x[0] + 2.0 * x[2]));
+  vtkIdType b = points->InsertNextPoint(x);
+  scalars->InsertNextValue(static_cast<float>(x[0] + 2.0 * x[2]));
+  input->GetPoint(20, x);
+  vtkIdType c = points->InsertNextPoint(x);
+  scalars->InsertNextValue(static_cast<float>(x[0] + 2.0 * x[2]));
+  input->GetPoint(30, x);
+  vtkIdType d = points->InsertNextPoint(x);
+  scalars->InsertNextValue(static_cast<float>(x[0] + 2.0 * x[2]));
+  vtkIdType quad[4] = { a, b, c, d };
+  polys->InsertNextCell(4, quad);
+  vtkIdType tri[3] = { a, b, c };
+  polys->InsertNextCell(3, tri);
+  vtkIdType line[2] = { a, b };
+  lines->InsertNextCell(2, line);
+  lines->InsertNextCell(2, tri + 1);
+  vtkIdType strip[4] = { a, b, c, d };
+  strips->InsertNextCell(4, strip);
 
-  dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::DEFAULT_PRECISION);
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->SetPoints(points);
+  output->SetLines(lines);
+  output->SetPolys(polys);
+  output->SetStrips(strips);
+  output->GetPointData()->SetScalars(scalars);
 
-  if(dataType != VTK_DOUBLE)
+  vtkSmartPointer<vtkFloatArray> cellIds =
+    vtkSmartPointer<vtkFloatArray>::New();
+  cellIds->SetNumberOfTuples(output->GetNumberOfCells());
+  for (vtkIdType i = 0; i < output->GetNumberOfCells(); ++i)
   {
-    return EXIT_FAILURE;
+    cellIds->SetValue(i, static_cast<float>(i));
   }
+  output->GetCellData()->SetScalars(cellIds);
+  return output;
+}
 
-  dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::SINGLE_PRECISION);
-
-  if(dataType != VTK_FLOAT)
+// Check that the serial and threaded outputs are the same, up to the
+// numbering of the points.
+int CompareSMP(vtkPolyData *input, int pointMerging, double tolerance)
+{
+  vtkSmartPointer<vtkPolyData> outputs[2];
+  for (int enableSMP = 0; enableSMP < 2; ++enableSMP)
   {
+    vtkSmartPointer<vtkCleanPolyData> clean =
+      vtkSmartPointer<vtkCleanPolyData>::New();
+    clean->SetInputData(input);
+    clean->SetPointMerging(pointMerging);
+    clean->SetTolerance(tolerance);
+    clean->SetEnableSMP(enableSMP);
+    clean->Update();
+    outputs[enableSMP] = clean->GetOutput();
+  }
+  if (input->GetPolys()->HasCellLocations())
+  {
+    std::cerr << "The cell locations of the input were kept" << std::endl;
     return EXIT_FAILURE;
   }
 
-  dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::SINGLE_PRECISION);
-
-  if(dataType != VTK_FLOAT)
+  vtkPolyData *serial = outputs[0];
+  vtkPolyData *smp = outputs[1];
+  if (serial->GetNumberOfPoints() != smp->GetNumberOfPoints() ||
+      serial->GetNumberOfVerts() != smp->GetNumberOfVerts() ||
+      serial->GetNumberOfLines() != smp->GetNumberOfLines() ||
+      serial->GetNumberOfPolys() != smp->GetNumberOfPolys() ||
+      serial->GetNumberOfStrips() != smp->GetNumberOfStrips())
   {
+    std::cerr << "Serial and SMP outputs differ: "
+              << serial->GetNumberOfPoints() << " / "
+              << smp->GetNumberOfPoints() << " points, "
+              << serial->GetNumberOfCells() << " / "
+              << smp->GetNumberOfCells() << " cells" << std::endl;
     return EXIT_FAILURE;
   }
 
-  dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::DOUBLE_PRECISION);
-
-  if(dataType != VTK_DOUBLE)
+  vtkDataArray *serialPD = serial->GetPointData()->GetScalars();
+  vtkDataArray *smpPD = smp->GetPointData()->GetScalars();
+  vtkDataArray *serialCD = serial->GetCellData()->GetScalars();
+  vtkDataArray *smpCD = smp->GetCellData()->GetScalars();
+  if (!serialPD || !smpPD || !serialCD || !smpCD)
   {
+    std::cerr << "Missing attributes" << std::endl;
     return EXIT_FAILURE;
   }
+  vtkSmartPointer<vtkIdList> serialPts = vtkSmartPointer<vtkIdList>::New();
+  vtkSmartPointer<vtkIdList> smpPts = vtkSmartPointer<vtkIdList>::New();
+  for (vtkIdType cellId = 0; cellId < serial->GetNumberOfCells(); ++cellId)
+  {
+    serial->GetCellPoints(cellId, serialPts);
+    smp->GetCellPoints(cellId, smpPts);
+    if (serial->GetCellType(cellId) != smp->GetCellType(cellId) ||
+        serialPts->GetNumberOfIds() != smpPts->GetNumberOfIds() ||
+        serialCD->GetTuple1(cellId) != smpCD->GetTuple1(cellId))
+    {
+      std::cerr << "Cell " << cellId << " differs" << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (vtkIdType i = 0; i < serialPts->GetNumberOfIds(); ++i)
+    {
+      double x[3], y[3];
+      serial->GetPoint(serialPts->GetId(i), x);
+      smp->GetPoint(smpPts->GetId(i), y);
+      if (x[0] != y[0] || x[1] != y[1] || x[2] != y[2] ||
+          serialPD->GetTuple1(serialPts->GetId(i)) !=
+          smpPD->GetTuple1(smpPts->GetId(i)))
+      {
+        std::cerr << "Point " << i << " of cell " << cellId << " differs"
+                  << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  return EXIT_SUCCESS;
+}
+}
+
+int TestCleanPolyData(int vtkNotUsed(argc), char *vtkNotUsed(argv)[])
+{
+  for (int enableSMP = 0; enableSMP < 2; ++enableSMP)
+  {
+    int dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::DEFAULT_PRECISION,
+                                 enableSMP);
+
+    if(dataType != VTK_FLOAT)
+    {
+      return EXIT_FAILURE;
+    }
+
+    dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::DEFAULT_PRECISION,
+                             enableSMP);
+
+    if(dataType != VTK_DOUBLE)
+    {
+      return EXIT_FAILURE;
+    }
+
+    dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::SINGLE_PRECISION,
+                             enableSMP);
+
+    if(dataType != VTK_FLOAT)
+    {
+      return EXIT_FAILURE;
+    }
+
+    dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::SINGLE_PRECISION,
+                             enableSMP);
 
-  dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::DOUBLE_PRECISION);
+    if(dataType != VTK_FLOAT)
+    {
+      return EXIT_FAILURE;
+    }
+
+    dataType = CleanPolyData(VTK_FLOAT, vtkAlgorithm::DOUBLE_PRECISION,
+                             enableSMP);
+
+    if(dataType != VTK_DOUBLE)
+    {
+      return EXIT_FAILURE;
+    }
+
+    dataType = CleanPolyData(VTK_DOUBLE, vtkAlgorithm::DOUBLE_PRECISION,
+                             enableSMP);
+
+    if(dataType != VTK_DOUBLE)
+    {
+      return EXIT_FAILURE;
+    }
+  }
 
-  if(dataType != VTK_DOUBLE)
+  vtkSmartPointer<vtkPolyData> sphere = MakeUnmergedSphere();
+  if (CompareSMP(sphere, 1, 0.0) != EXIT_SUCCESS ||
+      CompareSMP(sphere, 1, 1.0e-6) != EXIT_SUCCESS ||
+      CompareSMP(sphere, 0, 0.0) != EXIT_SUCCESS)
   {
     return EXIT_FAILURE;
   }
@@ -0,0 +1,186 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestCutterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded cutting of vtkCutter produces the same output as
+// the serial cutting, with or without a scalar tree.
+
+#include "vtkAlgorithm.h"
+#include "vtkAppendFilter.h"
+#include "vtkCutter.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkNew.h"
+#include "vtkPlane.h"
+#include "vtkPointDataToCellData.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSphere.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+
+#include <cmath>
+
+namespace
+{
+bool SameCounts(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfPoints() != pd2->GetNumberOfPoints() ||
+      pd1->GetNumberOfCells() != pd2->GetNumberOfCells())
+  {
+    cerr << "Expected " << pd1->GetNumberOfPoints() << " points and "
+         << pd1->GetNumberOfCells() << " cells but got "
+         << pd2->GetNumberOfPoints() << " points and "
+         << pd2->GetNumberOfCells() << " cells" << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestCutterSMP(int, char *[])
+{
+  vtkNew<vtkRTAnalyticSource> image;
+  image->SetWholeExtent(-12, 12, -12, 12, -12, 12);
+  vtkNew<vtkPointDataToCellData> cellData;
+  cellData->SetInputConnection(image->GetOutputPort());
+  cellData->PassPointDataOn();
+
+  // A grid of hexahedra, a grid of tetrahedra and a sphere.
+  vtkNew<vtkAppendFilter> hexahedra;
+  hexahedra->SetInputConnection(cellData->GetOutputPort());
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputConnection(cellData->GetOutputPort());
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(60);
+  sphereSource->SetPhiResolution(60);
+  sphereSource->SetRadius(8.0);
+  vtkAlgorithm *inputs[3] = {
+    hexahedra.Get(), tetrahedra.Get(), sphereSource.Get()};
+
+  vtkNew<vtkPlane> plane;
+  plane->SetOrigin(0.5, 0.25, 0.125);
+  plane->SetNormal(1.0, 2.0, 3.0);
+  vtkNew<vtkSphere> sphere;
+  sphere->SetCenter(1.0, -2.0, 0.5);
+  sphere->SetRadius(7.0);
+
+  // With double precision points, the threaded cutting merges the same
+  // points as the serial one.
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int mode = 0; mode < 3; ++mode)
+    {
+      vtkNew<vtkCutter> serial;
+      vtkNew<vtkCutter> threaded;
+      vtkCutter *cutters[2] = {serial.Get(), threaded.Get()};
+      for (int j = 0; j < 2; ++j)
+      {
+        cutters[j]->SetInputConnection(inputs[i]->GetOutputPort());
+        cutters[j]->SetEnableSMP(j);
+        cutters[j]->SetOutputPointsPrecision(vtkAlgorithm::DOUBLE_PRECISION);
+        if (mode == 0)
+        {
+          cutters[j]->SetCutFunction(plane.Get());
+        }
+        else if (mode == 1)
+        {
+          cutters[j]->SetCutFunction(sphere.Get());
+          cutters[j]->GenerateCutScalarsOn();
+        }
+        else
+        {
+          cutters[j]->SetCutFunction(plane.Get());
+          cutters[j]->GenerateValues(5, -6.0, 6.0);
+        }
+        cutters[j]->Update();
+      }
+      if (threaded->GetOutput()->GetNumberOfCells() == 0 ||
+          !vtkTestDataSetUtilities::SameDataSets(
+            serial->GetOutput(), threaded->GetOutput(), 1.0e-5))
+      {
+        cerr << "Threaded cutting differs for input " << i << " and mode "
+             << mode << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // The scalar tree changes the order of the cells, but not the number of
+  // points and cells, also when the same function is cut again at other
+  // values.
+  for (int i = 0; i < 3; ++i)
+  {
+    vtkNew<vtkCutter> threaded;
+    vtkNew<vtkCutter> tree;
+    vtkCutter *cutters[2] = {threaded.Get(), tree.Get()};
+    for (int j = 0; j < 2; ++j)
+    {
+      cutters[j]->SetInputConnection(inputs[i]->GetOutputPort());
+      cutters[j]->SetCutFunction(sphere.Get());
+      cutters[j]->EnableSMPOn();
+      cutters[j]->SetUseScalarTree(j);
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      for (int j = 0; j < 2; ++j)
+      {
+        cutters[j]->SetValue(0, 8.0 * k - 4.0);
+        cutters[j]->Update();
+      }
+      if (threaded->GetOutput()->GetNumberOfCells() == 0 ||
+          !SameCounts(threaded->GetOutput(), tree->GetOutput()))
+      {
+        cerr << "Cutting with a scalar tree differs for input " << i
+             << " and value " << k << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Swapping the cut function for one modified before the current one must
+  // not reuse the values of the current function at the points.
+  vtkNew<vtkPlane> planeB;
+  planeB->SetOrigin(0.0, 0.3, 0.0);
+  planeB->SetNormal(0.0, 1.0, 0.0);
+  vtkNew<vtkPlane> planeA;
+  planeA->SetOrigin(0.05, 0.0, 0.0);
+  planeA->SetNormal(1.0, 0.0, 0.0);
+  vtkNew<vtkCutter> serial;
+  vtkNew<vtkCutter> threaded;
+  vtkCutter *cutters[2] = {serial.Get(), threaded.Get()};
+  for (int k = 0; k < 2; ++k)
+  {
+    for (int j = 0; j < 2; ++j)
+    {
+      cutters[j]->SetInputConnection(hexahedra->GetOutputPort());
+      cutters[j]->SetEnableSMP(j);
+      cutters[j]->SetOutputPointsPrecision(vtkAlgorithm::DOUBLE_PRECISION);
+      cutters[j]->SetCutFunction(k == 0 ? planeA.Get() : planeB.Get());
+      cutters[j]->Update();
+    }
+    double bounds[6];
+    threaded->GetOutput()->GetBounds(bounds);
+    if (threaded->GetOutput()->GetNumberOfCells() == 0 ||
+        (k == 1 && (fabs(bounds[2] - 0.3) > 1.0e-6 ||
+                    fabs(bounds[3] - 0.3) > 1.0e-6)) ||
+        !vtkTestDataSetUtilities::SameDataSets(
+          serial->GetOutput(), threaded->GetOutput(), 1.0e-5))
+    {
+      cerr << "Threaded cutting differs after swapping the cut function "
+           << k << " times" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
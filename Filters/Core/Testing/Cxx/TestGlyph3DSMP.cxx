@@ -0,0 +1,201 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGlyph3DSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded glyphing of vtkGlyph3D produces the same output
+// as the serial glyphing, and that the instances describe the same glyphs.
+
+#include "vtkCellArray.h"
+#include "vtkConeSource.h"
+#include "vtkDataArray.h"
+#include "vtkFloatArray.h"
+#include "vtkGlyph3D.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkTransform.h"
+
+#include <cmath>
+
+namespace
+{
+// Check that the instances transform the source onto the serial glyphs.
+bool CheckInstances(vtkPolyData *glyphs, vtkPolyData *instances,
+                    vtkPolyData *source)
+{
+  vtkDataArray *transforms =
+    instances->GetPointData()->GetArray("GlyphTransform");
+  vtkIdType numSourcePts = source->GetNumberOfPoints();
+  if (!transforms || transforms->GetNumberOfComponents() != 16 ||
+      instances->GetNumberOfPoints() * numSourcePts !=
+        glyphs->GetNumberOfPoints() ||
+      instances->GetNumberOfVerts() != instances->GetNumberOfPoints())
+  {
+    cerr << "Wrong instances" << endl;
+    return false;
+  }
+  double m[16], x[3], y[3];
+  for (vtkIdType i = 0; i < instances->GetNumberOfPoints(); ++i)
+  {
+    transforms->GetTuple(i, m);
+    for (vtkIdType j = 0; j < numSourcePts; ++j)
+    {
+      source->GetPoint(j, x);
+      glyphs->GetPoint(i * numSourcePts + j, y);
+      for (int k = 0; k < 3; ++k)
+      {
+        double z = m[4*k] * x[0] + m[4*k+1] * x[1] + m[4*k+2] * x[2] +
+          m[4*k+3];
+        if (fabs(z - y[k]) > 1.0e-5 * (1.0 + fabs(y[k])))
+        {
+          cerr << "Instance " << i << " does not match its glyph" << endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestGlyph3DSMP(int, char *[])
+{
+  // Points on a helix, with scalars and vectors, including a null vector
+  // and a vector along -x.
+  const vtkIdType numPts = 3000;
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("Scalars");
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    double t = 0.01 * i;
+    points->InsertNextPoint(cos(t), sin(t), 0.1 * t);
+    scalars->InsertNextValue(0.5 + 0.4 * sin(3.0 * t));
+    if (i == 10)
+    {
+      vectors->InsertNextTuple3(0.0, 0.0, 0.0);
+    }
+    else if (i == 20)
+    {
+      vectors->InsertNextTuple3(-2.0, 0.0, 0.0);
+    }
+    else
+    {
+      vectors->InsertNextTuple3(-sin(t), cos(t), 0.5 * cos(2.0 * t));
+    }
+  }
+  vtkNew<vtkPolyData> input;
+  input->SetPoints(points.Get());
+  input->GetPointData()->SetScalars(scalars.Get());
+  input->GetPointData()->SetVectors(vectors.Get());
+
+  // A sphere with normals and texture coordinates, and a cone.
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(8);
+  sphereSource->SetPhiResolution(6);
+  sphereSource->SetRadius(0.05);
+  sphereSource->Update();
+  vtkNew<vtkPolyData> sphere;
+  sphere->DeepCopy(sphereSource->GetOutput());
+  vtkNew<vtkFloatArray> tcoords;
+  tcoords->SetNumberOfComponents(2);
+  for (vtkIdType i = 0; i < sphere->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    sphere->GetPoint(i, x);
+    tcoords->InsertNextTuple2(x[0], x[1]);
+  }
+  sphere->GetPointData()->SetTCoords(tcoords.Get());
+  vtkNew<vtkConeSource> cone;
+  cone->SetHeight(0.1);
+  cone->SetRadius(0.02);
+  cone->Update();
+
+  vtkNew<vtkTransform> sourceTransform;
+  sourceTransform->RotateZ(30.0);
+  sourceTransform->Translate(0.01, 0.0, 0.02);
+
+  for (int mode = 0; mode < 4; ++mode)
+  {
+    vtkNew<vtkGlyph3D> serial;
+    vtkNew<vtkGlyph3D> threaded;
+    vtkNew<vtkGlyph3D> instances;
+    vtkGlyph3D *glyphers[3] = {serial.Get(), threaded.Get(), instances.Get()};
+    for (int j = 0; j < 3; ++j)
+    {
+      vtkGlyph3D *glypher = glyphers[j];
+      glypher->SetInputData(input.Get());
+      glypher->SetSourceData(sphere.Get());
+      glypher->SetEnableSMP(j == 1);
+      glypher->SetGenerateInstances(j == 2);
+      if (mode == 0)
+      {
+        glypher->SetScaleModeToScaleByScalar();
+        glypher->SetColorModeToColorByScale();
+        glypher->GeneratePointIdsOn();
+        glypher->FillCellDataOn();
+      }
+      else if (mode == 1)
+      {
+        glypher->SetScaleModeToScaleByVectorComponents();
+        glypher->SetColorModeToColorByVector();
+        glypher->ClampingOn();
+        glypher->SetRange(-0.5, 0.5);
+        glypher->SetSourceTransform(sourceTransform.Get());
+      }
+      else if (mode == 2)
+      {
+        glypher->SetScaleModeToScaleByVector();
+        glypher->SetColorModeToColorByScalar();
+        glypher->SetScaleFactor(2.0);
+        glypher->SetSourceData(1, cone->GetOutput());
+        glypher->SetIndexModeToScalar();
+      }
+      else
+      {
+        glypher->SetScaleModeToDataScalingOff();
+        glypher->SetVectorModeToVectorRotationOff();
+        glypher->SetSourceConnection(cone->GetOutputPort());
+      }
+      glypher->Update();
+    }
+
+    if (threaded->GetOutput()->GetNumberOfCells() == 0 ||
+        !vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                               threaded->GetOutput()))
+    {
+      cerr << "Threaded glyphing differs in mode " << mode << endl;
+      return EXIT_FAILURE;
+    }
+    if (mode != 2 && !CheckInstances(serial->GetOutput(),
+                                     instances->GetOutput(),
+                                     serial->GetSource()))
+    {
+      cerr << "Wrong instances in mode " << mode << endl;
+      return EXIT_FAILURE;
+    }
+    if (mode == 2 &&
+        !instances->GetOutput()->GetPointData()->GetArray("GlyphSourceIndex"))
+    {
+      cerr << "Missing source indices" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
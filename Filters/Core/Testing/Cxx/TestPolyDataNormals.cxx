@@ -0,0 +1,201 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPolyDataNormals.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkFloatArray.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkPolygon.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+// A cube made of 8 shared points and 6 quads.
+vtkSmartPointer<vtkPolyData> MakeCube()
+{
+  static const double coords[8][3] = {
+    {0,0,0}, {1,0,0}, {1,1,0}, {0,1,0},
+    {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1} };
+  static const vtkIdType faces[6][4] = {
+    {0,3,2,1}, {4,5,6,7}, {0,1,5,4}, {1,2,6,5}, {2,3,7,6}, {3,0,4,7} };
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int i = 0; i < 8; ++i)
+  {
+    points->InsertNextPoint(coords[i]);
+  }
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  for (int i = 0; i < 6; ++i)
+  {
+    polys->InsertNextCell(4, faces[i]);
+  }
+  vtkSmartPointer<vtkPolyData> cube = vtkSmartPointer<vtkPolyData>::New();
+  cube->SetPoints(points);
+  cube->SetPolys(polys);
+  return cube;
+}
+
+// Check the normals computed with EnableSMP off or on.
+bool CheckNormals(int enableSMP)
+{
+  // Without splitting nor consistency, the point normals are the normalized
+  // sums of the normals of the polygons using each point.
+  vtkSmartPointer<vtkSphereSource> sphere =
+    vtkSmartPointer<vtkSphereSource>::New();
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+
+  vtkSmartPointer<vtkPolyDataNormals> normals =
+    vtkSmartPointer<vtkPolyDataNormals>::New();
+  normals->SetInputData(input);
+  normals->SetEnableSMP(enableSMP);
+  normals->SplittingOff();
+  normals->ConsistencyOff();
+  normals->ComputeCellNormalsOn();
+  normals->Update();
+
+  vtkPolyData *output = normals->GetOutput();
+  vtkFloatArray *pointNormals = vtkArrayDownCast<vtkFloatArray>(
+    output->GetPointData()->GetNormals());
+  vtkFloatArray *cellNormals = vtkArrayDownCast<vtkFloatArray>(
+    output->GetCellData()->GetNormals());
+  if (!pointNormals || !cellNormals ||
+      output->GetNumberOfPoints() != input->GetNumberOfPoints())
+  {
+    cerr << "Missing normals" << endl;
+    return false;
+  }
+
+  vtkIdType numPts = input->GetNumberOfPoints();
+  std::vector<float> expected(3 * numPts, 0.0f);
+  vtkCellArray *polys = input->GetPolys();
+  vtkIdType npts, *pts, cellId;
+  double n[3];
+  for (cellId = 0, polys->InitTraversal(); polys->GetNextCell(npts, pts);
+       ++cellId)
+  {
+    vtkPolygon::ComputeNormal(input->GetPoints(), npts, pts, n);
+    float cellNormal[3] = {static_cast<float>(n[0]),
+                           static_cast<float>(n[1]),
+                           static_cast<float>(n[2])};
+    float *computed = cellNormals->GetPointer(3 * cellId);
+    for (int j = 0; j < 3; ++j)
+    {
+      if (computed[j] != cellNormal[j])
+      {
+        cerr << "Wrong normal for cell " << cellId << endl;
+        return false;
+      }
+    }
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        expected[3 * pts[i] + j] += cellNormal[j];
+      }
+    }
+  }
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    float *e = &expected[3 * i];
+    const double length = sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+    float *computed = pointNormals->GetPointer(3 * i);
+    for (int j = 0; j < 3; ++j)
+    {
+      e[j] /= length;
+      if (fabs(computed[j] - e[j]) > 1.0e-6)
+      {
+        cerr << "Wrong normal for point " << i << ": " << computed[j]
+             << " instead of " << e[j] << endl;
+        return false;
+      }
+    }
+  }
+
+  // Splitting the sharp edges of a cube gives 3 points per corner, whose
+  // normals are the normals of the faces.
+  normals->SetInputData(MakeCube());
+  normals->SplittingOn();
+  normals->ConsistencyOn();
+  normals->ComputeCellNormalsOff();
+  normals->Update();
+  output = normals->GetOutput();
+  pointNormals = vtkArrayDownCast<vtkFloatArray>(
+    output->GetPointData()->GetNormals());
+  if (output->GetNumberOfPoints() != 24 || !pointNormals)
+  {
+    cerr << "Expected 24 points after splitting but got "
+         << output->GetNumberOfPoints() << endl;
+    return false;
+  }
+  polys = output->GetPolys();
+  for (cellId = 0, polys->InitTraversal(); polys->GetNextCell(npts, pts);
+       ++cellId)
+  {
+    vtkPolygon::ComputeNormal(output->GetPoints(), npts, pts, n);
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      float *computed = pointNormals->GetPointer(3 * pts[i]);
+      if (fabs(computed[0] - n[0]) > 1.0e-6 ||
+          fabs(computed[1] - n[1]) > 1.0e-6 ||
+          fabs(computed[2] - n[2]) > 1.0e-6)
+      {
+        cerr << "Wrong normal for point " << pts[i] << " of face "
+             << cellId << endl;
+        return false;
+      }
+      for (vtkIdType k = 0; k < i; ++k)
+      {
+        if (pts[k] == pts[i])
+        {
+          cerr << "Face " << cellId << " uses point " << pts[i]
+               << " twice" << endl;
+          return false;
+        }
+      }
+    }
+  }
+
+  // With a feature angle above 90 degrees, nothing is split.
+  normals->SetFeatureAngle(120.0);
+  normals->Update();
+  if (normals->GetOutput()->GetNumberOfPoints() != 8)
+  {
+    cerr << "Expected 8 points without splitting but got "
+         << normals->GetOutput()->GetNumberOfPoints() << endl;
+    return false;
+  }
+
+  return true;
+}
+}
+
+int TestPolyDataNormals(int, char *[])
+{
+  if (!CheckNormals(0) || !CheckNormals(1))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
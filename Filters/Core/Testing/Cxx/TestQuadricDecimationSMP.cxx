@@ -0,0 +1,106 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestQuadricDecimationSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded computation of the quadrics and costs of
+// vtkQuadricDecimation produces the same mesh as the serial one, and that
+// the lazy edge queue reaches the requested reduction.
+
+#include "vtkCellArray.h"
+#include "vtkDoubleArray.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkQuadricDecimation.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+
+namespace
+{
+// A noisy half sphere, so that it has boundary edges, with point scalars.
+vtkSmartPointer<vtkPolyData> MakeSurface()
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(60);
+  sphere->SetPhiResolution(40);
+  sphere->SetEndTheta(180.0);
+  sphere->Update();
+
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  surface->DeepCopy(sphere->GetOutput());
+
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  vtkPoints *points = surface->GetPoints();
+  vtkNew<vtkDoubleArray> scalars;
+  scalars->SetName("scalars");
+  scalars->SetNumberOfTuples(points->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+  {
+    points->GetPoint(i, x);
+    for (int j = 0; j < 3; ++j)
+    {
+      random->Next();
+      x[j] += 0.01 * (random->GetValue() - 0.5);
+    }
+    points->SetPoint(i, x);
+    scalars->SetValue(i, x[0] * x[1] + x[2]);
+  }
+  surface->GetPointData()->SetScalars(scalars.Get());
+  return surface;
+}
+
+bool CheckDecimation(vtkPolyData *input, int options)
+{
+  vtkNew<vtkQuadricDecimation> serial;
+  vtkNew<vtkQuadricDecimation> threaded;
+  vtkQuadricDecimation *decimators[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; ++i)
+  {
+    decimators[i]->SetInputData(input);
+    decimators[i]->SetTargetReduction(0.8);
+    decimators[i]->SetAttributeErrorMetric(options & 1);
+    decimators[i]->SetVolumePreservation((options >> 1) & 1);
+    decimators[i]->SetLazyEdgeQueue((options >> 2) & 1);
+    decimators[i]->SetEnableSMP(i);
+    decimators[i]->Update();
+  }
+  if (threaded->GetActualReduction() < 0.75)
+  {
+    cerr << "Expected a reduction of 0.8 but got "
+         << threaded->GetActualReduction() << endl;
+    return false;
+  }
+  return vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                               threaded->GetOutput());
+}
+}
+
+int TestQuadricDecimationSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input = MakeSurface();
+  for (int options = 0; options < 8; ++options)
+  {
+    if (!CheckDecimation(input, options))
+    {
+      cerr << "Threaded decimation differs for options " << options << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSmoothPolyDataFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded vtkWindowedSincPolyDataFilter produces the same
+// points as the serial one, and that the threaded vtkSmoothPolyDataFilter
+// does not depend on the number of threads and stays close to the serial
+// one.
+
+#include "vtkCellArray.h"
+#include "vtkMath.h"
+#include "vtkMinimalStandardRandomSequence.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+#include "vtkSmoothPolyDataFilter.h"
+#include "vtkSphereSource.h"
+#include "vtkStripper.h"
+#include "vtkWindowedSincPolyDataFilter.h"
+
+namespace
+{
+// A noisy half sphere, so that it has boundary edges, with a polyline and
+// a vertex on it. If strips is true, the triangles are stripped.
+vtkSmartPointer<vtkPolyData> MakeSurface(int dataType, bool strips)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(40);
+  sphere->SetPhiResolution(30);
+  sphere->SetEndTheta(180.0);
+  sphere->SetOutputPointsPrecision(dataType == VTK_DOUBLE ?
+    vtkAlgorithm::DOUBLE_PRECISION : vtkAlgorithm::SINGLE_PRECISION);
+  sphere->Update();
+
+  vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+  if (strips)
+  {
+    vtkNew<vtkStripper> stripper;
+    stripper->SetInputConnection(sphere->GetOutputPort());
+    stripper->Update();
+    surface->DeepCopy(stripper->GetOutput());
+  }
+  else
+  {
+    surface->DeepCopy(sphere->GetOutput());
+  }
+
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  vtkPoints *points = surface->GetPoints();
+  double x[3];
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+  {
+    points->GetPoint(i, x);
+    for (int j = 0; j < 3; ++j)
+    {
+      random->Next();
+      x[j] += 0.02 * (random->GetValue() - 0.5);
+    }
+    points->SetPoint(i, x);
+  }
+
+  vtkNew<vtkCellArray> lines;
+  lines->InsertNextCell(5);
+  for (vtkIdType i = 100; i < 105; ++i)
+  {
+    lines->InsertCellPoint(i);
+  }
+  surface->SetLines(lines.Get());
+  vtkNew<vtkCellArray> verts;
+  verts->InsertNextCell(1);
+  verts->InsertCellPoint(300);
+  surface->SetVerts(verts.Get());
+  return surface;
+}
+
+// The largest distance between the points of pd1 and pd2.
+double MaximumDistance(vtkPolyData *pd1, vtkPolyData *pd2)
+{
+  if (pd1->GetNumberOfPoints() != pd2->GetNumberOfPoints())
+  {
+    return VTK_DOUBLE_MAX;
+  }
+  double maxDist = 0.0;
+  double x1[3], x2[3];
+  for (vtkIdType i = 0; i < pd1->GetNumberOfPoints(); ++i)
+  {
+    pd1->GetPoint(i, x1);
+    pd2->GetPoint(i, x2);
+    double dist = sqrt(vtkMath::Distance2BetweenPoints(x1, x2));
+    maxDist = dist > maxDist ? dist : maxDist;
+  }
+  return maxDist;
+}
+
+bool CheckWindowedSinc(vtkPolyData *input, int options)
+{
+  vtkNew<vtkWindowedSincPolyDataFilter> serial;
+  vtkNew<vtkWindowedSincPolyDataFilter> threaded;
+  vtkWindowedSincPolyDataFilter *smoothers[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; ++i)
+  {
+    smoothers[i]->SetInputData(input);
+    smoothers[i]->SetNumberOfIterations(15);
+    smoothers[i]->SetFeatureEdgeSmoothing(options & 1);
+    smoothers[i]->SetBoundarySmoothing((options >> 1) & 1);
+    smoothers[i]->SetNonManifoldSmoothing((options >> 2) & 1);
+    smoothers[i]->SetNormalizeCoordinates((options >> 3) & 1);
+    smoothers[i]->SetFeatureAngle(20.0);
+    smoothers[i]->SetEnableSMP(i);
+    smoothers[i]->Update();
+  }
+  return MaximumDistance(serial->GetOutput(), threaded->GetOutput()) == 0.0;
+}
+
+vtkSmartPointer<vtkPolyData> SmoothLaplacian(vtkPolyData *input, int options,
+                                             int enableSMP)
+{
+  vtkNew<vtkSmoothPolyDataFilter> smoother;
+  smoother->SetInputData(input);
+  smoother->SetNumberOfIterations(30);
+  smoother->SetRelaxationFactor(0.1);
+  smoother->SetFeatureEdgeSmoothing(options & 1);
+  smoother->SetBoundarySmoothing((options >> 1) & 1);
+  smoother->SetFeatureAngle(20.0);
+  smoother->SetEnableSMP(enableSMP);
+  smoother->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(smoother->GetOutput());
+  return output;
+}
+
+bool CheckLaplacian(vtkPolyData *input, int options)
+{
+  vtkSmartPointer<vtkPolyData> serial = SmoothLaplacian(input, options, 0);
+  vtkSMPTools::Initialize(1);
+  vtkSmartPointer<vtkPolyData> threaded1 = SmoothLaplacian(input, options, 1);
+  vtkSMPTools::Initialize(4);
+  vtkSmartPointer<vtkPolyData> threaded4 = SmoothLaplacian(input, options, 1);
+  if (MaximumDistance(threaded1, threaded4) != 0.0)
+  {
+    cerr << "The threaded smoothing depends on the number of threads" << endl;
+    return false;
+  }
+  // Jacobi and Gauss-Seidel iterations converge to the same surface.
+  double dist = MaximumDistance(serial, threaded4);
+  if (dist > 0.01 * input->GetLength())
+  {
+    cerr << "The threaded smoothing is too far from the serial one: "
+         << dist << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestSmoothPolyDataFilterSMP(int, char *[])
+{
+  int dataTypes[2] = {VTK_FLOAT, VTK_DOUBLE};
+  for (int t = 0; t < 2; ++t)
+  {
+    for (int strips = 0; strips < 2; ++strips)
+    {
+      vtkSmartPointer<vtkPolyData> input =
+        MakeSurface(dataTypes[t], strips != 0);
+      for (int options = 0; options < 16; ++options)
+      {
+        if (!CheckWindowedSinc(input, options))
+        {
+          cerr << "Threaded windowed sinc smoothing differs for data type "
+               << dataTypes[t] << ", strips " << strips << " and options "
+               << options << endl;
+          return EXIT_FAILURE;
+        }
+      }
+      for (int options = 0; options < 4; ++options)
+      {
+        if (!CheckLaplacian(input, options))
+        {
+          cerr << "Threaded Laplacian smoothing failed for data type "
+               << dataTypes[t] << ", strips " << strips << " and options "
+               << options << endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
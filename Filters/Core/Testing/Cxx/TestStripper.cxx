@@ -85,7 +85,7 @@ TestSpherePlaneIntersection(bool joinSegments)
   {
     if (intersectionMapper->GetInput()->GetNumberOfLines() != 2)
     {
-      return true;
+      return false;
     }
   }
   else
@@ -99,9 +99,57 @@ TestSpherePlaneIntersection(bool joinSegments)
   return true;
 }
 
+bool
+TestJoinContiguousSegments()
+{
+  // A polyline made of 3 segments, given in an order that the stripping
+  // alone turns into 2 lines
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->InsertNextPoint(0, 0, 0);
+  points->InsertNextPoint(1, 0, 0);
+  points->InsertNextPoint(2, 0, 0);
+  points->InsertNextPoint(3, 0, 0);
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  vtkIdType segments[3][2] = {{1, 2}, {3, 2}, {0, 1}};
+  for (int i = 0; i < 3; i++)
+  {
+    lines->InsertNextCell(2, segments[i]);
+  }
+  vtkSmartPointer<vtkPolyData> polyLine = vtkSmartPointer<vtkPolyData>::New();
+  polyLine->SetPoints(points);
+  polyLine->SetLines(lines);
+
+  vtkSmartPointer<vtkStripper> stripper = vtkSmartPointer<vtkStripper>::New();
+  stripper->SetInputData(polyLine);
+  stripper->Update();
+  if (stripper->GetOutput()->GetNumberOfLines() != 2)
+  {
+    return false;
+  }
+
+  stripper->JoinContiguousSegmentsOn();
+  stripper->Update();
+  vtkPolyData *output = stripper->GetOutput();
+  if (output->GetNumberOfLines() != 1)
+  {
+    return false;
+  }
+  vtkIdType npts;
+  vtkIdType *pts;
+  output->GetLines()->InitTraversal();
+  output->GetLines()->GetNextCell(npts, pts);
+  return (pts[0] == 0 && pts[npts - 1] == 3) ||
+    (pts[0] == 3 && pts[npts - 1] == 0);
+}
+
 int
 TestStripper(int, char *[])
 {
+  if (!TestJoinContiguousSegments())
+  {
+    return EXIT_FAILURE;
+  }
+
   if (!TestSpherePlaneIntersection(false))
   {
     return EXIT_FAILURE;
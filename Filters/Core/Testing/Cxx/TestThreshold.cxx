@@ -21,6 +21,141 @@
 #include "vtkImageData.h"
 #include "vtkPointData.h"
 #include "vtkFloatArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkPoints.h"
+#include "vtkBitArray.h"
+#include "vtkStringArray.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkVariant.h"
+
+#include <vector>
+
+namespace
+{
+// Two cubes side by side: a hexahedron and a polyhedron sharing a face.
+// The cell scalars are the cell ids, and the point scalars the point ids.
+vtkSmartPointer<vtkUnstructuredGrid> MakeHexAndPolyhedron()
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int k = 0; k < 2; ++k)
+  {
+    for (int j = 0; j < 2; ++j)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        points->InsertNextPoint(i, j, k);
+      }
+    }
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points);
+  grid->Allocate(2);
+  vtkIdType hex[8] = {0, 1, 4, 3, 6, 7, 10, 9};
+  grid->InsertNextCell(VTK_HEXAHEDRON, 8, hex);
+  vtkIdType faces[] = {
+    4, 1, 4, 5, 2,   4, 7, 8, 11, 10,  4, 1, 2, 8, 7,
+    4, 4, 10, 11, 5, 4, 1, 7, 10, 4,   4, 2, 5, 11, 8 };
+  vtkIdType polyPts[8] = {1, 2, 5, 4, 7, 8, 11, 10};
+  grid->InsertNextCell(VTK_POLYHEDRON, 8, polyPts, 6, faces);
+
+  vtkSmartPointer<vtkIntArray> cellIds = vtkSmartPointer<vtkIntArray>::New();
+  cellIds->SetName("CellIds");
+  cellIds->InsertNextValue(0);
+  cellIds->InsertNextValue(1);
+  grid->GetCellData()->SetScalars(cellIds);
+  vtkSmartPointer<vtkIntArray> pointIds = vtkSmartPointer<vtkIntArray>::New();
+  pointIds->SetName("PointIds");
+  for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+  {
+    pointIds->InsertNextValue(i);
+  }
+  grid->GetPointData()->SetScalars(pointIds);
+  return grid;
+}
+
+// Check that the output points are numbered in order of first use by the
+// extracted cells, and that they match the input points.
+bool CheckCells(vtkUnstructuredGrid *input, vtkUnstructuredGrid *output)
+{
+  vtkDataArray *srcPtIds = output->GetPointData()->GetArray("PointIds");
+  vtkDataArray *srcCellIds = output->GetCellData()->GetArray("CellIds");
+  if (!srcPtIds || !srcCellIds)
+  {
+    return false;
+  }
+  std::vector<vtkIdType> pointMap(input->GetNumberOfPoints(), -1);
+  for (vtkIdType ptId = 0; ptId < output->GetNumberOfPoints(); ++ptId)
+  {
+    pointMap[static_cast<vtkIdType>(srcPtIds->GetComponent(ptId, 0))] = ptId;
+  }
+
+  vtkNew<vtkIdList> inPts;
+  vtkNew<vtkIdList> outPts;
+  vtkIdType nextPtId = 0;
+  for (vtkIdType cellId = 0; cellId < output->GetNumberOfCells(); ++cellId)
+  {
+    vtkIdType srcCellId =
+      static_cast<vtkIdType>(srcCellIds->GetComponent(cellId, 0));
+    if (input->GetCellType(srcCellId) != output->GetCellType(cellId))
+    {
+      return false;
+    }
+    input->GetCellPoints(srcCellId, inPts.Get());
+    for (vtkIdType i = 0; i < inPts->GetNumberOfIds(); ++i)
+    {
+      vtkIdType ptId = pointMap[inPts->GetId(i)];
+      if (ptId < 0 || ptId > nextPtId)
+      {
+        return false;
+      }
+      nextPtId += ptId == nextPtId ? 1 : 0;
+    }
+
+    // The points of a polyhedron are given by its face stream: the number
+    // of faces, then each face preceded by its number of points.
+    bool polyhedron = output->GetCellType(cellId) == VTK_POLYHEDRON;
+    if (polyhedron)
+    {
+      input->GetFaceStream(srcCellId, inPts.Get());
+      output->GetFaceStream(cellId, outPts.Get());
+    }
+    else
+    {
+      output->GetCellPoints(cellId, outPts.Get());
+    }
+    if (inPts->GetNumberOfIds() != outPts->GetNumberOfIds())
+    {
+      return false;
+    }
+    vtkIdType faceEnd = polyhedron ? 1 : outPts->GetNumberOfIds();
+    if (polyhedron && outPts->GetId(0) != inPts->GetId(0))
+    {
+      return false;
+    }
+    for (vtkIdType i = (polyhedron ? 1 : 0); i < outPts->GetNumberOfIds(); ++i)
+    {
+      if (i == faceEnd)
+      {
+        faceEnd += outPts->GetId(i) + 1;
+        if (outPts->GetId(i) != inPts->GetId(i))
+        {
+          return false;
+        }
+      }
+      else if (outPts->GetId(i) != pointMap[inPts->GetId(i)])
+      {
+        return false;
+      }
+    }
+  }
+  return nextPtId == output->GetNumberOfPoints();
+}
+}
+
 int TestThreshold(int, char *[])
 {
   //---------------------------------------------------
@@ -64,5 +199,111 @@ int TestThreshold(int, char *[])
     return EXIT_FAILURE;
   }
 
+  //---------------------------------------------------
+  // Test the connectivity of the extracted cells
+  //---------------------------------------------------
+  filter->ThresholdBetween(L,U);
+  filter->Update();
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->DeepCopy(filter->GetOutput());
+  vtkNew<vtkIntArray> gridCellIds;
+  gridCellIds->SetName("CellIds");
+  vtkNew<vtkIntArray> gridPointIds;
+  gridPointIds->SetName("PointIds");
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); ++i)
+  {
+    gridCellIds->InsertNextValue(i);
+  }
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); ++i)
+  {
+    gridPointIds->InsertNextValue(i);
+  }
+  grid->GetCellData()->AddArray(gridCellIds.Get());
+  grid->GetPointData()->AddArray(gridPointIds.Get());
+  vtkNew<vtkThreshold> cellFilter;
+  cellFilter->SetInputData(grid);
+  cellFilter->SetAllScalars(1);
+  cellFilter->UseContinuousCellRangeOff();
+  cellFilter->ThresholdBetween(120,180);
+  cellFilter->Update();
+  if (cellFilter->GetOutput()->GetNumberOfCells() == 0 ||
+      !CheckCells(grid, cellFilter->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+  vtkIdType numCells = cellFilter->GetOutput()->GetNumberOfCells();
+  cellFilter->EnableSMPOn();
+  cellFilter->Update();
+  if (cellFilter->GetOutput()->GetNumberOfCells() != numCells ||
+      !CheckCells(grid, cellFilter->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
+  // The attributes are copied in parallel when the arrays can be paired by
+  // name, also for string and bit arrays, and serially otherwise.
+  vtkNew<vtkStringArray> names;
+  names->SetName("Names");
+  vtkNew<vtkBitArray> bits;
+  bits->SetName("Bits");
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); ++i)
+  {
+    names->InsertNextValue(vtkVariant(i).ToString());
+    bits->InsertNextValue(i % 3 == 0);
+  }
+  grid->GetCellData()->AddArray(names.Get());
+  grid->GetCellData()->AddArray(bits.Get());
+  vtkNew<vtkThreshold> serialFilter;
+  serialFilter->SetInputData(grid);
+  serialFilter->SetAllScalars(1);
+  serialFilter->UseContinuousCellRangeOff();
+  serialFilter->ThresholdBetween(120,180);
+  for (int unnamed = 0; unnamed < 2; ++unnamed)
+  {
+    if (unnamed)
+    {
+      vtkNew<vtkFloatArray> vectors;
+      vectors->SetNumberOfComponents(3);
+      for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); ++i)
+      {
+        vectors->InsertNextTuple3(i, -i, 0.5 * i);
+      }
+      grid->GetPointData()->SetVectors(vectors.Get());
+    }
+    serialFilter->Modified();
+    serialFilter->Update();
+    cellFilter->Modified();
+    cellFilter->Update();
+    if (!cellFilter->GetOutput()->GetCellData()->GetAbstractArray("Names") ||
+        !cellFilter->GetOutput()->GetCellData()->GetAbstractArray("Bits") ||
+        !vtkTestDataSetUtilities::SameDataSets(serialFilter->GetOutput(),
+                                               cellFilter->GetOutput()))
+    {
+      cerr << "Threaded attributes differ" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  vtkSmartPointer<vtkUnstructuredGrid> polyhedra = MakeHexAndPolyhedron();
+  cellFilter->SetInputData(polyhedra);
+  cellFilter->SetInputArrayToProcess(0, 0, 0,
+    vtkDataObject::FIELD_ASSOCIATION_CELLS, "CellIds");
+  cellFilter->ThresholdBetween(0,1);
+  cellFilter->Update();
+  if (cellFilter->GetOutput()->GetNumberOfCells() != 2 ||
+      !CheckCells(polyhedra, cellFilter->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+  cellFilter->ThresholdBetween(1,1);
+  cellFilter->Update();
+  if (cellFilter->GetOutput()->GetNumberOfCells() != 1 ||
+      cellFilter->GetOutput()->GetNumberOfPoints() != 8 ||
+      !CheckCells(polyhedra, cellFilter->GetOutput()))
+  {
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
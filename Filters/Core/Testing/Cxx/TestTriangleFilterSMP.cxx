@@ -0,0 +1,247 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTriangleFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded vtkTriangleFilter produces the same cells as the
+// serial one (the same area for quads, which are split differently), and
+// that stripping its output with vtkStripper keeps all the triangles.
+
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkIdList.h"
+#include "vtkIntArray.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkStripper.h"
+#include "vtkTriangle.h"
+#include "vtkTriangleFilter.h"
+
+namespace
+{
+// A sphere (triangles and strips) with a polyline, a polyvertex and a few
+// polygons away from it: pentagons, and if withQuads is true a convex and a
+// concave quad.
+vtkSmartPointer<vtkPolyData> MakeInput(bool withQuads)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(30);
+  sphere->SetPhiResolution(20);
+  vtkNew<vtkStripper> stripper;
+  stripper->SetInputConnection(sphere->GetOutputPort());
+  stripper->SetMaximumLength(20);
+  stripper->Update();
+
+  vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+  input->DeepCopy(stripper->GetOutput());
+  vtkPoints *points = input->GetPoints();
+
+  // Put back some triangles next to the strips.
+  vtkNew<vtkCellArray> polys;
+  sphere->Update();
+  vtkCellArray *sphereTris = sphere->GetOutput()->GetPolys();
+  vtkIdType npts, *pts;
+  sphereTris->InitTraversal();
+  for (int i = 0; i < 50 && sphereTris->GetNextCell(npts, pts); i++)
+  {
+    polys->InsertNextCell(npts, pts);
+  }
+
+  vtkIdType ptIds[5];
+  for (int j = 0; j < 3; j++)
+  {
+    for (int i = 0; i < 5; i++)
+    {
+      double angle = 2.0 * vtkMath::Pi() * i / 5.0;
+      ptIds[i] = points->InsertNextPoint(
+        2.0 + cos(angle), sin(angle), 0.5 * j);
+    }
+    polys->InsertNextCell(5, ptIds);
+  }
+  if (withQuads)
+  {
+    ptIds[0] = points->InsertNextPoint(3.0, 0.0, 0.0);
+    ptIds[1] = points->InsertNextPoint(4.0, 0.0, 0.0);
+    ptIds[2] = points->InsertNextPoint(4.0, 1.0, 0.0);
+    ptIds[3] = points->InsertNextPoint(3.0, 1.0, 0.0);
+    polys->InsertNextCell(4, ptIds);
+    ptIds[2] = points->InsertNextPoint(3.2, 0.2, 0.0);
+    polys->InsertNextCell(4, ptIds);
+  }
+  input->SetPolys(polys.Get());
+
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  verts->InsertNextCell(4);
+  lines->InsertNextCell(6);
+  for (vtkIdType i = 0; i < 6; i++)
+  {
+    if (i < 4)
+    {
+      verts->InsertCellPoint(i);
+    }
+    lines->InsertCellPoint(10 + i);
+  }
+  lines->InsertNextCell(2);
+  lines->InsertCellPoint(0);
+  lines->InsertCellPoint(1);
+  input->SetVerts(verts.Get());
+  input->SetLines(lines.Get());
+
+  vtkNew<vtkIntArray> cellIds;
+  cellIds->SetName("cellIds");
+  cellIds->SetNumberOfTuples(input->GetNumberOfCells());
+  for (vtkIdType i = 0; i < input->GetNumberOfCells(); i++)
+  {
+    cellIds->SetValue(i, static_cast<int>(i));
+  }
+  input->GetCellData()->AddArray(cellIds.Get());
+  return input;
+}
+
+double CellArea(vtkPolyData *pd, vtkIdType cellId)
+{
+  vtkNew<vtkIdList> ids;
+  pd->GetCellPoints(cellId, ids.Get());
+  if (ids->GetNumberOfIds() != 3)
+  {
+    return 0.0;
+  }
+  double x[3][3];
+  for (int i = 0; i < 3; i++)
+  {
+    pd->GetPoint(ids->GetId(i), x[i]);
+  }
+  return vtkTriangle::TriangleArea(x[0], x[1], x[2]);
+}
+
+// Compare the cells and their data; with exact false, only compare the
+// types and areas of the cells.
+bool SameCells(vtkPolyData *pd1, vtkPolyData *pd2, bool exact)
+{
+  if (pd1->GetNumberOfVerts() != pd2->GetNumberOfVerts() ||
+      pd1->GetNumberOfLines() != pd2->GetNumberOfLines() ||
+      pd1->GetNumberOfPolys() != pd2->GetNumberOfPolys() ||
+      pd1->GetNumberOfStrips() != pd2->GetNumberOfStrips())
+  {
+    cerr << "Expected " << pd1->GetNumberOfCells() << " cells but got "
+         << pd2->GetNumberOfCells() << endl;
+    return false;
+  }
+  vtkIntArray *ids1 =
+    vtkIntArray::SafeDownCast(pd1->GetCellData()->GetArray("cellIds"));
+  vtkIntArray *ids2 =
+    vtkIntArray::SafeDownCast(pd2->GetCellData()->GetArray("cellIds"));
+  if (!ids1 || !ids2)
+  {
+    cerr << "Missing cell data" << endl;
+    return false;
+  }
+  vtkNew<vtkIdList> pts1;
+  vtkNew<vtkIdList> pts2;
+  double area1 = 0.0;
+  double area2 = 0.0;
+  for (vtkIdType i = 0; i < pd1->GetNumberOfCells(); i++)
+  {
+    pd1->GetCellPoints(i, pts1.Get());
+    pd2->GetCellPoints(i, pts2.Get());
+    bool same = pd1->GetCellType(i) == pd2->GetCellType(i) &&
+      pts1->GetNumberOfIds() == pts2->GetNumberOfIds() &&
+      ids1->GetValue(i) == ids2->GetValue(i);
+    for (vtkIdType j = 0; exact && same && j < pts1->GetNumberOfIds(); j++)
+    {
+      same = pts1->GetId(j) == pts2->GetId(j);
+    }
+    if (!same)
+    {
+      cerr << "Cell " << i << " differs" << endl;
+      return false;
+    }
+    area1 += CellArea(pd1, i);
+    area2 += CellArea(pd2, i);
+  }
+  if (fabs(area1 - area2) > 1e-9 * area1)
+  {
+    cerr << "Expected an area of " << area1 << " but got " << area2 << endl;
+    return false;
+  }
+  return true;
+}
+
+bool CheckTriangleFilter(vtkPolyData *input, int options, bool exact)
+{
+  vtkNew<vtkTriangleFilter> serial;
+  vtkNew<vtkTriangleFilter> threaded;
+  vtkTriangleFilter *filters[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; i++)
+  {
+    filters[i]->SetInputData(input);
+    filters[i]->SetPassVerts(options & 1);
+    filters[i]->SetPassLines((options >> 1) & 1);
+    filters[i]->SetEnableSMP(i);
+    filters[i]->Update();
+  }
+  return SameCells(serial->GetOutput(), threaded->GetOutput(), exact);
+}
+
+// Strip the triangles of input and triangulate the strips again.
+bool CheckStripper(vtkPolyData *input)
+{
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputData(input);
+  triangles->SetEnableSMP(1);
+  triangles->PassVertsOff();
+  triangles->PassLinesOff();
+  vtkNew<vtkStripper> stripper;
+  stripper->SetInputConnection(triangles->GetOutputPort());
+  vtkNew<vtkTriangleFilter> retriangles;
+  retriangles->SetInputConnection(stripper->GetOutputPort());
+  retriangles->SetEnableSMP(1);
+  retriangles->Update();
+  vtkIdType numTris = triangles->GetOutput()->GetNumberOfPolys();
+  if (stripper->GetOutput()->GetNumberOfStrips() >= numTris ||
+      retriangles->GetOutput()->GetNumberOfPolys() != numTris)
+  {
+    cerr << "Stripped " << numTris << " triangles into "
+         << stripper->GetOutput()->GetNumberOfStrips() << " strips and "
+         << retriangles->GetOutput()->GetNumberOfPolys() << " triangles"
+         << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestTriangleFilterSMP(int, char *[])
+{
+  vtkSmartPointer<vtkPolyData> input = MakeInput(false);
+  vtkSmartPointer<vtkPolyData> inputWithQuads = MakeInput(true);
+  for (int options = 0; options < 4; options++)
+  {
+    if (!CheckTriangleFilter(input, options, true) ||
+        !CheckTriangleFilter(inputWithQuads, options, false))
+    {
+      cerr << "Threaded triangulation differs for options " << options << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (!CheckStripper(input))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
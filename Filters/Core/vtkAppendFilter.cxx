@@ -14,33 +14,235 @@
 =========================================================================*/
 #include "vtkAppendFilter.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkBoundingBox.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSetAttributes.h"
 #include "vtkDataSetCollection.h"
 #include "vtkExecutive.h"
+#include "vtkIdTypeArray.h"
 #include "vtkIncrementalOctreePointLocator.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <set>
 #include <string>
+#include <vector>
 
 vtkStandardNewMacro(vtkAppendFilter);
 
+namespace
+{
+//----------------------------------------------------------------------------
+// Copy all the tuples of src to dest, from tuple Offset on.
+struct AppendDataWorker
+{
+  vtkIdType Offset;
+
+  AppendDataWorker(vtkIdType offset) : Offset(offset) {}
+
+  template <typename Array1T, typename Array2T>
+  void operator()(Array1T *dest, Array2T *src)
+  {
+    vtkDataArrayAccessor<Array1T> d(dest);
+    vtkDataArrayAccessor<Array2T> s(src);
+
+    const vtkIdType numTuples = src->GetNumberOfTuples();
+    const int numComps = src->GetNumberOfComponents();
+
+    for (vtkIdType t = 0; t < numTuples; ++t)
+    {
+      for (int c = 0; c < numComps; ++c)
+      {
+        d.Set(t + this->Offset, c, s.Get(t, c));
+      }
+    }
+  }
+};
+
+void AppendData(vtkDataArray *dest, vtkDataArray *src, vtkIdType offset)
+{
+  AppendDataWorker worker(offset);
+  if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(dest, src, worker))
+  {
+    // Use vtkDataArray API when fast-path dispatch fails.
+    worker(dest, src);
+  }
+}
+
+// Whether distinct tuples of the array can be written concurrently.
+bool IsThreadSafe(vtkAbstractArray *array)
+{
+  return vtkDataArray::FastDownCast(array) != NULL &&
+    array->GetDataType() != VTK_BIT;
+}
+
+// The points of a cell, without copy for polydata and unstructured grids.
+inline const vtkIdType *GetCellPoints(vtkDataSet *ds, vtkPolyData *pd,
+                                      vtkUnstructuredGrid *ug,
+                                      vtkIdType cellId, vtkIdList *ptIds,
+                                      vtkIdType &npts)
+{
+  vtkIdType *pts;
+  if (ug)
+  {
+    ug->GetCellPoints(cellId, npts, pts);
+  }
+  else if (pd)
+  {
+    pd->GetCellPoints(cellId, npts, pts);
+  }
+  else
+  {
+    ds->GetCellPoints(cellId, ptIds);
+    npts = ptIds->GetNumberOfIds();
+    pts = ptIds->GetPointer(0);
+  }
+  return pts;
+}
+
+//----------------------------------------------------------------------------
+// Count the connectivity entries of the cells of each input, or append the
+// points and cells of each input to the output at the offsets computed from
+// these counts.
+struct AppendGeometryFunctor
+{
+  std::vector<vtkDataSet*> &Inputs;
+  std::vector<vtkIdType> &PointOffsets;
+  std::vector<vtkIdType> &CellOffsets;
+  std::vector<vtkIdType> &ConnectivityOffsets;
+  bool Count;
+  vtkDataArray *Points;
+  vtkIdType *Connectivity;
+  unsigned char *Types;
+  vtkIdType *Locations;
+  vtkSMPThreadLocalObject<vtkIdList> PointIds;
+
+  AppendGeometryFunctor(std::vector<vtkDataSet*> &inputs,
+                        std::vector<vtkIdType> &pointOffsets,
+                        std::vector<vtkIdType> &cellOffsets,
+                        std::vector<vtkIdType> &connectivityOffsets)
+    : Inputs(inputs), PointOffsets(pointOffsets), CellOffsets(cellOffsets),
+      ConnectivityOffsets(connectivityOffsets), Count(true), Points(NULL),
+      Connectivity(NULL), Types(NULL), Locations(NULL)
+  {
+  }
+
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdList *ptIds = this->PointIds.Local();
+    double x[3];
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      vtkDataSet *ds = this->Inputs[idx];
+      vtkPolyData *pd = vtkPolyData::SafeDownCast(ds);
+      vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(ds);
+      vtkIdType numCells = ds->GetNumberOfCells();
+      vtkIdType npts;
+      const vtkIdType *pts;
+
+      if (this->Count)
+      {
+        // stored for now in the offset of the next input
+        vtkIdType size = 0;
+        for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+        {
+          GetCellPoints(ds, pd, ug, cellId, ptIds, npts);
+          size += npts + 1;
+        }
+        this->ConnectivityOffsets[idx + 1] = size;
+        continue;
+      }
+
+      // copy points
+      vtkIdType ptOffset = this->PointOffsets[idx];
+      vtkPointSet *ps = vtkPointSet::SafeDownCast(ds);
+      if (ps && ps->GetPoints())
+      {
+        AppendData(this->Points, ps->GetPoints()->GetData(), ptOffset);
+      }
+      else
+      {
+        for (vtkIdType ptId = 0; ptId < ds->GetNumberOfPoints(); ++ptId)
+        {
+          ds->GetPoint(ptId, x);
+          this->Points->SetTuple(ptId + ptOffset, x);
+        }
+      }
+
+      // copy cells
+      vtkIdType cellOffset = this->CellOffsets[idx];
+      vtkIdType loc = this->ConnectivityOffsets[idx];
+      for (vtkIdType cellId = 0; cellId < numCells; ++cellId)
+      {
+        pts = GetCellPoints(ds, pd, ug, cellId, ptIds, npts);
+        this->Types[cellOffset + cellId] =
+          static_cast<unsigned char>(ds->GetCellType(cellId));
+        this->Locations[cellOffset + cellId] = loc;
+        this->Connectivity[loc++] = npts;
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          this->Connectivity[loc++] = pts[j] + ptOffset;
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+//----------------------------------------------------------------------------
+// Copy the tuples of the arrays of the inputs to the output arrays.
+struct AppendArraysFunctor
+{
+  struct Task
+  {
+    vtkDataArray *Destination;
+    vtkDataArray *Source;
+    vtkIdType Offset;
+  };
+
+  std::vector<Task> &Tasks;
+
+  AppendArraysFunctor(std::vector<Task> &tasks) : Tasks(tasks) {}
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const Task &task = this->Tasks[i];
+      AppendData(task.Destination, task.Source, task.Offset);
+    }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 vtkAppendFilter::vtkAppendFilter()
 {
   this->InputList = NULL;
   this->MergePoints = 0;
   this->OutputPointsPrecision = DEFAULT_PRECISION;
+  this->EnableSMP = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -165,9 +367,6 @@ int vtkAppendFilter::RequestData(
     return 1;
   }
 
-  // Now we can allocate memory
-  output->Allocate(totalNumCells);
-
   vtkSmartPointer<vtkPoints> newPts = vtkSmartPointer<vtkPoints>::New();
 
   // set precision for the points in the output
@@ -200,6 +399,27 @@ int vtkAppendFilter::RequestData(
     newPts->SetDataType(VTK_DOUBLE);
   }
 
+  // The threaded append shares the geometry of a single unstructured grid,
+  // or copies the inputs concurrently. All the arrays are then allocated to
+  // their exact size, or shared, and need no squeeze.
+  if (this->EnableSMP && !reallyMergePoints &&
+      ((numInputs == 1 &&
+        this->PassGeometry(inputs->GetItem(0), newPts, output)) ||
+       this->AppendGeometry(inputs, newPts, output)))
+  {
+    this->UpdateProgress(0.5);
+    this->AppendArrays(
+      vtkDataObject::POINT, inputVector, NULL, output, totalNumPts);
+    this->UpdateProgress(0.75);
+    this->AppendArrays(
+      vtkDataObject::CELL, inputVector, NULL, output, totalNumCells);
+    this->UpdateProgress(1.0);
+    return 1;
+  }
+
+  // Now we can allocate memory
+  output->Allocate(totalNumCells);
+
   // If we aren't merging points, we need to allocate the points here.
   if (!reallyMergePoints)
   {
@@ -334,6 +554,85 @@ int vtkAppendFilter::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+bool vtkAppendFilter::PassGeometry(vtkDataSet *input, vtkPoints *newPts,
+                                   vtkUnstructuredGrid *output)
+{
+  vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(input);
+  if (!ug || !ug->GetPoints() || !ug->GetCells() ||
+      !ug->GetCellTypesArray() || !ug->GetCellLocationsArray() ||
+      ug->GetPoints()->GetDataType() != newPts->GetDataType())
+  {
+    return false;
+  }
+
+  output->SetPoints(ug->GetPoints());
+  output->SetCells(ug->GetCellTypesArray(), ug->GetCellLocationsArray(),
+                   ug->GetCells(), ug->GetFaceLocations(), ug->GetFaces());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkAppendFilter::AppendGeometry(vtkDataSetCollection *inputs,
+                                     vtkPoints *newPts,
+                                     vtkUnstructuredGrid *output)
+{
+  int numInputs = inputs->GetNumberOfItems();
+  std::vector<vtkDataSet*> dataSets(numInputs);
+  std::vector<vtkIdType> ptOffsets(numInputs + 1, 0);
+  std::vector<vtkIdType> cellOffsets(numInputs + 1, 0);
+  std::vector<vtkIdType> connOffsets(numInputs + 1, 0);
+  vtkNew<vtkIdList> ptIds;
+  for (int inputIndex = 0; inputIndex < numInputs; ++inputIndex)
+  {
+    vtkDataSet *dataSet = inputs->GetItem(inputIndex);
+    vtkUnstructuredGrid *ug = vtkUnstructuredGrid::SafeDownCast(dataSet);
+    if (ug && ug->GetFaces())
+    {
+      return false;
+    }
+    // The cell queries are thread safe once called from a single thread.
+    if (dataSet->GetNumberOfCells() > 0)
+    {
+      dataSet->GetCellType(0);
+      dataSet->GetCellPoints(0, ptIds.Get());
+    }
+    dataSets[inputIndex] = dataSet;
+    ptOffsets[inputIndex + 1] =
+      ptOffsets[inputIndex] + dataSet->GetNumberOfPoints();
+    cellOffsets[inputIndex + 1] =
+      cellOffsets[inputIndex] + dataSet->GetNumberOfCells();
+  }
+
+  AppendGeometryFunctor appendGeometry(
+    dataSets, ptOffsets, cellOffsets, connOffsets);
+  vtkSMPTools::For(0, numInputs, appendGeometry);
+  for (int inputIndex = 0; inputIndex < numInputs; ++inputIndex)
+  {
+    connOffsets[inputIndex + 1] += connOffsets[inputIndex];
+  }
+
+  vtkIdType numCells = cellOffsets[numInputs];
+  newPts->SetNumberOfPoints(ptOffsets[numInputs]);
+  vtkNew<vtkCellArray> cells;
+  vtkNew<vtkUnsignedCharArray> types;
+  types->SetNumberOfValues(numCells);
+  vtkNew<vtkIdTypeArray> locations;
+  locations->SetNumberOfValues(numCells);
+
+  appendGeometry.Count = false;
+  appendGeometry.Points = newPts->GetData();
+  appendGeometry.Connectivity =
+    cells->WritePointer(numCells, connOffsets[numInputs]);
+  appendGeometry.Types = types->GetPointer(0);
+  appendGeometry.Locations = locations->GetPointer(0);
+  vtkSMPTools::For(0, numInputs, appendGeometry);
+
+  output->SetPoints(newPts);
+  output->SetCells(types.Get(), locations.Get(), cells.Get());
+  return true;
+}
+
 //----------------------------------------------------------------------------
 vtkDataSetCollection* vtkAppendFilter::GetNonEmptyInputs(vtkInformationVector ** inputVector)
 {
@@ -392,6 +691,12 @@ void vtkAppendFilter::AppendArrays(int attributesType,
   vtkSmartPointer<vtkDataSetCollection> inputs;
   inputs.TakeReference(this->GetNonEmptyInputs(inputVector));
   int numInputs = inputs->GetNumberOfItems();
+
+  // The threaded append shares the arrays of a single input with the
+  // output, and copies the other arrays concurrently.
+  bool parallel = this->EnableSMP && !globalIds;
+  bool share = parallel && numInputs == 1;
+
   for (int inputIndex = 0; inputIndex < numInputs; ++inputIndex)
   {
     vtkDataSet* dataSet = inputs->GetItem(inputIndex);
@@ -440,6 +745,11 @@ void vtkAppendFilter::AppendArrays(int attributesType,
   for (std::set<std::string>::iterator it = dataArrayNames.begin(); it != dataArrayNames.end(); ++it)
   {
     vtkAbstractArray* srcArray = firstInputData->GetAbstractArray((*it).c_str());
+    if (share)
+    {
+      outputData->AddArray(srcArray);
+      continue;
+    }
     vtkAbstractArray* dstArray = vtkAbstractArray::CreateArray(srcArray->GetDataType());
     dstArray->CopyInformation(srcArray->GetInformation());
     dstArray->SetName(srcArray->GetName());
@@ -547,6 +857,11 @@ void vtkAppendFilter::AppendArrays(int attributesType,
     if (attributeNeedsNullArray[attributeIndex])
     {
       vtkAbstractArray* srcArray = firstInputData->GetAttribute(attributeIndex);
+      if (share)
+      {
+        outputData->SetAttribute(srcArray, attributeIndex);
+        continue;
+      }
       vtkAbstractArray* dstArray = vtkAbstractArray::CreateArray(srcArray->GetDataType());
       dstArray->SetNumberOfComponents(srcArray->GetNumberOfComponents());
       for (int j = 0; j < srcArray->GetNumberOfComponents(); ++j)
@@ -565,6 +880,11 @@ void vtkAppendFilter::AppendArrays(int attributesType,
   //////////////////////////////////////////////////////////////
   // Phase 4 - Copy data
   //////////////////////////////////////////////////////////////
+  if (share)
+  {
+    return;
+  }
+  std::vector<AppendArraysFunctor::Task> tasks;
   vtkIdType offset = 0;
   for (int inputIndex = 0; inputIndex < numInputs; ++inputIndex)
   {
@@ -576,6 +896,13 @@ void vtkAppendFilter::AppendArrays(int attributesType,
       vtkAbstractArray* srcArray = inputData->GetAbstractArray(arrayName);
       vtkAbstractArray* dstArray = outputData->GetAbstractArray(arrayName);
 
+      if (parallel && IsThreadSafe(dstArray))
+      {
+        AppendArraysFunctor::Task task = {vtkDataArray::FastDownCast(dstArray),
+          vtkDataArray::FastDownCast(srcArray), offset};
+        tasks.push_back(task);
+        continue;
+      }
       for (vtkIdType id = 0; id < srcArray->GetNumberOfTuples(); ++id)
       {
         if (globalIds)
@@ -600,6 +927,14 @@ void vtkAppendFilter::AppendArrays(int attributesType,
       if (srcArray && !srcArray->GetName() &&
           dstArray && !dstArray->GetName())
       {
+        if (parallel && IsThreadSafe(dstArray))
+        {
+          AppendArraysFunctor::Task task = {
+            vtkDataArray::FastDownCast(dstArray),
+            vtkDataArray::FastDownCast(srcArray), offset};
+          tasks.push_back(task);
+          continue;
+        }
         for (vtkIdType id = 0; id < srcArray->GetNumberOfTuples(); ++id)
         {
           if (globalIds)
@@ -623,6 +958,9 @@ void vtkAppendFilter::AppendArrays(int attributesType,
       offset += dataSet->GetNumberOfCells();
     }
   }
+
+  AppendArraysFunctor appendArrays(tasks);
+  vtkSMPTools::For(0, static_cast<vtkIdType>(tasks.size()), appendArrays);
 }
 
 //----------------------------------------------------------------------------
@@ -663,4 +1001,5 @@ void vtkAppendFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "MergePoints:" << (this->MergePoints?"On":"Off") << "\n";
   os << indent << "OutputPointsPrecision: "
      << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -23,6 +23,13 @@
  * (For example, if one dataset has scalars but another does not, scalars will
  * not be appended.)
  *
+ * When EnableSMP is on and the points are not merged, the output sizes are
+ * computed up front, and the points, cells and attribute arrays of the
+ * inputs are then copied into the output concurrently (via vtkSMPTools).
+ * The output is the same as in the serial case. A single unstructured grid
+ * input shares its points, cells and arrays with the output instead. The
+ * inputs with polyhedral cells are always appended serially.
+ *
  * @sa
  * vtkAppendPolyData
 */
@@ -35,6 +42,7 @@
 
 class vtkDataSetAttributes;
 class vtkDataSetCollection;
+class vtkPoints;
 
 class VTKFILTERSCORE_EXPORT vtkAppendFilter : public vtkUnstructuredGridAlgorithm
 {
@@ -92,6 +100,16 @@ public:
   vtkGetMacro(OutputPointsPrecision, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded append of the inputs (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
 protected:
   vtkAppendFilter();
   ~vtkAppendFilter() VTK_OVERRIDE;
@@ -112,6 +130,8 @@ protected:
 
   int OutputPointsPrecision;
 
+  int EnableSMP;
+
 private:
   vtkAppendFilter(const vtkAppendFilter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkAppendFilter&) VTK_DELETE_FUNCTION;
@@ -120,6 +140,16 @@ private:
   // Caller must delete the returned vtkDataSetCollection.
   vtkDataSetCollection* GetNonEmptyInputs(vtkInformationVector ** inputVector);
 
+  // Share the points and cells of a single unstructured grid input with
+  // the output, if it has the output points precision.
+  bool PassGeometry(vtkDataSet *input, vtkPoints *newPts,
+                    vtkUnstructuredGrid *output);
+
+  // Append the points and cells of the inputs concurrently, unless some of
+  // them have polyhedral cells.
+  bool AppendGeometry(vtkDataSetCollection *inputs, vtkPoints *newPts,
+                      vtkUnstructuredGrid *output);
+
   void AppendArrays(int attributesType,
                     vtkInformationVector **inputVector,
                     vtkIdType* globalIds,
@@ -26,20 +26,302 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTrivialProducer.h"
 
 #include <cassert>
 #include <cstdlib>
+#include <vector>
 
 vtkStandardNewMacro(vtkAppendPolyData);
 
+//----------------------------------------------------------------------------
+namespace {
+struct AppendDataWorker
+{
+  vtkIdType Offset;
+  vtkIdType SrcStart;
+  vtkIdType NumberOfTuples;
+
+  AppendDataWorker(vtkIdType offset, vtkIdType srcStart,
+                   vtkIdType numTuples)
+    : Offset(offset), SrcStart(srcStart), NumberOfTuples(numTuples) {}
+
+  template <typename Array1T, typename Array2T>
+  void operator()(Array1T *dest, Array2T *src)
+  {
+    vtkDataArrayAccessor<Array1T> d(dest);
+    vtkDataArrayAccessor<Array2T> s(src);
+    VTK_ASSUME(src->GetNumberOfComponents() == dest->GetNumberOfComponents());
+
+    const int numComps = src->GetNumberOfComponents();
+
+    for (vtkIdType t = 0; t < this->NumberOfTuples; ++t)
+    {
+      for (int c = 0; c < numComps; ++c)
+      {
+        d.Set(t + this->Offset, c, s.Get(t + this->SrcStart, c));
+      }
+    }
+  }
+};
+
+// Whether distinct tuples of the array can be written concurrently.
+bool IsThreadSafe(vtkAbstractArray *array)
+{
+  return vtkDataArray::FastDownCast(array) != NULL &&
+    array->GetDataType() != VTK_BIT;
+}
+
+// Copy the n tuples of the fields of list from srcStart in the attributes
+// of input idx to dstStart in the output attributes, as
+// vtkDataSetAttributes::CopyData() does, but only for the arrays that can
+// (or cannot, if threadSafe is false) be written concurrently.
+void CopyFields(vtkDataSetAttributes::FieldList &list,
+                vtkDataSetAttributes *outputDSA, vtkDataSetAttributes *inDSA,
+                int idx, vtkIdType dstStart, vtkIdType n, vtkIdType srcStart,
+                bool threadSafe)
+{
+  if (n <= 0)
+  {
+    return;
+  }
+  for (int i = 0; i < list.GetNumberOfFields(); ++i)
+  {
+    if (list.GetFieldIndex(i) >= 0 && list.GetDSAIndex(idx, i) >= 0)
+    {
+      vtkAbstractArray *toDA =
+        outputDSA->GetAbstractArray(list.GetFieldIndex(i));
+      vtkAbstractArray *fromDA =
+        inDSA->GetAbstractArray(list.GetDSAIndex(idx, i));
+      if (IsThreadSafe(toDA) != threadSafe)
+      {
+        continue;
+      }
+      if (threadSafe)
+      {
+        AppendDataWorker worker(dstStart, srcStart, n);
+        vtkDataArray *dest = vtkDataArray::FastDownCast(toDA);
+        vtkDataArray *src = vtkDataArray::FastDownCast(fromDA);
+        if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(dest, src,
+                                                               worker))
+        {
+          worker(dest, src);
+        }
+      }
+      else
+      {
+        toDA->InsertTuples(dstStart, n, srcStart, fromDA);
+      }
+    }
+  }
+}
+} // end anon namespace
+
+//----------------------------------------------------------------------------
+// Copy each input into the output at the offsets computed up front. The
+// arrays that cannot be written concurrently (bit arrays, string
+// arrays...) are copied afterwards, in CopySerialArrays().
+struct vtkAppendPolyData::AppendInputs
+{
+  // Where an input goes in the output
+  struct Offsets
+  {
+    vtkIdType Points;
+    vtkIdType Verts;
+    vtkIdType Lines;
+    vtkIdType Polys;
+    vtkIdType Strips;
+    vtkIdType VertsConnectivity;
+    vtkIdType LinesConnectivity;
+    vtkIdType PolysConnectivity;
+    vtkIdType StripsConnectivity;
+    // The index of the input in the field lists, -1 if it has no points
+    // (resp. cells)
+    int PointListIndex;
+    int CellListIndex;
+  };
+
+  vtkAppendPolyData *Self;
+  vtkPolyData **Inputs;
+  vtkDataSetAttributes::FieldList &PointList;
+  vtkDataSetAttributes::FieldList &CellList;
+  vtkPointData *OutputPD;
+  vtkCellData *OutputCD;
+  vtkDataArray *Points;
+  // scalars, normals, vectors, tcoords and tensors, or NULL
+  vtkDataArray *PointAttributes[5];
+  vtkIdType *Verts;
+  vtkIdType *Lines;
+  vtkIdType *Polys;
+  vtkIdType *Strips;
+  std::vector<Offsets> InputOffsets;
+
+  AppendInputs(vtkAppendPolyData *self, vtkPolyData **inputs,
+               vtkDataSetAttributes::FieldList &ptList,
+               vtkDataSetAttributes::FieldList &cellList,
+               vtkPointData *outputPD, vtkCellData *outputCD,
+               vtkDataArray *points, vtkDataArray *pointAttributes[5],
+               vtkIdType *verts, vtkIdType *lines, vtkIdType *polys,
+               vtkIdType *strips)
+    : Self(self), Inputs(inputs), PointList(ptList), CellList(cellList),
+      OutputPD(outputPD), OutputCD(outputCD), Points(points), Verts(verts),
+      Lines(lines), Polys(polys), Strips(strips)
+  {
+    for (int i = 0; i < 5; ++i)
+    {
+      this->PointAttributes[i] = pointAttributes[i];
+    }
+  }
+
+  // The offsets of the inputs, as they are accumulated by the serial
+  // append.
+  void ComputeOffsets(int numInputs, vtkIdType numVerts, vtkIdType numLines,
+                      vtkIdType numPolys)
+  {
+    Offsets offsets = {0, 0, numVerts, numVerts + numLines,
+      numVerts + numLines + numPolys, 0, 0, 0, 0, -1, -1};
+    int countPD = 0;
+    int countCD = 0;
+    this->InputOffsets.resize(numInputs);
+    for (int idx = 0; idx < numInputs; ++idx)
+    {
+      vtkPolyData *ds = this->Inputs[idx];
+      Offsets &inputOffsets = this->InputOffsets[idx];
+      inputOffsets = offsets;
+      if (ds == NULL)
+      {
+        continue;
+      }
+      if (ds->GetNumberOfPoints() > 0)
+      {
+        inputOffsets.PointListIndex = countPD++;
+        offsets.Points += ds->GetNumberOfPoints();
+      }
+      if (ds->GetNumberOfCells() > 0)
+      {
+        inputOffsets.CellListIndex = countCD++;
+        offsets.Verts += ds->GetNumberOfVerts();
+        offsets.Lines += ds->GetNumberOfLines();
+        offsets.Polys += ds->GetNumberOfPolys();
+        offsets.Strips += ds->GetNumberOfStrips();
+        offsets.VertsConnectivity += ds->GetVerts() ?
+          ds->GetVerts()->GetNumberOfConnectivityEntries() : 0;
+        offsets.LinesConnectivity += ds->GetLines() ?
+          ds->GetLines()->GetNumberOfConnectivityEntries() : 0;
+        offsets.PolysConnectivity += ds->GetPolys() ?
+          ds->GetPolys()->GetNumberOfConnectivityEntries() : 0;
+        offsets.StripsConnectivity += ds->GetStrips() ?
+          ds->GetStrips()->GetNumberOfConnectivityEntries() : 0;
+      }
+    }
+  }
+
+  void GetPointAttributes(vtkPointData *inPD, vtkDataArray *attributes[5])
+  {
+    attributes[0] = inPD->GetScalars();
+    attributes[1] = inPD->GetNormals();
+    attributes[2] = inPD->GetVectors();
+    attributes[3] = inPD->GetTCoords();
+    attributes[4] = inPD->GetTensors();
+  }
+
+  void CopyCellData(vtkPolyData *ds, const Offsets &o, bool threadSafe)
+  {
+    vtkCellData *inCD = ds->GetCellData();
+    vtkIdType numVerts = ds->GetNumberOfVerts();
+    vtkIdType numLines = ds->GetNumberOfLines();
+    vtkIdType numPolys = ds->GetNumberOfPolys();
+    CopyFields(this->CellList, this->OutputCD, inCD, o.CellListIndex,
+               o.Verts, numVerts, 0, threadSafe);
+    CopyFields(this->CellList, this->OutputCD, inCD, o.CellListIndex,
+               o.Lines, numLines, numVerts, threadSafe);
+    CopyFields(this->CellList, this->OutputCD, inCD, o.CellListIndex,
+               o.Polys, numPolys, numVerts + numLines, threadSafe);
+    CopyFields(this->CellList, this->OutputCD, inCD, o.CellListIndex,
+               o.Strips, ds->GetNumberOfStrips(),
+               numVerts + numLines + numPolys, threadSafe);
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkDataArray *inAttributes[5];
+    for (vtkIdType idx = begin; idx < end; ++idx)
+    {
+      vtkPolyData *ds = this->Inputs[idx];
+      const Offsets &o = this->InputOffsets[idx];
+      if (o.PointListIndex >= 0)
+      {
+        vtkPointData *inPD = ds->GetPointData();
+        this->Self->AppendData(this->Points, ds->GetPoints()->GetData(),
+                               o.Points);
+        this->GetPointAttributes(inPD, inAttributes);
+        for (int i = 0; i < 5; ++i)
+        {
+          if (this->PointAttributes[i] &&
+              IsThreadSafe(this->PointAttributes[i]))
+          {
+            this->Self->AppendData(this->PointAttributes[i], inAttributes[i],
+                                   o.Points);
+          }
+        }
+        CopyFields(this->PointList, this->OutputPD, inPD, o.PointListIndex,
+                   o.Points, ds->GetNumberOfPoints(), 0, true);
+      }
+      if (o.CellListIndex >= 0)
+      {
+        this->Self->AppendCells(this->Verts + o.VertsConnectivity,
+                                ds->GetVerts(), o.Points);
+        this->Self->AppendCells(this->Lines + o.LinesConnectivity,
+                                ds->GetLines(), o.Points);
+        this->Self->AppendCells(this->Polys + o.PolysConnectivity,
+                                ds->GetPolys(), o.Points);
+        this->Self->AppendCells(this->Strips + o.StripsConnectivity,
+                                ds->GetStrips(), o.Points);
+        this->CopyCellData(ds, o, true);
+      }
+    }
+  }
+
+  void CopySerialArrays(int numInputs)
+  {
+    vtkDataArray *inAttributes[5];
+    for (int idx = 0; idx < numInputs; ++idx)
+    {
+      vtkPolyData *ds = this->Inputs[idx];
+      const Offsets &o = this->InputOffsets[idx];
+      if (o.PointListIndex >= 0)
+      {
+        vtkPointData *inPD = ds->GetPointData();
+        this->GetPointAttributes(inPD, inAttributes);
+        for (int i = 0; i < 5; ++i)
+        {
+          if (this->PointAttributes[i] &&
+              !IsThreadSafe(this->PointAttributes[i]))
+          {
+            this->Self->AppendData(this->PointAttributes[i], inAttributes[i],
+                                   o.Points);
+          }
+        }
+        CopyFields(this->PointList, this->OutputPD, inPD, o.PointListIndex,
+                   o.Points, ds->GetNumberOfPoints(), 0, false);
+      }
+      if (o.CellListIndex >= 0)
+      {
+        this->CopyCellData(ds, o, false);
+      }
+    }
+  }
+};
+
 //----------------------------------------------------------------------------
 vtkAppendPolyData::vtkAppendPolyData()
 {
   this->ParallelStreaming = 0;
   this->UserManagedInputs = 0;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -423,91 +705,115 @@ int vtkAppendPolyData::ExecuteAppend(vtkPolyData* output,
   vtkIdType polysOffset = numVerts+numLines;
   vtkIdType stripsOffset = numVerts+numLines+numPolys;
   countPD = countCD = 0;
-  for (idx = 0; idx < numInputs; ++idx)
+  if (this->EnableSMP)
   {
-    this->UpdateProgress(0.2 + 0.8*idx/numInputs);
-    ds = inputs[idx];
-    // this check is not necessary, but I'll put it in anyway
-    if (ds != NULL)
+    // the arrays are written concurrently, so they are sized first
+    for (idx = 0; idx < outputPD->GetNumberOfArrays(); ++idx)
     {
-      numPts = ds->GetNumberOfPoints();
-      numCells = ds->GetNumberOfCells();
-      if ( numPts <= 0 && numCells <= 0 )
-      {
-        continue; //no input, just skip
-      }
-
-      inPD = ds->GetPointData();
-      inCD = ds->GetCellData();
-
-      inPts = ds->GetPoints();
-      inVerts = ds->GetVerts();
-      inLines = ds->GetLines();
-      inPolys = ds->GetPolys();
-      inStrips = ds->GetStrips();
+      outputPD->GetAbstractArray(idx)->SetNumberOfTuples(numPts);
+    }
+    for (idx = 0; idx < outputCD->GetNumberOfArrays(); ++idx)
+    {
+      outputCD->GetAbstractArray(idx)->SetNumberOfTuples(numCells);
+    }
 
-      if (ds->GetNumberOfPoints() > 0)
+    vtkDataArray *newPtAttributes[5] = {newPtScalars, newPtNormals,
+      newPtVectors, newPtTCoords, newPtTensors};
+    vtkAppendPolyData::AppendInputs appendInputs(this, inputs, ptList,
+      cellList, outputPD, outputCD, newPts->GetData(), newPtAttributes,
+      pVerts, pLines, pPolys, pStrips);
+    appendInputs.ComputeOffsets(numInputs, numVerts, numLines, numPolys);
+    vtkSMPTools::For(0, numInputs, appendInputs);
+    appendInputs.CopySerialArrays(numInputs);
+  }
+  else
+  {
+    for (idx = 0; idx < numInputs; ++idx)
+    {
+      this->UpdateProgress(0.2 + 0.8*idx/numInputs);
+      ds = inputs[idx];
+      // this check is not necessary, but I'll put it in anyway
+      if (ds != NULL)
       {
-        // copy points directly
-        this->AppendData(newPts->GetData(),
-                         inPts->GetData(), ptOffset);
-
-        // copy scalars directly
-        if (newPtScalars)
-        {
-          this->AppendData(newPtScalars, inPD->GetScalars(), ptOffset);
-        }
-        // copy normals directly
-        if (newPtNormals)
-        {
-          this->AppendData(newPtNormals, inPD->GetNormals(), ptOffset);
-        }
-        // copy vectors directly
-        if (newPtVectors)
+        numPts = ds->GetNumberOfPoints();
+        numCells = ds->GetNumberOfCells();
+        if ( numPts <= 0 && numCells <= 0 )
         {
-          this->AppendData(newPtVectors, inPD->GetVectors(), ptOffset);
+          continue; //no input, just skip
         }
-        // copy tcoords directly
-        if (newPtTCoords)
+
+        inPD = ds->GetPointData();
+        inCD = ds->GetCellData();
+
+        inPts = ds->GetPoints();
+        inVerts = ds->GetVerts();
+        inLines = ds->GetLines();
+        inPolys = ds->GetPolys();
+        inStrips = ds->GetStrips();
+
+        if (ds->GetNumberOfPoints() > 0)
         {
-          this->AppendData(newPtTCoords, inPD->GetTCoords() , ptOffset);
+          // copy points directly
+          this->AppendData(newPts->GetData(),
+                           inPts->GetData(), ptOffset);
+
+          // copy scalars directly
+          if (newPtScalars)
+          {
+            this->AppendData(newPtScalars, inPD->GetScalars(), ptOffset);
+          }
+          // copy normals directly
+          if (newPtNormals)
+          {
+            this->AppendData(newPtNormals, inPD->GetNormals(), ptOffset);
+          }
+          // copy vectors directly
+          if (newPtVectors)
+          {
+            this->AppendData(newPtVectors, inPD->GetVectors(), ptOffset);
+          }
+          // copy tcoords directly
+          if (newPtTCoords)
+          {
+            this->AppendData(newPtTCoords, inPD->GetTCoords() , ptOffset);
+          }
+          // copy tensors directly
+          if (newPtTensors)
+          {
+            this->AppendData(newPtTensors, inPD->GetTensors(), ptOffset);
+          }
+          // append the remainder of the field data
+          outputPD->CopyData(ptList, inPD, countPD, ptOffset, numPts, 0);
+          ++countPD;
         }
-        // copy tensors directly
-        if (newPtTensors)
+
+        if (ds->GetNumberOfCells() > 0)
         {
-          this->AppendData(newPtTensors, inPD->GetTensors(), ptOffset);
+          // These are the cellIDs at which each of the cell types start.
+          vtkIdType vertsIndex = 0;
+          vtkIdType linesIndex = ds->GetNumberOfVerts();
+          vtkIdType polysIndex = linesIndex + ds->GetNumberOfLines();
+          vtkIdType stripsIndex = polysIndex + ds->GetNumberOfPolys();
+
+          // copy the cells
+          pVerts = this->AppendCells(pVerts, inVerts, ptOffset);
+          pLines = this->AppendCells(pLines, inLines, ptOffset);
+          pPolys = this->AppendCells(pPolys, inPolys, ptOffset);
+          pStrips = this->AppendCells(pStrips, inStrips, ptOffset);
+
+          // copy cell data
+          outputCD->CopyData(cellList, inCD, countCD, vertOffset, ds->GetNumberOfVerts(), vertsIndex);
+          vertOffset += ds->GetNumberOfVerts();
+          outputCD->CopyData(cellList, inCD, countCD, linesOffset, ds->GetNumberOfLines(), linesIndex);
+          linesOffset += ds->GetNumberOfLines();
+          outputCD->CopyData(cellList, inCD, countCD, polysOffset, ds->GetNumberOfPolys(), polysIndex);
+          polysOffset += ds->GetNumberOfPolys();
+          outputCD->CopyData(cellList, inCD, countCD, stripsOffset, ds->GetNumberOfStrips(), stripsIndex);
+          stripsOffset += ds->GetNumberOfStrips();
+          ++countCD;
         }
-        // append the remainder of the field data
-        outputPD->CopyData(ptList, inPD, countPD, ptOffset, numPts, 0);
-        ++countPD;
+        ptOffset += numPts;
       }
-
-      if (ds->GetNumberOfCells() > 0)
-      {
-        // These are the cellIDs at which each of the cell types start.
-        vtkIdType vertsIndex = 0;
-        vtkIdType linesIndex = ds->GetNumberOfVerts();
-        vtkIdType polysIndex = linesIndex + ds->GetNumberOfLines();
-        vtkIdType stripsIndex = polysIndex + ds->GetNumberOfPolys();
-
-        // copy the cells
-        pVerts = this->AppendCells(pVerts, inVerts, ptOffset);
-        pLines = this->AppendCells(pLines, inLines, ptOffset);
-        pPolys = this->AppendCells(pPolys, inPolys, ptOffset);
-        pStrips = this->AppendCells(pStrips, inStrips, ptOffset);
-
-        // copy cell data
-        outputCD->CopyData(cellList, inCD, countCD, vertOffset, ds->GetNumberOfVerts(), vertsIndex);
-        vertOffset += ds->GetNumberOfVerts();
-        outputCD->CopyData(cellList, inCD, countCD, linesOffset, ds->GetNumberOfLines(), linesIndex);
-        linesOffset += ds->GetNumberOfLines();
-        outputCD->CopyData(cellList, inCD, countCD, polysOffset, ds->GetNumberOfPolys(), polysIndex);
-        polysOffset += ds->GetNumberOfPolys();
-        outputCD->CopyData(cellList, inCD, countCD, stripsOffset, ds->GetNumberOfStrips(), stripsIndex);
-        stripsOffset += ds->GetNumberOfStrips();
-        ++countCD;
-      }
-      ptOffset += numPts;
     }
   }
 
@@ -688,37 +994,9 @@ void vtkAppendPolyData::PrintSelf(ostream& os, vtkIndent indent)
   os << "UserManagedInputs:" << (this->UserManagedInputs?"On":"Off") << endl;
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << endl;
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
-//----------------------------------------------------------------------------
-namespace {
-struct AppendDataWorker
-{
-  vtkIdType Offset;
-
-  AppendDataWorker(vtkIdType offset) : Offset(offset) {}
-
-  template <typename Array1T, typename Array2T>
-  void operator()(Array1T *dest, Array2T *src)
-  {
-    vtkDataArrayAccessor<Array1T> d(dest);
-    vtkDataArrayAccessor<Array2T> s(src);
-    VTK_ASSUME(src->GetNumberOfComponents() == dest->GetNumberOfComponents());
-
-    const vtkIdType numTuples = src->GetNumberOfTuples();
-    const int numComps = src->GetNumberOfComponents();
-
-    for (vtkIdType t = 0; t < numTuples; ++t)
-    {
-      for (int c = 0; c < numComps; ++c)
-      {
-        d.Set(t + this->Offset, c, s.Get(t, c));
-      }
-    }
-  }
-};
-} // end anon namespace
-
 //----------------------------------------------------------------------------
 void vtkAppendPolyData::AppendData(vtkDataArray *dest, vtkDataArray *src,
                                    vtkIdType offset)
@@ -728,7 +1006,7 @@ void vtkAppendPolyData::AppendData(vtkDataArray *dest, vtkDataArray *src,
   assert("Destination array has enough tuples." &&
          src->GetNumberOfTuples() + offset <= dest->GetNumberOfTuples());
 
-  AppendDataWorker worker(offset);
+  AppendDataWorker worker(offset, 0, src->GetNumberOfTuples());
   if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(dest, src, worker))
   {
     // Use vtkDataArray API when fast-path dispatch fails.
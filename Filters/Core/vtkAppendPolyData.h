@@ -24,6 +24,12 @@
  * attributes available.  (For example, if one dataset has point scalars but
  * another does not, point scalars will not be appended.)
  *
+ * When EnableSMP is on, the points, attribute arrays and cells of the
+ * inputs are copied into the output concurrently (via vtkSMPTools), each
+ * input at offsets computed up front. The output is the same as in the
+ * serial case. With a single input, the output shares the arrays of the
+ * input in both cases.
+ *
  * @sa
  * vtkAppendFilter
 */
@@ -115,6 +121,16 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded copy of the inputs (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
   int ExecuteAppend(vtkPolyData* output,
     vtkPolyData* inputs[], int numInputs);
 
@@ -125,6 +141,7 @@ protected:
   // Flag for selecting parallel streaming behavior
   int ParallelStreaming;
   int OutputPointsPrecision;
+  int EnableSMP;
 
   // Usual data generation method
   int RequestData(vtkInformation *,
@@ -141,6 +158,9 @@ protected:
   vtkIdType *AppendCells(vtkIdType *pDest, vtkCellArray *src,
                          vtkIdType offset);
 
+  // The threaded copy of the inputs
+  struct AppendInputs;
+
  private:
   // hide the superclass' AddInput() from the user and the compiler
   void AddInputData(vtkDataObject *)
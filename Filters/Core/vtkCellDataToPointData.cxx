@@ -14,22 +14,30 @@
 =========================================================================*/
 #include "vtkCellDataToPointData.h"
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinks.h"
 #include "vtkStructuredGrid.h"
 #include "vtkUnsignedIntArray.h"
 #include "vtkUnstructuredGrid.h"
 
 #include <algorithm>
 #include <functional>
+#include <vector>
 
 #define VTK_MAX_CELLS_PER_POINT 4096
 
@@ -40,6 +48,7 @@ vtkStandardNewMacro(vtkCellDataToPointData);
 vtkCellDataToPointData::vtkCellDataToPointData()
 {
   this->PassCellData = 0;
+  this->EnableSMP = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -58,6 +67,11 @@ int vtkCellDataToPointData::RequestData(
 
   vtkDebugMacro(<<"Mapping cell data to point data");
 
+  if (this->EnableSMP)
+  {
+    return this->RequestDataSMP(input, output);
+  }
+
   // Special traversal algorithm for unstructured grid
   if (input->IsA("vtkUnstructuredGrid"))
   {
@@ -109,6 +123,7 @@ void vtkCellDataToPointData::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Pass Cell Data: " << (this->PassCellData ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
 //----------------------------------------------------------------------------
@@ -370,3 +385,289 @@ void vtkCellDataToPointData::interpolatePointDataWithMask(
   }
 }
 
+
+//----------------------------------------------------------------------------
+// Threaded averaging. Each data array is handled by an averager created
+// with vtkArrayDispatch, and each point gathers the values of the cells
+// using it for all the arrays at once.
+namespace
+{
+  // Average a set of tuples of an input array into a tuple of the output
+  // array.
+  struct Averager
+  {
+    virtual ~Averager() {}
+    virtual void Average(vtkIdType numIds, const vtkIdType *ids,
+                         vtkIdType outId) = 0;
+    virtual void Null(vtkIdType outId) = 0;
+  };
+
+  template <typename InArrayT, typename OutArrayT>
+  struct TypedAverager : public Averager
+  {
+    typedef typename vtkDataArrayAccessor<OutArrayT>::APIType ValueType;
+
+    InArrayT *Input;
+    OutArrayT *Output;
+    int NumComp;
+
+    TypedAverager(InArrayT *in, OutArrayT *out) :
+      Input(in), Output(out), NumComp(in->GetNumberOfComponents())
+    {
+    }
+
+    // Same weights and summation order as vtkDataArray::InterpolateTuple().
+    void Average(vtkIdType numIds, const vtkIdType *ids,
+                 vtkIdType outId) VTK_OVERRIDE
+    {
+      vtkDataArrayAccessor<InArrayT> in(this->Input);
+      vtkDataArrayAccessor<OutArrayT> out(this->Output);
+      double weight = 1.0 / numIds;
+      for (int c = 0; c < this->NumComp; ++c)
+      {
+        double val = 0.0;
+        for (vtkIdType i = 0; i < numIds; ++i)
+        {
+          val += weight * static_cast<double>(in.Get(ids[i], c));
+        }
+        ValueType valT;
+        vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+        out.Set(outId, c, valT);
+      }
+    }
+
+    void Null(vtkIdType outId) VTK_OVERRIDE
+    {
+      vtkDataArrayAccessor<OutArrayT> out(this->Output);
+      for (int c = 0; c < this->NumComp; ++c)
+      {
+        out.Set(outId, c, static_cast<ValueType>(0));
+      }
+    }
+  };
+
+  // Fallback for the arrays that cannot be dispatched (e.g., bit arrays).
+  // It is not thread safe and is used serially.
+  struct GenericAverager : public Averager
+  {
+    vtkDataArray *Input;
+    vtkDataArray *Output;
+    vtkNew<vtkIdList> Ids;
+    std::vector<double> Weights;
+
+    GenericAverager(vtkDataArray *in, vtkDataArray *out) :
+      Input(in), Output(out)
+    {
+    }
+
+    void Average(vtkIdType numIds, const vtkIdType *ids,
+                 vtkIdType outId) VTK_OVERRIDE
+    {
+      this->Ids->SetNumberOfIds(numIds);
+      std::copy(ids, ids + numIds, this->Ids->GetPointer(0));
+      this->Weights.assign(numIds, 1.0 / numIds);
+      this->Output->InterpolateTuple(outId, this->Ids.Get(), this->Input,
+                                     &this->Weights[0]);
+    }
+
+    void Null(vtkIdType outId) VTK_OVERRIDE
+    {
+      for (int c = 0; c < this->Output->GetNumberOfComponents(); ++c)
+      {
+        this->Output->SetComponent(outId, c, 0.0);
+      }
+    }
+  };
+
+  struct MakeAverager
+  {
+    std::vector<Averager*> &Averagers;
+
+    MakeAverager(std::vector<Averager*> &averagers) : Averagers(averagers)
+    {
+    }
+
+    template <typename InArrayT, typename OutArrayT>
+    void operator()(InArrayT *in, OutArrayT *out)
+    {
+      this->Averagers.push_back(
+        new TypedAverager<InArrayT, OutArrayT>(in, out));
+    }
+  };
+
+  // Gather the cells using each point and average their values. The cells
+  // are given by the static links when available, and are otherwise
+  // requested from the dataset.
+  struct AveragePointsOp
+  {
+    vtkDataSet *Input;
+    vtkStaticCellLinks *Links;
+    vtkStructuredGrid *MaskedGrid;
+    std::vector<Averager*> *Averagers;
+    vtkSMPThreadLocalObject<vtkIdList> PointCells;
+    vtkSMPThreadLocal<std::vector<vtkIdType> > CellIds;
+
+    AveragePointsOp(vtkDataSet *input, vtkStaticCellLinks *links,
+                    vtkStructuredGrid *maskedGrid,
+                    std::vector<Averager*> *averagers) :
+      Input(input), Links(links), MaskedGrid(maskedGrid), Averagers(averagers)
+    {
+    }
+
+    void operator()(vtkIdType ptId, vtkIdType endPtId)
+    {
+      vtkIdList *pointCells = this->PointCells.Local();
+      std::vector<vtkIdType> &cellIds = this->CellIds.Local();
+      std::vector<Averager*>::iterator begin = this->Averagers->begin();
+      std::vector<Averager*>::iterator end = this->Averagers->end();
+      for (; ptId < endPtId; ++ptId)
+      {
+        cellIds.clear();
+        if (this->Links)
+        {
+          // The links list the cells in decreasing order. Average them in
+          // increasing order, like the serial filter.
+          vtkIdType numCells = this->Links->GetNumberOfCells(ptId);
+          const vtkIdType *cells = this->Links->GetCells(ptId);
+          for (vtkIdType i = numCells; i-- > 0;)
+          {
+            cellIds.push_back(cells[i]);
+          }
+        }
+        else
+        {
+          this->Input->GetPointCells(ptId, pointCells);
+          for (vtkIdType i = 0; i < pointCells->GetNumberOfIds(); ++i)
+          {
+            vtkIdType cellId = pointCells->GetId(i);
+            if (!this->MaskedGrid || this->MaskedGrid->IsCellVisible(cellId))
+            {
+              cellIds.push_back(cellId);
+            }
+          }
+        }
+
+        vtkIdType numCells = static_cast<vtkIdType>(cellIds.size());
+        for (std::vector<Averager*>::iterator it = begin; it != end; ++it)
+        {
+          if (numCells > 0)
+          {
+            (*it)->Average(numCells, &cellIds[0], ptId);
+          }
+          else
+          {
+            (*it)->Null(ptId);
+          }
+        }
+      }
+    }
+  };
+}
+
+//----------------------------------------------------------------------------
+int vtkCellDataToPointData::RequestDataSMP(vtkDataSet *input,
+                                           vtkDataSet *output)
+{
+  // First, copy the input to the output as a starting point
+  output->CopyStructure(input);
+  vtkPointData* const opd = output->GetPointData();
+
+  // Pass the point data first. The fields and attributes
+  // which also exist in the cell data of the input will
+  // be over-written during InterpolateAllocate
+  opd->CopyGlobalIdsOff();
+  opd->PassData(input->GetPointData());
+  opd->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
+
+  vtkIdType const npoints = input->GetNumberOfPoints();
+  if (npoints > 0 && input->GetNumberOfCells() > 0)
+  {
+    // Copy all existing cell fields into a temporary cell data array, and
+    // remove all fields that are not a data array.
+    vtkSmartPointer<vtkCellData> clean = vtkSmartPointer<vtkCellData>::New();
+    clean->PassData(input->GetCellData());
+    for (vtkIdType fid = clean->GetNumberOfArrays(); fid--;)
+    {
+      if (!clean->GetAbstractArray(fid)->IsA("vtkDataArray"))
+      {
+        clean->RemoveArray(fid);
+      }
+    }
+
+    vtkDataSetAttributes::FieldList cfl(1);
+    cfl.InitializeFieldList(clean);
+    opd->InterpolateAllocate(cfl, npoints, npoints);
+
+    std::vector<Averager*> averagers;
+    std::vector<Averager*> serialAveragers;
+    MakeAverager makeAverager(averagers);
+    for (int fid = 0, nfields = cfl.GetNumberOfFields(); fid < nfields; ++fid)
+    {
+      int const dstid = cfl.GetFieldIndex(fid);
+      int const srcid = cfl.GetDSAIndex(0,fid);
+      if (srcid < 0 || dstid < 0)
+      {
+        continue;
+      }
+      vtkDataArray* const srcarray = clean->GetArray(srcid);
+      vtkDataArray* const dstarray = opd->GetArray(dstid);
+      dstarray->SetNumberOfTuples(npoints);
+      if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(
+            srcarray, dstarray, makeAverager))
+      {
+        serialAveragers.push_back(new GenericAverager(srcarray, dstarray));
+      }
+    }
+
+    // The links of polydata and unstructured grids are built once, in
+    // parallel. Other datasets are asked for the cells using each point,
+    // after a first serial request which builds any lazily constructed
+    // structure they may need.
+    vtkNew<vtkStaticCellLinks> links;
+    vtkStaticCellLinks *pointLinks = NULL;
+    int const dataType = input->GetDataObjectType();
+    if (dataType == VTK_POLY_DATA || dataType == VTK_UNSTRUCTURED_GRID)
+    {
+      links->BuildLinks(input);
+      pointLinks = links.Get();
+    }
+    else
+    {
+      vtkNew<vtkIdList> cellIds;
+      input->GetPointCells(0, cellIds.Get());
+    }
+
+    // Take care of masked cells if needed.
+    vtkStructuredGrid *sGrid = vtkStructuredGrid::SafeDownCast(input);
+    if (sGrid && !sGrid->HasAnyBlankCells())
+    {
+      sGrid = NULL;
+    }
+
+    AveragePointsOp average(input, pointLinks, sGrid, &averagers);
+    vtkSMPTools::For(0, npoints, average);
+    if (!serialAveragers.empty())
+    {
+      average.Averagers = &serialAveragers;
+      average(0, npoints);
+    }
+
+    for (size_t i = 0; i < averagers.size(); ++i)
+    {
+      delete averagers[i];
+    }
+    for (size_t i = 0; i < serialAveragers.size(); ++i)
+    {
+      delete serialAveragers[i];
+    }
+  }
+
+  if (!this->PassCellData)
+  {
+    output->GetCellData()->CopyAllOff();
+    output->GetCellData()->CopyFieldOn(vtkDataSetAttributes::GhostArrayName());
+  }
+  output->GetCellData()->PassData(input->GetCellData());
+
+  return 1;
+}
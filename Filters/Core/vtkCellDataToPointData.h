@@ -22,6 +22,15 @@
  * values of all cells using a particular point. Optionally, the input cell
  * data can be passed through to the output as well.
  *
+ * When EnableSMP is on, the point data is computed in parallel (via
+ * vtkSMPTools). The cells using the points of polydata and unstructured
+ * grids are then found once, with static cell links built in parallel, and
+ * each point gathers the values of its cells for all the arrays at once.
+ * As in the serial processing of unstructured grids, only data arrays are
+ * averaged. The average is computed in double precision and rounded for
+ * integral types, like for the other types of datasets, so it may slightly
+ * differ from the serial average computed for unstructured grids.
+ *
  * @warning
  * This filter is an abstract filter, that is, the output is an abstract type
  * (i.e., vtkDataSet). Use the convenience methods (e.g.,
@@ -58,6 +67,15 @@ public:
   vtkBooleanMacro(PassCellData,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded averaging of the cell data (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
 protected:
   vtkCellDataToPointData();
   ~vtkCellDataToPointData() VTK_OVERRIDE {}
@@ -76,7 +94,11 @@ protected:
   void interpolatePointDataWithMask(vtkStructuredGrid *input,
                                     vtkDataSet *output);
 
+  // Threaded averaging, used when EnableSMP is on.
+  int RequestDataSMP(vtkDataSet *input, vtkDataSet *output);
+
   int PassCellData;
+  int EnableSMP;
 private:
   vtkCellDataToPointData(const vtkCellDataToPointData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCellDataToPointData&) VTK_DELETE_FUNCTION;
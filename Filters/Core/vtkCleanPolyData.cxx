@@ -16,15 +16,22 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkIdList.h"
 #include "vtkMergePoints.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticPointLocator.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkIncrementalPointLocator.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkCleanPolyData);
 
 //---------------------------------------------------------------------------
@@ -32,6 +39,281 @@ vtkStandardNewMacro(vtkCleanPolyData);
 // default an instance of vtkPointLocator is used.
 vtkCxxSetObjectMacro(vtkCleanPolyData,Locator,vtkIncrementalPointLocator);
 
+//---------------------------------------------------------------------------
+// Helpers for the threaded execution (EnableSMP).
+namespace
+{
+// The four kinds of polydata cells, in the order they are stored.
+enum { VERTS = 0, LINES = 1, POLYS = 2, STRIPS = 3 };
+
+// Flag the points used by the cells. Points shared by cells of different
+// threads may be flagged concurrently, but always with the same value.
+struct MarkUsedPointsOp
+{
+  vtkCellArray *Cells;
+  vtkIdType *Used;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts, *pts;
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      this->Cells->GetCellAtId(cellId, npts, pts);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        this->Used[pts[i]] = 1;
+      }
+    }
+  }
+};
+
+// Once the usage flags have been turned into a prefix sum, list the used
+// points (point i is used if the sum increases after it).
+struct GatherUsedIdsOp
+{
+  const vtkIdType *PointMap;
+  vtkIdType NumPts;
+  vtkIdType NumUsedPts;
+  vtkIdType *UsedIds;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      vtkIdType next = ( ptId + 1 < this->NumPts ? this->PointMap[ptId+1] :
+                         this->NumUsedPts );
+      if ( next > this->PointMap[ptId] )
+      {
+        this->UsedIds[this->PointMap[ptId]] = ptId;
+      }
+    }
+  }
+};
+
+// Flag the points that are kept by the merging, i.e. mapped to themselves.
+struct FlagMergedPointsOp
+{
+  const vtkIdType *MergeMap;
+  vtkIdType *NewIds;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      this->NewIds[ptId] = ( this->MergeMap[ptId] == ptId ? 1 : 0 );
+    }
+  }
+};
+
+// Compact the points kept by the merging, and their input ids.
+struct CompactPointsOp
+{
+  const vtkIdType *MergeMap;
+  const vtkIdType *NewIds;
+  vtkPoints *InPts;
+  vtkPoints *OutPts;
+  const vtkIdType *UsedIds;
+  vtkIdType *OutUsedIds;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    double x[3];
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      if ( this->MergeMap[ptId] == ptId )
+      {
+        this->InPts->GetPoint(ptId, x);
+        this->OutPts->SetPoint(this->NewIds[ptId], x);
+        this->OutUsedIds[this->NewIds[ptId]] = this->UsedIds[ptId];
+      }
+    }
+  }
+};
+
+// Map the input points to the merged points. Unused input points are
+// mapped too, to some valid id, but never referenced.
+struct MapMergedPointsOp
+{
+  vtkIdType *PointMap;
+  vtkIdType NumUsedPts;
+  const vtkIdType *MergeMap;
+  const vtkIdType *NewIds;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      if ( this->PointMap[ptId] < this->NumUsedPts )
+      {
+        this->PointMap[ptId] =
+          this->NewIds[this->MergeMap[this->PointMap[ptId]]];
+      }
+    }
+  }
+};
+
+// Fill a list with the ids 0...n-1.
+struct IdentityIdsOp
+{
+  vtkIdType *Ids;
+
+  void operator()(vtkIdType id, vtkIdType endId)
+  {
+    for ( ; id < endId; ++id )
+    {
+      this->Ids[id] = id;
+    }
+  }
+};
+
+// Gather the used points, applying vtkCleanPolyData::OperateOnPoint().
+struct TransformPointsOp
+{
+  vtkCleanPolyData *Filter;
+  vtkPoints *InPts;
+  const vtkIdType *UsedIds;
+  vtkPoints *OutPts;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    double x[3], newx[3];
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      this->InPts->GetPoint(this->UsedIds[ptId], x);
+      this->Filter->OperateOnPoint(x, newx);
+      this->OutPts->SetPoint(ptId, newx);
+    }
+  }
+};
+
+// Number of cells and size of the connectivity list (point counts
+// included) generated for each kind of output cell.
+struct CellCounts
+{
+  vtkIdType NumCells[4];
+  vtkIdType Size[4];
+};
+
+// Renumber the cells of one input cell array and convert the degenerate
+// ones, following the rules of the serial algorithm. The cells are
+// processed by chunks in two passes: the first one counts the output cells
+// of each chunk, the second one (once the counts have been turned into
+// offsets) writes them, so the output is ordered as in the serial case.
+struct CleanCellsOp
+{
+  vtkCellArray *Cells;
+  int CellType;
+  vtkIdType FirstCellId; // input id of the first cell of the array
+  vtkIdType ChunkSize;
+  const vtkIdType *PointMap;
+  int ConvertLinesToPoints;
+  int ConvertPolysToLines;
+  int ConvertStripsToPolys;
+  CellCounts *Counts; // one per chunk
+  bool Write;
+  vtkIdType *OutConn[4];
+  vtkIdType *OutCellIds[4]; // input id of each output cell
+  vtkSMPThreadLocal<std::vector<vtkIdType> > UpdatedPts;
+
+  // Renumber the points of a cell, then return the kind of the output
+  // cell, or -1 if the cell is eliminated.
+  int CleanCell(vtkIdType npts, const vtkIdType *pts, vtkIdType *updatedPts,
+                vtkIdType &numNewPts)
+  {
+    numNewPts = 0;
+    if ( this->CellType == VERTS )
+    {
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        updatedPts[numNewPts++] = this->PointMap[pts[i]];
+      }
+      return ( numNewPts > 0 ? VERTS : -1 );
+    }
+
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      vtkIdType ptId = this->PointMap[pts[i]];
+      if ( i == 0 || ptId != updatedPts[numNewPts-1] )
+      {
+        updatedPts[numNewPts++] = ptId;
+      }
+    }
+    if ( this->CellType == POLYS && numNewPts > 2 &&
+         updatedPts[0] == updatedPts[numNewPts-1] )
+    {
+      numNewPts--;
+    }
+
+    int type = this->CellType;
+    if ( type == STRIPS )
+    {
+      if ( numNewPts > 3 || !this->ConvertStripsToPolys )
+      {
+        return STRIPS;
+      }
+      type = POLYS;
+    }
+    if ( type == POLYS )
+    {
+      if ( numNewPts > 2 || !this->ConvertPolysToLines )
+      {
+        return POLYS;
+      }
+      type = LINES;
+    }
+    if ( numNewPts > 1 || !this->ConvertLinesToPoints )
+    {
+      return LINES;
+    }
+    return ( numNewPts == 1 ? VERTS : -1 );
+  }
+
+  void operator()(vtkIdType chunk, vtkIdType endChunk)
+  {
+    std::vector<vtkIdType> &updatedPts = this->UpdatedPts.Local();
+    vtkIdType numCells = this->Cells->GetNumberOfCells();
+    vtkIdType npts, *pts, numNewPts;
+    for ( ; chunk < endChunk; ++chunk )
+    {
+      CellCounts &counts = this->Counts[chunk];
+      if ( !this->Write )
+      {
+        for (int t = 0; t < 4; ++t)
+        {
+          counts.NumCells[t] = counts.Size[t] = 0;
+        }
+      }
+      vtkIdType cellId = chunk * this->ChunkSize;
+      vtkIdType endCellId = cellId + this->ChunkSize;
+      endCellId = ( endCellId < numCells ? endCellId : numCells );
+      for ( ; cellId < endCellId; ++cellId )
+      {
+        this->Cells->GetCellAtId(cellId, npts, pts);
+        if ( static_cast<vtkIdType>(updatedPts.size()) <= npts )
+        {
+          updatedPts.resize(npts + 1);
+        }
+        int type = this->CleanCell(npts, pts, &updatedPts[0], numNewPts);
+        if ( type < 0 )
+        {
+          continue;
+        }
+        if ( this->Write )
+        {
+          vtkIdType *conn = this->OutConn[type] + counts.Size[type];
+          *conn++ = numNewPts;
+          std::copy(updatedPts.begin(), updatedPts.begin() + numNewPts, conn);
+          this->OutCellIds[type][counts.NumCells[type]] =
+            this->FirstCellId + cellId;
+        }
+        counts.NumCells[type]++;
+        counts.Size[type] += numNewPts + 1;
+      }
+    }
+  }
+};
+}
+
 //---------------------------------------------------------------------------
 // Construct object with initial Tolerance of 0.0
 vtkCleanPolyData::vtkCleanPolyData()
@@ -46,6 +328,7 @@ vtkCleanPolyData::vtkCleanPolyData()
   this->Locator = NULL;
   this->PieceInvariant = 1;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = 0;
 }
 
 //--------------------------------------------------------------------------
@@ -138,6 +421,10 @@ int vtkCleanPolyData::RequestData(
     vtkDebugMacro(<<"No data to Operate On!");
     return 1;
   }
+  if ( this->EnableSMP )
+  {
+    return this->ExecuteSMP(input, output);
+  }
   vtkIdType *updatedPts = new vtkIdType[input->GetMaxCellSize()];
 
   vtkIdType numNewPts;
@@ -594,6 +881,264 @@ int vtkCleanPolyData::RequestData(
   return 1;
 }
 
+//--------------------------------------------------------------------------
+// Threaded version of RequestData(). The points used by the cells are
+// gathered, merged with a vtkStaticPointLocator and numbered with prefix
+// sums, then the cells are rewritten in parallel.
+int vtkCleanPolyData::ExecuteSMP(vtkPolyData *input, vtkPolyData *output)
+{
+  vtkPoints *inPts = input->GetPoints();
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkPointData *inputPD = input->GetPointData();
+  vtkCellData *inputCD = input->GetCellData();
+  int t;
+
+  vtkCellArray *inCells[4];
+  inCells[VERTS] = input->GetVerts();
+  inCells[LINES] = input->GetLines();
+  inCells[POLYS] = input->GetPolys();
+  inCells[STRIPS] = input->GetStrips();
+
+  // Find the points used by the cells, and number them in increasing id
+  // order. pointMap maps the input points to the used points for now.
+  // The cell locations built here are deleted once the cells are written.
+  std::vector<vtkIdType> pointMap(numPts);
+  vtkSMPTools::Fill(pointMap.begin(), pointMap.end(), 0);
+  bool hadLocations[4];
+  for (t = 0; t < 4; ++t)
+  {
+    hadLocations[t] = inCells[t]->HasCellLocations();
+    inCells[t]->BuildCellLocations();
+    MarkUsedPointsOp mark = { inCells[t], &pointMap[0] };
+    vtkSMPTools::For(0, inCells[t]->GetNumberOfCells(), mark);
+  }
+  vtkIdType numUsedPts = vtkSMPTools::ExclusiveScan(
+    pointMap.begin(), pointMap.end(), pointMap.begin(),
+    static_cast<vtkIdType>(0));
+
+  // The input ids of the output points, and the output points.
+  vtkIdList *srcPtIds = vtkIdList::New();
+  srcPtIds->SetNumberOfIds(numUsedPts);
+  GatherUsedIdsOp gather = { &pointMap[0], numPts, numUsedPts,
+                             srcPtIds->GetPointer(0) };
+  vtkSMPTools::For(0, numPts, gather);
+
+  vtkPoints *newPts = inPts->NewInstance();
+  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    newPts->SetDataType(inPts->GetDataType());
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_FLOAT);
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    newPts->SetDataType(VTK_DOUBLE);
+  }
+  newPts->SetNumberOfPoints(numUsedPts);
+  TransformPointsOp transform = { this, inPts, srcPtIds->GetPointer(0),
+                                  newPts };
+  vtkSMPTools::For(0, numUsedPts, transform);
+  this->UpdateProgress(0.25);
+
+  // Merge the used points. Each group of merged points is represented by
+  // its first point, and the representatives are numbered in order.
+  vtkIdType numNewPts = numUsedPts;
+  if ( this->PointMerging && numUsedPts > 0 )
+  {
+    double tol = ( this->ToleranceIsAbsolute ? this->AbsoluteTolerance :
+                   this->Tolerance*input->GetLength() );
+    vtkPolyData *usedPts = vtkPolyData::New();
+    usedPts->SetPoints(newPts);
+    vtkStaticPointLocator *locator = vtkStaticPointLocator::New();
+    locator->SetDataSet(usedPts);
+    locator->BuildLocator();
+    std::vector<vtkIdType> mergeMap(numUsedPts);
+    locator->MergePoints(tol, &mergeMap[0]);
+    locator->Delete();
+    usedPts->Delete();
+
+    std::vector<vtkIdType> newIds(numUsedPts);
+    FlagMergedPointsOp flag = { &mergeMap[0], &newIds[0] };
+    vtkSMPTools::For(0, numUsedPts, flag);
+    numNewPts = vtkSMPTools::ExclusiveScan(
+      newIds.begin(), newIds.end(), newIds.begin(), static_cast<vtkIdType>(0));
+
+    if ( numNewPts < numUsedPts )
+    {
+      vtkPoints *mergedPts = newPts->NewInstance();
+      mergedPts->SetDataType(newPts->GetDataType());
+      mergedPts->SetNumberOfPoints(numNewPts);
+      vtkIdList *mergedIds = vtkIdList::New();
+      mergedIds->SetNumberOfIds(numNewPts);
+      CompactPointsOp compact = { &mergeMap[0], &newIds[0], newPts, mergedPts,
+                                  srcPtIds->GetPointer(0),
+                                  mergedIds->GetPointer(0) };
+      vtkSMPTools::For(0, numUsedPts, compact);
+      newPts->Delete();
+      newPts = mergedPts;
+      srcPtIds->Delete();
+      srcPtIds = mergedIds;
+
+      MapMergedPointsOp map = { &pointMap[0], numUsedPts, &mergeMap[0],
+                                &newIds[0] };
+      vtkSMPTools::For(0, numPts, map);
+    }
+  }
+  this->UpdateProgress(0.5);
+
+  // Rewrite the cells, first counting the output cells of each chunk of
+  // input cells. The counts are then turned into the offsets of the chunks
+  // in the output cell arrays, which are filled in a second pass.
+  const vtkIdType chunkSize = 10000;
+  vtkIdType firstChunk[5], firstCellId[4];
+  firstChunk[0] = 0;
+  for (t = 0; t < 4; ++t)
+  {
+    vtkIdType numCells = inCells[t]->GetNumberOfCells();
+    firstChunk[t+1] = firstChunk[t] + (numCells + chunkSize - 1) / chunkSize;
+    firstCellId[t] = ( t == 0 ? 0 :
+                       firstCellId[t-1] + inCells[t-1]->GetNumberOfCells() );
+  }
+  std::vector<CellCounts> counts(firstChunk[4]);
+  CleanCellsOp clean[4];
+  for (t = 0; t < 4; ++t)
+  {
+    clean[t].Cells = inCells[t];
+    clean[t].CellType = t;
+    clean[t].FirstCellId = firstCellId[t];
+    clean[t].ChunkSize = chunkSize;
+    clean[t].PointMap = &pointMap[0];
+    clean[t].ConvertLinesToPoints = this->ConvertLinesToPoints;
+    clean[t].ConvertPolysToLines = this->ConvertPolysToLines;
+    clean[t].ConvertStripsToPolys = this->ConvertStripsToPolys;
+    clean[t].Counts = counts.empty() ? NULL : &counts[firstChunk[t]];
+    clean[t].Write = false;
+    vtkSMPTools::For(0, firstChunk[t+1] - firstChunk[t], clean[t]);
+  }
+
+  CellCounts total;
+  for (t = 0; t < 4; ++t)
+  {
+    total.NumCells[t] = total.Size[t] = 0;
+  }
+  for (size_t chunk = 0; chunk < counts.size(); ++chunk)
+  {
+    for (t = 0; t < 4; ++t)
+    {
+      vtkIdType numCells = counts[chunk].NumCells[t];
+      vtkIdType size = counts[chunk].Size[t];
+      counts[chunk].NumCells[t] = total.NumCells[t];
+      counts[chunk].Size[t] = total.Size[t];
+      total.NumCells[t] += numCells;
+      total.Size[t] += size;
+    }
+  }
+
+  // The output cell data is ordered verts, lines, polys then strips.
+  vtkIdType numNewCells = 0;
+  bool sameCells = true;
+  vtkIdList *srcCellIds = vtkIdList::New();
+  srcCellIds->SetNumberOfIds(total.NumCells[0] + total.NumCells[1] +
+                             total.NumCells[2] + total.NumCells[3]);
+  vtkCellArray *newCells[4];
+  vtkIdType *outConn[4], *outCellIds[4];
+  for (t = 0; t < 4; ++t)
+  {
+    newCells[t] = NULL;
+    outConn[t] = NULL;
+    outCellIds[t] = srcCellIds->GetPointer(numNewCells);
+    numNewCells += total.NumCells[t];
+    sameCells = sameCells &&
+      total.NumCells[t] == inCells[t]->GetNumberOfCells();
+    if ( total.NumCells[t] > 0 )
+    {
+      vtkIdTypeArray *conn = vtkIdTypeArray::New();
+      outConn[t] = conn->WritePointer(0, total.Size[t]);
+      newCells[t] = vtkCellArray::New();
+      newCells[t]->SetCells(total.NumCells[t], conn);
+      conn->Delete();
+    }
+  }
+  for (t = 0; t < 4; ++t)
+  {
+    std::copy(outConn, outConn + 4, clean[t].OutConn);
+    std::copy(outCellIds, outCellIds + 4, clean[t].OutCellIds);
+    clean[t].Write = true;
+    vtkSMPTools::For(0, firstChunk[t+1] - firstChunk[t], clean[t]);
+    if ( !hadLocations[t] )
+    {
+      inCells[t]->DeleteCellLocations();
+    }
+  }
+  this->UpdateProgress(0.75);
+
+  vtkDebugMacro(<<"Removed " << numPts - numNewPts << " points and "
+                << input->GetNumberOfCells() - numNewCells << " cells");
+
+  // Copy the attributes. They are passed as is when the points or the
+  // cells are the input ones.
+  vtkPointData *outputPD = output->GetPointData();
+  if ( numNewPts == numPts )
+  {
+    outputPD->PassData(inputPD);
+  }
+  else
+  {
+    vtkIdList *dstIds = vtkIdList::New();
+    dstIds->SetNumberOfIds(numNewPts);
+    IdentityIdsOp identity = { dstIds->GetPointer(0) };
+    vtkSMPTools::For(0, numNewPts, identity);
+    outputPD->CopyAllocate(inputPD, numNewPts);
+    outputPD->CopyData(inputPD, srcPtIds, dstIds);
+    dstIds->Delete();
+  }
+  srcPtIds->Delete();
+
+  vtkCellData *outputCD = output->GetCellData();
+  if ( sameCells )
+  {
+    outputCD->PassData(inputCD);
+  }
+  else
+  {
+    vtkIdList *dstIds = vtkIdList::New();
+    dstIds->SetNumberOfIds(numNewCells);
+    IdentityIdsOp identity = { dstIds->GetPointer(0) };
+    vtkSMPTools::For(0, numNewCells, identity);
+    outputCD->CopyAllocate(inputCD, numNewCells);
+    outputCD->CopyData(inputCD, srcCellIds, dstIds);
+    dstIds->Delete();
+  }
+  srcCellIds->Delete();
+
+  output->SetPoints(newPts);
+  newPts->Delete();
+  if ( newCells[VERTS] )
+  {
+    output->SetVerts(newCells[VERTS]);
+    newCells[VERTS]->Delete();
+  }
+  if ( newCells[LINES] )
+  {
+    output->SetLines(newCells[LINES]);
+    newCells[LINES]->Delete();
+  }
+  if ( newCells[POLYS] )
+  {
+    output->SetPolys(newCells[POLYS]);
+    newCells[POLYS]->Delete();
+  }
+  if ( newCells[STRIPS] )
+  {
+    output->SetStrips(newCells[STRIPS]);
+    newCells[STRIPS]->Delete();
+  }
+
+  return 1;
+}
+
 //--------------------------------------------------------------------------
 // Method manages creation of locators. It takes into account the potential
 // change of tolerance (zero to non-zero).
@@ -675,6 +1220,8 @@ void vtkCleanPolyData::PrintSelf(ostream& os, vtkIndent indent)
      << (this->PieceInvariant ? "On\n" : "Off\n");
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision
      << "\n";
+  os << indent << "EnableSMP: "
+     << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
 //--------------------------------------------------------------------------
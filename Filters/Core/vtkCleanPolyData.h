@@ -46,6 +46,17 @@
  * will not be used, and points that are not used by any cells will be
  * eliminated, but never merged.
  *
+ * When EnableSMP is on, the filter executes in parallel with vtkSMPTools.
+ * The points used by the cells are binned by a vtkStaticPointLocator and
+ * merged (see vtkStaticPointLocator::MergePoints()), and the cells are then
+ * renumbered and their degeneracies removed in parallel. The Locator is not
+ * used, and OperateOnPoint() may be invoked concurrently from several
+ * threads. The output points are ordered by increasing input point id
+ * (instead of the order in which the cells use them), and the attributes of
+ * a merged point are those of the input point with the smallest id. The
+ * output cells are identical to the serial output up to this renumbering
+ * of the points.
+ *
  * @warning
  * Merging points can alter topology, including introducing non-manifold
  * forms. The tolerance should be chosen carefully to avoid these problems.
@@ -144,6 +155,17 @@ public:
   vtkBooleanMacro(PointMerging,int);
   //@}
 
+  //@{
+  /**
+   * Turn on/off the threaded execution of the filter (see the class
+   * documentation). Off by default, which keeps the order of the output
+   * points of the incremental, serial algorithm.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
   //@{
   /**
    * Set/Get a spatial locator for speeding the search process. By
@@ -205,6 +227,9 @@ protected:
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
   int RequestUpdateExtent(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
 
+  // Threaded implementation used when EnableSMP is on.
+  int ExecuteSMP(vtkPolyData *input, vtkPolyData *output);
+
   int   PointMerging;
   double Tolerance;
   double AbsoluteTolerance;
@@ -216,6 +241,7 @@ protected:
 
   int PieceInvariant;
   int OutputPointsPrecision;
+  int EnableSMP;
 private:
   vtkCleanPolyData(const vtkCleanPolyData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCleanPolyData&) VTK_DELETE_FUNCTION;
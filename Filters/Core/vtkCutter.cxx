@@ -26,6 +26,8 @@
 #include "vtkFloatArray.h"
 #include "vtkGenericCell.h"
 #include "vtkGridSynchronizedTemplates3D.h"
+#include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkImageData.h"
 #include "vtkImplicitFunction.h"
 #include "vtkInformation.h"
@@ -38,7 +40,11 @@
 #include "vtkPolyData.h"
 #include "vtkRectilinearGrid.h"
 #include "vtkRectilinearSynchronizedTemplates.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkSpanSpace.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
 #include "vtkSynchronizedTemplates3D.h"
@@ -52,10 +58,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkCutter);
 vtkCxxSetObjectMacro(vtkCutter,CutFunction,vtkImplicitFunction);
 vtkCxxSetObjectMacro(vtkCutter,Locator,vtkIncrementalPointLocator)
+vtkCxxSetObjectMacro(vtkCutter,ScalarTree,vtkScalarTree);
 
 //----------------------------------------------------------------------------
 // Construct with user-specified implicit function; initial value of 0.0; and
@@ -69,6 +77,12 @@ vtkCutter::vtkCutter(vtkImplicitFunction *cf)
   this->Locator = NULL;
   this->GenerateTriangles = 1;
   this->OutputPointsPrecision = DEFAULT_PRECISION;
+  this->EnableSMP = 0;
+  this->UseScalarTree = 0;
+  this->ScalarTree = NULL;
+  this->CutScalars = NULL;
+  this->CutScalarsInput = NULL;
+  this->CutScalarsFunction = NULL;
 
   this->SynchronizedTemplates3D = vtkSynchronizedTemplates3D::New();
   this->SynchronizedTemplatesCutter3D = vtkSynchronizedTemplatesCutter3D::New();
@@ -82,6 +96,11 @@ vtkCutter::~vtkCutter()
   this->ContourValues->Delete();
   this->SetCutFunction(NULL);
   this->SetLocator(NULL);
+  this->SetScalarTree(NULL);
+  if (this->CutScalars)
+  {
+    this->CutScalars->Delete();
+  }
 
   this->SynchronizedTemplates3D->Delete();
   this->SynchronizedTemplatesCutter3D->Delete();
@@ -400,6 +419,13 @@ int vtkCutter::RequestData(
   {
     this->RectilinearGridCutter(input, output);
   }
+  else if (this->EnableSMP &&
+           (input->GetDataObjectType() == VTK_UNSTRUCTURED_GRID ||
+            input->GetDataObjectType() == VTK_POLY_DATA))
+  {
+    vtkDebugMacro(<< "Executing threaded Point Set Cutter");
+    this->PointSetCutterSMP(input, output);
+  }
   else if (input->GetDataObjectType() == VTK_UNSTRUCTURED_GRID_BASE ||
            input->GetDataObjectType() == VTK_UNSTRUCTURED_GRID)
   {
@@ -1014,6 +1040,671 @@ void vtkCutter::UnstructuredGridCutter(vtkDataSet *input, vtkPolyData *output)
   output->Squeeze();
 }
 
+//----------------------------------------------------------------------------
+// Threaded cutting of unstructured grids and polydata.
+namespace
+{
+
+// Number of cells (or of scalar tree batches of cells) cut by each task.
+const vtkIdType CUTTER_CHUNK_SIZE = 1024;
+
+// The output of the cells of a chunk: its points, merged by a locator of its
+// own, their attributes, and the verts, lines and polys with the ids of the
+// input cells they come from.
+struct CutterChunk
+{
+  vtkSmartPointer<vtkPoints> Points;
+  vtkSmartPointer<vtkPointData> PointData;
+  vtkSmartPointer<vtkCellArray> Cells[3];
+  std::vector<vtkIdType> SourceCells[3];
+};
+
+// Evaluate the cut function at the points.
+struct CutterFunctionOp
+{
+  vtkDataSet *Input;
+  vtkImplicitFunction *Function;
+  bool Transform; // use FunctionValue() instead of EvaluateFunction()
+  double *Scalars;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId) const
+  {
+    double x[3];
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      this->Input->GetPoint(ptId, x);
+      this->Scalars[ptId] = this->Transform ?
+        this->Function->FunctionValue(x) : this->Function->EvaluateFunction(x);
+    }
+  }
+};
+
+// Cut the cells of the chunks. A chunk is either a range of cell ids, or a
+// range of batches of cells of a scalar tree. This is the loop of
+// vtkCutter::UnstructuredGridCutter(), writing the output of each chunk into
+// its own points and cells.
+struct CutterCellsOp
+{
+  vtkDataSet *Input;
+  vtkPointData *InPD;
+  vtkCellData *InCD;
+  const double *CutScalars;
+  vtkScalarTree *ScalarTree; // NULL to visit all the cells
+  vtkIdType NumberOfItems; // number of cells or of scalar tree batches
+  vtkIdType ItemsPerChunk;
+  const double *Values;
+  int NumberOfValues;
+  int Dimensions[2]; // range of dimensions of the cells to cut
+  const unsigned char *CellTypeDimensions;
+  int PointsType;
+  bool GenerateTriangles;
+  CutterChunk *Chunks;
+
+  vtkSMPThreadLocalObject<vtkGenericCell> Cell;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+  vtkSMPThreadLocalObject<vtkDoubleArray> CellScalars;
+  vtkSMPThreadLocalObject<vtkMergePoints> Locator;
+  // No cell data is copied while cutting: the ids of the input cells are
+  // recorded instead, and the cell data copied once all is done.
+  vtkSMPThreadLocalObject<vtkCellData> NoCellData;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > CellIds;
+
+  // Keep the cell if it may be cut, and add its points to the bounds.
+  void AddCell(vtkIdType cellId, vtkIdList *cellPts,
+               std::vector<vtkIdType>& cellIds, double bounds[6])
+  {
+    int cellType = this->Input->GetCellType(cellId);
+    if (cellType >= VTK_NUMBER_OF_CELL_TYPES ||
+        this->CellTypeDimensions[cellType] < this->Dimensions[0] ||
+        this->CellTypeDimensions[cellType] > this->Dimensions[1])
+    {
+      return;
+    }
+    this->Input->GetCellPoints(cellId, cellPts);
+    vtkIdType numCellPts = cellPts->GetNumberOfIds();
+    if (numCellPts < 1)
+    {
+      return;
+    }
+    const vtkIdType *ptIds = cellPts->GetPointer(0);
+    double range[2];
+    range[0] = range[1] = this->CutScalars[ptIds[0]];
+    for (vtkIdType i = 1; i < numCellPts; ++i)
+    {
+      range[0] = std::min(range[0], this->CutScalars[ptIds[i]]);
+      range[1] = std::max(range[1], this->CutScalars[ptIds[i]]);
+    }
+    int i;
+    for (i = 0; i < this->NumberOfValues; ++i)
+    {
+      if (this->Values[i] >= range[0] && this->Values[i] <= range[1])
+      {
+        break;
+      }
+    }
+    if (i == this->NumberOfValues)
+    {
+      return;
+    }
+    cellIds.push_back(cellId);
+    double x[3];
+    for (vtkIdType j = 0; j < numCellPts; ++j)
+    {
+      this->Input->GetPoint(ptIds[j], x);
+      for (int k = 0; k < 3; ++k)
+      {
+        bounds[2*k] = std::min(bounds[2*k], x[k]);
+        bounds[2*k+1] = std::max(bounds[2*k+1], x[k]);
+      }
+    }
+  }
+
+  void operator()(vtkIdType chunkId, vtkIdType endChunkId)
+  {
+    vtkGenericCell *cell = this->Cell.Local();
+    vtkIdList *cellPts = this->CellPts.Local();
+    vtkDoubleArray *cellScalars = this->CellScalars.Local();
+    vtkMergePoints *locator = this->Locator.Local();
+    vtkCellData *noCellData = this->NoCellData.Local();
+    std::vector<vtkIdType>& cellIds = this->CellIds.Local();
+
+    for ( ; chunkId < endChunkId; ++chunkId)
+    {
+      // Find the cells to cut.
+      cellIds.clear();
+      double bounds[6] = { VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                           VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN };
+      vtkIdType item = chunkId * this->ItemsPerChunk;
+      vtkIdType endItem =
+        std::min(item + this->ItemsPerChunk, this->NumberOfItems);
+      for ( ; item < endItem; ++item)
+      {
+        if (this->ScalarTree)
+        {
+          vtkIdType numCells;
+          const vtkIdType *batch =
+            this->ScalarTree->GetCellBatch(item, numCells);
+          for (vtkIdType i = 0; i < numCells; ++i)
+          {
+            this->AddCell(batch[i], cellPts, cellIds, bounds);
+          }
+        }
+        else
+        {
+          this->AddCell(item, cellPts, cellIds, bounds);
+        }
+      }
+      if (cellIds.empty())
+      {
+        continue;
+      }
+
+      // Cut them.
+      CutterChunk& chunk = this->Chunks[chunkId];
+      vtkIdType estimatedSize = static_cast<vtkIdType>(
+        cellIds.size() * this->NumberOfValues);
+      chunk.Points = vtkSmartPointer<vtkPoints>::New();
+      chunk.Points->SetDataType(this->PointsType);
+      chunk.Points->Allocate(estimatedSize, estimatedSize);
+      chunk.PointData = vtkSmartPointer<vtkPointData>::New();
+      chunk.PointData->InterpolateAllocate(
+        this->InPD, estimatedSize, estimatedSize);
+      for (int k = 0; k < 3; ++k)
+      {
+        chunk.Cells[k] = vtkSmartPointer<vtkCellArray>::New();
+        chunk.Cells[k]->Allocate(4 * estimatedSize, 4 * estimatedSize);
+      }
+      locator->InitPointInsertion(chunk.Points, bounds, estimatedSize);
+      vtkContourHelper helper(locator, chunk.Cells[0], chunk.Cells[1],
+                              chunk.Cells[2], this->InPD, this->InCD,
+                              chunk.PointData, noCellData,
+                              static_cast<int>(estimatedSize),
+                              this->GenerateTriangles);
+      for (size_t i = 0; i < cellIds.size(); ++i)
+      {
+        vtkIdType cellId = cellIds[i];
+        this->Input->GetCell(cellId, cell);
+        vtkIdList *pointIds = cell->GetPointIds();
+        vtkIdType numCellPts = pointIds->GetNumberOfIds();
+        cellScalars->SetNumberOfTuples(numCellPts);
+        for (vtkIdType j = 0; j < numCellPts; ++j)
+        {
+          cellScalars->SetValue(j, this->CutScalars[pointIds->GetId(j)]);
+        }
+        for (int v = 0; v < this->NumberOfValues; ++v)
+        {
+          helper.Contour(cell, this->Values[v], cellScalars, cellId);
+          for (int k = 0; k < 3; ++k)
+          {
+            chunk.SourceCells[k].resize(
+              chunk.Cells[k]->GetNumberOfCells(), cellId);
+          }
+        }
+      }
+      locator->Initialize();
+    }
+  }
+};
+
+// A point generated by a chunk, with its position in the sequence of the
+// points of all the chunks. Sorting them brings the coincident points
+// together, in the order in which the serial cutter would insert them.
+struct CutterPoint
+{
+  double X[3];
+  vtkIdType Position;
+
+  bool operator<(const CutterPoint& other) const
+  {
+    if (this->X[0] != other.X[0])
+    {
+      return this->X[0] < other.X[0];
+    }
+    if (this->X[1] != other.X[1])
+    {
+      return this->X[1] < other.X[1];
+    }
+    if (this->X[2] != other.X[2])
+    {
+      return this->X[2] < other.X[2];
+    }
+    return this->Position < other.Position;
+  }
+
+  bool IsCoincident(const CutterPoint& other) const
+  {
+    return this->X[0] == other.X[0] && this->X[1] == other.X[1] &&
+      this->X[2] == other.X[2];
+  }
+};
+
+struct CutterGatherPointsOp
+{
+  const CutterChunk *Chunks;
+  const vtkIdType *Offsets;
+  CutterPoint *Points;
+
+  void operator()(vtkIdType chunkId, vtkIdType endChunkId) const
+  {
+    for ( ; chunkId < endChunkId; ++chunkId)
+    {
+      vtkPoints *points = this->Chunks[chunkId].Points;
+      vtkIdType offset = this->Offsets[chunkId];
+      vtkIdType numPts = this->Offsets[chunkId + 1] - offset;
+      for (vtkIdType i = 0; i < numPts; ++i)
+      {
+        CutterPoint& point = this->Points[offset + i];
+        points->GetPoint(i, point.X);
+        point.Position = offset + i;
+      }
+    }
+  }
+};
+
+// Each point is merged with the first coincident point.
+struct CutterMergePointsOp
+{
+  const CutterPoint *Points;
+  vtkIdType *MergeMap;
+  vtkIdType *Flags;
+
+  void operator()(vtkIdType i, vtkIdType end) const
+  {
+    for ( ; i < end; ++i)
+    {
+      vtkIdType first = i;
+      while (first > 0 && this->Points[first - 1].IsCoincident(this->Points[i]))
+      {
+        --first;
+      }
+      vtkIdType position = this->Points[i].Position;
+      this->MergeMap[position] = this->Points[first].Position;
+      this->Flags[position] = first == i ? 1 : 0;
+    }
+  }
+};
+
+// Once the first points are numbered, number the points merged with them.
+struct CutterNumberPointsOp
+{
+  const vtkIdType *MergeMap;
+  vtkIdType *PointIds;
+
+  void operator()(vtkIdType position, vtkIdType end) const
+  {
+    for ( ; position < end; ++position)
+    {
+      if (this->MergeMap[position] != position)
+      {
+        this->PointIds[position] = this->PointIds[this->MergeMap[position]];
+      }
+    }
+  }
+};
+
+// Copy the points which are kept, and their attributes.
+struct CutterCopyPointsOp
+{
+  const CutterChunk *Chunks;
+  const vtkIdType *Offsets;
+  const vtkIdType *MergeMap;
+  const vtkIdType *PointIds;
+  vtkPoints *OutPoints;
+  vtkPointData *OutPD;
+
+  void operator()(vtkIdType chunkId, vtkIdType endChunkId) const
+  {
+    int numArrays = this->OutPD->GetNumberOfArrays();
+    double x[3];
+    for ( ; chunkId < endChunkId; ++chunkId)
+    {
+      const CutterChunk& chunk = this->Chunks[chunkId];
+      vtkIdType offset = this->Offsets[chunkId];
+      vtkIdType numPts = this->Offsets[chunkId + 1] - offset;
+      for (vtkIdType i = 0; i < numPts; ++i)
+      {
+        if (this->MergeMap[offset + i] != offset + i)
+        {
+          continue;
+        }
+        vtkIdType ptId = this->PointIds[offset + i];
+        chunk.Points->GetPoint(i, x);
+        this->OutPoints->SetPoint(ptId, x);
+        for (int a = 0; a < numArrays; ++a)
+        {
+          this->OutPD->GetAbstractArray(a)->SetTuple(
+            ptId, i, chunk.PointData->GetAbstractArray(a));
+        }
+      }
+    }
+  }
+};
+
+// Copy the verts, lines or polys of the chunks, renumbering their points,
+// and the ids of the input cells they come from.
+struct CutterCopyCellsOp
+{
+  const CutterChunk *Chunks;
+  int Kind; // 0 for verts, 1 for lines, 2 for polys
+  const vtkIdType *PointOffsets;
+  const vtkIdType *ConnOffsets;
+  const vtkIdType *CellOffsets;
+  const vtkIdType *PointIds;
+  vtkIdType *Connectivity;
+  vtkIdType *SourceCells;
+
+  void operator()(vtkIdType chunkId, vtkIdType endChunkId) const
+  {
+    for ( ; chunkId < endChunkId; ++chunkId)
+    {
+      const CutterChunk& chunk = this->Chunks[chunkId];
+      if (!chunk.Points)
+      {
+        continue;
+      }
+      vtkCellArray *cells = chunk.Cells[this->Kind];
+      const vtkIdType *conn = cells->GetPointer();
+      const vtkIdType *connEnd = conn + cells->GetNumberOfConnectivityEntries();
+      const vtkIdType *pointIds = this->PointIds + this->PointOffsets[chunkId];
+      vtkIdType *outConn = this->Connectivity + this->ConnOffsets[chunkId];
+      while (conn < connEnd)
+      {
+        vtkIdType npts = *conn++;
+        *outConn++ = npts;
+        for (vtkIdType i = 0; i < npts; ++i)
+        {
+          *outConn++ = pointIds[*conn++];
+        }
+      }
+      std::copy(chunk.SourceCells[this->Kind].begin(),
+                chunk.SourceCells[this->Kind].end(),
+                this->SourceCells + this->CellOffsets[chunkId]);
+    }
+  }
+};
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Cut unstructured grids and polydata in parallel (see the class
+// documentation). The cells are cut in chunks, in the order in which the
+// serial cutters visit them, and the points of the chunks are merged in the
+// order in which the serial cutters insert them, so that the output is the
+// same as theirs.
+void vtkCutter::PointSetCutterSMP(vtkDataSet *input, vtkPolyData *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+  int numContours = this->ContourValues->GetNumberOfContours();
+  double *contourValues = this->ContourValues->GetValues();
+  if (numCells < 1)
+  {
+    return;
+  }
+
+  // The cell access methods of the datasets are thread safe once they have
+  // been called from a single thread (e.g. to build the cells of polydata).
+  vtkNew<vtkGenericCell> cell;
+  input->GetCell(0, cell.GetPointer());
+  input->GetCellType(0);
+
+  // Evaluate the cut function at the points, unless it has already been done
+  // for the same input and function.
+  bool newScalars = false;
+  if (!this->CutScalars || this->CutScalarsInput != input ||
+      this->CutScalarsFunction != this->CutFunction ||
+      this->CutScalars->GetNumberOfTuples() != numPts ||
+      this->CutScalarsTime < input->GetMTime() ||
+      this->CutScalarsTime < this->CutFunction->GetMTime())
+  {
+    if (!this->CutScalars)
+    {
+      this->CutScalars = vtkDoubleArray::New();
+    }
+    this->CutScalars->SetNumberOfTuples(numPts);
+    // As in the serial cutters, the transform of the function is only used
+    // for polydata. vtkPlane evaluates arrays of points in parallel already.
+    bool transform = input->GetDataObjectType() != VTK_UNSTRUCTURED_GRID;
+    if (!transform && vtkPlane::SafeDownCast(this->CutFunction))
+    {
+      this->CutFunction->EvaluateFunction(
+        vtkPointSet::SafeDownCast(input)->GetPoints()->GetData(),
+        this->CutScalars);
+    }
+    else
+    {
+      CutterFunctionOp evaluate = { input, this->CutFunction, transform,
+        this->CutScalars->GetPointer(0) };
+      vtkSMPTools::For(0, numPts, evaluate);
+    }
+    this->CutScalars->Modified();
+    this->CutScalarsInput = input;
+    this->CutScalarsFunction = this->CutFunction;
+    this->CutScalarsTime.Modified();
+    newScalars = true;
+  }
+
+  // The scalar tree is rebuilt when the scalars have been recomputed.
+  if (this->UseScalarTree)
+  {
+    if (!this->ScalarTree)
+    {
+      this->ScalarTree = vtkSpanSpace::New();
+    }
+    this->ScalarTree->SetDataSet(input);
+    this->ScalarTree->SetScalars(this->CutScalars);
+    if (newScalars)
+    {
+      this->ScalarTree->Modified();
+    }
+  }
+
+  vtkPointData *inPD = input->GetPointData();
+  vtkCellData *inCD = input->GetCellData();
+  vtkSmartPointer<vtkPointData> cutPD;
+  if (this->GenerateCutScalars)
+  {
+    cutPD = vtkSmartPointer<vtkPointData>::New();
+    cutPD->ShallowCopy(inPD);
+    cutPD->SetScalars(this->CutScalars);
+    inPD = cutPD;
+  }
+
+  int pointsType = VTK_FLOAT;
+  if (this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    pointsType = vtkPointSet::SafeDownCast(input)->GetPoints()->GetDataType();
+  }
+  else if (this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    pointsType = VTK_DOUBLE;
+  }
+
+  unsigned char cellTypeDimensions[VTK_NUMBER_OF_CELL_TYPES];
+  vtkCutter::GetCellTypeDimensions(cellTypeDimensions);
+
+  // Cut the cells in as many passes as the serial cutters: by increasing
+  // dimension when sorting by value, by contour value otherwise. With a
+  // scalar tree, each contour value is processed separately.
+  bool useTree = this->UseScalarTree && this->ScalarTree;
+  int numPasses = (this->SortBy == VTK_SORT_BY_CELL || useTree) ?
+    numContours : 3;
+  std::vector<CutterChunk> chunks;
+  for (int pass = 0; pass < numPasses && !this->GetAbortExecute(); ++pass)
+  {
+    CutterCellsOp cut;
+    cut.Input = input;
+    cut.InPD = inPD;
+    cut.InCD = inCD;
+    cut.CutScalars = this->CutScalars->GetPointer(0);
+    cut.ScalarTree = NULL;
+    cut.NumberOfItems = numCells;
+    cut.ItemsPerChunk = CUTTER_CHUNK_SIZE;
+    cut.Values = contourValues;
+    cut.NumberOfValues = numContours;
+    cut.Dimensions[0] = 1;
+    cut.Dimensions[1] = 3;
+    cut.CellTypeDimensions = cellTypeDimensions;
+    cut.PointsType = pointsType;
+    cut.GenerateTriangles = this->GenerateTriangles != 0;
+    if (this->SortBy == VTK_SORT_BY_CELL || useTree)
+    {
+      cut.Values = contourValues + pass;
+      cut.NumberOfValues = 1;
+      if (this->SortBy == VTK_SORT_BY_CELL)
+      {
+        cut.Dimensions[0] = 0;
+      }
+    }
+    else
+    {
+      cut.Dimensions[0] = cut.Dimensions[1] = pass + 1;
+    }
+    if (useTree)
+    {
+      this->ScalarTree->InitTraversal(contourValues[pass]);
+      cut.ScalarTree = this->ScalarTree;
+      cut.NumberOfItems = this->ScalarTree->GetNumberOfCellBatches();
+      vtkIdType batchSize = 1;
+      if (cut.NumberOfItems > 0)
+      {
+        this->ScalarTree->GetCellBatch(0, batchSize);
+      }
+      cut.ItemsPerChunk =
+        std::max<vtkIdType>(1, CUTTER_CHUNK_SIZE / std::max<vtkIdType>(1, batchSize));
+    }
+
+    vtkIdType numChunks =
+      (cut.NumberOfItems + cut.ItemsPerChunk - 1) / cut.ItemsPerChunk;
+    size_t firstChunk = chunks.size();
+    chunks.resize(firstChunk + numChunks);
+    cut.Chunks = numChunks > 0 ? &chunks[firstChunk] : NULL;
+    vtkSMPTools::For(0, numChunks, cut);
+    this->UpdateProgress(0.8 * (pass + 1) / numPasses);
+  }
+
+  // Number the points of the chunks one after the other, then merge the
+  // coincident points: each group of coincident points is numbered after its
+  // first point.
+  vtkIdType numChunks = static_cast<vtkIdType>(chunks.size());
+  std::vector<vtkIdType> pointOffsets(numChunks + 1, 0);
+  for (vtkIdType chunkId = 0; chunkId < numChunks; ++chunkId)
+  {
+    pointOffsets[chunkId + 1] = pointOffsets[chunkId] + (chunks[chunkId].Points ?
+      chunks[chunkId].Points->GetNumberOfPoints() : 0);
+  }
+  vtkIdType numChunkPts = pointOffsets[numChunks];
+  if (numChunkPts == 0)
+  {
+    return;
+  }
+
+  std::vector<CutterPoint> points(numChunkPts);
+  CutterGatherPointsOp gather = { &chunks[0], &pointOffsets[0], &points[0] };
+  vtkSMPTools::For(0, numChunks, gather);
+  vtkSMPTools::Sort(points.begin(), points.end());
+
+  std::vector<vtkIdType> mergeMap(numChunkPts);
+  std::vector<vtkIdType> pointIds(numChunkPts);
+  CutterMergePointsOp merge = { &points[0], &mergeMap[0], &pointIds[0] };
+  vtkSMPTools::For(0, numChunkPts, merge);
+  std::vector<CutterPoint>().swap(points);
+  vtkIdType numNewPts = vtkSMPTools::ExclusiveScan(
+    pointIds.begin(), pointIds.end(), pointIds.begin(), vtkIdType(0));
+  CutterNumberPointsOp number = { &mergeMap[0], &pointIds[0] };
+  vtkSMPTools::For(0, numChunkPts, number);
+
+  vtkPoints *newPoints = vtkPoints::New();
+  newPoints->SetDataType(pointsType);
+  newPoints->SetNumberOfPoints(numNewPts);
+  vtkPointData *outPD = output->GetPointData();
+  outPD->InterpolateAllocate(inPD, numNewPts);
+  for (int a = 0; a < outPD->GetNumberOfArrays(); ++a)
+  {
+    outPD->GetAbstractArray(a)->SetNumberOfTuples(numNewPts);
+  }
+  CutterCopyPointsOp copyPoints = { &chunks[0], &pointOffsets[0],
+    &mergeMap[0], &pointIds[0], newPoints, outPD };
+  vtkSMPTools::For(0, numChunks, copyPoints);
+  output->SetPoints(newPoints);
+  newPoints->Delete();
+
+  // Copy the verts, then the lines, then the polys of the chunks, and the
+  // ids of the input cells they come from to copy the cell data.
+  vtkIdType numNewCells = 0;
+  for (vtkIdType chunkId = 0; chunkId < numChunks; ++chunkId)
+  {
+    if (chunks[chunkId].Points)
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        numNewCells += chunks[chunkId].Cells[k]->GetNumberOfCells();
+      }
+    }
+  }
+  vtkIdList *srcCellIds = vtkIdList::New();
+  srcCellIds->SetNumberOfIds(numNewCells);
+  std::vector<vtkIdType> connOffsets(numChunks + 1);
+  std::vector<vtkIdType> cellOffsets(numChunks + 1);
+  vtkIdType cellOffset = 0;
+  for (int k = 0; k < 3; ++k)
+  {
+    connOffsets[0] = 0;
+    cellOffsets[0] = cellOffset;
+    for (vtkIdType chunkId = 0; chunkId < numChunks; ++chunkId)
+    {
+      vtkCellArray *cells = chunks[chunkId].Cells[k];
+      connOffsets[chunkId + 1] = connOffsets[chunkId] +
+        (cells ? cells->GetNumberOfConnectivityEntries() : 0);
+      cellOffsets[chunkId + 1] = cellOffsets[chunkId] +
+        (cells ? cells->GetNumberOfCells() : 0);
+    }
+    vtkIdType numKindCells = cellOffsets[numChunks] - cellOffset;
+    if (numKindCells == 0)
+    {
+      continue;
+    }
+    vtkIdTypeArray *connectivity = vtkIdTypeArray::New();
+    connectivity->SetNumberOfValues(connOffsets[numChunks]);
+    CutterCopyCellsOp copyCells = { &chunks[0], k, &pointOffsets[0],
+      &connOffsets[0], &cellOffsets[0], &pointIds[0],
+      connectivity->GetPointer(0), srcCellIds->GetPointer(0) };
+    vtkSMPTools::For(0, numChunks, copyCells);
+    vtkCellArray *newCells = vtkCellArray::New();
+    newCells->SetCells(numKindCells, connectivity);
+    connectivity->Delete();
+    if (k == 0)
+    {
+      output->SetVerts(newCells);
+    }
+    else if (k == 1)
+    {
+      output->SetLines(newCells);
+    }
+    else
+    {
+      output->SetPolys(newCells);
+    }
+    newCells->Delete();
+    cellOffset += numKindCells;
+  }
+
+  vtkCellData *outCD = output->GetCellData();
+  outCD->CopyAllocate(inCD, numNewCells);
+  vtkIdList *newCellIds = vtkIdList::New();
+  newCellIds->SetNumberOfIds(numNewCells);
+  vtkIdType *newCellIdsPtr = newCellIds->GetPointer(0);
+  for (vtkIdType cellId = 0; cellId < numNewCells; ++cellId)
+  {
+    newCellIdsPtr[cellId] = cellId;
+  }
+  outCD->CopyData(inCD, srcCellIds, newCellIds);
+  srcCellIds->Delete();
+  newCellIds->Delete();
+
+  output->Squeeze();
+}
+
 //----------------------------------------------------------------------------
 // Specify a spatial locator for merging points. By default,
 // an instance of vtkMergePoints is used.
@@ -1069,4 +1760,15 @@ void vtkCutter::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "Use Scalar Tree: "
+     << (this->UseScalarTree ? "On\n" : "Off\n");
+  if ( this->ScalarTree )
+  {
+    os << indent << "Scalar Tree: " << this->ScalarTree << "\n";
+  }
+  else
+  {
+    os << indent << "Scalar Tree: (none)\n";
+  }
 }
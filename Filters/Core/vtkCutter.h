@@ -38,6 +38,24 @@
  * By default, if an implicit function is set it is used to clip the data
  * set, otherwise the dataset scalars are used to perform the clipping.
  *
+ * When EnableSMP is on, unstructured grids and polydata are cut in parallel
+ * with vtkSMPTools: the implicit function is evaluated in parallel, the
+ * cells are cut in chunks, each with its own points and its own
+ * vtkMergePoints locator, and the coincident points of different chunks
+ * are merged afterwards by sorting them. The output does not depend on the
+ * number of threads. The Locator is not used: coincident points are always
+ * merged, whereas with single precision points the serial vtkMergePoints
+ * may leave a few of them unmerged. Otherwise the output is the same as
+ * with the serial algorithm, except that with GenerateTriangles off a
+ * polygon may start at a different point. The values of
+ * the implicit function are kept between executions, and if UseScalarTree
+ * is on, a scalar tree built over them is used to visit only the cells
+ * which may be cut. To sweep a cut surface interactively through a large
+ * dataset, keep the cut function fixed and change the contour values: the
+ * function values and the scalar tree are then reused. With a scalar tree,
+ * the cells are processed one contour value at a time, in the order of the
+ * tree.
+ *
  * @sa
  * vtkImplicitFunction vtkClipPolyData
 */
@@ -53,8 +71,10 @@
 #define VTK_SORT_BY_VALUE 0
 #define VTK_SORT_BY_CELL 1
 
+class vtkDoubleArray;
 class vtkImplicitFunction;
 class vtkIncrementalPointLocator;
+class vtkScalarTree;
 class vtkSynchronizedTemplates3D;
 class vtkSynchronizedTemplatesCutter3D;
 class vtkGridSynchronizedTemplates3D;
@@ -206,6 +226,36 @@ public:
    */
   void CreateDefaultLocator();
 
+  //@{
+  /**
+   * Enable/disable the threaded cutting of unstructured grids and polydata
+   * (see the class documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
+  //@{
+  /**
+   * Enable the use of a scalar tree to accelerate the threaded cutting. The
+   * scalar tree is kept as long as the input and the cut function are not
+   * modified. This flag is only used when EnableSMP is on.
+   */
+  vtkSetMacro(UseScalarTree,int);
+  vtkGetMacro(UseScalarTree,int);
+  vtkBooleanMacro(UseScalarTree,int);
+  //@}
+
+  //@{
+  /**
+   * Specify the instance of vtkScalarTree to use. If not specified and
+   * UseScalarTree is enabled, then a vtkSpanSpace will be used.
+   */
+  virtual void SetScalarTree(vtkScalarTree*);
+  vtkGetObjectMacro(ScalarTree,vtkScalarTree);
+  //@}
+
   /**
    * Normally I would put this in a different class, but since
    * This is a temporary fix until we convert this class and contour filter
@@ -237,6 +287,7 @@ protected:
                               vtkInformationVector *);
   void StructuredGridCutter(vtkDataSet *, vtkPolyData *);
   void RectilinearGridCutter(vtkDataSet *, vtkPolyData *);
+  void PointSetCutterSMP(vtkDataSet *input, vtkPolyData *output);
   vtkImplicitFunction *CutFunction;
   int GenerateTriangles;
 
@@ -250,6 +301,17 @@ protected:
   vtkContourValues *ContourValues;
   int GenerateCutScalars;
   int OutputPointsPrecision;
+
+  int EnableSMP;
+  int UseScalarTree;
+  vtkScalarTree *ScalarTree;
+
+  // Values of the cut function at the points of the input, kept between
+  // executions of the threaded cutter.
+  vtkDoubleArray *CutScalars;
+  vtkDataSet *CutScalarsInput;
+  vtkImplicitFunction *CutScalarsFunction;
+  vtkTimeStamp CutScalarsTime;
 private:
   vtkCutter(const vtkCutter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkCutter&) VTK_DELETE_FUNCTION;
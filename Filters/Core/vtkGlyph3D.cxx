@@ -14,18 +14,23 @@
 =========================================================================*/
 #include "vtkGlyph3D.h"
 
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkCell.h"
+#include "vtkDoubleArray.h"
 #include "vtkFloatArray.h"
 #include "vtkIdList.h"
 #include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkIntArray.h"
 #include "vtkMath.h"
+#include "vtkMatrix4x4.h"
 #include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTransform.h"
@@ -33,6 +38,9 @@
 #include "vtkUniformGrid.h"
 #include "vtkUnsignedCharArray.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkGlyph3D);
 vtkCxxSetObjectMacro(vtkGlyph3D, SourceTransform, vtkTransform);
 
@@ -59,6 +67,8 @@ vtkGlyph3D::vtkGlyph3D()
   this->SetNumberOfInputPorts(2);
   this->FillCellData = 0;
   this->SourceTransform = 0;
+  this->EnableSMP = 0;
+  this->GenerateInstances = 0;
 
   // by default process active point scalars
   this->SetInputArrayToProcess(0,0,0,vtkDataObject::FIELD_ASSOCIATION_POINTS,
@@ -133,6 +143,12 @@ bool vtkGlyph3D::Execute(
     return true;
   }
 
+  if (this->EnableSMP || this->GenerateInstances)
+  {
+    return this->ExecuteSMP(input, sourceVector, output, inSScalars,
+                            inVectors);
+  }
+
   // this is used to respect blanking specified on uniform grids.
   vtkUniformGrid* inputUG = vtkUniformGrid::SafeDownCast(input);
 
@@ -732,6 +748,980 @@ bool vtkGlyph3D::Execute(
   return true;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// Number of input points per block of the threaded glyphing.
+const vtkIdType GLYPH_BLOCK_SIZE = 1024;
+
+// What the float scalars of the glyphs hold.
+enum GlyphScalars
+{
+  GLYPH_SCALARS_NONE,
+  GLYPH_SCALARS_SCALE,
+  GLYPH_SCALARS_VECTOR_MAGNITUDE
+};
+
+// A source of the table of glyphs. Its geometry and attributes are
+// extracted once, so that the threads only read plain arrays.
+struct GlyphSource
+{
+  vtkPolyData *Source;
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  std::vector<double> Points; // transformed by the SourceTransform
+  std::vector<double> Normals;
+  std::vector<double> TCoords;
+  int NumberOfTCoordComponents;
+  // The connectivity of the verts, lines, polys and strips, which are
+  // numbered in this order.
+  vtkIdType NumberOfCellsOfKind[4];
+  vtkIdType ConnectivitySize[4];
+  const vtkIdType *Connectivity[4];
+
+  GlyphSource() : Source(NULL), NumberOfPoints(0), NumberOfCells(0),
+    NumberOfTCoordComponents(0)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      this->NumberOfCellsOfKind[k] = this->ConnectivitySize[k] = 0;
+      this->Connectivity[k] = NULL;
+    }
+  }
+
+  void Initialize(vtkPolyData *source, vtkTransform *sourceTransform)
+  {
+    this->Source = source;
+    if (!source)
+    {
+      return;
+    }
+
+    vtkSmartPointer<vtkPoints> points = source->GetPoints();
+    this->NumberOfPoints = points ? points->GetNumberOfPoints() : 0;
+    if (this->NumberOfPoints > 0 && sourceTransform)
+    {
+      vtkSmartPointer<vtkPoints> transformed =
+        vtkSmartPointer<vtkPoints>::New();
+      transformed->SetDataTypeToDouble();
+      sourceTransform->TransformPoints(points, transformed);
+      points = transformed;
+    }
+    this->Points.resize(3 * this->NumberOfPoints);
+    for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+    {
+      points->GetPoint(i, &this->Points[3 * i]);
+    }
+
+    vtkDataArray *normals = source->GetPointData()->GetNormals();
+    if (normals && normals->GetNumberOfTuples() >= this->NumberOfPoints)
+    {
+      this->Normals.resize(3 * this->NumberOfPoints);
+      for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+      {
+        normals->GetTuple(i, &this->Normals[3 * i]);
+      }
+    }
+    vtkDataArray *tcoords = source->GetPointData()->GetTCoords();
+    if (tcoords && tcoords->GetNumberOfTuples() >= this->NumberOfPoints)
+    {
+      int numComps = tcoords->GetNumberOfComponents();
+      this->NumberOfTCoordComponents = numComps;
+      this->TCoords.resize(numComps * this->NumberOfPoints);
+      for (vtkIdType i = 0; i < this->NumberOfPoints; ++i)
+      {
+        tcoords->GetTuple(i, &this->TCoords[numComps * i]);
+      }
+    }
+
+    vtkCellArray *cells[4] = {source->GetVerts(), source->GetLines(),
+                              source->GetPolys(), source->GetStrips()};
+    for (int k = 0; k < 4; ++k)
+    {
+      this->NumberOfCellsOfKind[k] = cells[k]->GetNumberOfCells();
+      this->ConnectivitySize[k] = cells[k]->GetNumberOfConnectivityEntries();
+      this->Connectivity[k] = cells[k]->GetPointer();
+      this->NumberOfCells += this->NumberOfCellsOfKind[k];
+    }
+  }
+};
+
+// The sizes of the output generated by a block of input points, turned into
+// the offsets of the block in the output by a prefix sum.
+struct GlyphBlock
+{
+  vtkIdType NumberOfPoints;
+  vtkIdType NumberOfCells;
+  vtkIdType NumberOfCellsOfKind[4];
+  vtkIdType ConnectivitySize[4];
+
+  void Add(const GlyphBlock &block)
+  {
+    this->NumberOfPoints += block.NumberOfPoints;
+    this->NumberOfCells += block.NumberOfCells;
+    for (int k = 0; k < 4; ++k)
+    {
+      this->NumberOfCellsOfKind[k] += block.NumberOfCellsOfKind[k];
+      this->ConnectivitySize[k] += block.ConnectivitySize[k];
+    }
+  }
+};
+
+// Computes the parameters of the glyph of an input point, as the serial
+// vtkGlyph3D::Execute() does.
+struct GlyphEvaluator
+{
+  vtkGlyph3D *Self;
+  vtkDataSet *Input;
+  vtkUniformGrid *InputUG;
+  unsigned char *GhostLevels;
+  vtkDataArray *Scalars;
+  vtkDataArray *Vectors; // NULL when the glyphs do not use vectors
+  int ScaleMode;
+  int IndexMode;
+  int Clamping;
+  double Range[2];
+  double Den;
+  const std::vector<GlyphSource> *Sources;
+
+  // Get the scalar, the vector and its magnitude, and the clamped scale
+  // factors of a point.
+  void Evaluate(vtkIdType ptId, double &s, double v[3], double &vMag,
+                double scale[3]) const
+  {
+    s = vMag = 0.0;
+    v[0] = v[1] = v[2] = 0.0;
+    scale[0] = scale[1] = scale[2] = 1.0;
+    if (this->Scalars)
+    {
+      s = this->Scalars->GetComponent(ptId, 0);
+      if (this->ScaleMode == VTK_SCALE_BY_SCALAR ||
+          this->ScaleMode == VTK_DATA_SCALING_OFF)
+      {
+        scale[0] = scale[1] = scale[2] = s;
+      }
+    }
+    if (this->Vectors)
+    {
+      this->Vectors->GetTuple(ptId, v);
+      vMag = vtkMath::Norm(v);
+      if (this->ScaleMode == VTK_SCALE_BY_VECTORCOMPONENTS)
+      {
+        scale[0] = v[0];
+        scale[1] = v[1];
+        scale[2] = v[2];
+      }
+      else if (this->ScaleMode == VTK_SCALE_BY_VECTOR)
+      {
+        scale[0] = scale[1] = scale[2] = vMag;
+      }
+    }
+    if (this->Clamping)
+    {
+      for (int i = 0; i < 3; ++i)
+      {
+        scale[i] = (scale[i] < this->Range[0] ? this->Range[0] :
+                    (scale[i] > this->Range[1] ? this->Range[1] : scale[i]));
+        scale[i] = (scale[i] - this->Range[0]) / this->Den;
+      }
+    }
+  }
+
+  // Return the index of the source of the glyph of a point, or -1 if the
+  // point is not glyphed.
+  int GlyphIndex(vtkIdType ptId, double s, double vMag) const
+  {
+    int index = 0;
+    if (this->IndexMode != VTK_INDEXING_OFF)
+    {
+      int numberOfSources = static_cast<int>(this->Sources->size());
+      double value = (this->IndexMode == VTK_INDEXING_BY_SCALAR ? s : vMag);
+      index = static_cast<int>(
+        (value - this->Range[0]) * numberOfSources / this->Den);
+      index = (index < 0 ? 0 :
+               (index >= numberOfSources ? (numberOfSources-1) : index));
+    }
+    if (index < 0 || !(*this->Sources)[index].Source)
+    {
+      return -1;
+    }
+    if ((this->GhostLevels &&
+         this->GhostLevels[ptId] & vtkDataSetAttributes::DUPLICATEPOINT) ||
+        (this->InputUG && !this->InputUG->IsPointVisible(ptId)) ||
+        !this->Self->IsPointVisible(this->Input, ptId))
+    {
+      return -1;
+    }
+    return index;
+  }
+};
+
+// First pass: find the glyph of each point and count the output of each
+// block of points.
+struct GlyphCountOp
+{
+  const GlyphEvaluator *Evaluator;
+  vtkIdType NumberOfPoints;
+  bool Instances;
+  int *Glyphs;
+  GlyphBlock *Blocks;
+
+  void operator()(vtkIdType block, vtkIdType endBlock)
+  {
+    const std::vector<GlyphSource> &sources = *this->Evaluator->Sources;
+    double s, v[3], vMag, scale[3];
+    for ( ; block < endBlock; ++block)
+    {
+      GlyphBlock &counts = this->Blocks[block];
+      counts = GlyphBlock();
+      vtkIdType ptId = block * GLYPH_BLOCK_SIZE;
+      vtkIdType endPtId =
+        std::min(ptId + GLYPH_BLOCK_SIZE, this->NumberOfPoints);
+      for ( ; ptId < endPtId; ++ptId)
+      {
+        this->Evaluator->Evaluate(ptId, s, v, vMag, scale);
+        int glyph = this->Evaluator->GlyphIndex(ptId, s, vMag);
+        this->Glyphs[ptId] = glyph;
+        if (glyph < 0)
+        {
+          continue;
+        }
+        if (this->Instances)
+        {
+          counts.NumberOfPoints++;
+          counts.NumberOfCells++;
+          counts.NumberOfCellsOfKind[0]++;
+          counts.ConnectivitySize[0] += 2;
+          continue;
+        }
+        const GlyphSource &source = sources[glyph];
+        counts.NumberOfPoints += source.NumberOfPoints;
+        counts.NumberOfCells += source.NumberOfCells;
+        for (int k = 0; k < 4; ++k)
+        {
+          counts.NumberOfCellsOfKind[k] += source.NumberOfCellsOfKind[k];
+          counts.ConnectivitySize[k] += source.ConnectivitySize[k];
+        }
+      }
+    }
+  }
+};
+
+// Compute the matrix that vtkTransform builds for Identity(), Translate(x),
+// RotateWXYZ(180, axis) and Scale(scale), with the same floating point
+// operations but without the overhead of the transform pipeline.
+void GlyphMatrix(const double x[3], const double *axis, const double *scale,
+                 double matrix[4][4])
+{
+  double pre[4][4];
+  double op[4][4];
+  bool concatenated = false;
+  vtkMatrix4x4::Identity(*pre);
+  if (x[0] != 0.0 || x[1] != 0.0 || x[2] != 0.0)
+  {
+    vtkMatrix4x4::Identity(*op);
+    op[0][3] = x[0];
+    op[1][3] = x[1];
+    op[2][3] = x[2];
+    vtkMatrix4x4::Multiply4x4(*pre, *op, *pre);
+    concatenated = true;
+  }
+  if (axis && (axis[0] != 0.0 || axis[1] != 0.0 || axis[2] != 0.0))
+  {
+    // Rotation matrix of the normalized quaternion.
+    double angle = vtkMath::RadiansFromDegrees(180.0);
+    double w = cos(0.5*angle);
+    double f = sin(0.5*angle) /
+      sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+    double qx = axis[0] * f;
+    double qy = axis[1] * f;
+    double qz = axis[2] * f;
+
+    double ww = w*w;
+    double wx = w*qx;
+    double wy = w*qy;
+    double wz = w*qz;
+    double xx = qx*qx;
+    double yy = qy*qy;
+    double zz = qz*qz;
+    double xy = qx*qy;
+    double xz = qx*qz;
+    double yz = qy*qz;
+    double s = ww - xx - yy - zz;
+
+    vtkMatrix4x4::Identity(*op);
+    op[0][0] = xx*2 + s;
+    op[1][0] = (xy + wz)*2;
+    op[2][0] = (xz - wy)*2;
+    op[0][1] = (xy - wz)*2;
+    op[1][1] = yy*2 + s;
+    op[2][1] = (yz + wx)*2;
+    op[0][2] = (xz + wy)*2;
+    op[1][2] = (yz - wx)*2;
+    op[2][2] = zz*2 + s;
+    vtkMatrix4x4::Multiply4x4(*pre, *op, *pre);
+    concatenated = true;
+  }
+  if (scale && (scale[0] != 1.0 || scale[1] != 1.0 || scale[2] != 1.0))
+  {
+    vtkMatrix4x4::Identity(*op);
+    op[0][0] = scale[0];
+    op[1][1] = scale[1];
+    op[2][2] = scale[2];
+    vtkMatrix4x4::Multiply4x4(*pre, *op, *pre);
+    concatenated = true;
+  }
+  vtkMatrix4x4::Identity(*matrix);
+  if (concatenated)
+  {
+    vtkMatrix4x4::Multiply4x4(*matrix, *pre, *matrix);
+  }
+}
+
+// Second pass: write the glyphs of each block of points at the offsets of
+// the block. The output arrays which are not generated are NULL.
+struct GlyphOp
+{
+  const GlyphEvaluator *Evaluator;
+  vtkIdType NumberOfPoints;
+  bool Instances;
+  const int *Glyphs;
+  const GlyphBlock *Blocks;
+  int Orient;
+  int Scaling;
+  int ScaleMode;
+  double ScaleFactor;
+  const double *SourceMatrix;
+  int ScalarsMode;
+
+  float *Points;
+  float *Normals;
+  float *TCoords;
+  int NumberOfTCoordComponents;
+  float *Vectors;
+  float *Scalars;
+  vtkIdType *PointIds;
+  vtkIdType *SrcPointIds;
+  vtkIdType *SrcCellIds;
+  vtkIdType *Connectivity[4];
+  double *Transforms;
+  int *SourceIndices;
+
+  void operator()(vtkIdType block, vtkIdType endBlock)
+  {
+    const std::vector<GlyphSource> &sources = *this->Evaluator->Sources;
+    double s, x[3], v[3], vMag, scale[3], axis[3], matrix[4][4];
+    double normalMatrix[4][4];
+    for ( ; block < endBlock; ++block)
+    {
+      GlyphBlock offsets = this->Blocks[block];
+      vtkIdType ptId = block * GLYPH_BLOCK_SIZE;
+      vtkIdType endPtId =
+        std::min(ptId + GLYPH_BLOCK_SIZE, this->NumberOfPoints);
+      for ( ; ptId < endPtId; ++ptId)
+      {
+        int glyph = this->Glyphs[ptId];
+        if (glyph < 0)
+        {
+          continue;
+        }
+        const GlyphSource &source = sources[glyph];
+        this->Evaluator->Evaluate(ptId, s, v, vMag, scale);
+        float scalar = static_cast<float>(
+          this->ScalarsMode == GLYPH_SCALARS_SCALE ? scale[0] : vMag);
+        this->Evaluator->Input->GetPoint(ptId, x);
+
+        bool rotate = false;
+        if (this->Evaluator->Vectors && this->Orient && vMag > 0.0)
+        {
+          if (v[1] == 0.0 && v[2] == 0.0)
+          {
+            if (v[0] < 0) // just flip x if we need to
+            {
+              axis[0] = axis[2] = 0.0;
+              axis[1] = 1.0;
+              rotate = true;
+            }
+          }
+          else
+          {
+            axis[0] = (v[0] + vMag) / 2.0;
+            axis[1] = v[1] / 2.0;
+            axis[2] = v[2] / 2.0;
+            rotate = true;
+          }
+        }
+
+        if (this->Scaling)
+        {
+          for (int i = 0; i < 3; ++i)
+          {
+            if (this->ScaleMode == VTK_DATA_SCALING_OFF)
+            {
+              scale[i] = this->ScaleFactor;
+            }
+            else
+            {
+              scale[i] *= this->ScaleFactor;
+            }
+            if (scale[i] == 0.0)
+            {
+              scale[i] = 1.0e-10;
+            }
+          }
+        }
+        GlyphMatrix(x, rotate ? axis : NULL, this->Scaling ? scale : NULL,
+                    matrix);
+
+        vtkIdType ptOffset = offsets.NumberOfPoints;
+        vtkIdType numGlyphPts;
+        vtkIdType numGlyphCells;
+        if (this->Instances)
+        {
+          numGlyphPts = numGlyphCells = 1;
+          float *p = this->Points + 3 * ptOffset;
+          p[0] = static_cast<float>(x[0]);
+          p[1] = static_cast<float>(x[1]);
+          p[2] = static_cast<float>(x[2]);
+          double *transform = this->Transforms + 16 * ptOffset;
+          if (this->SourceMatrix)
+          {
+            vtkMatrix4x4::Multiply4x4(*matrix, this->SourceMatrix, transform);
+          }
+          else
+          {
+            vtkMatrix4x4::DeepCopy(transform, *matrix);
+          }
+          if (this->SourceIndices)
+          {
+            this->SourceIndices[ptOffset] = glyph;
+          }
+          vtkIdType *conn =
+            this->Connectivity[0] + offsets.ConnectivitySize[0];
+          conn[0] = 1;
+          conn[1] = ptOffset;
+          offsets.ConnectivitySize[0] += 2;
+        }
+        else
+        {
+          numGlyphPts = source.NumberOfPoints;
+          numGlyphCells = source.NumberOfCells;
+
+          // Same operations as vtkLinearTransform::TransformPoints().
+          const double *in = numGlyphPts ? &source.Points[0] : NULL;
+          float *out = this->Points + 3 * ptOffset;
+          for (vtkIdType i = 0; i < numGlyphPts; ++i, in += 3, out += 3)
+          {
+            out[0] = static_cast<float>(matrix[0][0]*in[0] +
+              matrix[0][1]*in[1] + matrix[0][2]*in[2] + matrix[0][3]);
+            out[1] = static_cast<float>(matrix[1][0]*in[0] +
+              matrix[1][1]*in[1] + matrix[1][2]*in[2] + matrix[1][3]);
+            out[2] = static_cast<float>(matrix[2][0]*in[0] +
+              matrix[2][1]*in[1] + matrix[2][2]*in[2] + matrix[2][3]);
+          }
+
+          // Same operations as vtkLinearTransform::TransformNormals().
+          if (this->Normals && !source.Normals.empty())
+          {
+            vtkMatrix4x4::DeepCopy(*normalMatrix, *matrix);
+            vtkMatrix4x4::Invert(*normalMatrix, *normalMatrix);
+            vtkMatrix4x4::Transpose(*normalMatrix, *normalMatrix);
+            in = &source.Normals[0];
+            out = this->Normals + 3 * ptOffset;
+            for (vtkIdType i = 0; i < numGlyphPts; ++i, in += 3, out += 3)
+            {
+              out[0] = static_cast<float>(normalMatrix[0][0]*in[0] +
+                normalMatrix[0][1]*in[1] + normalMatrix[0][2]*in[2]);
+              out[1] = static_cast<float>(normalMatrix[1][0]*in[0] +
+                normalMatrix[1][1]*in[1] + normalMatrix[1][2]*in[2]);
+              out[2] = static_cast<float>(normalMatrix[2][0]*in[0] +
+                normalMatrix[2][1]*in[1] + normalMatrix[2][2]*in[2]);
+              vtkMath::Normalize(out);
+            }
+          }
+
+          if (this->TCoords && !source.TCoords.empty())
+          {
+            vtkIdType n = this->NumberOfTCoordComponents * numGlyphPts;
+            out = this->TCoords + this->NumberOfTCoordComponents * ptOffset;
+            for (vtkIdType i = 0; i < n; ++i)
+            {
+              out[i] = static_cast<float>(source.TCoords[i]);
+            }
+          }
+
+          for (int k = 0; k < 4; ++k)
+          {
+            const vtkIdType *cellIn = source.Connectivity[k];
+            vtkIdType *cellOut =
+              this->Connectivity[k] + offsets.ConnectivitySize[k];
+            vtkIdType size = source.ConnectivitySize[k];
+            for (vtkIdType i = 0; i < size; )
+            {
+              vtkIdType npts = cellIn[i];
+              cellOut[i++] = npts;
+              for (vtkIdType j = 0; j < npts; ++j, ++i)
+              {
+                cellOut[i] = cellIn[i] + ptOffset;
+              }
+            }
+            offsets.ConnectivitySize[k] += size;
+          }
+        }
+
+        for (vtkIdType i = ptOffset; i < ptOffset + numGlyphPts; ++i)
+        {
+          if (this->Vectors)
+          {
+            this->Vectors[3 * i] = static_cast<float>(v[0]);
+            this->Vectors[3 * i + 1] = static_cast<float>(v[1]);
+            this->Vectors[3 * i + 2] = static_cast<float>(v[2]);
+          }
+          if (this->Scalars)
+          {
+            this->Scalars[i] = scalar;
+          }
+          if (this->PointIds)
+          {
+            this->PointIds[i] = ptId;
+          }
+          if (this->SrcPointIds)
+          {
+            this->SrcPointIds[i] = ptId;
+          }
+        }
+        if (this->SrcCellIds)
+        {
+          vtkIdType cellOffset = offsets.NumberOfCells;
+          for (vtkIdType i = 0; i < numGlyphCells; ++i)
+          {
+            this->SrcCellIds[cellOffset + i] = ptId;
+          }
+        }
+        offsets.NumberOfPoints += numGlyphPts;
+        offsets.NumberOfCells += numGlyphCells;
+      }
+    }
+  }
+};
+
+struct IdentityIdsOp
+{
+  vtkIdType *Ids;
+
+  void operator()(vtkIdType id, vtkIdType endId)
+  {
+    for ( ; id < endId; ++id )
+    {
+      this->Ids[id] = id;
+    }
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+// The points are processed in blocks. A first pass finds the glyph of each
+// point and counts the output of each block, the offsets of the blocks in
+// the output are computed with a prefix sum, then a second pass writes the
+// glyphs directly into the output arrays. The output does not depend on the
+// number of threads.
+bool vtkGlyph3D::ExecuteSMP(
+  vtkDataSet* input,
+  vtkInformationVector* sourceVector,
+  vtkPolyData* output,
+  vtkDataArray *inSScalars,
+  vtkDataArray *inVectors)
+{
+  vtkDebugMacro(<<"Generating glyphs in parallel");
+
+  vtkPointData *pd = input->GetPointData();
+  vtkPointData *outputPD = output->GetPointData();
+  vtkCellData *outputCD = output->GetCellData();
+  vtkDataArray *inNormals = this->GetInputArrayToProcess(2, input);
+  vtkDataArray *inCScalars = this->GetInputArrayToProcess(3, input);
+  if (inCScalars == NULL)
+  {
+    inCScalars = inSScalars;
+  }
+
+  unsigned char *inGhostLevels = NULL;
+  vtkDataArray *temp =
+    pd ? pd->GetArray(vtkDataSetAttributes::GhostArrayName()) : NULL;
+  if (temp && temp->GetDataType() == VTK_UNSIGNED_CHAR &&
+      temp->GetNumberOfComponents() == 1)
+  {
+    inGhostLevels = static_cast<vtkUnsignedCharArray *>(temp)->GetPointer(0);
+  }
+
+  vtkIdType numPts = input->GetNumberOfPoints();
+  if (numPts < 1)
+  {
+    vtkDebugMacro(<<"No points to glyph!");
+    return true;
+  }
+
+  // Check input for consistency
+  //
+  double den = this->Range[1] - this->Range[0];
+  if (den == 0.0)
+  {
+    den = 1.0;
+  }
+  vtkDataArray *array3D = NULL;
+  if (this->VectorMode == VTK_USE_VECTOR)
+  {
+    array3D = inVectors;
+  }
+  else if (this->VectorMode == VTK_USE_NORMAL)
+  {
+    array3D = inNormals;
+  }
+  if (array3D && array3D->GetNumberOfComponents() > 3)
+  {
+    vtkErrorMacro(<<"vtkDataArray "<<array3D->GetName()<<" has more than 3 components.\n");
+    return false;
+  }
+
+  int numberOfSources = this->GetNumberOfInputConnections(1);
+  if ( (this->IndexMode == VTK_INDEXING_BY_SCALAR && !inSScalars) ||
+       (this->IndexMode == VTK_INDEXING_BY_VECTOR &&
+       ((!inVectors && this->VectorMode == VTK_USE_VECTOR) ||
+        (!inNormals && this->VectorMode == VTK_USE_NORMAL))) )
+  {
+    if ( !this->GetSource(0, sourceVector) )
+    {
+      vtkErrorMacro(<<"Indexing on but don't have data to index with");
+      return true;
+    }
+    else
+    {
+      vtkWarningMacro(<<"Turning indexing off: no data to index with");
+      this->IndexMode = VTK_INDEXING_OFF;
+    }
+  }
+
+  // Extract the sources. Without indexing, the point data is copied to the
+  // glyphs, and a line is used if there is no source.
+  bool indexing = (this->IndexMode != VTK_INDEXING_OFF);
+  bool instances = (this->GenerateInstances != 0);
+  bool haveNormals = !instances;
+  bool haveTCoords = !instances && !indexing;
+  std::vector<GlyphSource> sources(indexing ? numberOfSources : 1);
+  vtkSmartPointer<vtkPolyData> defaultSource;
+  if (indexing)
+  {
+    for (int i = 0; i < numberOfSources; ++i)
+    {
+      vtkPolyData *source = this->GetSource(i, sourceVector);
+      sources[i].Initialize(source, this->SourceTransform);
+      if (source && !source->GetPointData()->GetNormals())
+      {
+        haveNormals = false;
+      }
+    }
+  }
+  else
+  {
+    vtkPolyData *source = this->GetSource(0, sourceVector);
+    if (!source)
+    {
+      vtkNew<vtkPoints> defaultPoints;
+      defaultPoints->InsertNextPoint(0, 0, 0);
+      defaultPoints->InsertNextPoint(1, 0, 0);
+      vtkIdType defaultPointIds[2] = {0, 1};
+      defaultSource = vtkSmartPointer<vtkPolyData>::New();
+      defaultSource->SetPoints(defaultPoints.Get());
+      defaultSource->Allocate();
+      defaultSource->InsertNextCell(VTK_LINE, 2, defaultPointIds);
+      source = defaultSource;
+    }
+    sources[0].Initialize(source, this->SourceTransform);
+    haveNormals = haveNormals && source->GetPointData()->GetNormals() != NULL;
+    haveTCoords = haveTCoords && source->GetPointData()->GetTCoords() != NULL;
+  }
+
+  GlyphEvaluator evaluator;
+  evaluator.Self = this;
+  evaluator.Input = input;
+  evaluator.InputUG = vtkUniformGrid::SafeDownCast(input);
+  evaluator.GhostLevels = inGhostLevels;
+  evaluator.Scalars = inSScalars;
+  evaluator.Vectors = array3D;
+  evaluator.ScaleMode = this->ScaleMode;
+  evaluator.IndexMode = this->IndexMode;
+  evaluator.Clamping = this->Clamping;
+  evaluator.Range[0] = this->Range[0];
+  evaluator.Range[1] = this->Range[1];
+  evaluator.Den = den;
+  evaluator.Sources = &sources;
+
+  // Find the glyphed points and size the output.
+  vtkIdType numBlocks = (numPts + GLYPH_BLOCK_SIZE - 1) / GLYPH_BLOCK_SIZE;
+  std::vector<int> glyphs(numPts);
+  std::vector<GlyphBlock> blocks(numBlocks);
+  GlyphCountOp count = {&evaluator, numPts, instances, &glyphs[0],
+                        &blocks[0]};
+  vtkSMPTools::For(0, numBlocks, count);
+
+  this->UpdateProgress(0.5);
+  if (this->GetAbortExecute())
+  {
+    return true;
+  }
+
+  GlyphBlock totals = GlyphBlock();
+  for (vtkIdType block = 0; block < numBlocks; ++block)
+  {
+    GlyphBlock counts = blocks[block];
+    blocks[block] = totals;
+    totals.Add(counts);
+  }
+  vtkIdType numNewPts = totals.NumberOfPoints;
+  vtkIdType numNewCells = totals.NumberOfCells;
+
+  // Allocate the output.
+  GlyphOp write = GlyphOp();
+  write.Evaluator = &evaluator;
+  write.NumberOfPoints = numPts;
+  write.Instances = instances;
+  write.Glyphs = &glyphs[0];
+  write.Blocks = &blocks[0];
+  write.Orient = this->Orient;
+  write.Scaling = this->Scaling;
+  write.ScaleMode = this->ScaleMode;
+  write.ScaleFactor = this->ScaleFactor;
+
+  vtkPoints *newPts = vtkPoints::New();
+  newPts->SetNumberOfPoints(numNewPts);
+  write.Points = static_cast<vtkFloatArray *>(newPts->GetData())->GetPointer(0);
+
+  vtkCellArray *newCells[4] = {NULL, NULL, NULL, NULL};
+  for (int k = 0; k < 4; ++k)
+  {
+    if (totals.NumberOfCellsOfKind[k] > 0)
+    {
+      newCells[k] = vtkCellArray::New();
+      write.Connectivity[k] = newCells[k]->WritePointer(
+        totals.NumberOfCellsOfKind[k], totals.ConnectivitySize[k]);
+    }
+  }
+
+  outputPD->CopyVectorsOff();
+  outputPD->CopyNormalsOff();
+  outputPD->CopyTCoordsOff();
+  vtkIdList *srcPtIds = NULL;
+  vtkIdList *srcCellIds = NULL;
+  if (!indexing)
+  {
+    outputPD->CopyAllocate(pd, numNewPts);
+    if (this->FillCellData)
+    {
+      outputCD->CopyAllocate(pd, numNewCells);
+      srcCellIds = vtkIdList::New();
+      srcCellIds->SetNumberOfIds(numNewCells);
+      write.SrcCellIds = srcCellIds->GetPointer(0);
+    }
+  }
+
+  if ( this->GeneratePointIds )
+  {
+    vtkIdTypeArray *pointIds = vtkIdTypeArray::New();
+    pointIds->SetName(this->PointIdsName);
+    pointIds->SetNumberOfTuples(numNewPts);
+    outputPD->AddArray(pointIds);
+    pointIds->Delete();
+    write.PointIds = pointIds->GetPointer(0);
+  }
+
+  vtkDataArray *newScalars = NULL;
+  bool copyScalars = false;
+  if ( this->ColorMode == VTK_COLOR_BY_SCALAR && inCScalars )
+  {
+    newScalars = inCScalars->NewInstance();
+    newScalars->SetNumberOfComponents(inCScalars->GetNumberOfComponents());
+    newScalars->SetName(inCScalars->GetName());
+    copyScalars = true;
+  }
+  else if ( (this->ColorMode == VTK_COLOR_BY_SCALE) && inSScalars)
+  {
+    vtkFloatArray *scalars = vtkFloatArray::New();
+    scalars->SetNumberOfTuples(numNewPts);
+    scalars->SetName("GlyphScale");
+    if (this->ScaleMode == VTK_SCALE_BY_SCALAR)
+    {
+      scalars->SetName(inSScalars->GetName());
+    }
+    write.Scalars = scalars->GetPointer(0);
+    write.ScalarsMode = GLYPH_SCALARS_SCALE;
+    newScalars = scalars;
+  }
+  else if ( (this->ColorMode == VTK_COLOR_BY_VECTOR) && array3D)
+  {
+    vtkFloatArray *scalars = vtkFloatArray::New();
+    scalars->SetNumberOfTuples(numNewPts);
+    scalars->SetName("VectorMagnitude");
+    write.Scalars = scalars->GetPointer(0);
+    write.ScalarsMode = GLYPH_SCALARS_VECTOR_MAGNITUDE;
+    newScalars = scalars;
+  }
+  if (!indexing || copyScalars)
+  {
+    srcPtIds = vtkIdList::New();
+    srcPtIds->SetNumberOfIds(numNewPts);
+    write.SrcPointIds = srcPtIds->GetPointer(0);
+  }
+
+  vtkFloatArray *newVectors = NULL;
+  if ( array3D )
+  {
+    newVectors = vtkFloatArray::New();
+    newVectors->SetNumberOfComponents(3);
+    newVectors->SetNumberOfTuples(numNewPts);
+    newVectors->SetName("GlyphVector");
+    write.Vectors = newVectors->GetPointer(0);
+  }
+  vtkFloatArray *newNormals = NULL;
+  if ( haveNormals )
+  {
+    newNormals = vtkFloatArray::New();
+    newNormals->SetNumberOfComponents(3);
+    newNormals->SetNumberOfTuples(numNewPts);
+    newNormals->SetName("Normals");
+    write.Normals = newNormals->GetPointer(0);
+  }
+  vtkFloatArray *newTCoords = NULL;
+  if ( haveTCoords )
+  {
+    newTCoords = vtkFloatArray::New();
+    newTCoords->SetNumberOfComponents(sources[0].NumberOfTCoordComponents);
+    newTCoords->SetNumberOfTuples(numNewPts);
+    newTCoords->SetName("TCoords");
+    write.TCoords = newTCoords->GetPointer(0);
+    write.NumberOfTCoordComponents = sources[0].NumberOfTCoordComponents;
+  }
+
+  vtkDoubleArray *transforms = NULL;
+  vtkIntArray *sourceIndices = NULL;
+  double sourceMatrix[16];
+  if ( instances )
+  {
+    transforms = vtkDoubleArray::New();
+    transforms->SetNumberOfComponents(16);
+    transforms->SetNumberOfTuples(numNewPts);
+    transforms->SetName("GlyphTransform");
+    write.Transforms = transforms->GetPointer(0);
+    if ( indexing )
+    {
+      sourceIndices = vtkIntArray::New();
+      sourceIndices->SetNumberOfTuples(numNewPts);
+      sourceIndices->SetName("GlyphSourceIndex");
+      write.SourceIndices = sourceIndices->GetPointer(0);
+    }
+    if ( this->SourceTransform )
+    {
+      vtkMatrix4x4::DeepCopy(sourceMatrix, this->SourceTransform->GetMatrix());
+      write.SourceMatrix = sourceMatrix;
+    }
+  }
+
+  // Generate the glyphs.
+  vtkSMPTools::For(0, numBlocks, write);
+
+  // Copy the point data of the glyphed points.
+  vtkIdList *dstIds = vtkIdList::New();
+  dstIds->SetNumberOfIds(std::max(numNewPts, numNewCells));
+  IdentityIdsOp identity = { dstIds->GetPointer(0) };
+  vtkSMPTools::For(0, dstIds->GetNumberOfIds(), identity);
+  if (srcPtIds)
+  {
+    dstIds->SetNumberOfIds(numNewPts);
+    if (!indexing)
+    {
+      outputPD->CopyData(pd, srcPtIds, dstIds);
+    }
+    if (copyScalars)
+    {
+      newScalars->InsertTuples(dstIds, srcPtIds, inCScalars);
+    }
+    srcPtIds->Delete();
+  }
+  if (srcCellIds)
+  {
+    dstIds->SetNumberOfIds(numNewCells);
+    outputCD->CopyData(pd, srcCellIds, dstIds);
+    srcCellIds->Delete();
+  }
+  dstIds->Delete();
+
+  // Update ourselves and release memory
+  //
+  output->SetPoints(newPts);
+  newPts->Delete();
+
+  if (newCells[0])
+  {
+    output->SetVerts(newCells[0]);
+  }
+  if (newCells[1])
+  {
+    output->SetLines(newCells[1]);
+  }
+  if (newCells[2])
+  {
+    output->SetPolys(newCells[2]);
+  }
+  if (newCells[3])
+  {
+    output->SetStrips(newCells[3]);
+  }
+  for (int k = 0; k < 4; ++k)
+  {
+    if (newCells[k])
+    {
+      newCells[k]->Delete();
+    }
+  }
+
+  if (newScalars)
+  {
+    int idx = outputPD->AddArray(newScalars);
+    outputPD->SetActiveAttribute(idx, vtkDataSetAttributes::SCALARS);
+    newScalars->Delete();
+  }
+
+  if (newVectors)
+  {
+    outputPD->SetVectors(newVectors);
+    newVectors->Delete();
+  }
+
+  if (newNormals)
+  {
+    outputPD->SetNormals(newNormals);
+    newNormals->Delete();
+  }
+
+  if (newTCoords)
+  {
+    outputPD->SetTCoords(newTCoords);
+    newTCoords->Delete();
+  }
+
+  if (transforms)
+  {
+    outputPD->AddArray(transforms);
+    transforms->Delete();
+  }
+
+  if (sourceIndices)
+  {
+    outputPD->AddArray(sourceIndices);
+    sourceIndices->Delete();
+  }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 // Specify a source object at a specified table location.
 void vtkGlyph3D::SetSourceConnection(int id, vtkAlgorithmOutput* algOutput)
@@ -879,6 +1869,9 @@ void vtkGlyph3D::PrintSelf(ostream& os, vtkIndent indent)
   }
 
   os << indent << "Fill Cell Data: " << (this->FillCellData ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "Generate Instances: "
+     << (this->GenerateInstances ? "On\n" : "Off\n");
 
   os << indent << "SourceTransform: ";
   if (this->SourceTransform)
@@ -73,6 +73,26 @@
  * vtkAlgorithm. The first array is scalars, the next vectors, the next
  * normals and finally color scalars.
  *
+ * @warning
+ * When EnableSMP is on, the glyphs are generated in parallel with
+ * vtkSMPTools: the glyphed points are counted first, the output is sized
+ * with prefix sums, then the source points and normals are transformed by
+ * the matrix of each glyph directly into the output arrays. The output is
+ * the same as with the serial algorithm. IsPointVisible() is then called
+ * from several threads, so subclasses overriding it must make it thread
+ * safe.
+ *
+ * @warning
+ * When GenerateInstances is on, the source geometry is not copied at all.
+ * The output has one point and one vertex per glyph, located at the input
+ * point, with the point data that the points of the glyph would receive,
+ * and a 16 component "GlyphTransform" array holding the matrix (row major,
+ * as in vtkMatrix4x4) which maps the source, SourceTransform included,
+ * onto the glyph. When indexing is on, a "GlyphSourceIndex" array gives the
+ * index of the source of each glyph in the table. The sources themselves
+ * are shared through the source inputs. This output is also generated in
+ * parallel, whatever the value of EnableSMP.
+ *
  * @sa
  * vtkTensorGlyph
 */
@@ -303,6 +323,29 @@ public:
   vtkGetObjectMacro(SourceTransform, vtkTransform);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the generation of the glyphs in parallel. The output is
+   * the same as with the serial algorithm, but IsPointVisible() must be
+   * thread safe. Off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
+  //@{
+  /**
+   * Enable/disable the generation of one instance (a point with the glyph
+   * matrix and attributes) per glyph instead of copies of the source
+   * geometry. See the class documentation for the layout of the output.
+   * Off by default.
+   */
+  vtkSetMacro(GenerateInstances,int);
+  vtkGetMacro(GenerateInstances,int);
+  vtkBooleanMacro(GenerateInstances,int);
+  //@}
+
   /**
    * Overridden to include SourceTransform's MTime.
    */
@@ -334,6 +377,16 @@ protected:
                        vtkDataArray *inVectors);
   //@}
 
+  /**
+   * Threaded version of Execute(), used when EnableSMP or GenerateInstances
+   * is on.
+   */
+  bool ExecuteSMP(vtkDataSet* input,
+                  vtkInformationVector* sourceVector,
+                  vtkPolyData* output,
+                  vtkDataArray *inSScalars,
+                  vtkDataArray *inVectors);
+
   vtkPolyData **Source; // Geometry to copy to each point
   int Scaling; // Determine whether scaling of geometry is performed
   int ScaleMode; // Scale by scalar value or vector magnitude
@@ -348,6 +401,8 @@ protected:
   int FillCellData; // whether to fill output cell data
   char *PointIdsName;
   vtkTransform* SourceTransform;
+  int EnableSMP; // generate the glyphs in parallel
+  int GenerateInstances; // output instances instead of copies of the source
 
 private:
   vtkGlyph3D(const vtkGlyph3D&) VTK_DELETE_FUNCTION;
@@ -19,14 +19,22 @@
 #include <limits>
 #include <vector>
 
+#include "vtkArrayDispatch.h"
 #include "vtkCellData.h"
 #include "vtkDataArray.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkDataSet.h"
 #include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMath.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 
 #define VTK_EPSILON 1.e-6
 
@@ -159,6 +167,7 @@ vtkPointDataToCellData::vtkPointDataToCellData()
 {
   this->PassPointData = 0;
   this->CategoricalData = 0;
+  this->EnableSMP = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -232,53 +241,60 @@ int vtkPointDataToCellData::RequestData(
   output->GetCellData()->PassData(input->GetCellData());
   output->GetCellData()->CopyFieldOff(vtkDataSetAttributes::GhostArrayName());
 
-  // notice that inPD and outCD are vtkPointData and vtkCellData; respectively.
-  // It's weird, but it works.
-  outCD->InterpolateAllocate(inPD,numCells);
-
-  int abort=0;
-  vtkIdType progressInterval=numCells/20 + 1;
-  for (cellId=0; cellId < numCells && !abort; cellId++)
+  if (this->EnableSMP)
+  {
+    this->InterpolateCellDataSMP(input, output);
+  }
+  else
   {
-    if ( !(cellId % progressInterval) )
+    // notice that inPD and outCD are vtkPointData and vtkCellData; respectively.
+    // It's weird, but it works.
+    outCD->InterpolateAllocate(inPD,numCells);
+
+    int abort=0;
+    vtkIdType progressInterval=numCells/20 + 1;
+    for (cellId=0; cellId < numCells && !abort; cellId++)
     {
-      this->UpdateProgress((double)cellId/numCells);
-      abort = GetAbortExecute();
-    }
+      if ( !(cellId % progressInterval) )
+      {
+        this->UpdateProgress((double)cellId/numCells);
+        abort = GetAbortExecute();
+      }
 
-    input->GetCellPoints(cellId, cellPts);
-    numPts = cellPts->GetNumberOfIds();
+      input->GetCellPoints(cellId, cellPts);
+      numPts = cellPts->GetNumberOfIds();
 
-    if (numPts == 0)
-    {
-      continue;
-    }
+      if (numPts == 0)
+      {
+        continue;
+      }
 
-    // If we aren't dealing with categorical data...
-    if (!(this->CategoricalData))
-    {
-      // ...then we simply provide each point with an equal weight value and
-      // interpolate.
-      weight = 1.0 / numPts;
-      for (ptId=0; ptId < numPts; ptId++)
+      // If we aren't dealing with categorical data...
+      if (!(this->CategoricalData))
       {
-        weights[ptId] = weight;
+        // ...then we simply provide each point with an equal weight value and
+        // interpolate.
+        weight = 1.0 / numPts;
+        for (ptId=0; ptId < numPts; ptId++)
+        {
+          weights[ptId] = weight;
+        }
+        outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
       }
-      outCD->InterpolatePoint(inPD, cellId, cellPts, weights);
-    }
-    else
-    {
-      // ...otherwise, we populate a histogram from the scalar values at each
-      // point, and then select the bin with the most elements.
-      hist.Reset(numPts);
-      for (ptId=0; ptId < numPts; ptId++)
+      else
       {
-        pointId = cellPts->GetId(ptId);
-        hist.Fill(pointId,
-                  input->GetPointData()->GetScalars()->GetTuple1(pointId));
+        // ...otherwise, we populate a histogram from the scalar values at each
+        // point, and then select the bin with the most elements.
+        hist.Reset(numPts);
+        for (ptId=0; ptId < numPts; ptId++)
+        {
+          pointId = cellPts->GetId(ptId);
+          hist.Fill(pointId,
+                    input->GetPointData()->GetScalars()->GetTuple1(pointId));
+        }
+
+        outCD->CopyData(inPD, hist.IndexOfLargestBin(), cellId);
       }
-
-      outCD->CopyData(inPD, hist.IndexOfLargestBin(), cellId);
     }
   }
 
@@ -301,4 +317,260 @@ void vtkPointDataToCellData::PrintSelf(ostream& os, vtkIndent indent)
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Pass Point Data: " << (this->PassPointData ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+}
+
+//----------------------------------------------------------------------------
+// Threaded computation of the cell data. Each data array is handled by a
+// typed pair of arrays created with vtkArrayDispatch, and each cell gathers
+// the values of its points for all the arrays at once.
+namespace
+{
+  // Average a set of tuples of an input array into a tuple of the output
+  // array, or copy a single tuple.
+  struct Gatherer
+  {
+    virtual ~Gatherer() {}
+    virtual void Average(vtkIdType numIds, const vtkIdType *ids,
+                         vtkIdType outId) = 0;
+    virtual void Copy(vtkIdType inId, vtkIdType outId) = 0;
+    virtual void Null(vtkIdType outId) = 0;
+  };
+
+  template <typename InArrayT, typename OutArrayT>
+  struct TypedGatherer : public Gatherer
+  {
+    typedef typename vtkDataArrayAccessor<OutArrayT>::APIType ValueType;
+
+    InArrayT *Input;
+    OutArrayT *Output;
+    int NumComp;
+
+    TypedGatherer(InArrayT *in, OutArrayT *out) :
+      Input(in), Output(out), NumComp(in->GetNumberOfComponents())
+    {
+    }
+
+    // Same weights and summation order as vtkDataArray::InterpolateTuple().
+    void Average(vtkIdType numIds, const vtkIdType *ids,
+                 vtkIdType outId) VTK_OVERRIDE
+    {
+      vtkDataArrayAccessor<InArrayT> in(this->Input);
+      vtkDataArrayAccessor<OutArrayT> out(this->Output);
+      double weight = 1.0 / numIds;
+      for (int c = 0; c < this->NumComp; ++c)
+      {
+        double val = 0.0;
+        for (vtkIdType i = 0; i < numIds; ++i)
+        {
+          val += weight * static_cast<double>(in.Get(ids[i], c));
+        }
+        ValueType valT;
+        vtkMath::RoundDoubleToIntegralIfNecessary(val, &valT);
+        out.Set(outId, c, valT);
+      }
+    }
+
+    void Copy(vtkIdType inId, vtkIdType outId) VTK_OVERRIDE
+    {
+      vtkDataArrayAccessor<InArrayT> in(this->Input);
+      vtkDataArrayAccessor<OutArrayT> out(this->Output);
+      for (int c = 0; c < this->NumComp; ++c)
+      {
+        out.Set(outId, c, in.Get(inId, c));
+      }
+    }
+
+    void Null(vtkIdType outId) VTK_OVERRIDE
+    {
+      vtkDataArrayAccessor<OutArrayT> out(this->Output);
+      for (int c = 0; c < this->NumComp; ++c)
+      {
+        out.Set(outId, c, static_cast<ValueType>(0));
+      }
+    }
+  };
+
+  // Fallback for the arrays that cannot be dispatched (e.g., bit arrays).
+  // It is not thread safe and is used serially.
+  struct GenericGatherer : public Gatherer
+  {
+    vtkDataArray *Input;
+    vtkDataArray *Output;
+    vtkNew<vtkIdList> Ids;
+    std::vector<double> Weights;
+
+    GenericGatherer(vtkDataArray *in, vtkDataArray *out) :
+      Input(in), Output(out)
+    {
+    }
+
+    void Average(vtkIdType numIds, const vtkIdType *ids,
+                 vtkIdType outId) VTK_OVERRIDE
+    {
+      this->Ids->SetNumberOfIds(numIds);
+      std::copy(ids, ids + numIds, this->Ids->GetPointer(0));
+      this->Weights.assign(numIds, 1.0 / numIds);
+      this->Output->InterpolateTuple(outId, this->Ids.Get(), this->Input,
+                                     &this->Weights[0]);
+    }
+
+    void Copy(vtkIdType inId, vtkIdType outId) VTK_OVERRIDE
+    {
+      this->Output->SetTuple(outId, inId, this->Input);
+    }
+
+    void Null(vtkIdType outId) VTK_OVERRIDE
+    {
+      for (int c = 0; c < this->Output->GetNumberOfComponents(); ++c)
+      {
+        this->Output->SetComponent(outId, c, 0.0);
+      }
+    }
+  };
+
+  struct MakeGatherer
+  {
+    std::vector<Gatherer*> &Gatherers;
+
+    MakeGatherer(std::vector<Gatherer*> &gatherers) : Gatherers(gatherers)
+    {
+    }
+
+    template <typename InArrayT, typename OutArrayT>
+    void operator()(InArrayT *in, OutArrayT *out)
+    {
+      this->Gatherers.push_back(
+        new TypedGatherer<InArrayT, OutArrayT>(in, out));
+    }
+  };
+
+  // Gather the points of each cell, and either average their values or,
+  // for categorical data, copy the values of the majority point.
+  struct GatherCellsOp
+  {
+    vtkDataSet *Input;
+    vtkDataArray *Categories;
+    std::vector<Gatherer*> *Gatherers;
+    vtkSMPThreadLocalObject<vtkIdList> CellPts;
+    vtkSMPThreadLocal<Histogram> Hist;
+
+    GatherCellsOp(vtkDataSet *input, vtkDataArray *categories,
+                  std::vector<Gatherer*> *gatherers) :
+      Input(input), Categories(categories), Gatherers(gatherers),
+      Hist(Histogram(input->GetMaxCellSize()))
+    {
+    }
+
+    void operator()(vtkIdType cellId, vtkIdType endCellId)
+    {
+      vtkIdList *cellPts = this->CellPts.Local();
+      Histogram &hist = this->Hist.Local();
+      std::vector<Gatherer*>::iterator begin = this->Gatherers->begin();
+      std::vector<Gatherer*>::iterator end = this->Gatherers->end();
+      for (; cellId < endCellId; ++cellId)
+      {
+        this->Input->GetCellPoints(cellId, cellPts);
+        vtkIdType numPts = cellPts->GetNumberOfIds();
+        std::vector<Gatherer*>::iterator it;
+        if (numPts == 0)
+        {
+          for (it = begin; it != end; ++it)
+          {
+            (*it)->Null(cellId);
+          }
+        }
+        else if (!this->Categories)
+        {
+          for (it = begin; it != end; ++it)
+          {
+            (*it)->Average(numPts, cellPts->GetPointer(0), cellId);
+          }
+        }
+        else
+        {
+          hist.Reset(numPts);
+          for (vtkIdType i = 0; i < numPts; ++i)
+          {
+            vtkIdType pointId = cellPts->GetId(i);
+            hist.Fill(pointId, this->Categories->GetComponent(pointId, 0));
+          }
+          vtkIdType pointId = hist.IndexOfLargestBin();
+          for (it = begin; it != end; ++it)
+          {
+            (*it)->Copy(pointId, cellId);
+          }
+        }
+      }
+    }
+  };
+}
+
+//----------------------------------------------------------------------------
+void vtkPointDataToCellData::InterpolateCellDataSMP(vtkDataSet *input,
+                                                    vtkDataSet *output)
+{
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkCellData *outCD = output->GetCellData();
+
+  // Copy all existing point fields into a temporary point data array, and
+  // remove all fields that are not a data array.
+  vtkSmartPointer<vtkPointData> clean = vtkSmartPointer<vtkPointData>::New();
+  clean->PassData(input->GetPointData());
+  for (vtkIdType fid = clean->GetNumberOfArrays(); fid--;)
+  {
+    if (!clean->GetAbstractArray(fid)->IsA("vtkDataArray"))
+    {
+      clean->RemoveArray(fid);
+    }
+  }
+
+  vtkDataSetAttributes::FieldList pfl(1);
+  pfl.InitializeFieldList(clean);
+  outCD->InterpolateAllocate(pfl, numCells, numCells);
+
+  std::vector<Gatherer*> gatherers;
+  std::vector<Gatherer*> serialGatherers;
+  MakeGatherer makeGatherer(gatherers);
+  for (int fid = 0, nfields = pfl.GetNumberOfFields(); fid < nfields; ++fid)
+  {
+    int dstId = pfl.GetFieldIndex(fid);
+    int srcId = pfl.GetDSAIndex(0, fid);
+    if (srcId < 0 || dstId < 0)
+    {
+      continue;
+    }
+    vtkDataArray *srcArray = clean->GetArray(srcId);
+    vtkDataArray *dstArray = outCD->GetArray(dstId);
+    dstArray->SetNumberOfTuples(numCells);
+    if (!vtkArrayDispatch::Dispatch2SameValueType::Execute(
+          srcArray, dstArray, makeGatherer))
+    {
+      serialGatherers.push_back(new GenericGatherer(srcArray, dstArray));
+    }
+  }
+
+  // A first serial request builds any lazily constructed structure the
+  // dataset needs to answer the threaded requests (e.g., polydata cells).
+  vtkNew<vtkIdList> cellPts;
+  input->GetCellPoints(0, cellPts.Get());
+
+  vtkDataArray *categories =
+    this->CategoricalData ? input->GetPointData()->GetScalars() : NULL;
+  GatherCellsOp gather(input, categories, &gatherers);
+  vtkSMPTools::For(0, numCells, gather);
+  if (!serialGatherers.empty())
+  {
+    gather.Gatherers = &serialGatherers;
+    gather(0, numCells);
+  }
+
+  for (size_t i = 0; i < gatherers.size(); ++i)
+  {
+    delete gatherers[i];
+  }
+  for (size_t i = 0; i < serialGatherers.size(); ++i)
+  {
+    delete serialGatherers[i];
+  }
 }
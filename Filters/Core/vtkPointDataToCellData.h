@@ -22,6 +22,11 @@
  * values of all points defining a particular cell. Optionally, the input point
  * data can be passed through to the output as well.
  *
+ * When EnableSMP is on, the cell data is computed in parallel (via
+ * vtkSMPTools): each cell gathers the values of its points for all the
+ * arrays at once. Only data arrays are processed in that case. The output
+ * is otherwise the same as the serial one.
+ *
  * @warning
  * This filter is an abstract filter, that is, the output is an abstract type
  * (i.e., vtkDataSet). Use the convenience methods (e.g.,
@@ -67,6 +72,16 @@ public:
   vtkBooleanMacro(CategoricalData,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded computation of the cell data (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkPointDataToCellData();
   ~vtkPointDataToCellData() VTK_OVERRIDE {}
@@ -75,8 +90,12 @@ protected:
                   vtkInformationVector** inputVector,
                   vtkInformationVector* outputVector) VTK_OVERRIDE;
 
+  // Threaded computation of the cell data, used when EnableSMP is on.
+  void InterpolateCellDataSMP(vtkDataSet *input, vtkDataSet *output);
+
   int PassPointData;
   int CategoricalData;
+  int EnableSMP;
 private:
   vtkPointDataToCellData(const vtkPointDataToCellData&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPointDataToCellData&) VTK_DELETE_FUNCTION;
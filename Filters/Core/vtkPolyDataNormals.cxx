@@ -24,13 +24,337 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
-#include "vtkTriangleStrip.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkStaticCellLinks.h"
+#include "vtkTriangleStrip.h"
 
 #include "vtkNew.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkPolyDataNormals);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Compute the normal of each polygon of the mesh.
+struct ComputePolyNormalsOp
+{
+  vtkPolyData *Mesh;
+  vtkPoints *Points;
+  float *Normals;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts, *pts;
+    double n[3];
+    float *normal = this->Normals + 3*cellId;
+    for ( ; cellId < endCellId; ++cellId, normal += 3)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      vtkPolygon::ComputeNormal(this->Points, npts, pts, n);
+      normal[0] = static_cast<float>(n[0]);
+      normal[1] = static_cast<float>(n[1]);
+      normal[2] = static_cast<float>(n[2]);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Move around the "cycle" of cells using the point ptId, and label each
+// subregion of cells which are connected (and not separated by a feature
+// edge) with a given region number: regions[j] is the region of cells[j].
+// Returns the number of regions. For each N regions created, N-1 duplicate
+// (split) points are created.
+int MarkRegions(vtkPolyData *mesh, const float *polyNormals, double cosAngle,
+                vtkIdType ptId, unsigned short ncells, const vtkIdType *cells,
+                std::vector<int> &regions, vtkIdList *cellIds)
+{
+  // Start by initializing the cells as unvisited
+  regions.assign(ncells, -1);
+
+  // Loop over all cells and mark the region that each is in.
+  vtkIdType numPts;
+  vtkIdType *pts;
+  int numRegions = 0;
+  vtkIdType spot, neiPt[2], nei, cellId, neiCellId = -1;
+  double thisNormal[3], neiNormal[3];
+  int j, neiIdx;
+  for (j=0; j<ncells; j++) //for all cells connected to point
+  {
+    // A cell using ptId several times is listed several times, the region is
+    // stored at its first occurrence.
+    int seedIdx = static_cast<int>(
+      std::find(cells, cells + j, cells[j]) - cells);
+    if ( regions[seedIdx] >= 0 )
+    {
+      continue;
+    }
+    regions[seedIdx] = numRegions;
+    //okay, mark all the cells connected to this seed cell and using ptId
+    mesh->GetCellPoints(cells[j],numPts,pts);
+
+    //find the two edges
+    for (spot=0; spot < numPts; spot++)
+    {
+      if ( pts[spot] == ptId )
+      {
+        break;
+      }
+    }
+
+    if ( spot == 0 )
+    {
+      neiPt[0] = pts[spot+1];
+      neiPt[1] = pts[numPts-1];
+    }
+    else if ( spot == (numPts-1) )
+    {
+      neiPt[0] = pts[spot-1];
+      neiPt[1] = pts[0];
+    }
+    else
+    {
+      neiPt[0] = pts[spot+1];
+      neiPt[1] = pts[spot-1];
+    }
+
+    for (int i=0; i<2; i++) //for each of the two edges of the seed cell
+    {
+      cellId = cells[j];
+      nei = neiPt[i];
+      while ( cellId >= 0 ) //while we can grow this region
+      {
+        mesh->GetCellEdgeNeighbors(cellId,ptId,nei,cellIds);
+        neiIdx = ncells;
+        if ( cellIds->GetNumberOfIds() == 1 )
+        {
+          neiCellId = cellIds->GetId(0);
+          neiIdx = static_cast<int>(
+            std::find(cells, cells + ncells, neiCellId) - cells);
+        }
+        if ( neiIdx >= ncells || regions[neiIdx] >= 0 )
+        {
+          cellId = -1;//separated by previous visit, boundary, or non-manifold
+          continue;
+        }
+
+        std::copy(polyNormals + 3*cellId, polyNormals + 3*cellId + 3,
+                  thisNormal);
+        std::copy(polyNormals + 3*neiCellId, polyNormals + 3*neiCellId + 3,
+                  neiNormal);
+        if ( vtkMath::Dot(thisNormal,neiNormal) <= cosAngle )
+        {
+          cellId = -1; //separated by edge angle
+          continue;
+        }
+
+        //visit and arrange to visit next edge neighbor
+        regions[neiIdx] = numRegions;
+        cellId = neiCellId;
+        mesh->GetCellPoints(cellId,numPts,pts);
+
+        for (spot=0; spot < numPts; spot++)
+        {
+          if ( pts[spot] == ptId )
+          {
+            break;
+          }
+        }
+
+        if (spot == 0)
+        {
+          nei = (pts[spot+1] != nei ? pts[spot+1] : pts[numPts-1]);
+        }
+        else if (spot == (numPts-1))
+        {
+          nei = (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
+        }
+        else
+        {
+          nei = (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
+        }
+      }//while visit wave is propagating
+    }//for each of the two edges of the seed cell
+    numRegions++;
+  }
+
+  for (j=0; j<ncells; j++)
+  {
+    regions[j] = regions[std::find(cells, cells + j, cells[j]) - cells];
+  }
+  return numRegions;
+}
+
+//----------------------------------------------------------------------------
+// Count the number of points created by splitting each point along the
+// feature edges. The region of each use of a split point by a cell is
+// stored in Regions, which has the layout of the connectivity array of the
+// mesh (only the first use is stored when a cell uses a point several
+// times). Each use belongs to a single point so there is no write conflict.
+struct MarkSplitPointsOp
+{
+  vtkPolyData *Mesh;
+  const vtkIdType *Connectivity;
+  const float *PolyNormals;
+  double CosAngle;
+  vtkIdType *NumSplits;
+  unsigned short *Regions;
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+  vtkSMPThreadLocal<std::vector<int> > CellRegions;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    vtkIdList *cellIds = this->CellIds.Local();
+    std::vector<int> &regions = this->CellRegions.Local();
+    unsigned short ncells;
+    vtkIdType *cells, npts, *pts;
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      this->NumSplits[ptId] = 0;
+      this->Mesh->GetPointCells(ptId, ncells, cells);
+      if ( ncells <= 1 )
+      {
+        continue; //point does not need to be further disconnected
+      }
+      int numRegions = MarkRegions(this->Mesh, this->PolyNormals,
+        this->CosAngle, ptId, ncells, cells, regions, cellIds);
+      if ( numRegions <= 1 )
+      {
+        continue; //a single region, no splitting ever required
+      }
+      this->NumSplits[ptId] = numRegions - 1;
+      for (int j=0; j < ncells; j++)
+      {
+        this->Mesh->GetCellPoints(cells[j], npts, pts);
+        vtkIdType spot = std::find(pts, pts + npts, ptId) - pts;
+        this->Regions[pts - this->Connectivity + spot] =
+          static_cast<unsigned short>(regions[j]);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Split the points: in all cells not in the first region around a point,
+// the point is replaced with a new point, which is a duplicate of the
+// point but disconnected topologically. The new points of a point are
+// numbered consecutively, starting at Offsets[ptId]. Each cell only
+// modifies its own connectivity in the new mesh, which may have been
+// reordered for consistency, and looks up the regions in the original
+// mesh.
+struct SplitCellsOp
+{
+  vtkPolyData *Mesh;
+  vtkPolyData *NewMesh;
+  const vtkIdType *Connectivity;
+  const unsigned short *Regions;
+  const vtkIdType *Offsets;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType npts, *pts, *newPts;
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      this->NewMesh->GetCellPoints(cellId, npts, newPts);
+      const unsigned short *regions =
+        this->Regions + (pts - this->Connectivity);
+      for (vtkIdType i=0; i < npts; i++)
+      {
+        vtkIdType ptId = newPts[i];
+        vtkIdType spot = std::find(pts, pts + npts, ptId) - pts;
+        if ( regions[spot] > 0 ) //replace point if splitting needed
+        {
+          newPts[i] = this->Offsets[ptId] + regions[spot] - 1;
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Gather the normals of the polygons using each point, and normalize them.
+// The polygon normals are summed in increasing cell id order so that the
+// result does not depend on the number of threads. When no point has been
+// split, the links of the input mesh are used. Otherwise the links of the
+// split mesh are built; they are stored in decreasing cell id order.
+struct ComputePointNormalsOp
+{
+  vtkPolyData *Mesh;
+  vtkStaticCellLinks *Links;
+  const float *PolyNormals;
+  float *Normals;
+  double FlipDirection;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    float *n = this->Normals + 3*ptId;
+    unsigned short ncells;
+    vtkIdType *cells;
+    for ( ; ptId < endPtId; ++ptId, n += 3)
+    {
+      n[0] = n[1] = n[2] = 0.0f;
+      if ( this->Links )
+      {
+        const vtkIdType *links = this->Links->GetCells(ptId);
+        for (vtkIdType i = this->Links->GetNumberOfCells(ptId)-1; i >= 0; --i)
+        {
+          this->Add(n, links[i]);
+        }
+      }
+      else
+      {
+        this->Mesh->GetPointCells(ptId, ncells, cells);
+        for (unsigned short i = 0; i < ncells; ++i)
+        {
+          this->Add(n, cells[i]);
+        }
+      }
+
+      const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]) *
+        this->FlipDirection;
+      if (length != 0.0)
+      {
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+      }
+    }
+  }
+
+  void Add(float *n, vtkIdType cellId)
+  {
+    const float *polyNormal = this->PolyNormals + 3*cellId;
+    n[0] += polyNormal[0];
+    n[1] += polyNormal[1];
+    n[2] += polyNormal[2];
+  }
+};
+
+//----------------------------------------------------------------------------
+// Run the functor over [0, n) with vtkSMPTools, or in the calling thread
+// when the filter is not threaded.
+template <typename Functor>
+void NormalsFor(bool parallel, vtkIdType n, Functor &functor)
+{
+  if ( parallel )
+  {
+    vtkSMPTools::For(0, n, functor);
+  }
+  else if ( n > 0 )
+  {
+    functor(0, n);
+  }
+}
+
+} // end anon namespace
+
 // Construct with feature angle=30, splitting and consistency turned on,
 // flipNormals turned off, and non-manifold traversal turned on.
 vtkPolyDataNormals::vtkPolyDataNormals()
@@ -46,10 +370,10 @@ vtkPolyDataNormals::vtkPolyDataNormals()
   // some internal data
   this->NumFlips = 0;
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
+  this->EnableSMP = 0;
   this->Wave = 0;
   this->Wave2 = 0;
   this->CellIds = 0;
-  this->Map = 0;
   this->OldMesh = 0;
   this->NewMesh = 0;
   this->Visited = 0;
@@ -190,7 +514,7 @@ int vtkPolyDataNormals::RequestData(
 
   // The visited array keeps track of which polygons have been visited.
   //
-  if ( this->Consistency || this->Splitting || this->AutoOrientNormals )
+  if ( this->Consistency || this->AutoOrientNormals )
   {
     this->Visited = new int[numPolys];
     memset(this->Visited, VTK_CELL_NOT_VISITED, numPolys*sizeof(int));
@@ -342,51 +666,72 @@ int vtkPolyDataNormals::RequestData(
   //
   this->PolyNormals = vtkFloatArray::New();
   this->PolyNormals->SetNumberOfComponents(3);
-  this->PolyNormals->Allocate(3*numPolys);
   this->PolyNormals->SetName("Normals");
   this->PolyNormals->SetNumberOfTuples(numPolys);
-
-  for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts,pts);
-       cellId++ )
-  {
-    if ((cellId % 1000) == 0)
-    {
-      this->UpdateProgress (0.333 + 0.333 * (double) cellId / (double) numPolys);
-      if (this->GetAbortExecute())
-      {
-        break;
-      }
-    }
-    vtkPolygon::ComputeNormal(inPts, npts, pts, n);
-    this->PolyNormals->SetTuple(cellId,n);
-  }
+  float *fPolyNormals = this->PolyNormals->GetPointer(0);
+
+  ComputePolyNormalsOp polyNormals;
+  polyNormals.Mesh = this->NewMesh;
+  polyNormals.Points = inPts;
+  polyNormals.Normals = fPolyNormals;
+  // The points are read concurrently when threaded, which some mapped
+  // arrays do not support, hence the EnableSMP flag.
+  bool parallel = this->EnableSMP != 0;
+  NormalsFor(parallel, numPolys, polyNormals);
+  this->UpdateProgress(0.5);
 
   // Split mesh if sharp features
   if ( this->Splitting )
   {
     //  Traverse all nodes; evaluate loops and feature edges.  If feature
     //  edges found, split mesh creating new nodes.  Update polygon
-    // connectivity.
+    //  connectivity. This is done in two passes: the number of new points
+    //  of each point is counted first, which gives with a prefix sum the
+    //  ids of the new points, and the points are then split.
     //
-      this->CosAngle = cos( vtkMath::RadiansFromDegrees( this->FeatureAngle) );
-    //  Splitting will create new points.  We have to create index array
-    // to map new points into old points.
-    //
-    this->Map = vtkIdList::New();
-    this->Map->SetNumberOfIds(numPts);
-    for (vtkIdType i=0; i < numPts; i++)
+    this->CosAngle = cos( vtkMath::RadiansFromDegrees( this->FeatureAngle) );
+    std::vector<vtkIdType> offsets(numPts+1);
+    std::vector<unsigned short> regions(polys->GetNumberOfConnectivityEntries());
+    vtkSMPTools::Fill(regions.begin(), regions.end(), 0);
+
+    MarkSplitPointsOp mark;
+    mark.Mesh = this->OldMesh;
+    mark.Connectivity = polys->GetPointer();
+    mark.PolyNormals = fPolyNormals;
+    mark.CosAngle = this->CosAngle;
+    mark.NumSplits = &offsets[0];
+    mark.Regions = &regions[0];
+    NormalsFor(parallel, numPts, mark);
+
+    numNewPts = vtkSMPTools::ExclusiveScan(offsets.begin(),
+      offsets.begin() + numPts, offsets.begin(), numPts);
+    offsets[numPts] = numNewPts;
+
+    vtkDebugMacro(<<"Created " << numNewPts-numPts << " new points");
+
+    if ( numNewPts > numPts )
     {
-      this->Map->SetId(i,i);
+      SplitCellsOp split;
+      split.Mesh = this->OldMesh;
+      split.NewMesh = this->NewMesh;
+      split.Connectivity = polys->GetPointer();
+      split.Regions = &regions[0];
+      split.Offsets = &offsets[0];
+      NormalsFor(parallel, numPolys, split);
     }
 
+    //  Splitting creates new points.  We have to create index array
+    //  to map new points into old points.
+    //
+    std::vector<vtkIdType> map(numNewPts);
     for (ptId=0; ptId < numPts; ptId++)
     {
-      this->MarkAndSplit(ptId);
-    }//for all input points
-
-    numNewPts = this->Map->GetNumberOfIds();
-
-    vtkDebugMacro(<<"Created " << numNewPts-numPts << " new points");
+      map[ptId] = ptId;
+      for (vtkIdType i=offsets[ptId]; i < offsets[ptId+1]; i++)
+      {
+        map[i] = ptId;
+      }
+    }
 
     //  Now need to map attributes of old points into new points.
     //
@@ -420,11 +765,10 @@ int vtkPolyDataNormals::RequestData(
     newPts->SetNumberOfPoints(numNewPts);
     for (ptId=0; ptId < numNewPts; ptId++)
     {
-      oldId = this->Map->GetId(ptId);
+      oldId = map[ptId];
       newPts->SetPoint(ptId,inPts->GetPoint(oldId));
       outPD->CopyData(pd,oldId,ptId);
     }
-    this->Map->Delete();
   } //splitting
 
   else //no splitting, so no new points
@@ -434,16 +778,17 @@ int vtkPolyDataNormals::RequestData(
     outPD->PassData(pd);
   }
 
-  if ( this->Consistency || this->Splitting )
+  if ( this->Visited )
   {
     delete [] this->Visited;
+    this->Visited = NULL;
     this->CellIds->Delete();
   }
 
   this->UpdateProgress(0.80);
 
-  //  Finally, traverse all elements, computing polygon normals and
-  //  accumulating them at the vertices.
+  //  Finally, traverse all points, gathering the normals of the polygons
+  //  using them.
   //
   if ( this->FlipNormals && ! this->Consistency )
   {
@@ -454,37 +799,25 @@ int vtkPolyDataNormals::RequestData(
   newNormals->SetNumberOfComponents(3);
   newNormals->SetNumberOfTuples(numNewPts);
   newNormals->SetName("Normals");
-  float *fNormals = newNormals->WritePointer(0, 3 * numNewPts);
-  std::fill_n(fNormals, 3 * numNewPts, 0);
-
-  float *fPolyNormals = this->PolyNormals->WritePointer(0, 3 * numPolys);
 
   if (this->ComputePointNormals)
   {
-    for (cellId=0, newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);
-         ++cellId)
+    vtkNew<vtkStaticCellLinks> links;
+    ComputePointNormalsOp pointNormals;
+    pointNormals.Mesh = this->OldMesh;
+    pointNormals.Links = NULL;
+    if ( numNewPts > numPts )
     {
-      for (vtkIdType i = 0; i < npts; ++i)
-      {
-        fNormals[3 * pts[i]] += fPolyNormals[3 * cellId];
-        fNormals[3 * pts[i] + 1] += fPolyNormals[3 * cellId + 1];
-        fNormals[3 * pts[i] + 2] += fPolyNormals[3 * cellId + 2];
-      }
-    }
-
-    for (vtkIdType i = 0; i < numNewPts; ++i)
-    {
-      const double length = sqrt(fNormals[3 * i] * fNormals[3 * i] +
-                                 fNormals[3 * i + 1] * fNormals[3 * i + 1] +
-                                 fNormals[3 * i + 2] * fNormals[3 * i + 2]
-                                 ) * flipDirection;
-      if (length != 0.0)
-      {
-        fNormals[3 * i] /= length;
-        fNormals[3 * i + 1] /= length;
-        fNormals[3 * i + 2] /= length;
-      }
+      vtkNew<vtkPolyData> mesh;
+      mesh->SetPoints(newPts);
+      mesh->SetPolys(newPolys);
+      links->BuildLinks(mesh.GetPointer());
+      pointNormals.Links = links.GetPointer();
     }
+    pointNormals.PolyNormals = fPolyNormals;
+    pointNormals.Normals = newNormals->GetPointer(0);
+    pointNormals.FlipDirection = flipDirection;
+    NormalsFor(parallel, numNewPts, pointNormals);
   }
 
   //  Update ourselves.  If no new nodes have been created (i.e., no
@@ -597,167 +930,6 @@ void vtkPolyDataNormals::TraverseAndOrder (void)
   return;
 }
 
-//
-//  Mark polygons around vertex.  Create new vertex (if necessary) and
-//  replace (i.e., split mesh).
-//
-void vtkPolyDataNormals::MarkAndSplit (vtkIdType ptId)
-{
-  int i,j;
-
-  // Get the cells using this point and make sure that we have to do something
-  unsigned short ncells;
-  vtkIdType *cells;
-  this->OldMesh->GetPointCells(ptId,ncells,cells);
-  if ( ncells <= 1 )
-  {
-    return; //point does not need to be further disconnected
-  }
-
-  // Start moving around the "cycle" of points using the point. Label
-  // each point as requiring a visit. Then label each subregion of cells
-  // connected to this point that are connected (and not separated by
-  // a feature edge) with a given region number. For each N regions
-  // created, N-1 duplicate (split) points are created. The split point
-  // replaces the current point ptId in the polygons connectivity array.
-  //
-  // Start by initializing the cells as unvisited
-  for (i=0; i<ncells; i++)
-  {
-    this->Visited[cells[i]] = -1;
-  }
-
-  // Loop over all cells and mark the region that each is in.
-  //
-  vtkIdType numPts;
-  vtkIdType *pts;
-  int numRegions = 0;
-  vtkIdType spot, neiPt[2], nei, cellId, neiCellId;
-  double thisNormal[3], neiNormal[3];
-  for (j=0; j<ncells; j++) //for all cells connected to point
-  {
-    if ( this->Visited[cells[j]] < 0 ) //for all unvisited cells
-    {
-      this->Visited[cells[j]] = numRegions;
-      //okay, mark all the cells connected to this seed cell and using ptId
-      this->OldMesh->GetCellPoints(cells[j],numPts,pts);
-
-      //find the two edges
-      for (spot=0; spot < numPts; spot++)
-      {
-        if ( pts[spot] == ptId )
-        {
-          break;
-        }
-      }
-
-      if ( spot == 0 )
-      {
-        neiPt[0] = pts[spot+1];
-        neiPt[1] = pts[numPts-1];
-      }
-      else if ( spot == (numPts-1) )
-      {
-        neiPt[0] = pts[spot-1];
-        neiPt[1] = pts[0];
-      }
-      else
-      {
-        neiPt[0] = pts[spot+1];
-        neiPt[1] = pts[spot-1];
-      }
-
-      for (i=0; i<2; i++) //for each of the two edges of the seed cell
-      {
-        cellId = cells[j];
-        nei = neiPt[i];
-        while ( cellId >= 0 ) //while we can grow this region
-        {
-          this->OldMesh->GetCellEdgeNeighbors(cellId,ptId,nei,this->CellIds);
-          if ( this->CellIds->GetNumberOfIds() == 1 &&
-               this->Visited[(neiCellId=this->CellIds->GetId(0))] < 0 )
-          {
-            this->PolyNormals->GetTuple(cellId, thisNormal);
-            this->PolyNormals->GetTuple(neiCellId, neiNormal);
-
-            if ( vtkMath::Dot(thisNormal,neiNormal) > CosAngle )
-            {
-              //visit and arrange to visit next edge neighbor
-              this->Visited[neiCellId] = numRegions;
-              cellId = neiCellId;
-              this->OldMesh->GetCellPoints(cellId,numPts,pts);
-
-              for (spot=0; spot < numPts; spot++)
-              {
-                if ( pts[spot] == ptId )
-                {
-                  break;
-                }
-              }
-
-              if (spot == 0)
-              {
-                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[numPts-1]);
-              }
-              else if (spot == (numPts-1))
-              {
-                nei = (pts[spot-1] != nei ? pts[spot-1] : pts[0]);
-              }
-              else
-              {
-                nei = (pts[spot+1] != nei ? pts[spot+1] : pts[spot-1]);
-              }
-
-            }//if not separated by edge angle
-            else
-            {
-              cellId = -1; //separated by edge angle
-            }
-          }//if can move to edge neighbor
-          else
-          {
-            cellId = -1;//separated by previous visit, boundary, or non-manifold
-          }
-        }//while visit wave is propagating
-      }//for each of the two edges of the starting cell
-      numRegions++;
-    }//if cell is unvisited
-  }//for all cells connected to point ptId
-
-  if ( numRegions <=1 )
-  {
-    return; //a single region, no splitting ever required
-  }
-
-  // Okay, for all cells not in the first region, the ptId is
-  // replaced with a new ptId, which is a duplicate of the first
-  // point, but disconnected topologically.
-  //
-  vtkIdType lastId = this->Map->GetNumberOfIds();
-  vtkIdType replacementPoint;
-  for (j=0; j<ncells; j++)
-  {
-    if (this->Visited[cells[j]] > 0 ) //replace point if splitting needed
-    {
-      replacementPoint = lastId + this->Visited[cells[j]] - 1;
-
-      this->Map->InsertId(replacementPoint, ptId);
-
-      this->NewMesh->GetCellPoints(cells[j],numPts,pts);
-      for (i=0; i < numPts; i++)
-      {
-        if ( pts[i] == ptId )
-        {
-          pts[i] = replacementPoint; // this is very nasty! direct write!
-          break;
-        }
-      }//replace ptId with split point
-    }//if not in first regions and requiring splitting
-  }//for all cells connected to ptId
-
-  return;
-}
-
 void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
@@ -776,5 +948,6 @@ void vtkPolyDataNormals::PrintSelf(ostream& os, vtkIndent indent)
      << (this->NonManifoldTraversal ? "On\n" : "Off\n");
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
@@ -39,6 +39,15 @@
  * are split and new points generated to prevent blurry edges (due to
  * Gouraud shading).
  *
+ * When EnableSMP is on, the polygon normals, the splitting of the sharp
+ * edges and the point normals are computed in parallel using vtkSMPTools.
+ * The point normals are gathered from the polygons using each point (instead
+ * of being scattered from each polygon to its points), so the output does
+ * not depend on the number of threads. The consistency and auto-orientation
+ * traversals are serial. Since several threads call GetPoint on the input
+ * at once, keep it off for points whose array caches the last tuple read,
+ * as vtkPeriodicDataArray does.
+ *
  * @warning
  * Normals are computed only for polygons and triangle strips. Normals are
  * not computed for lines or vertices.
@@ -173,6 +182,16 @@ public:
   vtkGetMacro(OutputPointsPrecision, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded computation of the normals (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkPolyDataNormals();
   ~vtkPolyDataNormals() VTK_OVERRIDE {}
@@ -190,12 +209,12 @@ protected:
   int ComputeCellNormals;
   int NumFlips;
   int OutputPointsPrecision;
+  int EnableSMP;
 
 private:
   vtkIdList *Wave;
   vtkIdList *Wave2;
   vtkIdList *CellIds;
-  vtkIdList *Map;
   vtkPolyData *OldMesh;
   vtkPolyData *NewMesh;
   int *Visited;
@@ -206,11 +225,6 @@ private:
   // checked and properly ordered polygons.
   void TraverseAndOrder(void);
 
-  // Check the point id give to see whether it lies on a feature
-  // edge. If so, split the point (i.e., duplicate it) to topologically
-  // separate the mesh.
-  void MarkAndSplit(vtkIdType ptId);
-
 private:
   vtkPolyDataNormals(const vtkPolyDataNormals&) VTK_DELETE_FUNCTION;
   void operator=(const vtkPolyDataNormals&) VTK_DELETE_FUNCTION;
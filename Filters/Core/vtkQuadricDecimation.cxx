@@ -53,19 +53,286 @@
 #include "vtkPolyData.h"
 #include "vtkPointData.h"
 #include "vtkPriorityQueue.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkTriangle.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkQuadricDecimation);
 
+//----------------------------------------------------------------------------
+// A priority queue of the edges where the edges are not removed when their
+// cost changes: every insertion of an edge pushes a new version of it, and
+// the entries of older versions, or of deleted edges, are skipped when they
+// are popped.
+class vtkQuadricDecimation::LazyQueue
+{
+public:
+  void Insert(double cost, vtkIdType edgeId)
+  {
+    if (edgeId >= static_cast<vtkIdType>(this->Versions.size()))
+    {
+      this->Versions.resize(edgeId + 1, 0);
+      this->InQueue.resize(edgeId + 1, 0);
+    }
+    // like vtkPriorityQueue, ignore the edges that are already queued
+    if (this->InQueue[edgeId])
+    {
+      return;
+    }
+    this->InQueue[edgeId] = 1;
+    Entry entry = {cost, edgeId, ++this->Versions[edgeId]};
+    this->Heap.push_back(entry);
+    std::push_heap(this->Heap.begin(), this->Heap.end());
+  }
+
+  void Delete(vtkIdType edgeId)
+  {
+    if (edgeId < static_cast<vtkIdType>(this->InQueue.size()))
+    {
+      this->InQueue[edgeId] = 0;
+    }
+  }
+
+  vtkIdType Pop(double &cost)
+  {
+    while (!this->Heap.empty())
+    {
+      std::pop_heap(this->Heap.begin(), this->Heap.end());
+      Entry entry = this->Heap.back();
+      this->Heap.pop_back();
+      if (this->InQueue[entry.EdgeId] &&
+          entry.Version == this->Versions[entry.EdgeId])
+      {
+        this->InQueue[entry.EdgeId] = 0;
+        cost = entry.Cost;
+        return entry.EdgeId;
+      }
+    }
+    return -1;
+  }
+
+private:
+  struct Entry
+  {
+    double Cost;
+    vtkIdType EdgeId;
+    unsigned int Version;
+
+    // The standard heap puts the greatest entry on top: the greatest entry
+    // is the one with the lowest cost, then with the lowest edge id.
+    bool operator<(const Entry &other) const
+    {
+      return this->Cost > other.Cost ||
+        (this->Cost == other.Cost && this->EdgeId > other.EdgeId);
+    }
+  };
+
+  std::vector<Entry> Heap;
+  std::vector<unsigned int> Versions;
+  std::vector<char> InQueue;
+};
+
+//----------------------------------------------------------------------------
+// Compute the quadric (and volume constraint) of each point by gathering
+// the contributions of its triangles, in the order in which
+// InitializeQuadrics() and AddBoundaryConstraints() scatter them, so that
+// the sums are the same as in the serial case.
+struct vtkQuadricDecimation::ComputeQuadrics
+{
+  vtkQuadricDecimation *Self;
+  int NumberOfQuadricComponents;
+  vtkSMPThreadLocal<std::vector<double> > QEM;
+  vtkSMPThreadLocalObject<vtkIdList> CellIds;
+  vtkSMPThreadLocal<vtkIdType> NumberOfFailures;
+
+  ComputeQuadrics(vtkQuadricDecimation *self) : Self(self),
+    NumberOfQuadricComponents(11 + 4 * self->NumberOfComponents)
+  {
+  }
+
+  void Initialize()
+  {
+    this->QEM.Local().resize(this->NumberOfQuadricComponents);
+    this->NumberOfFailures.Local() = 0;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkPolyData *mesh = this->Self->Mesh;
+    double *volume = this->Self->VolumePreservation ?
+      this->Self->VolumeConstraints : NULL;
+    double *qem = &this->QEM.Local()[0];
+    vtkIdList *cellIds = this->CellIds.Local();
+    vtkIdType &numFailures = this->NumberOfFailures.Local();
+    unsigned short ncells, c;
+    vtkIdType *cells, npts, *pts, p0, p1;
+    double n[3], d, triArea2, w;
+    int i, j;
+
+    for (vtkIdType ptId = begin; ptId < end; ptId++)
+    {
+      double *quadric = this->Self->ErrorQuadrics[ptId].Quadric;
+      std::fill(quadric, quadric + this->NumberOfQuadricComponents, 0.0);
+      mesh->GetPointCells(ptId, ncells, cells);
+
+      // the triangles, once per use of the point (the links of a point
+      // list a degenerate triangle as many times as it uses the point)
+      for (c = 0; c < ncells; c++)
+      {
+        mesh->GetCellPoints(cells[c], npts, pts);
+        if (!this->Self->ComputeTriangleQuadric(pts, qem, n, d, triArea2))
+        {
+          numFailures++;
+        }
+        for (j = 0; j < this->NumberOfQuadricComponents; j++)
+        {
+          quadric[j] += qem[j] * triArea2;
+        }
+        if (volume)
+        {
+          for (j = 0; j < 3; j++)
+          {
+            volume[ptId * 4 + j] += n[j] * triArea2 * 2.0;
+          }
+          volume[ptId * 4 + 3] += -d * triArea2 * 2.0;
+        }
+      }
+
+      // the boundary edges of the triangles, once per triangle
+      for (c = 0; c < ncells; c++)
+      {
+        if (c > 0 && cells[c] == cells[c-1])
+        {
+          continue;
+        }
+        mesh->GetCellPoints(cells[c], npts, pts);
+        for (i = 0; i < 3; i++)
+        {
+          p0 = pts[i];
+          p1 = pts[(i+1)%3];
+          if (p0 != ptId && p1 != ptId)
+          {
+            continue;
+          }
+          mesh->GetCellEdgeNeighbors(cells[c], p0, p1, cellIds);
+          if (cellIds->GetNumberOfIds() == 0)
+          {
+            this->Self->ComputeBoundaryQuadric(pts, i, qem, w);
+            for (j = 0; j < 11; j++)
+            {
+              if (p0 == ptId)
+              {
+                quadric[j] += qem[j]*w;
+              }
+              if (p1 == ptId)
+              {
+                quadric[j] += qem[j]*w;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    vtkIdType numFailures = 0;
+    vtkSMPThreadLocal<vtkIdType>::iterator iter;
+    for (iter = this->NumberOfFailures.begin();
+         iter != this->NumberOfFailures.end(); ++iter)
+    {
+      numFailures += *iter;
+    }
+    if (numFailures)
+    {
+      vtkErrorWithObjectMacro(this->Self,
+                              <<"Unable to factor attribute matrix!");
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Compute the cost of and target point for collapsing each edge, with work
+// arrays per thread.
+struct vtkQuadricDecimation::ComputeCosts
+{
+  struct WorkArrays
+  {
+    std::vector<double> X;
+    std::vector<double> Quad;
+    std::vector<double> B;
+    std::vector<double> Data;
+    std::vector<double*> A;
+  };
+
+  vtkQuadricDecimation *Self;
+  std::vector<double> &Costs;
+  int Size;
+  vtkSMPThreadLocal<WorkArrays> Work;
+
+  ComputeCosts(vtkQuadricDecimation *self, std::vector<double> &costs)
+    : Self(self), Costs(costs),
+      Size(3 + self->NumberOfComponents + self->VolumePreservation)
+  {
+  }
+
+  void Initialize()
+  {
+    WorkArrays &work = this->Work.Local();
+    work.X.resize(this->Size);
+    work.Quad.resize(11 + 4 * this->Self->NumberOfComponents +
+                     this->Self->VolumePreservation);
+    work.B.resize(this->Size);
+    work.Data.resize(this->Size * this->Size);
+    work.A.resize(this->Size);
+    for (int i = 0; i < this->Size; i++)
+    {
+      work.A[i] = &work.Data[0] + i * this->Size;
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    WorkArrays &work = this->Work.Local();
+    double *x = &work.X[0];
+    double *targetPoints = this->Self->TargetPoints->GetPointer(0);
+    for (vtkIdType edgeId = begin; edgeId < end; edgeId++)
+    {
+      if (this->Self->AttributeErrorMetric)
+      {
+        this->Costs[edgeId] = this->Self->ComputeCost2(
+          edgeId, x, &work.Quad[0], &work.A[0], &work.B[0]);
+      }
+      else
+      {
+        this->Costs[edgeId] =
+          this->Self->ComputeCost(edgeId, x, &work.Quad[0]);
+      }
+      std::copy(x, x + this->Size, targetPoints + edgeId * this->Size);
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
 
 //----------------------------------------------------------------------------
 vtkQuadricDecimation::vtkQuadricDecimation()
 {
   this->Edges = vtkEdgeTable::New();
   this->EdgeCosts = vtkPriorityQueue::New();
+  this->LazyEdgeCosts = NULL;
   this->EndPoint1List = vtkIdList::New();
   this->EndPoint2List = vtkIdList::New();
   this->ErrorQuadrics = NULL;
+  this->QuadricData = NULL;
   this->VolumeConstraints = NULL;
   this->TargetPoints = vtkDoubleArray::New();
 
@@ -88,6 +355,9 @@ vtkQuadricDecimation::vtkQuadricDecimation()
   this->TensorsWeight = 0.1;
 
   this->ActualReduction = 0.0;
+
+  this->EnableSMP = 0;
+  this->LazyEdgeQueue = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -253,7 +523,14 @@ int vtkQuadricDecimation::RequestData(
 
   vtkDebugMacro(<<"Computing Edges");
   this->Edges->InitEdgeInsertion(numPts, 1); // storing edge id as attribute
-  this->EdgeCosts->Allocate(this->Mesh->GetPolys()->GetNumberOfCells() * 3);
+  if (this->LazyEdgeQueue)
+  {
+    this->LazyEdgeCosts = new vtkQuadricDecimation::LazyQueue;
+  }
+  else
+  {
+    this->EdgeCosts->Allocate(this->Mesh->GetPolys()->GetNumberOfCells() * 3);
+  }
   for (i = 0; i <  this->Mesh->GetNumberOfCells(); i++)
   {
     this->Mesh->GetCellPoints(i, npts, pts);
@@ -295,31 +572,56 @@ int vtkQuadricDecimation::RequestData(
   this->TargetPoints->SetNumberOfComponents(3+this->NumberOfComponents+this->VolumePreservation);
 
   vtkDebugMacro(<<"Computing Quadrics");
-  this->InitializeQuadrics(numPts);
-  this->AddBoundaryConstraints();
+  if (this->EnableSMP)
+  {
+    this->AllocateQuadrics(numPts);
+    vtkQuadricDecimation::ComputeQuadrics computeQuadrics(this);
+    vtkSMPTools::For(0, numPts, computeQuadrics);
+  }
+  else
+  {
+    this->InitializeQuadrics(numPts);
+    this->AddBoundaryConstraints();
+  }
   this->UpdateProgress(0.15);
 
   vtkDebugMacro(<<"Computing Costs");
   // Compute the cost of and target point for collapsing each edge.
-  for (i = 0; i < this->Edges->GetNumberOfEdges(); i++)
+  if (this->EnableSMP)
   {
-    if (this->AttributeErrorMetric)
+    vtkIdType numEdges = this->Edges->GetNumberOfEdges();
+    std::vector<double> costs(numEdges);
+    this->TargetPoints->SetNumberOfTuples(numEdges);
+    vtkQuadricDecimation::ComputeCosts computeCosts(this, costs);
+    vtkSMPTools::For(0, numEdges, computeCosts);
+    // the queue is filled in the same order as in the serial case
+    for (i = 0; i < numEdges; i++)
     {
-      cost = this->ComputeCost2(i, x);
+      this->InsertEdgeCost(costs[i], i);
     }
-    else
+  }
+  else
+  {
+    for (i = 0; i < this->Edges->GetNumberOfEdges(); i++)
     {
-      cost = this->ComputeCost(i, x);
+      if (this->AttributeErrorMetric)
+      {
+        cost = this->ComputeCost2(i, x);
+      }
+      else
+      {
+        cost = this->ComputeCost(i, x);
+      }
+      this->InsertEdgeCost(cost, i);
+      this->TargetPoints->InsertTuple(i, x);
     }
-    this->EdgeCosts->Insert(cost, i);
-    this->TargetPoints->InsertTuple(i, x);
   }
   this->UpdateProgress(0.20);
 
   // Okay collapse edges until desired reduction is reached
   this->ActualReduction = 0.0;
   this->NumberOfEdgeCollapses = 0;
-  edgeId = this->EdgeCosts->Pop(0,cost);
+  edgeId = this->PopEdgeCost(cost);
 
   int abort = 0;
   while ( !abort && edgeId >= 0 && cost < VTK_DOUBLE_MAX &&
@@ -342,9 +644,9 @@ int vtkQuadricDecimation::RequestData(
       vtkDebugMacro(<<"Poor placement detected " << edgeId << " " <<  cost);
       // return the point to the queue but with the max cost so that
       // when it is recomputed it will be reconsidered
-      this->EdgeCosts->Insert(VTK_DOUBLE_MAX, edgeId);
+      this->InsertEdgeCost(VTK_DOUBLE_MAX, edgeId);
 
-      edgeId = this->EdgeCosts->Pop(0, cost);
+      edgeId = this->PopEdgeCost(cost);
       continue;
     }
 
@@ -363,18 +665,19 @@ int vtkQuadricDecimation::RequestData(
     // Update the output triangles.
     numDeletedTris += this->CollapseEdge(endPtIds[0], endPtIds[1]);
     this->ActualReduction = (double) numDeletedTris / numTris;
-    edgeId = this->EdgeCosts->Pop(0, cost);
+    edgeId = this->PopEdgeCost(cost);
   }
 
   vtkDebugMacro(<<"Number Of Edge Collapses: "
                 << this->NumberOfEdgeCollapses << " Cost: " << cost);
 
   // clean up working data
-  for (i = 0; i < numPts; i++)
-  {
-    delete [] this->ErrorQuadrics[i].Quadric;
-  }
+  delete [] this->QuadricData;
+  this->QuadricData = NULL;
   delete [] this->ErrorQuadrics;
+  this->ErrorQuadrics = NULL;
+  delete this->LazyEdgeCosts;
+  this->LazyEdgeCosts = NULL;
 
   if (this->VolumePreservation)
     delete[] this->VolumeConstraints;
@@ -420,6 +723,20 @@ int vtkQuadricDecimation::RequestData(
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkQuadricDecimation::AllocateQuadrics(vtkIdType numPts)
+{
+  // the quadrics of all the points are stored contiguously, so that the
+  // quadrics of the two end points of an edge are read from one block
+  vtkIdType numQuadricComponents = 11 + 4 * this->NumberOfComponents;
+  this->QuadricData = new double[numPts * numQuadricComponents];
+  for (vtkIdType ptId = 0; ptId < numPts; ptId++)
+  {
+    this->ErrorQuadrics[ptId].Quadric =
+      this->QuadricData + ptId * numQuadricComponents;
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
 {
@@ -429,25 +746,15 @@ void vtkQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
   int i, j;
   vtkCellArray *polys;
   vtkIdType npts, *pts=NULL;
-  double point0[3], point1[3], point2[3];
-  double n[3];
-  double tempP1[3], tempP2[3],  d, triArea2;
-  double data[16];
-  double *A[4], x[4];
-  int index[4];
-  A[0] = data;
-  A[1] = data+4;
-  A[2] = data+8;
-  A[3] = data+12;
+  double n[3], d, triArea2;
 
   // allocate local QEM sparse matrix
   QEM = new double[11 + 4 * this->NumberOfComponents];
 
   // clear and allocate global QEM array
+  this->AllocateQuadrics(numPts);
   for (ptId = 0; ptId < numPts; ptId++)
   {
-    this->ErrorQuadrics[ptId].Quadric =
-      new double[11 + 4 * this->NumberOfComponents];
     for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
     {
       this->ErrorQuadrics[ptId].Quadric[i] = 0.0;
@@ -458,113 +765,9 @@ void vtkQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
   // compute the QEM for each face
   for (polys->InitTraversal(); polys->GetNextCell(npts, pts); )
   {
-    input->GetPoint(pts[0], point0);
-    input->GetPoint(pts[1], point1);
-    input->GetPoint(pts[2], point2);
-    for (i = 0; i < 3; i++)
-    {
-      tempP1[i] = point1[i] - point0[i];
-      tempP2[i] = point2[i] - point0[i];
-    }
-    vtkMath::Cross(tempP1, tempP2, n);
-    triArea2 = vtkMath::Normalize(n);
-    //triArea2 = (triArea2 * triArea2 * 0.25);
-    triArea2 = triArea2 * 0.5;
-    // I am unsure whether this should be squared or not??
-    d = -vtkMath::Dot(n, point0);
-    // could possible add in angle weights??
-
-    // set the geometric part of the QEM
-    QEM[0] = n[0] * n[0];
-    QEM[1] = n[0] * n[1];
-    QEM[2] = n[0] * n[2];
-    QEM[3] = d * n[0];
-
-    QEM[4] = n[1] * n[1];
-    QEM[5] = n[1] * n[2];
-    QEM[6] = d * n[1];
-
-    QEM[7] = n[2] * n[2];
-    QEM[8] = d * n[2];
-
-    QEM[9] = d * d;
-    QEM[10] = 1;
-
-    if (this->AttributeErrorMetric)
+    if (!this->ComputeTriangleQuadric(pts, QEM, n, d, triArea2))
     {
-      for (i = 0; i < 3; i++)
-      {
-        A[0][i] = point0[i];
-        A[1][i] = point1[i];
-        A[2][i] = point2[i];
-        A[3][i] = n[i];
-      }
-      A[0][3] =  A[1][3] = A[2][3] = 1;
-      A[3][3] = 0;
-
-      // should handle poorly condition matrix better
-      if (vtkMath::LUFactorLinearSystem(A, index, 4))
-      {
-        for (i = 0; i < this->NumberOfComponents; i++)
-        {
-          x[3] = 0;
-          if (i < this->AttributeComponents[0])
-          {
-            x[0] = input->GetPointData()->GetScalars()->GetComponent(pts[0], i) *  this->AttributeScale[0];
-            x[1] = input->GetPointData()->GetScalars()->GetComponent(pts[1], i) *  this->AttributeScale[0];
-            x[2] = input->GetPointData()->GetScalars()->GetComponent(pts[2], i) *  this->AttributeScale[0];
-          }
-          else if (i < this->AttributeComponents[1])
-          {
-            x[0] = input->GetPointData()->GetVectors()->GetComponent(pts[0], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
-            x[1] = input->GetPointData()->GetVectors()->GetComponent(pts[1], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
-            x[2] = input->GetPointData()->GetVectors()->GetComponent(pts[2], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
-          }
-          else if (i < this->AttributeComponents[2])
-          {
-            x[0] = input->GetPointData()->GetNormals()->GetComponent(pts[0], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
-            x[1] = input->GetPointData()->GetNormals()->GetComponent(pts[1], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
-            x[2] = input->GetPointData()->GetNormals()->GetComponent(pts[2], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
-          }
-          else if (i < this->AttributeComponents[3])
-          {
-            x[0] = input->GetPointData()->GetTCoords()->GetComponent(pts[0], i - this->AttributeComponents[2]) *  this->AttributeScale[3];
-            x[1] = input->GetPointData()->GetTCoords()->GetComponent(pts[1], i - this->AttributeComponents[2])*  this->AttributeScale[3];
-            x[2] = input->GetPointData()->GetTCoords()->GetComponent(pts[2], i - this->AttributeComponents[2])*  this->AttributeScale[3];
-          }
-          else if (i < this->AttributeComponents[4])
-          {
-            x[0] = input->GetPointData()->GetTensors()->GetComponent(pts[0], i - this->AttributeComponents[3])*  this->AttributeScale[4];
-            x[1] = input->GetPointData()->GetTensors()->GetComponent(pts[1], i - this->AttributeComponents[3])*  this->AttributeScale[4];
-            x[2] = input->GetPointData()->GetTensors()->GetComponent(pts[2], i - this->AttributeComponents[3])*  this->AttributeScale[4];
-          }
-          vtkMath::LUSolveLinearSystem(A, index, x, 4);
-
-          // add in the contribution of this element into the QEM
-          QEM[0] += x[0] * x[0];
-          QEM[1] += x[0] * x[1];
-          QEM[2] += x[0] * x[2];
-          QEM[3] += x[3] * x[0];
-
-          QEM[4] += x[1] * x[1];
-          QEM[5] += x[1] * x[2];
-          QEM[6] += x[3] * x[1];
-
-          QEM[7] += x[2] * x[2];
-          QEM[8] += x[3] * x[2];
-
-          QEM[9] += x[3] * x[3];
-
-          QEM[11+i*4] = -x[0];
-          QEM[12+i*4] = -x[1];
-          QEM[13+i*4] = -x[2];
-          QEM[14+i*4] = -x[3];
-        }
-      }
-      else
-      {
-        vtkErrorMacro(<<"Unable to factor attribute matrix!");
-      }
+      vtkErrorMacro(<<"Unable to factor attribute matrix!");
     }
 
     // add the QEM to all points of the face
@@ -592,6 +795,139 @@ void vtkQuadricDecimation::InitializeQuadrics(vtkIdType numPts)
   delete [] QEM;
 }
 
+//----------------------------------------------------------------------------
+int vtkQuadricDecimation::ComputeTriangleQuadric(const vtkIdType *pts,
+                                                 double *QEM, double n[3],
+                                                 double &d, double &triArea2)
+{
+  vtkPolyData *input = this->Mesh;
+  int i;
+  double point0[3], point1[3], point2[3];
+  double tempP1[3], tempP2[3];
+  double data[16];
+  double *A[4], x[4];
+  int index[4];
+  A[0] = data;
+  A[1] = data+4;
+  A[2] = data+8;
+  A[3] = data+12;
+
+  input->GetPoint(pts[0], point0);
+  input->GetPoint(pts[1], point1);
+  input->GetPoint(pts[2], point2);
+  for (i = 0; i < 3; i++)
+  {
+    tempP1[i] = point1[i] - point0[i];
+    tempP2[i] = point2[i] - point0[i];
+  }
+  vtkMath::Cross(tempP1, tempP2, n);
+  triArea2 = vtkMath::Normalize(n);
+  //triArea2 = (triArea2 * triArea2 * 0.25);
+  triArea2 = triArea2 * 0.5;
+  // I am unsure whether this should be squared or not??
+  d = -vtkMath::Dot(n, point0);
+  // could possible add in angle weights??
+
+  // set the geometric part of the QEM
+  QEM[0] = n[0] * n[0];
+  QEM[1] = n[0] * n[1];
+  QEM[2] = n[0] * n[2];
+  QEM[3] = d * n[0];
+
+  QEM[4] = n[1] * n[1];
+  QEM[5] = n[1] * n[2];
+  QEM[6] = d * n[1];
+
+  QEM[7] = n[2] * n[2];
+  QEM[8] = d * n[2];
+
+  QEM[9] = d * d;
+  QEM[10] = 1;
+
+  if (this->AttributeErrorMetric)
+  {
+    for (i = 0; i < 3; i++)
+    {
+      A[0][i] = point0[i];
+      A[1][i] = point1[i];
+      A[2][i] = point2[i];
+      A[3][i] = n[i];
+    }
+    A[0][3] =  A[1][3] = A[2][3] = 1;
+    A[3][3] = 0;
+
+    // should handle poorly condition matrix better
+    if (vtkMath::LUFactorLinearSystem(A, index, 4))
+    {
+      for (i = 0; i < this->NumberOfComponents; i++)
+      {
+        x[3] = 0;
+        if (i < this->AttributeComponents[0])
+        {
+          x[0] = input->GetPointData()->GetScalars()->GetComponent(pts[0], i) *  this->AttributeScale[0];
+          x[1] = input->GetPointData()->GetScalars()->GetComponent(pts[1], i) *  this->AttributeScale[0];
+          x[2] = input->GetPointData()->GetScalars()->GetComponent(pts[2], i) *  this->AttributeScale[0];
+        }
+        else if (i < this->AttributeComponents[1])
+        {
+          x[0] = input->GetPointData()->GetVectors()->GetComponent(pts[0], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
+          x[1] = input->GetPointData()->GetVectors()->GetComponent(pts[1], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
+          x[2] = input->GetPointData()->GetVectors()->GetComponent(pts[2], i - this->AttributeComponents[0]) *  this->AttributeScale[1];
+        }
+        else if (i < this->AttributeComponents[2])
+        {
+          x[0] = input->GetPointData()->GetNormals()->GetComponent(pts[0], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
+          x[1] = input->GetPointData()->GetNormals()->GetComponent(pts[1], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
+          x[2] = input->GetPointData()->GetNormals()->GetComponent(pts[2], i - this->AttributeComponents[1]) *  this->AttributeScale[2];
+        }
+        else if (i < this->AttributeComponents[3])
+        {
+          x[0] = input->GetPointData()->GetTCoords()->GetComponent(pts[0], i - this->AttributeComponents[2]) *  this->AttributeScale[3];
+          x[1] = input->GetPointData()->GetTCoords()->GetComponent(pts[1], i - this->AttributeComponents[2])*  this->AttributeScale[3];
+          x[2] = input->GetPointData()->GetTCoords()->GetComponent(pts[2], i - this->AttributeComponents[2])*  this->AttributeScale[3];
+        }
+        else if (i < this->AttributeComponents[4])
+        {
+          x[0] = input->GetPointData()->GetTensors()->GetComponent(pts[0], i - this->AttributeComponents[3])*  this->AttributeScale[4];
+          x[1] = input->GetPointData()->GetTensors()->GetComponent(pts[1], i - this->AttributeComponents[3])*  this->AttributeScale[4];
+          x[2] = input->GetPointData()->GetTensors()->GetComponent(pts[2], i - this->AttributeComponents[3])*  this->AttributeScale[4];
+        }
+        vtkMath::LUSolveLinearSystem(A, index, x, 4);
+
+        // add in the contribution of this element into the QEM
+        QEM[0] += x[0] * x[0];
+        QEM[1] += x[0] * x[1];
+        QEM[2] += x[0] * x[2];
+        QEM[3] += x[3] * x[0];
+
+        QEM[4] += x[1] * x[1];
+        QEM[5] += x[1] * x[2];
+        QEM[6] += x[3] * x[1];
+
+        QEM[7] += x[2] * x[2];
+        QEM[8] += x[3] * x[2];
+
+        QEM[9] += x[3] * x[3];
+
+        QEM[11+i*4] = -x[0];
+        QEM[12+i*4] = -x[1];
+        QEM[13+i*4] = -x[2];
+        QEM[14+i*4] = -x[3];
+      }
+    }
+    else
+    {
+      for (i = 11; i < 11 + 4 * this->NumberOfComponents; i++)
+      {
+        QEM[i] = 0.0;
+      }
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
 
 void vtkQuadricDecimation::AddBoundaryConstraints(void)
 {
@@ -600,8 +936,7 @@ void vtkQuadricDecimation::AddBoundaryConstraints(void)
   vtkIdType  cellId;
   int i, j;
   vtkIdType npts, *pts;
-  double t0[3], t1[3], t2[3];
-  double e0[3], e1[3], n[3], c, d, w;
+  double w;
   vtkIdList *cellIds = vtkIdList::New();
 
   // allocate local QEM space matrix
@@ -617,50 +952,7 @@ void vtkQuadricDecimation::AddBoundaryConstraints(void)
       if (cellIds->GetNumberOfIds() == 0)
       {
         // this is a boundary
-        input->GetPoint(pts[(i+2)%3], t0);
-        input->GetPoint(pts[i], t1);
-        input->GetPoint(pts[(i+1)%3], t2);
-
-        // computing a plane which is orthogonal to line t1, t2 and incident
-        // with it
-        for (j = 0; j < 3; j++)
-        {
-          e0[j] = t2[j] - t1[j];
-        }
-        for (j = 0; j < 3; j++)
-        {
-          e1[j] = t0[j] - t1[j];
-        }
-
-        // compute n so that it is orthogonal to e0 and parallel to the
-        // triangle
-        c = vtkMath::Dot(e0,e1)/(e0[0]*e0[0]+e0[1]*e0[1]+e0[2]*e0[2]);
-        for (j = 0; j < 3; j++)
-        {
-          n[j] = e1[j] - c*e0[j];
-        }
-        vtkMath::Normalize(n);
-        d = -vtkMath::Dot(n, t1);
-        w = vtkMath::Norm(e0);
-
-        //w *= w;
-        // area issue ??
-        // could possible add in angle weights??
-        QEM[0] = n[0] * n[0];
-        QEM[1] = n[0] * n[1];
-        QEM[2] = n[0] * n[2];
-        QEM[3] = d * n[0];
-
-        QEM[4] = n[1] * n[1];
-        QEM[5] = n[1] * n[2];
-        QEM[6] = d * n[1];
-
-        QEM[7] = n[2] * n[2];
-        QEM[8] = d * n[2];
-
-        QEM[9] = d * d;
-
-        QEM[10] = 1;
+        this->ComputeBoundaryQuadric(pts, i, QEM, w);
 
         // need to add orthogonal plane with the other Attributes, but this
         // is not clear??
@@ -677,6 +969,61 @@ void vtkQuadricDecimation::AddBoundaryConstraints(void)
   delete [] QEM;
 }
 
+//----------------------------------------------------------------------------
+void vtkQuadricDecimation::ComputeBoundaryQuadric(const vtkIdType *pts, int i,
+                                                  double *QEM, double &w)
+{
+  vtkPolyData *input = this->Mesh;
+  int j;
+  double t0[3], t1[3], t2[3];
+  double e0[3], e1[3], n[3], c, d;
+
+  input->GetPoint(pts[(i+2)%3], t0);
+  input->GetPoint(pts[i], t1);
+  input->GetPoint(pts[(i+1)%3], t2);
+
+  // computing a plane which is orthogonal to line t1, t2 and incident
+  // with it
+  for (j = 0; j < 3; j++)
+  {
+    e0[j] = t2[j] - t1[j];
+  }
+  for (j = 0; j < 3; j++)
+  {
+    e1[j] = t0[j] - t1[j];
+  }
+
+  // compute n so that it is orthogonal to e0 and parallel to the
+  // triangle
+  c = vtkMath::Dot(e0,e1)/(e0[0]*e0[0]+e0[1]*e0[1]+e0[2]*e0[2]);
+  for (j = 0; j < 3; j++)
+  {
+    n[j] = e1[j] - c*e0[j];
+  }
+  vtkMath::Normalize(n);
+  d = -vtkMath::Dot(n, t1);
+  w = vtkMath::Norm(e0);
+
+  //w *= w;
+  // area issue ??
+  // could possible add in angle weights??
+  QEM[0] = n[0] * n[0];
+  QEM[1] = n[0] * n[1];
+  QEM[2] = n[0] * n[2];
+  QEM[3] = d * n[0];
+
+  QEM[4] = n[1] * n[1];
+  QEM[5] = n[1] * n[2];
+  QEM[6] = d * n[1];
+
+  QEM[7] = n[2] * n[2];
+  QEM[8] = d * n[2];
+
+  QEM[9] = d * d;
+
+  QEM[10] = 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkQuadricDecimation::AddQuadric(vtkIdType oldPtId, vtkIdType newPtId)
 {
@@ -697,6 +1044,42 @@ void vtkQuadricDecimation::AddQuadric(vtkIdType oldPtId, vtkIdType newPtId)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkQuadricDecimation::InsertEdgeCost(double cost, vtkIdType edgeId)
+{
+  if (this->LazyEdgeCosts)
+  {
+    this->LazyEdgeCosts->Insert(cost, edgeId);
+  }
+  else
+  {
+    this->EdgeCosts->Insert(cost, edgeId);
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkQuadricDecimation::DeleteEdgeCost(vtkIdType edgeId)
+{
+  if (this->LazyEdgeCosts)
+  {
+    this->LazyEdgeCosts->Delete(edgeId);
+  }
+  else
+  {
+    this->EdgeCosts->DeleteId(edgeId);
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkQuadricDecimation::PopEdgeCost(double &cost)
+{
+  if (this->LazyEdgeCosts)
+  {
+    return this->LazyEdgeCosts->Pop(cost);
+  }
+  return this->EdgeCosts->Pop(0, cost);
+}
+
 //----------------------------------------------------------------------------
 void vtkQuadricDecimation::FindAffectedEdges(vtkIdType p1Id, vtkIdType p2Id,
                                               vtkIdList *edges)
@@ -758,7 +1141,7 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
 
     // Remove all affected edges from the priority queue.
     // This does not include collapsed edge.
-    this->EdgeCosts->DeleteId(changedEdges->GetId(i));
+    this->DeleteEdgeCost(changedEdges->GetId(i));
 
     // Determine the new set of edges
     if (edge[0] == pt1Id)
@@ -778,7 +1161,7 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
         {
           cost = this->ComputeCost(edgeId, this->TempX);
         }
-        this->EdgeCosts->Insert(cost, edgeId);
+        this->InsertEdgeCost(cost, edgeId);
         this->TargetPoints->InsertTuple(edgeId, this->TempX);
       }
     }
@@ -799,7 +1182,7 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
         {
           cost = this->ComputeCost(edgeId, this->TempX);
         }
-        this->EdgeCosts->Insert(cost, edgeId);
+        this->InsertEdgeCost(cost, edgeId);
         this->TargetPoints->InsertTuple(edgeId, this->TempX);
       }
     }
@@ -813,7 +1196,7 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
       {
         cost = this->ComputeCost(changedEdges->GetId(i), this->TempX);
       }
-      this->EdgeCosts->Insert(cost, changedEdges->GetId(i));
+      this->InsertEdgeCost(cost, changedEdges->GetId(i));
       this->TargetPoints->InsertTuple(changedEdges->GetId(i), this->TempX);
     }
   }
@@ -824,6 +1207,13 @@ void vtkQuadricDecimation::UpdateEdgeData(vtkIdType pt0Id, vtkIdType pt1Id)
 
 //----------------------------------------------------------------------------
 double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
+{
+  return this->ComputeCost(edgeId, x, this->TempQuad);
+}
+
+//----------------------------------------------------------------------------
+double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x,
+                                         double *quad)
 {
   static const double errorNumber = 1e-10;
   double temp[3], A[3][3], b[3];
@@ -840,20 +1230,20 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
 
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
   {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
+    quad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
       this->ErrorQuadrics[pointIds[1]].Quadric[i];
   }
 
-  A[0][0] = this->TempQuad[0];
-  A[0][1] = A[1][0] = this->TempQuad[1];
-  A[0][2] = A[2][0] = this->TempQuad[2];
-  A[1][1] = this->TempQuad[4];
-  A[1][2] = A[2][1] = this->TempQuad[5];
-  A[2][2] = this->TempQuad[7];
+  A[0][0] = quad[0];
+  A[0][1] = A[1][0] = quad[1];
+  A[0][2] = A[2][0] = quad[2];
+  A[1][1] = quad[4];
+  A[1][2] = A[2][1] = quad[5];
+  A[2][2] = quad[7];
 
-  b[0] = -this->TempQuad[3];
-  b[1] = -this->TempQuad[6];
-  b[2] = -this->TempQuad[8];
+  b[0] = -quad[3];
+  b[1] = -quad[6];
+  b[2] = -quad[8];
 
   norm = vtkMath::Norm(A[0]);
   normTemp = vtkMath::Norm(A[1]);
@@ -907,7 +1297,7 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
 
   // Compute the cost
   // x'*quad*x
-  index = this->TempQuad;
+  index = quad;
   for (i = 0; i < 4; i++)
   {
     cost += (*index++)*newPoint[i]*newPoint[i];
@@ -923,6 +1313,15 @@ double vtkQuadricDecimation::ComputeCost(vtkIdType edgeId, double *x)
 
 //----------------------------------------------------------------------------
 double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
+{
+  return this->ComputeCost2(edgeId, x, this->TempQuad, this->TempA,
+                            this->TempB);
+}
+
+//----------------------------------------------------------------------------
+double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x,
+                                          double *quad, double **A,
+                                          double *b)
 {
   // this function is so ugly because the functionality of converting an QEM
   // into a dense matrix was not extracted into a separate function and
@@ -938,29 +1337,29 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
 
   for (i = 0; i < 11 + 4 * this->NumberOfComponents; i++)
   {
-    this->TempQuad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
+    quad[i] = this->ErrorQuadrics[pointIds[0]].Quadric[i] +
       this->ErrorQuadrics[pointIds[1]].Quadric[i];
   }
 
-  // copy the temp quad into TempA
+  // copy the temp quad into A
   // converting from the sparse matrix format into a dense
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
+  A[0][0] = quad[0];
+  A[0][1] = A[1][0] = quad[1];
+  A[0][2] = A[2][0] = quad[2];
+  A[1][1] = quad[4];
+  A[1][2] = A[2][1] = quad[5];
+  A[2][2] = quad[7];
 
-  this->TempB[0] = -this->TempQuad[3];
-  this->TempB[1] = -this->TempQuad[6];
-  this->TempB[2] = -this->TempQuad[8];
+  b[0] = -quad[3];
+  b[1] = -quad[6];
+  b[2] = -quad[8];
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
   {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
-    this->TempB[i] = -this->TempQuad[11+4*(i-3)+3];
+    A[0][i] = A[i][0] = quad[11+4*(i-3)];
+    A[1][i] = A[i][1] = quad[11+4*(i-3)+1];
+    A[2][i] = A[i][2] = quad[11+4*(i-3)+2];
+    b[i] = -quad[11+4*(i-3)+3];
   }
 
 
@@ -971,11 +1370,11 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i == j)
       {
-        this->TempA[i][j] = this->TempQuad[10];
+        A[i][j] = quad[10];
       }
       else
       {
-        this->TempA[i][j] = 0;
+        A[i][j] = 0;
       }
     }
   }
@@ -986,45 +1385,45 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i >= 3)
       {
-        this->TempA[i][3 + this->NumberOfComponents] = 0;
-        this->TempA[3 + this->NumberOfComponents][i] = 0;
+        A[i][3 + this->NumberOfComponents] = 0;
+        A[3 + this->NumberOfComponents][i] = 0;
       }
       else
       {
-        this->TempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        A[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        A[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        A[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        A[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
       }
     }
     // Add constraint to b
-    this->TempB[3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + 3];
-    this->TempB[3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + 3];
+    b[3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + 3];
+    b[3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + 3];
   }
 
   for (i = 0; i < 3 + this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    x[i] = this->TempB[i];
+    x[i] = b[i];
   }
 
   // solve A*x = b
   // this clobers A
   // need to develop a quality of the solution test??
-  solveOk = vtkMath::SolveLinearSystem(this->TempA, x, 3 + this->NumberOfComponents + this->VolumePreservation);
+  solveOk = vtkMath::SolveLinearSystem(A, x, 3 + this->NumberOfComponents + this->VolumePreservation);
 
   // need to copy back into A
-  this->TempA[0][0] = this->TempQuad[0];
-  this->TempA[0][1] = this->TempA[1][0] = this->TempQuad[1];
-  this->TempA[0][2] = this->TempA[2][0] = this->TempQuad[2];
-  this->TempA[1][1] = this->TempQuad[4];
-  this->TempA[1][2] = this->TempA[2][1] = this->TempQuad[5];
-  this->TempA[2][2] = this->TempQuad[7];
+  A[0][0] = quad[0];
+  A[0][1] = A[1][0] = quad[1];
+  A[0][2] = A[2][0] = quad[2];
+  A[1][1] = quad[4];
+  A[1][2] = A[2][1] = quad[5];
+  A[2][2] = quad[7];
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
   {
-    this->TempA[0][i] = this->TempA[i][0] = this->TempQuad[11+4*(i-3)];
-    this->TempA[1][i] = this->TempA[i][1] = this->TempQuad[11+4*(i-3)+1];
-    this->TempA[2][i] = this->TempA[i][2] = this->TempQuad[11+4*(i-3)+2];
+    A[0][i] = A[i][0] = quad[11+4*(i-3)];
+    A[1][i] = A[i][1] = quad[11+4*(i-3)+1];
+    A[2][i] = A[i][2] = quad[11+4*(i-3)+2];
   }
 
   for (i = 3; i < 3 +  this->NumberOfComponents; i++)
@@ -1033,11 +1432,11 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i == j)
       {
-        this->TempA[i][j] = this->TempQuad[10];
+        A[i][j] = quad[10];
       }
       else
       {
-        this->TempA[i][j] = 0;
+        A[i][j] = 0;
       }
     }
   }
@@ -1048,15 +1447,15 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
     {
       if (i >= 3)
       {
-        this->TempA[i][3 + this->NumberOfComponents] = 0;
-        this->TempA[3 + this->NumberOfComponents][i] = 0;
+        A[i][3 + this->NumberOfComponents] = 0;
+        A[3 + this->NumberOfComponents][i] = 0;
       }
       else
       {
-        this->TempA[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
-        this->TempA[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
-        this->TempA[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        A[i][3 + this->NumberOfComponents] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        A[3 + this->NumberOfComponents][i] = this->VolumeConstraints[pointIds[0] * 4 + i];
+        A[i][3 + this->NumberOfComponents] += this->VolumeConstraints[pointIds[1] * 4 + i];
+        A[3 + this->NumberOfComponents][i] += this->VolumeConstraints[pointIds[1] * 4 + i];
       }
     }
   }
@@ -1089,7 +1488,7 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
       temp2[i] = 0;
       for (j = 0; j < 3 + this->NumberOfComponents; ++j)
       {
-        temp2[i] += this->TempA[i][j]*v[j];
+        temp2[i] += A[i][j]*v[j];
       }
     }
 
@@ -1107,13 +1506,13 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
         temp[i] = 0;
         for (j = 0; j < 3 + this->NumberOfComponents; ++j)
         {
-          temp[i] += this->TempA[i][j]*pt1[j];
+          temp[i] += A[i][j]*pt1[j];
         }
       }
 
       for (i = 0; i < 3 + this->NumberOfComponents; i++)
       {
-        temp[i] = this->TempB[i] - temp[i];
+        temp[i] = b[i] - temp[i];
       }
 
       for (i = 0; i < 3 + this->NumberOfComponents; i++)
@@ -1147,18 +1546,18 @@ double vtkQuadricDecimation::ComputeCost2(vtkIdType edgeId, double *x)
   // x'*A*x - 2*b*x + d
   for (i = 0; i < 3+this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    cost += this->TempA[i][i]*x[i]*x[i];
+    cost += A[i][i]*x[i]*x[i];
     for (j = i+1; j < 3+this->NumberOfComponents + this->VolumePreservation; j++)
     {
-      cost += 2.0*this->TempA[i][j]*x[i]*x[j];
+      cost += 2.0*A[i][j]*x[i]*x[j];
     }
   }
   for (i = 0; i < 3+this->NumberOfComponents + this->VolumePreservation; i++)
   {
-    cost -=  2.0 * this->TempB[i]*x[i];
+    cost -=  2.0 * b[i]*x[i];
   }
 
-  cost += this->TempQuad[9];
+  cost += quad[9];
 
   return cost;
 }
@@ -1455,4 +1854,8 @@ void vtkQuadricDecimation::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Normals Weight: " << this->NormalsWeight << "\n";
   os << indent << "TCoords Weight: " << this->TCoordsWeight << "\n";
   os << indent << "Tensors Weight: " << this->TensorsWeight << "\n";
+
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
+  os << indent << "Lazy Edge Queue: "
+     << (this->LazyEdgeQueue ? "On\n" : "Off\n");
 }
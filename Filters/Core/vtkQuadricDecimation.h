@@ -48,6 +48,18 @@
  * Attributes" is also a good take on the subject especially as it pertains
  * to the error metric applied to attributes.
  *
+ * When EnableSMP is on, the initial error quadrics and the initial costs of
+ * the edges are computed in parallel (via vtkSMPTools). Each point gathers
+ * the contributions of its triangles in the order of the serial
+ * computation, so the result is the same. The error quadrics are always
+ * stored in a single packed array.
+ *
+ * When LazyEdgeQueue is on, the edges whose cost changes after a collapse
+ * are not removed from the priority queue: their outdated entries are
+ * skipped when they reach the top of the queue instead. The edges of equal
+ * cost may then be collapsed in a different order than with the default
+ * queue.
+ *
  * @par Thanks:
  * Thanks to Bradley Lowekamp of the National Library of Medicine/NIH for
  * contributing this class.
@@ -156,6 +168,26 @@ public:
   vtkGetMacro(ActualReduction, double);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded computation of the initial quadrics and
+   * edge costs (see the class documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
+  //@{
+  /**
+   * Enable/disable the lazy update of the priority queue of the edges (see
+   * the class documentation). This flag is off by default.
+   */
+  vtkSetMacro(LazyEdgeQueue, int);
+  vtkGetMacro(LazyEdgeQueue, int);
+  vtkBooleanMacro(LazyEdgeQueue, int);
+  //@}
+
 protected:
   vtkQuadricDecimation();
   ~vtkQuadricDecimation() VTK_OVERRIDE;
@@ -178,6 +210,34 @@ protected:
    */
   void AddBoundaryConstraints(void);
 
+  /**
+   * Allocate the quadrics of the points in the packed QuadricData array.
+   */
+  void AllocateQuadrics(vtkIdType numPts);
+
+  //@{
+  /**
+   * Compute the quadric of a triangle (with its unit normal, plane offset
+   * and area), or the quadric of the plane constraining its i-th edge when
+   * it is on the boundary (with the edge length). The attribute part of
+   * the triangle quadric is zeroed, and 0 is returned, when the attribute
+   * gradients cannot be computed.
+   */
+  int ComputeTriangleQuadric(const vtkIdType *pts, double *QEM, double n[3],
+                             double &d, double &triArea2);
+  void ComputeBoundaryQuadric(const vtkIdType *pts, int i, double *QEM,
+                              double &w);
+  //@}
+
+  //@{
+  /**
+   * Access the priority queue of the edges, lazy or not.
+   */
+  void InsertEdgeCost(double cost, vtkIdType edgeId);
+  void DeleteEdgeCost(vtkIdType edgeId);
+  vtkIdType PopEdgeCost(double &cost);
+  //@}
+
   /**
    * Compute quadric for this vertex.
    */
@@ -192,10 +252,14 @@ protected:
   //@{
   /**
    * Compute cost for contracting this edge and the point that gives us this
-   * cost.
+   * cost. The versions taking their work arrays (sized like TempQuad, TempA
+   * and TempB) can be called from several threads at once.
    */
   double ComputeCost(vtkIdType edgeId, double *x);
   double ComputeCost2(vtkIdType edgeId, double *x);
+  double ComputeCost(vtkIdType edgeId, double *x, double *quad);
+  double ComputeCost2(vtkIdType edgeId, double *x, double *quad, double **A,
+                      double *b);
   //@}
 
   /**
@@ -247,11 +311,16 @@ protected:
   double TCoordsWeight;
   double TensorsWeight;
 
+  int EnableSMP;
+  int LazyEdgeQueue;
+
   int               NumberOfEdgeCollapses;
   vtkEdgeTable     *Edges;
   vtkIdList        *EndPoint1List;
   vtkIdList        *EndPoint2List;
   vtkPriorityQueue *EdgeCosts;
+  class LazyQueue;
+  LazyQueue        *LazyEdgeCosts;
   vtkDoubleArray   *TargetPoints;
   int               NumberOfComponents;
   vtkPolyData      *Mesh;
@@ -262,8 +331,9 @@ protected:
   };
 
 
-  // One ErrorQuadric per point
+  // One ErrorQuadric per point, pointing in the packed QuadricData array
   ErrorQuadric *ErrorQuadrics;
+  double *QuadricData;
 
   // Contains 4 doubles per point. Length = nPoints * 4
   double *VolumeConstraints;
@@ -278,6 +348,10 @@ protected:
   double **TempA;
   double *TempData;
 
+  // The threaded computations of the quadrics and costs
+  struct ComputeQuadrics;
+  struct ComputeCosts;
+
 private:
   vtkQuadricDecimation(const vtkQuadricDecimation&) VTK_DELETE_FUNCTION;
   void operator=(const vtkQuadricDecimation&) VTK_DELETE_FUNCTION;
@@ -25,9 +25,13 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
+#include "vtkSmoothingTopology.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkTriangleFilter.h"
 
+#include <algorithm>
 #include <limits>
 
 vtkStandardNewMacro(vtkSmoothPolyDataFilter);
@@ -130,6 +134,8 @@ vtkSmoothPolyDataFilter::vtkSmoothPolyDataFilter()
 
   this->OutputPointsPrecision = vtkAlgorithm::DEFAULT_PRECISION;
 
+  this->EnableSMP = 0;
+
   this->SmoothPoints = NULL;
 
   // optional second input
@@ -279,6 +285,118 @@ template<typename T> void vtkSPDF_MovePoints(vtkSPDF_InternalParams<T>& params)
   vtkDebugWithObjectMacro(params.spdf, << "Performed " << iterationNumber << " smoothing passes");
 }
 
+// One threaded smoothing pass: the points are moved from their positions
+// after the previous pass, so that the result does not depend on the order
+// in which they are processed.
+template<typename T> struct vtkSPDF_RelaxPoints
+{
+  const vtkSmoothingTopology &Topology;
+  T Factor;
+  const T *X;
+  T *XNew;
+  vtkSMPThreadLocal<T> MaxDist;
+
+  vtkSPDF_RelaxPoints(const vtkSmoothingTopology &topology, T factor) :
+    Topology(topology), Factor(factor), X(NULL), XNew(NULL), MaxDist(0)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    T &maxDist = this->MaxDist.Local();
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      const T *x = this->X + 3 * ptId;
+      T *xNew = this->XNew + 3 * ptId;
+      vtkIdType npts = this->Topology.GetNumberOfNeighbors(ptId);
+      if (this->Topology.GetType(ptId) != VTK_FIXED_VERTEX && npts > 0)
+      {
+        const vtkIdType *neighbors = this->Topology.GetNeighbors(ptId);
+        T deltaX[3] = {0.0, 0.0, 0.0};
+        // Compute the mean (cumulated) direction vector
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          const T *y = this->X + 3 * neighbors[j];
+          for (int k = 0; k < 3; ++k)
+          {
+            deltaX[k] += y[k];
+          }
+        }
+
+        // Move the point
+        for (int k = 0; k < 3; ++k)
+        {
+          xNew[k] = x[k] + this->Factor * (deltaX[k] / npts - x[k]);
+        }
+
+        T dist = vtkMath::Norm(deltaX);
+        if (dist > maxDist)
+        {
+          maxDist = dist;
+        }
+      }
+      else
+      {
+        xNew[0] = x[0];
+        xNew[1] = x[1];
+        xNew[2] = x[2];
+      }
+    }
+  }
+};
+
+template<typename T> void vtkSPDF_MovePointsSMP(
+  vtkSmoothPolyDataFilter *spdf, const vtkSmoothingTopology &topology,
+  vtkPoints *newPts, T factor, T conv)
+{
+  // double buffering of the points
+  vtkIdType numPts = newPts->GetNumberOfPoints();
+  vtkPoints *tmpPts = vtkPoints::New();
+  tmpPts->SetDataType(newPts->GetDataType());
+  tmpPts->SetNumberOfPoints(numPts);
+  T *x = static_cast<T*>(newPts->GetVoidPointer(0));
+  T *xNew = static_cast<T*>(tmpPts->GetVoidPointer(0));
+
+  int numberOfIterations = spdf->GetNumberOfIterations();
+  int iterationNumber = 0;
+  vtkSPDF_RelaxPoints<T> relax(topology, factor);
+  for (T maxDist = std::numeric_limits<T>::max();
+       maxDist > conv && iterationNumber < numberOfIterations;
+       ++iterationNumber)
+  {
+    if (iterationNumber && !(iterationNumber % 5))
+    {
+      spdf->UpdateProgress(0.5 + 0.5*iterationNumber / numberOfIterations);
+      if (spdf->GetAbortExecute())
+      {
+        break;
+      }
+    }
+
+    relax.X = x;
+    relax.XNew = xNew;
+    vtkSMPTools::For(0, numPts, relax);
+    std::swap(x, xNew);
+
+    // The maximum does not depend on the way the points were split.
+    maxDist = 0.0;
+    for (typename vtkSMPThreadLocal<T>::iterator iter = relax.MaxDist.begin();
+         iter != relax.MaxDist.end(); ++iter)
+    {
+      maxDist = std::max(maxDist, *iter);
+      *iter = 0.0;
+    }
+  }
+
+  if (x != newPts->GetVoidPointer(0))
+  {
+    std::copy(x, x + 3 * numPts, static_cast<T*>(newPts->GetVoidPointer(0)));
+  }
+  tmpPts->Delete();
+
+  vtkDebugWithObjectMacro(spdf, << "Performed " << iterationNumber << " smoothing passes");
+}
+
 }// namespace
 
 int vtkSmoothPolyDataFilter::RequestData(
@@ -362,267 +480,285 @@ int vtkSmoothPolyDataFilter::RequestData(
   // using a subset of the attached vertices.
   //
   vtkDebugMacro(<<"Analyzing topology...");
-  Verts = new vtkMeshVertex[numPts];
-
   inPts = input->GetPoints();
   conv = this->Convergence * input->GetLength();
 
-  // check vertices first. Vertices are never smoothed_--------------
-  for (inVerts=input->GetVerts(), inVerts->InitTraversal();
-  inVerts->GetNextCell(npts,pts); )
+  // The constrained smoothing is serial since the cell locator is not
+  // thread safe.
+  bool smp = this->EnableSMP && !source;
+  vtkSmoothingTopology topology;
+  Verts = NULL;
+  if (smp)
   {
-    for (j=0; j<npts; j++)
-    {
-      Verts[pts[j]].type = VTK_FIXED_VERTEX;
-    }
+    topology.Build(input, this->FeatureEdgeSmoothing != 0, CosFeatureAngle,
+                   CosEdgeAngle, this->BoundarySmoothing != 0, false);
+    numSimple = topology.NumberOfSimpleVertices;
+    numFixed = topology.NumberOfFixedVertices;
+    numFEdges = topology.NumberOfFeatureEdgeVertices;
+    numBEdges = topology.NumberOfBoundaryEdgeVertices;
+    this->UpdateProgress(0.50);
   }
-  this->UpdateProgress(0.10);
-
-  // now check lines. Only manifold lines can be smoothed------------
-  for (inLines=input->GetLines(), inLines->InitTraversal();
-  inLines->GetNextCell(npts,pts); )
+  else
   {
-    for (j=0; j<npts; j++)
+    Verts = new vtkMeshVertex[numPts];
+
+    // check vertices first. Vertices are never smoothed_--------------
+    for (inVerts=input->GetVerts(), inVerts->InitTraversal();
+    inVerts->GetNextCell(npts,pts); )
     {
-      if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
+      for (j=0; j<npts; j++)
       {
-        if ( j == (npts-1) ) //end-of-line marked FIXED
-        {
-          Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        }
-        else if ( j == 0 ) //beginning-of-line marked FIXED
-        {
-          Verts[pts[0]].type = VTK_FIXED_VERTEX;
-          inPts->GetPoint(pts[0],x2);
-          inPts->GetPoint(pts[1],x3);
-        }
-        else //is edge vertex (unless already edge vertex!)
-        {
-          Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
-          Verts[pts[j]].edges = vtkIdList::New();
-          Verts[pts[j]].edges->SetNumberOfIds(2);
-          Verts[pts[j]].edges->SetId(0,pts[j-1]);
-          Verts[pts[j]].edges->SetId(1,pts[j+1]);
-        }
-      } //if simple vertex
-
-      else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
-      { //multiply connected, becomes fixed!
         Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        Verts[pts[j]].edges->Delete();
-        Verts[pts[j]].edges = NULL;
       }
-
-    } //for all points in this line
-  } //for all lines
-  this->UpdateProgress(0.25);
-
-  // now polygons and triangle strips-------------------------------
-  inPolys=input->GetPolys();
-  numPolys = inPolys->GetNumberOfCells();
-  inStrips=input->GetStrips();
-  numStrips = inStrips->GetNumberOfCells();
-
-  if ( numPolys > 0 || numStrips > 0 )
-  { //build cell structure
-    vtkCellArray *polys;
-    vtkIdType cellId;
-    int numNei, nei, edge;
-    vtkIdType numNeiPts;
-    vtkIdType *neiPts;
-    double normal[3], neiNormal[3];
-    vtkIdList *neighbors;
-
-    neighbors = vtkIdList::New();
-    neighbors->Allocate(VTK_CELL_SIZE);
-
-    inMesh = vtkPolyData::New();
-    inMesh->SetPoints(inPts);
-    inMesh->SetPolys(inPolys);
-    Mesh = inMesh;
-
-    if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
-    { // convert data to triangles
-      inMesh->SetStrips(inStrips);
-      toTris = vtkTriangleFilter::New();
-      toTris->SetInputData(inMesh);
-      toTris->Update();
-      Mesh = toTris->GetOutput();
     }
+    this->UpdateProgress(0.10);
 
-    Mesh->BuildLinks(); //to do neighborhood searching
-    polys = Mesh->GetPolys();
-    this->UpdateProgress(0.375);
-
-    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
-    cellId++)
+    // now check lines. Only manifold lines can be smoothed------------
+    for (inLines=input->GetLines(), inLines->InitTraversal();
+    inLines->GetNextCell(npts,pts); )
     {
-      for (i=0; i < npts; i++)
+      for (j=0; j<npts; j++)
       {
-        p1 = pts[i];
-        p2 = pts[(i+1)%npts];
-
-        if ( Verts[p1].edges == NULL )
-        {
-          Verts[p1].edges = vtkIdList::New();
-          Verts[p1].edges->Allocate(16,6);
-        }
-        if ( Verts[p2].edges == NULL )
+        if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
         {
-          Verts[p2].edges = vtkIdList::New();
-          Verts[p2].edges->Allocate(16,6);
+          if ( j == (npts-1) ) //end-of-line marked FIXED
+          {
+            Verts[pts[j]].type = VTK_FIXED_VERTEX;
+          }
+          else if ( j == 0 ) //beginning-of-line marked FIXED
+          {
+            Verts[pts[0]].type = VTK_FIXED_VERTEX;
+            inPts->GetPoint(pts[0],x2);
+            inPts->GetPoint(pts[1],x3);
+          }
+          else //is edge vertex (unless already edge vertex!)
+          {
+            Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
+            Verts[pts[j]].edges = vtkIdList::New();
+            Verts[pts[j]].edges->SetNumberOfIds(2);
+            Verts[pts[j]].edges->SetId(0,pts[j-1]);
+            Verts[pts[j]].edges->SetId(1,pts[j+1]);
+          }
+        } //if simple vertex
+
+        else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
+        { //multiply connected, becomes fixed!
+          Verts[pts[j]].type = VTK_FIXED_VERTEX;
+          Verts[pts[j]].edges->Delete();
+          Verts[pts[j]].edges = NULL;
         }
 
-        Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
-        numNei = neighbors->GetNumberOfIds();
+      } //for all points in this line
+    } //for all lines
+    this->UpdateProgress(0.25);
+
+    // now polygons and triangle strips-------------------------------
+    inPolys=input->GetPolys();
+    numPolys = inPolys->GetNumberOfCells();
+    inStrips=input->GetStrips();
+    numStrips = inStrips->GetNumberOfCells();
+
+    if ( numPolys > 0 || numStrips > 0 )
+    { //build cell structure
+      vtkCellArray *polys;
+      vtkIdType cellId;
+      int numNei, nei, edge;
+      vtkIdType numNeiPts;
+      vtkIdType *neiPts;
+      double normal[3], neiNormal[3];
+      vtkIdList *neighbors;
+
+      neighbors = vtkIdList::New();
+      neighbors->Allocate(VTK_CELL_SIZE);
+
+      inMesh = vtkPolyData::New();
+      inMesh->SetPoints(inPts);
+      inMesh->SetPolys(inPolys);
+      Mesh = inMesh;
+
+      if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
+      { // convert data to triangles
+        inMesh->SetStrips(inStrips);
+        toTris = vtkTriangleFilter::New();
+        toTris->SetInputData(inMesh);
+        toTris->Update();
+        Mesh = toTris->GetOutput();
+      }
 
-        edge = VTK_SIMPLE_VERTEX;
-        if ( numNei == 0 )
-        {
-          edge = VTK_BOUNDARY_EDGE_VERTEX;
-        }
+      Mesh->BuildLinks(); //to do neighborhood searching
+      polys = Mesh->GetPolys();
+      this->UpdateProgress(0.375);
 
-        else if ( numNei >= 2 )
+      for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
+      cellId++)
+      {
+        for (i=0; i < npts; i++)
         {
-          // check to make sure that this edge hasn't been marked already
-          for (j=0; j < numNei; j++)
+          p1 = pts[i];
+          p2 = pts[(i+1)%npts];
+
+          if ( Verts[p1].edges == NULL )
           {
-            if ( neighbors->GetId(j) < cellId )
-            {
-              break;
-            }
+            Verts[p1].edges = vtkIdList::New();
+            Verts[p1].edges->Allocate(16,6);
           }
-          if ( j >= numNei )
+          if ( Verts[p2].edges == NULL )
           {
-            edge = VTK_FEATURE_EDGE_VERTEX;
+            Verts[p2].edges = vtkIdList::New();
+            Verts[p2].edges->Allocate(16,6);
           }
-        }
 
-        else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
-        {
-          if (this->FeatureEdgeSmoothing)
+          Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
+          numNei = neighbors->GetNumberOfIds();
+
+          edge = VTK_SIMPLE_VERTEX;
+          if ( numNei == 0 )
           {
-            vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
-            Mesh->GetCellPoints(nei,numNeiPts,neiPts);
-            vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
+            edge = VTK_BOUNDARY_EDGE_VERTEX;
+          }
 
-            if (vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle)
+          else if ( numNei >= 2 )
+          {
+            // check to make sure that this edge hasn't been marked already
+            for (j=0; j < numNei; j++)
+            {
+              if ( neighbors->GetId(j) < cellId )
+              {
+                break;
+              }
+            }
+            if ( j >= numNei )
             {
               edge = VTK_FEATURE_EDGE_VERTEX;
             }
           }
-        }
-        else // a visited edge; skip rest of analysis
-        {
-          continue;
-        }
 
-        if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p1].edges->Reset();
-          Verts[p1].edges->InsertNextId(p2);
-          Verts[p1].type = edge;
-        }
-        else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
-        (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p1].edges->InsertNextId(p2);
-          if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+          else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
           {
-            Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
+            if (this->FeatureEdgeSmoothing)
+            {
+              vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
+              Mesh->GetCellPoints(nei,numNeiPts,neiPts);
+              vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
+
+              if (vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle)
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
+              }
+            }
+          }
+          else // a visited edge; skip rest of analysis
+          {
+            continue;
           }
-        }
 
-        if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p2].edges->Reset();
-          Verts[p2].edges->InsertNextId(p1);
-          Verts[p2].type = edge;
-        }
-        else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
-        (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p2].edges->InsertNextId(p1);
-          if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+          if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
+          {
+            Verts[p1].edges->Reset();
+            Verts[p1].edges->InsertNextId(p2);
+            Verts[p1].type = edge;
+          }
+          else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
+          (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
+          (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
+          {
+            Verts[p1].edges->InsertNextId(p2);
+            if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+            {
+              Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
+            }
+          }
+
+          if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
+          {
+            Verts[p2].edges->Reset();
+            Verts[p2].edges->InsertNextId(p1);
+            Verts[p2].type = edge;
+          }
+          else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
+          (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
+          (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
           {
-            Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
+            Verts[p2].edges->InsertNextId(p1);
+            if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+            {
+              Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
+            }
           }
         }
       }
-    }
 
-    inMesh->Delete();
-    if (toTris) {toTris->Delete();}
+      inMesh->Delete();
+      if (toTris) {toTris->Delete();}
 
-    neighbors->Delete();
-  }//if strips or polys
+      neighbors->Delete();
+    }//if strips or polys
 
-  this->UpdateProgress(0.50);
-
-  //post-process edge vertices to make sure we can smooth them
-  for (i=0; i<numPts; i++)
-  {
-    if ( Verts[i].type == VTK_SIMPLE_VERTEX )
-    {
-      numSimple++;
-    }
+    this->UpdateProgress(0.50);
 
-    else if ( Verts[i].type == VTK_FIXED_VERTEX )
+    //post-process edge vertices to make sure we can smooth them
+    for (i=0; i<numPts; i++)
     {
-      numFixed++;
-    }
-
-    else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
-    Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
-    { //see how many edges; if two, what the angle is
-
-      if ( !this->BoundarySmoothing &&
-      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      if ( Verts[i].type == VTK_SIMPLE_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numBEdges++;
+        numSimple++;
       }
 
-      else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
+      else if ( Verts[i].type == VTK_FIXED_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
         numFixed++;
       }
 
-      else //check angle between edges
-      {
-        inPts->GetPoint(Verts[i].edges->GetId(0),x1);
-        inPts->GetPoint(i,x2);
-        inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+      else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
+      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      { //see how many edges; if two, what the angle is
 
-        for (k=0; k<3; k++)
+        if ( !this->BoundarySmoothing &&
+        Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
         {
-          l1[k] = x2[k] - x1[k];
-          l2[k] = x3[k] - x2[k];
+          Verts[i].type = VTK_FIXED_VERTEX;
+          numBEdges++;
         }
-        if ( vtkMath::Normalize(l1) >= 0.0 &&
-             vtkMath::Normalize(l2) >= 0.0 &&
-             vtkMath::Dot(l1,l2) < CosEdgeAngle)
+
+        else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
         {
-          numFixed++;
           Verts[i].type = VTK_FIXED_VERTEX;
+          numFixed++;
         }
-        else
+
+        else //check angle between edges
         {
-          if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+          inPts->GetPoint(Verts[i].edges->GetId(0),x1);
+          inPts->GetPoint(i,x2);
+          inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+
+          for (k=0; k<3; k++)
+          {
+            l1[k] = x2[k] - x1[k];
+            l2[k] = x3[k] - x2[k];
+          }
+          if ( vtkMath::Normalize(l1) >= 0.0 &&
+               vtkMath::Normalize(l2) >= 0.0 &&
+               vtkMath::Dot(l1,l2) < CosEdgeAngle)
           {
-            numFEdges++;
+            numFixed++;
+            Verts[i].type = VTK_FIXED_VERTEX;
           }
           else
           {
-            numBEdges++;
+            if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+            {
+              numFEdges++;
+            }
+            else
+            {
+              numBEdges++;
+            }
           }
-        }
-      }//if along edge
-    }//if edge vertex
-  }//for all points
+        }//if along edge
+      }//if edge vertex
+    }//for all points
+  }
 
   vtkDebugMacro(<<"Found\n\t" << numSimple << " simple vertices\n\t"
                 << numFEdges << " feature edge vertices\n\t"
@@ -679,7 +815,21 @@ int vtkSmoothPolyDataFilter::RequestData(
     }
   }
 
-  if (newPts->GetDataType() == VTK_DOUBLE)
+  if (smp)
+  {
+    if (newPts->GetDataType() == VTK_DOUBLE)
+    {
+      vtkSPDF_MovePointsSMP<double>(this, topology, newPts,
+                                    this->RelaxationFactor, conv);
+    }
+    else
+    {
+      vtkSPDF_MovePointsSMP<float>(this, topology, newPts,
+                                   static_cast<float>(this->RelaxationFactor),
+                                   static_cast<float>(conv));
+    }
+  }
+  else if (newPts->GetDataType() == VTK_DOUBLE)
   {
     vtkSPDF_InternalParams<double> params = { this, this->NumberOfIterations, newPts,
                                               this->RelaxationFactor, conv, numPts,
@@ -754,15 +904,18 @@ int vtkSmoothPolyDataFilter::RequestData(
   output->SetStrips(input->GetStrips());
 
   //free up connectivity storage
-  for (i=0; i<numPts; i++)
+  if (Verts)
   {
-    if ( Verts[i].edges != NULL )
+    for (i=0; i<numPts; i++)
     {
-      Verts[i].edges->Delete();
-      Verts[i].edges = NULL;
+      if ( Verts[i].edges != NULL )
+      {
+        Verts[i].edges->Delete();
+        Verts[i].edges = NULL;
+      }
     }
+    delete [] Verts;
   }
-  delete [] Verts;
 
   return 1;
 }
@@ -805,4 +958,5 @@ void vtkSmoothPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
   }
 
   os << indent << "Output Points Precision: " << this->OutputPointsPrecision << "\n";
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
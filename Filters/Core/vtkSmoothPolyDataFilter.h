@@ -77,6 +77,15 @@
  * second input: the Source. If defined, the input mesh is constrained to
  * lie on the surface defined by the Source ivar.
  *
+ * When EnableSMP is on, the topological analysis and the smoothing passes
+ * are done in parallel (via vtkSMPTools). The neighbors of every point are
+ * then gathered once in a compact array, and each pass moves all the points
+ * from their positions after the previous pass (Jacobi iterations) instead
+ * of using the points already moved during the pass (Gauss-Seidel
+ * iterations). The results thus differ slightly from the serial ones, but
+ * they do not depend on the number of threads. Constrained smoothing (when
+ * a Source is given) always runs serially.
+ *
  *
  * @warning
  * The Laplacian operation reduces high frequency information in the geometry
@@ -215,6 +224,16 @@ public:
   vtkGetMacro(OutputPointsPrecision,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded smoothing (see the class documentation).
+   * This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkSmoothPolyDataFilter();
   ~vtkSmoothPolyDataFilter() VTK_OVERRIDE {}
@@ -232,6 +251,7 @@ protected:
   int GenerateErrorScalars;
   int GenerateErrorVectors;
   int OutputPointsPrecision;
+  int EnableSMP;
 
   vtkSmoothPoints *SmoothPoints;
 private:
@@ -0,0 +1,479 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSmoothingTopology.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkSmoothingTopology.h"
+
+#include "vtkCellArray.h"
+#include "vtkIdList.h"
+#include "vtkMath.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolygon.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkTriangleFilter.h"
+
+#include <algorithm>
+
+namespace
+{
+// The classification of a polygon edge; SKIP_EDGE marks the edges that were
+// already seen from a neighbor polygon.
+const char SKIP_EDGE = -1;
+
+// Classify the edges of the polygons of the mesh. The type of the edge
+// starting at the i-th point of a polygon is stored at the index of this
+// point in the connectivity array.
+struct ClassifyEdges
+{
+  vtkPolyData *Mesh;
+  vtkPoints *Points;
+  const vtkIdType *Connectivity;
+  char *EdgeTypes;
+  bool FeatureEdgeSmoothing;
+  double CosFeatureAngle;
+  bool NonManifoldSmoothing;
+  vtkSMPThreadLocalObject<vtkIdList> Neighbors;
+
+  ClassifyEdges(vtkPolyData *mesh, vtkPoints *points, char *edgeTypes,
+                bool featureEdgeSmoothing, double cosFeatureAngle,
+                bool nonManifoldSmoothing) :
+    Mesh(mesh), Points(points),
+    Connectivity(mesh->GetPolys()->GetPointer()), EdgeTypes(edgeTypes),
+    FeatureEdgeSmoothing(featureEdgeSmoothing),
+    CosFeatureAngle(cosFeatureAngle),
+    NonManifoldSmoothing(nonManifoldSmoothing)
+  {
+  }
+
+  void Initialize()
+  {
+    this->Neighbors.Local()->Allocate(VTK_CELL_SIZE);
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdList *neighbors = this->Neighbors.Local();
+    vtkIdType npts, *pts, numNeiPts, *neiPts, nei;
+    double normal[3], neiNormal[3];
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      char *edgeTypes = this->EdgeTypes + (pts - this->Connectivity);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        this->Mesh->GetCellEdgeNeighbors(cellId, pts[i], pts[(i + 1) % npts],
+                                         neighbors);
+        vtkIdType numNei = neighbors->GetNumberOfIds();
+
+        char edge = vtkSmoothingTopology::SIMPLE_VERTEX;
+        if (numNei == 0)
+        {
+          edge = vtkSmoothingTopology::BOUNDARY_EDGE_VERTEX;
+        }
+        else if (numNei >= 2)
+        {
+          if (!this->NonManifoldSmoothing)
+          {
+            // check to make sure that this edge hasn't been marked already
+            vtkIdType j;
+            for (j = 0; j < numNei; ++j)
+            {
+              if (neighbors->GetId(j) < cellId)
+              {
+                break;
+              }
+            }
+            if (j >= numNei)
+            {
+              edge = vtkSmoothingTopology::FEATURE_EDGE_VERTEX;
+            }
+          }
+        }
+        else if (numNei == 1 && (nei = neighbors->GetId(0)) > cellId)
+        {
+          if (this->FeatureEdgeSmoothing)
+          {
+            vtkPolygon::ComputeNormal(this->Points, npts, pts, normal);
+            this->Mesh->GetCellPoints(nei, numNeiPts, neiPts);
+            vtkPolygon::ComputeNormal(this->Points, numNeiPts, neiPts,
+                                      neiNormal);
+            if (vtkMath::Dot(normal, neiNormal) <= this->CosFeatureAngle)
+            {
+              edge = vtkSmoothingTopology::FEATURE_EDGE_VERTEX;
+            }
+          }
+        }
+        else // a visited edge
+        {
+          edge = SKIP_EDGE;
+        }
+        edgeTypes[i] = edge;
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+
+// Per point counts of the vertex kinds.
+struct VertexCounts
+{
+  vtkIdType Simple;
+  vtkIdType Fixed;
+  vtkIdType FeatureEdges;
+  vtkIdType BoundaryEdges;
+};
+
+// Replays, point by point, the serial analysis of the polygon edges: the
+// edges using a point are visited in the order of the polygons, which is
+// the order of the cell links.
+struct AnalyzePoints
+{
+  vtkPolyData *Mesh;
+  vtkPoints *Points;
+  const vtkIdType *Connectivity;
+  const char *EdgeTypes;
+  const vtkIdType *LineNeighbors;
+  double CosEdgeAngle;
+  bool BoundarySmoothing;
+  const char *InitialTypes;
+  char *Types;
+  vtkIdType *Counts;
+  const vtkIdType *Offsets;
+  vtkIdType *Neighbors;
+  vtkSMPThreadLocal<std::vector<vtkIdType> > Edges;
+  vtkSMPThreadLocal<VertexCounts> LocalCounts;
+
+  AnalyzePoints(vtkPolyData *mesh, vtkPoints *points, const char *edgeTypes,
+                const vtkIdType *lineNeighbors, double cosEdgeAngle,
+                bool boundarySmoothing, const char *initialTypes,
+                char *types, vtkIdType *counts) :
+    Mesh(mesh), Points(points),
+    Connectivity(mesh ? mesh->GetPolys()->GetPointer() : NULL),
+    EdgeTypes(edgeTypes), LineNeighbors(lineNeighbors),
+    CosEdgeAngle(cosEdgeAngle), BoundarySmoothing(boundarySmoothing),
+    InitialTypes(initialTypes), Types(types), Counts(counts), Offsets(NULL),
+    Neighbors(NULL)
+  {
+  }
+
+  void Initialize()
+  {
+    VertexCounts &counts = this->LocalCounts.Local();
+    counts.Simple = counts.Fixed = 0;
+    counts.FeatureEdges = counts.BoundaryEdges = 0;
+  }
+
+  // Collects the neighbors of ptId, updating its type.
+  void Collect(vtkIdType ptId, char &type, std::vector<vtkIdType> &edges)
+  {
+    edges.clear();
+    if (type == vtkSmoothingTopology::FEATURE_EDGE_VERTEX)
+    {
+      // interior point of a line
+      edges.push_back(this->LineNeighbors[2 * ptId]);
+      edges.push_back(this->LineNeighbors[2 * ptId + 1]);
+    }
+    if (!this->Mesh)
+    {
+      return;
+    }
+
+    unsigned short ncells;
+    vtkIdType *cells, npts, *pts;
+    this->Mesh->GetPointCells(ptId, ncells, cells);
+    for (unsigned short c = 0; c < ncells; ++c)
+    {
+      if (c > 0 && cells[c] == cells[c - 1])
+      {
+        continue; // point repeated in the polygon, already visited
+      }
+      this->Mesh->GetCellPoints(cells[c], npts, pts);
+      const char *edgeTypes = this->EdgeTypes + (pts - this->Connectivity);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        char edge = edgeTypes[i];
+        if (edge == SKIP_EDGE)
+        {
+          continue;
+        }
+        vtkIdType p1 = pts[i];
+        vtkIdType p2 = pts[(i + 1) % npts];
+        if (p1 == ptId)
+        {
+          this->Insert(edge, p2, type, edges);
+        }
+        if (p2 == ptId)
+        {
+          this->Insert(edge, p1, type, edges);
+        }
+      }
+    }
+  }
+
+  static void Insert(char edge, vtkIdType neighbor, char &type,
+                     std::vector<vtkIdType> &edges)
+  {
+    if (edge && type == vtkSmoothingTopology::SIMPLE_VERTEX)
+    {
+      edges.clear();
+      edges.push_back(neighbor);
+      type = edge;
+    }
+    else if ((edge && type == vtkSmoothingTopology::BOUNDARY_EDGE_VERTEX) ||
+             (edge && type == vtkSmoothingTopology::FEATURE_EDGE_VERTEX) ||
+             (!edge && type == vtkSmoothingTopology::SIMPLE_VERTEX))
+    {
+      edges.push_back(neighbor);
+      if (type && edge == vtkSmoothingTopology::BOUNDARY_EDGE_VERTEX)
+      {
+        type = vtkSmoothingTopology::BOUNDARY_EDGE_VERTEX;
+      }
+    }
+  }
+
+  // Make sure that the edge vertices can be smoothed.
+  void PostProcess(vtkIdType ptId, char &type,
+                   const std::vector<vtkIdType> &edges, VertexCounts &counts)
+  {
+    if (type == vtkSmoothingTopology::SIMPLE_VERTEX)
+    {
+      counts.Simple++;
+    }
+    else if (type == vtkSmoothingTopology::FIXED_VERTEX)
+    {
+      counts.Fixed++;
+    }
+    else if (!this->BoundarySmoothing &&
+             type == vtkSmoothingTopology::BOUNDARY_EDGE_VERTEX)
+    {
+      type = vtkSmoothingTopology::FIXED_VERTEX;
+      counts.BoundaryEdges++;
+    }
+    else if (edges.size() != 2)
+    {
+      type = vtkSmoothingTopology::FIXED_VERTEX;
+      counts.Fixed++;
+    }
+    else //check angle between edges
+    {
+      double x1[3], x2[3], x3[3], l1[3], l2[3];
+      this->Points->GetPoint(edges[0], x1);
+      this->Points->GetPoint(ptId, x2);
+      this->Points->GetPoint(edges[1], x3);
+      for (int k = 0; k < 3; ++k)
+      {
+        l1[k] = x2[k] - x1[k];
+        l2[k] = x3[k] - x2[k];
+      }
+      if (vtkMath::Normalize(l1) >= 0.0 && vtkMath::Normalize(l2) >= 0.0 &&
+          vtkMath::Dot(l1, l2) < this->CosEdgeAngle)
+      {
+        type = vtkSmoothingTopology::FIXED_VERTEX;
+        counts.Fixed++;
+      }
+      else if (type == vtkSmoothingTopology::FEATURE_EDGE_VERTEX)
+      {
+        counts.FeatureEdges++;
+      }
+      else
+      {
+        counts.BoundaryEdges++;
+      }
+    }
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    std::vector<vtkIdType> &edges = this->Edges.Local();
+    if (!this->Neighbors)
+    {
+      // first pass: classify the points and count their neighbors
+      VertexCounts &counts = this->LocalCounts.Local();
+      for ( ; ptId < endPtId; ++ptId)
+      {
+        char type = this->InitialTypes[ptId];
+        this->Collect(ptId, type, edges);
+        this->PostProcess(ptId, type, edges, counts);
+        this->Types[ptId] = type;
+        this->Counts[ptId] = static_cast<vtkIdType>(edges.size());
+      }
+    }
+    else
+    {
+      // second pass: collect the neighbors again, in place
+      for ( ; ptId < endPtId; ++ptId)
+      {
+        if (this->Offsets[ptId + 1] > this->Offsets[ptId])
+        {
+          char type = this->InitialTypes[ptId];
+          this->Collect(ptId, type, edges);
+          std::copy(edges.begin(), edges.end(),
+                    this->Neighbors + this->Offsets[ptId]);
+        }
+      }
+    }
+  }
+
+  void Reduce()
+  {
+  }
+};
+}
+
+//----------------------------------------------------------------------------
+vtkSmoothingTopology::vtkSmoothingTopology() :
+  NumberOfSimpleVertices(0), NumberOfFixedVertices(0),
+  NumberOfFeatureEdgeVertices(0), NumberOfBoundaryEdgeVertices(0)
+{
+}
+
+//----------------------------------------------------------------------------
+vtkSmoothingTopology::~vtkSmoothingTopology()
+{
+}
+
+//----------------------------------------------------------------------------
+void vtkSmoothingTopology::Build(vtkPolyData *input, bool featureEdgeSmoothing,
+                                 double cosFeatureAngle, double cosEdgeAngle,
+                                 bool boundarySmoothing,
+                                 bool nonManifoldSmoothing)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkPoints *inPts = input->GetPoints();
+  vtkIdType npts = 0;
+  vtkIdType *pts = 0;
+
+  // The verts and lines are few in general: they are analyzed serially to
+  // get the initial type of the points.
+  std::vector<char> initialTypes(numPts, SIMPLE_VERTEX);
+  std::vector<vtkIdType> lineNeighbors;
+
+  // check vertices first. Vertices are never smoothed
+  vtkCellArray *inVerts = input->GetVerts();
+  for (inVerts->InitTraversal(); inVerts->GetNextCell(npts, pts); )
+  {
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      initialTypes[pts[j]] = FIXED_VERTEX;
+    }
+  }
+
+  // now check lines. Only manifold lines can be smoothed
+  vtkCellArray *inLines = input->GetLines();
+  if (inLines->GetNumberOfCells() > 0)
+  {
+    lineNeighbors.resize(2 * numPts);
+  }
+  for (inLines->InitTraversal(); inLines->GetNextCell(npts, pts); )
+  {
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      if (initialTypes[pts[j]] == SIMPLE_VERTEX)
+      {
+        if (j == 0 || j == (npts - 1)) // end of line marked FIXED
+        {
+          initialTypes[pts[j]] = FIXED_VERTEX;
+        }
+        else // is edge vertex
+        {
+          initialTypes[pts[j]] = FEATURE_EDGE_VERTEX;
+          lineNeighbors[2 * pts[j]] = pts[j - 1];
+          lineNeighbors[2 * pts[j] + 1] = pts[j + 1];
+        }
+      }
+      else if (initialTypes[pts[j]] == FEATURE_EDGE_VERTEX)
+      { // multiply connected, becomes fixed!
+        initialTypes[pts[j]] = FIXED_VERTEX;
+      }
+    }
+  }
+
+  // now polygons and triangle strips
+  vtkCellArray *inPolys = input->GetPolys();
+  vtkCellArray *inStrips = input->GetStrips();
+  vtkPolyData *inMesh = NULL;
+  vtkPolyData *mesh = NULL;
+  vtkTriangleFilter *toTris = NULL;
+  std::vector<char> edgeTypes;
+  if (inPolys->GetNumberOfCells() > 0 || inStrips->GetNumberOfCells() > 0)
+  {
+    inMesh = vtkPolyData::New();
+    inMesh->SetPoints(inPts);
+    inMesh->SetPolys(inPolys);
+    mesh = inMesh;
+    if (inStrips->GetNumberOfCells() > 0)
+    { // convert data to triangles
+      inMesh->SetStrips(inStrips);
+      toTris = vtkTriangleFilter::New();
+      toTris->SetInputData(inMesh);
+      toTris->Update();
+      mesh = toTris->GetOutput();
+    }
+
+    // The links are built before threading since the neighborhood searches
+    // need them.
+    mesh->BuildLinks();
+    vtkCellArray *polys = mesh->GetPolys();
+    edgeTypes.resize(polys->GetNumberOfConnectivityEntries());
+    ClassifyEdges classify(mesh, inPts, &edgeTypes[0], featureEdgeSmoothing,
+                           cosFeatureAngle, nonManifoldSmoothing);
+    vtkSMPTools::For(0, polys->GetNumberOfCells(), classify);
+  }
+
+  // Classify the points and count their neighbors, then fill the neighbor
+  // lists once their offsets are known.
+  this->Types.resize(numPts);
+  this->Offsets.resize(numPts + 1);
+  AnalyzePoints analyze(mesh, inPts, edgeTypes.empty() ? NULL : &edgeTypes[0],
+                        lineNeighbors.empty() ? NULL : &lineNeighbors[0],
+                        cosEdgeAngle, boundarySmoothing, &initialTypes[0],
+                        &this->Types[0], &this->Offsets[0]);
+  vtkSMPTools::For(0, numPts, analyze);
+
+  this->NumberOfSimpleVertices = this->NumberOfFixedVertices = 0;
+  this->NumberOfFeatureEdgeVertices = this->NumberOfBoundaryEdgeVertices = 0;
+  for (vtkSMPThreadLocal<VertexCounts>::iterator iter =
+         analyze.LocalCounts.begin(); iter != analyze.LocalCounts.end(); ++iter)
+  {
+    this->NumberOfSimpleVertices += iter->Simple;
+    this->NumberOfFixedVertices += iter->Fixed;
+    this->NumberOfFeatureEdgeVertices += iter->FeatureEdges;
+    this->NumberOfBoundaryEdgeVertices += iter->BoundaryEdges;
+  }
+
+  this->Offsets[numPts] = vtkSMPTools::ExclusiveScan(
+    this->Offsets.begin(), this->Offsets.begin() + numPts,
+    this->Offsets.begin(), static_cast<vtkIdType>(0));
+  this->Neighbors.resize(this->Offsets[numPts]);
+  if (!this->Neighbors.empty())
+  {
+    analyze.Offsets = &this->Offsets[0];
+    analyze.Neighbors = &this->Neighbors[0];
+    vtkSMPTools::For(0, numPts, analyze);
+  }
+
+  if (inMesh)
+  {
+    inMesh->Delete();
+  }
+  if (toTris)
+  {
+    toTris->Delete();
+  }
+}
@@ -0,0 +1,100 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkSmoothingTopology.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkSmoothingTopology
+ * @brief   A utility class used by the mesh smoothing filters
+ *
+ * This is a simple utility class that performs, in parallel, the topological
+ * analysis of the mesh smoothing filters. Every point of a polydata is
+ * classified as a simple, fixed, feature edge or boundary edge vertex, and
+ * gets the list of the points it is smoothed with. The lists are stored in
+ * a compact (CSR) layout: the neighbors of point i are the ids
+ * [Offsets[i], Offsets[i+1]) of Neighbors. The classification and the order
+ * of the neighbors are the same as in the serial analysis of the filters.
+ * @sa
+ * vtkSmoothPolyDataFilter vtkWindowedSincPolyDataFilter
+*/
+
+#ifndef vtkSmoothingTopology_h
+#define vtkSmoothingTopology_h
+
+#include "vtkFiltersCoreModule.h" // For export macro
+#include "vtkType.h" // For vtkIdType
+
+#include <vector> // For the neighbor lists
+
+class vtkPolyData;
+
+class VTKFILTERSCORE_EXPORT vtkSmoothingTopology
+{
+public:
+  enum VertexType
+  {
+    SIMPLE_VERTEX = 0,
+    FIXED_VERTEX = 1,
+    FEATURE_EDGE_VERTEX = 2,
+    BOUNDARY_EDGE_VERTEX = 3
+  };
+
+  vtkSmoothingTopology();
+  ~vtkSmoothingTopology();
+
+  /**
+   * Analyze the topology of the verts, lines, polys and strips of input.
+   * The parameters have the meaning of the filter ivars with the same names;
+   * the angles are given by their cosine.
+   */
+  void Build(vtkPolyData *input, bool featureEdgeSmoothing,
+             double cosFeatureAngle, double cosEdgeAngle,
+             bool boundarySmoothing, bool nonManifoldSmoothing);
+
+  /**
+   * The type of a point after the analysis (one of VertexType).
+   */
+  char GetType(vtkIdType ptId) const
+  {
+    return this->Types[ptId];
+  }
+
+  /**
+   * The points a point is smoothed with.
+   */
+  vtkIdType GetNumberOfNeighbors(vtkIdType ptId) const
+  {
+    return this->Offsets[ptId + 1] - this->Offsets[ptId];
+  }
+  const vtkIdType *GetNeighbors(vtkIdType ptId) const
+  {
+    return this->Neighbors.empty() ? 0 :
+      &this->Neighbors[0] + this->Offsets[ptId];
+  }
+
+  // The number of points of each kind, for debugging purposes.
+  vtkIdType NumberOfSimpleVertices;
+  vtkIdType NumberOfFixedVertices;
+  vtkIdType NumberOfFeatureEdgeVertices;
+  vtkIdType NumberOfBoundaryEdgeVertices;
+
+private:
+  vtkSmoothingTopology(const vtkSmoothingTopology&) VTK_DELETE_FUNCTION;
+  vtkSmoothingTopology& operator=(const vtkSmoothingTopology&) VTK_DELETE_FUNCTION;
+
+  std::vector<char> Types;
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Neighbors;
+};
+
+#endif
+// VTK-HeaderTest-Exclude: vtkSmoothingTopology.h
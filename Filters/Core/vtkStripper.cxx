@@ -24,9 +24,75 @@
 #include "vtkCellData.h"
 #include "vtkPolyData.h"
 #include "vtkIdTypeArray.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
 
 vtkStandardNewMacro(vtkStripper);
 
+namespace
+{
+// For every triangle of the mesh, find the first cell other than itself
+// that uses each of its edges (t[k], t[k+1]). This is the cell the serial
+// code used to get from vtkPolyData::GetCellEdgeNeighbors; computing it up
+// front keeps the greedy strip construction free of neighbor searches.
+struct ComputeEdgeNeighbors
+{
+  vtkPolyData *Mesh;
+  vtkIdType *Neighbors;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts;
+    unsigned short ncells1, ncells2;
+    vtkIdType *cells1, *cells2;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      vtkIdType *neighbors = this->Neighbors + 3 * cellId;
+      neighbors[0] = neighbors[1] = neighbors[2] = -1;
+      if (this->Mesh->GetCellType(cellId) != VTK_TRIANGLE)
+      {
+        continue;
+      }
+      this->Mesh->GetCellPoints(cellId, npts, pts);
+      for (int k = 0; k < 3; ++k)
+      {
+        this->Mesh->GetPointCells(pts[k], ncells1, cells1);
+        this->Mesh->GetPointCells(pts[(k + 1) % 3], ncells2, cells2);
+        for (unsigned short j = 0; j < ncells1; ++j)
+        {
+          if (cells1[j] != cellId &&
+              std::find(cells2, cells2 + ncells2, cells1[j]) != cells2 + ncells2)
+          {
+            neighbors[k] = cells1[j];
+            break;
+          }
+        }
+      }
+    }
+  }
+};
+
+// Look up the neighbor of triangle triPts across the edge (p1, p2).
+inline vtkIdType GetEdgeNeighbor(const vtkIdType *neighbors,
+                                 const vtkIdType *triPts,
+                                 vtkIdType p1, vtkIdType p2)
+{
+  for (int k = 0; k < 3; ++k)
+  {
+    vtkIdType a = triPts[k];
+    vtkIdType b = triPts[(k + 1) % 3];
+    if ((a == p1 && b == p2) || (a == p2 && b == p1))
+    {
+      return neighbors[k];
+    }
+  }
+  return -1;
+}
+}
+
 // Construct object with MaximumLength set to 1000.
 vtkStripper::vtkStripper()
 {
@@ -60,7 +126,7 @@ int vtkStripper::RequestData(
   vtkIdType numLinePts = 0;
   vtkIdList *cellIds;
   int foundOne;
-  vtkIdType *pts, neighbor=0;
+  vtkIdType *pts, neighbor=0, next=0;
   vtkPolyData *mesh;
   char *visited;
   vtkIdType numStripPts = 0;
@@ -107,6 +173,14 @@ int vtkStripper::RequestData(
     return 1;
   }
 
+  // The triangle neighbors across each edge, found in parallel.
+  std::vector<vtkIdType> edgeNeighbors(3 * numCells);
+  if ( numCells > 0 )
+  {
+    ComputeEdgeNeighbors computeEdgeNeighbors = {mesh, &edgeNeighbors[0]};
+    vtkSMPTools::For(0, numCells, computeEdgeNeighbors);
+  }
+
   pts = new vtkIdType[this->MaximumLength + 2]; //working array
   cellIds = vtkIdList::New();
   cellIds->Allocate(this->MaximumLength + 2);
@@ -255,9 +329,8 @@ int vtkStripper::RequestData(
           pts[1] = triPts[i];
           pts[2] = triPts[(i+1)%3];
 
-          mesh->GetCellEdgeNeighbors(cellId, pts[1], pts[2], cellIds);
-          if ( cellIds->GetNumberOfIds() > 0 &&
-          !visited[neighbor=cellIds->GetId(0)] &&
+          neighbor = edgeNeighbors[3*cellId + i];
+          if ( neighbor >= 0 && !visited[neighbor] &&
           mesh->GetCellType(neighbor) == VTK_TRIANGLE )
           {
             pts[0] = triPts[(i+2)%3];
@@ -285,6 +358,7 @@ int vtkStripper::RequestData(
         {
           //  Have a neighbor.  March along grabbing new points
           //
+          next = neighbor;
           if (this->PassCellDataAsFieldData)
           {
             newfdStrips->InsertNextTuple(cellId, cd);
@@ -318,8 +392,8 @@ int vtkStripper::RequestData(
             if (i < 3)
             {
               pts[numPts] = triPts[i];
-              mesh->GetCellEdgeNeighbors(neighbor, pts[numPts],
-                                         pts[numPts-1], cellIds);
+              next = GetEdgeNeighbor(&edgeNeighbors[3*neighbor], triPts,
+                                     pts[numPts], pts[numPts-1]);
               numPts++;
             }
 
@@ -330,10 +404,10 @@ int vtkStripper::RequestData(
 
             // note: if updates value of neighbor
             // Note2: for a degenerate triangle this test will
-            // correctly fail because the visited[neighbor] will
-            // now be visited
-            if ( cellIds->GetNumberOfIds() <= 0 ||
-                 visited[neighbor=cellIds->GetId(0)] ||
+            // correctly fail because next is still the (now visited)
+            // neighbor
+            if ( next < 0 ||
+                 visited[neighbor=next] ||
                  mesh->GetCellType(neighbor) != VTK_TRIANGLE ||
                  numPts >= (this->MaximumLength+2) )
             {
@@ -514,120 +588,61 @@ int vtkStripper::RequestData(
       vtkSmartPointer<vtkCellArray> compressedLines = vtkSmartPointer<
           vtkCellArray>::New();
 
-      bool* used = new bool[newLines->GetNumberOfCells()];
-      for (i = 0; i < newLines->GetNumberOfCells(); i++)
-      {
-        used[i] = 0;
-      }
-
-      bool done = false;
-      while (!done)
+      // Every joined line starts with the first line not used yet and
+      // grows with the lines that follow it as long as they adjoin one of
+      // its ends, so a single traversal of the lines is enough.
+      std::deque<vtkIdType> line;
+      vtkIdType n;
+      vtkIdType* p;
+      newLines->InitTraversal();
+      while (newLines->GetNextCell(n, p))
       {
-        int out_n = 0;
-        vtkIdType* out_p =
-            new vtkIdType[newLines->GetNumberOfConnectivityEntries()];
-
-        newLines->InitTraversal();
-        int id = -1;
-        vtkIdType n;
-        vtkIdType* p;
-
-        // Find a line from the original set that has not yet been used
-        do
+        if (!line.empty())
         {
-          if (newLines->GetNextCell(n, p) == 0)
+          // Here's the start and end of our current line
+          vtkIdType ca = line.front();
+          vtkIdType cb = line.back();
+          vtkIdType ta = p[0];
+          vtkIdType tb = p[n - 1];
+          if ((ca == ta) || (ca == tb) || (cb == ta) || (cb == tb))
           {
-            done = true;
-          }
-          id++;
-        }
-        while (!done && (used[id] == 1));
-
-        if (done == false)
-        {
-          // Write it into our output line
-          memcpy(out_p + out_n, p, n * sizeof(vtkIdType));
-          out_n += n;
-          used[id] = 1;
-
-          // Now add any unused lines that adjoin this current line
-          bool finished_new_line = false;
-          while (!finished_new_line)
-          {
-            // Here's the start and end of our current line
-            vtkIdType ca = out_p[0];
-            vtkIdType cb = out_p[out_n - 1];
-
-            vtkIdType ta;
-            vtkIdType tb;
-            bool found = false;
-
-            // Look for any lines which adjoin this one
-            while (!finished_new_line && !found)
+            // Add the new line to our current one, before or after it,
+            // forwards or backwards as appropriate
+            bool reverse = (ca == ta || cb == tb);
+            if (ca == ta || ca == tb)
             {
-              if (newLines->GetNextCell(n, p) == 0)
+              for (vtkIdType x = 0; x < n; x++)
               {
-                finished_new_line = true;
+                line.push_front(reverse ? p[x] : p[n - x - 1]);
               }
-              id++;
-
-              if (!finished_new_line && (used[id] == 0))
+            }
+            else
+            {
+              for (vtkIdType x = 0; x < n; x++)
               {
-                ta = p[0];
-                tb = p[n - 1];
-                if ((ca == ta) || (ca == tb) || (cb == ta) || (cb == tb))
-                {
-                  found = true;
-                  // Here's a line which adjoins this one somehow; add it in
-                  vtkIdType* add_to;
-
-                  if (ca == ta || ca == tb)
-                  {
-                    // This line will go in before our current one; move
-                    // the current one forwards to make room
-                    memmove(out_p + n, out_p, out_n * sizeof(vtkIdType));
-                    add_to = out_p;
-                  }
-                  else
-                  {
-                    // This line will go in after our current one
-                    add_to = out_p + out_n;
-                  }
-
-                  // Add the new line to our current one, either forwards
-                  // or backwards as appropriate
-                  if (ca == ta || cb == tb)
-                  {
-                    for (vtkIdType x = 0; x < n; x++)
-                    {
-                      add_to[x] = p[n - x - 1];
-                    }
-                  }
-                  else
-                  {
-                    memcpy(add_to, p, n * sizeof(vtkIdType));
-                  }
-                  out_n += n;
-                  used[id] = 1;
-                }
-                else
-                {
-                  finished_new_line = true;
-                }
+                line.push_back(reverse ? p[n - x - 1] : p[x]);
               }
             }
+            continue;
           }
 
           // We've finished this new line, so add it to the list
-          compressedLines->InsertNextCell(out_n, out_p);
+          std::vector<vtkIdType> out_p(line.begin(), line.end());
+          compressedLines->InsertNextCell(
+            static_cast<vtkIdType>(out_p.size()), &out_p[0]);
+          line.clear();
         }
-
-        delete [] out_p;
+        line.assign(p, p + n);
+      }
+      if (!line.empty())
+      {
+        std::vector<vtkIdType> out_p(line.begin(), line.end());
+        compressedLines->InsertNextCell(
+          static_cast<vtkIdType>(out_p.size()), &out_p[0]);
       }
 
       compressedLines->Squeeze();
       output->SetLines(compressedLines);
-      delete [] used;
     }
     else
     {
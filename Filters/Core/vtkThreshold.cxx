@@ -14,21 +14,392 @@
 =========================================================================*/
 #include "vtkThreshold.h"
 
-#include "vtkCell.h"
+#include "vtkArrayDispatch.h"
+#include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkDataArrayAccessor.h"
 #include "vtkIdList.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkMath.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
 
 vtkStandardNewMacro(vtkThreshold);
 
+//----------------------------------------------------------------------------
+// Evaluate the threshold criterion for each cell. The size of each cell in
+// the output connectivity list (number of points plus one) is recorded, or
+// zero if the cell is not extracted, as well as whether the cell is kept.
+class vtkThresholdFunctor
+{
+public:
+  vtkThreshold *Filter;
+  vtkDataSet *Input;
+  vtkDataArray *Scalars;
+  bool UsePointScalars;
+  vtkIdType *CellSizes;
+  vtkIdType *CellMap;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  vtkThresholdFunctor(vtkThreshold *filter, vtkDataSet *input,
+                      vtkDataArray *scalars, bool usePointScalars,
+                      vtkIdType *cellSizes, vtkIdType *cellMap) :
+    Filter(filter), Input(input), Scalars(scalars),
+    UsePointScalars(usePointScalars), CellSizes(cellSizes), CellMap(cellMap)
+  {
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkThreshold *self = this->Filter;
+    vtkIdList *cellPts = this->CellPts.Local();
+    vtkIdType i, numCellPts;
+    int keepCell;
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      this->Input->GetCellPoints(cellId, cellPts);
+      numCellPts = cellPts->GetNumberOfIds();
+
+      if ( this->UsePointScalars )
+      {
+        if (self->AllScalars)
+        {
+          keepCell = 1;
+          for ( i=0; keepCell && (i < numCellPts); i++)
+          {
+            keepCell = self->EvaluateComponents( this->Scalars,
+                                                 cellPts->GetId(i) );
+          }
+        }
+        else
+        {
+          if(!self->UseContinuousCellRange)
+          {
+            keepCell = 0;
+            for ( i=0; (!keepCell) && (i < numCellPts); i++)
+            {
+              keepCell = self->EvaluateComponents( this->Scalars,
+                                                   cellPts->GetId(i) );
+            }
+          }
+          else
+          {
+            keepCell = self->EvaluateCell(this->Scalars, cellPts,
+                                          static_cast<int>(numCellPts));
+          }
+        }
+      }
+      else //use cell scalars
+      {
+        keepCell = self->EvaluateComponents( this->Scalars, cellId );
+      }
+
+      // satisfied thresholding (also non-empty cell, i.e. not VTK_EMPTY_CELL)
+      keepCell = ( numCellPts > 0 && keepCell );
+      this->CellSizes[cellId] = ( keepCell ? numCellPts + 1 : 0 );
+      this->CellMap[cellId] = ( keepCell ? 1 : 0 );
+    }
+  }
+};
+
+namespace
+{
+//----------------------------------------------------------------------------
+// The output points are numbered in order of first use in the output
+// connectivity list, as when cells are inserted one at a time. The first
+// use of each point is found with an atomic minimum.
+typedef std::atomic<vtkIdType> AtomicIdType;
+
+inline void AtomicMin(AtomicIdType &value, vtkIdType candidate)
+{
+  vtkIdType current = value.load(std::memory_order_relaxed);
+  while ( candidate < current &&
+          !value.compare_exchange_weak(current, candidate,
+                                       std::memory_order_relaxed) )
+  {
+  }
+}
+
+//----------------------------------------------------------------------------
+// Write the extracted cells with their input point ids, and record the
+// first use of each point.
+struct WriteCellsOp
+{
+  vtkDataSet *Input;
+  const vtkIdType *Locations; // prefix sum of the cell sizes
+  const vtkIdType *CellMap; // prefix sum of the extracted cells
+  vtkIdType *Conn;
+  unsigned char *Types;
+  vtkIdType *OutLocations;
+  vtkIdType *SrcCellIds;
+  AtomicIdType *FirstUse;
+  vtkSMPThreadLocalObject<vtkIdList> CellPts;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdList *cellPts = this->CellPts.Local();
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      vtkIdType newCellId = this->CellMap[cellId];
+      if ( this->CellMap[cellId+1] == newCellId )
+      {
+        continue;
+      }
+      vtkIdType loc = this->Locations[cellId];
+      this->Input->GetCellPoints(cellId, cellPts);
+      vtkIdType npts = cellPts->GetNumberOfIds();
+      this->Types[newCellId] =
+        static_cast<unsigned char>(this->Input->GetCellType(cellId));
+      this->OutLocations[newCellId] = loc;
+      this->SrcCellIds[newCellId] = cellId;
+      this->Conn[loc] = npts;
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        vtkIdType ptId = cellPts->GetId(i);
+        this->Conn[loc+1+i] = ptId;
+        AtomicMin(this->FirstUse[ptId], loc+1+i);
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Count the points first used by each output cell.
+struct CountNewPointsOp
+{
+  const vtkIdType *Conn;
+  const vtkIdType *Locations;
+  const AtomicIdType *FirstUse;
+  vtkIdType *NewPtIds;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      vtkIdType loc = this->Locations[cellId];
+      vtkIdType end = loc + 1 + this->Conn[loc];
+      vtkIdType count = 0;
+      for (vtkIdType pos = loc + 1; pos < end; ++pos)
+      {
+        if ( this->FirstUse[this->Conn[pos]].load(std::memory_order_relaxed)
+             == pos )
+        {
+          ++count;
+        }
+      }
+      this->NewPtIds[cellId] = count;
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Number the points first used by each output cell. Each point is
+// numbered by exactly one cell.
+struct NumberPointsOp
+{
+  const vtkIdType *Conn;
+  const vtkIdType *Locations;
+  const AtomicIdType *FirstUse;
+  const vtkIdType *NewPtIds; // prefix sum of the counts
+  vtkIdType *PointMap;
+  vtkIdType *SrcPtIds;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      vtkIdType loc = this->Locations[cellId];
+      vtkIdType end = loc + 1 + this->Conn[loc];
+      vtkIdType newId = this->NewPtIds[cellId];
+      for (vtkIdType pos = loc + 1; pos < end; ++pos)
+      {
+        vtkIdType ptId = this->Conn[pos];
+        if ( this->FirstUse[ptId].load(std::memory_order_relaxed) == pos )
+        {
+          this->PointMap[ptId] = newId;
+          this->SrcPtIds[newId++] = ptId;
+        }
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Replace the input point ids by the output ones.
+struct RenumberCellsOp
+{
+  vtkIdType *Conn;
+  const vtkIdType *Locations;
+  const vtkIdType *PointMap;
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    for ( ; cellId < endCellId; ++cellId )
+    {
+      vtkIdType loc = this->Locations[cellId];
+      vtkIdType end = loc + 1 + this->Conn[loc];
+      for (vtkIdType pos = loc + 1; pos < end; ++pos)
+      {
+        this->Conn[pos] = this->PointMap[this->Conn[pos]];
+      }
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+struct CopyPointsOp
+{
+  vtkDataSet *Input;
+  const vtkIdType *SrcPtIds;
+  vtkPoints *Points;
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    double x[3];
+    for ( ; ptId < endPtId; ++ptId )
+    {
+      this->Input->GetPoint(this->SrcPtIds[ptId], x);
+      this->Points->SetPoint(ptId, x);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Run the functor over [0, n) with vtkSMPTools, or in the calling thread
+// when the filter is not threaded.
+template <typename Functor>
+void ThresholdFor(bool parallel, vtkIdType n, Functor &functor)
+{
+  if ( parallel )
+  {
+    vtkSMPTools::For(0, n, functor);
+  }
+  else if ( n > 0 )
+  {
+    functor(0, n);
+  }
+}
+
+//----------------------------------------------------------------------------
+struct IdentityIdsOp
+{
+  vtkIdType *Ids;
+
+  void operator()(vtkIdType id, vtkIdType endId)
+  {
+    for ( ; id < endId; ++id )
+    {
+      this->Ids[id] = id;
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Copy the tuples SrcIds of an input array to the tuples 0, 1, ... of an
+// output array that has been sized already.
+template <typename SrcArrayT, typename DstArrayT>
+struct GatherTuplesOp
+{
+  SrcArrayT *Src;
+  DstArrayT *Dst;
+  const vtkIdType *SrcIds;
+
+  void operator()(vtkIdType id, vtkIdType endId)
+  {
+    vtkDataArrayAccessor<SrcArrayT> s(this->Src);
+    vtkDataArrayAccessor<DstArrayT> d(this->Dst);
+    typedef typename vtkDataArrayAccessor<DstArrayT>::APIType DestType;
+    int numComps = this->Src->GetNumberOfComponents();
+    for ( ; id < endId; ++id )
+    {
+      for ( int c = 0; c < numComps; ++c )
+      {
+        d.Set(id, c, static_cast<DestType>(s.Get(this->SrcIds[id], c)));
+      }
+    }
+  }
+};
+
+struct GatherTuplesWorker
+{
+  const vtkIdType *SrcIds;
+  vtkIdType NumberOfIds;
+
+  template <typename SrcArrayT, typename DstArrayT>
+  void operator()(SrcArrayT *src, DstArrayT *dst)
+  {
+    GatherTuplesOp<SrcArrayT, DstArrayT> gather = { src, dst, this->SrcIds };
+    vtkSMPTools::For(0, this->NumberOfIds, gather);
+  }
+};
+
+//----------------------------------------------------------------------------
+// Copy the attributes of the extracted points or cells, whose output ids
+// are 0, 1, ... After CopyAllocate, the arrays of out are those of in that
+// are copied, under the same names. When they can all be paired by name,
+// the tuples of the arrays are copied in parallel, otherwise as usual with
+// CopyData.
+void CopyAttributes(vtkDataSetAttributes *in, vtkDataSetAttributes *out,
+                    vtkIdList *srcIds, vtkIdList *dstIds, bool parallel)
+{
+  int numArrays = out->GetNumberOfArrays();
+  std::vector<vtkAbstractArray*> inArrays(numArrays);
+  for ( int i = 0; parallel && i < numArrays; ++i )
+  {
+    const char *name = out->GetArrayName(i);
+    int index = -1;
+    inArrays[i] = name ? in->GetAbstractArray(name, index) : NULL;
+    for ( int j = index + 1; inArrays[i] && j < in->GetNumberOfArrays(); ++j )
+    {
+      const char *otherName = in->GetArrayName(j);
+      if ( otherName && strcmp(name, otherName) == 0 )
+      {
+        inArrays[i] = NULL;
+      }
+    }
+    parallel = inArrays[i] != NULL;
+  }
+  if ( !parallel )
+  {
+    out->CopyData(in, srcIds, dstIds);
+    return;
+  }
+
+  vtkIdType numIds = dstIds->GetNumberOfIds();
+  GatherTuplesWorker worker = { srcIds->GetPointer(0), numIds };
+  for ( int i = 0; i < numArrays; ++i )
+  {
+    vtkAbstractArray *outArray = out->GetAbstractArray(i);
+    vtkDataArray *inDA = vtkArrayDownCast<vtkDataArray>(inArrays[i]);
+    vtkDataArray *outDA = vtkArrayDownCast<vtkDataArray>(outArray);
+    if ( inDA && outDA &&
+         inDA->GetNumberOfComponents() == outDA->GetNumberOfComponents() )
+    {
+      outDA->SetNumberOfTuples(numIds);
+      if ( vtkArrayDispatch::Dispatch2SameValueType::Execute(inDA, outDA,
+                                                             worker) )
+      {
+        continue;
+      }
+    }
+    // Other arrays, such as bit and string arrays, are copied serially.
+    outArray->InsertTuples(dstIds, srcIds, inArrays[i]);
+  }
+}
+}
+
 // Construct with lower threshold=0, upper threshold=1, and threshold
 // function=upper AllScalars=1.
 vtkThreshold::vtkThreshold()
@@ -47,6 +418,7 @@ vtkThreshold::vtkThreshold()
                                vtkDataSetAttributes::SCALARS);
 
   this->UseContinuousCellRange = 0;
+  this->EnableSMP = 0;
 }
 
 vtkThreshold::~vtkThreshold()
@@ -105,17 +477,10 @@ int vtkThreshold::RequestData(
   vtkUnstructuredGrid *output = vtkUnstructuredGrid::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
-  vtkIdType cellId, newCellId;
-  vtkIdList *cellPts, *pointMap;
-  vtkIdList *newCellPts;
-  vtkCell *cell;
+  vtkIdType numPts, numCells;
   vtkPoints *newPoints;
-  int i, ptId, newId, numPts;
-  int numCellPts;
-  double x[3];
   vtkPointData *pd=input->GetPointData(), *outPD=output->GetPointData();
   vtkCellData *cd=input->GetCellData(), *outCD=output->GetCellData();
-  int keepCell;
 
   vtkDebugMacro(<< "Executing threshold filter");
 
@@ -133,13 +498,8 @@ int vtkThreshold::RequestData(
     return 1;
   }
 
-  outPD->CopyGlobalIdsOn();
-  outPD->CopyAllocate(pd);
-  outCD->CopyGlobalIdsOn();
-  outCD->CopyAllocate(cd);
-
   numPts = input->GetNumberOfPoints();
-  output->Allocate(input->GetNumberOfCells());
+  numCells = input->GetNumberOfCells();
 
   newPoints = vtkPoints::New();
 
@@ -165,98 +525,157 @@ int vtkThreshold::RequestData(
     newPoints->SetDataType(VTK_DOUBLE);
   }
 
-  newPoints->Allocate(numPts);
-
-  pointMap = vtkIdList::New(); //maps old point ids into new
-  pointMap->SetNumberOfIds(numPts);
-  for (i=0; i < numPts; i++)
-  {
-    pointMap->SetId(i,-1);
-  }
-
-  newCellPts = vtkIdList::New();
-
   // are we using pointScalars?
   int fieldAssociation = this->GetInputArrayAssociation(0, inputVector);
   bool usePointScalars = fieldAssociation == vtkDataObject::FIELD_ASSOCIATION_POINTS;
 
-  // Check that the scalars of each cell satisfy the threshold criterion
-  for (cellId=0; cellId < input->GetNumberOfCells(); cellId++)
+  // The cell access methods of the datasets are thread safe once they have
+  // been called from a single thread (e.g. to build the cells of polydata).
+  // The input arrays must also support concurrent reads, which is not the
+  // case of some mapped arrays, hence the EnableSMP flag.
+  bool parallel = this->EnableSMP != 0;
+  if ( parallel && numCells > 0 )
   {
-    cell = input->GetCell(cellId);
-    cellPts = cell->GetPointIds();
-    numCellPts = cell->GetNumberOfPoints();
+    vtkIdList *cellPts = vtkIdList::New();
+    input->GetCellPoints(0, cellPts);
+    input->GetCellType(0);
+    cellPts->Delete();
+  }
 
-    if ( usePointScalars )
+  // Check that the scalars of each cell satisfy the threshold criterion,
+  // then compute the locations of the extracted cells in the output
+  // connectivity list and their ids.
+  std::vector<vtkIdType> locations(numCells + 1);
+  std::vector<vtkIdType> cellMap(numCells + 1);
+  vtkThresholdFunctor evaluate(this, input, inScalars, usePointScalars,
+                               &locations[0], &cellMap[0]);
+  ThresholdFor(parallel, numCells, evaluate);
+
+  vtkIdType numNewCells = vtkSMPTools::ExclusiveScan(
+    cellMap.begin(), cellMap.end() - 1, cellMap.begin(),
+    static_cast<vtkIdType>(0));
+  cellMap[numCells] = numNewCells;
+  vtkIdType connSize = vtkSMPTools::ExclusiveScan(
+    locations.begin(), locations.end() - 1, locations.begin(),
+    static_cast<vtkIdType>(0));
+  locations[numCells] = connSize;
+
+  // Write the extracted cells, then number the points in order of first
+  // use and renumber the cells.
+  vtkIdTypeArray *conn = vtkIdTypeArray::New();
+  vtkIdType *connPtr = conn->WritePointer(0, connSize);
+  vtkUnsignedCharArray *types = vtkUnsignedCharArray::New();
+  types->SetNumberOfValues(numNewCells);
+  vtkIdTypeArray *outLocations = vtkIdTypeArray::New();
+  outLocations->SetNumberOfValues(numNewCells);
+  vtkIdList *srcCellIds = vtkIdList::New();
+  srcCellIds->SetNumberOfIds(numNewCells);
+
+  std::vector<vtkIdType> pointMap(numPts);
+  vtkIdList *srcPtIds = vtkIdList::New();
+  vtkIdType numNewPts;
+  {
+    std::vector<AtomicIdType> firstUse(numPts);
+    vtkSMPTools::Fill(firstUse.begin(), firstUse.end(), VTK_ID_MAX);
+
+    WriteCellsOp write;
+    write.Input = input;
+    write.Locations = &locations[0];
+    write.CellMap = &cellMap[0];
+    write.Conn = connPtr;
+    write.Types = types->GetPointer(0);
+    write.OutLocations = outLocations->GetPointer(0);
+    write.SrcCellIds = srcCellIds->GetPointer(0);
+    write.FirstUse = firstUse.empty() ? NULL : &firstUse[0];
+    ThresholdFor(parallel, numCells, write);
+
+    std::vector<vtkIdType>().swap(locations);
+    std::vector<vtkIdType>().swap(cellMap);
+
+    std::vector<vtkIdType> newPtIds(numNewCells);
+    const vtkIdType *outLocs = outLocations->GetPointer(0);
+    CountNewPointsOp count = { connPtr, outLocs, write.FirstUse,
+                               newPtIds.empty() ? NULL : &newPtIds[0] };
+    ThresholdFor(parallel, numNewCells, count);
+    numNewPts = vtkSMPTools::ExclusiveScan(
+      newPtIds.begin(), newPtIds.end(), newPtIds.begin(),
+      static_cast<vtkIdType>(0));
+
+    srcPtIds->SetNumberOfIds(numNewPts);
+    NumberPointsOp number = { connPtr, outLocs, write.FirstUse,
+                              count.NewPtIds,
+                              pointMap.empty() ? NULL : &pointMap[0],
+                              srcPtIds->GetPointer(0) };
+    ThresholdFor(parallel, numNewCells, number);
+  }
+  RenumberCellsOp renumber = { connPtr, outLocations->GetPointer(0),
+                               pointMap.empty() ? NULL : &pointMap[0] };
+  ThresholdFor(parallel, numNewCells, renumber);
+
+  newPoints->SetNumberOfPoints(numNewPts);
+  CopyPointsOp copyPoints = { input, srcPtIds->GetPointer(0), newPoints };
+  ThresholdFor(parallel, numNewPts, copyPoints);
+
+  // special handling for polyhedron cells, whose faces are inserted
+  // serially
+  vtkUnstructuredGrid *inputGrid = vtkUnstructuredGrid::SafeDownCast(input);
+  if ( inputGrid && inputGrid->GetFaces() )
+  {
+    output->Allocate(numNewCells);
+    vtkIdList *newCellPts = vtkIdList::New();
+    const unsigned char *cellTypes = types->GetPointer(0);
+    const vtkIdType *outLocs = outLocations->GetPointer(0);
+    for (vtkIdType newCellId = 0; newCellId < numNewCells; ++newCellId)
     {
-      if (this->AllScalars)
+      if ( cellTypes[newCellId] == VTK_POLYHEDRON )
       {
-        keepCell = 1;
-        for ( i=0; keepCell && (i < numCellPts); i++)
-        {
-          ptId = cellPts->GetId(i);
-          keepCell = this->EvaluateComponents( inScalars, ptId );
-        }
+        inputGrid->GetFaceStream(srcCellIds->GetId(newCellId), newCellPts);
+        vtkUnstructuredGrid::ConvertFaceStreamPointIds(
+          newCellPts, &pointMap[0]);
+        output->InsertNextCell(VTK_POLYHEDRON, newCellPts);
       }
       else
       {
-        if(!this->UseContinuousCellRange)
-        {
-          keepCell = 0;
-          for ( i=0; (!keepCell) && (i < numCellPts); i++)
-          {
-            ptId = cellPts->GetId(i);
-            keepCell = this->EvaluateComponents( inScalars, ptId );
-          }
-        }
-        else
-        {
-          keepCell = this->EvaluateCell(inScalars, cellPts, numCellPts);
-        }
+        vtkIdType loc = outLocs[newCellId];
+        output->InsertNextCell(cellTypes[newCellId], connPtr[loc],
+                               connPtr + loc + 1);
       }
     }
-    else //use cell scalars
-    {
-      keepCell = this->EvaluateComponents( inScalars, cellId );
-    }
+    newCellPts->Delete();
+  }
+  else
+  {
+    vtkCellArray *cells = vtkCellArray::New();
+    cells->SetCells(numNewCells, conn);
+    output->SetCells(types, outLocations, cells);
+    cells->Delete();
+  }
+  conn->Delete();
+  types->Delete();
+  outLocations->Delete();
 
-    if (  numCellPts > 0 && keepCell )
-    {
-      // satisfied thresholding (also non-empty cell, i.e. not VTK_EMPTY_CELL)
-      for (i=0; i < numCellPts; i++)
-      {
-        ptId = cellPts->GetId(i);
-        if ( (newId = pointMap->GetId(ptId)) < 0 )
-        {
-          input->GetPoint(ptId, x);
-          newId = newPoints->InsertNextPoint(x);
-          pointMap->SetId(ptId,newId);
-          outPD->CopyData(pd,ptId,newId);
-        }
-        newCellPts->InsertId(i,newId);
-      }
-      // special handling for polyhedron cells
-      if (vtkUnstructuredGrid::SafeDownCast(input) &&
-          input->GetCellType(cellId) == VTK_POLYHEDRON)
-      {
-        newCellPts->Reset();
-        vtkUnstructuredGrid::SafeDownCast(input)->
-          GetFaceStream(cellId, newCellPts);
-        vtkUnstructuredGrid::ConvertFaceStreamPointIds(
-          newCellPts, pointMap->GetPointer(0));
-      }
-      newCellId = output->InsertNextCell(cell->GetCellType(),newCellPts);
-      outCD->CopyData(cd,cellId,newCellId);
-      newCellPts->Reset();
-    } // satisfied thresholding
-  } // for all cells
+  // Copy the attributes of the extracted points and cells.
+  vtkIdList *dstIds = vtkIdList::New();
+  dstIds->SetNumberOfIds(std::max(numNewPts, numNewCells));
+  IdentityIdsOp identity = { dstIds->GetPointer(0) };
+  ThresholdFor(parallel, dstIds->GetNumberOfIds(), identity);
+
+  outPD->CopyGlobalIdsOn();
+  outPD->CopyAllocate(pd, numNewPts);
+  dstIds->SetNumberOfIds(numNewPts);
+  CopyAttributes(pd, outPD, srcPtIds, dstIds, parallel);
+  outCD->CopyGlobalIdsOn();
+  outCD->CopyAllocate(cd, numNewCells);
+  dstIds->SetNumberOfIds(numNewCells);
+  CopyAttributes(cd, outCD, srcCellIds, dstIds, parallel);
 
   vtkDebugMacro(<< "Extracted " << output->GetNumberOfCells()
                 << " number of cells.");
 
   // now clean up / update ourselves
-  pointMap->Delete();
-  newCellPts->Delete();
+  dstIds->Delete();
+  srcPtIds->Delete();
+  srcCellIds->Delete();
 
   output->SetPoints(newPoints);
   newPoints->Delete();
@@ -300,7 +719,7 @@ int vtkThreshold::EvaluateCell( vtkDataArray *scalars, int c, vtkIdList* cellPts
   double minScalar=DBL_MAX, maxScalar=DBL_MIN;
   for (int i=0; i < numCellPts; i++)
   {
-    int ptId = cellPts->GetId(i);
+    vtkIdType ptId = cellPts->GetId(i);
     double s = scalars->GetComponent(ptId,c);
     minScalar = std::min(s,minScalar);
     maxScalar = std::max(s,maxScalar);
@@ -450,4 +869,5 @@ void vtkThreshold::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
   os << indent << "Use Continuous Cell Range: "<<this->UseContinuousCellRange<<endl;
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
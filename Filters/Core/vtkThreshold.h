@@ -30,6 +30,16 @@
  * By default only the first scalar value is used in the decision. Use the ComponentMode
  * and SelectedComponent ivars to control this behavior.
  *
+ * The output cells and points are numbered with prefix sums, and the
+ * connectivity, points and attributes are written into preallocated arrays.
+ * When EnableSMP is on, these passes (and the evaluation of the criterion)
+ * are threaded with vtkSMPTools. The output (including the order of the
+ * points, which are numbered in order of first use by the extracted cells)
+ * does not depend on the number of threads. Polyhedral cells are inserted
+ * serially, and so are the attributes unless all the copied arrays have
+ * distinct names. The input arrays are then read concurrently, which some
+ * mapped arrays (e.g. vtkPeriodicDataArray) do not support.
+ *
  * @sa
  * vtkThresholdPoints vtkThresholdTextureCoords
 */
@@ -183,6 +193,16 @@ public:
   int GetOutputPointsPrecision() const;
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded extraction of the cells (see the class
+   * documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkThreshold();
   ~vtkThreshold() VTK_OVERRIDE;
@@ -201,6 +221,7 @@ protected:
   int    SelectedComponent;
   int OutputPointsPrecision;
   int UseContinuousCellRange;
+  int EnableSMP;
 
   int (vtkThreshold::*ThresholdFunction)(double s);
 
@@ -213,6 +234,8 @@ protected:
   int EvaluateCell( vtkDataArray *scalars, vtkIdList* cellPts, int numCellPts );
   int EvaluateCell( vtkDataArray *scalars, int c, vtkIdList* cellPts, int numCellPts );
 private:
+  friend class vtkThresholdFunctor; // evaluates the cells in parallel
+
   vtkThreshold(const vtkThreshold&) VTK_DELETE_FUNCTION;
   void operator=(const vtkThreshold&) VTK_DELETE_FUNCTION;
 };
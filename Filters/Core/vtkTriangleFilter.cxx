@@ -16,16 +16,187 @@
 
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
+#include "vtkIdList.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkTriangleStrip.h"
 
+#include <algorithm>
+#include <vector>
+
 vtkStandardNewMacro(vtkTriangleFilter);
 
+namespace
+{
+// Triangulate one of the cell arrays of a polydata (verts, lines, polys or
+// strips) with vtkSMPTools. A first pass stores the number of output cells
+// of every input cell in Offsets; once these counts are turned into offsets,
+// a second pass writes the output cells (in the legacy connectivity layout)
+// and the input cell each of them comes from. General polygons are
+// triangulated in both passes rather than kept in memory.
+struct TriangulateCells
+{
+  enum { VERTS = 0, LINES = 1, POLYS = 2, STRIPS = 3 };
+
+  vtkCellArray *Cells;
+  int Kind;
+  vtkPoints *Points;
+  vtkIdType FirstCellId;
+  bool Counting;
+  vtkIdType *Offsets;
+  vtkIdType *Output;
+  vtkIdType *Sources;
+  vtkSMPThreadLocalObject<vtkPolygon> Polygon;
+  vtkSMPThreadLocalObject<vtkIdList> Triangles;
+
+  // Quads with distinct points that are convex are split along the
+  // diagonal (p0, p2).
+  bool IsConvexQuad(vtkIdType npts, vtkIdType *pts)
+  {
+    return npts == 4 && pts[0] != pts[1] && pts[0] != pts[2] &&
+      pts[0] != pts[3] && pts[1] != pts[2] && pts[1] != pts[3] &&
+      pts[2] != pts[3] && vtkPolygon::IsConvex(this->Points, 4, pts);
+  }
+
+  // Triangulate a polygon as the serial filter does. Returns the point ids
+  // of the triangles.
+  vtkIdList *TriangulatePolygon(vtkIdType npts, vtkIdType *pts)
+  {
+    vtkPolygon *poly = this->Polygon.Local();
+    vtkIdList *tris = this->Triangles.Local();
+    double x[3];
+    poly->PointIds->SetNumberOfIds(npts);
+    poly->Points->SetNumberOfPoints(npts);
+    for (vtkIdType i = 0; i < npts; i++)
+    {
+      poly->PointIds->SetId(i, pts[i]);
+      this->Points->GetPoint(pts[i], x);
+      poly->Points->SetPoint(i, x);
+    }
+    poly->Triangulate(tris);
+    for (vtkIdType i = 0; i < tris->GetNumberOfIds(); i++)
+    {
+      tris->SetId(i, pts[tris->GetId(i)]);
+    }
+    return tris;
+  }
+
+  vtkIdType CountCells(vtkIdType npts, vtkIdType *pts)
+  {
+    switch (this->Kind)
+    {
+      case VERTS:
+        return npts;
+      case LINES:
+        return npts > 1 ? npts - 1 : 0;
+      case STRIPS:
+        return npts > 2 ? npts - 2 : 0;
+      default:
+        if (npts == 0)
+        {
+          return 0;
+        }
+        if (npts == 3)
+        {
+          return 1;
+        }
+        if (this->IsConvexQuad(npts, pts))
+        {
+          return 2;
+        }
+        return this->TriangulatePolygon(npts, pts)->GetNumberOfIds() / 3;
+    }
+  }
+
+  void WriteCells(vtkIdType npts, vtkIdType *pts, vtkIdType *out)
+  {
+    vtkIdType i;
+    switch (this->Kind)
+    {
+      case VERTS:
+        for (i = 0; i < npts; i++)
+        {
+          *out++ = 1;
+          *out++ = pts[i];
+        }
+        break;
+      case LINES:
+        for (i = 0; i < npts - 1; i++)
+        {
+          *out++ = 2;
+          *out++ = pts[i];
+          *out++ = pts[i+1];
+        }
+        break;
+      case STRIPS:
+        // flip every other triangle, as vtkTriangleStrip::DecomposeStrip()
+        for (i = 0; i < npts - 2; i++)
+        {
+          *out++ = 3;
+          *out++ = pts[(i % 2) ? i+1 : i];
+          *out++ = pts[(i % 2) ? i : i+1];
+          *out++ = pts[i+2];
+        }
+        break;
+      default:
+        if (npts == 0)
+        {
+          break;
+        }
+        if (npts == 3)
+        {
+          *out++ = 3;
+          std::copy(pts, pts + 3, out);
+        }
+        else if (this->IsConvexQuad(npts, pts))
+        {
+          vtkIdType tris[8] = {3, pts[0], pts[1], pts[2], 3, pts[0], pts[2], pts[3]};
+          std::copy(tris, tris + 8, out);
+        }
+        else
+        {
+          vtkIdList *tris = this->TriangulatePolygon(npts, pts);
+          for (i = 0; i < tris->GetNumberOfIds(); i += 3)
+          {
+            *out++ = 3;
+            *out++ = tris->GetId(i);
+            *out++ = tris->GetId(i+1);
+            *out++ = tris->GetId(i+2);
+          }
+        }
+        break;
+    }
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType npts, *pts;
+    vtkIdType cellSize = this->Kind == VERTS ? 2 : (this->Kind == LINES ? 3 : 4);
+    for (vtkIdType cellId = begin; cellId < end; cellId++)
+    {
+      this->Cells->GetCellAtId(cellId, npts, pts);
+      if (this->Counting)
+      {
+        this->Offsets[cellId] = this->CountCells(npts, pts);
+        continue;
+      }
+      vtkIdType outId = this->Offsets[cellId];
+      std::fill(this->Sources + outId, this->Sources + this->Offsets[cellId+1],
+                this->FirstCellId + cellId);
+      this->WriteCells(npts, pts, this->Output + cellSize * outId);
+    }
+  }
+};
+}
+
 int vtkTriangleFilter::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -41,6 +212,12 @@ int vtkTriangleFilter::RequestData(
   vtkPolyData *output = vtkPolyData::SafeDownCast(
     outInfo->Get(vtkDataObject::DATA_OBJECT()));
 
+  if ( this->EnableSMP )
+  {
+    this->TriangulateSMP(input, output);
+    return 1;
+  }
+
   vtkIdType numCells=input->GetNumberOfCells();
   vtkIdType cellNum=0;
   vtkIdType numPts, newId;
@@ -239,11 +416,124 @@ int vtkTriangleFilter::RequestData(
   return 1;
 }
 
+void vtkTriangleFilter::TriangulateSMP(vtkPolyData *input, vtkPolyData *output)
+{
+  vtkCellArray *cells[4] = {input->GetVerts(), input->GetLines(),
+                            input->GetPolys(), input->GetStrips()};
+  bool pass[4] = {this->PassVerts != 0, this->PassLines != 0, true, true};
+  TriangulateCells triangulators[4];
+  std::vector<vtkIdType> offsets[4];
+  vtkIdType numOutCells[4] = {0, 0, 0, 0};
+  bool hadLocations[4] = {true, true, true, true};
+
+  // Count the output cells of every input cell.
+  vtkIdType firstCellId = 0;
+  for (int k = 0; k < 4; k++)
+  {
+    TriangulateCells &triangulator = triangulators[k];
+    vtkIdType numCells = cells[k]->GetNumberOfCells();
+    triangulator.Cells = cells[k];
+    triangulator.Kind = k;
+    triangulator.Points = input->GetPoints();
+    triangulator.FirstCellId = firstCellId;
+    triangulator.Counting = true;
+    triangulator.Offsets = NULL;
+    triangulator.Output = NULL;
+    triangulator.Sources = NULL;
+    firstCellId += numCells;
+    if ( !pass[k] || numCells == 0 )
+    {
+      continue;
+    }
+    hadLocations[k] = cells[k]->HasCellLocations();
+    cells[k]->BuildCellLocations();
+    offsets[k].resize(numCells + 1, 0);
+    triangulator.Offsets = &offsets[k][0];
+    vtkSMPTools::For(0, numCells, triangulator);
+
+    for (vtkIdType i = 0; i <= numCells; i++)
+    {
+      vtkIdType count = offsets[k][i];
+      offsets[k][i] = numOutCells[k];
+      numOutCells[k] += count;
+    }
+  }
+  this->UpdateProgress(0.5);
+
+  // Allocate the output cells; the triangles of the strips follow the ones
+  // of the polygons.
+  vtkIdType *outputs[4] = {NULL, NULL, NULL, NULL};
+  if ( numOutCells[0] > 0 )
+  {
+    vtkSmartPointer<vtkCellArray> newVerts = vtkSmartPointer<vtkCellArray>::New();
+    outputs[0] = newVerts->WritePointer(numOutCells[0], 2 * numOutCells[0]);
+    output->SetVerts(newVerts);
+  }
+  if ( numOutCells[1] > 0 )
+  {
+    vtkSmartPointer<vtkCellArray> newLines = vtkSmartPointer<vtkCellArray>::New();
+    outputs[1] = newLines->WritePointer(numOutCells[1], 3 * numOutCells[1]);
+    output->SetLines(newLines);
+  }
+  vtkIdType numTris = numOutCells[2] + numOutCells[3];
+  if ( numTris > 0 )
+  {
+    vtkSmartPointer<vtkCellArray> newPolys = vtkSmartPointer<vtkCellArray>::New();
+    outputs[2] = newPolys->WritePointer(numTris, 4 * numTris);
+    outputs[3] = outputs[2] + 4 * numOutCells[2];
+    output->SetPolys(newPolys);
+  }
+
+  // Write them.
+  vtkIdType numOutput = numOutCells[0] + numOutCells[1] + numTris;
+  std::vector<vtkIdType> sources(numOutput);
+  vtkIdType firstOutputId = 0;
+  for (int k = 0; k < 4; k++)
+  {
+    if ( numOutCells[k] > 0 )
+    {
+      TriangulateCells &triangulator = triangulators[k];
+      triangulator.Counting = false;
+      triangulator.Output = outputs[k];
+      triangulator.Sources = &sources[firstOutputId];
+      vtkSMPTools::For(0, cells[k]->GetNumberOfCells(), triangulator);
+      firstOutputId += numOutCells[k];
+    }
+    if ( !hadLocations[k] )
+    {
+      cells[k]->DeleteCellLocations();
+    }
+  }
+  this->UpdateProgress(0.9);
+
+  // Update output
+  vtkNew<vtkIdList> srcIds;
+  vtkNew<vtkIdList> dstIds;
+  srcIds->SetNumberOfIds(numOutput);
+  dstIds->SetNumberOfIds(numOutput);
+  for (vtkIdType i = 0; i < numOutput; i++)
+  {
+    srcIds->SetId(i, sources[i]);
+    dstIds->SetId(i, i);
+  }
+  output->GetCellData()->CopyAllocate(input->GetCellData(), numOutput);
+  output->GetCellData()->CopyData(input->GetCellData(), srcIds.Get(),
+                                  dstIds.Get());
+  output->SetPoints(input->GetPoints());
+  output->GetPointData()->PassData(input->GetPointData());
+
+  vtkDebugMacro(<<"Converted " << input->GetNumberOfCells()
+                << "input cells to "
+                << output->GetNumberOfCells()
+                <<" output cells");
+}
+
 void vtkTriangleFilter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "Pass Verts: " << (this->PassVerts ? "On\n" : "Off\n");
   os << indent << "Pass Lines: " << (this->PassLines ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 
 }
@@ -20,6 +20,14 @@
  * strips.  It also generates line segments from polylines unless PassLines
  * is off, and generates individual vertex cells from vtkVertex point lists
  * unless PassVerts is off.
+ *
+ * When EnableSMP is on, the number of output cells of every input cell is
+ * counted first, and the output cells are then written in parallel (via
+ * vtkSMPTools) at the offsets given by the prefix sum of the counts. Convex
+ * quads are then split along their first diagonal instead of being
+ * triangulated as general polygons, so their triangles may differ from the
+ * serial ones; all the other cells give the same output. Vertex and line
+ * cells without points are dropped.
 */
 
 #ifndef vtkTriangleFilter_h
@@ -59,15 +67,29 @@ public:
   vtkGetMacro(PassLines,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded triangulation (see the class documentation).
+   * This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
-  vtkTriangleFilter() : PassVerts(1), PassLines(1) {}
+  vtkTriangleFilter() : PassVerts(1), PassLines(1), EnableSMP(0) {}
   ~vtkTriangleFilter() VTK_OVERRIDE {}
 
   // Usual data generation method
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
 
+  // The threaded triangulation, used when EnableSMP is on.
+  void TriangulateSMP(vtkPolyData *input, vtkPolyData *output);
+
   int PassVerts;
   int PassLines;
+  int EnableSMP;
 private:
   vtkTriangleFilter(const vtkTriangleFilter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkTriangleFilter&) VTK_DELETE_FUNCTION;
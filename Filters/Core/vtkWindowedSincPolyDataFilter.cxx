@@ -24,6 +24,8 @@
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
 #include "vtkPolygon.h"
+#include "vtkSMPTools.h"
+#include "vtkSmoothingTopology.h"
 #include "vtkTriangle.h"
 #include "vtkTriangleFilter.h"
 
@@ -50,6 +52,8 @@ vtkWindowedSincPolyDataFilter::vtkWindowedSincPolyDataFilter()
   this->GenerateErrorVectors = 0;
 
   this->NormalizeCoordinates = 0;
+
+  this->EnableSMP = 0;
 }
 
 #define VTK_SIMPLE_VERTEX 0
@@ -64,6 +68,163 @@ typedef struct _vtkMeshVertex
   vtkIdList *edges; // connected edges (list of connected point ids)
 } vtkMeshVertex, *vtkMeshVertexPtr;
 
+namespace
+{
+// The first pass of the threaded smoothing. The points are single
+// precision, like in the serial smoothing, and the computations are done
+// in double precision in the same order so that both give the same result.
+struct SincFirstPass
+{
+  const vtkSmoothingTopology &Topology;
+  const float *X0;
+  float *X1;
+  float *X3;
+  const double *C;
+
+  SincFirstPass(const vtkSmoothingTopology &topology, vtkPoints *x0,
+                vtkPoints *x1, vtkPoints *x3, const double *c) :
+    Topology(topology),
+    X0(static_cast<float *>(x0->GetVoidPointer(0))),
+    X1(static_cast<float *>(x1->GetVoidPointer(0))),
+    X3(static_cast<float *>(x3->GetVoidPointer(0))), C(c)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    double x[3], deltaX[3];
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      const float *x0 = this->X0 + 3 * ptId;
+      float *x1 = this->X1 + 3 * ptId;
+      float *x3 = this->X3 + 3 * ptId;
+      vtkIdType npts = this->Topology.GetNumberOfNeighbors(ptId);
+      if (npts > 0)
+      {
+        const vtkIdType *neighbors = this->Topology.GetNeighbors(ptId);
+        int k;
+        for (k = 0; k < 3; ++k)
+        {
+          x[k] = x0[k];
+          deltaX[k] = 0.0;
+        }
+
+        // calculate the negative of the laplacian
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          const float *y = this->X0 + 3 * neighbors[j];
+          for (k = 0; k < 3; ++k)
+          {
+            deltaX[k] += (x[k] - y[k]) / npts;
+          }
+        }
+        // x1 = x0 - 0.5 x1
+        for (k = 0; k < 3; ++k)
+        {
+          deltaX[k] = x[k] - 0.5 * deltaX[k];
+          x1[k] = static_cast<float>(deltaX[k]);
+        }
+
+        // x3 = c0 x0 + c1 x1
+        bool fixed =
+          this->Topology.GetType(ptId) == vtkSmoothingTopology::FIXED_VERTEX;
+        for (k = 0; k < 3; ++k)
+        {
+          x3[k] = fixed ? x0[k] :
+            static_cast<float>(this->C[0] * x[k] + this->C[1] * deltaX[k]);
+        }
+      }
+      else
+      {
+        // point is not allowed to move (zero out the Laplacian)
+        for (int k = 0; k < 3; ++k)
+        {
+          x1[k] = 0.0f;
+          x3[k] = x0[k];
+        }
+      }
+    }
+  }
+};
+
+// The next passes of the threaded smoothing. They only read the points of
+// the previous passes, so that the points can be updated in any order.
+struct SincPass
+{
+  const vtkSmoothingTopology &Topology;
+  const float *X0;
+  const float *X1;
+  float *X2;
+  float *X3;
+  double C;
+
+  SincPass(const vtkSmoothingTopology &topology, vtkPoints *x0, vtkPoints *x1,
+           vtkPoints *x2, vtkPoints *x3, double c) :
+    Topology(topology),
+    X0(static_cast<float *>(x0->GetVoidPointer(0))),
+    X1(static_cast<float *>(x1->GetVoidPointer(0))),
+    X2(static_cast<float *>(x2->GetVoidPointer(0))),
+    X3(static_cast<float *>(x3->GetVoidPointer(0))), C(c)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    double p_x1[3], deltaX[3];
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      const float *x0 = this->X0 + 3 * ptId;
+      const float *x1 = this->X1 + 3 * ptId;
+      float *x2 = this->X2 + 3 * ptId;
+      vtkIdType npts = this->Topology.GetNumberOfNeighbors(ptId);
+      if (npts > 0)
+      {
+        const vtkIdType *neighbors = this->Topology.GetNeighbors(ptId);
+        int k;
+        for (k = 0; k < 3; ++k)
+        {
+          p_x1[k] = x1[k];
+          deltaX[k] = 0.0;
+        }
+
+        // calculate the negative laplacian of x1
+        for (vtkIdType j = 0; j < npts; ++j)
+        {
+          const float *y = this->X1 + 3 * neighbors[j];
+          for (k = 0; k < 3; ++k)
+          {
+            deltaX[k] += (p_x1[k] - y[k]) / npts;
+          }
+        }
+
+        // Taubin:  x2 = (x1 - x0) + (x1 - x2)
+        for (k = 0; k < 3; ++k)
+        {
+          deltaX[k] = p_x1[k] - x0[k] + p_x1[k] - deltaX[k];
+          x2[k] = static_cast<float>(deltaX[k]);
+        }
+
+        // smooth the vertex (x3 = x3 + cj x2)
+        if (this->Topology.GetType(ptId) != vtkSmoothingTopology::FIXED_VERTEX)
+        {
+          float *x3 = this->X3 + 3 * ptId;
+          for (k = 0; k < 3; ++k)
+          {
+            x3[k] = static_cast<float>(x3[k] + this->C * deltaX[k]);
+          }
+        }
+      }
+      else
+      {
+        // point is not allowed to move (zero out the Laplacian). Its x1 was
+        // zeroed as x2 by the previous pass, or by the first one.
+        x2[0] = x2[1] = x2[2] = 0.0f;
+      }
+    }
+  }
+};
+}
+
 int vtkWindowedSincPolyDataFilter::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -149,280 +310,295 @@ int vtkWindowedSincPolyDataFilter::RequestData(
 // using a subset of the attached vertices.
 //
   vtkDebugMacro(<<"Analyzing topology...");
-  Verts = new vtkMeshVertex[numPts];
-  for (i=0; i<numPts; i++)
+  inPts = input->GetPoints();
+  Verts = NULL;
+  vtkSmoothingTopology topology;
+  if (this->EnableSMP)
   {
-    Verts[i].type = VTK_SIMPLE_VERTEX; //can smooth
-    Verts[i].edges = NULL;
+    topology.Build(input, this->FeatureEdgeSmoothing != 0, CosFeatureAngle,
+                   CosEdgeAngle, this->BoundarySmoothing != 0,
+                   this->NonManifoldSmoothing != 0);
+    numSimple = topology.NumberOfSimpleVertices;
+    numFixed = topology.NumberOfFixedVertices;
+    numFEdges = topology.NumberOfFeatureEdgeVertices;
+    numBEdges = topology.NumberOfBoundaryEdgeVertices;
+    this->UpdateProgress(0.50);
   }
-
-  inPts = input->GetPoints();
-
-  // check vertices first. Vertices are never smoothed_--------------
-  for (inVerts=input->GetVerts(), inVerts->InitTraversal();
-  inVerts->GetNextCell(npts,pts); )
+  else
   {
-    for (j=0; j<npts; j++)
+    Verts = new vtkMeshVertex[numPts];
+    for (i=0; i<numPts; i++)
     {
-      Verts[pts[j]].type = VTK_FIXED_VERTEX;
+      Verts[i].type = VTK_SIMPLE_VERTEX; //can smooth
+      Verts[i].edges = NULL;
     }
-  }
 
-  this->UpdateProgress(0.10);
-
-  // now check lines. Only manifold lines can be smoothed------------
-  for (inLines=input->GetLines(), inLines->InitTraversal();
-  inLines->GetNextCell(npts,pts); )
-  {
-    for (j=0; j<npts; j++)
+    // check vertices first. Vertices are never smoothed_--------------
+    for (inVerts=input->GetVerts(), inVerts->InitTraversal();
+    inVerts->GetNextCell(npts,pts); )
     {
-      if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
+      for (j=0; j<npts; j++)
       {
-        if ( j == (npts-1) ) //end-of-line marked FIXED
-        {
-          Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        }
-        else if ( j == 0 ) //beginning-of-line marked FIXED
-        {
-          Verts[pts[0]].type = VTK_FIXED_VERTEX;
-          inPts->GetPoint(pts[0],x2);
-          inPts->GetPoint(pts[1],x3);
-        }
-        else //is edge vertex (unless already edge vertex!)
-        {
-          Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
-          Verts[pts[j]].edges = vtkIdList::New();
-          Verts[pts[j]].edges->SetNumberOfIds(2);
-          //Verts[pts[j]].edges = new vtkIdList(2,2);
-          Verts[pts[j]].edges->SetId(0,pts[j-1]);
-          Verts[pts[j]].edges->SetId(1,pts[j+1]);
-        }
-      } //if simple vertex
-
-      else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
-      { //multiply connected, becomes fixed!
         Verts[pts[j]].type = VTK_FIXED_VERTEX;
-        Verts[pts[j]].edges->Delete();
-        Verts[pts[j]].edges = NULL;
       }
-
-    } //for all points in this line
-  } //for all lines
-
-  this->UpdateProgress(0.25);
-
-  // now polygons and triangle strips-------------------------------
-  inPolys=input->GetPolys();
-  numPolys = inPolys->GetNumberOfCells();
-  inStrips=input->GetStrips();
-  numStrips = inStrips->GetNumberOfCells();
-
-  if ( numPolys > 0 || numStrips > 0 )
-  { //build cell structure
-    vtkCellArray *polys;
-    vtkIdType cellId;
-    int numNei, nei, edge;
-    vtkIdType numNeiPts;
-    vtkIdType *neiPts;
-    double normal[3], neiNormal[3];
-    vtkIdList *neighbors;
-
-    inMesh = vtkPolyData::New();
-    inMesh->SetPoints(inPts);
-    inMesh->SetPolys(inPolys);
-    Mesh = inMesh;
-    neighbors = vtkIdList::New();
-    neighbors->Allocate(VTK_CELL_SIZE);
-
-    if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
-    { // convert data to triangles
-      inMesh->SetStrips(inStrips);
-      toTris = vtkTriangleFilter::New();
-      toTris->SetInputData(inMesh);
-      toTris->Update();
-      Mesh = toTris->GetOutput();
     }
 
-    Mesh->BuildLinks(); //to do neighborhood searching
-    polys = Mesh->GetPolys();
+    this->UpdateProgress(0.10);
 
-    for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
-         cellId++)
+    // now check lines. Only manifold lines can be smoothed------------
+    for (inLines=input->GetLines(), inLines->InitTraversal();
+    inLines->GetNextCell(npts,pts); )
     {
-      for (i=0; i < npts; i++)
+      for (j=0; j<npts; j++)
       {
-        p1 = pts[i];
-        p2 = pts[(i+1)%npts];
-
-        if ( Verts[p1].edges == NULL )
+        if ( Verts[pts[j]].type == VTK_SIMPLE_VERTEX )
         {
-          Verts[p1].edges = vtkIdList::New();
-          Verts[p1].edges->Allocate(16,6);
-          // Verts[p1].edges = new vtkIdList(6,6);
-        }
-        if ( Verts[p2].edges == NULL )
-        {
-          Verts[p2].edges = vtkIdList::New();
-          Verts[p2].edges->Allocate(16,6);
-          // Verts[p2].edges = new vtkIdList(6,6);
+          if ( j == (npts-1) ) //end-of-line marked FIXED
+          {
+            Verts[pts[j]].type = VTK_FIXED_VERTEX;
+          }
+          else if ( j == 0 ) //beginning-of-line marked FIXED
+          {
+            Verts[pts[0]].type = VTK_FIXED_VERTEX;
+            inPts->GetPoint(pts[0],x2);
+            inPts->GetPoint(pts[1],x3);
+          }
+          else //is edge vertex (unless already edge vertex!)
+          {
+            Verts[pts[j]].type = VTK_FEATURE_EDGE_VERTEX;
+            Verts[pts[j]].edges = vtkIdList::New();
+            Verts[pts[j]].edges->SetNumberOfIds(2);
+            //Verts[pts[j]].edges = new vtkIdList(2,2);
+            Verts[pts[j]].edges->SetId(0,pts[j-1]);
+            Verts[pts[j]].edges->SetId(1,pts[j+1]);
+          }
+        } //if simple vertex
+
+        else if ( Verts[pts[j]].type == VTK_FEATURE_EDGE_VERTEX )
+        { //multiply connected, becomes fixed!
+          Verts[pts[j]].type = VTK_FIXED_VERTEX;
+          Verts[pts[j]].edges->Delete();
+          Verts[pts[j]].edges = NULL;
         }
 
-        Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
-        numNei = neighbors->GetNumberOfIds();
+      } //for all points in this line
+    } //for all lines
+
+    this->UpdateProgress(0.25);
+
+    // now polygons and triangle strips-------------------------------
+    inPolys=input->GetPolys();
+    numPolys = inPolys->GetNumberOfCells();
+    inStrips=input->GetStrips();
+    numStrips = inStrips->GetNumberOfCells();
+
+    if ( numPolys > 0 || numStrips > 0 )
+    { //build cell structure
+      vtkCellArray *polys;
+      vtkIdType cellId;
+      int numNei, nei, edge;
+      vtkIdType numNeiPts;
+      vtkIdType *neiPts;
+      double normal[3], neiNormal[3];
+      vtkIdList *neighbors;
+
+      inMesh = vtkPolyData::New();
+      inMesh->SetPoints(inPts);
+      inMesh->SetPolys(inPolys);
+      Mesh = inMesh;
+      neighbors = vtkIdList::New();
+      neighbors->Allocate(VTK_CELL_SIZE);
+
+      if ( (numStrips = inStrips->GetNumberOfCells()) > 0 )
+      { // convert data to triangles
+        inMesh->SetStrips(inStrips);
+        toTris = vtkTriangleFilter::New();
+        toTris->SetInputData(inMesh);
+        toTris->Update();
+        Mesh = toTris->GetOutput();
+      }
 
-        edge = VTK_SIMPLE_VERTEX;
-        if ( numNei == 0 )
-        {
-          edge = VTK_BOUNDARY_EDGE_VERTEX;
-        }
+      Mesh->BuildLinks(); //to do neighborhood searching
+      polys = Mesh->GetPolys();
 
-        else if ( numNei >= 2 )
+      for (cellId=0, polys->InitTraversal(); polys->GetNextCell(npts,pts);
+           cellId++)
+      {
+        for (i=0; i < npts; i++)
         {
-          // non-manifold case, check nonmanifold smoothing state
-          if (!this->NonManifoldSmoothing)
+          p1 = pts[i];
+          p2 = pts[(i+1)%npts];
+
+          if ( Verts[p1].edges == NULL )
+          {
+            Verts[p1].edges = vtkIdList::New();
+            Verts[p1].edges->Allocate(16,6);
+            // Verts[p1].edges = new vtkIdList(6,6);
+          }
+          if ( Verts[p2].edges == NULL )
+          {
+            Verts[p2].edges = vtkIdList::New();
+            Verts[p2].edges->Allocate(16,6);
+            // Verts[p2].edges = new vtkIdList(6,6);
+          }
+
+          Mesh->GetCellEdgeNeighbors(cellId,p1,p2,neighbors);
+          numNei = neighbors->GetNumberOfIds();
+
+          edge = VTK_SIMPLE_VERTEX;
+          if ( numNei == 0 )
+          {
+            edge = VTK_BOUNDARY_EDGE_VERTEX;
+          }
+
+          else if ( numNei >= 2 )
           {
-            // check to make sure that this edge hasn't been marked already
-            for (j=0; j < numNei; j++)
+            // non-manifold case, check nonmanifold smoothing state
+            if (!this->NonManifoldSmoothing)
             {
-              if ( neighbors->GetId(j) < cellId )
+              // check to make sure that this edge hasn't been marked already
+              for (j=0; j < numNei; j++)
               {
-                break;
+                if ( neighbors->GetId(j) < cellId )
+                {
+                  break;
+                }
+              }
+              if ( j >= numNei )
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
               }
             }
-            if ( j >= numNei )
+          }
+
+          else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
+          {
+            if (this->FeatureEdgeSmoothing)
             {
-              edge = VTK_FEATURE_EDGE_VERTEX;
+              vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
+              Mesh->GetCellPoints(nei,numNeiPts,neiPts);
+              vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
+
+              if ( vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle )
+              {
+                edge = VTK_FEATURE_EDGE_VERTEX;
+              }
             }
           }
-        }
-
-        else if ( numNei == 1 && (nei=neighbors->GetId(0)) > cellId )
-        {
-          if (this->FeatureEdgeSmoothing)
+          else // a visited edge; skip rest of analysis
           {
-            vtkPolygon::ComputeNormal(inPts,npts,pts,normal);
-            Mesh->GetCellPoints(nei,numNeiPts,neiPts);
-            vtkPolygon::ComputeNormal(inPts,numNeiPts,neiPts,neiNormal);
+            continue;
+          }
 
-            if ( vtkMath::Dot(normal,neiNormal) <= CosFeatureAngle )
+          if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
+          {
+            Verts[p1].edges->Reset();
+            Verts[p1].edges->InsertNextId(p2);
+            Verts[p1].type = edge;
+          }
+          else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
+          (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
+          (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
+          {
+            Verts[p1].edges->InsertNextId(p2);
+            if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
             {
-              edge = VTK_FEATURE_EDGE_VERTEX;
+              Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
             }
           }
-        }
-        else // a visited edge; skip rest of analysis
-        {
-          continue;
-        }
 
-        if ( edge && Verts[p1].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p1].edges->Reset();
-          Verts[p1].edges->InsertNextId(p2);
-          Verts[p1].type = edge;
-        }
-        else if ( (edge && Verts[p1].type == VTK_BOUNDARY_EDGE_VERTEX) ||
-        (edge && Verts[p1].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p1].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p1].edges->InsertNextId(p2);
-          if ( Verts[p1].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+          if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
           {
-            Verts[p1].type = VTK_BOUNDARY_EDGE_VERTEX;
+            Verts[p2].edges->Reset();
+            Verts[p2].edges->InsertNextId(p1);
+            Verts[p2].type = edge;
           }
-        }
-
-        if ( edge && Verts[p2].type == VTK_SIMPLE_VERTEX )
-        {
-          Verts[p2].edges->Reset();
-          Verts[p2].edges->InsertNextId(p1);
-          Verts[p2].type = edge;
-        }
-        else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
-        (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
-        (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
-        {
-          Verts[p2].edges->InsertNextId(p1);
-          if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+          else if ( (edge && Verts[p2].type == VTK_BOUNDARY_EDGE_VERTEX ) ||
+          (edge && Verts[p2].type == VTK_FEATURE_EDGE_VERTEX) ||
+          (!edge && Verts[p2].type == VTK_SIMPLE_VERTEX ) )
           {
-            Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
+            Verts[p2].edges->InsertNextId(p1);
+            if ( Verts[p2].type && edge == VTK_BOUNDARY_EDGE_VERTEX )
+            {
+              Verts[p2].type = VTK_BOUNDARY_EDGE_VERTEX;
+            }
           }
         }
       }
-    }
-
-    //    delete inMesh; // delete this later, windowed sinc smoothing needs it
-    if (toTris)
-    {
-      toTris->Delete();
-    }
-    neighbors->Delete();
-  }//if strips or polys
 
-  this->UpdateProgress(0.50);
+      //    delete inMesh; // delete this later, windowed sinc smoothing needs it
+      if (toTris)
+      {
+        toTris->Delete();
+      }
+      neighbors->Delete();
+    }//if strips or polys
 
-  //post-process edge vertices to make sure we can smooth them
-  for (i=0; i<numPts; i++)
-  {
-    if ( Verts[i].type == VTK_SIMPLE_VERTEX )
-    {
-      numSimple++;
-    }
+    this->UpdateProgress(0.50);
 
-    else if ( Verts[i].type == VTK_FIXED_VERTEX )
+    //post-process edge vertices to make sure we can smooth them
+    for (i=0; i<numPts; i++)
     {
-      numFixed++;
-    }
-
-    else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
-    Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
-    { //see how many edges; if two, what the angle is
-
-      if ( !this->BoundarySmoothing &&
-      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      if ( Verts[i].type == VTK_SIMPLE_VERTEX )
       {
-        Verts[i].type = VTK_FIXED_VERTEX;
-        numBEdges++;
+        numSimple++;
       }
 
-      else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
+      else if ( Verts[i].type == VTK_FIXED_VERTEX )
       {
-        // can only smooth edges on 2-manifold surfaces
-        Verts[i].type = VTK_FIXED_VERTEX;
         numFixed++;
       }
 
-      else //check angle between edges
-      {
-        inPts->GetPoint(Verts[i].edges->GetId(0),x1);
-        inPts->GetPoint(i,x2);
-        inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+      else if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX ||
+      Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
+      { //see how many edges; if two, what the angle is
 
-        for (k=0; k<3; k++)
+        if ( !this->BoundarySmoothing &&
+        Verts[i].type == VTK_BOUNDARY_EDGE_VERTEX )
         {
-          l1[k] = x2[k] - x1[k];
-          l2[k] = x3[k] - x2[k];
+          Verts[i].type = VTK_FIXED_VERTEX;
+          numBEdges++;
         }
-        if ((vtkMath::Normalize(l1) >= 0.0) && (vtkMath::Normalize(l2) >= 0.0)
-            && (vtkMath::Dot(l1,l2) < CosEdgeAngle))
+
+        else if ( (npts = Verts[i].edges->GetNumberOfIds()) != 2 )
         {
-          numFixed++;
+          // can only smooth edges on 2-manifold surfaces
           Verts[i].type = VTK_FIXED_VERTEX;
+          numFixed++;
         }
-        else
+
+        else //check angle between edges
         {
-          if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+          inPts->GetPoint(Verts[i].edges->GetId(0),x1);
+          inPts->GetPoint(i,x2);
+          inPts->GetPoint(Verts[i].edges->GetId(1),x3);
+
+          for (k=0; k<3; k++)
+          {
+            l1[k] = x2[k] - x1[k];
+            l2[k] = x3[k] - x2[k];
+          }
+          if ((vtkMath::Normalize(l1) >= 0.0) && (vtkMath::Normalize(l2) >= 0.0)
+              && (vtkMath::Dot(l1,l2) < CosEdgeAngle))
           {
-            numFEdges++;
+            numFixed++;
+            Verts[i].type = VTK_FIXED_VERTEX;
           }
           else
           {
-            numBEdges++;
+            if ( Verts[i].type == VTK_FEATURE_EDGE_VERTEX )
+            {
+              numFEdges++;
+            }
+            else
+            {
+              numBEdges++;
+            }
           }
-        }
-      }//if along edge
-    }//if edge vertex
-  }//for all points
+        }//if along edge
+      }//if edge vertex
+    }//for all points
+  }
 
   vtkDebugMacro(<<"Found\n\t" << numSimple << " simple vertices\n\t"
                 << numFEdges << " feature edge vertices\n\t"
@@ -579,53 +755,62 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   }
 
   // first iteration
-  for (i=0; i<numPts; i++)
+  if (this->EnableSMP)
+  {
+    SincFirstPass first(topology, newPts[zero], newPts[one], newPts[three],
+                        c);
+    vtkSMPTools::For(0, numPts, first);
+  }
+  else
   {
-    if ( Verts[i].edges != NULL &&
-         (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+    for (i=0; i<numPts; i++)
     {
-      // point is allowed to move
-      newPts[zero]->GetPoint(i, x); //use current points
-      deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
-
-      // calculate the negative of the laplacian
-      for (j=0; j<npts; j++) //for all connected points
+      if ( Verts[i].edges != NULL &&
+           (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
       {
-        newPts[zero]->GetPoint(Verts[i].edges->GetId(j), y);
+        // point is allowed to move
+        newPts[zero]->GetPoint(i, x); //use current points
+        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+
+        // calculate the negative of the laplacian
+        for (j=0; j<npts; j++) //for all connected points
+        {
+          newPts[zero]->GetPoint(Verts[i].edges->GetId(j), y);
+          for (k=0; k<3; k++)
+          {
+            deltaX[k] += (x[k] - y[k]) / npts;
+          }
+        }
+        // newPts[one] = newPts[zero] - 0.5 newPts[one]
         for (k=0; k<3; k++)
         {
-          deltaX[k] += (x[k] - y[k]) / npts;
+          deltaX[k] = x[k] - 0.5*deltaX[k];
         }
-      }
-      // newPts[one] = newPts[zero] - 0.5 newPts[one]
-      for (k=0; k<3; k++)
-      {
-        deltaX[k] = x[k] - 0.5*deltaX[k];
-      }
-      newPts[one]->SetPoint(i, deltaX);
+        newPts[one]->SetPoint(i, deltaX);
 
-      // calculate newPts[three] = c0 newPts[zero] + c1 newPts[one]
-      for (k=0; k < 3; k++)
-      {
-        deltaX[k] = c[0]*x[k] + c[1]*deltaX[k];
-      }
-      if (Verts[i].type == VTK_FIXED_VERTEX)
-      {
-        newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-      }
+        // calculate newPts[three] = c0 newPts[zero] + c1 newPts[one]
+        for (k=0; k < 3; k++)
+        {
+          deltaX[k] = c[0]*x[k] + c[1]*deltaX[k];
+        }
+        if (Verts[i].type == VTK_FIXED_VERTEX)
+        {
+          newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
+        }
+        else
+        {
+          newPts[three]->SetPoint(i, deltaX);
+        }
+      }//if can move point
       else
       {
-        newPts[three]->SetPoint(i, deltaX);
+        // point is not allowed to move, just use the old point...
+        // (zero out the Laplacian)
+        newPts[one]->SetPoint(i, zerovector);
+        newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
       }
-    }//if can move point
-    else
-    {
-      // point is not allowed to move, just use the old point...
-      // (zero out the Laplacian)
-      newPts[one]->SetPoint(i, zerovector);
-      newPts[three]->SetPoint(i, newPts[zero]->GetPoint(i));
-    }
-  }//for all points
+    }//for all points
+  }
 
   // for the rest of the iterations
   for ( iterationNumber=2;
@@ -641,53 +826,62 @@ int vtkWindowedSincPolyDataFilter::RequestData(
       }
     }
 
-    for (i=0; i<numPts; i++)
+    if (this->EnableSMP)
     {
-      if ( Verts[i].edges != NULL &&
-           (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+      SincPass pass(topology, newPts[zero], newPts[one], newPts[two],
+                    newPts[three], c[iterationNumber]);
+      vtkSMPTools::For(0, numPts, pass);
+    }
+    else
+    {
+      for (i=0; i<numPts; i++)
       {
-        // point is allowed to move
-        newPts[zero]->GetPoint(i, p_x0); //use current points
-        newPts[one]->GetPoint(i, p_x1);
+        if ( Verts[i].edges != NULL &&
+             (npts = Verts[i].edges->GetNumberOfIds()) > 0 )
+        {
+          // point is allowed to move
+          newPts[zero]->GetPoint(i, p_x0); //use current points
+          newPts[one]->GetPoint(i, p_x1);
 
-        deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
+          deltaX[0] = deltaX[1] = deltaX[2] = 0.0;
 
-        // calculate the negative laplacian of x1
-        for (j=0; j<npts; j++)
-        {
-          newPts[one]->GetPoint(Verts[i].edges->GetId(j), y);
+          // calculate the negative laplacian of x1
+          for (j=0; j<npts; j++)
+          {
+            newPts[one]->GetPoint(Verts[i].edges->GetId(j), y);
+            for (k=0; k<3; k++)
+            {
+              deltaX[k] += (p_x1[k] - y[k]) / npts;
+            }
+          }//for all connected points
+
+          // Taubin:  x2 = (x1 - x0) + (x1 - x2)
           for (k=0; k<3; k++)
           {
-            deltaX[k] += (p_x1[k] - y[k]) / npts;
+            deltaX[k] = p_x1[k] - p_x0[k] + p_x1[k] - deltaX[k];
           }
-        }//for all connected points
-
-        // Taubin:  x2 = (x1 - x0) + (x1 - x2)
-        for (k=0; k<3; k++)
-        {
-          deltaX[k] = p_x1[k] - p_x0[k] + p_x1[k] - deltaX[k];
-        }
-        newPts[two]->SetPoint(i, deltaX);
+          newPts[two]->SetPoint(i, deltaX);
 
-        // smooth the vertex (x3 = x3 + cj x2)
-        newPts[three]->GetPoint(i, p_x3);
-        for (k=0;k<3;k++)
-        {
-          xNew[k] = p_x3[k] + c[iterationNumber] * deltaX[k];
-        }
-        if (Verts[i].type != VTK_FIXED_VERTEX)
+          // smooth the vertex (x3 = x3 + cj x2)
+          newPts[three]->GetPoint(i, p_x3);
+          for (k=0;k<3;k++)
+          {
+            xNew[k] = p_x3[k] + c[iterationNumber] * deltaX[k];
+          }
+          if (Verts[i].type != VTK_FIXED_VERTEX)
+          {
+            newPts[three]->SetPoint(i,xNew);
+          }
+        }//if can move point
+        else
         {
-          newPts[three]->SetPoint(i,xNew);
+          // point is not allowed to move, just use the old point...
+          // (zero out the Laplacian)
+          newPts[one]->SetPoint(i, zerovector);
+          newPts[two]->SetPoint(i, zerovector);
         }
-      }//if can move point
-      else
-      {
-        // point is not allowed to move, just use the old point...
-        // (zero out the Laplacian)
-        newPts[one]->SetPoint(i, zerovector);
-        newPts[two]->SetPoint(i, zerovector);
-      }
-    }//for all points
+      }//for all points
+    }
 
     // update the pointers. three is always three. all other pointers
     // shift by one and wrap.
@@ -780,14 +974,20 @@ int vtkWindowedSincPolyDataFilter::RequestData(
   output->SetStrips(input->GetStrips());
 
   // finally delete the constructed (local) mesh
-  inMesh->Delete();
+  if (inMesh)
+  {
+    inMesh->Delete();
+  }
 
   //free up connectivity storage
-  for (i=0; i<numPts; i++)
+  if (Verts)
   {
-    if ( Verts[i].edges != NULL ) {Verts[i].edges->Delete();}
+    for (i=0; i<numPts; i++)
+    {
+      if ( Verts[i].edges != NULL ) {Verts[i].edges->Delete();}
+    }
+    delete [] Verts;
   }
-  delete [] Verts;
 
   return 1;
 }
@@ -806,4 +1006,5 @@ void vtkWindowedSincPolyDataFilter::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Nonmanifold Smoothing: " << (this->NonManifoldSmoothing ? "On\n" : "Off\n");
   os << indent << "Generate Error Scalars: " << (this->GenerateErrorScalars ? "On\n" : "Off\n");
   os << indent << "Generate Error Vectors: " << (this->GenerateErrorVectors ? "On\n" : "Off\n");
+  os << indent << "Enable SMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -125,6 +125,12 @@
  * ivar GenerateErrorVectors is on, then a vector representing change in
  * position is computed.
  *
+ * When EnableSMP is on, the topological analysis and the smoothing passes
+ * are done in parallel (via vtkSMPTools). The neighbors of every point are
+ * then gathered once in a compact array, and each pass updates all the
+ * points at once from the results of the previous pass. The output is
+ * identical to the serial one, whatever the number of threads.
+ *
  * @warning
  * The smoothing operation reduces high frequency information in the
  * geometry of the mesh. With excessive smoothing important details may be
@@ -251,6 +257,16 @@ public:
   vtkBooleanMacro(GenerateErrorVectors,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded smoothing (see the class documentation).
+   * This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
  protected:
   vtkWindowedSincPolyDataFilter();
   ~vtkWindowedSincPolyDataFilter() VTK_OVERRIDE {}
@@ -267,6 +283,7 @@ public:
   int GenerateErrorScalars;
   int GenerateErrorVectors;
   int NormalizeCoordinates;
+  int EnableSMP;
 private:
   vtkWindowedSincPolyDataFilter(const vtkWindowedSincPolyDataFilter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkWindowedSincPolyDataFilter&) VTK_DELETE_FUNCTION;
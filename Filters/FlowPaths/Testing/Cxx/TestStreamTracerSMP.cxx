@@ -0,0 +1,148 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestStreamTracerSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded integration of the seeds by vtkStreamTracer
+// produces the same streamlines as the serial one.
+
+#include "vtkCellData.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkImageData.h"
+#include "vtkImageGradient.h"
+#include "vtkMultiBlockDataSet.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkRTAnalyticSource.h"
+#include "vtkSmartPointer.h"
+#include "vtkStreamTracer.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+namespace
+{
+// The gradient of the analytic source over the given extent.
+vtkSmartPointer<vtkImageData> MakeImage(int x0, int x1)
+{
+  vtkNew<vtkRTAnalyticSource> source;
+  source->SetWholeExtent(x0, x1, -10, 10, -10, 10);
+  vtkNew<vtkImageGradient> gradient;
+  gradient->SetDimensionality(3);
+  gradient->SetInputConnection(source->GetOutputPort());
+  gradient->Update();
+  vtkSmartPointer<vtkImageData> image = vtkSmartPointer<vtkImageData>::New();
+  image->DeepCopy(gradient->GetOutput());
+  image->GetPointData()->SetActiveVectors("RTDataGradient");
+  return image;
+}
+
+// A point data array named name, constant over the dataset.
+void AddConstantArray(vtkDataSet *data, const char *name, double value)
+{
+  vtkNew<vtkDoubleArray> array;
+  array->SetName(name);
+  array->SetNumberOfTuples(data->GetNumberOfPoints());
+  for (vtkIdType i = 0; i < data->GetNumberOfPoints(); ++i)
+  {
+    array->SetValue(i, value);
+  }
+  data->GetPointData()->AddArray(array.Get());
+}
+
+bool CheckStreamlines(vtkDataObject *input, vtkPolyData *seeds,
+                      int direction, int integrator, int interpolator)
+{
+  vtkNew<vtkStreamTracer> serial;
+  vtkNew<vtkStreamTracer> threaded;
+  vtkStreamTracer *tracers[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    tracers[j]->SetInputData(input);
+    tracers[j]->SetSourceData(seeds);
+    tracers[j]->SetMaximumPropagation(20.0);
+    tracers[j]->SetIntegrationDirection(direction);
+    tracers[j]->SetIntegratorType(integrator);
+    tracers[j]->SetInterpolatorType(interpolator);
+    tracers[j]->SetEnableSMP(j);
+    tracers[j]->Update();
+  }
+  return threaded->GetOutput()->GetNumberOfCells() > 0 &&
+    vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                          threaded->GetOutput());
+}
+}
+
+int TestStreamTracerSMP(int, char *[])
+{
+  // Seeds on a lattice, some of which are outside of the datasets.
+  vtkNew<vtkPoints> seedPoints;
+  for (int k = -2; k <= 2; ++k)
+  {
+    for (int j = -2; j <= 2; ++j)
+    {
+      for (int i = -3; i <= 3; ++i)
+      {
+        seedPoints->InsertNextPoint(3.3 * i + 0.1, 4.1 * j, 4.3 * k + 0.2);
+      }
+    }
+  }
+  vtkNew<vtkPolyData> seeds;
+  seeds->SetPoints(seedPoints.Get());
+
+  // An image, tetrahedra, and two images with different point data arrays
+  // that the streamlines cross.
+  vtkSmartPointer<vtkImageData> image = MakeImage(-10, 10);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image);
+  tetrahedra->Update();
+  vtkUnstructuredGrid *tets = tetrahedra->GetOutput();
+  tets->GetPointData()->SetActiveVectors("RTDataGradient");
+
+  vtkSmartPointer<vtkImageData> image0 = MakeImage(-10, 0);
+  AddConstantArray(image0, "array 0", 1.0);
+  vtkSmartPointer<vtkImageData> image1 = MakeImage(0, 10);
+  AddConstantArray(image1, "array 1", 2.0);
+  vtkNew<vtkMultiBlockDataSet> blocks;
+  blocks->SetNumberOfBlocks(2);
+  blocks->SetBlock(0, image0);
+  blocks->SetBlock(1, image1);
+
+  vtkDataObject *inputs[3] = {image, tets, blocks.Get()};
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int direction = vtkStreamTracer::FORWARD;
+         direction <= vtkStreamTracer::BOTH; ++direction)
+    {
+      for (int integrator = vtkStreamTracer::RUNGE_KUTTA2;
+           integrator <= vtkStreamTracer::RUNGE_KUTTA45; ++integrator)
+      {
+        for (int interpolator = 0; interpolator < 2; ++interpolator)
+        {
+          if (!CheckStreamlines(inputs[i], seeds.Get(), direction,
+                                integrator, interpolator))
+          {
+            cerr << "Threaded streamlines differ for input " << i
+                 << ", direction " << direction << ", integrator "
+                 << integrator << " and interpolator " << interpolator
+                 << endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
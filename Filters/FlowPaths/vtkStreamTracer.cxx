@@ -45,8 +45,11 @@ PURPOSE.  See the above copyright notice for more information.
 #include "vtkRungeKutta2.h"
 #include "vtkRungeKutta4.h"
 #include "vtkRungeKutta45.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 
+#include <map>
 #include <vector>
 
 vtkObjectFactoryNewMacro(vtkStreamTracer)
@@ -128,6 +131,8 @@ vtkStreamTracer::vtkStreamTracer()
   this->HasMatchingPointAttributes = true;
 
   this->SurfaceStreamlines = false;
+
+  this->EnableSMP = 0;
 }
 
 vtkStreamTracer::~vtkStreamTracer()
@@ -514,12 +519,23 @@ int vtkStreamTracer::RequestData(
       double propagation = 0;
       vtkIdType numSteps = 0;
       double integrationTime = 0;
-      this->Integrate(input0->GetPointData(), output,
-                      seeds, seedIds,
-                      integrationDirections,
-                      lastPoint, func,
-                      maxCellSize, vecType,vecName,
-                      propagation, numSteps, integrationTime);
+      if (this->EnableSMP)
+      {
+        this->IntegrateSMP(input0->GetPointData(), output,
+                           seeds, seedIds,
+                           integrationDirections,
+                           func,
+                           maxCellSize, vecType, vecName);
+      }
+      else
+      {
+        this->Integrate(input0->GetPointData(), output,
+                        seeds, seedIds,
+                        integrationDirections,
+                        lastPoint, func,
+                        maxCellSize, vecType,vecName,
+                        propagation, numSteps, integrationTime);
+      }
     }
     func->Delete();
     seeds->Delete();
@@ -1202,6 +1218,661 @@ void vtkStreamTracer::Integrate(vtkPointData *input0Data,
   return;
 }
 
+//----------------------------------------------------------------------------
+// Integrate ranges of seeds. Each thread has its own velocity field, so that
+// the last cell and weights cached by the field are not shared, and appends
+// its streamlines to its own polydata. The points of the streamline of each
+// seed are recorded so that IntegrateSMP() can gather them in seed order.
+struct vtkStreamTracer::IntegrateSeeds
+{
+  // The points of the streamline of a seed in the polydata of a thread.
+  struct Streamline
+  {
+    vtkPolyData *Lines;
+    vtkIdType FirstPoint;
+    vtkIdType NumberOfPoints;
+    int ReasonForTermination;
+  };
+
+  struct LocalData
+  {
+    vtkSmartPointer<vtkAbstractInterpolatedVelocityField> Func;
+    vtkSmartPointer<vtkInitialValueProblemSolver> Integrator;
+    vtkSmartPointer<vtkGenericCell> Cell;
+    std::vector<double> Weights;
+    vtkSmartPointer<vtkDoubleArray> CellVectors;
+    vtkSmartPointer<vtkPolyData> Lines;
+    vtkSmartPointer<vtkDoubleArray> Time;
+    vtkSmartPointer<vtkDoubleArray> VelocityVectors;
+    vtkSmartPointer<vtkDoubleArray> Vorticity;
+    vtkSmartPointer<vtkDoubleArray> Rotation;
+    vtkSmartPointer<vtkDoubleArray> AngularVelocity;
+  };
+
+  vtkStreamTracer *Tracer;
+  vtkPointData *InputData;
+  vtkDataArray *SeedSource;
+  vtkIdList *SeedIds;
+  vtkIntArray *IntegrationDirections;
+  vtkAbstractInterpolatedVelocityField *Func;
+  const std::vector<vtkDataSet*> &DataSets;
+  int MaxCellSize;
+  int VecType;
+  const char *VecName;
+  Streamline *Streamlines;
+  vtkSMPThreadLocal<LocalData> Local;
+
+  IntegrateSeeds(vtkStreamTracer *tracer, vtkPointData *inputData,
+                 vtkDataArray *seedSource, vtkIdList *seedIds,
+                 vtkIntArray *integrationDirections,
+                 vtkAbstractInterpolatedVelocityField *func,
+                 const std::vector<vtkDataSet*> &dataSets, int maxCellSize,
+                 int vecType, const char *vecName, Streamline *streamlines) :
+    Tracer(tracer), InputData(inputData), SeedSource(seedSource),
+    SeedIds(seedIds), IntegrationDirections(integrationDirections),
+    Func(func), DataSets(dataSets), MaxCellSize(maxCellSize),
+    VecType(vecType), VecName(vecName), Streamlines(streamlines)
+  {
+  }
+
+  void Initialize()
+  {
+    LocalData &local = this->Local.Local();
+
+    // Copy the velocity field, like CheckInputs() sets it up.
+    vtkAbstractInterpolatedVelocityField *func = this->Func->NewInstance();
+    local.Func.TakeReference(func);
+    func->CopyParameters(this->Func);
+    if (vtkAMRInterpolatedVelocityField *amrFunc =
+        vtkAMRInterpolatedVelocityField::SafeDownCast(func))
+    {
+      amrFunc->SetAMRData(vtkAMRInterpolatedVelocityField::SafeDownCast(
+                            this->Func)->GetAmrDataSet());
+    }
+    else if (vtkCompositeInterpolatedVelocityField *compositeFunc =
+             vtkCompositeInterpolatedVelocityField::SafeDownCast(func))
+    {
+      for (size_t i = 0; i < this->DataSets.size(); ++i)
+      {
+        compositeFunc->AddDataSet(this->DataSets[i]);
+      }
+    }
+    func->SelectVectors(this->VecType, this->VecName);
+    if (this->Tracer->SurfaceStreamlines)
+    {
+      func->SetForceSurfaceTangentVector(true);
+      func->SetSurfaceDataset(true);
+    }
+
+    local.Integrator.TakeReference(
+      this->Tracer->GetIntegrator()->NewInstance());
+    local.Integrator->SetFunctionSet(func);
+    local.Cell = vtkSmartPointer<vtkGenericCell>::New();
+    local.Weights.resize(this->MaxCellSize > 0 ? this->MaxCellSize : 1);
+
+    local.Lines = vtkSmartPointer<vtkPolyData>::New();
+    vtkNew<vtkPoints> points;
+    local.Lines->SetPoints(points.Get());
+    local.Lines->GetPointData()->InterpolateAllocate(
+      this->InputData, this->Tracer->MaximumNumberOfSteps);
+
+    local.Time = vtkSmartPointer<vtkDoubleArray>::New();
+    local.Time->SetName("IntegrationTime");
+    if (this->VecType != vtkDataObject::POINT)
+    {
+      local.VelocityVectors = vtkSmartPointer<vtkDoubleArray>::New();
+      local.VelocityVectors->SetName(this->VecName);
+      local.VelocityVectors->SetNumberOfComponents(3);
+    }
+    if (this->Tracer->ComputeVorticity)
+    {
+      local.CellVectors = vtkSmartPointer<vtkDoubleArray>::New();
+      local.CellVectors->SetNumberOfComponents(3);
+      local.CellVectors->Allocate(3*VTK_CELL_SIZE);
+
+      local.Vorticity = vtkSmartPointer<vtkDoubleArray>::New();
+      local.Vorticity->SetName("Vorticity");
+      local.Vorticity->SetNumberOfComponents(3);
+
+      local.Rotation = vtkSmartPointer<vtkDoubleArray>::New();
+      local.Rotation->SetName("Rotation");
+
+      local.AngularVelocity = vtkSmartPointer<vtkDoubleArray>::New();
+      local.AngularVelocity->SetName("AngularVelocity");
+    }
+  }
+
+  void operator()(vtkIdType currentLine, vtkIdType endLine)
+  {
+    LocalData &local = this->Local.Local();
+    for ( ; currentLine < endLine; ++currentLine)
+    {
+      if (this->Tracer->GetAbortExecute())
+      {
+        break;
+      }
+      this->IntegrateSeed(local, currentLine);
+    }
+  }
+
+  // Add the arrays computed along the streamlines to the point data of the
+  // threads, after the interpolated attributes like in Integrate(). When
+  // the blocks do not have the same point attributes, the threads may have
+  // removed different arrays: only those that all the threads kept are
+  // kept.
+  void Reduce()
+  {
+    vtkSMPThreadLocal<LocalData>::iterator iter;
+    for (iter = this->Local.begin(); iter != this->Local.end(); ++iter)
+    {
+      vtkPointData *pd = iter->Lines->GetPointData();
+      if (!this->Tracer->HasMatchingPointAttributes)
+      {
+        vtkSMPThreadLocal<LocalData>::iterator other;
+        for (other = this->Local.begin(); other != this->Local.end(); ++other)
+        {
+          vtkPointData *otherPD = other->Lines->GetPointData();
+          for (int i = pd->GetNumberOfArrays() - 1; i >= 0; i--)
+          {
+            const char *name = pd->GetAbstractArray(i)->GetName();
+            if (!otherPD->GetAbstractArray(name))
+            {
+              pd->RemoveArray(name);
+            }
+          }
+        }
+      }
+    }
+    for (iter = this->Local.begin(); iter != this->Local.end(); ++iter)
+    {
+      vtkPointData *pd = iter->Lines->GetPointData();
+      pd->AddArray(iter->Time);
+      if (iter->VelocityVectors)
+      {
+        pd->AddArray(iter->VelocityVectors);
+      }
+      if (iter->Vorticity)
+      {
+        pd->AddArray(iter->Vorticity);
+        pd->AddArray(iter->Rotation);
+        pd->AddArray(iter->AngularVelocity);
+      }
+    }
+  }
+
+  // Integrate the streamline of a seed, like Integrate() does with zero
+  // initial propagation, steps and time.
+  void IntegrateSeed(LocalData &local, vtkIdType currentLine)
+  {
+    vtkStreamTracer *self = this->Tracer;
+    vtkAbstractInterpolatedVelocityField *func = local.Func;
+    vtkInitialValueProblemSolver *integrator = local.Integrator;
+    vtkGenericCell *cell = local.Cell;
+    double *weights = &local.Weights[0];
+    vtkPoints *outputPoints = local.Lines->GetPoints();
+    vtkPointData *outputPD = local.Lines->GetPointData();
+    vtkDoubleArray *time = local.Time;
+    vtkDoubleArray *cellVectors = local.CellVectors;
+    vtkDoubleArray *vorticity = local.Vorticity;
+    vtkDoubleArray *rotation = local.Rotation;
+    vtkDoubleArray *angularVel = local.AngularVelocity;
+    vtkInterpolatedVelocityField *surfaceFunc = self->SurfaceStreamlines ?
+      vtkInterpolatedVelocityField::SafeDownCast(func) : NULL;
+
+    Streamline &streamline = this->Streamlines[currentLine];
+    streamline.Lines = local.Lines;
+    streamline.FirstPoint = outputPoints->GetNumberOfPoints();
+    streamline.NumberOfPoints = 0;
+    streamline.ReasonForTermination = OUT_OF_LENGTH;
+
+    int direction = 1;
+    if (this->IntegrationDirections->GetValue(currentLine) == BACKWARD)
+    {
+      direction = -1;
+    }
+
+    double propagation = 0;
+    vtkIdType numSteps = 0;
+    double integrationTime = 0;
+
+    // temporary variables used in the integration
+    double point1[3], point2[3], pcoords[3], vort[3], omega, velocity[3];
+    vtkIdType index, numPts = 0;
+    int i;
+
+    // Clear the last cell to avoid starting a search from
+    // the last point of the previous streamline
+    func->ClearLastCellId();
+
+    // Initial point
+    this->SeedSource->GetTuple(this->SeedIds->GetId(currentLine), point1);
+    memcpy(point2, point1, 3*sizeof(double));
+    if (!func->FunctionValues(point1, velocity))
+    {
+      return;
+    }
+
+    if (propagation >= self->MaximumPropagation)
+    {
+      return;
+    }
+
+    numPts++;
+    vtkIdType nextPoint = outputPoints->InsertNextPoint(point1);
+    double lastInsertedPoint[3];
+    outputPoints->GetPoint(nextPoint, lastInsertedPoint);
+    time->InsertNextValue(integrationTime);
+
+    // We will always pass an arc-length step size to the integrator.
+    IntervalInformation stepSize;  // either positive or negative
+    stepSize.Unit  = LENGTH_UNIT;
+    stepSize.Interval = 0;
+    IntervalInformation aStep; // always positive
+    aStep.Unit = LENGTH_UNIT;
+    double step, minStep=0, maxStep=0;
+    double stepTaken;
+    double speed;
+    double cellLength;
+    int retVal=OUT_OF_LENGTH, tmp;
+
+    // Make sure we use the dataset found by the velocity field
+    vtkDataSet *input = func->GetLastDataSet();
+    vtkPointData *inputPD = input->GetPointData();
+    vtkDataArray *inVectors =
+      input->GetAttributesAsFieldData(this->VecType)->GetArray(this->VecName);
+    // Convert intervals to arc-length unit
+    input->GetCell(func->GetLastCellId(), cell);
+    cellLength = sqrt(static_cast<double>(cell->GetLength2()));
+    speed = vtkMath::Norm(velocity);
+    // Never call conversion methods if speed == 0
+    if ( speed != 0.0 )
+    {
+      self->ConvertIntervals( stepSize.Interval, minStep, maxStep,
+                              direction, cellLength );
+    }
+
+    // Interpolate all point attributes on first point
+    func->GetLastWeights(weights);
+    InterpolatePoint(outputPD, inputPD, nextPoint, cell->PointIds, weights,
+                     self->HasMatchingPointAttributes);
+    if (local.VelocityVectors)
+    {
+      local.VelocityVectors->InsertNextTuple(velocity);
+    }
+
+    // Compute vorticity if required
+    if (vorticity)
+    {
+      if (this->VecType == vtkDataObject::POINT)
+      {
+        inVectors->GetTuples(cell->PointIds, cellVectors);
+        func->GetLastLocalCoordinates(pcoords);
+        self->CalculateVorticity(cell, pcoords, cellVectors, vort);
+      }
+      else
+      {
+        vort[0] = 0;
+        vort[1] = 0;
+        vort[2] = 0;
+      }
+      vorticity->InsertNextTuple(vort);
+      // local rotation = vorticity . unit tangent ( i.e. velocity/speed )
+      if (speed != 0.0)
+      {
+        omega = vtkMath::Dot(vort, velocity);
+        omega /= speed;
+        omega *= self->RotationScale;
+      }
+      else
+      {
+        omega = 0.0;
+      }
+      angularVel->InsertNextValue(omega);
+      rotation->InsertNextValue(0.0);
+    }
+
+    double error = 0;
+
+    // Integrate until the maximum propagation length is reached,
+    // maximum number of steps is reached or until a boundary is encountered.
+    while ( propagation < self->MaximumPropagation )
+    {
+      if (numSteps > self->MaximumNumberOfSteps)
+      {
+        retVal = OUT_OF_STEPS;
+        break;
+      }
+
+      if ( numSteps++ % 1000 == 1 && self->GetAbortExecute() )
+      {
+        break;
+      }
+
+      // Never call conversion methods if speed == 0
+      if ( (speed == 0) || (speed <= self->TerminalSpeed) )
+      {
+        retVal = STAGNATION;
+        break;
+      }
+
+      // If, with the next step, propagation will be larger than
+      // max, reduce it so that it is (approximately) equal to max.
+      aStep.Interval = fabs( stepSize.Interval );
+
+      if ( ( propagation + aStep.Interval ) > self->MaximumPropagation )
+      {
+        aStep.Interval = self->MaximumPropagation - propagation;
+        if ( stepSize.Interval >= 0 )
+        {
+          stepSize.Interval = vtkStreamTracer::ConvertToLength( aStep, cellLength );
+        }
+        else
+        {
+          stepSize.Interval = vtkStreamTracer::ConvertToLength( aStep, cellLength ) * ( -1.0 );
+        }
+        maxStep = stepSize.Interval;
+      }
+
+      // Calculate the next step using the integrator provided
+      // Break if the next point is out of bounds.
+      func->SetNormalizeVector( true );
+      tmp = integrator->ComputeNextStep( point1, point2, 0, stepSize.Interval,
+                                         stepTaken, minStep, maxStep,
+                                         self->MaximumError, error );
+      func->SetNormalizeVector( false );
+      if ( tmp != 0 )
+      {
+        retVal = tmp;
+        break;
+      }
+
+      // This is the next starting point
+      if (surfaceFunc)
+      {
+        if (surfaceFunc->SnapPointOnCell(point2, point1) != 1)
+        {
+          retVal = OUT_OF_DOMAIN;
+          break;
+        }
+      }
+      else
+      {
+        for (i = 0; i < 3; i++)
+        {
+          point1[i] = point2[i];
+        }
+      }
+
+      // Interpolate the velocity at the next point
+      if ( !func->FunctionValues(point2, velocity) )
+      {
+        retVal = OUT_OF_DOMAIN;
+        break;
+      }
+
+      // Use average speed to check if it is below stagnation threshold
+      double speed2 = vtkMath::Norm(velocity);
+      if ( (speed+speed2)/2 <= self->TerminalSpeed )
+      {
+        retVal = STAGNATION;
+        break;
+      }
+
+      integrationTime += stepTaken / speed;
+      propagation += fabs( stepSize.Interval );
+
+      // Make sure we use the dataset found by the velocity field
+      input = func->GetLastDataSet();
+      inputPD = input->GetPointData();
+      inVectors = input->GetAttributesAsFieldData(this->VecType)
+        ->GetArray(this->VecName);
+
+      // Calculate cell length and speed to be used in unit conversions
+      input->GetCell(func->GetLastCellId(), cell);
+      cellLength = sqrt(static_cast<double>(cell->GetLength2()));
+      speed = speed2;
+
+      // Check if conversion to float will produce a point in same place
+      float convertedPoint[3];
+      for (i = 0; i < 3; i++)
+      {
+        convertedPoint[i] = point1[i];
+      }
+      if (lastInsertedPoint[0] != convertedPoint[0] ||
+          lastInsertedPoint[1] != convertedPoint[1] ||
+          lastInsertedPoint[2] != convertedPoint[2])
+      {
+        // Point is valid. Insert it.
+        numPts++;
+        nextPoint = outputPoints->InsertNextPoint(point1);
+        outputPoints->GetPoint(nextPoint, lastInsertedPoint);
+        time->InsertNextValue(integrationTime);
+
+        // Interpolate all point attributes on current point
+        func->GetLastWeights(weights);
+        InterpolatePoint(outputPD, inputPD, nextPoint, cell->PointIds,
+                         weights, self->HasMatchingPointAttributes);
+
+        if (local.VelocityVectors)
+        {
+          local.VelocityVectors->InsertNextTuple(velocity);
+        }
+        // Compute vorticity if required
+        if (vorticity)
+        {
+          if (this->VecType == vtkDataObject::POINT)
+          {
+            inVectors->GetTuples(cell->PointIds, cellVectors);
+            func->GetLastLocalCoordinates(pcoords);
+            self->CalculateVorticity(cell, pcoords, cellVectors, vort);
+          }
+          else
+          {
+            vort[0] = 0;
+            vort[1] = 0;
+            vort[2] = 0;
+          }
+          vorticity->InsertNextTuple(vort);
+          // angular velocity = vorticity . unit tangent ( i.e. velocity/speed )
+          // rotation = sum ( angular velocity * stepSize )
+          omega = vtkMath::Dot(vort, velocity);
+          omega /= speed;
+          omega *= self->RotationScale;
+          index = angularVel->InsertNextValue(omega);
+          rotation->InsertNextValue(rotation->GetValue(index-1) +
+                                    (angularVel->GetValue(index-1) + omega)/2 *
+                                    (integrationTime - time->GetValue(index-1)));
+        }
+      }
+
+      // Never call conversion methods if speed == 0
+      if ( (speed == 0) || (speed <= self->TerminalSpeed) )
+      {
+        retVal = STAGNATION;
+        break;
+      }
+
+      // Convert all intervals to arc length
+      self->ConvertIntervals( step, minStep, maxStep, direction, cellLength );
+
+      // If the solver is adaptive, keep the next step size within the
+      // minimum and maximum steps, which depend on the cell size.
+      if (integrator->IsAdaptive())
+      {
+        if (fabs(stepSize.Interval) < fabs(minStep))
+        {
+          stepSize.Interval = fabs( minStep ) *
+                                stepSize.Interval / fabs( stepSize.Interval );
+        }
+        else if (fabs(stepSize.Interval) > fabs(maxStep))
+        {
+          stepSize.Interval = fabs( maxStep ) *
+                                stepSize.Interval / fabs( stepSize.Interval );
+        }
+      }
+      else
+      {
+        stepSize.Interval = step;
+      }
+    }
+
+    streamline.NumberOfPoints = numPts;
+    streamline.ReasonForTermination = retVal;
+  }
+};
+
+//----------------------------------------------------------------------------
+void vtkStreamTracer::IntegrateSMP(vtkPointData *input0Data,
+                                   vtkPolyData* output,
+                                   vtkDataArray* seedSource,
+                                   vtkIdList* seedIds,
+                                   vtkIntArray* integrationDirections,
+                                   vtkAbstractInterpolatedVelocityField* func,
+                                   int maxCellSize,
+                                   int vecType,
+                                   const char *vecName)
+{
+  vtkIdType numLines = seedIds->GetNumberOfIds();
+  vtkDataSetAttributes* outputPD = output->GetPointData();
+  vtkDataSetAttributes* outputCD = output->GetCellData();
+
+  if (this->GetIntegrator() == 0)
+  {
+    vtkErrorMacro("No integrator is specified.");
+    return;
+  }
+
+  if (this->SurfaceStreamlines &&
+      !vtkInterpolatedVelocityField::SafeDownCast(func))
+  {
+    vtkWarningMacro(<< "Surface Streamlines works only with Point Locator "
+                       "Interpolated Velocity Field, setting it off");
+    this->SetSurfaceStreamlines(false);
+  }
+
+  // The datasets build their cell links, point locators and bounds on
+  // demand when cells are located. Build them here, so that the threads only
+  // read them.
+  std::vector<vtkDataSet*> dataSets;
+  vtkSmartPointer<vtkCompositeDataIterator> iter;
+  iter.TakeReference(this->InputData->NewIterator());
+  vtkNew<vtkGenericCell> cell;
+  vtkNew<vtkIdList> cellIds;
+  for (iter->GoToFirstItem(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+  {
+    vtkDataSet* input = vtkDataSet::SafeDownCast(iter->GetCurrentDataObject());
+    if (!input)
+    {
+      continue;
+    }
+    dataSets.push_back(input);
+    input->GetLength();
+    if (input->GetNumberOfPoints() > 0 && input->GetNumberOfCells() > 0)
+    {
+      double x[3], pcoords[3];
+      int subId;
+      std::vector<double> weights(input->GetMaxCellSize() + 1);
+      input->GetCell(0, cell.Get());
+      input->GetPointCells(0, cellIds.Get());
+      input->GetPoint(0, x);
+      input->FindCell(x, NULL, cell.Get(), -1, 0.0, subId, pcoords,
+                      &weights[0]);
+    }
+  }
+
+  // Integrate the seeds.
+  std::vector<IntegrateSeeds::Streamline> streamlines(numLines);
+  IntegrateSeeds integrate(this, input0Data, seedSource, seedIds,
+                           integrationDirections, func, dataSets,
+                           maxCellSize, vecType, vecName, &streamlines[0]);
+  vtkSMPTools::For(0, numLines, integrate);
+  if (this->GetAbortExecute() || integrate.Local.begin() == integrate.Local.end())
+  {
+    return;
+  }
+
+  // Gather the streamlines in the order of the seeds: number their points
+  // and build the lines and their cell data.
+  vtkNew<vtkCellArray> outputLines;
+  vtkNew<vtkIntArray> retVals;
+  retVals->SetName("ReasonForTermination");
+  vtkNew<vtkIntArray> sids;
+  sids->SetName("SeedIds");
+
+  std::map<vtkPolyData*, size_t> threadIndices;
+  std::vector<vtkSmartPointer<vtkIdList> > srcIds;
+  std::vector<vtkSmartPointer<vtkIdList> > dstIds;
+  vtkIdType numPts = 0;
+  for (vtkIdType line = 0; line < numLines; line++)
+  {
+    const IntegrateSeeds::Streamline &streamline = streamlines[line];
+    vtkIdType n = streamline.NumberOfPoints;
+    if (n == 0)
+    {
+      continue;
+    }
+    std::map<vtkPolyData*, size_t>::iterator thread =
+      threadIndices.find(streamline.Lines);
+    if (thread == threadIndices.end())
+    {
+      thread = threadIndices.insert(
+        std::make_pair(streamline.Lines, srcIds.size())).first;
+      srcIds.push_back(vtkSmartPointer<vtkIdList>::New());
+      dstIds.push_back(vtkSmartPointer<vtkIdList>::New());
+    }
+    vtkIdList *src = srcIds[thread->second];
+    vtkIdList *dst = dstIds[thread->second];
+    vtkIdType i;
+    for (i = 0; i < n; i++)
+    {
+      src->InsertNextId(streamline.FirstPoint + i);
+      dst->InsertNextId(numPts + i);
+    }
+    if (n > 1)
+    {
+      outputLines->InsertNextCell(n);
+      for (i = 0; i < n; i++)
+      {
+        outputLines->InsertCellPoint(numPts + i);
+      }
+      retVals->InsertNextValue(streamline.ReasonForTermination);
+      sids->InsertNextValue(seedIds->GetId(line));
+    }
+    numPts += n;
+  }
+
+  // Copy the points and their attributes. All the threads have the same
+  // point data arrays.
+  vtkNew<vtkPoints> outputPoints;
+  vtkPointData *threadPD = integrate.Local.begin()->Lines->GetPointData();
+  outputPD->CopyAllocate(threadPD, numPts);
+  std::map<vtkPolyData*, size_t>::iterator thread;
+  for (thread = threadIndices.begin(); thread != threadIndices.end(); ++thread)
+  {
+    vtkIdList *src = srcIds[thread->second];
+    vtkIdList *dst = dstIds[thread->second];
+    outputPoints->InsertPoints(dst, src, thread->first->GetPoints());
+    outputPD->CopyData(thread->first->GetPointData(), src, dst);
+  }
+
+  // Create the output polyline
+  output->SetPoints(outputPoints.Get());
+  if ( numPts > 1 )
+  {
+    // Assign geometry and attributes
+    output->SetLines(outputLines.Get());
+    if (this->GenerateNormalsInIntegrate)
+    {
+      this->GenerateNormals(output, 0, vecName);
+    }
+
+    outputCD->AddArray(retVals.Get());
+    outputCD->AddArray(sids.Get());
+  }
+
+  output->Squeeze();
+}
+
 void vtkStreamTracer::GenerateNormals(vtkPolyData* output, double* firstNormal,
                                       const char *vecName)
 {
@@ -1415,6 +2086,7 @@ void vtkStreamTracer::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Vorticity computation: "
      << (this->ComputeVorticity ? " On" : " Off") << endl;
   os << indent << "Rotation scale: " << this->RotationScale << endl;
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On" : "Off") << endl;
 }
 
 vtkExecutive* vtkStreamTracer::CreateDefaultExecutive()
@@ -289,6 +289,20 @@ public:
   vtkBooleanMacro(SurfaceStreamlines, bool);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the integration of the seeds in parallel (via
+   * vtkSMPTools). Each thread integrates its seeds with its own copy of the
+   * velocity field, and the streamlines are then gathered in the order of
+   * the seeds, so that the output is the same as without the flag. Note
+   * that interpolators using cell locators build their locators once per
+   * thread. This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
   enum
   {
     FORWARD,
@@ -383,6 +397,20 @@ protected:
                  double& propagation,
                  vtkIdType& numSteps,
                  double& integrationTime);
+  /**
+   * Integrate the seeds in parallel, see EnableSMP. Unlike Integrate(), the
+   * integration of each streamline starts with zero propagation, steps and
+   * time.
+   */
+  void IntegrateSMP(vtkPointData *inputData,
+                    vtkPolyData* output,
+                    vtkDataArray* seedSource,
+                    vtkIdList* seedIds,
+                    vtkIntArray* integrationDirections,
+                    vtkAbstractInterpolatedVelocityField* func,
+                    int maxCellSize,
+                    int vecType,
+                    const char *vecFieldName);
   double SimpleIntegrate(double seed[3],
                          double lastPoint[3],
                          double stepSize,
@@ -439,6 +467,8 @@ protected:
   // Compute streamlines only on surface.
   bool SurfaceStreamlines;
 
+  int EnableSMP;
+
   vtkAbstractInterpolatedVelocityField * InterpolatorPrototype;
 
   vtkCompositeDataSet* InputData;
@@ -446,6 +476,9 @@ protected:
 
   friend class PStreamTracerUtils;
 
+  // Functor integrating ranges of seeds for IntegrateSMP().
+  struct IntegrateSeeds;
+
 private:
   vtkStreamTracer(const vtkStreamTracer&) VTK_DELETE_FUNCTION;
   void operator=(const vtkStreamTracer&) VTK_DELETE_FUNCTION;
@@ -0,0 +1,251 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestGradientFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded vtkGradientFilter produces the same gradients,
+// divergence, vorticity and Q criterion as the serial filter on
+// unstructured grids and polydata.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkCylinderSource.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkGenericCell.h"
+#include "vtkGradientFilter.h"
+#include "vtkImageData.h"
+#include "vtkNew.h"
+#include "vtkPlaneSource.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+// The field, and a linear field whose gradient is the matrix Linear.
+const double Linear[9] = {1.0, 2.0, -1.0, 0.5, -3.0, 2.0, 4.0, 1.0, 0.25};
+
+void Evaluate(const double x[3], double v[3], double l[3])
+{
+  v[0] = sin(2.0 * x[0]) * x[1];
+  v[1] = x[0] * x[2] + x[1] * x[1];
+  v[2] = cos(x[1]) + x[2];
+  for (int i = 0; i < 3; ++i)
+  {
+    l[i] = Linear[3*i] * x[0] + Linear[3*i+1] * x[1] + Linear[3*i+2] * x[2];
+  }
+}
+
+// Add the field at the points, and at the first point of the cells.
+void AddArrays(vtkDataSet *ds)
+{
+  vtkNew<vtkDoubleArray> pointVectors;
+  pointVectors->SetName("Vectors");
+  pointVectors->SetNumberOfComponents(3);
+  vtkNew<vtkDoubleArray> pointLinear;
+  pointLinear->SetName("Linear");
+  pointLinear->SetNumberOfComponents(3);
+  double x[3], v[3], l[3];
+  for (vtkIdType i = 0; i < ds->GetNumberOfPoints(); ++i)
+  {
+    ds->GetPoint(i, x);
+    Evaluate(x, v, l);
+    pointVectors->InsertNextTuple(v);
+    pointLinear->InsertNextTuple(l);
+  }
+  ds->GetPointData()->AddArray(pointVectors.Get());
+  ds->GetPointData()->AddArray(pointLinear.Get());
+
+  vtkNew<vtkDoubleArray> cellVectors;
+  cellVectors->SetName("Vectors");
+  cellVectors->SetNumberOfComponents(3);
+  vtkNew<vtkGenericCell> cell;
+  for (vtkIdType i = 0; i < ds->GetNumberOfCells(); ++i)
+  {
+    ds->GetCell(i, cell.Get());
+    ds->GetPoint(cell->GetPointId(0), x);
+    Evaluate(x, v, l);
+    cellVectors->InsertNextTuple(v);
+  }
+  ds->GetCellData()->AddArray(cellVectors.Get());
+}
+
+// A grid of slightly warped hexahedra.
+vtkSmartPointer<vtkUnstructuredGrid> MakeHexahedra(int n)
+{
+  vtkNew<vtkPoints> points;
+  for (int k = 0; k <= n; ++k)
+  {
+    for (int j = 0; j <= n; ++j)
+    {
+      for (int i = 0; i <= n; ++i)
+      {
+        double x = static_cast<double>(i) / n;
+        double y = static_cast<double>(j) / n;
+        double z = static_cast<double>(k) / n;
+        points->InsertNextPoint(x + 0.02 * sin(3.0 * y), y + 0.1 * z, z);
+      }
+    }
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points.Get());
+  grid->Allocate(n * n * n);
+  int s = n + 1;
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        vtkIdType p = i + s * (j + s * k);
+        vtkIdType hex[8] = {p, p + 1, p + 1 + s, p + s,
+                            p + s * s, p + 1 + s * s, p + 1 + s + s * s,
+                            p + s + s * s};
+        grid->InsertNextCell(VTK_HEXAHEDRON, 8, hex);
+      }
+    }
+  }
+  return grid;
+}
+
+bool CheckGradients(vtkDataSet *input, int mode)
+{
+  vtkNew<vtkGradientFilter> serial;
+  vtkNew<vtkGradientFilter> threaded;
+  vtkGradientFilter *filters[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    filters[j]->SetInputData(input);
+    filters[j]->SetInputScalars(mode == 2 ?
+      vtkDataObject::FIELD_ASSOCIATION_CELLS :
+      vtkDataObject::FIELD_ASSOCIATION_POINTS, "Vectors");
+    filters[j]->SetFasterApproximation(mode == 1);
+    filters[j]->ComputeDivergenceOn();
+    filters[j]->ComputeVorticityOn();
+    filters[j]->ComputeQCriterionOn();
+    filters[j]->SetEnableSMP(j);
+    filters[j]->Update();
+  }
+  if (mode == 2)
+  {
+    return vtkTestDataSetUtilities::SameFieldData(
+      serial->GetOutput()->GetCellData(),
+      threaded->GetOutput()->GetCellData(), 1.0e-6);
+  }
+  return vtkTestDataSetUtilities::SameFieldData(
+    serial->GetOutput()->GetPointData(),
+    threaded->GetOutput()->GetPointData(), 1.0e-6);
+}
+
+// The gradient of the linear field is exact in cells that can represent it.
+bool CheckLinearGradients(vtkDataSet *input)
+{
+  vtkNew<vtkGradientFilter> gradients;
+  gradients->SetInputData(input);
+  gradients->SetInputScalars(vtkDataObject::FIELD_ASSOCIATION_POINTS,
+                             "Linear");
+  gradients->EnableSMPOn();
+  gradients->Update();
+  vtkDataArray *result =
+    gradients->GetOutput()->GetPointData()->GetArray("Gradients");
+  for (vtkIdType t = 0; t < result->GetNumberOfTuples(); ++t)
+  {
+    for (int c = 0; c < 9; ++c)
+    {
+      if (fabs(result->GetComponent(t, c) - Linear[c]) > 1.0e-8)
+      {
+        cerr << "Wrong gradient of a linear field at point " << t << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+}
+
+int TestGradientFilterSMP(int, char *[])
+{
+  // Hexahedra, voxels, tetrahedra, triangles, quads and polygons.
+  vtkSmartPointer<vtkUnstructuredGrid> hexahedra = MakeHexahedra(10);
+  AddArrays(hexahedra);
+
+  vtkNew<vtkImageData> image;
+  image->SetExtent(0, 8, 0, 8, 0, 8);
+  image->SetSpacing(1.0 / 8, 1.0 / 8, 1.0 / 8);
+  vtkNew<vtkAppendFilter> voxels;
+  voxels->SetInputData(image.Get());
+  voxels->Update();
+  vtkUnstructuredGrid *voxelGrid = voxels->GetOutput();
+  AddArrays(voxelGrid);
+
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(hexahedra);
+  tetrahedra->Update();
+  vtkUnstructuredGrid *tets = tetrahedra->GetOutput();
+  tets->GetPointData()->Initialize();
+  tets->GetCellData()->Initialize();
+  AddArrays(tets);
+
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetThetaResolution(30);
+  sphereSource->SetPhiResolution(20);
+  sphereSource->Update();
+  vtkPolyData *sphere = sphereSource->GetOutput();
+  AddArrays(sphere);
+
+  vtkNew<vtkPlaneSource> planeSource;
+  planeSource->SetResolution(12, 9);
+  planeSource->SetOrigin(0.0, 0.0, 0.0);
+  planeSource->SetPoint1(1.0, 0.2, 0.3);
+  planeSource->SetPoint2(-0.1, 1.0, 0.5);
+  planeSource->Update();
+  vtkPolyData *plane = planeSource->GetOutput();
+  AddArrays(plane);
+
+  vtkNew<vtkCylinderSource> cylinderSource;
+  cylinderSource->SetResolution(12);
+  cylinderSource->Update();
+  vtkPolyData *cylinder = cylinderSource->GetOutput();
+  AddArrays(cylinder);
+
+  vtkDataSet *inputs[6] = {
+    hexahedra, voxelGrid, tets, sphere, plane, cylinder};
+  for (int i = 0; i < 6; ++i)
+  {
+    for (int mode = 0; mode < 3; ++mode)
+    {
+      if (!CheckGradients(inputs[i], mode))
+      {
+        cerr << "Threaded gradients differ for input " << i << " and mode "
+             << mode << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  if (!CheckLinearGradients(hexahedra) || !CheckLinearGradients(tets) ||
+      !CheckLinearGradients(voxelGrid))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
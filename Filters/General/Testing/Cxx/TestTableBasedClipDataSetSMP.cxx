@@ -0,0 +1,206 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestTableBasedClipDataSetSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded clipping of vtkTableBasedClipDataSet produces
+// the same output as the serial clipping.
+
+#include "vtkAppendFilter.h"
+#include "vtkCellArray.h"
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkFloatArray.h"
+#include "vtkImageData.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphere.h"
+#include "vtkSphereSource.h"
+#include "vtkStructuredGrid.h"
+#include "vtkTableBasedClipDataSet.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+// Add the scalars to clip to the points of the dataset.
+void AddScalars(vtkDataSet *ds)
+{
+  vtkNew<vtkFloatArray> scalars;
+  scalars->SetName("Scalars");
+  scalars->SetNumberOfTuples(ds->GetNumberOfPoints());
+  double x[3];
+  for (vtkIdType i = 0; i < ds->GetNumberOfPoints(); ++i)
+  {
+    ds->GetPoint(i, x);
+    scalars->SetValue(i, sin(3.0 * x[0]) * cos(2.0 * x[1]) + 0.5 * x[2]);
+  }
+  ds->GetPointData()->SetScalars(scalars.Get());
+}
+
+// Add the cell ids to the cell data of the dataset.
+void AddCellIds(vtkDataSet *ds)
+{
+  vtkNew<vtkIntArray> cellIds;
+  cellIds->SetName("CellIds");
+  cellIds->SetNumberOfTuples(ds->GetNumberOfCells());
+  for (vtkIdType i = 0; i < ds->GetNumberOfCells(); ++i)
+  {
+    cellIds->SetValue(i, i);
+  }
+  ds->GetCellData()->AddArray(cellIds.Get());
+}
+
+// A structured grid with the points of the image, slightly warped.
+vtkSmartPointer<vtkStructuredGrid> MakeStructuredGrid(vtkImageData *image)
+{
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  double x[3];
+  for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+  {
+    image->GetPoint(i, x);
+    points->InsertNextPoint(x[0] + 0.02 * sin(5.0 * x[1]), x[1],
+                            x[2] + 0.01 * x[0]);
+  }
+  vtkSmartPointer<vtkStructuredGrid> grid =
+    vtkSmartPointer<vtkStructuredGrid>::New();
+  grid->SetExtent(image->GetExtent());
+  grid->SetPoints(points.Get());
+  AddScalars(grid);
+  AddCellIds(grid);
+  return grid;
+}
+
+// A sphere with vertices, a polyline and a triangle strip.
+vtkSmartPointer<vtkPolyData> MakePolyData()
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(40);
+  sphere->SetPhiResolution(30);
+  sphere->SetRadius(0.8);
+  sphere->Update();
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->DeepCopy(sphere->GetOutput());
+
+  vtkNew<vtkCellArray> verts;
+  vtkNew<vtkCellArray> lines;
+  vtkNew<vtkCellArray> strips;
+  lines->InsertNextCell(40);
+  strips->InsertNextCell(40);
+  for (vtkIdType i = 0; i < 40; ++i)
+  {
+    vtkIdType id = 7 * i + 3;
+    verts->InsertNextCell(1, &id);
+    lines->InsertCellPoint(i + 2);
+    strips->InsertCellPoint(i % 2 ? i + 42 : i + 2);
+  }
+  polyData->SetVerts(verts.Get());
+  polyData->SetLines(lines.Get());
+  polyData->SetStrips(strips.Get());
+  polyData->GetPointData()->Initialize();
+  polyData->GetCellData()->Initialize();
+  AddScalars(polyData);
+  AddCellIds(polyData);
+  return polyData;
+}
+
+// Clip with the scalars (also generating the clipped output), or with a
+// sphere, serially and in parallel.
+bool CheckClip(vtkDataSet *input, int mode)
+{
+  vtkNew<vtkSphere> sphere;
+  sphere->SetCenter(0.1, 0.2, 0.05);
+  sphere->SetRadius(0.6);
+  vtkNew<vtkTableBasedClipDataSet> serial;
+  vtkNew<vtkTableBasedClipDataSet> threaded;
+  vtkTableBasedClipDataSet *clippers[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    clippers[j]->SetInputData(input);
+    clippers[j]->SetEnableSMP(j);
+    if (mode == 0)
+    {
+      clippers[j]->SetValue(0.2);
+      clippers[j]->InsideOutOn();
+      clippers[j]->GenerateClippedOutputOn();
+    }
+    else
+    {
+      clippers[j]->SetClipFunction(sphere.Get());
+      clippers[j]->GenerateClipScalarsOn();
+    }
+    clippers[j]->Update();
+  }
+  return threaded->GetOutput()->GetNumberOfCells() > 0 &&
+    vtkTestDataSetUtilities::SameDataSets(
+      serial->GetOutput(), threaded->GetOutput(), 1.0e-5) &&
+    (mode != 0 ||
+     vtkTestDataSetUtilities::SameDataSets(
+       serial->GetClippedOutput(), threaded->GetClippedOutput(), 1.0e-5));
+}
+}
+
+int TestTableBasedClipDataSetSMP(int, char *[])
+{
+  vtkNew<vtkImageData> image;
+  image->SetExtent(-12, 12, -12, 12, -12, 12);
+  image->SetSpacing(1.0 / 12, 1.0 / 12, 1.0 / 12);
+  AddScalars(image.Get());
+  AddCellIds(image.Get());
+
+  // A grid of hexahedra, to which a hexagonal prism is added since it is
+  // not handled by the clipping tables, and a grid of tetrahedra.
+  vtkNew<vtkAppendFilter> hexahedra;
+  hexahedra->SetInputData(image.Get());
+  hexahedra->Update();
+  vtkNew<vtkUnstructuredGrid> mixed;
+  mixed->DeepCopy(hexahedra->GetOutput());
+  vtkIdType prism[12] = {0, 1, 2, 27, 52, 51, 625, 626, 627, 652, 677, 676};
+  mixed->InsertNextCell(VTK_HEXAGONAL_PRISM, 12, prism);
+  mixed->GetCellData()->GetArray("CellIds")->InsertNextTuple1(-1);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(image.Get());
+  tetrahedra->Update();
+
+  // Polydata, and 3D and 2D structured grids.
+  vtkSmartPointer<vtkPolyData> polyData = MakePolyData();
+  vtkSmartPointer<vtkStructuredGrid> grid3D = MakeStructuredGrid(image.Get());
+  vtkNew<vtkImageData> slice;
+  slice->SetExtent(-12, 12, -12, 12, 3, 3);
+  slice->SetSpacing(1.0 / 12, 1.0 / 12, 1.0 / 12);
+  vtkSmartPointer<vtkStructuredGrid> grid2D = MakeStructuredGrid(slice.Get());
+
+  vtkDataSet *inputs[5] = {
+    mixed.Get(), tetrahedra->GetOutput(), polyData, grid3D, grid2D};
+  for (int i = 0; i < 5; ++i)
+  {
+    for (int mode = 0; mode < 2; ++mode)
+    {
+      if (!CheckClip(inputs[i], mode))
+      {
+        cerr << "Threaded clipping differs for input " << i << " and mode "
+             << mode << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -23,8 +23,11 @@
 #include "vtkCell.h"
 #include "vtkCellData.h"
 #include "vtkCellDataToPointData.h"
+#include "vtkCellType.h"
 #include "vtkDataArray.h"
 #include "vtkDataSet.h"
+#include "vtkGenericCell.h"
+#include "vtkHexahedron.h"
 #include "vtkIdList.h"
 #include "vtkImageData.h"
 #include "vtkInformation.h"
@@ -34,12 +37,20 @@
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkQuad.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
+#include "vtkStaticCellLinks.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGrid.h"
+#include "vtkTetra.h"
+#include "vtkTriangle.h"
 #include "vtkUnstructuredGrid.h"
 
+#include <algorithm>
 #include <vector>
 
 //-----------------------------------------------------------------------------
@@ -85,7 +96,7 @@ namespace
   void ComputePointGradientsUG(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence);
+    data_type* divergence, bool enableSMP);
 
   int GetCellParametricData(
     vtkIdType pointId, double pointCoord[3], vtkCell *cell, int & subId,
@@ -93,6 +104,19 @@ namespace
 
   template<class data_type>
   void ComputeCellGradientsUG(
+    vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
+    data_type* divergence, bool enableSMP);
+
+  // Threaded versions of the functions above
+  template<class data_type>
+  void ComputePointGradientsUGSMP(
+    vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
+    data_type* divergence);
+
+  template<class data_type>
+  void ComputeCellGradientsUGSMP(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
     data_type* divergence);
@@ -150,6 +174,7 @@ vtkGradientFilter::vtkGradientFilter()
   this->ComputeDivergence = 0;
   this->ComputeVorticity = 0;
   this->ComputeQCriterion = 0;
+  this->EnableSMP = 0;
   this->SetInputScalars(vtkDataObject::FIELD_ASSOCIATION_POINTS_THEN_CELLS,
                         vtkDataSetAttributes::SCALARS);
 }
@@ -181,6 +206,7 @@ void vtkGradientFilter::PrintSelf(ostream &os, vtkIndent indent)
   os << indent << "ComputeDivergence:"  << this->ComputeDivergence << endl;
   os << indent << "ComputeVorticity:" << this->ComputeVorticity << endl;
   os << indent << "ComputeQCriterion:" << this->ComputeQCriterion << endl;
+  os << indent << "EnableSMP:" << this->EnableSMP << endl;
 }
 
 //-----------------------------------------------------------------------------
@@ -412,7 +438,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                            (qCriterion == NULL ? NULL :
                             static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                            (divergence == NULL ? NULL :
-                            static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                            static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                           this->EnableSMP != 0));
       }
       if(gradients)
       {
@@ -480,7 +507,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
             (qCriterion == NULL ? NULL :
              static_cast<VTK_TT *>(cellQCriterion->GetVoidPointer(0))),
             (divergence == NULL ? NULL :
-             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0)))));
+             static_cast<VTK_TT *>(cellDivergence->GetVoidPointer(0))),
+            this->EnableSMP != 0));
       }
 
       // We need to convert cell Array to points Array.
@@ -507,6 +535,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
       vtkNew<vtkCellDataToPointData> cd2pd;
       cd2pd->SetInputData(dummy);
       cd2pd->PassCellDataOff();
+      cd2pd->SetEnableSMP(this->EnableSMP);
       cd2pd->Update();
 
       // Set the gradients array in the output and cleanup.
@@ -543,6 +572,7 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
     vtkNew<vtkCellDataToPointData> cd2pd;
     cd2pd->SetInputData(dummy);
     cd2pd->PassCellDataOff();
+    cd2pd->SetEnableSMP(this->EnableSMP);
     cd2pd->Update();
     vtkDataArray *pointScalars
       = cd2pd->GetOutput()->GetPointData()->GetScalars();
@@ -561,7 +591,8 @@ int vtkGradientFilter::ComputeUnstructuredGridGradient(
                          (qCriterion == NULL ? NULL :
                           static_cast<VTK_TT *>(qCriterion->GetVoidPointer(0))),
                          (divergence == NULL ? NULL :
-                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0)))));
+                          static_cast<VTK_TT *>(divergence->GetVoidPointer(0))),
+                         this->EnableSMP != 0));
     }
 
     if(gradients)
@@ -759,8 +790,16 @@ namespace {
   void ComputePointGradientsUG(
     vtkDataSet *structure, data_type *array, data_type *gradients,
     int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
-    data_type* divergence)
+    data_type* divergence, bool enableSMP)
   {
+    if (enableSMP)
+    {
+      ComputePointGradientsUGSMP(structure, array, gradients,
+                                 numberOfInputComponents, vorticity,
+                                 qCriterion, divergence);
+      return;
+    }
+
     vtkNew<vtkIdList> currentPoint;
     currentPoint->SetNumberOfIds(1);
     vtkNew<vtkIdList> cellsOnPoint;
@@ -885,8 +924,16 @@ namespace {
     void ComputeCellGradientsUG(
       vtkDataSet *structure, data_type *array, data_type *gradients,
       int numberOfInputComponents, data_type* vorticity,
-      data_type* qCriterion, data_type* divergence)
+      data_type* qCriterion, data_type* divergence, bool enableSMP)
   {
+    if (enableSMP)
+    {
+      ComputeCellGradientsUGSMP(structure, array, gradients,
+                                numberOfInputComponents, vorticity,
+                                qCriterion, divergence);
+      return;
+    }
+
     vtkIdType numcells = structure->GetNumberOfCells();
     std::vector<double> values(8);
     std::vector<data_type> cellGradients(3*numberOfInputComponents);
@@ -943,6 +990,499 @@ namespace {
     }
   }
 
+//-----------------------------------------------------------------------------
+  // Number of parametric dimensions of the cells that are differentiated
+  // directly from the derivatives of their shape functions, or 0 for the
+  // cells that are differentiated through a vtkCell.
+  int GetShapeDimension(int cellType, vtkIdType numPts)
+  {
+    switch (cellType)
+    {
+      case VTK_TETRA:
+        return numPts == 4 ? 3 : 0;
+      case VTK_HEXAHEDRON:
+        return numPts == 8 ? 3 : 0;
+      case VTK_TRIANGLE:
+        return numPts == 3 ? 2 : 0;
+      case VTK_QUAD:
+        return numPts == 4 ? 2 : 0;
+      default:
+        return 0;
+    }
+  }
+
+  // Parametric coordinates of the points of a hexahedron. Those of a quad
+  // are the first four.
+  const double HexahedronPCoords[8][3] = {
+    {0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {1.0, 1.0, 0.0}, {0.0, 1.0, 0.0},
+    {0.0, 0.0, 1.0}, {1.0, 0.0, 1.0}, {1.0, 1.0, 1.0}, {0.0, 1.0, 1.0} };
+
+//-----------------------------------------------------------------------------
+  // Computes the derivatives of the field at given points of the cells of a
+  // dataset. Each thread has its own instance.
+  template<class data_type>
+  class CellDerivatives
+  {
+  public:
+    CellDerivatives() : Input(NULL), Array(NULL), NumberOfComponents(0) {}
+
+    void Initialize(vtkDataSet *input, data_type *array,
+                    int numberOfComponents)
+    {
+      this->Input = input;
+      this->Array = array;
+      this->NumberOfComponents = numberOfComponents;
+      this->Cell = vtkSmartPointer<vtkGenericCell>::New();
+      this->PointIds = vtkSmartPointer<vtkIdList>::New();
+      this->Derivative.resize(3*numberOfComponents);
+    }
+
+    // Add the derivatives of the cell at one of its points to g. Returns
+    // false, like GetCellParametricData(), if the cell does not have the
+    // point exactly once.
+    bool AddPointDerivatives(vtkIdType cellId, vtkIdType pointId,
+                             double pointCoord[3], double *g)
+    {
+      int cellType = this->Input->GetCellType(cellId);
+      if (this->IsShapeCell(cellType))
+      {
+        this->Input->GetCellPoints(cellId, this->PointIds);
+        vtkIdType numPts = this->PointIds->GetNumberOfIds();
+        int dim = GetShapeDimension(cellType, numPts);
+        if (dim > 0)
+        {
+          const vtkIdType *ptIds = this->PointIds->GetPointer(0);
+          int index = -1;
+          for (int i = 0; i < numPts; i++)
+          {
+            if (ptIds[i] == pointId)
+            {
+              if (index >= 0)
+              {
+                return false;
+              }
+              index = i;
+            }
+          }
+          if (index < 0)
+          {
+            return false;
+          }
+          // The derivatives of simplices do not depend on the position.
+          double center[3] = {0.25, 0.25, 0.25};
+          const double *pcoords = (cellType == VTK_HEXAHEDRON ||
+                                   cellType == VTK_QUAD) ?
+            HexahedronPCoords[index] : center;
+          this->AddShapeDerivatives(cellType, dim, numPts, pcoords, g);
+          return true;
+        }
+      }
+
+      this->Input->GetCell(cellId, this->Cell);
+      int subId;
+      double parametricCoord[3];
+      if (!GetCellParametricData(pointId, pointCoord, this->Cell, subId,
+                                 parametricCoord))
+      {
+        return false;
+      }
+      this->ComputeCellDerivatives(subId, parametricCoord);
+      for (int i = 0; i < 3*this->NumberOfComponents; i++)
+      {
+        g[i] += this->Derivative[i];
+      }
+      return true;
+    }
+
+    // Set g to the derivatives of the cell at its parametric center.
+    void GetCenterDerivatives(vtkIdType cellId, double *g)
+    {
+      for (int i = 0; i < 3*this->NumberOfComponents; i++)
+      {
+        g[i] = 0.0;
+      }
+      int cellType = this->Input->GetCellType(cellId);
+      if (this->IsShapeCell(cellType))
+      {
+        this->Input->GetCellPoints(cellId, this->PointIds);
+        vtkIdType numPts = this->PointIds->GetNumberOfIds();
+        int dim = GetShapeDimension(cellType, numPts);
+        if (dim > 0)
+        {
+          double pcoords[3] = {0.5, 0.5, 0.5};
+          if (cellType == VTK_TETRA)
+          {
+            pcoords[0] = pcoords[1] = pcoords[2] = 0.25;
+          }
+          else if (cellType == VTK_TRIANGLE)
+          {
+            pcoords[0] = pcoords[1] = 1.0 / 3.0;
+            pcoords[2] = 0.0;
+          }
+          else if (cellType == VTK_QUAD)
+          {
+            pcoords[2] = 0.0;
+          }
+          this->AddShapeDerivatives(cellType, dim, numPts, pcoords, g);
+          return;
+        }
+      }
+
+      this->Input->GetCell(cellId, this->Cell);
+      double cellCenter[3];
+      int subId = this->Cell->GetParametricCenter(cellCenter);
+      this->ComputeCellDerivatives(subId, cellCenter);
+      for (int i = 0; i < 3*this->NumberOfComponents; i++)
+      {
+        g[i] = this->Derivative[i];
+      }
+    }
+
+  private:
+    bool IsShapeCell(int cellType)
+    {
+      return cellType == VTK_TETRA || cellType == VTK_HEXAHEDRON ||
+        cellType == VTK_TRIANGLE || cellType == VTK_QUAD;
+    }
+
+    // Add the derivatives of a tetrahedron, hexahedron, triangle or quad
+    // whose points are in PointIds. They are the derivatives of the shape
+    // functions with respect to x, y and z, computed from the inverse of the
+    // Jacobian (or its pseudo inverse for 2D cells), applied to the values.
+    // Degenerate cells have null derivatives.
+    void AddShapeDerivatives(int cellType, int dim, vtkIdType numPts,
+                             const double pcoords[3], double *g)
+    {
+      double p[3] = {pcoords[0], pcoords[1], pcoords[2]};
+      double shapeDerivs[24];
+      switch (cellType)
+      {
+        case VTK_TETRA:
+          vtkTetra::InterpolationDerivs(p, shapeDerivs);
+          break;
+        case VTK_HEXAHEDRON:
+          vtkHexahedron::InterpolationDerivs(p, shapeDerivs);
+          break;
+        case VTK_TRIANGLE:
+          vtkTriangle::InterpolationDerivs(p, shapeDerivs);
+          break;
+        default:
+          vtkQuad::InterpolationDerivs(p, shapeDerivs);
+          break;
+      }
+
+      const vtkIdType *ptIds = this->PointIds->GetPointer(0);
+      double jacobian[3][3] = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0},
+                               {0.0, 0.0, 0.0}};
+      double x[3];
+      for (vtkIdType i = 0; i < numPts; i++)
+      {
+        this->Input->GetPoint(ptIds[i], x);
+        for (int r = 0; r < dim; r++)
+        {
+          for (int j = 0; j < 3; j++)
+          {
+            jacobian[r][j] += shapeDerivs[r*numPts+i] * x[j];
+          }
+        }
+      }
+
+      // inverse[j][r] is the derivative of the r-th parametric coordinate
+      // with respect to the j-th coordinate.
+      double inverse[3][3];
+      if (dim == 3)
+      {
+        if (vtkMath::Determinant3x3(jacobian) == 0.0)
+        {
+          return;
+        }
+        vtkMath::Invert3x3(jacobian, inverse);
+      }
+      else
+      {
+        double a = vtkMath::Dot(jacobian[0], jacobian[0]);
+        double b = vtkMath::Dot(jacobian[0], jacobian[1]);
+        double c = vtkMath::Dot(jacobian[1], jacobian[1]);
+        double det = a*c - b*b;
+        if (det == 0.0)
+        {
+          return;
+        }
+        for (int j = 0; j < 3; j++)
+        {
+          inverse[j][0] = (c*jacobian[0][j] - b*jacobian[1][j]) / det;
+          inverse[j][1] = (a*jacobian[1][j] - b*jacobian[0][j]) / det;
+          inverse[j][2] = 0.0;
+        }
+      }
+
+      int numComp = this->NumberOfComponents;
+      for (int k = 0; k < numComp; k++)
+      {
+        double sum[3] = {0.0, 0.0, 0.0};
+        for (vtkIdType i = 0; i < numPts; i++)
+        {
+          double value = static_cast<double>(this->Array[ptIds[i]*numComp+k]);
+          for (int r = 0; r < dim; r++)
+          {
+            sum[r] += shapeDerivs[r*numPts+i] * value;
+          }
+        }
+        for (int j = 0; j < 3; j++)
+        {
+          g[3*k+j] += sum[0]*inverse[j][0] + sum[1]*inverse[j][1] +
+            sum[2]*inverse[j][2];
+        }
+      }
+    }
+
+    // Derivatives of the generic cell, one component at a time like the
+    // serial functions.
+    void ComputeCellDerivatives(int subId, double pcoords[3])
+    {
+      int numPts = this->Cell->GetNumberOfPoints();
+      if (static_cast<size_t>(numPts) > this->Values.size())
+      {
+        this->Values.resize(numPts);
+      }
+      int numComp = this->NumberOfComponents;
+      for (int k = 0; k < numComp; k++)
+      {
+        for (int i = 0; i < numPts; i++)
+        {
+          this->Values[i] = static_cast<double>(
+            this->Array[this->Cell->GetPointId(i)*numComp+k]);
+        }
+        this->Cell->Derivatives(subId, pcoords, &this->Values[0], 1,
+                                &this->Derivative[3*k]);
+      }
+    }
+
+    vtkDataSet *Input;
+    data_type *Array;
+    int NumberOfComponents;
+    vtkSmartPointer<vtkGenericCell> Cell;
+    vtkSmartPointer<vtkIdList> PointIds;
+    std::vector<double> Values;
+    std::vector<double> Derivative;
+  };
+
+//-----------------------------------------------------------------------------
+  // Store the gradient of an entity and the quantities derived from it.
+  template<class data_type>
+  struct GradientOutputs
+  {
+    int NumberOfComponents;
+    data_type *Gradients;
+    data_type *Vorticity;
+    data_type *QCriterion;
+    data_type *Divergence;
+
+    void Store(vtkIdType id, data_type *g)
+    {
+      if (this->Vorticity)
+      {
+        ComputeVorticityFromGradient(g, this->Vorticity+3*id);
+      }
+      if (this->QCriterion)
+      {
+        ComputeQCriterionFromGradient(g, this->QCriterion+id);
+      }
+      if (this->Divergence)
+      {
+        ComputeDivergenceFromGradient(g, this->Divergence+id);
+      }
+      if (this->Gradients)
+      {
+        int numberOfOutputComponents = 3*this->NumberOfComponents;
+        for (int i = 0; i < numberOfOutputComponents; i++)
+        {
+          this->Gradients[id*numberOfOutputComponents+i] = g[i];
+        }
+      }
+    }
+  };
+
+  // Average the derivatives of the cells using each point, in a single pass
+  // over the points. The cells come from the static links when available.
+  template<class data_type>
+  struct PointGradientsOp
+  {
+    vtkDataSet *Input;
+    vtkStaticCellLinks *Links;
+    data_type *Array;
+    GradientOutputs<data_type> Outputs;
+    vtkSMPThreadLocal<CellDerivatives<data_type> > Derivatives;
+    vtkSMPThreadLocalObject<vtkIdList> PointCells;
+
+    void Initialize()
+    {
+      this->Derivatives.Local().Initialize(
+        this->Input, this->Array, this->Outputs.NumberOfComponents);
+    }
+
+    void operator()(vtkIdType point, vtkIdType endPoint)
+    {
+      CellDerivatives<data_type> &derivatives = this->Derivatives.Local();
+      vtkIdList *pointCells = this->PointCells.Local();
+      int numberOfOutputComponents = 3*this->Outputs.NumberOfComponents;
+      std::vector<double> sum(numberOfOutputComponents);
+      std::vector<data_type> g(numberOfOutputComponents);
+
+      for (; point < endPoint; point++)
+      {
+        double pointcoords[3];
+        this->Input->GetPoint(point, pointcoords);
+        std::fill(sum.begin(), sum.end(), 0.0);
+
+        // The links list the cells in decreasing order.
+        vtkIdType numCellNeighbors;
+        if (this->Links)
+        {
+          numCellNeighbors = this->Links->GetNumberOfCells(point);
+          const vtkIdType *cells = this->Links->GetCells(point);
+          for (vtkIdType i = numCellNeighbors; i-- > 0;)
+          {
+            derivatives.AddPointDerivatives(cells[i], point, pointcoords,
+                                            &sum[0]);
+          }
+        }
+        else
+        {
+          this->Input->GetPointCells(point, pointCells);
+          numCellNeighbors = pointCells->GetNumberOfIds();
+          for (vtkIdType i = 0; i < numCellNeighbors; i++)
+          {
+            derivatives.AddPointDerivatives(pointCells->GetId(i), point,
+                                            pointcoords, &sum[0]);
+          }
+        }
+
+        for (int i = 0; i < numberOfOutputComponents; i++)
+        {
+          g[i] = static_cast<data_type>(
+            numCellNeighbors > 0 ? sum[i] / numCellNeighbors : sum[i]);
+        }
+        this->Outputs.Store(point, &g[0]);
+      }
+    }
+
+    void Reduce()
+    {
+    }
+  };
+
+  // Differentiate each cell at its parametric center.
+  template<class data_type>
+  struct CellGradientsOp
+  {
+    vtkDataSet *Input;
+    data_type *Array;
+    GradientOutputs<data_type> Outputs;
+    vtkSMPThreadLocal<CellDerivatives<data_type> > Derivatives;
+
+    void Initialize()
+    {
+      this->Derivatives.Local().Initialize(
+        this->Input, this->Array, this->Outputs.NumberOfComponents);
+    }
+
+    void operator()(vtkIdType cellid, vtkIdType endCellId)
+    {
+      CellDerivatives<data_type> &derivatives = this->Derivatives.Local();
+      int numberOfOutputComponents = 3*this->Outputs.NumberOfComponents;
+      std::vector<double> derivative(numberOfOutputComponents);
+      std::vector<data_type> g(numberOfOutputComponents);
+
+      for (; cellid < endCellId; cellid++)
+      {
+        derivatives.GetCenterDerivatives(cellid, &derivative[0]);
+        for (int i = 0; i < numberOfOutputComponents; i++)
+        {
+          g[i] = static_cast<data_type>(derivative[i]);
+        }
+        this->Outputs.Store(cellid, &g[0]);
+      }
+    }
+
+    void Reduce()
+    {
+    }
+  };
+
+//-----------------------------------------------------------------------------
+  template<class data_type>
+  void ComputePointGradientsUGSMP(
+    vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
+    data_type* divergence)
+  {
+    vtkIdType numpts = structure->GetNumberOfPoints();
+    if (numpts == 0)
+    {
+      return;
+    }
+
+    // The links of polydata and unstructured grids are built once, in
+    // parallel. The first serial requests build any lazily constructed
+    // structure that the other datasets need to be queried from threads.
+    vtkNew<vtkStaticCellLinks> links;
+    vtkStaticCellLinks *pointLinks = NULL;
+    int dataType = structure->GetDataObjectType();
+    if (dataType == VTK_POLY_DATA || dataType == VTK_UNSTRUCTURED_GRID)
+    {
+      links->BuildLinks(structure);
+      pointLinks = links.Get();
+    }
+    else
+    {
+      vtkNew<vtkIdList> cellIds;
+      structure->GetPointCells(0, cellIds.Get());
+    }
+    if (structure->GetNumberOfCells() > 0)
+    {
+      vtkNew<vtkGenericCell> cell;
+      structure->GetCell(0, cell.Get());
+    }
+
+    PointGradientsOp<data_type> op;
+    op.Input = structure;
+    op.Links = pointLinks;
+    op.Array = array;
+    op.Outputs.NumberOfComponents = numberOfInputComponents;
+    op.Outputs.Gradients = gradients;
+    op.Outputs.Vorticity = vorticity;
+    op.Outputs.QCriterion = qCriterion;
+    op.Outputs.Divergence = divergence;
+    vtkSMPTools::For(0, numpts, op);
+  }
+
+//-----------------------------------------------------------------------------
+  template<class data_type>
+  void ComputeCellGradientsUGSMP(
+    vtkDataSet *structure, data_type *array, data_type *gradients,
+    int numberOfInputComponents, data_type* vorticity, data_type* qCriterion,
+    data_type* divergence)
+  {
+    vtkIdType numcells = structure->GetNumberOfCells();
+    if (numcells == 0)
+    {
+      return;
+    }
+    vtkNew<vtkGenericCell> cell;
+    structure->GetCell(0, cell.Get());
+
+    CellGradientsOp<data_type> op;
+    op.Input = structure;
+    op.Array = array;
+    op.Outputs.NumberOfComponents = numberOfInputComponents;
+    op.Outputs.Gradients = gradients;
+    op.Outputs.Vorticity = vorticity;
+    op.Outputs.QCriterion = qCriterion;
+    op.Outputs.Divergence = divergence;
+    vtkSMPTools::For(0, numcells, op);
+  }
+
 //-----------------------------------------------------------------------------
   template<class Grid, class data_type>
   void ComputeGradientsSG(Grid output, data_type* array, data_type* gradients,
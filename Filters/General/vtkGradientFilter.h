@@ -31,6 +31,15 @@
  * output tuple will be {du/dx, du/dy, du/dz, dv/dx, dv/dy, dv/dz, dw/dx,
  * dw/dy, dw/dz} for an input array {u, v, w}. There are also the options
  * to additionally compute the vorticity and Q criterion of a vector field.
+ *
+ * When EnableSMP is on, the gradients of datasets other than images,
+ * rectilinear and structured grids are computed in parallel (via
+ * vtkSMPTools). The cells using each point of polydata and unstructured
+ * grids come from static cell links, and tetrahedra, hexahedra, triangles
+ * and quadrilaterals are differentiated directly from the derivatives of
+ * their shape functions. The gradient, divergence, vorticity and Q criterion
+ * are then produced in a single pass. The results match the serial ones up
+ * to round-off.
 */
 
 #ifndef vtkGradientFilter_h
@@ -161,6 +170,16 @@ public:
   vtkBooleanMacro(ComputeQCriterion, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded computation of the gradients of unstructured
+   * data (see the class documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
 protected:
   vtkGradientFilter();
   ~vtkGradientFilter() VTK_OVERRIDE;
@@ -252,6 +271,12 @@ protected:
    */
   int ComputeVorticity;
 
+  /**
+   * Flag to indicate that the gradients of unstructured data are computed
+   * in parallel.  By default EnableSMP is off.
+   */
+  int EnableSMP;
+
 private:
   vtkGradientFilter(const vtkGradientFilter &) VTK_DELETE_FUNCTION;
   void operator=(const vtkGradientFilter &) VTK_DELETE_FUNCTION;
@@ -57,6 +57,17 @@
 #include "vtkRectilinearGrid.h"
 #include "vtkUnstructuredGrid.h"
 #include "vtkGenericCell.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkUnsignedCharArray.h"
+
+#include "vtkArrayListTemplate.h" // For processing attribute data
+#include "vtkSMPThreadLocalObject.h"
+#include "vtkSMPTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
 
 #include "vtkTableBasedClipCases.h"
 
@@ -1597,6 +1608,813 @@ inline void GetPoint( double * pt, const double * X, const double * Y,
 // ============================================================================
 
 
+// ============================================================================
+// ================= threaded clipping of point sets (begin) ==================
+// ============================================================================
+
+namespace
+{
+// The cells are processed in chunks of fixed size, so that the order in
+// which the output cells and points are generated does not depend on the
+// number of threads.
+const vtkIdType CLIP_CHUNK_SIZE = 4096;
+
+// The output shapes, in the order in which vtkTableBasedClipperVolumeFromVolume
+// generates them.
+const int CLIP_NUM_SHAPE_TYPES = 8;
+const int CLIP_SHAPE_SIZES[CLIP_NUM_SHAPE_TYPES] = { 4, 5, 6, 8, 4, 3, 2, 1 };
+const unsigned char CLIP_SHAPE_VTK_TYPES[CLIP_NUM_SHAPE_TYPES] =
+  { VTK_TETRA, VTK_PYRAMID, VTK_WEDGE, VTK_HEXAHEDRON,
+    VTK_QUAD, VTK_TRIANGLE, VTK_LINE, VTK_VERTEX };
+
+typedef const int TableBasedClipperEdgeIds[2];
+
+// A point generated on the edge (Pt1,Pt2) of an input cell, Pt1 < Pt2. The
+// point is located at Percent * Pt1 + ( 1 - Percent ) * Pt2.
+struct TableBasedClipperEdge
+{
+  vtkIdType Pt1;
+  vtkIdType Pt2;
+  double    Percent;
+};
+
+// A point generated at the centroid of other points.
+struct TableBasedClipperCentroid
+{
+  int       NumPts;
+  vtkIdType PtIds[8];
+};
+
+// Sort key of the edge points, used to merge the points generated on the
+// same edge by different cells.
+struct TableBasedClipperEdgeKey
+{
+  vtkIdType Pt1;
+  vtkIdType Pt2;
+  vtkIdType EdgeId; // in order of generation
+
+  bool operator<( const TableBasedClipperEdgeKey & other ) const
+  {
+    if ( this->Pt1 != other.Pt1 )
+    {
+      return this->Pt1 < other.Pt1;
+    }
+    if ( this->Pt2 != other.Pt2 )
+    {
+      return this->Pt2 < other.Pt2;
+    }
+    return this->EdgeId < other.EdgeId;
+  }
+};
+
+// The output of a chunk of cells. The shapes are stored as the cell id
+// followed by the point references. A point reference is either an input
+// point id, an edge point (numPts + index of the edge in the chunk), or a
+// centroid (-1 - index of the centroid in the chunk), as with
+// vtkTableBasedClipperVolumeFromVolume.
+struct TableBasedClipperChunk
+{
+  std::vector< vtkIdType > Shapes[ CLIP_NUM_SHAPE_TYPES ];
+  std::vector< TableBasedClipperEdge > Edges;
+  std::vector< TableBasedClipperCentroid > Centroids;
+  std::vector< vtkIdType > SpecialCells; // cells that can not be clipped
+  vtkIdType EdgeOffset;
+  vtkIdType CentroidOffset;
+  vtkIdType CellOffsets[ CLIP_NUM_SHAPE_TYPES ];
+};
+
+//-----------------------------------------------------------------------------
+// Look up the clip case of a cell. Returns false if the cell type is not
+// supported by the tables.
+bool GetClipCase( int cellType, int caseIndx, const unsigned char *& thisCase,
+                  int & nOutputs, TableBasedClipperEdgeIds *& edgeVtxs )
+{
+  int startIdx = 0;
+  switch ( cellType )
+  {
+    case VTK_TETRA:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesTet[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesTet[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesTet[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::TetVerticesFromEdges;
+      return true;
+
+    case VTK_PYRAMID:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesPyr[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesPyr[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesPyr[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::PyramidVerticesFromEdges;
+      return true;
+
+    case VTK_WEDGE:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesWdg[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesWdg[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesWdg[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::WedgeVerticesFromEdges;
+      return true;
+
+    case VTK_HEXAHEDRON:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesHex[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesHex[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesHex[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::HexVerticesFromEdges;
+      return true;
+
+    case VTK_VOXEL:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesVox[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesVox[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesVox[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::VoxVerticesFromEdges;
+      return true;
+
+    case VTK_TRIANGLE:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesTri[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesTri[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesTri[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::TriVerticesFromEdges;
+      return true;
+
+    case VTK_QUAD:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesQua[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesQua[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesQua[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::QuadVerticesFromEdges;
+      return true;
+
+    case VTK_PIXEL:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesPix[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesPix[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesPix[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::PixelVerticesFromEdges;
+      return true;
+
+    case VTK_LINE:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesLin[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesLin[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesLin[ caseIndx ];
+      edgeVtxs = ( TableBasedClipperEdgeIds * )
+                 vtkTableBasedClipperTriangulationTables::LineVerticesFromEdges;
+      return true;
+
+    case VTK_VERTEX:
+      startIdx = vtkTableBasedClipperClipTables::StartClipShapesVtx[ caseIndx ];
+      thisCase =&vtkTableBasedClipperClipTables::ClipShapesVtx[ startIdx ];
+      nOutputs = vtkTableBasedClipperClipTables::NumClipShapesVtx[ caseIndx ];
+      edgeVtxs = NULL;
+      return true;
+  }
+
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+// Evaluate the implicit function at the points.
+struct TableBasedClipperFunctionOp
+{
+  vtkDataSet          * Input;
+  vtkImplicitFunction * Function;
+  double              * Scalars;
+
+  void operator()( vtkIdType ptId, vtkIdType endPtId ) const
+  {
+    double x[3];
+    for ( ; ptId < endPtId; ptId ++ )
+    {
+      this->Input->GetPoint( ptId, x );
+      this->Scalars[ ptId ] = this->Function->FunctionValue( x );
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Clip the cells of each chunk with the case tables. This is the loop of
+// vtkTableBasedClipDataSet::ClipUnstructuredGridData(), writing the output
+// of each chunk into its own buffers.
+struct TableBasedClipperCellsOp
+{
+  vtkDataSet   * Input;
+  vtkDataArray * ClipArray;
+  double         IsoValue;
+  int            InsideOut;
+  vtkIdType      NumberOfCells;
+  TableBasedClipperChunk * Chunks;
+  vtkSMPThreadLocalObject< vtkIdList > CellPts;
+
+  void operator()( vtkIdType chunkId, vtkIdType endChunkId )
+  {
+    vtkIdList * cellPts = this->CellPts.Local();
+    vtkIdType numPts = this->Input->GetNumberOfPoints();
+    for ( ; chunkId < endChunkId; chunkId ++ )
+    {
+      TableBasedClipperChunk & chunk = this->Chunks[ chunkId ];
+      vtkIdType cellId = chunkId * CLIP_CHUNK_SIZE;
+      vtkIdType endCellId =
+        std::min( cellId + CLIP_CHUNK_SIZE, this->NumberOfCells );
+      for ( ; cellId < endCellId; cellId ++ )
+      {
+        int cellType = this->Input->GetCellType( cellId );
+        if ( cellType == VTK_EMPTY_CELL )
+        {
+          continue;
+        }
+        this->Input->GetCellPoints( cellId, cellPts );
+        vtkIdType numbPnts = cellPts->GetNumberOfIds();
+        const vtkIdType * pntIndxs = cellPts->GetPointer( 0 );
+
+        int caseIndx = 0;
+        double grdDiffs[8];
+        const unsigned char * thisCase = NULL;
+        int nOutputs = 0;
+        TableBasedClipperEdgeIds * edgeVtxs = NULL;
+        if ( numbPnts <= 8 )
+        {
+          for ( vtkIdType j = numbPnts-1; j >= 0; j -- )
+          {
+            grdDiffs[j] = this->ClipArray->GetComponent( pntIndxs[j], 0 )
+                          - this->IsoValue;
+            caseIndx   += (  ( grdDiffs[j] >= 0.0 ) ? 1 : 0  );
+            caseIndx  <<= (  1 - ( !j )  );
+          }
+        }
+        if ( numbPnts > 8 ||
+             !GetClipCase( cellType, caseIndx, thisCase, nOutputs, edgeVtxs ) )
+        {
+          chunk.SpecialCells.push_back( cellId );
+          continue;
+        }
+
+        vtkIdType intrpIds[4];
+        for ( int j = 0; j < nOutputs; j ++ )
+        {
+          int nCellPts = 0;
+          int theColor = -1;
+          int intrpIdx = -1;
+          int shapeType = -1;
+          unsigned char theShape = *thisCase ++;
+
+          // number of points and color
+          switch ( theShape )
+          {
+            case ST_HEX:
+              shapeType = 3;
+              nCellPts = 8;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_WDG:
+              shapeType = 2;
+              nCellPts = 6;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_PYR:
+              shapeType = 1;
+              nCellPts = 5;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_TET:
+              shapeType = 0;
+              nCellPts = 4;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_QUA:
+              shapeType = 4;
+              nCellPts = 4;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_TRI:
+              shapeType = 5;
+              nCellPts = 3;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_LIN:
+              shapeType = 6;
+              nCellPts = 2;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_VTX:
+              shapeType = 7;
+              nCellPts = 1;
+              theColor = *thisCase ++;
+              break;
+
+            case ST_PNT:
+              intrpIdx = *thisCase ++;
+              theColor = *thisCase ++;
+              nCellPts = *thisCase ++;
+              break;
+          }
+
+          if ( (!this->InsideOut && theColor == COLOR0 ) ||
+               ( this->InsideOut && theColor == COLOR1 )
+             )
+          {
+            // We don't want this one; it's the wrong side.
+            thisCase += nCellPts;
+            continue;
+          }
+
+          vtkIdType shapeIds[8];
+          for ( int p = 0; p < nCellPts; p ++ )
+          {
+            unsigned char pntIndex = *thisCase ++;
+
+            if ( pntIndex <= P7 )
+            {
+              shapeIds[p] = pntIndxs[ pntIndex ];
+            }
+            else
+            if ( pntIndex >= EA && pntIndex <= EL )
+            {
+              int  pt1Index = edgeVtxs[ pntIndex-EA ][0];
+              int  pt2Index = edgeVtxs[ pntIndex-EA ][1];
+              if ( pt2Index < pt1Index )
+              {
+                std::swap( pt1Index, pt2Index );
+              }
+              double pt1ToPt2 = grdDiffs[ pt2Index ] - grdDiffs[ pt1Index ];
+              double pt1ToIso = 0.0 - grdDiffs[ pt1Index ];
+              double p1Weight = 1.0 - pt1ToIso / pt1ToPt2;
+
+              // the edges are keyed with increasing point ids
+              TableBasedClipperEdge edge;
+              edge.Pt1 = pntIndxs[ pt1Index ];
+              edge.Pt2 = pntIndxs[ pt2Index ];
+              edge.Percent = p1Weight;
+              if ( edge.Pt2 < edge.Pt1 )
+              {
+                std::swap( edge.Pt1, edge.Pt2 );
+                edge.Percent = 1.0 - p1Weight;
+              }
+              shapeIds[p] = numPts +
+                            static_cast< vtkIdType >( chunk.Edges.size() );
+              chunk.Edges.push_back( edge );
+            }
+            else
+            if ( pntIndex >= N0 && pntIndex <= N3 )
+            {
+              shapeIds[p] = intrpIds[ pntIndex - N0 ];
+            }
+          }
+
+          if ( theShape == ST_PNT )
+          {
+            TableBasedClipperCentroid centroid;
+            centroid.NumPts = nCellPts;
+            std::copy( shapeIds, shapeIds + nCellPts, centroid.PtIds );
+            intrpIds[ intrpIdx ] =
+              -1 - static_cast< vtkIdType >( chunk.Centroids.size() );
+            chunk.Centroids.push_back( centroid );
+          }
+          else if ( shapeType >= 0 )
+          {
+            std::vector< vtkIdType > & shapes = chunk.Shapes[ shapeType ];
+            shapes.push_back( cellId );
+            shapes.insert( shapes.end(), shapeIds, shapeIds + nCellPts );
+          }
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Gather the sort keys of the edge points.
+struct TableBasedClipperEdgeKeysOp
+{
+  TableBasedClipperChunk   * Chunks;
+  TableBasedClipperEdgeKey * Keys;
+
+  void operator()( vtkIdType chunkId, vtkIdType endChunkId ) const
+  {
+    for ( ; chunkId < endChunkId; chunkId ++ )
+    {
+      const TableBasedClipperChunk & chunk = this->Chunks[ chunkId ];
+      TableBasedClipperEdgeKey * key = this->Keys + chunk.EdgeOffset;
+      for ( size_t i = 0; i < chunk.Edges.size(); i ++, key ++ )
+      {
+        key->Pt1 = chunk.Edges[i].Pt1;
+        key->Pt2 = chunk.Edges[i].Pt2;
+        key->EdgeId = chunk.EdgeOffset + static_cast< vtkIdType >( i );
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Map each generated edge point to the first point generated on the same
+// edge. The sorted keys of an edge are contiguous, the first one having the
+// smallest id.
+struct TableBasedClipperMergeEdgesOp
+{
+  const TableBasedClipperEdgeKey * Keys;
+  vtkIdType                        NumberOfKeys;
+  vtkIdType                      * FirstEdge;
+  vtkIdType                      * IsFirst;
+
+  void operator()( vtkIdType i, vtkIdType end ) const
+  {
+    for ( ; i < end; i ++ )
+    {
+      if ( i > 0 && this->Keys[i].Pt1 == this->Keys[i-1].Pt1 &&
+           this->Keys[i].Pt2 == this->Keys[i-1].Pt2 )
+      {
+        continue; // not the first key of its edge
+      }
+      vtkIdType first = this->Keys[i].EdgeId;
+      this->IsFirst[ first ] = 1;
+      for ( vtkIdType j = i; j < this->NumberOfKeys &&
+            this->Keys[j].Pt1 == this->Keys[i].Pt1 &&
+            this->Keys[j].Pt2 == this->Keys[i].Pt2; j ++ )
+      {
+        this->FirstEdge[ this->Keys[j].EdgeId ] = first;
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Number the merged edge points in order of generation, and record the
+// edges of the output points.
+struct TableBasedClipperNumberEdgesOp
+{
+  TableBasedClipperChunk * Chunks;
+  const vtkIdType        * IsFirst; // exclusive scan of the first edges
+  vtkIdType              * EdgeMap; // first edges on input, point ids on output
+  TableBasedClipperEdge  * Edges;
+
+  void operator()( vtkIdType chunkId, vtkIdType endChunkId ) const
+  {
+    for ( ; chunkId < endChunkId; chunkId ++ )
+    {
+      TableBasedClipperChunk & chunk = this->Chunks[ chunkId ];
+      for ( size_t i = 0; i < chunk.Edges.size(); i ++ )
+      {
+        vtkIdType edgeId = chunk.EdgeOffset + static_cast< vtkIdType >( i );
+        vtkIdType newId = this->IsFirst[ this->EdgeMap[ edgeId ] ];
+        if ( this->EdgeMap[ edgeId ] == edgeId )
+        {
+          this->Edges[ newId ] = chunk.Edges[i];
+        }
+        this->EdgeMap[ edgeId ] = newId;
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Map a point reference of a chunk to its global reference: input point ids
+// are kept, edge points are offset by numPts by their merged id, and
+// centroids are offset by -1 by their global id.
+inline vtkIdType GetGlobalPointReference( vtkIdType ref, vtkIdType numPts,
+                                          const TableBasedClipperChunk & chunk,
+                                          const vtkIdType * edgeMap )
+{
+  if ( ref < 0 )
+  {
+    return ref - chunk.CentroidOffset;
+  }
+  else if ( ref >= numPts )
+  {
+    return numPts + edgeMap[ chunk.EdgeOffset + ref - numPts ];
+  }
+  return ref;
+}
+
+// Atomic minimum, used to find the first use of each input point.
+inline void TableBasedClipperAtomicMin( std::atomic< vtkIdType > & value,
+                                        vtkIdType candidate )
+{
+  vtkIdType current = value.load( std::memory_order_relaxed );
+  while ( candidate < current &&
+          !value.compare_exchange_weak( current, candidate,
+                                        std::memory_order_relaxed ) )
+  {
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Write the output cells, grouped by shape type, with global point
+// references, and record the first use of the input points.
+struct TableBasedClipperWriteCellsOp
+{
+  TableBasedClipperChunk   * Chunks;
+  vtkIdType                  NumberOfPoints;
+  const vtkIdType          * EdgeMap;
+  const vtkIdType          * TypeCellStart;
+  const vtkIdType          * TypeConnStart;
+  vtkIdType                * Conn;
+  vtkIdType                * Locations;
+  unsigned char            * Types;
+  vtkIdType                * SrcCellIds;
+  std::atomic< vtkIdType > * FirstUse;
+
+  void operator()( vtkIdType chunkId, vtkIdType endChunkId ) const
+  {
+    for ( ; chunkId < endChunkId; chunkId ++ )
+    {
+      TableBasedClipperChunk & chunk = this->Chunks[ chunkId ];
+      for ( int t = 0; t < CLIP_NUM_SHAPE_TYPES; t ++ )
+      {
+        const std::vector< vtkIdType > & shapes = chunk.Shapes[t];
+        int size = CLIP_SHAPE_SIZES[t];
+        vtkIdType cellId = chunk.CellOffsets[t];
+        vtkIdType loc = this->TypeConnStart[t] +
+                        ( cellId - this->TypeCellStart[t] ) * ( size + 1 );
+        for ( size_t i = 0; i < shapes.size(); i += size + 1, cellId ++ )
+        {
+          this->Types[ cellId ] = CLIP_SHAPE_VTK_TYPES[t];
+          this->Locations[ cellId ] = loc;
+          this->SrcCellIds[ cellId ] = shapes[i];
+          this->Conn[ loc ++ ] = size;
+          for ( int p = 1; p <= size; p ++, loc ++ )
+          {
+            vtkIdType ref = GetGlobalPointReference
+              ( shapes[ i + p ], this->NumberOfPoints, chunk, this->EdgeMap );
+            this->Conn[ loc ] = ref;
+            if ( ref >= 0 && ref < this->NumberOfPoints )
+            {
+              TableBasedClipperAtomicMin( this->FirstUse[ ref ], loc );
+            }
+          }
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Count the input points first used by each output cell.
+struct TableBasedClipperCountPointsOp
+{
+  vtkIdType                        NumberOfPoints;
+  const vtkIdType                * Conn;
+  const vtkIdType                * Locations;
+  const std::atomic< vtkIdType > * FirstUse;
+  vtkIdType                      * Counts;
+
+  void operator()( vtkIdType cellId, vtkIdType endCellId ) const
+  {
+    for ( ; cellId < endCellId; cellId ++ )
+    {
+      vtkIdType loc = this->Locations[ cellId ];
+      vtkIdType end = loc + 1 + this->Conn[ loc ];
+      vtkIdType count = 0;
+      for ( loc ++; loc < end; loc ++ )
+      {
+        vtkIdType ref = this->Conn[ loc ];
+        if ( ref >= 0 && ref < this->NumberOfPoints &&
+             this->FirstUse[ ref ].load( std::memory_order_relaxed ) == loc )
+        {
+          count ++;
+        }
+      }
+      this->Counts[ cellId ] = count;
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Number the input points in order of first use by the output cells.
+struct TableBasedClipperNumberPointsOp
+{
+  vtkIdType                        NumberOfPoints;
+  const vtkIdType                * Conn;
+  const vtkIdType                * Locations;
+  const std::atomic< vtkIdType > * FirstUse;
+  const vtkIdType                * Counts; // exclusive scan of the counts
+  vtkIdType                      * PointMap;
+  vtkIdType                      * SrcPtIds;
+
+  void operator()( vtkIdType cellId, vtkIdType endCellId ) const
+  {
+    for ( ; cellId < endCellId; cellId ++ )
+    {
+      vtkIdType loc = this->Locations[ cellId ];
+      vtkIdType end = loc + 1 + this->Conn[ loc ];
+      vtkIdType newId = this->Counts[ cellId ];
+      for ( loc ++; loc < end; loc ++ )
+      {
+        vtkIdType ref = this->Conn[ loc ];
+        if ( ref >= 0 && ref < this->NumberOfPoints &&
+             this->FirstUse[ ref ].load( std::memory_order_relaxed ) == loc )
+        {
+          this->PointMap[ ref ] = newId;
+          this->SrcPtIds[ newId ++ ] = ref;
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// The output points are the used input points, followed by the edge points
+// and the centroids.
+struct TableBasedClipperPointIds
+{
+  vtkIdType         NumberOfPoints;
+  vtkIdType         NumberOfUsedPoints;
+  vtkIdType         NumberOfEdges;
+  const vtkIdType * PointMap;
+
+  vtkIdType operator()( vtkIdType ref ) const
+  {
+    if ( ref < 0 )
+    {
+      return this->NumberOfUsedPoints + this->NumberOfEdges - 1 - ref;
+    }
+    else if ( ref >= this->NumberOfPoints )
+    {
+      return this->NumberOfUsedPoints + ref - this->NumberOfPoints;
+    }
+    return this->PointMap[ ref ];
+  }
+};
+
+//-----------------------------------------------------------------------------
+struct TableBasedClipperRenumberOp
+{
+  TableBasedClipperPointIds PointIds;
+  vtkIdType               * Conn;
+  const vtkIdType         * Locations;
+
+  void operator()( vtkIdType cellId, vtkIdType endCellId ) const
+  {
+    for ( ; cellId < endCellId; cellId ++ )
+    {
+      vtkIdType loc = this->Locations[ cellId ];
+      vtkIdType end = loc + 1 + this->Conn[ loc ];
+      for ( loc ++; loc < end; loc ++ )
+      {
+        this->Conn[ loc ] = this->PointIds( this->Conn[ loc ] );
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Copy the used input points and their attributes.
+struct TableBasedClipperCopyPointsOp
+{
+  vtkDataSet      * Input;
+  const vtkIdType * SrcPtIds;
+  vtkPoints       * Points;
+  ArrayList       * Arrays;
+  vtkIntArray     * OrigNodes;
+  vtkIntArray     * NewOrigNodes;
+
+  void operator()( vtkIdType ptId, vtkIdType endPtId ) const
+  {
+    double x[3];
+    for ( ; ptId < endPtId; ptId ++ )
+    {
+      vtkIdType srcId = this->SrcPtIds[ ptId ];
+      this->Input->GetPoint( srcId, x );
+      this->Points->SetPoint( ptId, x );
+      this->Arrays->Copy( srcId, ptId );
+      if ( this->NewOrigNodes )
+      {
+        for ( int c = 0; c < this->NewOrigNodes->GetNumberOfComponents(); c ++ )
+        {
+          this->NewOrigNodes->SetTypedComponent
+            ( ptId, c, this->OrigNodes->GetTypedComponent( srcId, c ) );
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Interpolate the edge points and their attributes.
+struct TableBasedClipperEdgePointsOp
+{
+  vtkDataSet                  * Input;
+  const TableBasedClipperEdge * Edges;
+  vtkIdType                     NumberOfUsedPoints;
+  vtkPoints                   * Points;
+  ArrayList                   * Arrays;
+  vtkIntArray                 * OrigNodes;
+  vtkIntArray                 * NewOrigNodes;
+
+  void operator()( vtkIdType edgeId, vtkIdType endEdgeId ) const
+  {
+    double pt[3], pt1[3], pt2[3];
+    for ( ; edgeId < endEdgeId; edgeId ++ )
+    {
+      const TableBasedClipperEdge & edge = this->Edges[ edgeId ];
+      vtkIdType ptIdx = this->NumberOfUsedPoints + edgeId;
+      this->Input->GetPoint( edge.Pt1, pt1 );
+      this->Input->GetPoint( edge.Pt2, pt2 );
+      double p  = edge.Percent;
+      double bp = 1.0 - p;
+      pt[0] = pt1[0] * p + pt2[0] * bp;
+      pt[1] = pt1[1] * p + pt2[1] * bp;
+      pt[2] = pt1[2] * p + pt2[2] * bp;
+      this->Points->SetPoint( ptIdx, pt );
+      this->Arrays->InterpolateEdge( edge.Pt1, edge.Pt2, bp, ptIdx );
+      if ( this->NewOrigNodes )
+      {
+        vtkIdType id = ( bp <= 0.5 ? edge.Pt1 : edge.Pt2 );
+        for ( int c = 0; c < this->NewOrigNodes->GetNumberOfComponents(); c ++ )
+        {
+          this->NewOrigNodes->SetTypedComponent
+            ( ptIdx, c, this->OrigNodes->GetTypedComponent( id, c ) );
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+// Compute the centroids and their attributes from the output points. A
+// centroid may depend on the previous centroids of its chunk, so the
+// centroids of a chunk are computed in order.
+struct TableBasedClipperCentroidsOp
+{
+  TableBasedClipperChunk  * Chunks;
+  const vtkIdType         * EdgeMap;
+  TableBasedClipperPointIds PointIds;
+  vtkPoints               * Points;
+  ArrayList               * Arrays; // interpolating the output attributes
+  vtkIntArray             * NewOrigNodes;
+
+  void operator()( vtkIdType chunkId, vtkIdType endChunkId ) const
+  {
+    vtkIdType ids[8];
+    double weights[8];
+    double x[3];
+    vtkIdType centroidStart = this->PointIds.NumberOfUsedPoints +
+                              this->PointIds.NumberOfEdges;
+    for ( ; chunkId < endChunkId; chunkId ++ )
+    {
+      const TableBasedClipperChunk & chunk = this->Chunks[ chunkId ];
+      vtkIdType ptIdx = centroidStart + chunk.CentroidOffset;
+      for ( size_t i = 0; i < chunk.Centroids.size(); i ++, ptIdx ++ )
+      {
+        const TableBasedClipperCentroid & ce = chunk.Centroids[i];
+        double pt[3] = { 0.0, 0.0, 0.0 };
+        double weight_factor = 1.0 / ce.NumPts;
+        for ( int k = 0; k < ce.NumPts; k ++ )
+        {
+          weights[k] = 1.0 * weight_factor;
+          ids[k] = this->PointIds( GetGlobalPointReference
+            ( ce.PtIds[k], this->PointIds.NumberOfPoints, chunk, this->EdgeMap ) );
+          this->Points->GetPoint( ids[k], x );
+          pt[0] += x[0];
+          pt[1] += x[1];
+          pt[2] += x[2];
+        }
+        pt[0] *= weight_factor;
+        pt[1] *= weight_factor;
+        pt[2] *= weight_factor;
+
+        this->Points->SetPoint( ptIdx, pt );
+        this->Arrays->Interpolate( ce.NumPts, ids, weights, ptIdx );
+        if ( this->NewOrigNodes )
+        {
+          // these 'created' nodes have no original designation
+          for ( int z = 0; z < this->NewOrigNodes->GetNumberOfComponents(); z ++ )
+          {
+            this->NewOrigNodes->SetTypedComponent( ptIdx, z, -1 );
+          }
+        }
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+struct TableBasedClipperIdentityOp
+{
+  vtkIdType * Ids;
+
+  void operator()( vtkIdType id, vtkIdType endId ) const
+  {
+    for ( ; id < endId; id ++ )
+    {
+      this->Ids[ id ] = id;
+    }
+  }
+};
+}
+// ============================================================================
+// ================== threaded clipping of point sets ( end ) =================
+// ============================================================================
+
+
 //-----------------------------------------------------------------------------
 // Construct with user-specified implicit function; InsideOut turned off; value
 // set to 0.0; and generate clip scalars turned off.
@@ -1619,6 +2437,7 @@ vtkTableBasedClipDataSet::vtkTableBasedClipDataSet( vtkImplicitFunction * cf )
   this->GenerateClippedOutput = 0;
 
   this->OutputPointsPrecision = DEFAULT_PRECISION;
+  this->EnableSMP = 0;
 
   this->SetNumberOfOutputPorts( 2 );
   vtkUnstructuredGrid * output2 = vtkUnstructuredGrid::New();
@@ -1810,10 +2629,19 @@ int vtkTableBasedClipDataSet::RequestData( vtkInformation * vtkNotUsed( request
       cpyInput->GetPointData()->SetScalars( pScalars );
     }
 
-    for ( i = 0; i < numbPnts; i ++ )
+    if ( this->EnableSMP )
+    {
+      TableBasedClipperFunctionOp evaluate =
+        { cpyInput.GetPointer(), this->ClipFunction, pScalars->GetPointer( 0 ) };
+      vtkSMPTools::For( 0, numbPnts, evaluate );
+    }
+    else
     {
-      double s = this->ClipFunction->FunctionValue(  cpyInput->GetPoint( i )  );
-      pScalars->SetTuple1( i, s );
+      for ( i = 0; i < numbPnts; i ++ )
+      {
+        double s = this->ClipFunction->FunctionValue(  cpyInput->GetPoint( i )  );
+        pScalars->SetTuple1( i, s );
+      }
     }
 
     clipAray = pScalars;
@@ -1831,6 +2659,19 @@ int vtkTableBasedClipDataSet::RequestData( vtkInformation * vtkNotUsed( request
   int    gridType = cpyInput->GetDataObjectType();
   double isoValue = ( !this->ClipFunction || this->UseValueAsOffset )
                     ?  this->Value  :  0.0;
+  if ( this->EnableSMP && ( gridType == VTK_UNSTRUCTURED_GRID ||
+       gridType == VTK_POLY_DATA || gridType == VTK_STRUCTURED_GRID ) )
+  {
+    this->ClipPointSetSMP( cpyInput.GetPointer(), clipAray, isoValue, outputUG );
+    if (clippedOutputUG)
+    {
+      this->InsideOut = !(this->InsideOut);
+      this->ClipPointSetSMP( cpyInput.GetPointer(), clipAray, isoValue,
+                             clippedOutputUG );
+      this->InsideOut = !(this->InsideOut);
+    }
+  }
+  else
   if ( gridType == VTK_IMAGE_DATA || gridType == VTK_STRUCTURED_POINTS )
   {
     this->ClipImageData( cpyInput.GetPointer(), clipAray, isoValue, outputUG );
@@ -3423,6 +4264,314 @@ void vtkTableBasedClipDataSet::ClipUnstructuredGridData( vtkDataSet * inputGrd,
   unstruct = NULL;
 }
 
+//-----------------------------------------------------------------------------
+void vtkTableBasedClipDataSet::ClipPointSetSMP( vtkDataSet * inputGrd,
+     vtkDataArray * clipAray, double isoValue, vtkUnstructuredGrid * outputUG )
+{
+  vtkPointSet * pointSet = vtkPointSet::SafeDownCast( inputGrd );
+  vtkIdType numPts = inputGrd->GetNumberOfPoints();
+  vtkIdType numCells = inputGrd->GetNumberOfCells();
+  vtkPointData * inPD = inputGrd->GetPointData();
+  vtkCellData * inCD = inputGrd->GetCellData();
+  vtkPointData * outPD = NULL;
+  vtkCellData * outCD = NULL;
+
+  // The cell access methods of the datasets are thread safe once they have
+  // been called from a single thread (e.g. to build the cells of polydata).
+  if ( numCells > 0 )
+  {
+    vtkIdList * cellPts = vtkIdList::New();
+    inputGrd->GetCellPoints( 0, cellPts );
+    inputGrd->GetCellType( 0 );
+    cellPts->Delete();
+  }
+
+  // Clip the cells of each chunk into its own buffers.
+  vtkIdType numChunks = ( numCells + CLIP_CHUNK_SIZE - 1 ) / CLIP_CHUNK_SIZE;
+  std::vector< TableBasedClipperChunk > chunks( numChunks );
+  TableBasedClipperCellsOp clipCells;
+  clipCells.Input = inputGrd;
+  clipCells.ClipArray = clipAray;
+  clipCells.IsoValue = isoValue;
+  clipCells.InsideOut = this->InsideOut;
+  clipCells.NumberOfCells = numCells;
+  clipCells.Chunks = chunks.empty() ? NULL : &chunks[0];
+  vtkSMPTools::For( 0, numChunks, clipCells );
+
+  // Offsets of the chunks in the output, the cells being grouped by shape
+  // type as with vtkTableBasedClipperVolumeFromVolume.
+  vtkIdType numEdgeUses = 0;
+  vtkIdType numCentroids = 0;
+  vtkIdType numSpecials = 0;
+  vtkIdType ncells = 0;
+  vtkIdType conn_size = 0;
+  vtkIdType typeCellStart[ CLIP_NUM_SHAPE_TYPES ];
+  vtkIdType typeConnStart[ CLIP_NUM_SHAPE_TYPES ];
+  for ( int t = 0; t < CLIP_NUM_SHAPE_TYPES; t ++ )
+  {
+    typeCellStart[t] = ncells;
+    typeConnStart[t] = conn_size;
+    for ( vtkIdType c = 0; c < numChunks; c ++ )
+    {
+      chunks[c].CellOffsets[t] = ncells;
+      ncells += static_cast< vtkIdType >( chunks[c].Shapes[t].size() ) /
+                ( CLIP_SHAPE_SIZES[t] + 1 );
+    }
+    conn_size += ( ncells - typeCellStart[t] ) * ( CLIP_SHAPE_SIZES[t] + 1 );
+  }
+  for ( vtkIdType c = 0; c < numChunks; c ++ )
+  {
+    chunks[c].EdgeOffset = numEdgeUses;
+    chunks[c].CentroidOffset = numCentroids;
+    numEdgeUses += static_cast< vtkIdType >( chunks[c].Edges.size() );
+    numCentroids += static_cast< vtkIdType >( chunks[c].Centroids.size() );
+    numSpecials += static_cast< vtkIdType >( chunks[c].SpecialCells.size() );
+  }
+
+  // Merge the points generated on the same edge by sorting the edges. The
+  // merged points are numbered in order of generation.
+  std::vector< vtkIdType > edgeMap( numEdgeUses + 1 );
+  std::vector< TableBasedClipperEdge > edges;
+  vtkIdType numEdges = 0;
+  {
+    std::vector< TableBasedClipperEdgeKey > keys( numEdgeUses );
+    TableBasedClipperEdgeKeysOp gatherKeys =
+      { clipCells.Chunks, keys.empty() ? NULL : &keys[0] };
+    vtkSMPTools::For( 0, numChunks, gatherKeys );
+    vtkSMPTools::Sort( keys.begin(), keys.end() );
+
+    std::vector< vtkIdType > isFirst( numEdgeUses + 1, 0 );
+    TableBasedClipperMergeEdgesOp merge =
+      { keys.empty() ? NULL : &keys[0], numEdgeUses, &edgeMap[0],
+        &isFirst[0] };
+    vtkSMPTools::For( 0, numEdgeUses, merge );
+    std::vector< TableBasedClipperEdgeKey >().swap( keys );
+
+    numEdges = vtkSMPTools::ExclusiveScan
+      ( isFirst.begin(), isFirst.end() - 1, isFirst.begin(),
+        static_cast< vtkIdType >( 0 ) );
+    edges.resize( numEdges );
+    TableBasedClipperNumberEdgesOp numberEdges =
+      { clipCells.Chunks, &isFirst[0], &edgeMap[0],
+        edges.empty() ? NULL : &edges[0] };
+    vtkSMPTools::For( 0, numChunks, numberEdges );
+  }
+
+  // Write the output cells, then number the used input points in order of
+  // first use and renumber the cells.
+  vtkIdTypeArray * nlist = vtkIdTypeArray::New();
+  vtkIdType * nl = nlist->WritePointer( 0, conn_size );
+  vtkUnsignedCharArray * cellTypes = vtkUnsignedCharArray::New();
+  cellTypes->SetNumberOfValues( ncells );
+  vtkIdTypeArray * cellLocations = vtkIdTypeArray::New();
+  cellLocations->SetNumberOfValues( ncells );
+  vtkIdList * srcCellIds = vtkIdList::New();
+  srcCellIds->SetNumberOfIds( ncells );
+
+  std::vector< vtkIdType > pointMap( numPts + 1, -1 );
+  vtkIdList * srcPtIds = vtkIdList::New();
+  vtkIdType numUsed = 0;
+  {
+    std::vector< std::atomic< vtkIdType > > firstUse( numPts + 1 );
+    vtkSMPTools::Fill( firstUse.begin(), firstUse.end(), VTK_ID_MAX );
+
+    TableBasedClipperWriteCellsOp writeCells;
+    writeCells.Chunks = clipCells.Chunks;
+    writeCells.NumberOfPoints = numPts;
+    writeCells.EdgeMap = &edgeMap[0];
+    writeCells.TypeCellStart = typeCellStart;
+    writeCells.TypeConnStart = typeConnStart;
+    writeCells.Conn = nl;
+    writeCells.Locations = cellLocations->GetPointer( 0 );
+    writeCells.Types = cellTypes->GetPointer( 0 );
+    writeCells.SrcCellIds = srcCellIds->GetPointer( 0 );
+    writeCells.FirstUse = &firstUse[0];
+    vtkSMPTools::For( 0, numChunks, writeCells );
+
+    std::vector< vtkIdType > counts( ncells + 1 );
+    TableBasedClipperCountPointsOp countPoints =
+      { numPts, nl, writeCells.Locations, &firstUse[0], &counts[0] };
+    vtkSMPTools::For( 0, ncells, countPoints );
+    numUsed = vtkSMPTools::ExclusiveScan
+      ( counts.begin(), counts.end() - 1, counts.begin(),
+        static_cast< vtkIdType >( 0 ) );
+
+    srcPtIds->SetNumberOfIds( numUsed );
+    TableBasedClipperNumberPointsOp numberPoints =
+      { numPts, nl, writeCells.Locations, &firstUse[0], &counts[0],
+        &pointMap[0], srcPtIds->GetPointer( 0 ) };
+    vtkSMPTools::For( 0, ncells, numberPoints );
+  }
+
+  TableBasedClipperPointIds pointIds =
+    { numPts, numUsed, numEdges, &pointMap[0] };
+  TableBasedClipperRenumberOp renumber =
+    { pointIds, nl, cellLocations->GetPointer( 0 ) };
+  vtkSMPTools::For( 0, ncells, renumber );
+
+  //
+  // Set up the output points and its point data.
+  //
+  vtkUnstructuredGrid * visItGrd =
+    numSpecials > 0 ? vtkUnstructuredGrid::New() : outputUG;
+  outPD = visItGrd->GetPointData();
+  outCD = visItGrd->GetCellData();
+
+  vtkPoints * outPts = vtkPoints::New();
+
+  // set precision for the points in the output
+  if(this->OutputPointsPrecision == vtkAlgorithm::DEFAULT_PRECISION)
+  {
+    if(pointSet && pointSet->GetPoints())
+    {
+      outPts->SetDataType(pointSet->GetPoints()->GetDataType());
+    }
+    else
+    {
+      outPts->SetDataType(VTK_FLOAT);
+    }
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::SINGLE_PRECISION)
+  {
+    outPts->SetDataType(VTK_FLOAT);
+  }
+  else if(this->OutputPointsPrecision == vtkAlgorithm::DOUBLE_PRECISION)
+  {
+    outPts->SetDataType(VTK_DOUBLE);
+  }
+
+  vtkIdType nOutPts = numUsed + numEdges + numCentroids;
+  outPts->SetNumberOfPoints( nOutPts );
+  outPD->CopyAllocate( inPD, nOutPts );
+
+  // The attributes are processed with array pairs, which can be accessed
+  // from several threads. The array of the original node numbers is filled
+  // separately.
+  vtkIntArray * newOrigNodes = NULL;
+  vtkIntArray * origNodes = vtkArrayDownCast<vtkIntArray>
+                (  inPD->GetArray( "avtOriginalNodeNumbers" )  );
+  if ( origNodes != NULL )
+  {
+    newOrigNodes = vtkIntArray::New();
+    newOrigNodes->SetNumberOfComponents( origNodes->GetNumberOfComponents() );
+    newOrigNodes->SetNumberOfTuples( nOutPts );
+    newOrigNodes->SetName( origNodes->GetName() );
+    outPD->AddArray( newOrigNodes );
+    newOrigNodes->Delete();
+  }
+  ArrayList arrays;
+  if ( origNodes != NULL )
+  {
+    arrays.ExcludeArray( origNodes );
+  }
+  arrays.AddArrays( nOutPts, inPD, outPD, 0.0, false );
+  for ( int a = outPD->GetNumberOfArrays() - 1; a >= 0; a -- )
+  {
+    // arrays that can not be interpolated with array pairs
+    if ( outPD->GetAbstractArray( a )->GetNumberOfTuples() != nOutPts )
+    {
+      outPD->RemoveArray( a );
+    }
+  }
+  ArrayList outArrays;
+  if ( newOrigNodes != NULL )
+  {
+    outArrays.ExcludeArray( newOrigNodes );
+  }
+  outArrays.AddSelfInterpolatingArrays( nOutPts, outPD );
+
+  TableBasedClipperCopyPointsOp copyPoints =
+    { inputGrd, srcPtIds->GetPointer( 0 ), outPts, &arrays, origNodes,
+      newOrigNodes };
+  vtkSMPTools::For( 0, numUsed, copyPoints );
+
+  TableBasedClipperEdgePointsOp edgePoints =
+    { inputGrd, edges.empty() ? NULL : &edges[0], numUsed, outPts, &arrays,
+      origNodes, newOrigNodes };
+  vtkSMPTools::For( 0, numEdges, edgePoints );
+
+  TableBasedClipperCentroidsOp centroids =
+    { clipCells.Chunks, &edgeMap[0], pointIds, outPts, &outArrays,
+      newOrigNodes };
+  vtkSMPTools::For( 0, numChunks, centroids );
+
+  visItGrd->SetPoints( outPts );
+  outPts->Delete();
+
+  //
+  // Now set up the shapes and the cell data.
+  //
+  vtkCellArray * cells = vtkCellArray::New();
+  cells->SetCells( ncells, nlist );
+  nlist->Delete();
+  visItGrd->SetCells( cellTypes, cellLocations, cells );
+  cellTypes->Delete();
+  cellLocations->Delete();
+  cells->Delete();
+
+  vtkIdList * dstIds = vtkIdList::New();
+  dstIds->SetNumberOfIds( ncells );
+  TableBasedClipperIdentityOp identity = { dstIds->GetPointer( 0 ) };
+  vtkSMPTools::For( 0, ncells, identity );
+  outCD->CopyAllocate( inCD, ncells );
+  outCD->CopyData( inCD, srcCellIds, dstIds );
+  dstIds->Delete();
+  srcCellIds->Delete();
+  srcPtIds->Delete();
+
+  // the stuff that can not be clipped, which is handled as with
+  // ClipUnstructuredGridData()
+  if ( numSpecials > 0 )
+  {
+    vtkUnstructuredGrid * unstruct =
+      vtkUnstructuredGrid::SafeDownCast( inputGrd );
+    vtkUnstructuredGrid * specials = vtkUnstructuredGrid::New();
+    specials->SetPoints( pointSet->GetPoints() );
+    specials->GetPointData()->ShallowCopy( inPD );
+    specials->Allocate( numSpecials );
+    specials->GetCellData()->CopyAllocate( inCD, numSpecials );
+
+    vtkIdList * cellPts = vtkIdList::New();
+    vtkIdType numCants = 0;
+    for ( vtkIdType c = 0; c < numChunks; c ++ )
+    {
+      const std::vector< vtkIdType > & cellIds = chunks[c].SpecialCells;
+      for ( size_t i = 0; i < cellIds.size(); i ++ )
+      {
+        int cellType = inputGrd->GetCellType( cellIds[i] );
+        if ( cellType == VTK_POLYHEDRON && unstruct )
+        {
+          vtkIdType nfaces, *facePtIds;
+          unstruct->GetFaceStream( cellIds[i], nfaces, facePtIds );
+          specials->InsertNextCell( cellType, nfaces, facePtIds );
+        }
+        else
+        {
+          inputGrd->GetCellPoints( cellIds[i], cellPts );
+          specials->InsertNextCell( cellType, cellPts );
+        }
+        specials->GetCellData()->CopyData( inCD, cellIds[i], numCants ++ );
+      }
+    }
+    cellPts->Delete();
+
+    vtkUnstructuredGrid * vtkUGrid  = vtkUnstructuredGrid::New();
+    this->ClipDataSet( specials, clipAray, vtkUGrid );
+
+    vtkAppendFilter * appender = vtkAppendFilter::New();
+    appender->AddInputData( vtkUGrid );
+    appender->AddInputData( visItGrd );
+    appender->Update();
+
+    outputUG->ShallowCopy( appender->GetOutput() );
+
+    appender->Delete();
+    vtkUGrid->Delete();
+    visItGrd->Delete();
+    specials->Delete();
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkTableBasedClipDataSet::PrintSelf( ostream & os, vtkIndent indent )
 {
@@ -3459,4 +4608,7 @@ void vtkTableBasedClipDataSet::PrintSelf( ostream & os, vtkIndent indent )
 
   os << indent << "Precision of the output points: "
      << this->OutputPointsPrecision << "\n";
+
+  os << indent << "EnableSMP: "
+     << (this->EnableSMP ? "On\n" : "Off\n");
 }
@@ -83,6 +83,18 @@
  *  points produces degenerate cells, which can be fixed by post-processing the
  *  output with a filter like vtkCleanGrid.
  *
+ * @warning
+ *  When EnableSMP is on, unstructured grids, polydata and structured grids are
+ *  clipped in parallel with vtkSMPTools: the cells are clipped in chunks, each
+ *  with its own output buffers, the points generated on the same edge are
+ *  merged by sorting the edges, and the output is assembled with prefix sums.
+ *  The output is the same as with the serial algorithm and does not depend
+ *  on the number of threads, except for integral point attributes, which are
+ *  truncated (instead of rounded) when interpolated, and for point arrays
+ *  which are not data arrays (e.g. string arrays), which are not passed. The
+ *  clip function, if any, is also evaluated in parallel, so it must be
+ *  thread safe.
+ *
  * @par Thanks:
  *  This filter was adapted from the VisIt clipper (vtkVisItClipper).
  *
@@ -228,6 +240,17 @@ public:
   vtkGetMacro(OutputPointsPrecision, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded clipping of unstructured grids, polydata and
+   * structured grids (see the class documentation). This flag is off by
+   * default.
+   */
+  vtkSetMacro( EnableSMP, int );
+  vtkGetMacro( EnableSMP, int );
+  vtkBooleanMacro( EnableSMP, int );
+  //@}
+
 protected:
   vtkTableBasedClipDataSet( vtkImplicitFunction * cf = NULL );
   ~vtkTableBasedClipDataSet() VTK_OVERRIDE;
@@ -287,6 +310,14 @@ protected:
   void ClipUnstructuredGridData( vtkDataSet * inputGrd, vtkDataArray * clipAray,
                                  double isoValue, vtkUnstructuredGrid * outputUG );
 
+  /**
+   * This function clips a vtkPointSet in parallel, as described in the class
+   * documentation. The cells that can not be clipped with the tables are
+   * handled as with ClipUnstructuredGridData(......).
+   */
+  void ClipPointSetSMP( vtkDataSet * inputGrd, vtkDataArray * clipAray,
+                        double isoValue, vtkUnstructuredGrid * outputUG );
+
 
   /**
    * Register a callback function with the InternalProgressObserver.
@@ -311,6 +342,7 @@ protected:
   vtkIncrementalPointLocator * Locator;
 
   int OutputPointsPrecision;
+  int EnableSMP;
 
 private:
   vtkTableBasedClipDataSet( const vtkTableBasedClipDataSet &) VTK_DELETE_FUNCTION;
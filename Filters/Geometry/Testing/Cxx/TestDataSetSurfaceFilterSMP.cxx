@@ -0,0 +1,253 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestDataSetSurfaceFilterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded extraction of the faces of unstructured grids by
+// vtkDataSetSurfaceFilter produces the same output as the serial one.
+
+#include "vtkCellData.h"
+#include "vtkCellType.h"
+#include "vtkDataSetSurfaceFilter.h"
+#include "vtkDataSetTriangleFilter.h"
+#include "vtkDoubleArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnsignedCharArray.h"
+#include "vtkUnstructuredGrid.h"
+
+#include <cmath>
+
+namespace
+{
+// Add scalars at the points and the cells, and global ids at the points.
+void AddArrays(vtkUnstructuredGrid *grid)
+{
+  vtkNew<vtkDoubleArray> pointScalars;
+  pointScalars->SetName("Scalars");
+  vtkNew<vtkIdTypeArray> globalIds;
+  globalIds->SetName("GlobalIds");
+  double x[3];
+  for (vtkIdType i = 0; i < grid->GetNumberOfPoints(); ++i)
+  {
+    grid->GetPoint(i, x);
+    pointScalars->InsertNextValue(sin(x[0]) + x[1] * x[2]);
+    globalIds->InsertNextValue(1000 + i);
+  }
+  grid->GetPointData()->SetScalars(pointScalars.Get());
+  grid->GetPointData()->SetGlobalIds(globalIds.Get());
+
+  vtkNew<vtkIntArray> cellIds;
+  cellIds->SetName("CellIds");
+  for (vtkIdType i = 0; i < grid->GetNumberOfCells(); ++i)
+  {
+    cellIds->InsertNextValue(static_cast<int>(2 * i + 1));
+  }
+  grid->GetCellData()->AddArray(cellIds.Get());
+}
+
+// A grid of hexahedra, some of which are split into wedges or pyramids,
+// and into which cells of lower dimension are interleaved.
+vtkSmartPointer<vtkUnstructuredGrid> MakeGrid(int n, bool split,
+                                              bool lowerCells)
+{
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  int s = n + 1;
+  for (int k = 0; k <= n; ++k)
+  {
+    for (int j = 0; j <= n; ++j)
+    {
+      for (int i = 0; i <= n; ++i)
+      {
+        points->InsertNextPoint(i + 0.1 * sin(j + 2.0 * k), j + 0.05 * k, k);
+      }
+    }
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points.Get());
+  grid->Allocate(8 * n * n * n);
+  const int faces[6][4] = {{0,1,5,4}, {0,3,2,1}, {0,4,7,3},
+                           {1,2,6,5}, {2,3,7,6}, {4,5,6,7}};
+  for (int k = 0; k < n; ++k)
+  {
+    for (int j = 0; j < n; ++j)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        vtkIdType p = i + s * (j + s * k);
+        vtkIdType c[8] = {p, p + 1, p + 1 + s, p + s,
+                          p + s * s, p + 1 + s * s, p + 1 + s + s * s,
+                          p + s + s * s};
+        int mode = split ? (i + 2 * j + k) % 3 : 0;
+        if (mode == 0)
+        {
+          grid->InsertNextCell(VTK_HEXAHEDRON, 8, c);
+        }
+        else if (mode == 1)
+        {
+          vtkIdType wedge1[6] = {c[0], c[1], c[2], c[4], c[5], c[6]};
+          vtkIdType wedge2[6] = {c[0], c[2], c[3], c[4], c[6], c[7]};
+          grid->InsertNextCell(VTK_WEDGE, 6, wedge1);
+          grid->InsertNextCell(VTK_WEDGE, 6, wedge2);
+        }
+        else
+        {
+          double x[3] = {0.0, 0.0, 0.0};
+          for (int l = 0; l < 8; ++l)
+          {
+            double y[3];
+            points->GetPoint(c[l], y);
+            x[0] += y[0] / 8;
+            x[1] += y[1] / 8;
+            x[2] += y[2] / 8;
+          }
+          vtkIdType center = points->InsertNextPoint(x);
+          for (int f = 0; f < 6; ++f)
+          {
+            vtkIdType pyramid[5] = {c[faces[f][0]], c[faces[f][1]],
+                                    c[faces[f][2]], c[faces[f][3]], center};
+            grid->InsertNextCell(VTK_PYRAMID, 5, pyramid);
+          }
+        }
+        if (lowerCells && i == j && j == k)
+        {
+          vtkIdType line[3] = {c[0], c[6], c[7]};
+          grid->InsertNextCell(VTK_POLY_LINE, 3, line);
+          grid->InsertNextCell(VTK_VERTEX, 1, c + 5);
+          vtkIdType quad[4] = {c[0], c[1], c[3], c[2]};
+          grid->InsertNextCell(VTK_PIXEL, 4, quad);
+          grid->InsertNextCell(VTK_TRIANGLE_STRIP, 5, c + 2);
+          grid->InsertNextCell(VTK_POLYGON, 5, c);
+          grid->InsertNextCell(VTK_TRIANGLE, 3, c + 4);
+          grid->InsertNextCell(VTK_EMPTY_CELL, 0, c);
+          grid->InsertNextCell(VTK_POLY_VERTEX, 3, c + 1);
+        }
+      }
+    }
+  }
+  return grid;
+}
+
+// Stacks of pentagonal and hexagonal prisms, every other prism listing its
+// bases in the opposite direction.
+vtkSmartPointer<vtkUnstructuredGrid> MakePrisms()
+{
+  vtkNew<vtkPoints> points;
+  vtkSmartPointer<vtkUnstructuredGrid> grid =
+    vtkSmartPointer<vtkUnstructuredGrid>::New();
+  grid->SetPoints(points.Get());
+  grid->Allocate(8);
+  for (int n = 5; n <= 6; ++n)
+  {
+    vtkIdType first = points->GetNumberOfPoints();
+    for (int k = 0; k <= 4; ++k)
+    {
+      for (int i = 0; i < n; ++i)
+      {
+        double angle = 2.0 * 3.14159265358979 * i / n;
+        points->InsertNextPoint(3.0 * n + cos(angle), sin(angle), k);
+      }
+    }
+    for (int k = 0; k < 4; ++k)
+    {
+      vtkIdType prism[12];
+      for (int i = 0; i < n; ++i)
+      {
+        int l = (k % 2) ? (n - i) % n : i;
+        prism[i] = first + k * n + l;
+        prism[i + n] = first + (k + 1) * n + l;
+      }
+      grid->InsertNextCell(n == 5 ? VTK_PENTAGONAL_PRISM : VTK_HEXAGONAL_PRISM,
+                           2 * n, prism);
+    }
+  }
+  return grid;
+}
+
+bool CheckSurface(vtkUnstructuredGrid *input, bool passThroughIds)
+{
+  vtkNew<vtkDataSetSurfaceFilter> serial;
+  vtkNew<vtkDataSetSurfaceFilter> threaded;
+  vtkDataSetSurfaceFilter *filters[2] = {serial.Get(), threaded.Get()};
+  for (int j = 0; j < 2; ++j)
+  {
+    filters[j]->SetInputData(input);
+    filters[j]->SetEnableSMP(j);
+    filters[j]->SetPassThroughCellIds(passThroughIds);
+    filters[j]->SetPassThroughPointIds(passThroughIds);
+    filters[j]->Update();
+  }
+  return threaded->GetOutput()->GetNumberOfCells() > 0 &&
+    vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                          threaded->GetOutput());
+}
+}
+
+int TestDataSetSurfaceFilterSMP(int, char *[])
+{
+  // Hexahedra, hexahedra split into wedges and pyramids, with and without
+  // cells of lower dimension, tetrahedra, and prisms.
+  vtkSmartPointer<vtkUnstructuredGrid> hexahedra = MakeGrid(6, false, false);
+  AddArrays(hexahedra);
+  vtkSmartPointer<vtkUnstructuredGrid> mixed = MakeGrid(6, true, true);
+  AddArrays(mixed);
+  vtkSmartPointer<vtkUnstructuredGrid> split = MakeGrid(5, true, false);
+  AddArrays(split);
+  vtkNew<vtkDataSetTriangleFilter> tetrahedra;
+  tetrahedra->SetInputData(hexahedra);
+  tetrahedra->Update();
+  vtkUnstructuredGrid *tets = tetrahedra->GetOutput();
+  vtkSmartPointer<vtkUnstructuredGrid> prisms = MakePrisms();
+  AddArrays(prisms);
+
+  // Hexahedra with duplicate ghost points on a side and a hidden point.
+  vtkNew<vtkUnstructuredGrid> ghosts;
+  ghosts->DeepCopy(hexahedra);
+  vtkNew<vtkUnsignedCharArray> ghostPoints;
+  ghostPoints->SetName(vtkDataSetAttributes::GhostArrayName());
+  for (vtkIdType i = 0; i < ghosts->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    ghosts->GetPoint(i, x);
+    unsigned char ghost = x[2] < 0.5 ? vtkDataSetAttributes::DUPLICATEPOINT : 0;
+    if (i == 10)
+    {
+      ghost |= vtkDataSetAttributes::HIDDENPOINT;
+    }
+    ghostPoints->InsertNextValue(ghost);
+  }
+  ghosts->GetPointData()->AddArray(ghostPoints.Get());
+
+  vtkUnstructuredGrid *inputs[6] = {
+    hexahedra, mixed, split, tets, prisms, ghosts.Get()};
+  for (int i = 0; i < 6; ++i)
+  {
+    for (int passThroughIds = 0; passThroughIds < 2; ++passThroughIds)
+    {
+      if (!CheckSurface(inputs[i], passThroughIds != 0))
+      {
+        cerr << "Threaded surface differs for input " << i << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
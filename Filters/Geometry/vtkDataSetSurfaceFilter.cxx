@@ -31,6 +31,8 @@
 #include "vtkPolyData.h"
 #include "vtkPyramid.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStructuredGridGeometryFilter.h"
@@ -47,6 +49,8 @@
 #include "vtkStructuredData.h"
 
 #include <algorithm>
+#include <atomic>
+#include <vector>
 #include <vtksys/hash_map.hxx>
 
 #include <cassert>
@@ -129,6 +133,8 @@ vtkDataSetSurfaceFilter::vtkDataSetSurfaceFilter()
   this->OriginalPointIdsName = NULL;
 
   this->NonlinearSubdivisionLevel = 1;
+
+  this->EnableSMP = 0;
 }
 
 //----------------------------------------------------------------------------
@@ -1433,6 +1439,7 @@ void vtkDataSetSurfaceFilter::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "NonlinearSubdivisionLevel: "
      << this->GetNonlinearSubdivisionLevel() << endl;
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 }
 
 //========================================================================
@@ -1445,6 +1452,14 @@ void vtkDataSetSurfaceFilter::PrintSelf(ostream& os, vtkIndent indent)
 int vtkDataSetSurfaceFilter::UnstructuredGridExecute(vtkDataSet *dataSetInput,
                                                      vtkPolyData *output)
 {
+  // The threaded extraction gives up, before touching the output, on the
+  // cells it does not handle.
+  vtkUnstructuredGrid *grid = vtkUnstructuredGrid::SafeDownCast(dataSetInput);
+  if (this->EnableSMP && grid && this->UnstructuredGridExecuteSMP(grid, output))
+  {
+    return 1;
+  }
+
   vtkUnstructuredGridBase *input =
       vtkUnstructuredGridBase::SafeDownCast(dataSetInput);
 
@@ -2180,6 +2195,923 @@ int vtkDataSetSurfaceFilter::UnstructuredGridExecute(vtkDataSet *dataSetInput,
   return 1;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+// The faces of the 3D cells, in the order in which the serial extraction
+// inserts them in the hash. Wedges and pyramids use the faces of their cell
+// classes, like the serial extraction.
+const int TetraFaces[4][3] = {{0,1,3}, {0,2,1}, {0,3,2}, {1,2,3}};
+const int HexahedronFaces[6][4] = {{0,1,5,4}, {0,3,2,1}, {0,4,7,3},
+                                   {1,2,6,5}, {2,3,7,6}, {4,5,6,7}};
+const int VoxelFaces[6][4] = {{0,1,5,4}, {0,2,3,1}, {0,4,6,2},
+                              {1,3,7,5}, {2,6,7,3}, {4,5,7,6}};
+
+// A face is identified by the id of its cell, shifted by FaceIndexBits,
+// and by its index in the cell.
+const int FaceIndexBits = 3;
+const vtkIdType FaceIndexMask = (1 << FaceIndexBits) - 1;
+
+// Number of faces of the cells whose faces are extracted in parallel, 0 for
+// the cells that are passed to the output, and -1 for the cells that only
+// the serial extraction handles.
+int GetNumberOfFaces(int cellType)
+{
+  switch (cellType)
+  {
+    case VTK_EMPTY_CELL:
+    case VTK_VERTEX:
+    case VTK_POLY_VERTEX:
+    case VTK_LINE:
+    case VTK_POLY_LINE:
+    case VTK_TRIANGLE:
+    case VTK_TRIANGLE_STRIP:
+    case VTK_POLYGON:
+    case VTK_PIXEL:
+    case VTK_QUAD:
+      return 0;
+    case VTK_TETRA:
+      return 4;
+    case VTK_HEXAHEDRON:
+    case VTK_VOXEL:
+      return 6;
+    case VTK_WEDGE:
+    case VTK_PYRAMID:
+      return 5;
+    case VTK_PENTAGONAL_PRISM:
+      return 7;
+    case VTK_HEXAGONAL_PRISM:
+      return 8;
+    default:
+      return -1;
+  }
+}
+
+// Get the points of a face of a cell, starting from the point the face
+// hash starts from: the smallest id of triangles and quads when it is
+// unique, and the first smallest id of polygons. Returns the number of
+// points of the face.
+int GetFace(int cellType, const vtkIdType *pts, int faceId, vtkIdType *face)
+{
+  int numFacePts;
+  int i;
+  switch (cellType)
+  {
+    case VTK_TETRA:
+      numFacePts = 3;
+      for (i = 0; i < 3; ++i)
+      {
+        face[i] = pts[TetraFaces[faceId][i]];
+      }
+      break;
+
+    case VTK_HEXAHEDRON:
+    case VTK_VOXEL:
+    {
+      const int *verts = cellType == VTK_HEXAHEDRON ?
+        HexahedronFaces[faceId] : VoxelFaces[faceId];
+      numFacePts = 4;
+      for (i = 0; i < 4; ++i)
+      {
+        face[i] = pts[verts[i]];
+      }
+      break;
+    }
+
+    case VTK_WEDGE:
+    case VTK_PYRAMID:
+    {
+      const int *verts = cellType == VTK_WEDGE ?
+        vtkWedge::GetFaceArray(faceId) : vtkPyramid::GetFaceArray(faceId);
+      numFacePts = verts[3] < 0 ? 3 : 4;
+      for (i = 0; i < numFacePts; ++i)
+      {
+        face[i] = pts[verts[i]];
+      }
+      break;
+    }
+
+    default: // Pentagonal and hexagonal prisms: side quads, then the bases.
+    {
+      int n = cellType == VTK_PENTAGONAL_PRISM ? 5 : 6;
+      if (faceId < n)
+      {
+        int next = (faceId + 1) % n;
+        numFacePts = 4;
+        face[0] = pts[faceId];
+        face[1] = pts[next];
+        face[2] = pts[next + n];
+        face[3] = pts[faceId + n];
+      }
+      else
+      {
+        numFacePts = n;
+        std::copy(pts + (faceId - n) * n, pts + (faceId - n + 1) * n, face);
+      }
+      break;
+    }
+  }
+
+  int first = 0;
+  bool unique = true;
+  for (i = 1; i < numFacePts; ++i)
+  {
+    if (face[i] < face[first])
+    {
+      first = i;
+      unique = true;
+    }
+    else if (face[i] == face[first])
+    {
+      unique = false;
+    }
+  }
+  if (numFacePts > 4 || unique)
+  {
+    std::rotate(face, face + first, face + numFacePts);
+  }
+  return numFacePts;
+}
+
+// The connectivity of the input grid.
+struct GridCells
+{
+  const unsigned char *Types;
+  const vtkIdType *Locations;
+  const vtkIdType *Connectivity;
+
+  // Number of points of the cell followed by its point ids.
+  const vtkIdType *GetCell(vtkIdType cellId) const
+  {
+    return this->Connectivity + this->Locations[cellId];
+  }
+
+  int GetFace(vtkIdType face, vtkIdType *pts) const
+  {
+    vtkIdType cellId = face >> FaceIndexBits;
+    return ::GetFace(this->Types[cellId], this->GetCell(cellId) + 1,
+                     static_cast<int>(face & FaceIndexMask), pts);
+  }
+};
+
+// A face whose points after the first one are listed in the direction of
+// the smallest neighbor of the first point, so that the faces matched by
+// the face hash have the same points.
+struct FaceKey
+{
+  int NumberOfPoints;
+  vtkIdType Points[6];
+
+  void Set(const GridCells &grid, vtkIdType face)
+  {
+    this->NumberOfPoints = grid.GetFace(face, this->Points);
+    if (this->Points[this->NumberOfPoints - 1] < this->Points[1])
+    {
+      std::reverse(this->Points + 1, this->Points + this->NumberOfPoints);
+    }
+  }
+
+  bool SameFace(const FaceKey &other) const
+  {
+    return this->NumberOfPoints == other.NumberOfPoints &&
+      std::equal(this->Points, this->Points + this->NumberOfPoints,
+                 other.Points);
+  }
+};
+
+// A face in the run of the point it starts from, with the next points of
+// its key: the triangles and quads have the same points when the face hash
+// matches them. For polygons, only the next two points are kept and the
+// last value is PolygonKey, the whole keys being compared when needed.
+const vtkIdType TriangleKey = -1;
+const vtkIdType PolygonKey = -2;
+
+struct FaceRecord
+{
+  vtkIdType Face;
+  vtkIdType Key[3];
+
+  // Leave the records uninitialized, they are all set when inserted.
+  FaceRecord()
+  {
+  }
+
+  void Set(const vtkIdType *pts, int numFacePts, vtkIdType face)
+  {
+    this->Face = face;
+    if (numFacePts == 3)
+    {
+      this->Key[0] = std::min(pts[1], pts[2]);
+      this->Key[1] = std::max(pts[1], pts[2]);
+      this->Key[2] = TriangleKey;
+    }
+    else if (numFacePts == 4)
+    {
+      this->Key[0] = pts[2];
+      this->Key[1] = std::min(pts[1], pts[3]);
+      this->Key[2] = std::max(pts[1], pts[3]);
+    }
+    else if (pts[1] < pts[numFacePts - 1])
+    {
+      this->Key[0] = pts[1];
+      this->Key[1] = pts[2];
+      this->Key[2] = PolygonKey;
+    }
+    else
+    {
+      this->Key[0] = pts[numFacePts - 1];
+      this->Key[1] = pts[numFacePts - 2];
+      this->Key[2] = PolygonKey;
+    }
+  }
+
+  bool SameKey(const FaceRecord &other) const
+  {
+    return this->Key[0] == other.Key[0] && this->Key[1] == other.Key[1] &&
+      this->Key[2] == other.Key[2];
+  }
+
+  bool operator<(const FaceRecord &other) const
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      if (this->Key[i] != other.Key[i])
+      {
+        return this->Key[i] < other.Key[i];
+      }
+    }
+    return this->Face < other.Face;
+  }
+
+  static bool FaceLess(const FaceRecord &a, const FaceRecord &b)
+  {
+    return a.Face < b.Face;
+  }
+};
+
+// Check that the cells are handled by the threaded extraction, and count
+// the cells that are passed to the output.
+struct CheckCells
+{
+  const unsigned char *Types;
+  vtkSMPThreadLocal<vtkIdType> LocalUnsupported;
+  vtkSMPThreadLocal<vtkIdType> LocalPassed;
+  vtkIdType NumberOfUnsupportedCells;
+  vtkIdType NumberOfPassedCells;
+
+  CheckCells(const unsigned char *types) : Types(types),
+    NumberOfUnsupportedCells(0), NumberOfPassedCells(0)
+  {
+  }
+
+  void Initialize()
+  {
+    this->LocalUnsupported.Local() = 0;
+    this->LocalPassed.Local() = 0;
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType &unsupported = this->LocalUnsupported.Local();
+    vtkIdType &passed = this->LocalPassed.Local();
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      int numFaces = GetNumberOfFaces(this->Types[cellId]);
+      if (numFaces < 0)
+      {
+        ++unsupported;
+      }
+      else if (numFaces == 0 && this->Types[cellId] != VTK_EMPTY_CELL)
+      {
+        ++passed;
+      }
+    }
+  }
+
+  void Reduce()
+  {
+    vtkSMPThreadLocal<vtkIdType>::iterator iter;
+    for (iter = this->LocalUnsupported.begin();
+         iter != this->LocalUnsupported.end(); ++iter)
+    {
+      this->NumberOfUnsupportedCells += *iter;
+    }
+    for (iter = this->LocalPassed.begin(); iter != this->LocalPassed.end();
+         ++iter)
+    {
+      this->NumberOfPassedCells += *iter;
+    }
+  }
+};
+
+// Count the faces starting from each point. TCount is either vtkIdType or
+// std::atomic<vtkIdType>.
+template <typename TCount>
+struct CountFaces
+{
+  GridCells Grid;
+  TCount *Counts;
+
+  CountFaces(const GridCells &grid, TCount *counts) :
+    Grid(grid), Counts(counts)
+  {
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType face[6];
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      int cellType = this->Grid.Types[cellId];
+      int numFaces = GetNumberOfFaces(cellType);
+      const vtkIdType *pts = this->Grid.GetCell(cellId) + 1;
+      for (int i = 0; i < numFaces; ++i)
+      {
+        GetFace(cellType, pts, i, face);
+        ++this->Counts[face[0]];
+      }
+    }
+  }
+};
+
+// Point the cursors to the end of the runs of faces of each point.
+template <typename TCount>
+struct InitializeCursors
+{
+  const vtkIdType *Offsets;
+  TCount *Cursors;
+
+  InitializeCursors(const vtkIdType *offsets, TCount *cursors) :
+    Offsets(offsets), Cursors(cursors)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      this->Cursors[ptId] = this->Offsets[ptId + 1];
+    }
+  }
+};
+
+// Insert the faces in the runs of the points they start from, filling each
+// run backwards.
+template <typename TCount>
+struct InsertFaces
+{
+  GridCells Grid;
+  TCount *Cursors;
+  FaceRecord *Faces;
+
+  InsertFaces(const GridCells &grid, TCount *cursors, FaceRecord *faces) :
+    Grid(grid), Cursors(cursors), Faces(faces)
+  {
+  }
+
+  void operator()(vtkIdType cellId, vtkIdType endCellId)
+  {
+    vtkIdType face[6];
+    for ( ; cellId < endCellId; ++cellId)
+    {
+      int cellType = this->Grid.Types[cellId];
+      int numFaces = GetNumberOfFaces(cellType);
+      const vtkIdType *pts = this->Grid.GetCell(cellId) + 1;
+      for (int i = 0; i < numFaces; ++i)
+      {
+        int numFacePts = GetFace(cellType, pts, i, face);
+        this->Faces[--this->Cursors[face[0]]].Set(
+          face, numFacePts, (cellId << FaceIndexBits) | i);
+      }
+    }
+  }
+};
+
+// Group the faces by the point they start from. The offsets must hold
+// numPts+1 values.
+template <typename TCount>
+void BucketFaces(const GridCells &grid, vtkIdType numPts, vtkIdType numCells,
+                 vtkIdType *offsets, std::vector<FaceRecord> &faces)
+{
+  // The counts are value initialized, i.e. zeroed. They are then reused as
+  // the insertion cursors.
+  std::vector<TCount> counts(numPts);
+  CountFaces<TCount> count(grid, &counts[0]);
+  vtkSMPTools::For(0, numCells, count);
+  offsets[numPts] = vtkSMPTools::ExclusiveScan(
+    counts.begin(), counts.end(), offsets, static_cast<vtkIdType>(0));
+
+  faces.resize(offsets[numPts]);
+  if (faces.empty())
+  {
+    return;
+  }
+  InitializeCursors<TCount> initialize(offsets, &counts[0]);
+  vtkSMPTools::For(0, numPts, initialize);
+  InsertFaces<TCount> insert(grid, &counts[0], &faces[0]);
+  vtkSMPTools::For(0, numCells, insert);
+}
+
+// Keep, at the beginning of the run of each point, the faces that no other
+// face matches, sorted by cell and face index like in the face hash.
+struct FindSurfaceFaces
+{
+  GridCells Grid;
+  const vtkIdType *Offsets;
+  FaceRecord *Faces;
+  vtkIdType *NumberOfSurfaceFaces;
+  vtkSMPThreadLocal<std::vector<FaceKey> > Keys;
+
+  FindSurfaceFaces(const GridCells &grid, const vtkIdType *offsets,
+                   FaceRecord *faces, vtkIdType *numSurfaceFaces) :
+    Grid(grid), Offsets(offsets), Faces(faces),
+    NumberOfSurfaceFaces(numSurfaceFaces)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    std::vector<FaceKey> &keys = this->Keys.Local();
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      FaceRecord *faces = this->Faces + this->Offsets[ptId];
+      vtkIdType numFaces = this->Offsets[ptId + 1] - this->Offsets[ptId];
+      std::sort(faces, faces + numFaces);
+
+      vtkIdType numSurfaceFaces = 0;
+      for (vtkIdType i = 0; i < numFaces; )
+      {
+        vtkIdType j = i + 1;
+        while (j < numFaces && faces[j].SameKey(faces[i]))
+        {
+          ++j;
+        }
+        if (j == i + 1)
+        {
+          faces[numSurfaceFaces++].Face = faces[i].Face;
+        }
+        else if (faces[i].Key[2] == PolygonKey)
+        {
+          // Polygons starting with the same points: compare all their
+          // points.
+          vtkIdType k, l;
+          keys.resize(j - i);
+          for (k = i; k < j; ++k)
+          {
+            keys[k - i].Set(this->Grid, faces[k].Face);
+          }
+          for (k = i; k < j; ++k)
+          {
+            for (l = i; l < j; ++l)
+            {
+              if (l != k && keys[k - i].SameFace(keys[l - i]))
+              {
+                break;
+              }
+            }
+            if (l == j)
+            {
+              faces[numSurfaceFaces++].Face = faces[k].Face;
+            }
+          }
+        }
+        i = j;
+      }
+      std::sort(faces, faces + numSurfaceFaces, FaceRecord::FaceLess);
+      this->NumberOfSurfaceFaces[ptId] = numSurfaceFaces;
+    }
+  }
+};
+
+// Gather the surface faces of all the points, in the order of the points.
+struct GatherSurfaceFaces
+{
+  const vtkIdType *Offsets;
+  const FaceRecord *Faces;
+  const vtkIdType *SurfaceOffsets;
+  vtkIdType *SurfaceFaces;
+
+  GatherSurfaceFaces(const vtkIdType *offsets, const FaceRecord *faces,
+                     const vtkIdType *surfaceOffsets, vtkIdType *surfaceFaces) :
+    Offsets(offsets), Faces(faces), SurfaceOffsets(surfaceOffsets),
+    SurfaceFaces(surfaceFaces)
+  {
+  }
+
+  void operator()(vtkIdType ptId, vtkIdType endPtId)
+  {
+    for ( ; ptId < endPtId; ++ptId)
+    {
+      const FaceRecord *faces = this->Faces + this->Offsets[ptId];
+      vtkIdType *surfaceFaces = this->SurfaceFaces + this->SurfaceOffsets[ptId];
+      vtkIdType numSurfaceFaces =
+        this->SurfaceOffsets[ptId + 1] - this->SurfaceOffsets[ptId];
+      for (vtkIdType i = 0; i < numSurfaceFaces; ++i)
+      {
+        surfaceFaces[i] = faces[i].Face;
+      }
+    }
+  }
+};
+
+// Size, in the output connectivity, of the surface faces, 0 for the faces
+// whose points are all duplicate ghost points or include a hidden point.
+struct SizeSurfaceFaces
+{
+  GridCells Grid;
+  const vtkIdType *SurfaceFaces;
+  const unsigned char *Ghosts;
+  vtkIdType *Sizes;
+  vtkIdType *Emitted;
+
+  SizeSurfaceFaces(const GridCells &grid, const vtkIdType *surfaceFaces,
+                   const unsigned char *ghosts, vtkIdType *sizes,
+                   vtkIdType *emitted) :
+    Grid(grid), SurfaceFaces(surfaceFaces), Ghosts(ghosts), Sizes(sizes),
+    Emitted(emitted)
+  {
+  }
+
+  void operator()(vtkIdType faceId, vtkIdType endFaceId)
+  {
+    vtkIdType pts[6];
+    for ( ; faceId < endFaceId; ++faceId)
+    {
+      int numFacePts = this->Grid.GetFace(this->SurfaceFaces[faceId], pts);
+      bool emit = true;
+      if (this->Ghosts)
+      {
+        bool allGhosts = true;
+        for (int i = 0; i < numFacePts; ++i)
+        {
+          unsigned char val = this->Ghosts[pts[i]];
+          if (!(val & vtkDataSetAttributes::DUPLICATEPOINT))
+          {
+            allGhosts = false;
+          }
+          if (val & vtkDataSetAttributes::HIDDENPOINT)
+          {
+            emit = false;
+          }
+        }
+        emit = emit && !allGhosts;
+      }
+      this->Sizes[faceId] = emit ? numFacePts + 1 : 0;
+      this->Emitted[faceId] = emit ? 1 : 0;
+    }
+  }
+};
+
+// Write the surface faces with the output point ids, at the locations given
+// by the prefix sums of their sizes, and record their cells.
+struct EmitSurfaceFaces
+{
+  GridCells Grid;
+  const vtkIdType *SurfaceFaces;
+  const vtkIdType *PointMap;
+  const vtkIdType *Sizes;
+  const vtkIdType *Locations;
+  const vtkIdType *CellIds;
+  vtkIdType *Connectivity;
+  vtkIdType *CellSources;
+
+  EmitSurfaceFaces(const GridCells &grid, const vtkIdType *surfaceFaces,
+                   const vtkIdType *pointMap, const vtkIdType *sizes,
+                   const vtkIdType *locations, const vtkIdType *cellIds,
+                   vtkIdType *connectivity, vtkIdType *cellSources) :
+    Grid(grid), SurfaceFaces(surfaceFaces), PointMap(pointMap), Sizes(sizes),
+    Locations(locations), CellIds(cellIds), Connectivity(connectivity),
+    CellSources(cellSources)
+  {
+  }
+
+  void operator()(vtkIdType faceId, vtkIdType endFaceId)
+  {
+    vtkIdType pts[6];
+    for ( ; faceId < endFaceId; ++faceId)
+    {
+      if (this->Sizes[faceId] == 0)
+      {
+        continue;
+      }
+      vtkIdType face = this->SurfaceFaces[faceId];
+      int numFacePts = this->Grid.GetFace(face, pts);
+      vtkIdType *cell = this->Connectivity + this->Locations[faceId];
+      *cell++ = numFacePts;
+      for (int i = 0; i < numFacePts; ++i)
+      {
+        cell[i] = this->PointMap[pts[i]];
+      }
+      this->CellSources[this->CellIds[faceId]] = face >> FaceIndexBits;
+    }
+  }
+};
+
+// Numbers the output points in the order of their first use, like the
+// serial extraction.
+struct PointNumbering
+{
+  std::vector<vtkIdType> Map;
+  std::vector<vtkIdType> Sources;
+
+  PointNumbering(vtkIdType numPts) : Map(numPts, -1)
+  {
+  }
+
+  vtkIdType operator()(vtkIdType ptId)
+  {
+    vtkIdType &outPtId = this->Map[ptId];
+    if (outPtId < 0)
+    {
+      outPtId = static_cast<vtkIdType>(this->Sources.size());
+      this->Sources.push_back(ptId);
+    }
+    return outPtId;
+  }
+
+  void InsertCell(vtkCellArray *cells, vtkIdType npts, const vtkIdType *pts)
+  {
+    cells->InsertNextCell(npts);
+    for (vtkIdType i = 0; i < npts; ++i)
+    {
+      cells->InsertCellPoint((*this)(pts[i]));
+    }
+  }
+};
+
+// Copy the ids into an id list.
+void SetIds(vtkIdList *list, const std::vector<vtkIdType> &ids)
+{
+  list->SetNumberOfIds(static_cast<vtkIdType>(ids.size()));
+  std::copy(ids.begin(), ids.end(), list->GetPointer(0));
+}
+
+// An id list holding 0, 1, ..., n-1.
+void SetRange(vtkIdList *list, vtkIdType n)
+{
+  list->SetNumberOfIds(n);
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    list->SetId(i, i);
+  }
+}
+}
+
+//----------------------------------------------------------------------------
+// The faces of the 3D cells are grouped by the point the face hash would
+// insert them at, in parallel, with atomic counters and a prefix sum. The
+// faces of each point are then sorted to find those used by a single cell.
+// Since the faces of each point are kept in cell order, and the points are
+// numbered in the order of their first use, the output is the same as the
+// one of the serial extraction.
+int vtkDataSetSurfaceFilter::UnstructuredGridExecuteSMP(
+  vtkUnstructuredGrid *input, vtkPolyData *output)
+{
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkIdType numCells = input->GetNumberOfCells();
+  vtkCellArray *cells = input->GetCells();
+  vtkUnsignedCharArray *types = input->GetCellTypesArray();
+  vtkIdTypeArray *locations = input->GetCellLocationsArray();
+  if (numPts < 1 || numCells < 1 || !cells || !types || !locations ||
+      numCells > (VTK_ID_MAX >> FaceIndexBits))
+  {
+    return 0;
+  }
+
+  CheckCells check(types->GetPointer(0));
+  vtkSMPTools::For(0, numCells, check);
+  if (check.NumberOfUnsupportedCells > 0)
+  {
+    return 0;
+  }
+
+  GridCells grid;
+  grid.Types = types->GetPointer(0);
+  grid.Locations = locations->GetPointer(0);
+  grid.Connectivity = cells->GetPointer();
+
+  // Group the faces by the point they start from, and keep those that no
+  // other face matches.
+  std::vector<vtkIdType> offsets(numPts + 1);
+  std::vector<FaceRecord> faces;
+  if (vtkSMPTools::GetEstimatedNumberOfThreads() > 1)
+  {
+    BucketFaces<std::atomic<vtkIdType> >(grid, numPts, numCells,
+                                         &offsets[0], faces);
+  }
+  else
+  {
+    BucketFaces<vtkIdType>(grid, numPts, numCells, &offsets[0], faces);
+  }
+  this->UpdateProgress(0.3);
+
+  std::vector<vtkIdType> surfaceFaces;
+  if (!faces.empty())
+  {
+    std::vector<vtkIdType> surfaceOffsets(numPts + 1);
+    FindSurfaceFaces find(grid, &offsets[0], &faces[0], &surfaceOffsets[0]);
+    vtkSMPTools::For(0, numPts, find);
+    surfaceOffsets[numPts] = vtkSMPTools::ExclusiveScan(
+      surfaceOffsets.begin(), surfaceOffsets.end() - 1,
+      surfaceOffsets.begin(), static_cast<vtkIdType>(0));
+    surfaceFaces.resize(surfaceOffsets[numPts]);
+    if (!surfaceFaces.empty())
+    {
+      GatherSurfaceFaces gather(&offsets[0], &faces[0], &surfaceOffsets[0],
+                                &surfaceFaces[0]);
+      vtkSMPTools::For(0, numPts, gather);
+    }
+  }
+  std::vector<FaceRecord>().swap(faces);
+  std::vector<vtkIdType>().swap(offsets);
+  this->UpdateProgress(0.6);
+
+  // Like the serial extraction, output the vertices, the lines and the 2D
+  // cells in this order, before the faces.
+  vtkIdType numSurfaceFaces = static_cast<vtkIdType>(surfaceFaces.size());
+  PointNumbering numbering(numPts);
+  std::vector<vtkIdType> cellSources;
+  vtkNew<vtkCellArray> newVerts;
+  vtkNew<vtkCellArray> newLines;
+  vtkNew<vtkCellArray> newPolys;
+  vtkIdType i;
+  if (check.NumberOfPassedCells > 0)
+  {
+    std::vector<vtkIdType> passedCells;
+    passedCells.reserve(check.NumberOfPassedCells);
+    for (i = 0; i < numCells; ++i)
+    {
+      if (GetNumberOfFaces(grid.Types[i]) == 0 &&
+          grid.Types[i] != VTK_EMPTY_CELL)
+      {
+        passedCells.push_back(i);
+      }
+    }
+    for (int pass = 0; pass < 3; ++pass)
+    {
+      for (i = 0; i < check.NumberOfPassedCells; ++i)
+      {
+        vtkIdType cellId = passedCells[i];
+        int cellType = grid.Types[cellId];
+        const vtkIdType *cell = grid.GetCell(cellId);
+        vtkIdType npts = cell[0];
+        const vtkIdType *pts = cell + 1;
+        if (pass == 0 && (cellType == VTK_VERTEX ||
+                          cellType == VTK_POLY_VERTEX))
+        {
+          numbering.InsertCell(newVerts.Get(), npts, pts);
+          cellSources.push_back(cellId);
+        }
+        else if (pass == 1 && (cellType == VTK_LINE ||
+                               cellType == VTK_POLY_LINE))
+        {
+          numbering.InsertCell(newLines.Get(), npts, pts);
+          cellSources.push_back(cellId);
+        }
+        else if (pass == 2 && cellType == VTK_PIXEL)
+        {
+          vtkIdType quad[4] = {pts[0], pts[1], pts[3], pts[2]};
+          numbering.InsertCell(newPolys.Get(), 4, quad);
+          cellSources.push_back(cellId);
+        }
+        else if (pass == 2 && cellType == VTK_TRIANGLE_STRIP)
+        {
+          // Change strips to triangles, like the serial extraction.
+          if (npts > 1)
+          {
+            int toggle = 0;
+            vtkIdType tri[3];
+            tri[0] = numbering(pts[0]);
+            tri[1] = numbering(pts[1]);
+            for (vtkIdType j = 2; j < npts; ++j)
+            {
+              tri[2] = numbering(pts[j]);
+              newPolys->InsertNextCell(3, tri);
+              cellSources.push_back(cellId);
+              tri[toggle] = tri[2];
+              toggle = !toggle;
+            }
+          }
+        }
+        else if (pass == 2 && (cellType == VTK_TRIANGLE ||
+                               cellType == VTK_QUAD ||
+                               cellType == VTK_POLYGON))
+        {
+          numbering.InsertCell(newPolys.Get(), npts, pts);
+          cellSources.push_back(cellId);
+        }
+      }
+    }
+  }
+
+  // The faces use their points in order. The hidden faces still number
+  // their points, like in the serial extraction.
+  vtkIdType pts[6];
+  for (i = 0; i < numSurfaceFaces; ++i)
+  {
+    int numFacePts = grid.GetFace(surfaceFaces[i], pts);
+    for (int j = 0; j < numFacePts; ++j)
+    {
+      numbering(pts[j]);
+    }
+  }
+
+  // Emit the faces at the locations given by the prefix sums of their sizes.
+  vtkIdType numPassedCells = static_cast<vtkIdType>(cellSources.size());
+  vtkIdType numPolys = newPolys->GetNumberOfCells();
+  vtkIdType passedPolysSize = newPolys->GetNumberOfConnectivityEntries();
+  vtkNew<vtkIdTypeArray> polys;
+  if (numSurfaceFaces > 0)
+  {
+    vtkUnsignedCharArray *ghosts = input->GetPointGhostArray();
+    std::vector<vtkIdType> sizes(numSurfaceFaces);
+    std::vector<vtkIdType> polyLocations(numSurfaceFaces);
+    std::vector<vtkIdType> cellIds(numSurfaceFaces);
+    SizeSurfaceFaces size(grid, &surfaceFaces[0],
+                          ghosts ? ghosts->GetPointer(0) : NULL,
+                          &sizes[0], &cellIds[0]);
+    vtkSMPTools::For(0, numSurfaceFaces, size);
+    vtkIdType polysSize = vtkSMPTools::ExclusiveScan(
+      sizes.begin(), sizes.end(), polyLocations.begin(), passedPolysSize);
+    vtkIdType numCellsOut = vtkSMPTools::ExclusiveScan(
+      cellIds.begin(), cellIds.end(), cellIds.begin(), numPassedCells);
+    numPolys += numCellsOut - numPassedCells;
+
+    polys->SetNumberOfValues(polysSize);
+    if (passedPolysSize > 0)
+    {
+      std::copy(newPolys->GetPointer(), newPolys->GetPointer() + passedPolysSize,
+                polys->GetPointer(0));
+    }
+    cellSources.resize(numCellsOut);
+    EmitSurfaceFaces emit(grid, &surfaceFaces[0], &numbering.Map[0],
+                          &sizes[0], &polyLocations[0], &cellIds[0],
+                          polys->GetPointer(0), &cellSources[0]);
+    vtkSMPTools::For(0, numSurfaceFaces, emit);
+    newPolys->SetCells(numPolys, polys.Get());
+  }
+  this->UpdateProgress(0.8);
+
+  // Copy the points and the attributes.
+  vtkPointData *inputPD = input->GetPointData();
+  vtkCellData *inputCD = input->GetCellData();
+  vtkPointData *outputPD = output->GetPointData();
+  vtkCellData *outputCD = output->GetCellData();
+  output->GetFieldData()->ShallowCopy(input->GetFieldData());
+
+  vtkIdType numOutPts = static_cast<vtkIdType>(numbering.Sources.size());
+  vtkNew<vtkIdList> srcIds;
+  vtkNew<vtkIdList> dstIds;
+  SetIds(srcIds.Get(), numbering.Sources);
+  SetRange(dstIds.Get(), numOutPts);
+  vtkNew<vtkPoints> newPts;
+  newPts->SetDataType(input->GetPoints()->GetDataType());
+  newPts->InsertPoints(dstIds.Get(), srcIds.Get(), input->GetPoints());
+  outputPD->CopyGlobalIdsOn();
+  outputPD->CopyAllocate(inputPD, numOutPts);
+  outputPD->CopyData(inputPD, srcIds.Get(), dstIds.Get());
+  if (this->PassThroughPointIds)
+  {
+    vtkNew<vtkIdTypeArray> originalPointIds;
+    originalPointIds->SetName(this->GetOriginalPointIdsName());
+    originalPointIds->SetNumberOfComponents(1);
+    originalPointIds->SetNumberOfTuples(numOutPts);
+    std::copy(numbering.Sources.begin(), numbering.Sources.end(),
+              originalPointIds->GetPointer(0));
+    outputPD->AddArray(originalPointIds.Get());
+  }
+
+  vtkIdType numOutCells = static_cast<vtkIdType>(cellSources.size());
+  SetIds(srcIds.Get(), cellSources);
+  SetRange(dstIds.Get(), numOutCells);
+  outputCD->CopyGlobalIdsOn();
+  outputCD->CopyAllocate(inputCD, numOutCells);
+  outputCD->CopyData(inputCD, srcIds.Get(), dstIds.Get());
+  if (this->PassThroughCellIds)
+  {
+    vtkNew<vtkIdTypeArray> originalCellIds;
+    originalCellIds->SetName(this->GetOriginalCellIdsName());
+    originalCellIds->SetNumberOfComponents(1);
+    originalCellIds->SetNumberOfTuples(numOutCells);
+    std::copy(cellSources.begin(), cellSources.end(),
+              originalCellIds->GetPointer(0));
+    outputCD->AddArray(originalCellIds.Get());
+  }
+
+  output->SetPoints(newPts.Get());
+  output->SetPolys(newPolys.Get());
+  if (newVerts->GetNumberOfCells() > 0)
+  {
+    output->SetVerts(newVerts.Get());
+  }
+  if (newLines->GetNumberOfCells() > 0)
+  {
+    output->SetLines(newLines.Get());
+  }
+
+  return 1;
+}
+
 //----------------------------------------------------------------------------
 void vtkDataSetSurfaceFilter::InitializeQuadHash(vtkIdType numPoints)
 {
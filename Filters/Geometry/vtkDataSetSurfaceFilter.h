@@ -21,6 +21,13 @@
  * vtkGeometryFilter.  It only has one option: whether to use triangle strips
  * when the input type is structured.
  *
+ * When EnableSMP is on, the external faces of unstructured grids made of
+ * linear cells are found in parallel (via vtkSMPTools). Instead of inserting
+ * every face in the face hash, the faces are sorted by their smallest point
+ * id, and those used by a single cell are emitted. The output is the same as
+ * without the flag. Grids with other cells (e.g. nonlinear cells or
+ * polyhedra) are processed serially.
+ *
  * @sa
  * vtkGeometryFilter vtkStructuredGridGeometryFilter.
 */
@@ -35,6 +42,7 @@ class vtkPointData;
 class vtkPoints;
 class vtkIdTypeArray;
 class vtkStructuredGrid;
+class vtkUnstructuredGrid;
 
 // Helper structure for hashing faces.
 struct vtkFastGeomQuadStruct
@@ -128,6 +136,16 @@ public:
   vtkGetMacro(NonlinearSubdivisionLevel, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded extraction of the faces of unstructured
+   * grids (see the class documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
   //@{
   /**
    * Direct access methods that can be used to use the this class as an
@@ -150,6 +168,14 @@ public:
 #endif
   virtual int UnstructuredGridExecute(vtkDataSet *input,
                                       vtkPolyData *output);
+  /**
+   * Threaded extraction of the surface of an unstructured grid, used by
+   * UnstructuredGridExecute() when EnableSMP is on. Returns 0, without
+   * touching the output, if the grid has cells that are only handled by
+   * the serial extraction.
+   */
+  virtual int UnstructuredGridExecuteSMP(vtkUnstructuredGrid *input,
+                                         vtkPolyData *output);
   virtual int DataSetExecute(vtkDataSet *input, vtkPolyData *output);
   virtual int StructuredWithBlankingExecute(vtkStructuredGrid *input, vtkPolyData *output);
   virtual int UniformGridExecute(
@@ -266,6 +292,8 @@ protected:
 
   int NonlinearSubdivisionLevel;
 
+  int EnableSMP;
+
 private:
   vtkDataSetSurfaceFilter(const vtkDataSetSurfaceFilter&) VTK_DELETE_FUNCTION;
   void operator=(const vtkDataSetSurfaceFilter&) VTK_DELETE_FUNCTION;
@@ -0,0 +1,129 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkMappedFile.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkMappedFile.h"
+#include "vtkObjectFactory.h"
+
+#if defined(_WIN32)
+# include "vtkWindows.h"
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkMappedFile);
+
+//----------------------------------------------------------------------------
+vtkMappedFile::vtkMappedFile()
+{
+  this->Data = 0;
+  this->Size = 0;
+}
+
+//----------------------------------------------------------------------------
+vtkMappedFile::~vtkMappedFile()
+{
+  this->Unmap();
+}
+
+//----------------------------------------------------------------------------
+int vtkMappedFile::Map(const char* fileName)
+{
+  this->Unmap();
+  if(!fileName)
+  {
+    return 0;
+  }
+
+  // The file and mapping handles can be closed once the view exists.
+  void* data = 0;
+  size_t size = 0;
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, 0,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+  if(file == INVALID_HANDLE_VALUE)
+  {
+    return 0;
+  }
+  LARGE_INTEGER fileSize;
+  if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 &&
+     static_cast<vtkTypeUInt64>(fileSize.QuadPart) <=
+     static_cast<vtkTypeUInt64>(static_cast<size_t>(-1)))
+  {
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    if(mapping)
+    {
+      data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+      size = static_cast<size_t>(fileSize.QuadPart);
+      CloseHandle(mapping);
+    }
+  }
+  CloseHandle(file);
+#else
+  int file = open(fileName, O_RDONLY);
+  if(file < 0)
+  {
+    return 0;
+  }
+  struct stat info;
+  if(fstat(file, &info) == 0 && info.st_size > 0 &&
+     static_cast<vtkTypeUInt64>(info.st_size) <=
+     static_cast<vtkTypeUInt64>(static_cast<size_t>(-1)))
+  {
+    size = static_cast<size_t>(info.st_size);
+    data = mmap(0, size, PROT_READ, MAP_PRIVATE, file, 0);
+    if(data == MAP_FAILED)
+    {
+      data = 0;
+    }
+  }
+  close(file);
+#endif
+  if(!data)
+  {
+    return 0;
+  }
+
+  this->Data = static_cast<const unsigned char*>(data);
+  this->Size = size;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkMappedFile::Unmap()
+{
+  if(!this->Data)
+  {
+    return;
+  }
+  void* data = const_cast<unsigned char*>(this->Data);
+#if defined(_WIN32)
+  UnmapViewOfFile(data);
+#else
+  munmap(data, this->Size);
+#endif
+  this->Data = 0;
+  this->Size = 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkMappedFile::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Data: " << static_cast<const void*>(this->Data) << "\n";
+  os << indent << "Size: " << this->Size << "\n";
+}
@@ -0,0 +1,72 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkMappedFile.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkMappedFile
+ * @brief   read-only memory mapping of a whole file
+ *
+ * vtkMappedFile maps a whole file in memory for reading, with mmap or
+ * MapViewOfFile, so that readers can parse or copy its contents from
+ * several threads without going through a stream.  The mapping is released
+ * by Unmap, by mapping another file or when the object is deleted.
+*/
+
+#ifndef vtkMappedFile_h
+#define vtkMappedFile_h
+
+#include "vtkIOCoreModule.h" // For export macro
+#include "vtkObject.h"
+
+class VTKIOCORE_EXPORT vtkMappedFile : public vtkObject
+{
+public:
+  static vtkMappedFile *New();
+  vtkTypeMacro(vtkMappedFile,vtkObject);
+  void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
+
+  /**
+   * Map the given file, releasing the previous mapping if any.  Returns 1
+   * for success, 0 if the file could not be opened or mapped, which is the
+   * case of empty files and of files larger than the address space.
+   */
+  int Map(const char* fileName);
+
+  /**
+   * Release the mapping, if any.
+   */
+  void Unmap();
+
+  /**
+   * Get the mapped contents of the file, or NULL if no file is mapped.
+   */
+  const unsigned char* GetData() { return this->Data; }
+
+  /**
+   * Get the size in bytes of the mapped file, or 0 if no file is mapped.
+   */
+  size_t GetSize() { return this->Size; }
+
+protected:
+  vtkMappedFile();
+  ~vtkMappedFile() VTK_OVERRIDE;
+
+  const unsigned char* Data;
+  size_t Size;
+
+private:
+  vtkMappedFile(const vtkMappedFile&) VTK_DELETE_FUNCTION;
+  void operator=(const vtkMappedFile&) VTK_DELETE_FUNCTION;
+};
+
+#endif
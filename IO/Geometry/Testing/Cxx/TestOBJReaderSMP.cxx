@@ -0,0 +1,228 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestOBJReaderSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded parsing of vtkOBJReader reads the same data as
+// the serial one, with matching and different indices for the points,
+// texture coordinates and normals, negative indices, materials and
+// continuation lines, and that both fail on the same files.
+
+#include "vtkCellArray.h"
+#include "vtkDataArray.h"
+#include "vtkNew.h"
+#include "vtkOBJReader.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkTestUtilities.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+namespace
+{
+void WriteVertices(std::ostream &os, vtkPolyData *sphere)
+{
+  vtkDataArray *normals = sphere->GetPointData()->GetNormals();
+  for (vtkIdType i = 0; i < sphere->GetNumberOfPoints(); ++i)
+  {
+    double x[3];
+    sphere->GetPoint(i, x);
+    double *n = normals->GetTuple3(i);
+    os << "v " << x[0] << " " << x[1] << " " << x[2] << "\n"
+       << "vn " << n[0] << "\t" << n[1] << " " << n[2] << "\n"
+       << "vt " << 0.5 * x[0] + 0.5 << " " << 0.5 * x[1] + 0.5 << "\n";
+  }
+}
+
+// A sphere whose faces use the same indices for their points, texture
+// coordinates and normals, with a few negative indices, points and a
+// polyline continued on several lines.
+std::string MakeMatchingFile(vtkPolyData *sphere)
+{
+  std::ostringstream os;
+  os.precision(9);
+  os << "# matching indices\nmtllib sphere.mtl\no sphere\n";
+  WriteVertices(os, sphere);
+  vtkIdType numPts = sphere->GetNumberOfPoints();
+  vtkCellArray *polys = sphere->GetPolys();
+  vtkIdType npts, *pts;
+  polys->InitTraversal();
+  for (vtkIdType i = 0; polys->GetNextCell(npts, pts); ++i)
+  {
+    os << (i % 5 == 0 ? "  f" : "f");
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      vtkIdType id = i % 7 == 0 ? pts[j] - numPts : pts[j] + 1;
+      os << " " << id << "/" << id << "/" << id;
+    }
+    os << (i % 11 == 0 ? " \r\n" : "\n");
+  }
+  os << "p 1 -1 2\n"
+        "l 1 2 3 \\\n"
+        "4 5\\\n"
+        "6 \\\n"
+        " 7 8\n"
+        "p 3";
+  return os.str();
+}
+
+// A sphere whose faces use other texture coordinates and normals, some
+// faces without them, and texture coordinates of several materials.
+std::string MakeDuplicatingFile(vtkPolyData *sphere)
+{
+  std::ostringstream os;
+  os.precision(9);
+  WriteVertices(os, sphere);
+  os << "vt 0.25 0.75\n"
+        "usemtl first\n"
+        "vt 0.5 0.5\n"
+        "vt 0.125 0.5\n"
+        "usemtl second\n"
+        "usemtl third\n"
+        "vt 1 0\n"
+        "usemtl second\n"
+        "vt 0 1\n"
+        "usemtl fourth\n"
+        "g group\n";
+  vtkIdType numPts = sphere->GetNumberOfPoints();
+  vtkCellArray *polys = sphere->GetPolys();
+  vtkIdType npts, *pts;
+  polys->InitTraversal();
+  for (vtkIdType i = 0; polys->GetNextCell(npts, pts); ++i)
+  {
+    os << "f";
+    for (vtkIdType j = 0; j < npts; ++j)
+    {
+      vtkIdType id = pts[j] + 1;
+      if (i % 13 == 0)
+      {
+        os << " " << id;
+      }
+      else if (i % 2 == 0)
+      {
+        os << " " << id << "//" << numPts - id + 1;
+      }
+      else
+      {
+        os << " " << id << "/" << -1 - (i + j) % 5 << "/" << -id;
+      }
+    }
+    os << "\n";
+  }
+  os << "l 1 2\n";
+  return os.str();
+}
+
+vtkSmartPointer<vtkPolyData> Read(const std::string &fileName,
+                                  int enableSMP)
+{
+  vtkNew<vtkOBJReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->SetEnableSMP(enableSMP);
+  reader->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(reader->GetOutput());
+  return output;
+}
+
+// Check the file with the number of points read, or with some points if
+// expectedPoints is negative.
+bool CheckFile(const std::string &fileName, const std::string &text,
+               vtkIdType expectedPoints)
+{
+  FILE *file = fopen(fileName.c_str(), "wb");
+  if (!file)
+  {
+    cerr << "Could not write " << fileName << endl;
+    return false;
+  }
+  fwrite(text.c_str(), 1, text.size(), file);
+  fclose(file);
+
+  vtkSmartPointer<vtkPolyData> serial = Read(fileName, 0);
+  vtkSmartPointer<vtkPolyData> threaded = Read(fileName, 1);
+  if (expectedPoints >= 0 ? serial->GetNumberOfPoints() != expectedPoints :
+      serial->GetNumberOfPoints() == 0)
+  {
+    cerr << "Expected " << expectedPoints << " points but got "
+         << serial->GetNumberOfPoints() << endl;
+    return false;
+  }
+  return vtkTestDataSetUtilities::SameDataSets(serial, threaded);
+}
+}
+
+int TestOBJReaderSMP(int argc, char *argv[])
+{
+  char* temp_dir_c =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv,
+                                           "VTK_TEMP_DIR",
+                                           "Testing/Temporary");
+  std::string temp_dir = std::string(temp_dir_c);
+  delete [] temp_dir_c;
+
+  if (temp_dir.empty())
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string fileName = temp_dir + "/TestOBJReaderSMP.obj";
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(200);
+  sphere->SetPhiResolution(200);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+  vtkIdType numPts = input->GetNumberOfPoints();
+
+  if (!CheckFile(fileName, MakeMatchingFile(input), numPts))
+  {
+    cerr << "The threaded parsing differs for matching indices" << endl;
+    return EXIT_FAILURE;
+  }
+  if (!CheckFile(fileName, MakeDuplicatingFile(input), -1))
+  {
+    cerr << "The threaded parsing differs for duplicated points" << endl;
+    return EXIT_FAILURE;
+  }
+
+  // Relative indices interleaved with the vertices.
+  std::string relative =
+    "v 0 0 0\nvt 0 0\nv 1 0 0\nvt 1 0\nv 0 1 0\nvt 0 1\n"
+    "f -3/-3 -2/-2 -1/-1\n"
+    "v 1 1 0\nvt 1 1\nf 2/2 -1/-1 3/3\n"
+    "usemtl last\n";
+  const char *invalid[5] = {
+    "v 0 0\n", "v 0 0 0\nv 1 0 0\nf 1 2\n", "v 0 0 0\nf 1 \\\n",
+    "v 0 0 0\nf 1 a 1\n", "v 0 0 0\np 1\nusemtl\n"};
+  vtkObject::GlobalWarningDisplayOff();
+  bool ok = CheckFile(fileName, relative, 0) &&
+    CheckFile(fileName, relative + "\nvt 0.5 0.5\n", 4);
+  for (int i = 0; ok && i < 5; ++i)
+  {
+    ok = CheckFile(fileName, invalid[i], 0);
+  }
+  vtkObject::GlobalWarningDisplayOn();
+  if (!ok)
+  {
+    cerr << "The threaded parsing differs for small files" << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestSTLReaderSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded reading and merging of vtkSTLReader produce the
+// same output as the serial ones, for binary and ascii files.
+
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkSTLReader.h"
+#include "vtkSTLWriter.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkTestUtilities.h"
+
+#include <fstream>
+#include <string>
+
+namespace
+{
+// Two solids, with a negative zero, a duplicate triangle and a degenerate
+// one.
+const char *MultipleSolids =
+  "solid first\n"
+  " facet normal 0 0 1\n"
+  "  outer loop\n"
+  "   vertex 0 0 0\n"
+  "   vertex 1 0 0\n"
+  "   vertex 1 1 0\n"
+  "  endloop\n"
+  " endfacet\n"
+  " facet normal 0 0 1\n"
+  "  outer loop\n"
+  "   vertex -0 0 0\n"
+  "   vertex 1 1 0\n"
+  "   vertex 0 1 -0.0\n"
+  "  endloop\n"
+  " endfacet\n"
+  "endsolid first\n"
+  "SOLID second\n"
+  "COLOR 0.5 0.5 0.5\n"
+  " FACET NORMAL 0 0 1\n"
+  "  OUTER LOOP\n"
+  "   VERTEX 0 0 0\n"
+  "   VERTEX 1 0 0\n"
+  "   VERTEX 1 1 0\n"
+  "  ENDLOOP\n"
+  " ENDFACET\n"
+  " FACET NORMAL 0 0 1\n"
+  "  OUTER LOOP\n"
+  "   VERTEX 2 0 0\n"
+  "   VERTEX 2.0 0 0\n"
+  "   VERTEX 3e0 1 0\n"
+  "  ENDLOOP\n"
+  " ENDFACET\n"
+  " FACET NORMAL 0 0 1\n"
+  "  OUTER LOOP\n"
+  "   VERTEX 1 1 0\n"
+  "   VERTEX 2 0 0\n"
+  "   VERTEX 3 1 0\n"
+  "  ENDLOOP\n"
+  " ENDFACET\n"
+  "ENDSOLID second\n";
+
+bool CheckRead(const std::string &fileName, vtkIdType numPts,
+               vtkIdType numTris)
+{
+  for (int merging = 0; merging < 2; ++merging)
+  {
+    vtkNew<vtkSTLReader> serial;
+    vtkNew<vtkSTLReader> threaded;
+    vtkSTLReader *readers[2] = {serial.Get(), threaded.Get()};
+    for (int i = 0; i < 2; ++i)
+    {
+      readers[i]->SetFileName(fileName.c_str());
+      readers[i]->SetMerging(merging);
+      readers[i]->ScalarTagsOn();
+      readers[i]->SetEnableSMP(i);
+      readers[i]->Update();
+    }
+    vtkPolyData *output = serial->GetOutput();
+    vtkPolyData *threadedOutput = threaded->GetOutput();
+    if (merging && (output->GetNumberOfPoints() != numPts ||
+                    output->GetNumberOfPolys() != numTris))
+    {
+      cerr << "Expected " << numPts << " points and " << numTris
+           << " triangles in " << fileName << " but got "
+           << output->GetNumberOfPoints() << " points and "
+           << output->GetNumberOfPolys() << " triangles" << endl;
+      return false;
+    }
+    if (!vtkTestDataSetUtilities::SameDataSets(output, threadedOutput))
+    {
+      cerr << "The threaded reading of " << fileName
+           << " differs with merging " << merging << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestSTLReaderSMP(int argc, char *argv[])
+{
+  char* temp_dir_c =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv,
+                                           "VTK_TEMP_DIR",
+                                           "Testing/Temporary");
+  std::string temp_dir = std::string(temp_dir_c);
+  delete [] temp_dir_c;
+
+  if (temp_dir.empty())
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // A sphere large enough to span several blocks of facets and several
+  // pieces of ascii text.
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(400);
+  sphere->SetPhiResolution(400);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+
+  for (int fileType = VTK_ASCII; fileType <= VTK_BINARY; ++fileType)
+  {
+    std::string fileName = temp_dir + "/TestSTLReaderSMP.stl";
+    vtkNew<vtkSTLWriter> writer;
+    writer->SetInputData(input);
+    writer->SetFileName(fileName.c_str());
+    writer->SetFileType(fileType);
+    writer->Write();
+    if (!CheckRead(fileName, input->GetNumberOfPoints(),
+                   input->GetNumberOfPolys()))
+    {
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::string fileName = temp_dir + "/TestSTLReaderSMPSolids.stl";
+  {
+    std::ofstream file(fileName.c_str());
+    file << MultipleSolids;
+  }
+  if (!CheckRead(fileName, 6, 4))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
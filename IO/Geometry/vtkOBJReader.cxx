@@ -16,12 +16,24 @@
 
 #include "vtkCellArray.h"
 #include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
+#include "vtkMappedFile.h"
+#include "vtkNew.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
+
+#include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
 
 vtkStandardNewMacro(vtkOBJReader);
 
@@ -30,6 +42,7 @@ vtkStandardNewMacro(vtkOBJReader);
 vtkOBJReader::vtkOBJReader()
 {
   this->FileName = NULL;
+  this->EnableSMP = 0;
 
   this->SetNumberOfInputPorts(0);
 }
@@ -40,6 +53,16 @@ vtkOBJReader::~vtkOBJReader()
   this->FileName = NULL;
 }
 
+namespace
+{
+// Turn an OBJ index, 1-based or negative to count back from the end of the
+// n items read so far, into a 0-based id.
+inline vtkIdType vtkOBJResolveIndex(int index, vtkIdType n)
+{
+  return index < 0 ? n + index : index - 1;
+}
+}
+
 /*---------------------------------------------------------------------------*\
 
 This is only partial support for the OBJ format, which is quite complicated.
@@ -124,6 +147,18 @@ int vtkOBJReader::RequestData(
     return 0;
   }
 
+  if (this->EnableSMP)
+  {
+    vtkNew<vtkMappedFile> file;
+    if (file->Map(this->FileName))
+    {
+      fclose(in);
+      this->ReadOBJSMP(reinterpret_cast<const char*>(file->GetData()),
+                       file->GetSize(), output);
+      return 1;
+    }
+  }
+
   vtkDebugMacro(<<"Reading file");
 
   // intialise some structures to store the file contents in
@@ -486,56 +521,44 @@ int vtkOBJReader::RequestData(
         if (pLine < pEnd)         // there is still data left on this line
         {
           int iVert,iTCoord,iNormal;
+          vtkIdType numTCoords = tcoords_vector[0]->GetNumberOfTuples();
+          vtkIdType numNormals = normals->GetNumberOfTuples();
           if (sscanf(pLine, "%d/%d/%d", &iVert, &iTCoord, &iNormal) == 3)
           {
-            if (iVert < 0)
-            {
-              polys->InsertCellPoint(numPoints+iVert);
-            }
-            else
-            {
-              polys->InsertCellPoint(iVert-1);
-            }
+            vtkIdType vertId = vtkOBJResolveIndex(iVert, numPoints);
+            vtkIdType tcoordId = vtkOBJResolveIndex(iTCoord, numTCoords);
+            vtkIdType normalId = vtkOBJResolveIndex(iNormal, numNormals);
+            polys->InsertCellPoint(vertId);
             nVerts++;
-            tcoord_polys->InsertCellPoint(iTCoord-1);
+            tcoord_polys->InsertCellPoint(tcoordId);
             nTCoords++;
-            normal_polys->InsertCellPoint(iNormal-1);
+            normal_polys->InsertCellPoint(normalId);
             nNormals++;
-            if (iTCoord != iVert)
+            if (tcoordId != vertId)
               tcoords_same_as_verts = false;
-            if (iNormal != iVert)
+            if (normalId != vertId)
               normals_same_as_verts = false;
           }
           else if (sscanf(pLine, "%d//%d", &iVert, &iNormal) == 2)
           {
-            if (iVert < 0)
-            {
-              polys->InsertCellPoint(numPoints+iVert);
-            }
-            else
-            {
-              polys->InsertCellPoint(iVert-1);
-            }
+            vtkIdType vertId = vtkOBJResolveIndex(iVert, numPoints);
+            vtkIdType normalId = vtkOBJResolveIndex(iNormal, numNormals);
+            polys->InsertCellPoint(vertId);
             nVerts++;
-            normal_polys->InsertCellPoint(iNormal-1);
+            normal_polys->InsertCellPoint(normalId);
             nNormals++;
-            if (iNormal != iVert)
+            if (normalId != vertId)
               normals_same_as_verts = false;
           }
           else if (sscanf(pLine, "%d/%d", &iVert, &iTCoord) == 2)
           {
-            if (iVert < 0)
-            {
-              polys->InsertCellPoint(numPoints+iVert);
-            }
-            else
-            {
-              polys->InsertCellPoint(iVert-1);
-            }
+            vtkIdType vertId = vtkOBJResolveIndex(iVert, numPoints);
+            vtkIdType tcoordId = vtkOBJResolveIndex(iTCoord, numTCoords);
+            polys->InsertCellPoint(vertId);
             nVerts++;
-            tcoord_polys->InsertCellPoint(iTCoord-1);
+            tcoord_polys->InsertCellPoint(tcoordId);
             nTCoords++;
-            if (iTCoord != iVert)
+            if (tcoordId != vertId)
               tcoords_same_as_verts = false;
           }
           else if (sscanf(pLine, "%d", &iVert) == 1)
@@ -795,12 +818,1068 @@ int vtkOBJReader::RequestData(
 }
 
 
+namespace
+{
+enum vtkOBJCellKind
+{
+  VTK_OBJ_VERTS,
+  VTK_OBJ_LINES,
+  VTK_OBJ_POLYS,
+  VTK_OBJ_TCOORD_POLYS,
+  VTK_OBJ_NORMAL_POLYS,
+  VTK_OBJ_NUMBER_OF_CELL_KINDS
+};
+
+enum vtkOBJError
+{
+  VTK_OBJ_READ_ERROR,
+  VTK_OBJ_CONTINUATION_ERROR,
+  VTK_OBJ_CELL_ERROR
+};
+
+inline bool vtkOBJIsBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool vtkOBJIsSpace(char c)
+{
+  return c == '\n' || vtkOBJIsBlank(c);
+}
+
+// Whether the word [begin, end) is command.
+bool vtkOBJIsCommand(const char *begin, const char *end, const char *command)
+{
+  for (; begin < end && *command; ++begin, ++command)
+  {
+    if (*begin != *command)
+    {
+      return false;
+    }
+  }
+  return begin == end && *command == 0;
+}
+
+// Whether a piece of the file can end at pos: after a line end that does
+// not continue the line.
+inline bool vtkOBJIsPieceEnd(const char *data, size_t pos)
+{
+  return pos > 0 && data[pos - 1] == '\n' && (pos < 2 || data[pos - 2] != '\\');
+}
+
+// Parse a decimal integer like sscanf's "%d" does, without skipping spaces.
+bool vtkOBJParseInt(const char *&p, int &value)
+{
+  const char *q = p;
+  bool negative = *q == '-';
+  if (*q == '-' || *q == '+')
+  {
+    ++q;
+  }
+  if (*q < '0' || *q > '9')
+  {
+    return false;
+  }
+  unsigned int result = 0;
+  for (; *q >= '0' && *q <= '9'; ++q)
+  {
+    result = 10 * result + static_cast<unsigned int>(*q - '0');
+  }
+  value = static_cast<int>(negative ? 0u - result : result);
+  p = q;
+  return true;
+}
+
+struct vtkOBJMaterial
+{
+  std::string Name;
+  vtkIdType Line;
+  bool NextLineIsTCoords;
+};
+
+// The cells of one kind read from a piece of the file: the number of ids of
+// each cell followed by the ids.  Negative indices can refer to items of
+// earlier pieces, so their ids are relative to the start of the piece, and
+// the offset of the piece is added to them when they are copied.
+struct vtkOBJCells
+{
+  std::vector<vtkIdType> Ids;
+  std::vector<size_t> RelativeIds;
+  vtkIdType NumberOfCells;
+
+  void Clear()
+  {
+    this->Ids.clear();
+    this->RelativeIds.clear();
+    this->NumberOfCells = 0;
+  }
+
+  // Start a cell, and return the position of its number of ids.
+  size_t InsertNextCell()
+  {
+    ++this->NumberOfCells;
+    this->Ids.push_back(0);
+    return this->Ids.size() - 1;
+  }
+
+  void InsertCellPoint(int index, vtkIdType n)
+  {
+    if (index < 0)
+    {
+      this->RelativeIds.push_back(this->Ids.size());
+    }
+    this->Ids.push_back(vtkOBJResolveIndex(index, n));
+  }
+
+  void CopyTo(vtkIdType *ids, vtkIdType offset) const
+  {
+    if (!this->Ids.empty())
+    {
+      memcpy(ids, &this->Ids[0], this->Ids.size() * sizeof(vtkIdType));
+    }
+    for (size_t i = 0; i < this->RelativeIds.size(); ++i)
+    {
+      ids[this->RelativeIds[i]] += offset;
+    }
+  }
+};
+
+// A piece of the file made of whole lines, parsed like the serial parsing
+// does, and where its data go in the output.
+struct vtkOBJPiece
+{
+  const char *Begin;
+  const char *End;
+
+  std::vector<float> Points;
+  std::vector<float> TCoords;
+  std::vector<float> Normals;
+  // For each texture coordinate, the last material of the piece before it,
+  // or -1.
+  std::vector<int> TCoordMaterials;
+  std::vector<vtkOBJMaterial> Materials;
+  vtkOBJCells Cells[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+  bool HasTCoords;
+  bool HasNormals;
+  bool FirstLineIsTCoords;
+  // Whether the last line is a usemtl line, whose next line is in a later
+  // piece.
+  bool LastLineIsMaterial;
+  vtkIdType NumberOfLines;
+  // The line of the first error in the piece, or -1.
+  vtkIdType ErrorLine;
+  vtkOBJError Error;
+  const char *ErrorCommand;
+
+  vtkIdType PointOffset;
+  vtkIdType TCoordOffset;
+  vtkIdType NormalOffset;
+  vtkIdType CellOffsets[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+  int MaterialOffset;
+  int PreviousMaterial;
+  bool TCoordsSameAsVerts;
+  bool NormalsSameAsVerts;
+
+  void SetError(vtkOBJError error, const char *command)
+  {
+    this->ErrorLine = this->NumberOfLines;
+    this->Error = error;
+    this->ErrorCommand = command;
+  }
+
+  void SkipBlanks(const char *&p) const
+  {
+    while (p < this->End && vtkOBJIsBlank(*p))
+    {
+      ++p;
+    }
+  }
+
+  // Parse n floats of the current line like sscanf's "%f" does.  The
+  // pieces end with a line end, which stops strtof.
+  bool ParseFloats(const char *&p, int n, std::vector<float> &values) const
+  {
+    for (int i = 0; i < n; ++i)
+    {
+      this->SkipBlanks(p);
+      if (p >= this->End || *p == '\n')
+      {
+        return false;
+      }
+      char *next = NULL;
+      float x = strtof(p, &next);
+      if (next == p)
+      {
+        return false;
+      }
+      values.push_back(x);
+      p = next;
+    }
+    return true;
+  }
+
+  // Parse the indices of a 'p', 'l' or 'f' line and of its continuation
+  // lines.
+  void ParseCell(const char *&p, const char *command)
+  {
+    vtkOBJCells &cells = this->Cells[command[0] == 'p' ? VTK_OBJ_VERTS :
+      command[0] == 'l' ? VTK_OBJ_LINES : VTK_OBJ_POLYS];
+    vtkOBJCells &tcoordCells = this->Cells[VTK_OBJ_TCOORD_POLYS];
+    vtkOBJCells &normalCells = this->Cells[VTK_OBJ_NORMAL_POLYS];
+    bool isFace = command[0] == 'f';
+    size_t cell = cells.InsertNextCell();
+    size_t tcoordCell = isFace ? tcoordCells.InsertNextCell() : 0;
+    size_t normalCell = isFace ? normalCells.InsertNextCell() : 0;
+    vtkIdType numPts = static_cast<vtkIdType>(this->Points.size() / 3);
+    vtkIdType numTCoords = static_cast<vtkIdType>(this->TCoords.size() / 2);
+    vtkIdType numNormals = static_cast<vtkIdType>(this->Normals.size() / 3);
+    vtkIdType nVerts = 0, nTCoords = 0, nNormals = 0;
+    for (;;)
+    {
+      this->SkipBlanks(p);
+      if (p >= this->End || *p == '\n')
+      {
+        break;
+      }
+      if (*p == '\\' && p + 1 < this->End && p[1] == '\n')
+      {
+        // handle backslash-newline continuation
+        if (p + 2 >= this->End)
+        {
+          this->SetError(VTK_OBJ_CONTINUATION_ERROR, command);
+          return;
+        }
+        p += 2;
+        ++this->NumberOfLines;
+        continue;
+      }
+      int index;
+      if (!vtkOBJParseInt(p, index))
+      {
+        this->SetError(VTK_OBJ_READ_ERROR, command);
+        return;
+      }
+      cells.InsertCellPoint(index, numPts);
+      ++nVerts;
+      // v/t, v/t/n and v//n, where only the vertex index is required
+      if (isFace && *p == '/')
+      {
+        const char *q = p + 1;
+        if (*q == '/')
+        {
+          ++q;
+          if (vtkOBJParseInt(q, index))
+          {
+            normalCells.InsertCellPoint(index, numNormals);
+            ++nNormals;
+          }
+        }
+        else if (vtkOBJParseInt(q, index))
+        {
+          tcoordCells.InsertCellPoint(index, numTCoords);
+          ++nTCoords;
+          if (*q == '/')
+          {
+            ++q;
+            if (vtkOBJParseInt(q, index))
+            {
+              normalCells.InsertCellPoint(index, numNormals);
+              ++nNormals;
+            }
+          }
+        }
+        p = q;
+      }
+      while (p < this->End && !vtkOBJIsSpace(*p))
+      {
+        ++p;
+      }
+    }
+
+    int minVerts = command[0] == 'p' ? 1 : command[0] == 'l' ? 2 : 3;
+    if (nVerts < minVerts ||
+        (nTCoords > 0 && nTCoords != nVerts) ||
+        (nNormals > 0 && nNormals != nVerts))
+    {
+      this->SetError(VTK_OBJ_CELL_ERROR, command);
+      return;
+    }
+    cells.Ids[cell] = nVerts;
+    if (isFace)
+    {
+      tcoordCells.Ids[tcoordCell] = nTCoords;
+      normalCells.Ids[normalCell] = nNormals;
+      this->HasTCoords = this->HasTCoords || nTCoords > 0;
+      this->HasNormals = this->HasNormals || nNormals > 0;
+    }
+  }
+
+  void Parse()
+  {
+    this->Points.clear();
+    this->TCoords.clear();
+    this->Normals.clear();
+    this->TCoordMaterials.clear();
+    this->Materials.clear();
+    for (int k = 0; k < VTK_OBJ_NUMBER_OF_CELL_KINDS; ++k)
+    {
+      this->Cells[k].Clear();
+    }
+    this->HasTCoords = false;
+    this->HasNormals = false;
+    this->FirstLineIsTCoords = false;
+    this->LastLineIsMaterial = false;
+    this->NumberOfLines = 0;
+    this->ErrorLine = -1;
+
+    int material = -1;
+    bool afterMaterial = false;
+    const char *p = this->Begin;
+    while (p < this->End)
+    {
+      // the first word of the line is the command
+      this->SkipBlanks(p);
+      const char *cmd = p;
+      while (p < this->End && !vtkOBJIsSpace(*p))
+      {
+        ++p;
+      }
+      bool isTCoords = vtkOBJIsCommand(cmd, p, "vt");
+      if (this->NumberOfLines == 0)
+      {
+        this->FirstLineIsTCoords = isTCoords;
+      }
+      if (afterMaterial)
+      {
+        this->Materials.back().NextLineIsTCoords = isTCoords;
+        afterMaterial = false;
+      }
+
+      if (vtkOBJIsCommand(cmd, p, "v"))
+      {
+        if (!this->ParseFloats(p, 3, this->Points))
+        {
+          this->SetError(VTK_OBJ_READ_ERROR, "v");
+        }
+      }
+      else if (isTCoords)
+      {
+        if (this->ParseFloats(p, 2, this->TCoords))
+        {
+          this->TCoordMaterials.push_back(material);
+        }
+        else
+        {
+          this->SetError(VTK_OBJ_READ_ERROR, "vt");
+        }
+      }
+      else if (vtkOBJIsCommand(cmd, p, "vn"))
+      {
+        if (!this->ParseFloats(p, 3, this->Normals))
+        {
+          this->SetError(VTK_OBJ_READ_ERROR, "vn");
+        }
+      }
+      else if (vtkOBJIsCommand(cmd, p, "usemtl"))
+      {
+        this->SkipBlanks(p);
+        const char *name = p;
+        while (p < this->End && !vtkOBJIsSpace(*p))
+        {
+          ++p;
+        }
+        if (p > name)
+        {
+          vtkOBJMaterial newMaterial;
+          newMaterial.Name.assign(name, p);
+          newMaterial.Line = this->NumberOfLines;
+          newMaterial.NextLineIsTCoords = false;
+          this->Materials.push_back(newMaterial);
+          material = static_cast<int>(this->Materials.size()) - 1;
+          afterMaterial = true;
+        }
+        else
+        {
+          this->SetError(VTK_OBJ_READ_ERROR, "usemtl");
+        }
+      }
+      else if (vtkOBJIsCommand(cmd, p, "p"))
+      {
+        this->ParseCell(p, "p");
+      }
+      else if (vtkOBJIsCommand(cmd, p, "l"))
+      {
+        this->ParseCell(p, "l");
+      }
+      else if (vtkOBJIsCommand(cmd, p, "f"))
+      {
+        this->ParseCell(p, "f");
+      }
+      if (this->ErrorLine >= 0)
+      {
+        return;
+      }
+
+      while (p < this->End && *p != '\n')
+      {
+        ++p;
+      }
+      ++p;
+      ++this->NumberOfLines;
+    }
+    this->LastLineIsMaterial = afterMaterial;
+  }
+};
+
+struct vtkOBJParsePieces
+{
+  vtkOBJPiece *Pieces;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      this->Pieces[i].Parse();
+    }
+  }
+};
+
+// Copy the data of the pieces to their offsets, resolve their negative
+// indices, and check whether their faces use the same indices for their
+// points, texture coordinates and normals.
+struct vtkOBJCopyPieces
+{
+  vtkOBJPiece *Pieces;
+  float *Points;
+  float *TCoords;
+  float *Normals;
+  int *TCoordMaterials;
+  vtkIdType *Cells[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkOBJPiece &piece = this->Pieces[i];
+      if (!piece.Points.empty())
+      {
+        memcpy(this->Points + 3 * piece.PointOffset, &piece.Points[0],
+               piece.Points.size() * sizeof(float));
+      }
+      if (!piece.TCoords.empty())
+      {
+        memcpy(this->TCoords + 2 * piece.TCoordOffset, &piece.TCoords[0],
+               piece.TCoords.size() * sizeof(float));
+      }
+      if (!piece.Normals.empty())
+      {
+        memcpy(this->Normals + 3 * piece.NormalOffset, &piece.Normals[0],
+               piece.Normals.size() * sizeof(float));
+      }
+      for (size_t j = 0; j < piece.TCoordMaterials.size(); ++j)
+      {
+        int material = piece.TCoordMaterials[j];
+        this->TCoordMaterials[piece.TCoordOffset + j] = material < 0 ?
+          piece.PreviousMaterial : piece.MaterialOffset + material;
+      }
+      for (int k = 0; k < VTK_OBJ_NUMBER_OF_CELL_KINDS; ++k)
+      {
+        vtkIdType offset = k == VTK_OBJ_TCOORD_POLYS ? piece.TCoordOffset :
+          k == VTK_OBJ_NORMAL_POLYS ? piece.NormalOffset : piece.PointOffset;
+        piece.Cells[k].CopyTo(this->Cells[k] + piece.CellOffsets[k], offset);
+      }
+
+      piece.TCoordsSameAsVerts = true;
+      piece.NormalsSameAsVerts = true;
+      const vtkIdType *poly =
+        this->Cells[VTK_OBJ_POLYS] + piece.CellOffsets[VTK_OBJ_POLYS];
+      const vtkIdType *tcoordPoly = this->Cells[VTK_OBJ_TCOORD_POLYS] +
+        piece.CellOffsets[VTK_OBJ_TCOORD_POLYS];
+      const vtkIdType *normalPoly = this->Cells[VTK_OBJ_NORMAL_POLYS] +
+        piece.CellOffsets[VTK_OBJ_NORMAL_POLYS];
+      for (vtkIdType j = 0; j < piece.Cells[VTK_OBJ_POLYS].NumberOfCells; ++j)
+      {
+        for (vtkIdType l = 1; l <= *tcoordPoly; ++l)
+        {
+          piece.TCoordsSameAsVerts =
+            piece.TCoordsSameAsVerts && tcoordPoly[l] == poly[l];
+        }
+        for (vtkIdType l = 1; l <= *normalPoly; ++l)
+        {
+          piece.NormalsSameAsVerts =
+            piece.NormalsSameAsVerts && normalPoly[l] == poly[l];
+        }
+        poly += *poly + 1;
+        tcoordPoly += *tcoordPoly + 1;
+        normalPoly += *normalPoly + 1;
+      }
+    }
+  }
+};
+
+// Give every texture coordinate whose material has the name of an array
+// to that array, and (-1,-1) to the other arrays.
+struct vtkOBJFillTCoords
+{
+  const float *Values;
+  const int *Materials;
+  const int *MaterialNames;
+  int InitialName;
+  int ArrayName;
+  float *TCoords;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      int material = this->Materials[i];
+      int name = material < 0 ? this->InitialName :
+        this->MaterialNames[material];
+      this->TCoords[2 * i] = name == this->ArrayName ?
+        this->Values[2 * i] : -1.0f;
+      this->TCoords[2 * i + 1] = name == this->ArrayName ?
+        this->Values[2 * i + 1] : -1.0f;
+    }
+  }
+};
+
+// The faces of a piece, where they are in the cells of the file, and where
+// their duplicated points and cells go.
+struct vtkOBJFaces
+{
+  vtkIdType PolyOffset;
+  vtkIdType TCoordPolyOffset;
+  vtkIdType NormalPolyOffset;
+  vtkIdType NumberOfPolys;
+  vtkIdType NumberOfNewPoints;
+  vtkIdType NumberOfNewPolys;
+  vtkIdType NewCellsSize;
+  vtkIdType NewPointOffset;
+  vtkIdType NewCellOffset;
+  bool Invalid;
+};
+
+// Give each face with complete texture coordinates and normals its own
+// points, like the serial parsing does when the faces use different
+// indices for their points, texture coordinates or normals.  A first pass
+// counts the new points and cells, a second pass writes them.
+struct vtkOBJDuplicatePoints
+{
+  enum Pass
+  {
+    COUNT,
+    WRITE
+  };
+
+  Pass CurrentPass;
+  vtkOBJFaces *Faces;
+  const vtkIdType *Polys;
+  const vtkIdType *TCoordPolys;
+  const vtkIdType *NormalPolys;
+  bool HasTCoords;
+  bool HasNormals;
+  const float *Points;
+  vtkIdType NumberOfPoints;
+  std::vector<const float*> TCoords;
+  vtkIdType NumberOfTCoords;
+  const float *Normals;
+  vtkIdType NumberOfNormals;
+  float *NewPoints;
+  std::vector<float*> NewTCoords;
+  float *NewNormals;
+  vtkIdType *NewPolys;
+
+  static bool InRange(const vtkIdType *ids, vtkIdType n, vtkIdType size)
+  {
+    for (vtkIdType i = 0; i < n; ++i)
+    {
+      if (ids[i] < 0 || ids[i] >= size)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkOBJFaces &faces = this->Faces[i];
+      const vtkIdType *poly = this->Polys + faces.PolyOffset;
+      const vtkIdType *tcoordPoly =
+        this->TCoordPolys + faces.TCoordPolyOffset;
+      const vtkIdType *normalPoly =
+        this->NormalPolys + faces.NormalPolyOffset;
+      vtkIdType newPtId = faces.NewPointOffset;
+      vtkIdType *newPoly = this->NewPolys + faces.NewCellOffset;
+      if (this->CurrentPass == COUNT)
+      {
+        faces.NumberOfNewPoints = 0;
+        faces.NumberOfNewPolys = 0;
+        faces.NewCellsSize = 0;
+        faces.Invalid = false;
+      }
+      for (vtkIdType j = 0; j < faces.NumberOfPolys; ++j)
+      {
+        vtkIdType npts = *poly;
+        vtkIdType ntcoords = *tcoordPoly;
+        vtkIdType nnormals = *normalPoly;
+        // skip the polys without complete tcoords or normals
+        if (!((npts != ntcoords && this->HasTCoords) ||
+              (npts != nnormals && this->HasNormals)))
+        {
+          if (this->CurrentPass == COUNT)
+          {
+            faces.NumberOfNewPoints += npts;
+            ++faces.NumberOfNewPolys;
+            faces.NewCellsSize += npts + 1;
+            faces.Invalid = faces.Invalid ||
+              !InRange(poly + 1, npts, this->NumberOfPoints) ||
+              !InRange(tcoordPoly + 1, ntcoords, this->NumberOfTCoords) ||
+              !InRange(normalPoly + 1, nnormals, this->NumberOfNormals);
+          }
+          else
+          {
+            *newPoly++ = npts;
+            for (vtkIdType k = 0; k < npts; ++k, ++newPtId)
+            {
+              *newPoly++ = newPtId;
+              memcpy(this->NewPoints + 3 * newPtId,
+                     this->Points + 3 * poly[k + 1], 3 * sizeof(float));
+              for (size_t l = 0; ntcoords > 0 && l < this->TCoords.size(); ++l)
+              {
+                memcpy(this->NewTCoords[l] + 2 * newPtId,
+                       this->TCoords[l] + 2 * tcoordPoly[k + 1],
+                       2 * sizeof(float));
+              }
+              if (nnormals > 0)
+              {
+                memcpy(this->NewNormals + 3 * newPtId,
+                       this->Normals + 3 * normalPoly[k + 1],
+                       3 * sizeof(float));
+              }
+            }
+          }
+        }
+        poly += npts + 1;
+        tcoordPoly += ntcoords + 1;
+        normalPoly += nnormals + 1;
+      }
+    }
+  }
+};
+
+// Make room for size values in array, growing it geometrically, and return
+// a pointer to its values.
+template <class ArrayT>
+typename ArrayT::ValueType *vtkOBJReserve(ArrayT *array, vtkIdType size)
+{
+  if (size > array->GetSize())
+  {
+    vtkIdType newSize = std::max(size, 2 * array->GetSize());
+    array->Resize(newSize / array->GetNumberOfComponents() + 1);
+  }
+  return array->WritePointer(0, size);
+}
+
+vtkSmartPointer<vtkFloatArray> vtkOBJNewArray(const char *name, int numComps,
+                                              vtkIdType numTuples)
+{
+  vtkSmartPointer<vtkFloatArray> array = vtkSmartPointer<vtkFloatArray>::New();
+  array->SetName(name);
+  array->SetNumberOfComponents(numComps);
+  array->SetNumberOfTuples(numTuples);
+  return array;
+}
+}
+
+
+void vtkOBJReader::ReadOBJSMP(const char *data, size_t size,
+                              vtkPolyData *output)
+{
+  vtkDebugMacro(<<"Reading file with several threads");
+
+  // The lines after the last line end that can end a piece are parsed from
+  // a copy ending with a line end, so that parsing numbers stops before the
+  // end of the data.
+  size_t mappedSize = size;
+  while (mappedSize > 0 && !vtkOBJIsPieceEnd(data, mappedSize))
+  {
+    --mappedSize;
+  }
+  std::vector<char> tail(data + mappedSize, data + size);
+  if (!tail.empty() && tail[tail.size() - 1] != '\n')
+  {
+    tail.push_back('\n');
+  }
+
+  vtkNew<vtkFloatArray> points;
+  points->SetNumberOfComponents(3);
+  vtkNew<vtkFloatArray> tcoordValues;
+  tcoordValues->SetNumberOfComponents(2);
+  vtkNew<vtkFloatArray> normals;
+  normals->SetNumberOfComponents(3);
+  normals->SetName("Normals");
+  std::vector<int> tcoordMaterials;
+  std::vector<vtkOBJMaterial> materials;
+  vtkSmartPointer<vtkIdTypeArray> cells[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+  vtkIdType numCells[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+  vtkIdType cellsSizes[VTK_OBJ_NUMBER_OF_CELL_KINDS];
+  for (int k = 0; k < VTK_OBJ_NUMBER_OF_CELL_KINDS; ++k)
+  {
+    cells[k] = vtkSmartPointer<vtkIdTypeArray>::New();
+    numCells[k] = 0;
+    cellsSizes[k] = 0;
+  }
+  std::vector<vtkOBJFaces> faces;
+  vtkIdType numPts = 0;
+  vtkIdType numTCoords = 0;
+  vtkIdType numNormals = 0;
+  vtkIdType numLines = 0;
+  int pendingMaterial = -1;
+  bool hasTCoords = false;
+  bool hasNormals = false;
+  bool tcoordsSameAsVerts = true;
+  bool normalsSameAsVerts = true;
+
+  // The file is parsed in windows of a few megabytes per thread, made of
+  // whole lines, which are cut into pieces parsed concurrently.
+  const size_t pieceSize = 1 << 20;
+  const size_t windowSize = 8 * pieceSize *
+    std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<vtkOBJPiece> pieces;
+  size_t windowBegin = 0;
+  bool done = false;
+  while (!done)
+  {
+    const char *window;
+    size_t windowEnd;
+    if (windowBegin < mappedSize)
+    {
+      window = data + windowBegin;
+      windowEnd = std::min(windowBegin + windowSize, mappedSize);
+      while (!vtkOBJIsPieceEnd(data, windowEnd))
+      {
+        ++windowEnd;
+      }
+      windowEnd -= windowBegin;
+      windowBegin += windowEnd;
+    }
+    else
+    {
+      done = true;
+      if (tail.empty())
+      {
+        break;
+      }
+      window = &tail[0];
+      windowEnd = tail.size();
+    }
+
+    // Cut the window after line ends.
+    size_t numPieces = windowEnd / pieceSize + 1;
+    pieces.resize(numPieces);
+    size_t pieceBegin = 0;
+    for (size_t i = 0; i < numPieces; ++i)
+    {
+      size_t pieceEnd = i + 1 == numPieces ? windowEnd :
+        std::max(pieceBegin, (i + 1) * windowEnd / numPieces);
+      while (pieceEnd < windowEnd && !vtkOBJIsPieceEnd(window, pieceEnd))
+      {
+        ++pieceEnd;
+      }
+      pieces[i].Begin = window + pieceBegin;
+      pieces[i].End = window + pieceEnd;
+      pieceBegin = pieceEnd;
+    }
+    vtkOBJParsePieces parse;
+    parse.Pieces = &pieces[0];
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numPieces), 1, parse);
+
+    // Find where the data of the pieces go, and follow the materials.
+    for (size_t i = 0; i < numPieces; ++i)
+    {
+      vtkOBJPiece &piece = pieces[i];
+      if (piece.ErrorLine >= 0)
+      {
+        vtkIdType line = numLines + piece.ErrorLine + 1;
+        if (piece.Error == VTK_OBJ_READ_ERROR)
+        {
+          vtkErrorMacro(<<"Error reading '" << piece.ErrorCommand
+                        << "' at line " << line);
+        }
+        else if (piece.Error == VTK_OBJ_CONTINUATION_ERROR)
+        {
+          vtkErrorMacro(<<"Error reading continuation line at line " << line);
+        }
+        else
+        {
+          vtkErrorMacro
+          (
+              <<"Error reading file near line " << line
+              << " while processing the '" << piece.ErrorCommand
+              << "' command"
+          );
+        }
+        return;
+      }
+      piece.PointOffset = numPts;
+      piece.TCoordOffset = numTCoords;
+      piece.NormalOffset = numNormals;
+      numPts += static_cast<vtkIdType>(piece.Points.size() / 3);
+      numTCoords += static_cast<vtkIdType>(piece.TCoords.size() / 2);
+      numNormals += static_cast<vtkIdType>(piece.Normals.size() / 3);
+      for (int k = 0; k < VTK_OBJ_NUMBER_OF_CELL_KINDS; ++k)
+      {
+        piece.CellOffsets[k] = cellsSizes[k];
+        cellsSizes[k] += static_cast<vtkIdType>(piece.Cells[k].Ids.size());
+        numCells[k] += piece.Cells[k].NumberOfCells;
+      }
+      if (pendingMaterial >= 0 && piece.NumberOfLines > 0)
+      {
+        materials[pendingMaterial].NextLineIsTCoords =
+          piece.FirstLineIsTCoords;
+        pendingMaterial = -1;
+      }
+      piece.MaterialOffset = static_cast<int>(materials.size());
+      piece.PreviousMaterial = piece.MaterialOffset - 1;
+      for (size_t j = 0; j < piece.Materials.size(); ++j)
+      {
+        materials.push_back(piece.Materials[j]);
+        materials.back().Line += numLines;
+      }
+      if (piece.LastLineIsMaterial)
+      {
+        pendingMaterial = static_cast<int>(materials.size()) - 1;
+      }
+      numLines += piece.NumberOfLines;
+      hasTCoords = hasTCoords || piece.HasTCoords;
+      hasNormals = hasNormals || piece.HasNormals;
+    }
+
+    vtkOBJCopyPieces copy;
+    copy.Pieces = &pieces[0];
+    copy.Points = vtkOBJReserve(points.Get(), 3 * numPts);
+    copy.TCoords = vtkOBJReserve(tcoordValues.Get(), 2 * numTCoords);
+    copy.Normals = vtkOBJReserve(normals.Get(), 3 * numNormals);
+    tcoordMaterials.resize(numTCoords);
+    copy.TCoordMaterials = numTCoords ? &tcoordMaterials[0] : NULL;
+    for (int k = 0; k < VTK_OBJ_NUMBER_OF_CELL_KINDS; ++k)
+    {
+      copy.Cells[k] = vtkOBJReserve(cells[k].Get(), cellsSizes[k]);
+    }
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numPieces), 1, copy);
+
+    for (size_t i = 0; i < numPieces; ++i)
+    {
+      const vtkOBJPiece &piece = pieces[i];
+      tcoordsSameAsVerts = tcoordsSameAsVerts && piece.TCoordsSameAsVerts;
+      normalsSameAsVerts = normalsSameAsVerts && piece.NormalsSameAsVerts;
+      if (piece.Cells[VTK_OBJ_POLYS].NumberOfCells > 0)
+      {
+        vtkOBJFaces pieceFaces;
+        pieceFaces.PolyOffset = piece.CellOffsets[VTK_OBJ_POLYS];
+        pieceFaces.TCoordPolyOffset = piece.CellOffsets[VTK_OBJ_TCOORD_POLYS];
+        pieceFaces.NormalPolyOffset = piece.CellOffsets[VTK_OBJ_NORMAL_POLYS];
+        pieceFaces.NumberOfPolys = piece.Cells[VTK_OBJ_POLYS].NumberOfCells;
+        faces.push_back(pieceFaces);
+      }
+    }
+    this->UpdateProgress(static_cast<double>(windowBegin) / size);
+  }
+
+  // Like the first pass of the serial parsing, a usemtl line directly
+  // followed by a vt line starts a new array of texture coordinates, and the
+  // line after a usemtl line is not checked for another usemtl line.  The
+  // texture coordinates before any usemtl line belong to the material of the
+  // last usemtl line checked.
+  std::vector<std::string> arrayNames;
+  int lastMaterial = -1;
+  for (int i = 0; i < static_cast<int>(materials.size()); ++i)
+  {
+    if (lastMaterial >= 0 && lastMaterial == i - 1 &&
+        materials[i].Line == materials[lastMaterial].Line + 1)
+    {
+      continue;
+    }
+    lastMaterial = i;
+    if (i == pendingMaterial)
+    {
+      vtkErrorMacro(<<"Error reading continuation line at line "
+                    << materials[i].Line + 1);
+      return;
+    }
+    if (materials[i].NextLineIsTCoords)
+    {
+      arrayNames.push_back(materials[i].Name);
+    }
+  }
+  std::string initialName = "TCoords";
+  if (arrayNames.empty())
+  {
+    arrayNames.push_back(initialName);
+  }
+  else
+  {
+    initialName = materials[lastMaterial].Name;
+  }
+
+  std::vector<vtkSmartPointer<vtkFloatArray> > tcoords;
+  if (hasTCoords && materials.empty())
+  {
+    tcoordValues->SetName(initialName.c_str());
+    tcoords.push_back(tcoordValues.Get());
+  }
+  else if (hasTCoords)
+  {
+    std::map<std::string, int> nameIds;
+    std::vector<int> materialNames(materials.size());
+    for (size_t i = 0; i < materials.size(); ++i)
+    {
+      materialNames[i] = nameIds.insert(std::make_pair(
+        materials[i].Name, static_cast<int>(nameIds.size()))).first->second;
+    }
+    vtkOBJFillTCoords fill;
+    fill.Values = tcoordValues->GetPointer(0);
+    fill.Materials = numTCoords ? &tcoordMaterials[0] : NULL;
+    fill.MaterialNames = &materialNames[0];
+    fill.InitialName = nameIds.insert(std::make_pair(
+      initialName, static_cast<int>(nameIds.size()))).first->second;
+    for (size_t i = 0; i < arrayNames.size(); ++i)
+    {
+      tcoords.push_back(vtkOBJNewArray(arrayNames[i].c_str(), 2, numTCoords));
+      fill.ArrayName = nameIds.insert(std::make_pair(
+        arrayNames[i], static_cast<int>(nameIds.size()))).first->second;
+      fill.TCoords = tcoords.back()->GetPointer(0);
+      vtkSMPTools::For(0, numTCoords, fill);
+    }
+  }
+
+  // -- now turn this lot into a useable vtkPolyData --
+  vtkNew<vtkPoints> outPoints;
+  vtkSmartPointer<vtkFloatArray> outNormals = normals.Get();
+  if ((!hasTCoords || tcoordsSameAsVerts) &&
+      (!hasNormals || normalsSameAsVerts))
+  {
+    vtkDebugMacro(<<"Copying file data into the output directly");
+
+    outPoints->SetData(points.Get());
+    output->SetPoints(outPoints.Get());
+    if (numCells[VTK_OBJ_VERTS])
+    {
+      vtkNew<vtkCellArray> verts;
+      verts->SetCells(numCells[VTK_OBJ_VERTS], cells[VTK_OBJ_VERTS]);
+      output->SetVerts(verts.Get());
+    }
+    if (numCells[VTK_OBJ_LINES])
+    {
+      vtkNew<vtkCellArray> lines;
+      lines->SetCells(numCells[VTK_OBJ_LINES], cells[VTK_OBJ_LINES]);
+      output->SetLines(lines.Get());
+    }
+    if (numCells[VTK_OBJ_POLYS])
+    {
+      vtkNew<vtkCellArray> polys;
+      polys->SetCells(numCells[VTK_OBJ_POLYS], cells[VTK_OBJ_POLYS]);
+      output->SetPolys(polys.Get());
+    }
+  }
+  // otherwise we can duplicate the vertices as necessary
+  else
+  {
+    vtkDebugMacro(<<"Duplicating vertices so that tcoords and normals are correct");
+
+    vtkOBJDuplicatePoints duplicate;
+    duplicate.CurrentPass = vtkOBJDuplicatePoints::COUNT;
+    duplicate.Faces = faces.empty() ? NULL : &faces[0];
+    duplicate.Polys = cells[VTK_OBJ_POLYS]->GetPointer(0);
+    duplicate.TCoordPolys = cells[VTK_OBJ_TCOORD_POLYS]->GetPointer(0);
+    duplicate.NormalPolys = cells[VTK_OBJ_NORMAL_POLYS]->GetPointer(0);
+    duplicate.HasTCoords = hasTCoords;
+    duplicate.HasNormals = hasNormals;
+    duplicate.Points = points->GetPointer(0);
+    duplicate.NumberOfPoints = numPts;
+    duplicate.NumberOfTCoords = numTCoords;
+    duplicate.Normals = normals->GetPointer(0);
+    duplicate.NumberOfNormals = numNormals;
+    vtkIdType numFaces = static_cast<vtkIdType>(faces.size());
+    vtkSMPTools::For(0, numFaces, 1, duplicate);
+
+    vtkIdType numNewPts = 0;
+    vtkIdType numNewPolys = 0;
+    vtkIdType newCellsSize = 0;
+    for (size_t i = 0; i < faces.size(); ++i)
+    {
+      if (faces[i].Invalid)
+      {
+        vtkErrorMacro(<<"Invalid index in the 'f' commands");
+        return;
+      }
+      faces[i].NewPointOffset = numNewPts;
+      faces[i].NewCellOffset = newCellsSize;
+      numNewPts += faces[i].NumberOfNewPoints;
+      numNewPolys += faces[i].NumberOfNewPolys;
+      newCellsSize += faces[i].NewCellsSize;
+    }
+
+    vtkSmartPointer<vtkFloatArray> newPoints =
+      vtkOBJNewArray(NULL, 3, numNewPts);
+    vtkSmartPointer<vtkFloatArray> newNormals =
+      vtkOBJNewArray("Normals", 3, hasNormals ? numNewPts : 0);
+    vtkNew<vtkIdTypeArray> newPolys;
+    newPolys->SetNumberOfValues(newCellsSize);
+    std::vector<vtkSmartPointer<vtkFloatArray> > newTCoords;
+    for (size_t i = 0; i < tcoords.size(); ++i)
+    {
+      newTCoords.push_back(
+        vtkOBJNewArray(tcoords[i]->GetName(), 2, numNewPts));
+      duplicate.TCoords.push_back(tcoords[i]->GetPointer(0));
+      duplicate.NewTCoords.push_back(newTCoords[i]->GetPointer(0));
+    }
+    duplicate.CurrentPass = vtkOBJDuplicatePoints::WRITE;
+    duplicate.NewPoints = newPoints->GetPointer(0);
+    duplicate.NewNormals = newNormals->GetPointer(0);
+    duplicate.NewPolys = newPolys->GetPointer(0);
+    vtkSMPTools::For(0, numFaces, 1, duplicate);
+    tcoords.swap(newTCoords);
+
+    outPoints->SetData(newPoints);
+    vtkNew<vtkCellArray> polys;
+    polys->SetCells(numNewPolys, newPolys.Get());
+    output->SetPoints(outPoints.Get());
+    output->SetPolys(polys.Get());
+    outNormals = newNormals;
+  }
+
+  // The tcoords and normals are only used when they match the points, or
+  // after duplicating the points.
+  if (hasTCoords)
+  {
+    for (size_t i = 0; i < tcoords.size(); ++i)
+    {
+      output->GetPointData()->AddArray(tcoords[i]);
+      if (i == 0)
+      {
+        output->GetPointData()->SetActiveTCoords(tcoords[i]->GetName());
+      }
+    }
+  }
+  if (hasNormals)
+  {
+    output->GetPointData()->SetNormals(outNormals);
+  }
+  output->Squeeze();
+}
+
+
 void vtkOBJReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
 
   os << indent << "File Name: "
      << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "EnableSMP: " << (this->EnableSMP ? "On\n" : "Off\n");
 
 }
 
@@ -18,6 +18,12 @@
  *
  * vtkOBJReader is a source object that reads Wavefront .obj
  * files. The output of this source object is polygonal data.
+ *
+ * When EnableSMP is on, the file is memory-mapped and cut into pieces of
+ * whole lines whose records are parsed concurrently.  The pieces are then
+ * concatenated, resolving the negative indices that count back from the
+ * last vertex, texture coordinate or normal read, so the output is the
+ * same as with the serial parsing.
  * @sa
  * vtkOBJImporter
 */
@@ -28,6 +34,8 @@
 #include "vtkIOGeometryModule.h" // For export macro
 #include "vtkAbstractPolyDataReader.h"
 
+class vtkPolyData;
+
 class VTKIOGEOMETRY_EXPORT vtkOBJReader : public vtkAbstractPolyDataReader
 {
 public:
@@ -35,11 +43,29 @@ public:
   vtkTypeMacro(vtkOBJReader,vtkAbstractPolyDataReader);
   void PrintSelf(ostream& os, vtkIndent indent) VTK_OVERRIDE;
 
+  //@{
+  /**
+   * Enable/disable the threaded parsing (see the class documentation).
+   * This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkOBJReader();
   ~vtkOBJReader() VTK_OVERRIDE;
 
+  int EnableSMP;
+
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
+
+  /**
+   * Threaded version of the parsing of RequestData, used when EnableSMP is
+   * on, which reads the size bytes of the file at data into output.
+   */
+  void ReadOBJSMP(const char *data, size_t size, vtkPolyData *output);
 private:
   vtkOBJReader(const vtkOBJReader&) VTK_DELETE_FUNCTION;
   void operator=(const vtkOBJReader&) VTK_DELETE_FUNCTION;
@@ -25,13 +25,17 @@
 #include "vtkMergePoints.h"
 #include "vtkObjectFactory.h"
 #include "vtkPolyData.h"
+#include "vtkSMPTools.h"
 #include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <vtksys/SystemTools.hxx>
 
 vtkStandardNewMacro(vtkSTLReader);
@@ -48,6 +52,7 @@ vtkSTLReader::vtkSTLReader()
   this->FileName = NULL;
   this->Merging = 1;
   this->ScalarTags = 0;
+  this->EnableSMP = 0;
   this->Locator = NULL;
 
   this->SetNumberOfInputPorts(0);
@@ -122,7 +127,9 @@ int vtkSTLReader::RequestData(
       newScalars = vtkFloatArray::New();
       newScalars->Allocate(5000);
     }
-    if (!this->ReadASCIISTL(fp, newPts, newPolys, newScalars))
+    if (!(this->EnableSMP ?
+          this->ReadASCIISTLSMP(fp, newPts, newPolys, newScalars) :
+          this->ReadASCIISTL(fp, newPts, newPolys, newScalars)))
     {
       fclose(fp);
       return 0;
@@ -140,7 +147,9 @@ int vtkSTLReader::RequestData(
       return 0;
     }
 
-    if (!this->ReadBinarySTL(fp, newPts, newPolys))
+    if (!(this->EnableSMP ?
+          this->ReadBinarySTLSMP(fp, newPts, newPolys) :
+          this->ReadBinarySTL(fp, newPts, newPolys)))
     {
       fclose(fp);
       return 0;
@@ -160,46 +169,58 @@ int vtkSTLReader::RequestData(
   if (this->Merging)
   {
     mergedPts = vtkPoints::New();
-    mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
     mergedPolys = vtkCellArray::New();
-    mergedPolys->Allocate(newPolys->GetSize());
     if (newScalars)
     {
       mergedScalars = vtkFloatArray::New();
-      mergedScalars->Allocate(newPolys->GetSize());
     }
 
-    vtkSmartPointer<vtkIncrementalPointLocator> locator = this->Locator;
-    if (this->Locator == NULL)
+    if (this->EnableSMP && this->Locator == NULL)
     {
-      locator.TakeReference(this->NewDefaultLocator());
+      this->MergePointsSMP(newPts, newScalars,
+                           mergedPts, mergedPolys, mergedScalars);
     }
-    locator->InitPointInsertion(mergedPts, newPts->GetBounds());
-
-    int nextCell = 0;
-    vtkIdType *pts = 0;
-    vtkIdType npts;
-    for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
+    else
     {
-      vtkIdType nodes[3];
-      for (int i = 0; i < 3; i++)
+      mergedPts->Allocate(newPts->GetNumberOfPoints() /2);
+      mergedPolys->Allocate(newPolys->GetSize());
+      if (newScalars)
+      {
+        mergedScalars->Allocate(newPolys->GetSize());
+      }
+
+      vtkSmartPointer<vtkIncrementalPointLocator> locator = this->Locator;
+      if (this->Locator == NULL)
       {
-        double x[3];
-        newPts->GetPoint(pts[i], x);
-        locator->InsertUniquePoint(x, nodes[i]);
+        locator.TakeReference(this->NewDefaultLocator());
       }
+      locator->InitPointInsertion(mergedPts, newPts->GetBounds());
 
-      if (nodes[0] != nodes[1] &&
-        nodes[0] != nodes[2] &&
-        nodes[1] != nodes[2])
+      int nextCell = 0;
+      vtkIdType *pts = 0;
+      vtkIdType npts;
+      for (newPolys->InitTraversal(); newPolys->GetNextCell(npts, pts);)
       {
-        mergedPolys->InsertNextCell(3, nodes);
-        if (newScalars)
+        vtkIdType nodes[3];
+        for (int i = 0; i < 3; i++)
+        {
+          double x[3];
+          newPts->GetPoint(pts[i], x);
+          locator->InsertUniquePoint(x, nodes[i]);
+        }
+
+        if (nodes[0] != nodes[1] &&
+          nodes[0] != nodes[2] &&
+          nodes[1] != nodes[2])
         {
-          mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
+          mergedPolys->InsertNextCell(3, nodes);
+          if (newScalars)
+          {
+            mergedScalars->InsertNextValue(newScalars->GetValue(nextCell));
+          }
         }
+        nextCell++;
       }
-      nextCell++;
     }
 
     newPts->Delete();
@@ -476,6 +497,640 @@ bool vtkSTLReader::ReadASCIISTL(FILE *fp, vtkPoints *newPts,
   return true;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+// Decode a block of binary facets: the 3 vertices of facet i are stored at
+// points 3i, 3i+1 and 3i+2 and its cell refers to them.
+struct vtkSTLDecodeFacets
+{
+  const unsigned char *Buffer;
+  float *Points;
+  vtkIdType *Cells;
+  vtkIdType FirstFacet;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      float *x = this->Points + 9 * i;
+      // Skip the normal, and the attribute byte count that ends the facet.
+      memcpy(x, this->Buffer + 50 * i + 12, 9 * sizeof(float));
+      vtkByteSwap::Swap4LERange(x, 9);
+      vtkIdType *cell = this->Cells + 4 * i;
+      vtkIdType pt = 3 * (this->FirstFacet + i);
+      cell[0] = 3;
+      cell[1] = pt;
+      cell[2] = pt + 1;
+      cell[3] = pt + 2;
+    }
+  }
+};
+
+inline bool vtkSTLIsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Whether the word [begin, end) is keyword, a lowercase word, ignoring case.
+bool vtkSTLIsKeyword(const char *begin, const char *end, const char *keyword)
+{
+  for (; begin < end && *keyword; ++begin, ++keyword)
+  {
+    if (tolower(static_cast<unsigned char>(*begin)) != *keyword)
+    {
+      return false;
+    }
+  }
+  return begin == end && *keyword == 0;
+}
+
+// Parse the vertices of a piece of an ascii STL file made of whole lines.
+// Only the "vertex" lines, whose 3 coordinates are parsed like fscanf
+// does, and the "endsolid" lines, which start a new solid, matter.
+struct vtkSTLASCIIPiece
+{
+  const char *Begin;
+  const char *End;
+  std::vector<float> Points;
+  // For each vertex, the number of solids ended before it in the piece.
+  std::vector<int> Solids;
+  bool StoreSolids;
+  int NumberOfSolids;
+  vtkIdType NumberOfLines;
+  // The line of the first invalid vertex in the piece, or -1.
+  vtkIdType ErrorLine;
+
+  void Parse()
+  {
+    this->Points.clear();
+    this->Solids.clear();
+    this->NumberOfSolids = 0;
+    this->NumberOfLines = 0;
+    this->ErrorLine = -1;
+    const char *p = this->Begin;
+    while (p < this->End)
+    {
+      while (p < this->End && vtkSTLIsSpace(*p))
+      {
+        ++p;
+      }
+      const char *word = p;
+      while (p < this->End && *p != '\n' && !vtkSTLIsSpace(*p))
+      {
+        ++p;
+      }
+      if (vtkSTLIsKeyword(word, p, "vertex"))
+      {
+        for (int i = 0; i < 3; ++i)
+        {
+          while (p < this->End && vtkSTLIsSpace(*p))
+          {
+            ++p;
+          }
+          // The buffer ends with a null character, which stops strtof.
+          char *next = NULL;
+          float x = 0.0f;
+          if (p < this->End && *p != '\n')
+          {
+            x = strtof(p, &next);
+          }
+          if (next == NULL || next == p)
+          {
+            this->ErrorLine = this->NumberOfLines;
+            return;
+          }
+          this->Points.push_back(x);
+          p = next;
+        }
+        if (this->StoreSolids)
+        {
+          this->Solids.push_back(this->NumberOfSolids);
+        }
+      }
+      else if (vtkSTLIsKeyword(word, p, "endsolid"))
+      {
+        ++this->NumberOfSolids;
+      }
+      while (p < this->End && *p != '\n')
+      {
+        ++p;
+      }
+      ++p;
+      ++this->NumberOfLines;
+    }
+  }
+};
+
+struct vtkSTLParsePieces
+{
+  vtkSTLASCIIPiece *Pieces;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      this->Pieces[i].Parse();
+    }
+  }
+};
+
+// Copy the parsed vertices of the pieces, starting at their offsets, and
+// the solid of the triangles that start in the pieces.
+struct vtkSTLCopyPieces
+{
+  vtkSTLASCIIPiece *Pieces;
+  const vtkIdType *Offsets;
+  const int *SolidOffsets;
+  float *Points;
+  float *Scalars;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const vtkSTLASCIIPiece &piece = this->Pieces[i];
+      if (piece.Points.empty())
+      {
+        continue;
+      }
+      memcpy(this->Points + 3 * this->Offsets[i], &piece.Points[0],
+             piece.Points.size() * sizeof(float));
+      if (this->Scalars)
+      {
+        vtkIdType numVerts = static_cast<vtkIdType>(piece.Solids.size());
+        for (vtkIdType j = 0; j < numVerts; ++j)
+        {
+          vtkIdType ptId = this->Offsets[i] + j;
+          if (ptId % 3 == 0)
+          {
+            this->Scalars[ptId / 3] =
+              static_cast<float>(this->SolidOffsets[i] + piece.Solids[j]);
+          }
+        }
+      }
+    }
+  }
+};
+
+struct vtkSTLMakeTriangles
+{
+  vtkIdType *Cells;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      vtkIdType *cell = this->Cells + 4 * i;
+      cell[0] = 3;
+      cell[1] = 3 * i;
+      cell[2] = 3 * i + 1;
+      cell[3] = 3 * i + 2;
+    }
+  }
+};
+
+// A point, with coordinates compared exactly like vtkMergePoints does, and
+// its id, which breaks the ties so that the first point of a group of
+// duplicates comes first.
+struct vtkSTLPointKey
+{
+  vtkTypeUInt32 X[3];
+  vtkIdType Id;
+
+  bool operator<(const vtkSTLPointKey &other) const
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      if (this->X[i] != other.X[i])
+      {
+        return this->X[i] < other.X[i];
+      }
+    }
+    return this->Id < other.Id;
+  }
+
+  bool SameCoordinates(const vtkSTLPointKey &other) const
+  {
+    return this->X[0] == other.X[0] && this->X[1] == other.X[1] &&
+      this->X[2] == other.X[2];
+  }
+
+  // NaN coordinates are not equal to themselves, so vtkMergePoints never
+  // merges these points.
+  bool IsNaN() const
+  {
+    return (this->X[0] & 0x7fffffff) > 0x7f800000 ||
+      (this->X[1] & 0x7fffffff) > 0x7f800000 ||
+      (this->X[2] & 0x7fffffff) > 0x7f800000;
+  }
+};
+
+// The passes of the sort-based merging. Points and triangles are processed
+// in chunks of ChunkSize items; the chunks first count what they output,
+// then write it at the offset given by the counts of the previous chunks,
+// so that the output is in the same order as the serial one.
+struct vtkSTLMergePoints
+{
+  enum PassType
+  {
+    MAKE_KEYS,
+    GROUP_POINTS,
+    COUNT_POINTS,
+    WRITE_POINTS,
+    COUNT_TRIANGLES,
+    WRITE_TRIANGLES
+  };
+  static const vtkIdType ChunkSize = 65536;
+
+  PassType Pass;
+  vtkIdType NumberOfPoints;
+  const float *Points;
+  const float *Scalars;
+  vtkSTLPointKey *Keys;
+  // The first point with the same coordinates as each point.
+  vtkIdType *Representatives;
+  // The merged id of each point that is its own representative.
+  vtkIdType *NewIds;
+  vtkIdType *Offsets;
+  float *MergedPoints;
+  vtkIdType *MergedCells;
+  float *MergedScalars;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    switch (this->Pass)
+    {
+      case MAKE_KEYS:
+        for (vtkIdType i = begin; i < end; ++i)
+        {
+          for (int j = 0; j < 3; ++j)
+          {
+            // Adding 0 turns -0 into 0, which compares equal to it.
+            float x = this->Points[3 * i + j] + 0.0f;
+            memcpy(&this->Keys[i].X[j], &x, sizeof(float));
+          }
+          this->Keys[i].Id = i;
+        }
+        break;
+      case GROUP_POINTS:
+        // Each group is handled from its first key, which may run past end.
+        for (vtkIdType i = begin; i < end; ++i)
+        {
+          const vtkSTLPointKey &first = this->Keys[i];
+          if (first.IsNaN())
+          {
+            this->Representatives[first.Id] = first.Id;
+          }
+          else if (i == 0 || !first.SameCoordinates(this->Keys[i - 1]))
+          {
+            for (vtkIdType j = i; j < this->NumberOfPoints &&
+                   this->Keys[j].SameCoordinates(first); ++j)
+            {
+              this->Representatives[this->Keys[j].Id] = first.Id;
+            }
+          }
+        }
+        break;
+      case COUNT_POINTS:
+      case WRITE_POINTS:
+        for (vtkIdType chunk = begin; chunk < end; ++chunk)
+        {
+          vtkIdType last =
+            std::min((chunk + 1) * ChunkSize, this->NumberOfPoints);
+          vtkIdType newId = this->Pass == WRITE_POINTS ?
+            this->Offsets[chunk] : 0;
+          for (vtkIdType i = chunk * ChunkSize; i < last; ++i)
+          {
+            if (this->Representatives[i] == i)
+            {
+              if (this->Pass == WRITE_POINTS)
+              {
+                this->NewIds[i] = newId;
+                memcpy(this->MergedPoints + 3 * newId, this->Points + 3 * i,
+                       3 * sizeof(float));
+              }
+              ++newId;
+            }
+          }
+          if (this->Pass == COUNT_POINTS)
+          {
+            this->Offsets[chunk] = newId;
+          }
+        }
+        break;
+      case COUNT_TRIANGLES:
+      case WRITE_TRIANGLES:
+        for (vtkIdType chunk = begin; chunk < end; ++chunk)
+        {
+          vtkIdType last =
+            std::min((chunk + 1) * ChunkSize, this->NumberOfPoints / 3);
+          vtkIdType cellId = this->Pass == WRITE_TRIANGLES ?
+            this->Offsets[chunk] : 0;
+          for (vtkIdType i = chunk * ChunkSize; i < last; ++i)
+          {
+            vtkIdType nodes[3];
+            for (int j = 0; j < 3; ++j)
+            {
+              nodes[j] = this->NewIds[this->Representatives[3 * i + j]];
+            }
+            if (nodes[0] != nodes[1] && nodes[0] != nodes[2] &&
+                nodes[1] != nodes[2])
+            {
+              if (this->Pass == WRITE_TRIANGLES)
+              {
+                vtkIdType *cell = this->MergedCells + 4 * cellId;
+                cell[0] = 3;
+                cell[1] = nodes[0];
+                cell[2] = nodes[1];
+                cell[3] = nodes[2];
+                if (this->Scalars)
+                {
+                  this->MergedScalars[cellId] = this->Scalars[i];
+                }
+              }
+              ++cellId;
+            }
+          }
+          if (this->Pass == COUNT_TRIANGLES)
+          {
+            this->Offsets[chunk] = cellId;
+          }
+        }
+        break;
+    }
+  }
+
+  // Run a counting pass over numChunks chunks and turn the counts into
+  // offsets; returns the total count.
+  vtkIdType Count(PassType pass, vtkIdType numChunks)
+  {
+    this->Pass = pass;
+    vtkSMPTools::For(0, numChunks, 1, *this);
+    vtkIdType total = 0;
+    for (vtkIdType chunk = 0; chunk < numChunks; ++chunk)
+    {
+      vtkIdType count = this->Offsets[chunk];
+      this->Offsets[chunk] = total;
+      total += count;
+    }
+    return total;
+  }
+};
+}
+
+//------------------------------------------------------------------------------
+bool vtkSTLReader::ReadBinarySTLSMP(FILE *fp, vtkPoints *newPts,
+                                    vtkCellArray *newPolys)
+{
+  vtkDebugMacro(<< "Reading BINARY STL file");
+
+  // 80 byte - header, 4 byte - triangle count
+  unsigned char header[84];
+  if (fread(header, 1, 84, fp) != 84)
+  {
+    vtkErrorMacro("STLReader error reading file: " << this->FileName
+      << " Premature EOF while reading header.");
+    return false;
+  }
+
+  // Like ReadBinarySTL, ignore the count, which is often bogus, and read
+  // the facets up to the end of the file.
+  vtkIdType numTris = static_cast<vtkIdType>(
+    (vtksys::SystemTools::FileLength(this->FileName) - 84) / 50);
+
+  newPts->SetDataTypeToFloat();
+  newPts->SetNumberOfPoints(3 * numTris);
+  float *points = static_cast<float*>(newPts->GetVoidPointer(0));
+  vtkIdType *cells = newPolys->WritePointer(numTris, 4 * numTris);
+
+  // Read the facets in large blocks, each of which is decoded by several
+  // threads.
+  const vtkIdType blockSize = 1 << 20;
+  std::vector<unsigned char> buffer(
+    50 * static_cast<size_t>(std::min(numTris, blockSize)));
+  for (vtkIdType first = 0; first < numTris; first += blockSize)
+  {
+    vtkIdType count = std::min(numTris - first, blockSize);
+    if (fread(&buffer[0], 50, count, fp) != static_cast<size_t>(count))
+    {
+      vtkErrorMacro("STLReader error reading file: " << this->FileName
+        << " Premature EOF while reading facets.");
+      return false;
+    }
+
+    vtkSTLDecodeFacets decode;
+    decode.Buffer = &buffer[0];
+    decode.Points = points + 9 * first;
+    decode.Cells = cells + 4 * first;
+    decode.FirstFacet = first;
+    vtkSMPTools::For(0, count, decode);
+
+    vtkDebugMacro(<< "triangle# " << first + count);
+    this->UpdateProgress(static_cast<double>(first + count) / numTris);
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool vtkSTLReader::ReadASCIISTLSMP(FILE *fp, vtkPoints *newPts,
+                                   vtkCellArray *newPolys,
+                                   vtkFloatArray *scalars)
+{
+  vtkDebugMacro(<< "Reading ASCII STL file");
+
+  newPts->SetDataTypeToFloat();
+  vtkFloatArray *points = vtkArrayDownCast<vtkFloatArray>(newPts->GetData());
+  points->SetNumberOfTuples(0);
+  if (scalars)
+  {
+    scalars->SetNumberOfTuples(0);
+  }
+
+  // The file is read in windows of a few megabytes per thread, made of
+  // whole lines, which are cut into pieces parsed concurrently.
+  const size_t pieceSize = 1 << 20;
+  size_t windowSize = 4 * pieceSize *
+    std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<char> buffer(windowSize + 1);
+  std::vector<vtkSTLASCIIPiece> pieces;
+  std::vector<vtkIdType> offsets;
+  std::vector<int> solidOffsets;
+  size_t carried = 0;
+  vtkIdType numPts = 0;
+  vtkIdType numLines = 0;
+  int numSolids = 0;
+  bool done = false;
+  while (!done)
+  {
+    size_t size = carried +
+      fread(&buffer[carried], 1, windowSize - carried, fp);
+    done = size < windowSize;
+    if (size == 0 && numLines == 0)
+    {
+      vtkErrorMacro("STLReader error reading file: " << this->FileName
+                     << " Premature EOF while reading header at line 0.");
+      return false;
+    }
+    size_t end = size;
+    if (!done)
+    {
+      while (end > 0 && buffer[end - 1] != '\n')
+      {
+        --end;
+      }
+      if (end == 0)
+      {
+        // A line longer than the window: make room for it.
+        carried = size;
+        windowSize *= 2;
+        buffer.resize(windowSize + 1);
+        continue;
+      }
+    }
+    buffer[size] = 0;
+
+    // Cut the window after line ends.
+    const char *data = &buffer[0];
+    size_t numPieces = end / pieceSize + 1;
+    pieces.resize(numPieces);
+    size_t pieceBegin = 0;
+    for (size_t i = 0; i < numPieces; ++i)
+    {
+      size_t pieceEnd = i + 1 == numPieces ? end :
+        std::max(pieceBegin, (i + 1) * end / numPieces);
+      while (pieceEnd < end && data[pieceEnd - 1] != '\n')
+      {
+        ++pieceEnd;
+      }
+      pieces[i].Begin = data + pieceBegin;
+      pieces[i].End = data + pieceEnd;
+      pieces[i].StoreSolids = scalars != NULL;
+      pieceBegin = pieceEnd;
+    }
+    vtkSTLParsePieces parse;
+    parse.Pieces = &pieces[0];
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numPieces), 1, parse);
+
+    offsets.resize(numPieces);
+    solidOffsets.resize(numPieces);
+    vtkIdType windowPts = 0;
+    for (size_t i = 0; i < numPieces; ++i)
+    {
+      if (pieces[i].ErrorLine >= 0)
+      {
+        vtkErrorMacro("STLReader: error while reading file " <<
+          this->FileName << " at line " << numLines + pieces[i].ErrorLine + 1
+          << ": unable to read STL vertex.");
+        return false;
+      }
+      offsets[i] = numPts + windowPts;
+      solidOffsets[i] = numSolids;
+      windowPts += static_cast<vtkIdType>(pieces[i].Points.size() / 3);
+      numSolids += pieces[i].NumberOfSolids;
+      numLines += pieces[i].NumberOfLines;
+    }
+
+    if (windowPts > 0)
+    {
+      vtkSTLCopyPieces copy;
+      copy.Pieces = &pieces[0];
+      copy.Offsets = &offsets[0];
+      copy.SolidOffsets = &solidOffsets[0];
+      copy.Points = points->WritePointer(0, 3 * (numPts + windowPts));
+      copy.Scalars = NULL;
+      if (scalars)
+      {
+        vtkIdType firstTri = (numPts + 2) / 3;
+        vtkIdType lastTri = (numPts + windowPts + 2) / 3;
+        copy.Scalars = lastTri > firstTri ?
+          scalars->WritePointer(0, lastTri) : scalars->GetPointer(0);
+      }
+      vtkSMPTools::For(0, static_cast<vtkIdType>(numPieces), 1, copy);
+      numPts += windowPts;
+      this->UpdateProgress((numPts / 3 % 50000) / 50000.0);
+    }
+
+    carried = size - end;
+    memmove(&buffer[0], &buffer[end], carried);
+  }
+
+  if (numPts % 3 != 0)
+  {
+    vtkErrorMacro("STLReader: error while reading file " << this->FileName
+      << " at line " << numLines << ": unable to read STL vertex.");
+    return false;
+  }
+
+  vtkIdType numTris = numPts / 3;
+  vtkSTLMakeTriangles triangles;
+  triangles.Cells = newPolys->WritePointer(numTris, 4 * numTris);
+  vtkSMPTools::For(0, numTris, triangles);
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void vtkSTLReader::MergePointsSMP(vtkPoints *newPts,
+                                  vtkFloatArray *newScalars,
+                                  vtkPoints *mergedPts,
+                                  vtkCellArray *mergedPolys,
+                                  vtkFloatArray *mergedScalars)
+{
+  vtkIdType numPts = newPts->GetNumberOfPoints();
+  vtkIdType numTris = numPts / 3;
+  std::vector<vtkSTLPointKey> keys(numPts);
+  std::vector<vtkIdType> representatives(numPts);
+  vtkIdType numChunks = (numPts + vtkSTLMergePoints::ChunkSize - 1) /
+    vtkSTLMergePoints::ChunkSize;
+  std::vector<vtkIdType> offsets(numChunks + 1);
+
+  vtkSTLMergePoints merge;
+  merge.NumberOfPoints = numPts;
+  merge.Points = static_cast<float*>(newPts->GetVoidPointer(0));
+  merge.Scalars = newScalars ? newScalars->GetPointer(0) : NULL;
+  merge.Keys = numPts > 0 ? &keys[0] : NULL;
+  merge.Representatives = numPts > 0 ? &representatives[0] : NULL;
+  merge.Offsets = &offsets[0];
+
+  // Sort the points by coordinates to find the groups of duplicates.
+  merge.Pass = vtkSTLMergePoints::MAKE_KEYS;
+  vtkSMPTools::For(0, numPts, merge);
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+  merge.Pass = vtkSTLMergePoints::GROUP_POINTS;
+  vtkSMPTools::For(0, numPts, merge);
+  std::vector<vtkSTLPointKey>().swap(keys);
+  std::vector<vtkIdType> newIds(numPts);
+  merge.NewIds = numPts > 0 ? &newIds[0] : NULL;
+
+  // Number the first point of each group in the order of the points, like
+  // vtkMergePoints does when the points are inserted in that order.
+  vtkIdType numMergedPts =
+    merge.Count(vtkSTLMergePoints::COUNT_POINTS, numChunks);
+  mergedPts->SetDataTypeToFloat();
+  mergedPts->SetNumberOfPoints(numMergedPts);
+  merge.MergedPoints = static_cast<float*>(mergedPts->GetVoidPointer(0));
+  merge.Pass = vtkSTLMergePoints::WRITE_POINTS;
+  vtkSMPTools::For(0, numChunks, 1, merge);
+
+  // Keep the triangles that are not degenerate.
+  vtkIdType numTriChunks = (numTris + vtkSTLMergePoints::ChunkSize - 1) /
+    vtkSTLMergePoints::ChunkSize;
+  vtkIdType numMergedTris =
+    merge.Count(vtkSTLMergePoints::COUNT_TRIANGLES, numTriChunks);
+  merge.MergedCells = mergedPolys->WritePointer(numMergedTris,
+                                                4 * numMergedTris);
+  merge.MergedScalars = NULL;
+  if (mergedScalars)
+  {
+    mergedScalars->SetNumberOfTuples(numMergedTris);
+    merge.MergedScalars = mergedScalars->GetPointer(0);
+  }
+  merge.Pass = vtkSTLMergePoints::WRITE_TRIANGLES;
+  vtkSMPTools::For(0, numTriChunks, 1, merge);
+}
+
 //------------------------------------------------------------------------------
 int vtkSTLReader::GetSTLFileType(const char *filename)
 {
@@ -514,6 +1169,7 @@ void vtkSTLReader::PrintSelf(ostream& os, vtkIndent indent)
 
   os << indent << "Merging: " <<(this->Merging ? "On\n" : "Off\n");
   os << indent << "ScalarTags: " <<(this->ScalarTags ? "On\n" : "Off\n");
+  os << indent << "EnableSMP: " <<(this->EnableSMP ? "On\n" : "Off\n");
   os << indent << "Locator: ";
   if (this->Locator)
   {
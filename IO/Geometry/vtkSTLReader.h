@@ -27,6 +27,14 @@
  * however, merging requires a large amount of temporary storage since a
  * 3D hash table must be constructed.
  *
+ * When EnableSMP is on, binary facets are read in large blocks and decoded
+ * with several threads, and ascii files are read in large buffers whose
+ * lines are parsed concurrently.  If no Locator was specified, merging
+ * then sorts the points by their coordinates with vtkSMPTools instead of
+ * inserting them in a vtkMergePoints.  Like vtkMergePoints, it only merges
+ * points with exactly the same coordinates and numbers them in the order
+ * they are first met, so the output is the same.
+ *
  * @warning
  * Binary files written on one system may not be readable on other systems.
  * vtkSTLWriter uses VAX or PC byte ordering and swaps bytes on other systems.
@@ -87,6 +95,16 @@ public:
   vtkGetObjectMacro(Locator,vtkIncrementalPointLocator);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded reading and merging (see the class
+   * documentation).  This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
 protected:
   vtkSTLReader();
   ~vtkSTLReader() VTK_OVERRIDE;
@@ -98,6 +116,7 @@ protected:
 
   int Merging;
   int ScalarTags;
+  int EnableSMP;
   vtkIncrementalPointLocator *Locator;
 
   int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *) VTK_OVERRIDE;
@@ -105,6 +124,20 @@ protected:
   bool ReadASCIISTL(FILE *fp, vtkPoints*, vtkCellArray*,
                     vtkFloatArray* scalars=0);
   int GetSTLFileType(const char *filename);
+
+  //@{
+  /**
+   * Threaded versions of the methods above, used when EnableSMP is on.
+   * The readers store the points of triangle i at 3i, 3i+1 and 3i+2,
+   * which MergePointsSMP relies on.
+   */
+  bool ReadBinarySTLSMP(FILE *fp, vtkPoints*, vtkCellArray*);
+  bool ReadASCIISTLSMP(FILE *fp, vtkPoints*, vtkCellArray*,
+                       vtkFloatArray* scalars=0);
+  void MergePointsSMP(vtkPoints *newPts, vtkFloatArray *newScalars,
+                      vtkPoints *mergedPts, vtkCellArray *mergedPolys,
+                      vtkFloatArray *mergedScalars);
+  //@}
 private:
   vtkSTLReader(const vtkSTLReader&) VTK_DELETE_FUNCTION;
   void operator=(const vtkSTLReader&) VTK_DELETE_FUNCTION;
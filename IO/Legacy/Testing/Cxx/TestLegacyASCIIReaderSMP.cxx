@@ -0,0 +1,222 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestLegacyASCIIReaderSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the bulk parsing of ascii legacy files reads the same values
+// as operator>>, and that the threaded parsing reads the same data as the
+// serial one.
+
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkIdTypeArray.h"
+#include "vtkIntArray.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+#include "vtkPoints.h"
+#include "vtkPolyData.h"
+#include "vtkPolyDataReader.h"
+#include "vtkPolyDataWriter.h"
+#include "vtkSmartPointer.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace
+{
+const char *TrickyPoints =
+  "0.1 -2.5e-3 1e22\n"
+  "123456789012345678901234 .5 -0\n"
+  "1.7976931348623157e308 2.2250738585072014E-308 3.\n"
+  "1e-30 +7 0.30000000000000004\n";
+
+const char *TrickyScalars =
+  "0.1 3.4028234e38 -1e-7 16777217\n";
+
+template <class T>
+void ParseExpected(const char *text, T *values, int n)
+{
+  std::istringstream is(text);
+  is.imbue(std::locale::classic());
+  for (int i = 0; i < n; ++i)
+  {
+    is >> values[i];
+  }
+}
+
+vtkSmartPointer<vtkPolyData> Read(const std::string &text, int enableSMP)
+{
+  vtkNew<vtkPolyDataReader> reader;
+  reader->ReadFromInputStringOn();
+  reader->SetInputString(text);
+  reader->SetEnableSMP(enableSMP);
+  reader->Update();
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(reader->GetOutput());
+  return output;
+}
+
+bool CheckTricky(int enableSMP)
+{
+  std::string text = std::string(
+    "# vtk DataFile Version 3.0\n"
+    "tricky values\n"
+    "ASCII\n"
+    "DATASET POLYDATA\n"
+    "POINTS 4 double\n") + TrickyPoints +
+    "VERTICES 1 5\n"
+    "4 0 1 2 3\n"
+    "POINT_DATA 4\n"
+    "SCALARS scalars float 1\n"
+    "LOOKUP_TABLE default\n" + TrickyScalars;
+  vtkSmartPointer<vtkPolyData> output = Read(text, enableSMP);
+
+  double points[12];
+  float scalars[4];
+  ParseExpected(TrickyPoints, points, 12);
+  ParseExpected(TrickyScalars, scalars, 4);
+  vtkDataArray *outPoints = output->GetPoints() ?
+    output->GetPoints()->GetData() : NULL;
+  vtkDataArray *outScalars = output->GetPointData()->GetScalars();
+  if (!outPoints || !outScalars || output->GetNumberOfVerts() != 1 ||
+      outPoints->GetNumberOfTuples() != 4 ||
+      outScalars->GetNumberOfTuples() != 4)
+  {
+    cerr << "Could not read the tricky values" << endl;
+    return false;
+  }
+  for (int i = 0; i < 12; ++i)
+  {
+    if (outPoints->GetComponent(i / 3, i % 3) != points[i])
+    {
+      cerr << "Point value " << i << " differs" << endl;
+      return false;
+    }
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    if (static_cast<float>(outScalars->GetComponent(i, 0)) != scalars[i])
+    {
+      cerr << "Scalar value " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+// Values much longer than the buffer sized from the number of values.
+bool CheckLongTokens(int enableSMP)
+{
+  std::string digits(200, '0');
+  std::string text = "# vtk DataFile Version 3.0\n"
+    "long values\n"
+    "ASCII\n"
+    "DATASET POLYDATA\n"
+    "POINTS 1 double\n"
+    "  0." + digits + "1\n" + digits + "2 -" + digits + "3.5\n"
+    "VERTICES 1 2\n"
+    "1 0\n";
+  vtkSmartPointer<vtkPolyData> output = Read(text, enableSMP);
+  if (output->GetNumberOfPoints() != 1 || output->GetNumberOfVerts() != 1)
+  {
+    cerr << "Could not read the long values" << endl;
+    return false;
+  }
+  double x[3];
+  output->GetPoint(0, x);
+  if (x[0] != 1e-201 || x[1] != 2.0 || x[2] != -3.5)
+  {
+    cerr << "Could not read the long values" << endl;
+    return false;
+  }
+  return true;
+}
+
+// A sphere large enough to span several buffers, with arrays of a few
+// types.
+std::string MakeFile()
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(300);
+  sphere->SetPhiResolution(300);
+  sphere->SetOutputPointsPrecision(vtkAlgorithm::DOUBLE_PRECISION);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkNew<vtkIntArray> ints;
+  ints->SetName("ints");
+  ints->SetNumberOfTuples(numPts);
+  vtkNew<vtkIdTypeArray> ids;
+  ids->SetName("ids");
+  ids->SetNumberOfTuples(numPts);
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetName("colors");
+  colors->SetNumberOfComponents(3);
+  colors->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    ints->SetValue(i, static_cast<int>(i * 7919 - 1000000));
+    ids->SetValue(i, i * 1000003);
+    for (int j = 0; j < 3; ++j)
+    {
+      colors->SetTypedComponent(i, j, static_cast<unsigned char>(i + j));
+    }
+  }
+  input->GetPointData()->AddArray(ints.Get());
+  input->GetPointData()->AddArray(ids.Get());
+  input->GetPointData()->AddArray(colors.Get());
+
+  vtkNew<vtkPolyDataWriter> writer;
+  writer->SetInputData(input);
+  writer->SetFileTypeToASCII();
+  writer->WriteToOutputStringOn();
+  writer->Write();
+  return writer->GetOutputStdString();
+}
+
+bool CheckLargeFile()
+{
+  std::string text = MakeFile();
+  vtkSmartPointer<vtkPolyData> serial = Read(text, 0);
+  vtkSmartPointer<vtkPolyData> threaded = Read(text, 1);
+  if (serial->GetNumberOfPoints() == 0 ||
+      !vtkTestDataSetUtilities::SameDataSets(serial, threaded))
+  {
+    cerr << "The threaded parsing of the large file differs" << endl;
+    return false;
+  }
+  vtkIntArray *ints =
+    vtkArrayDownCast<vtkIntArray>(serial->GetPointData()->GetArray("ints"));
+  if (ints->GetValue(100) != 100 * 7919 - 1000000)
+  {
+    cerr << "Wrong integer value" << endl;
+    return false;
+  }
+  return true;
+}
+}
+
+int TestLegacyASCIIReaderSMP(int, char *[])
+{
+  if (!CheckTricky(0) || !CheckTricky(1) || !CheckLongTokens(0) ||
+      !CheckLongTokens(1) || !CheckLargeFile())
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
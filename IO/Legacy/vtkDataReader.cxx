@@ -43,6 +43,7 @@
 #include "vtkPointData.h"
 #include "vtkPointSet.h"
 #include "vtkRectilinearGrid.h"
+#include "vtkSMPTools.h"
 #include "vtkShortArray.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkStringArray.h"
@@ -58,8 +59,13 @@
 
 #include "vtkTypeUInt64Array.h"
 
+#include <algorithm>
 #include <cctype>
+#include <limits>
+#include <locale>
+#include <memory>
 #include <sys/stat.h>
+#include <vector>
 
 // I need a safe way to read a line of arbitrary length.  It exists on
 // some platforms but not others so I'm afraid I have to write it
@@ -127,6 +133,7 @@ vtkDataReader::vtkDataReader()
   this->ReadAllColorScalars = 0;
   this->ReadAllTCoords = 0;
   this->ReadAllFields = 0;
+  this->EnableSMP = 0;
   this->FileMajorVersion = 0;
   this->FileMinorVersion = 0;
 
@@ -1413,23 +1420,445 @@ int vtkReadBinaryData(istream *IS, T *data, int numTuples, int numComp)
   return 1;
 }
 
-// General templated function to read data of various types.
+//----------------------------------------------------------------------------
+// Fast, locale-independent parsing of ascii values.  Each value is a token
+// delimited by white space.  The common tokens are converted exactly by
+// hand; the others (very long mantissas, large exponents, nan, ...) are
+// given to operator>> in the classic locale so that the result is the
+// same as with Read().
+namespace
+{
+inline bool vtkIsASCIISpace(char c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' ||
+    c == '\v' || c == '\f';
+}
+
+// The values are parsed as int for the char types, as in Read().
+template <class T> struct vtkASCIIValueType { typedef T Type; };
+template <> struct vtkASCIIValueType<char> { typedef int Type; };
+template <> struct vtkASCIIValueType<signed char> { typedef int Type; };
+template <> struct vtkASCIIValueType<unsigned char> { typedef int Type; };
+
 template <class T>
-int vtkReadASCIIData(vtkDataReader *self, T *data, int numTuples, int numComp)
+bool vtkParseASCIIValue(const char *p, const char *end, T &value)
 {
-  int i, j;
+  bool negative = (*p == '-');
+  if (*p == '-' || *p == '+')
+  {
+    ++p;
+  }
+  if (p == end)
+  {
+    return false;
+  }
+  vtkTypeUInt64 v = 0;
+  for (; p != end; ++p)
+  {
+    unsigned int digit = static_cast<unsigned int>(*p - '0');
+    if (digit > 9 || v > (VTK_TYPE_UINT64_MAX - digit) / 10)
+    {
+      return false;
+    }
+    v = 10 * v + digit;
+  }
+  vtkTypeUInt64 max = static_cast<vtkTypeUInt64>(std::numeric_limits<T>::max());
+  if (!negative)
+  {
+    if (v > max)
+    {
+      return false;
+    }
+    value = static_cast<T>(v);
+  }
+  else
+  {
+    // Leave the wrap around of negative unsigned values to operator>>.
+    if (!std::numeric_limits<T>::is_signed || v > max + 1)
+    {
+      return false;
+    }
+    value = v == 0 ? 0 : static_cast<T>(-static_cast<vtkTypeInt64>(v - 1) - 1);
+  }
+  return true;
+}
 
-  for (i=0; i<numTuples; i++)
+// Decompose a decimal number into mantissa * 10^exponent.  Returns false
+// if the mantissa has more than 19 significant digits.
+bool vtkParseASCIIDecimal(const char *p, const char *end, bool &negative,
+                          vtkTypeUInt64 &mantissa, int &exponent)
+{
+  negative = (*p == '-');
+  if (*p == '-' || *p == '+')
+  {
+    ++p;
+  }
+  mantissa = 0;
+  exponent = 0;
+  int numDigits = 0;
+  bool anyDigit = false;
+  bool fraction = false;
+  for (; p != end; ++p)
   {
-    for (j=0; j<numComp; j++)
+    if (*p == '.' && !fraction)
+    {
+      fraction = true;
+      continue;
+    }
+    unsigned int digit = static_cast<unsigned int>(*p - '0');
+    if (digit > 9)
+    {
+      break;
+    }
+    anyDigit = true;
+    if (numDigits < 19)
+    {
+      if (mantissa != 0 || digit != 0)
+      {
+        mantissa = 10 * mantissa + digit;
+        ++numDigits;
+      }
+      exponent -= fraction ? 1 : 0;
+    }
+    else if (digit != 0)
+    {
+      return false;
+    }
+    else if (!fraction)
+    {
+      ++exponent;
+    }
+  }
+  if (!anyDigit)
+  {
+    return false;
+  }
+  if (p != end)
+  {
+    if (*p != 'e' && *p != 'E')
+    {
+      return false;
+    }
+    ++p;
+    bool negativeExponent = (p != end && *p == '-');
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+      ++p;
+    }
+    if (p == end)
+    {
+      return false;
+    }
+    int e = 0;
+    for (; p != end; ++p)
+    {
+      unsigned int digit = static_cast<unsigned int>(*p - '0');
+      if (digit > 9 || e > 10000)
+      {
+        return false;
+      }
+      e = 10 * e + static_cast<int>(digit);
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+  return true;
+}
+
+// Both the mantissa and the power of ten are exact, so a single
+// multiplication or division rounds correctly, as strtod does.
+bool vtkParseASCIIValue(const char *p, const char *end, double &value)
+{
+  static const double powers[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  bool negative;
+  vtkTypeUInt64 mantissa;
+  int exponent;
+  if (!vtkParseASCIIDecimal(p, end, negative, mantissa, exponent) ||
+      mantissa > (static_cast<vtkTypeUInt64>(1) << 53) ||
+      exponent < -22 || exponent > 22)
+  {
+    return false;
+  }
+  value = static_cast<double>(mantissa);
+  value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+  value = negative ? -value : value;
+  return true;
+}
+
+bool vtkParseASCIIValue(const char *p, const char *end, float &value)
+{
+  static const float powers[11] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+  bool negative;
+  vtkTypeUInt64 mantissa;
+  int exponent;
+  if (!vtkParseASCIIDecimal(p, end, negative, mantissa, exponent) ||
+      mantissa > (static_cast<vtkTypeUInt64>(1) << 24) ||
+      exponent < -10 || exponent > 10)
+  {
+    return false;
+  }
+  value = static_cast<float>(mantissa);
+  value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+  value = negative ? -value : value;
+  return true;
+}
+
+template <class T>
+bool vtkParseASCIIToken(const char *p, const char *end, T &value)
+{
+  typedef typename vtkASCIIValueType<T>::Type ValueType;
+  ValueType v;
+  if (!vtkParseASCIIValue(p, end, v))
+  {
+    std::istringstream is(std::string(p, end));
+    is.imbue(std::locale::classic());
+    is >> v;
+    if (is.fail() || is.get() != std::char_traits<char>::eof())
+    {
+      return false;
+    }
+  }
+  value = static_cast<T>(v);
+  return true;
+}
+
+// Parse the tokens of a buffer split in pieces that start with white
+// space, so that no token crosses two pieces.  The tokens are counted
+// first, then parsed directly to their place in Data.
+template <class T>
+struct vtkParseASCIITokens
+{
+  const char *Buffer;
+  std::vector<size_t> PieceBegins;
+  std::vector<vtkIdType> PieceOffsets;
+  std::vector<size_t> PieceEnds;
+  std::vector<unsigned char> PieceFailed;
+  bool Counting;
+  T *Data;
+  vtkIdType NumberOfValues;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType piece = begin; piece < end; ++piece)
+    {
+      const char *p = this->Buffer + this->PieceBegins[piece];
+      const char *pieceEnd = this->Buffer + this->PieceBegins[piece + 1];
+      if (this->Counting)
+      {
+        vtkIdType count = 0;
+        bool inToken = false;
+        for (; p != pieceEnd; ++p)
+        {
+          bool space = vtkIsASCIISpace(*p);
+          count += (!space && !inToken) ? 1 : 0;
+          inToken = !space;
+        }
+        this->PieceOffsets[piece] = count;
+        continue;
+      }
+
+      vtkIdType id = this->PieceOffsets[piece];
+      while (id < this->NumberOfValues)
+      {
+        while (p != pieceEnd && vtkIsASCIISpace(*p))
+        {
+          ++p;
+        }
+        if (p == pieceEnd)
+        {
+          break;
+        }
+        const char *token = p;
+        while (p != pieceEnd && !vtkIsASCIISpace(*p))
+        {
+          ++p;
+        }
+        if (!vtkParseASCIIToken(token, p, this->Data[id++]))
+        {
+          this->PieceFailed[piece] = 1;
+          break;
+        }
+      }
+      this->PieceEnds[piece] = p - this->Buffer;
+    }
+  }
+};
+
+// Read n values from the stream into data.  The stream is read in
+// buffers of about 32 bytes per value, up to 1MB per piece, and is left
+// just after the last value.  The buffer is split in pieces parsed by
+// several threads only for arrays large enough to pay off.
+template <class T>
+int vtkReadASCIIValues(istream *IS, T *data, vtkIdType n, int enableSMP)
+{
+  if (n <= 0)
+  {
+    return 1;
+  }
+
+  vtkIdType const valuesPerPiece = 65536;
+  int numPieces = 1;
+  if (enableSMP && n >= 2 * valuesPerPiece)
+  {
+    vtkIdType maxPieces = n / valuesPerPiece;
+    numPieces = static_cast<int>(std::min<vtkIdType>(
+      std::max(vtkSMPTools::GetEstimatedNumberOfThreads(), 1), maxPieces));
+  }
+  size_t pieceSize = static_cast<size_t>(
+    std::min<vtkIdType>(1048576, 32 * ((n + numPieces - 1) / numPieces)));
+  size_t bufferSize = pieceSize * static_cast<size_t>(numPieces);
+  // The buffer is not initialized, only what is read is parsed.
+  std::unique_ptr<char[]> buffer(new char[bufferSize]);
+
+  vtkParseASCIITokens<T> parse;
+  parse.Buffer = buffer.get();
+  parse.PieceBegins.resize(numPieces + 1);
+  parse.PieceOffsets.resize(numPieces + 1);
+  parse.PieceEnds.resize(numPieces);
+  parse.PieceFailed.resize(numPieces);
+
+  size_t kept = 0;
+  while (n > 0)
+  {
+    // Fill the buffer after the partial token kept from the previous one.
+    IS->read(&buffer[kept], bufferSize - kept);
+    size_t length = kept + static_cast<size_t>(IS->gcount());
+    bool last = (length < bufferSize);
+
+    // Only parse up to the last white space, unless the stream ended.
+    size_t parsed = length;
+    if (!last)
+    {
+      while (parsed > 0 && !vtkIsASCIISpace(buffer[parsed - 1]))
+      {
+        --parsed;
+      }
+      if (parsed == 0)
+      {
+        // A single token fills the buffer: make room for the rest of it.
+        std::unique_ptr<char[]> larger(new char[2 * bufferSize]);
+        std::copy(buffer.get(), buffer.get() + length, larger.get());
+        buffer.swap(larger);
+        parse.Buffer = buffer.get();
+        bufferSize *= 2;
+        kept = length;
+        continue;
+      }
+    }
+
+    // Split the buffer in pieces that start with white space.
+    parse.PieceBegins[0] = 0;
+    for (int i = 1; i < numPieces; ++i)
     {
-      if ( !self->Read(data++) )
+      size_t begin = std::max(parsed / numPieces * i, parse.PieceBegins[i - 1]);
+      while (begin < parsed && !vtkIsASCIISpace(buffer[begin]))
+      {
+        ++begin;
+      }
+      parse.PieceBegins[i] = begin;
+    }
+    parse.PieceBegins[numPieces] = parsed;
+
+    // Count the tokens of each piece and parse as many as needed.
+    parse.Data = data;
+    parse.NumberOfValues = n;
+    parse.Counting = true;
+    if (numPieces > 1)
+    {
+      vtkSMPTools::For(0, numPieces, 1, parse);
+    }
+    else
+    {
+      parse(0, 1);
+    }
+    vtkIdType numTokens = 0;
+    for (int i = 0; i <= numPieces; ++i)
+    {
+      vtkIdType count = parse.PieceOffsets[i];
+      parse.PieceOffsets[i] = numTokens;
+      numTokens += (i < numPieces) ? count : 0;
+    }
+    parse.Counting = false;
+    std::fill(parse.PieceFailed.begin(), parse.PieceFailed.end(), 0);
+    if (numPieces > 1)
+    {
+      vtkSMPTools::For(0, numPieces, 1, parse);
+    }
+    else
+    {
+      parse(0, 1);
+    }
+    for (int i = 0; i < numPieces && parse.PieceOffsets[i] < n; ++i)
+    {
+      if (parse.PieceFailed[i])
       {
-        vtkGenericWarningMacro(<<"Error reading ascii data. Possible mismatch of "
-          "datasize with declaration.");
         return 0;
       }
     }
+
+    if (numTokens >= n)
+    {
+      // Put back what follows the last value.
+      int piece = numPieces - 1;
+      while (parse.PieceOffsets[piece] >= n)
+      {
+        --piece;
+      }
+      std::streamoff unread =
+        static_cast<std::streamoff>(length - parse.PieceEnds[piece]);
+      IS->clear();
+      if (unread > 0)
+      {
+        IS->seekg(-unread, ios::cur);
+      }
+      return 1;
+    }
+    if (last)
+    {
+      return 0;
+    }
+
+    // Keep the partial token at the end of the buffer.
+    data += numTokens;
+    n -= numTokens;
+    kept = length - parsed;
+    std::copy(buffer.get() + parsed, buffer.get() + length, buffer.get());
+  }
+  return 1;
+}
+}
+
+//----------------------------------------------------------------------------
+#define vtkDataReaderReadValuesMacro(type)                                  \
+  int vtkDataReader::ReadValues(type *data, vtkIdType n)                    \
+  {                                                                         \
+    return vtkReadASCIIValues(this->IS, data, n, this->EnableSMP);          \
+  }
+vtkDataReaderReadValuesMacro(char)
+vtkDataReaderReadValuesMacro(unsigned char)
+vtkDataReaderReadValuesMacro(short)
+vtkDataReaderReadValuesMacro(unsigned short)
+vtkDataReaderReadValuesMacro(int)
+vtkDataReaderReadValuesMacro(unsigned int)
+vtkDataReaderReadValuesMacro(long)
+vtkDataReaderReadValuesMacro(unsigned long)
+vtkDataReaderReadValuesMacro(long long)
+vtkDataReaderReadValuesMacro(unsigned long long)
+vtkDataReaderReadValuesMacro(float)
+vtkDataReaderReadValuesMacro(double)
+#undef vtkDataReaderReadValuesMacro
+
+// General templated function to read data of various types.
+template <class T>
+int vtkReadASCIIData(vtkDataReader *self, T *data, int numTuples, int numComp)
+{
+  if ( !self->ReadValues(data, static_cast<vtkIdType>(numTuples)*numComp) )
+  {
+    vtkGenericWarningMacro(<<"Error reading ascii data. Possible mismatch of "
+      "datasize with declaration.");
+    return 0;
   }
   return 1;
 }
@@ -1468,23 +1897,17 @@ vtkAbstractArray *vtkDataReader::ReadArray(const char *dataType, int numTuples,
       }
       else
       {
-        int b;
-        for (int i=0; i<numTuples; i++)
+        std::vector<int> bits(numTuples*numComp);
+        if ( !this->ReadValues(&bits[0], numTuples*numComp) )
         {
-          for (int j=0; j<numComp; j++)
-          {
-            if ( !this->Read(&b) )
-            {
-              vtkErrorMacro("Error reading ascii bit array! tuple: " << i << ", component: " << j);
-              free(type);
-              array->Delete();
-              return NULL;
-            }
-            else
-            {
-              ((vtkBitArray *)array)->SetValue(i*numComp+j,b);
-            }
-          }
+          vtkErrorMacro("Error reading ascii bit array!");
+          free(type);
+          array->Delete();
+          return NULL;
+        }
+        for (int i=0; i<numTuples*numComp; i++)
+        {
+          ((vtkBitArray *)array)->SetValue(i,bits[i]);
         }
       }
     }
@@ -3033,7 +3456,6 @@ int vtkDataReader::ReadLutData(vtkDataSetAttributes *a)
 int vtkDataReader::ReadCells(int size, int *data)
 {
   char line[256];
-  int i;
 
   if ( this->FileType == VTK_BINARY)
   {
@@ -3050,14 +3472,11 @@ int vtkDataReader::ReadCells(int size, int *data)
   }
   else // ascii
   {
-    for (i=0; i<size; i++)
+    if (!this->ReadValues(data, size))
     {
-      if (!this->Read(data+i))
-      {
-        vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
+      vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
+                    << (this->FileName?this->FileName:"(Null FileName)"));
+      return 0;
     }
   }
 
@@ -3071,21 +3490,22 @@ int vtkDataReader::ReadCells(int size, int *data,
                              int skip1, int read2, int skip3)
 {
   char line[256];
-  int i, numCellPts, junk, *tmp, *pTmp;
+  int i, *tmp, *pTmp;
+
+  // first read all the cells as one chunk (each cell has different length).
+  if (skip1 == 0 && skip3 == 0)
+  {
+    tmp = data;
+  }
+  else
+  {
+    tmp = new int[size];
+  }
 
   if ( this->FileType == VTK_BINARY)
   {
     // suck up newline
     this->IS->getline(line,256);
-    // first read all the cells as one chunk (each cell has different length).
-    if (skip1 == 0 && skip3 == 0)
-    {
-      tmp = data;
-    }
-    else
-    {
-      tmp = new int[size];
-    }
     this->IS->read((char *)tmp,sizeof(int)*size);
     if (this->IS->eof())
     {
@@ -3098,10 +3518,23 @@ int vtkDataReader::ReadCells(int size, int *data,
       return 0;
     }
     vtkByteSwap::Swap4BERange(tmp,size);
-    if (tmp == data)
+  }
+  else // ascii
+  {
+    if (!this->ReadValues(tmp, size))
     {
-      return 1;
+      vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
+                    << (this->FileName?this->FileName:"(Null FileName)"));
+      if (tmp != data)
+      {
+        delete [] tmp;
+      }
+      return 0;
     }
+  }
+
+  if (tmp != data)
+  {
     // skip cells before the piece
     pTmp = tmp;
     while (skip1 > 0)
@@ -3126,52 +3559,6 @@ int vtkDataReader::ReadCells(int size, int *data,
     // delete the temporary array
     delete [] tmp;
   }
-  else // ascii
-  {
-    // skip cells before the piece
-    for (i=0; i<skip1; i++)
-    {
-      if (!this->Read(&numCellPts))
-      {
-        vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
-      while (numCellPts-- > 0)
-      {
-        this->Read(&junk);
-      }
-    }
-    // read the cells in the piece
-    for (i=0; i<read2; i++)
-    {
-      if (!this->Read(data))
-      {
-        vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
-      numCellPts = *data++;
-      while (numCellPts-- > 0)
-      {
-        this->Read(data++);
-      }
-    }
-    // skip cells after the piece
-    for (i=0; i<skip3; i++)
-    {
-      if (!this->Read(&numCellPts))
-      {
-        vtkErrorMacro(<<"Error reading ascii cell data!" << " for file: "
-                      << (this->FileName?this->FileName:"(Null FileName)"));
-        return 0;
-      }
-      while (numCellPts-- > 0)
-      {
-        this->Read(&junk);
-      }
-    }
-  }
 
   float progress = this->GetProgress();
   this->UpdateProgress(progress + 0.5*(1.0 - progress));
@@ -3686,6 +4073,8 @@ void vtkDataReader::PrintSelf(ostream& os, vtkIndent indent)
   }
   os << indent << "ReadAllFields: "
      << (this->ReadAllFields ? "On" : "Off") << "\n";
+  os << indent << "EnableSMP: "
+     << (this->EnableSMP ? "On" : "Off") << "\n";
 
   os << indent << "InputStringLength: " << this->InputStringLength << endl;
 }
@@ -21,6 +21,11 @@
  * scalars, vectors, normals, etc.) from a vtk data file.  See text for
  * the format of the various vtk file types.
  *
+ * The values of ascii files are parsed in large buffers with a
+ * locale-independent parser, directly into the arrays being read.  When
+ * EnableSMP is on, each buffer is split into one piece per thread and the
+ * pieces are parsed concurrently with vtkSMPTools.
+ *
  * @sa
  * vtkPolyDataReader vtkStructuredPointsReader vtkStructuredGridReader
  * vtkUnstructuredGridReader vtkRectilinearGridReader
@@ -300,6 +305,16 @@ public:
   vtkBooleanMacro(ReadAllFields,int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded parsing of ascii values (see the class
+   * documentation).  This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP,int);
+  vtkGetMacro(EnableSMP,int);
+  vtkBooleanMacro(EnableSMP,int);
+  //@}
+
   /**
    * Open a vtk data file. Returns zero if error.
    */
@@ -405,6 +420,25 @@ public:
   int Read(double *);
   //@}
 
+  //@{
+  /**
+   * Internal function to read in n ascii values.  This is much faster
+   * than n calls to Read.  Returns zero if there was an error.
+   */
+  int ReadValues(char *data, vtkIdType n);
+  int ReadValues(unsigned char *data, vtkIdType n);
+  int ReadValues(short *data, vtkIdType n);
+  int ReadValues(unsigned short *data, vtkIdType n);
+  int ReadValues(int *data, vtkIdType n);
+  int ReadValues(unsigned int *data, vtkIdType n);
+  int ReadValues(long *data, vtkIdType n);
+  int ReadValues(unsigned long *data, vtkIdType n);
+  int ReadValues(long long *data, vtkIdType n);
+  int ReadValues(unsigned long long *data, vtkIdType n);
+  int ReadValues(float *data, vtkIdType n);
+  int ReadValues(double *data, vtkIdType n);
+  //@}
+
   /**
    * Read @a n character from the stream into @a str, then reset the stream
    * position. Returns the number of characters actually read.
@@ -518,6 +552,7 @@ protected:
   int ReadAllColorScalars;
   int ReadAllTCoords;
   int ReadAllFields;
+  int EnableSMP;
   int FileMajorVersion;
   int FileMinorVersion;
 
@@ -277,14 +277,11 @@ int vtkUnstructuredGridReader::RequestData(
             }
           }
           // read types for piece
-          for (i=0; i<read2; i++)
+          if (!this->ReadValues(types, read2))
           {
-            if (!this->Read(types+i))
-            {
-              vtkErrorMacro(<<"Error reading cell types!");
-              this->CloseVTKFile ();
-              return 1;
-            }
+            vtkErrorMacro(<<"Error reading cell types!");
+            this->CloseVTKFile ();
+            return 1;
           }
           // skip types after piece
           for (i=0; i<skip3; i++)
@@ -0,0 +1,255 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestPLYBinaryReadWrite.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the bulk reading of binary PLY files reads the same data as
+// the reading of the equivalent ascii file, and that the binary writer and
+// reader round trip.
+
+#include "vtkByteSwap.h"
+#include "vtkFloatArray.h"
+#include "vtkNew.h"
+#include "vtkPLYReader.h"
+#include "vtkPLYWriter.h"
+#include "vtkPointData.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkTestUtilities.h"
+#include "vtkUnsignedCharArray.h"
+
+#include <cstdio>
+#include <string>
+
+namespace
+{
+template <class T>
+void Put(FILE *file, T value, bool bigEndian)
+{
+  if (bigEndian)
+  {
+    vtkByteSwap::SwapBE(&value);
+  }
+  else
+  {
+    vtkByteSwap::SwapLE(&value);
+  }
+  fwrite(&value, sizeof(T), 1, file);
+}
+
+// A file with the faces before the vertices, double coordinates, short
+// normals, an unused property, unsigned indices and a polygon.
+bool WriteFile(const std::string &fileName, const char *format)
+{
+  FILE *file = fopen(fileName.c_str(), "wb");
+  if (!file)
+  {
+    cerr << "Cannot open " << fileName << " for writing" << endl;
+    return false;
+  }
+  fprintf(file,
+          "ply\n"
+          "format %s 1.0\n"
+          "element face 3\n"
+          "property list uchar uint vertex_indices\n"
+          "property uchar intensity\n"
+          "element vertex 5\n"
+          "property double x\n"
+          "property double y\n"
+          "property double z\n"
+          "property float confidence\n"
+          "property short nx\n"
+          "property short ny\n"
+          "property short nz\n"
+          "property uchar red\n"
+          "property uchar green\n"
+          "property uchar blue\n"
+          "end_header\n", format);
+  const unsigned int faces[3][5] = {
+    {3, 0, 1, 2, 0}, {4, 1, 2, 3, 4}, {3, 4, 3, 0, 0}};
+  bool ascii = format[0] == 'a';
+  bool bigEndian = format[7] == 'b';
+  for (int i = 0; i < 3; ++i)
+  {
+    if (ascii)
+    {
+      fprintf(file, "%u", faces[i][0]);
+    }
+    else
+    {
+      Put(file, static_cast<unsigned char>(faces[i][0]), bigEndian);
+    }
+    for (unsigned int j = 1; j <= faces[i][0]; ++j)
+    {
+      if (ascii)
+      {
+        fprintf(file, " %u", faces[i][j]);
+      }
+      else
+      {
+        Put(file, faces[i][j], bigEndian);
+      }
+    }
+    if (ascii)
+    {
+      fprintf(file, " %d\n", 10 * i);
+    }
+    else
+    {
+      Put(file, static_cast<unsigned char>(10 * i), bigEndian);
+    }
+  }
+  for (int i = 0; i < 5; ++i)
+  {
+    double x[3] = {0.5 * i, -0.25 * i, 1.0 + i};
+    short n[3] = {static_cast<short>(i), static_cast<short>(-i), 1};
+    unsigned char rgb[3] = {static_cast<unsigned char>(50 * i), 7, 255};
+    if (ascii)
+    {
+      fprintf(file, "%g %g %g 0.5 %d %d %d %d %d %d\n", x[0], x[1], x[2],
+              n[0], n[1], n[2], rgb[0], rgb[1], rgb[2]);
+    }
+    else
+    {
+      for (int j = 0; j < 3; ++j)
+      {
+        Put(file, x[j], bigEndian);
+      }
+      Put(file, 0.5f, bigEndian);
+      for (int j = 0; j < 3; ++j)
+      {
+        Put(file, n[j], bigEndian);
+      }
+      for (int j = 0; j < 3; ++j)
+      {
+        Put(file, rgb[j], bigEndian);
+      }
+    }
+  }
+  return fclose(file) == 0;
+}
+
+bool CheckReader(const std::string &tempDir)
+{
+  std::string asciiName = tempDir + "/TestPLYBinaryReadWriteASCII.ply";
+  if (!WriteFile(asciiName, "ascii"))
+  {
+    return false;
+  }
+  vtkNew<vtkPLYReader> asciiReader;
+  asciiReader->SetFileName(asciiName.c_str());
+  asciiReader->Update();
+
+  const char *formats[2] = {"binary_little_endian", "binary_big_endian"};
+  for (int i = 0; i < 2; ++i)
+  {
+    std::string binaryName = tempDir + "/TestPLYBinaryReadWrite.ply";
+    if (!WriteFile(binaryName, formats[i]))
+    {
+      return false;
+    }
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(binaryName.c_str());
+    reader->Update();
+    if (reader->GetOutput()->GetNumberOfPolys() == 0 ||
+        !vtkTestDataSetUtilities::SameDataSets(asciiReader->GetOutput(),
+                                               reader->GetOutput()))
+    {
+      cerr << "The " << formats[i] << " file differs from the ascii one"
+           << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CheckWriter(const std::string &tempDir)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(50);
+  sphere->SetPhiResolution(50);
+  sphere->Update();
+  vtkNew<vtkPolyData> input;
+  input->ShallowCopy(sphere->GetOutput());
+
+  vtkIdType numPts = input->GetNumberOfPoints();
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetName("RGB");
+  colors->SetNumberOfComponents(3);
+  colors->SetNumberOfTuples(numPts);
+  vtkNew<vtkFloatArray> tcoords;
+  tcoords->SetName("TCoords");
+  tcoords->SetNumberOfComponents(2);
+  tcoords->SetNumberOfTuples(numPts);
+  for (vtkIdType i = 0; i < numPts; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      colors->SetTypedComponent(i, j, static_cast<unsigned char>(i + j));
+    }
+    tcoords->SetTypedComponent(i, 0, 0.001f * i);
+    tcoords->SetTypedComponent(i, 1, -0.5f * i);
+  }
+  input->GetPointData()->Initialize();
+  input->GetPointData()->AddArray(colors.Get());
+  input->GetPointData()->SetTCoords(tcoords.Get());
+
+  std::string fileName = tempDir + "/TestPLYBinaryReadWrite.ply";
+  for (int byteOrder = 0; byteOrder < 2; ++byteOrder)
+  {
+    vtkNew<vtkPLYWriter> writer;
+    writer->SetInputData(input.Get());
+    writer->SetFileName(fileName.c_str());
+    writer->SetFileTypeToBinary();
+    writer->SetDataByteOrder(byteOrder);
+    writer->SetArrayName("RGB");
+    writer->Write();
+
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    vtkPolyData *output = reader->GetOutput();
+    if (output->GetNumberOfPolys() == 0 ||
+        !vtkTestDataSetUtilities::SameDataSets(input.Get(), output))
+    {
+      cerr << "The written file differs for byte order " << byteOrder
+           << endl;
+      return false;
+    }
+  }
+  return true;
+}
+}
+
+int TestPLYBinaryReadWrite(int argc, char *argv[])
+{
+  char* temp_dir_c =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv,
+                                           "VTK_TEMP_DIR",
+                                           "Testing/Temporary");
+  std::string temp_dir = std::string(temp_dir_c);
+  delete [] temp_dir_c;
+
+  if (temp_dir.empty())
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!CheckReader(temp_dir) || !CheckWriter(temp_dir))
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -14,10 +14,12 @@
 =========================================================================*/
 #include "vtkPLYReader.h"
 
+#include "vtkByteSwap.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkPointData.h"
 #include "vtkFloatArray.h"
+#include "vtkIdTypeArray.h"
 #include "vtkInformation.h"
 #include "vtkInformationVector.h"
 #include "vtkObjectFactory.h"
@@ -25,8 +27,10 @@
 #include "vtkPolyData.h"
 #include "vtkSmartPointer.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstddef>
+#include <vector>
 
 vtkStandardNewMacro(vtkPLYReader);
 
@@ -62,6 +66,304 @@ typedef struct _plyFace {
   unsigned char nverts;   // number of vertex indices in list
   int *verts;             // vertex index list
 } plyFace;
+
+// Bulk decoding of binary elements. The properties are converted like
+// vtkPLY::get_binary_item and vtkPLY::store_item do.
+const int vtkPLYTypeSize[] = {
+  0, 1, 2, 4, 4, 1, 2, 4, 1, 4, 4, 8
+};
+
+// Where a scalar property of the file goes: every Stride values in either
+// FloatData or UCharData.
+struct vtkPLYColumn
+{
+  const char *Name;
+  float *FloatData;
+  unsigned char *UCharData;
+  int Stride;
+  int Type;
+  int Offset;
+};
+
+template <class T>
+inline T vtkPLYGetValue(const unsigned char *p, bool swap)
+{
+  T value;
+  memcpy(&value, p, sizeof(T));
+  if (swap)
+  {
+    vtkByteSwap::SwapVoidRange(&value, 1, sizeof(T));
+  }
+  return value;
+}
+
+template <class T>
+void vtkPLYStoreValue(T value, vtkIdType i, const vtkPLYColumn &column)
+{
+  if (column.FloatData)
+  {
+    column.FloatData[i * column.Stride] =
+      static_cast<float>(static_cast<double>(value));
+  }
+  else
+  {
+    column.UCharData[i * column.Stride] =
+      static_cast<unsigned char>(static_cast<unsigned int>(value));
+  }
+}
+
+void vtkPLYDecodeValue(const unsigned char *p, bool swap, vtkIdType i,
+                       const vtkPLYColumn &column)
+{
+  switch (column.Type)
+  {
+    case PLY_CHAR:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeInt8>(p, swap), i, column);
+      break;
+    case PLY_UCHAR:
+    case PLY_UINT8:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeUInt8>(p, swap), i, column);
+      break;
+    case PLY_SHORT:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeInt16>(p, swap), i, column);
+      break;
+    case PLY_USHORT:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeUInt16>(p, swap), i, column);
+      break;
+    case PLY_INT:
+    case PLY_INT32:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeInt32>(p, swap), i, column);
+      break;
+    case PLY_UINT:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeUInt32>(p, swap), i, column);
+      break;
+    case PLY_FLOAT:
+    case PLY_FLOAT32:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeFloat32>(p, swap), i, column);
+      break;
+    case PLY_DOUBLE:
+      vtkPLYStoreValue(vtkPLYGetValue<vtkTypeFloat64>(p, swap), i, column);
+      break;
+  }
+}
+
+// Whether the binary data of elem can be decoded in bulk: scalar
+// properties only for fixed size elements, and else a single
+// "vertex_indices" list of 4 byte indices with a uchar count.
+bool vtkPLYCanDecode(PlyFile *ply, PlyElement *elem, bool allowList)
+{
+  if (ply->file_type == PLY_ASCII || elem->other_offset != -1)
+  {
+    return false;
+  }
+  int numLists = 0;
+  for (int i = 0; i < elem->nprops; ++i)
+  {
+    const PlyProperty *prop = elem->props[i];
+    if (prop->external_type <= PLY_START_TYPE ||
+        prop->external_type >= PLY_END_TYPE)
+    {
+      return false;
+    }
+    if (prop->is_list)
+    {
+      if (!allowList || ++numLists > 1 ||
+          !vtkPLY::equal_strings(prop->name, "vertex_indices") ||
+          (prop->count_external != PLY_UCHAR &&
+           prop->count_external != PLY_UINT8) ||
+          vtkPLYTypeSize[prop->external_type] != 4 ||
+          prop->external_type == PLY_FLOAT ||
+          prop->external_type == PLY_FLOAT32)
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Find the columns in the properties of elem and compute their offsets in
+// the fixed size part of the records, before any list. Returns false if a
+// column is missing.
+bool vtkPLYFindColumns(PlyElement *elem, std::vector<vtkPLYColumn> &columns)
+{
+  for (size_t c = 0; c < columns.size(); ++c)
+  {
+    columns[c].Offset = -1;
+    int offset = 0;
+    for (int i = 0; i < elem->nprops; ++i)
+    {
+      const PlyProperty *prop = elem->props[i];
+      if (!prop->is_list &&
+          vtkPLY::equal_strings(prop->name, columns[c].Name))
+      {
+        columns[c].Type = prop->external_type;
+        columns[c].Offset = offset;
+        break;
+      }
+      offset += prop->is_list ? 0 : vtkPLYTypeSize[prop->external_type];
+    }
+    if (columns[c].Offset < 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool vtkPLYNeedsSwap(PlyFile *ply)
+{
+#ifdef VTK_WORDS_BIGENDIAN
+  return ply->file_type == PLY_BINARY_LE;
+#else
+  return ply->file_type == PLY_BINARY_BE;
+#endif
+}
+
+// Read num fixed size elements in blocks and decode the columns.
+bool vtkPLYReadScalarElements(PlyFile *ply, PlyElement *elem, vtkIdType num,
+                              std::vector<vtkPLYColumn> &columns)
+{
+  if (!vtkPLYFindColumns(elem, columns))
+  {
+    return false;
+  }
+  size_t recordSize = 0;
+  for (int i = 0; i < elem->nprops; ++i)
+  {
+    recordSize += vtkPLYTypeSize[elem->props[i]->external_type];
+  }
+  bool swap = vtkPLYNeedsSwap(ply);
+  const vtkIdType blockSize = 65536;
+  std::vector<unsigned char> buffer(
+    recordSize * static_cast<size_t>(std::min(num, blockSize)) + 1);
+  for (vtkIdType first = 0; first < num; first += blockSize)
+  {
+    vtkIdType count = std::min(num - first, blockSize);
+    if (fread(&buffer[0], recordSize, count, ply->fp) !=
+        static_cast<size_t>(count))
+    {
+      return false;
+    }
+    for (size_t c = 0; c < columns.size(); ++c)
+    {
+      const unsigned char *p = &buffer[0] + columns[c].Offset;
+      for (vtkIdType i = 0; i < count; ++i, p += recordSize)
+      {
+        vtkPLYDecodeValue(p, swap, first + i, columns[c]);
+      }
+    }
+  }
+  return true;
+}
+
+// Read num faces: a "vertex_indices" list, whose indices go straight into
+// the connectivity array, and scalar properties, some of which are
+// decoded into the columns. The faces are read in blocks, the bytes read
+// past the last face are given back to the file.
+bool vtkPLYReadFaces(PlyFile *ply, PlyElement *elem, vtkIdType num,
+                     std::vector<vtkPLYColumn> &columns,
+                     vtkIdTypeArray *connectivity)
+{
+  // The columns read in each property, or -1.
+  std::vector<int> propColumns(elem->nprops, -1);
+  for (size_t c = 0; c < columns.size(); ++c)
+  {
+    int index;
+    if (!vtkPLY::find_property(elem, columns[c].Name, &index) ||
+        elem->props[index]->is_list)
+    {
+      return false;
+    }
+    columns[c].Type = elem->props[index]->external_type;
+    propColumns[index] = static_cast<int>(c);
+  }
+  int listType = PLY_INT;
+  size_t maxRecordSize = 0;
+  for (int i = 0; i < elem->nprops; ++i)
+  {
+    if (elem->props[i]->is_list)
+    {
+      listType = elem->props[i]->external_type;
+      maxRecordSize += 1 + 255 * 4;
+    }
+    else
+    {
+      maxRecordSize += vtkPLYTypeSize[elem->props[i]->external_type];
+    }
+  }
+
+  bool swap = vtkPLYNeedsSwap(ply);
+  vtkIdType capacity = 4 * num;
+  vtkIdType size = 0;
+  vtkIdType *cells = connectivity->WritePointer(0, capacity);
+  std::vector<unsigned char> buffer(std::max<size_t>(1 << 20,
+                                                     2 * maxRecordSize));
+  size_t begin = 0;
+  size_t end = 0;
+  bool eof = false;
+  for (vtkIdType face = 0; face < num; ++face)
+  {
+    if (end - begin < maxRecordSize && !eof)
+    {
+      memmove(&buffer[0], &buffer[begin], end - begin);
+      end -= begin;
+      begin = 0;
+      size_t read = fread(&buffer[end], 1, buffer.size() - end, ply->fp);
+      end += read;
+      eof = end < buffer.size();
+    }
+    const unsigned char *p = &buffer[begin];
+    const unsigned char *last = &buffer[0] + end;
+    for (int i = 0; i < elem->nprops; ++i)
+    {
+      if (elem->props[i]->is_list)
+      {
+        if (p >= last)
+        {
+          return false;
+        }
+        int count = *p++;
+        if (p + 4 * count > last)
+        {
+          return false;
+        }
+        if (size + 1 + count > capacity)
+        {
+          capacity = std::max(2 * capacity, size + 1 + count);
+          cells = connectivity->WritePointer(0, capacity);
+        }
+        cells[size++] = count;
+        for (int j = 0; j < count; ++j, p += 4)
+        {
+          cells[size++] = listType == PLY_UINT ?
+            static_cast<int>(vtkPLYGetValue<vtkTypeUInt32>(p, swap)) :
+            vtkPLYGetValue<vtkTypeInt32>(p, swap);
+        }
+      }
+      else
+      {
+        int itemSize = vtkPLYTypeSize[elem->props[i]->external_type];
+        if (p + itemSize > last)
+        {
+          return false;
+        }
+        if (propColumns[i] >= 0)
+        {
+          vtkPLYDecodeValue(p, swap, face, columns[propColumns[i]]);
+        }
+        p += itemSize;
+      }
+    }
+    begin = p - &buffer[0];
+  }
+  connectivity->SetNumberOfTuples(size);
+  connectivity->Squeeze();
+
+  // Give back the bytes of the next elements.
+  return end == begin ||
+    fseek(ply->fp, -static_cast<long>(end - begin), SEEK_CUR) == 0;
+}
 }
 
 int vtkPLYReader::RequestData(
@@ -223,14 +525,16 @@ int vtkPLYReader::RequestData(
 
   // Okay, now we can grab the data
   int numPts = 0, numPolys = 0;
+  bool readError = false;
   for (int i = 0; i < nelems; i++)
   {
     //get the description of the first element */
     elemName = elist[i];
-    vtkPLY::ply_get_element_description (ply, elemName, &numElems, &nprops);
+    elem = vtkPLY::ply_get_element_description (ply, elemName,
+                                                &numElems, &nprops);
 
     // if we're on vertex elements, read them in
-    if ( elemName && !strcmp ("vertex", elemName) )
+    if ( !readError && elemName && !strcmp ("vertex", elemName) )
     {
       // Create a list of points
       numPts = numElems;
@@ -238,103 +542,201 @@ int vtkPLYReader::RequestData(
       pts->SetDataTypeToFloat();
       pts->SetNumberOfPoints(numPts);
 
-      // Setup to read the PLY elements
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[0]);
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[1]);
-      vtkPLY::ply_get_property (ply, elemName, &vertProps[2]);
-
       if ( TexCoordsPointsAvailable )
       {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[3]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[4]);
         TexCoordsPoints->SetNumberOfTuples(numPts);
       }
-
       if ( NormalPointsAvailable )
       {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[5]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[6]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[7]);
         Normals->SetNumberOfTuples(numPts);
       }
-
       if ( RGBPointsAvailable )
       {
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[8]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[9]);
-        vtkPLY::ply_get_property (ply, elemName, &vertProps[10]);
         RGBPoints->SetNumberOfTuples(numPts);
       }
 
-      plyVertex vertex;
-      for (int j=0; j < numPts; j++)
+      if ( vtkPLYCanDecode(ply, elem, false) )
+      {
+        // Decode the vertices in blocks, straight into the arrays.
+        std::vector<vtkPLYColumn> columns;
+        float *x = static_cast<float*>(pts->GetVoidPointer(0));
+        for (int k = 0; k < 3; k++)
+        {
+          vtkPLYColumn column = {vertProps[k].name, x + k, NULL, 3, 0, 0};
+          columns.push_back(column);
+        }
+        if ( TexCoordsPointsAvailable )
+        {
+          for (int k = 0; k < 2; k++)
+          {
+            vtkPLYColumn column = {vertProps[3+k].name,
+              TexCoordsPoints->GetPointer(k), NULL, 2, 0, 0};
+            columns.push_back(column);
+          }
+        }
+        if ( NormalPointsAvailable )
+        {
+          for (int k = 0; k < 3; k++)
+          {
+            vtkPLYColumn column = {vertProps[5+k].name,
+              Normals->GetPointer(k), NULL, 3, 0, 0};
+            columns.push_back(column);
+          }
+        }
+        if ( RGBPointsAvailable )
+        {
+          for (int k = 0; k < 3; k++)
+          {
+            vtkPLYColumn column = {vertProps[8+k].name,
+              NULL, RGBPoints->GetPointer(k), 3, 0, 0};
+            columns.push_back(column);
+          }
+        }
+        if ( !vtkPLYReadScalarElements(ply, elem, numPts, columns) )
+        {
+          vtkErrorMacro(<<"Could not read the vertices");
+          readError = true;
+        }
+      }
+      else
       {
-        vtkPLY::ply_get_element (ply, (void *) &vertex);
-        pts->SetPoint (j, vertex.x);
+        // Setup to read the PLY elements
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[0]);
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[1]);
+        vtkPLY::ply_get_property (ply, elemName, &vertProps[2]);
+
         if ( TexCoordsPointsAvailable )
         {
-          TexCoordsPoints->SetTuple2(j, vertex.tex[0], vertex.tex[1]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[3]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[4]);
         }
+
         if ( NormalPointsAvailable )
         {
-          Normals->SetTuple3(j, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[5]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[6]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[7]);
         }
+
         if ( RGBPointsAvailable )
         {
-          RGBPoints->SetTuple3(j, vertex.red, vertex.green, vertex.blue);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[8]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[9]);
+          vtkPLY::ply_get_property (ply, elemName, &vertProps[10]);
+        }
+
+        plyVertex vertex;
+        for (int j=0; j < numPts; j++)
+        {
+          vtkPLY::ply_get_element (ply, (void *) &vertex);
+          pts->SetPoint (j, vertex.x);
+          if ( TexCoordsPointsAvailable )
+          {
+            TexCoordsPoints->SetTuple2(j, vertex.tex[0], vertex.tex[1]);
+          }
+          if ( NormalPointsAvailable )
+          {
+            Normals->SetTuple3(j, vertex.normal[0], vertex.normal[1], vertex.normal[2]);
+          }
+          if ( RGBPointsAvailable )
+          {
+            RGBPoints->SetTuple3(j, vertex.red, vertex.green, vertex.blue);
+          }
         }
       }
       output->SetPoints(pts);
       pts->Delete();
     }//if vertex
 
-    else if ( elemName && !strcmp ("face", elemName) )
+    else if ( !readError && elemName && !strcmp ("face", elemName) )
     {
       // Create a polygonal array
       numPolys = numElems;
       vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-      polys->Allocate(polys->EstimateSize(numPolys,3),numPolys/2);
-      plyFace face;
-      vtkIdType vtkVerts[256];
-
-      // Get the face properties
-      vtkPLY::ply_get_property (ply, elemName, &faceProps[0]);
       if ( intensityAvailable )
       {
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[1]);
         intensity->SetNumberOfComponents(1);
         intensity->SetNumberOfTuples(numPolys);
       }
       if ( RGBCellsAvailable )
       {
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[2]);
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[3]);
-        vtkPLY::ply_get_property (ply, elemName, &faceProps[4]);
         RGBCells->SetNumberOfComponents(3);
         RGBCells->SetNumberOfTuples(numPolys);
       }
 
-      // grab all the face elements
-      for (int j=0; j < numPolys; j++)
+      if ( vtkPLYCanDecode(ply, elem, true) )
       {
-        //grab and element from the file
-        vtkPLY::ply_get_element (ply, (void *) &face);
-        for (int k=0; k < face.nverts; k++)
+        // Decode the faces in blocks, with their indices straight into the
+        // connectivity array.
+        std::vector<vtkPLYColumn> columns;
+        if ( intensityAvailable )
         {
-          vtkVerts[k] = face.verts[k];
+          vtkPLYColumn column = {faceProps[1].name,
+            NULL, intensity->GetPointer(0), 1, 0, 0};
+          columns.push_back(column);
         }
-        free(face.verts); // allocated in vtkPLY::ascii/binary_get_element
+        if ( RGBCellsAvailable )
+        {
+          for (int k = 0; k < 3; k++)
+          {
+            vtkPLYColumn column = {faceProps[2+k].name,
+              NULL, RGBCells->GetPointer(k), 3, 0, 0};
+            columns.push_back(column);
+          }
+        }
+        vtkSmartPointer<vtkIdTypeArray> connectivity =
+          vtkSmartPointer<vtkIdTypeArray>::New();
+        if ( vtkPLYReadFaces(ply, elem, numPolys, columns, connectivity) )
+        {
+          polys->SetCells(numPolys, connectivity);
+        }
+        else
+        {
+          vtkErrorMacro(<<"Could not read the faces");
+          readError = true;
+        }
+      }
+      else
+      {
+        polys->Allocate(polys->EstimateSize(numPolys,3),numPolys/2);
+        plyFace face;
+        vtkIdType vtkVerts[256];
 
-        polys->InsertNextCell(face.nverts,vtkVerts);
+        // Get the face properties
+        vtkPLY::ply_get_property (ply, elemName, &faceProps[0]);
         if ( intensityAvailable )
         {
-          intensity->SetValue(j,face.intensity);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[1]);
         }
         if ( RGBCellsAvailable )
         {
-          RGBCells->SetValue(3*j,face.red);
-          RGBCells->SetValue(3*j+1,face.green);
-          RGBCells->SetValue(3*j+2,face.blue);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[2]);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[3]);
+          vtkPLY::ply_get_property (ply, elemName, &faceProps[4]);
+        }
+
+        // grab all the face elements
+        for (int j=0; j < numPolys; j++)
+        {
+          //grab and element from the file
+          vtkPLY::ply_get_element (ply, (void *) &face);
+          for (int k=0; k < face.nverts; k++)
+          {
+            vtkVerts[k] = face.verts[k];
+          }
+          free(face.verts); // allocated in vtkPLY::ascii/binary_get_element
+
+          polys->InsertNextCell(face.nverts,vtkVerts);
+          if ( intensityAvailable )
+          {
+            intensity->SetValue(j,face.intensity);
+          }
+          if ( RGBCellsAvailable )
+          {
+            RGBCells->SetValue(3*j,face.red);
+            RGBCells->SetValue(3*j+1,face.green);
+            RGBCells->SetValue(3*j+2,face.blue);
+          }
         }
       }
       output->SetPolys(polys);
@@ -352,7 +754,7 @@ int vtkPLYReader::RequestData(
   // close the PLY file
   vtkPLY::ply_close (ply);
 
-  return 1;
+  return readError ? 0 : 1;
 }
 
 int vtkPLYReader::CanReadFile(const char *filename)
@@ -14,6 +14,7 @@
 =========================================================================*/
 #include "vtkPLYWriter.h"
 
+#include "vtkByteSwap.h"
 #include "vtkCellArray.h"
 #include "vtkCellData.h"
 #include "vtkFloatArray.h"
@@ -26,6 +27,8 @@
 #include "vtkStringArray.h"
 
 #include <cstddef>
+#include <cstring>
+#include <vector>
 
 vtkStandardNewMacro(vtkPLYWriter);
 
@@ -73,6 +76,56 @@ typedef struct _plyFace {
   unsigned char green;
   unsigned char blue;
 } plyFace;
+
+// Encode binary elements in a buffer written in large blocks, like
+// vtkPLY::write_binary_item does for each item.
+class vtkPLYBlockWriter
+{
+public:
+  vtkPLYBlockWriter(PlyFile *ply) : File(ply->fp), Buffer(1 << 20), Size(0)
+  {
+#ifdef VTK_WORDS_BIGENDIAN
+    this->Swap = ply->file_type == PLY_BINARY_LE;
+#else
+    this->Swap = ply->file_type == PLY_BINARY_BE;
+#endif
+  }
+
+  ~vtkPLYBlockWriter()
+  {
+    this->Flush();
+  }
+
+  template <class T>
+  void Put(T value)
+  {
+    if (this->Size + sizeof(T) > this->Buffer.size())
+    {
+      this->Flush();
+    }
+    if (this->Swap)
+    {
+      vtkByteSwap::SwapVoidRange(&value, 1, sizeof(T));
+    }
+    memcpy(&this->Buffer[this->Size], &value, sizeof(T));
+    this->Size += sizeof(T);
+  }
+
+  void Flush()
+  {
+    if (this->Size > 0)
+    {
+      fwrite(&this->Buffer[0], 1, this->Size, this->File);
+      this->Size = 0;
+    }
+  }
+
+private:
+  FILE *File;
+  std::vector<unsigned char> Buffer;
+  size_t Size;
+  bool Swap;
+};
 }
 
 void vtkPLYWriter::WriteData()
@@ -202,63 +255,120 @@ void vtkPLYWriter::WriteData()
   // complete the header
   vtkPLY::ply_header_complete (ply);
 
-  // set up and write the vertex elements
-  plyVertex vert;
-  vtkPLY::ply_put_element_setup (ply, "vertex");
-  double dpoint[3];
-  for (i = 0; i < numPts; i++)
+  if ( this->FileType == VTK_BINARY )
   {
-    inPts->GetPoint(i,dpoint);
-    vert.x[0] = static_cast<float>(dpoint[0]);
-    vert.x[1] = static_cast<float>(dpoint[1]);
-    vert.x[2] = static_cast<float>(dpoint[2]);
-    if ( pointColors )
+    // Encode the elements straight from the arrays, in the same layout as
+    // ply_put_element.
+    vtkPLYBlockWriter writer(ply);
+    double dpoint[3];
+    for (i = 0; i < numPts; i++)
     {
-      idx = 3*i;
-      vert.red = *(pointColors + idx);
-      vert.green = *(pointColors + idx + 1);
-      vert.blue = *(pointColors + idx + 2);
+      inPts->GetPoint(i,dpoint);
+      writer.Put(static_cast<float>(dpoint[0]));
+      writer.Put(static_cast<float>(dpoint[1]));
+      writer.Put(static_cast<float>(dpoint[2]));
+      if ( pointColors )
+      {
+        idx = 3*i;
+        writer.Put(pointColors[idx]);
+        writer.Put(pointColors[idx + 1]);
+        writer.Put(pointColors[idx + 2]);
+      }
+      if ( textureCoords )
+      {
+        idx = 2*i;
+        writer.Put(textureCoords[idx]);
+        writer.Put(textureCoords[idx + 1]);
+      }
     }
-    if ( textureCoords )
+
+    vtkIdType npts = 0;
+    vtkIdType *pts = 0;
+    for (polys->InitTraversal(), i = 0; i < numPolys; i++)
     {
-      idx = 2*i;
-      vert.tex[0] = *(textureCoords + idx);
-      vert.tex[1] = *(textureCoords + idx + 1);
+      polys->GetNextCell(npts,pts);
+      if ( npts > 256 )
+      {
+        vtkErrorMacro(<<"Ply file only supports polygons with <256 points");
+      }
+      else
+      {
+        unsigned char nverts = static_cast<unsigned char>(npts);
+        writer.Put(nverts);
+        for (j=0; j<nverts; j++)
+        {
+          writer.Put(static_cast<int>(pts[j]));
+        }
+        if ( cellColors )
+        {
+          idx = 3*i;
+          writer.Put(cellColors[idx]);
+          writer.Put(cellColors[idx + 1]);
+          writer.Put(cellColors[idx + 2]);
+        }
+      }
     }
-    vtkPLY::ply_put_element (ply, (void *) &vert);
   }
-
-  // set up and write the face elements
-  plyFace face;
-  int verts[256];
-  face.verts = verts;
-  vtkPLY::ply_put_element_setup (ply, "face");
-  vtkIdType npts = 0;
-  vtkIdType *pts = 0;
-  for (polys->InitTraversal(), i = 0; i < numPolys; i++)
+  else
   {
-    polys->GetNextCell(npts,pts);
-    if ( npts > 256 )
+    // set up and write the vertex elements
+    plyVertex vert;
+    vtkPLY::ply_put_element_setup (ply, "vertex");
+    double dpoint[3];
+    for (i = 0; i < numPts; i++)
     {
-      vtkErrorMacro(<<"Ply file only supports polygons with <256 points");
+      inPts->GetPoint(i,dpoint);
+      vert.x[0] = static_cast<float>(dpoint[0]);
+      vert.x[1] = static_cast<float>(dpoint[1]);
+      vert.x[2] = static_cast<float>(dpoint[2]);
+      if ( pointColors )
+      {
+        idx = 3*i;
+        vert.red = *(pointColors + idx);
+        vert.green = *(pointColors + idx + 1);
+        vert.blue = *(pointColors + idx + 2);
+      }
+      if ( textureCoords )
+      {
+        idx = 2*i;
+        vert.tex[0] = *(textureCoords + idx);
+        vert.tex[1] = *(textureCoords + idx + 1);
+      }
+      vtkPLY::ply_put_element (ply, (void *) &vert);
     }
-    else
+
+    // set up and write the face elements
+    plyFace face;
+    int verts[256];
+    face.verts = verts;
+    vtkPLY::ply_put_element_setup (ply, "face");
+    vtkIdType npts = 0;
+    vtkIdType *pts = 0;
+    for (polys->InitTraversal(), i = 0; i < numPolys; i++)
     {
-      for (j=0; j<npts; j++)
+      polys->GetNextCell(npts,pts);
+      if ( npts > 256 )
       {
-        face.nverts = npts;
-        verts[j] = (int)pts[j];
+        vtkErrorMacro(<<"Ply file only supports polygons with <256 points");
       }
-      if ( cellColors )
+      else
       {
-        idx = 3*i;
-        face.red = *(cellColors + idx);
-        face.green = *(cellColors + idx + 1);
-        face.blue = *(cellColors + idx + 2);
+        for (j=0; j<npts; j++)
+        {
+          face.nverts = npts;
+          verts[j] = (int)pts[j];
+        }
+        if ( cellColors )
+        {
+          idx = 3*i;
+          face.red = *(cellColors + idx);
+          face.green = *(cellColors + idx + 1);
+          face.blue = *(cellColors + idx + 2);
+        }
+        vtkPLY::ply_put_element (ply, (void *) &face);
       }
-      vtkPLY::ply_put_element (ply, (void *) &face);
-    }
-  }//for all polygons
+    }//for all polygons
+  }
 
   delete [] pointColors;
   delete [] cellColors;
@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestXMLReaderSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded reading of vtkXMLReader, from a memory-mapped
+// file or from the stream, reads the same data as the serial one for
+// compressed and uncompressed, raw and encoded, big and little endian data.
+
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkTestDataSetUtilities.h"
+#include "vtkTestUtilities.h"
+#include "vtkXMLPolyDataReader.h"
+#include "vtkXMLPolyDataWriter.h"
+
+#include <string>
+
+namespace
+{
+bool CheckRead(vtkPolyData *input, const std::string &fileName)
+{
+  vtkNew<vtkXMLPolyDataReader> serial;
+  vtkNew<vtkXMLPolyDataReader> threaded;
+  vtkXMLPolyDataReader *readers[2] = {serial.Get(), threaded.Get()};
+  for (int i = 0; i < 2; ++i)
+  {
+    readers[i]->SetFileName(fileName.c_str());
+    readers[i]->SetEnableSMP(i);
+    readers[i]->Update();
+  }
+  return vtkTestDataSetUtilities::SameDataSets(input, serial->GetOutput()) &&
+    vtkTestDataSetUtilities::SameDataSets(serial->GetOutput(),
+                                          threaded->GetOutput());
+}
+}
+
+int TestXMLReaderSMP(int argc, char *argv[])
+{
+  char* temp_dir_c =
+    vtkTestUtilities::GetArgOrEnvOrDefault("-T", argc, argv,
+                                           "VTK_TEMP_DIR",
+                                           "Testing/Temporary");
+  std::string temp_dir = std::string(temp_dir_c);
+  delete [] temp_dir_c;
+
+  if (temp_dir.empty())
+  {
+    cerr << "Could not determine temporary directory." << endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string fileName = temp_dir + "/TestXMLReaderSMP.vtp";
+
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(100);
+  sphere->SetPhiResolution(100);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+
+  int dataModes[3] = {vtkXMLWriter::Appended, vtkXMLWriter::Appended,
+                      vtkXMLWriter::Binary};
+  int compressorTypes[3] = {vtkXMLWriter::NONE, vtkXMLWriter::ZLIB,
+                            vtkXMLWriter::LZ4};
+  for (int mode = 0; mode < 3; ++mode)
+  {
+    for (int compressor = 0; compressor < 3; ++compressor)
+    {
+      for (int byteOrder = 0; byteOrder < 2; ++byteOrder)
+      {
+        vtkNew<vtkXMLPolyDataWriter> writer;
+        writer->SetInputData(input);
+        writer->SetFileName(fileName.c_str());
+        writer->SetDataMode(dataModes[mode]);
+        writer->SetEncodeAppendedData(mode == 1);
+        writer->SetCompressorType(compressorTypes[compressor]);
+        writer->SetByteOrder(byteOrder);
+        // Small blocks, so that every array spans several windows of blocks.
+        writer->SetBlockSize(512);
+        writer->Write();
+
+        if (!CheckRead(input, fileName))
+        {
+          cerr << "The threaded reading differs for data mode " << mode
+               << ", compressor " << compressorTypes[compressor]
+               << " and byte order " << byteOrder << endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    TestXMLWriterSMP.cxx
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// Check that the threaded compression of vtkXMLWriter writes the same file
+// as the serial one, and that the file can be read back.
+
+#include "vtkNew.h"
+#include "vtkPolyData.h"
+#include "vtkSphereSource.h"
+#include "vtkXMLPolyDataReader.h"
+#include "vtkXMLPolyDataWriter.h"
+
+#include <string>
+
+namespace
+{
+std::string Write(vtkPolyData *input, int dataMode, int compressorType,
+                  int enableSMP)
+{
+  vtkNew<vtkXMLPolyDataWriter> writer;
+  writer->SetInputData(input);
+  writer->WriteToOutputStringOn();
+  writer->SetDataMode(dataMode);
+  writer->EncodeAppendedDataOff();
+  writer->SetCompressorType(compressorType);
+  // Small blocks, so that every array spans several windows of blocks.
+  writer->SetBlockSize(512);
+  writer->SetEnableSMP(enableSMP);
+  writer->Write();
+  return writer->GetOutputString();
+}
+}
+
+int TestXMLWriterSMP(int, char *[])
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(100);
+  sphere->SetPhiResolution(100);
+  sphere->Update();
+  vtkPolyData *input = sphere->GetOutput();
+
+  int dataModes[2] = {vtkXMLWriter::Binary, vtkXMLWriter::Appended};
+  int compressorTypes[2] = {vtkXMLWriter::ZLIB, vtkXMLWriter::LZ4};
+  for (int i = 0; i < 2; i++)
+  {
+    for (int j = 0; j < 2; j++)
+    {
+      std::string serial = Write(input, dataModes[i], compressorTypes[j], 0);
+      std::string threaded = Write(input, dataModes[i], compressorTypes[j], 1);
+      if (serial.empty() || serial != threaded)
+      {
+        cerr << "The threaded compression differs for data mode "
+             << dataModes[i] << " and compressor " << compressorTypes[j]
+             << endl;
+        return EXIT_FAILURE;
+      }
+
+      vtkNew<vtkXMLPolyDataReader> reader;
+      reader->ReadFromInputStringOn();
+      reader->SetInputString(threaded);
+      reader->Update();
+      if (reader->GetOutput()->GetNumberOfPoints() !=
+          input->GetNumberOfPoints() ||
+          reader->GetOutput()->GetNumberOfCells() != input->GetNumberOfCells())
+      {
+        cerr << "Could not read back the threaded output" << endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
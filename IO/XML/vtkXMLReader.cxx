@@ -104,6 +104,7 @@ vtkXMLReader::vtkXMLReader()
   this->StringStream = 0;
   this->ReadFromInputString = 0;
   this->InputString = "";
+  this->EnableSMP = 0;
   this->XMLParser = 0;
   this->ReaderErrorObserver = 0;
   this->ParserErrorObserver = 0;
@@ -196,6 +197,7 @@ void vtkXMLReader::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfTimeSteps:" << this->NumberOfTimeSteps << "\n";
   os << indent << "TimeStepRange:(" << this->TimeStepRange[0] << ","
                                     << this->TimeStepRange[1] << ")\n";
+  os << indent << "EnableSMP: " << this->EnableSMP << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -603,6 +605,13 @@ int vtkXMLReader::RequestData(vtkInformation *vtkNotUsed(request),
   (*this->Stream).imbue(std::locale::classic());
   this->XMLParser->SetStream(this->Stream);
 
+  // Let the parser read raw appended data from a mapping of the file.
+  this->XMLParser->SetEnableSMP(this->EnableSMP);
+  if (this->EnableSMP && this->FileStream && this->Stream == this->FileStream)
+  {
+    this->XMLParser->MapFile(this->FileName);
+  }
+
   // We are just starting to read.  Do not call UpdateProgressDiscrete
   // because we want a 0 progress callback the first time.
   this->UpdateProgress(0.);
@@ -636,6 +645,7 @@ int vtkXMLReader::RequestData(vtkInformation *vtkNotUsed(request),
   this->UpdateProgressDiscrete(1);
 
   // Close the input stream to prevent resource leaks.
+  this->XMLParser->UnmapFile();
   this->CloseStream();
   if( this->TimeSteps )
   {
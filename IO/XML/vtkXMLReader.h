@@ -19,6 +19,11 @@
  * vtkXMLReader uses vtkXMLDataParser to parse a
  * <a href="http://www.vtk.org/Wiki/VTK_XML_Formats">VTK XML</a> input file.
  * Concrete subclasses then traverse the parsed file structure and extract data.
+ *
+ * When EnableSMP is on, compressed binary data are decompressed with
+ * several threads, and a file with raw appended data is memory-mapped so
+ * that its arrays are copied or decompressed directly from the mapping
+ * (see vtkXMLDataParser).
 */
 
 #ifndef vtkXMLReader_h
@@ -148,6 +153,16 @@ public:
   vtkSetVector2Macro(TimeStepRange, int);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded reading of binary data (see the class
+   * documentation).  This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
   /**
    * Returns the internal XML parser. This can be used to access
    * the XML DOM after RequestInformation() was called.
@@ -310,6 +325,9 @@ protected:
   // The input string.
   std::string InputString;
 
+  // Whether binary data are read with several threads.
+  int EnableSMP;
+
   // The array selections.
   vtkDataArraySelection* PointDataArraySelection;
   vtkDataArraySelection* CellDataArraySelection;
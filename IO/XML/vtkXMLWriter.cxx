@@ -41,6 +41,7 @@
 #include "vtkOutputStream.h"
 #include "vtkPointData.h"
 #include "vtkPoints.h"
+#include "vtkSMPTools.h"
 #include "vtkStdString.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 #include "vtkUnsignedCharArray.h"
@@ -62,6 +63,7 @@
 #include <cassert>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #if !defined(_WIN32) || defined(__CYGWIN__)
 # include <unistd.h> /* unlink */
@@ -420,6 +422,8 @@ vtkXMLWriter::vtkXMLWriter()
   this->BlockSize = 32768; //2^15
   this->Compressor = vtkZLibDataCompressor::New();
   this->CompressionHeader = 0;
+  this->EnableSMP = 0;
+  this->PendingBlocks = 0;
   this->Int32IdTypeBuffer = 0;
   this->ByteSwapBuffer = 0;
 
@@ -538,6 +542,7 @@ void vtkXMLWriter::PrintSelf(ostream& os, vtkIndent indent)
   }
   os << indent << "EncodeAppendedData: " << this->EncodeAppendedData << "\n";
   os << indent << "BlockSize: " << this->BlockSize << "\n";
+  os << indent << "EnableSMP: " << this->EnableSMP << "\n";
   if (this->Stream)
   {
     os << indent << "Stream: " << this->Stream << "\n";
@@ -1218,6 +1223,46 @@ void vtkXMLWriter::ForwardAppendedDataDouble(
   }
 }
 
+//----------------------------------------------------------------------------
+// The blocks of an array that have been converted and byte swapped, and
+// their compressed version once WritePendingBlocks() compresses them.
+struct vtkXMLWriter::CompressionWindow
+{
+  CompressionWindow(size_t size) :
+    NumberOfBlocks(0), Blocks(size), CompressedBlocks(size),
+    CompressedSizes(size) {}
+
+  size_t NumberOfBlocks;
+  std::vector<std::vector<unsigned char> > Blocks;
+  std::vector<std::vector<unsigned char> > CompressedBlocks;
+  std::vector<size_t> CompressedSizes;
+};
+
+//----------------------------------------------------------------------------
+namespace
+{
+struct vtkXMLWriterCompressBlocks
+{
+  vtkDataCompressor* Compressor;
+  std::vector<std::vector<unsigned char> >* Blocks;
+  std::vector<std::vector<unsigned char> >* CompressedBlocks;
+  std::vector<size_t>* CompressedSizes;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      std::vector<unsigned char>& block = (*this->Blocks)[i];
+      std::vector<unsigned char>& compressed = (*this->CompressedBlocks)[i];
+      size_t space = this->Compressor->GetMaximumCompressionSpace(block.size());
+      compressed.resize(space);
+      (*this->CompressedSizes)[i] = this->Compressor->Compress(
+        &block[0], block.size(), &compressed[0], space);
+    }
+  }
+};
+}
+
 //----------------------------------------------------------------------------
 int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
 {
@@ -1232,6 +1277,13 @@ int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
     {
       return 0;
     }
+    // Queue the blocks to compress them concurrently.
+    if (this->EnableSMP)
+    {
+      this->PendingBlocks = new CompressionWindow(
+        2 * static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads()));
+    }
+
     // Start writing the data.
     int result = this->DataStream->StartWriting();
 
@@ -1241,6 +1293,14 @@ int vtkXMLWriter::WriteBinaryData(vtkAbstractArray* a)
       result = 0;
     }
 
+    // Write the last queued blocks.
+    if (result && this->PendingBlocks && !this->WritePendingBlocks())
+    {
+      result = 0;
+    }
+    delete this->PendingBlocks;
+    this->PendingBlocks = 0;
+
     // Finish writing the data.
     if (result && !this->DataStream->EndWriting())
     {
@@ -1478,7 +1538,11 @@ int vtkXMLWriter::WriteBinaryDataBlock(unsigned char* in_data,
   }
 
   // Now pass the data to the next write phase.
-  if (this->Compressor)
+  if (this->PendingBlocks)
+  {
+    return this->QueueCompressionBlock(data, numWords*wordSize);
+  }
+  else if (this->Compressor)
   {
     int res = this->WriteCompressionBlock(data, numWords*wordSize);
     this->Stream->flush();
@@ -1621,6 +1685,54 @@ int vtkXMLWriter::WriteCompressionBlock(unsigned char* data, size_t size)
   return result;
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLWriter::QueueCompressionBlock(unsigned char* data, size_t size)
+{
+  // The data buffer is reused for the next block, so keep a copy.
+  CompressionWindow* window = this->PendingBlocks;
+  window->Blocks[window->NumberOfBlocks++].assign(data, data + size);
+  if (window->NumberOfBlocks < window->Blocks.size())
+  {
+    return 1;
+  }
+  return this->WritePendingBlocks();
+}
+
+//----------------------------------------------------------------------------
+int vtkXMLWriter::WritePendingBlocks()
+{
+  CompressionWindow* window = this->PendingBlocks;
+  vtkIdType numBlocks = static_cast<vtkIdType>(window->NumberOfBlocks);
+  window->NumberOfBlocks = 0;
+  if (numBlocks == 0)
+  {
+    return 1;
+  }
+
+  // Compress the blocks concurrently, one block per task.
+  vtkXMLWriterCompressBlocks compress = {this->Compressor, &window->Blocks,
+    &window->CompressedBlocks, &window->CompressedSizes};
+  vtkSMPTools::For(0, numBlocks, 1, compress);
+
+  // Write them in order and store their compressed sizes in the
+  // compression header.
+  int result = 1;
+  for (vtkIdType i = 0; i < numBlocks && result; ++i)
+  {
+    size_t outputSize = window->CompressedSizes[i];
+    result = this->DataStream->Write(&window->CompressedBlocks[i][0],
+                                     outputSize);
+    this->CompressionHeader->Set(3+this->CompressionBlockNumber++, outputSize);
+  }
+  this->Stream->flush();
+  if (this->Stream->fail())
+  {
+    this->SetErrorCode(vtkErrorCode::GetLastSystemError());
+    return 0;
+  }
+  return result;
+}
+
 //----------------------------------------------------------------------------
 int vtkXMLWriter::WriteCompressionHeader()
 {
@@ -20,6 +20,12 @@
  * functionality needed to write VTK XML file formats.  Concrete
  * subclasses provide actual writer implementations calling upon this
  * functionality.
+ *
+ * When EnableSMP is on, the blocks of compressed binary and appended data
+ * are compressed concurrently (via vtkSMPTools) instead of one at a time.
+ * At most twice as many blocks as there are threads are held in memory,
+ * and they are written in order, so the file is the same as the one
+ * written serially.
 */
 
 #ifndef vtkXMLWriter_h
@@ -180,6 +186,16 @@ public:
   vtkGetMacro(BlockSize, size_t);
   //@}
 
+  //@{
+  /**
+   * Enable/disable the threaded compression of the data blocks (see the
+   * class documentation). This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
   //@{
   /**
    * Get/Set the data mode used for the file's data.  The options are
@@ -323,6 +339,11 @@ protected:
   size_t CompressionBlockNumber;
   vtkXMLDataHeader* CompressionHeader;
   vtkTypeInt64 CompressionHeaderPosition;
+  int EnableSMP;
+
+  // The blocks waiting to be compressed concurrently, when EnableSMP is on.
+  struct CompressionWindow;
+  CompressionWindow* PendingBlocks;
 
   // The output stream used to write binary and appended data.  May
   // transparently encode the data.
@@ -458,6 +479,8 @@ protected:
   void PerformByteSwap(void* data, size_t numWords, size_t wordSize);
   int CreateCompressionHeader(size_t size);
   int WriteCompressionBlock(unsigned char* data, size_t size);
+  int QueueCompressionBlock(unsigned char* data, size_t size);
+  int WritePendingBlocks();
   int WriteCompressionHeader();
   size_t GetWordTypeSize(int dataType);
   const char* GetWordTypeName(int dataType);
@@ -19,14 +19,19 @@
 #include "vtkCommand.h"
 #include "vtkDataCompressor.h"
 #include "vtkInputStream.h"
+#include "vtkMappedFile.h"
 #include "vtkObjectFactory.h"
+#include "vtkSMPThreadLocal.h"
+#include "vtkSMPTools.h"
 #include "vtkXMLDataElement.h"
 #define vtkXMLDataHeaderPrivate_DoNotInclude
 #include "vtkXMLDataHeaderPrivate.h"
 #undef vtkXMLDataHeaderPrivate_DoNotInclude
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "vtkXMLUtilities.h"
 
@@ -58,6 +63,9 @@ vtkXMLDataParser::vtkXMLDataParser()
   this->Abort = 0;
   this->Progress = 0;
 
+  this->EnableSMP = 0;
+  this->Mapping = 0;
+
   // Default byte order to that of this machine.
 #ifdef VTK_WORDS_BIGENDIAN
   this->ByteOrder = vtkXMLDataParser::BigEndian;
@@ -85,6 +93,7 @@ vtkXMLDataParser::~vtkXMLDataParser()
   delete [] this->BlockStartOffsets;
   this->SetCompressor(0);
   if(this->AsciiDataBuffer) { this->FreeAsciiBuffer(); }
+  this->UnmapFile();
 }
 
 //----------------------------------------------------------------------------
@@ -108,6 +117,7 @@ void vtkXMLDataParser::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Progress: " << this->Progress << "\n";
   os << indent << "Abort: " << this->Abort << "\n";
   os << indent << "AttributesEncoding: " << this->AttributesEncoding << "\n";
+  os << indent << "EnableSMP: " << this->EnableSMP << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -633,6 +643,18 @@ size_t vtkXMLDataParser::ReadUncompressedData(unsigned char* data,
   }
   length = end-offset;
 
+  // Copy the data from the mapped file if there is one.
+  if(this->EnableSMP)
+  {
+    const unsigned char* mappedData =
+      this->GetMappedData(this->TellG()+offset, length);
+    if(mappedData)
+    {
+      return this->ReadUncompressedDataSMP(data, mappedData, length,
+                                           wordSize);
+    }
+  }
+
   // Read the data.
   if(!this->DataStream->Seek(headerSize+offset))
   {
@@ -713,6 +735,11 @@ size_t vtkXMLDataParser::ReadCompressedData(unsigned char* data,
     endOffset = totalSize;
   }
 
+  if(this->EnableSMP)
+  {
+    return this->ReadCompressedDataSMP(data, beginOffset, endOffset, wordSize);
+  }
+
   // Find the range of compression blocks to read.
   vtkTypeUInt64 firstBlock = beginOffset / this->BlockUncompressedSize;
   vtkTypeUInt64 lastBlock = endOffset / this->BlockUncompressedSize;
@@ -805,6 +832,222 @@ size_t vtkXMLDataParser::ReadCompressedData(unsigned char* data,
   return (endOffset - beginOffset)/wordSize;
 }
 
+//----------------------------------------------------------------------------
+// Copy and byte swap blocks of uncompressed data.
+struct vtkXMLDataParser::CopyBlocks
+{
+  vtkXMLDataParser* Parser;
+  const unsigned char* Input;
+  unsigned char* Output;
+  size_t Length;
+  size_t WordSize;
+  size_t BlockSize;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    for(vtkIdType block = begin; block < end; ++block)
+    {
+      size_t first = static_cast<size_t>(block)*this->BlockSize;
+      size_t n = std::min(this->BlockSize, this->Length-first);
+      memcpy(this->Output+first, this->Input+first, n);
+      this->Parser->PerformByteSwap(this->Output+first, n / this->WordSize,
+                                    this->WordSize);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+// Decompress and byte swap compression blocks.  The part of each block
+// that falls in [BeginOffset, EndOffset) goes to Data.  Whole blocks are
+// decompressed in place, the others through a per-thread buffer.
+struct vtkXMLDataParser::DecompressBlocks
+{
+  vtkXMLDataParser* Parser;
+  unsigned char* Data;
+  vtkTypeUInt64 BeginOffset;
+  vtkTypeUInt64 EndOffset;
+  size_t WordSize;
+
+  // The compressed bytes of the current window of blocks, which start at
+  // the offset CompressedStart of the data.
+  const unsigned char* Compressed;
+  vtkTypeInt64 CompressedStart;
+
+  // Blocks that failed to decompress, indexed from FirstBlock.
+  vtkTypeUInt64 FirstBlock;
+  std::vector<unsigned char> Failed;
+
+  vtkSMPThreadLocal<std::vector<unsigned char> > Buffers;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    vtkXMLDataParser* parser = this->Parser;
+    std::vector<unsigned char>& buffer = this->Buffers.Local();
+    for(vtkIdType i = begin; i < end; ++i)
+    {
+      vtkTypeUInt64 block = static_cast<vtkTypeUInt64>(i);
+      vtkTypeUInt64 blockBegin = block*parser->BlockUncompressedSize;
+      size_t blockSize = parser->FindBlockSize(block);
+      vtkTypeUInt64 copyBegin = std::max(blockBegin, this->BeginOffset);
+      vtkTypeUInt64 copyEnd = std::min(blockBegin+blockSize, this->EndOffset);
+      if(blockSize == 0 || copyEnd <= copyBegin)
+      {
+        this->Failed[block-this->FirstBlock] = 1;
+        continue;
+      }
+
+      unsigned char* output = this->Data + (copyBegin-this->BeginOffset);
+      bool whole = copyBegin == blockBegin && copyEnd == blockBegin+blockSize;
+      unsigned char* target = output;
+      if(!whole)
+      {
+        buffer.resize(blockSize);
+        target = &buffer[0];
+      }
+
+      const unsigned char* input = this->Compressed +
+        (parser->BlockStartOffsets[block]-this->CompressedStart);
+      if(parser->Compressor->Uncompress(input,
+                                        parser->BlockCompressedSizes[block],
+                                        target, blockSize) == 0)
+      {
+        this->Failed[block-this->FirstBlock] = 1;
+        continue;
+      }
+      if(!whole)
+      {
+        memcpy(output, target+(copyBegin-blockBegin), copyEnd-copyBegin);
+      }
+
+      // Note that the copied range is always an integer multiple of the
+      // word size.
+      parser->PerformByteSwap(output, (copyEnd-copyBegin) / this->WordSize,
+                              this->WordSize);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+const unsigned char* vtkXMLDataParser::GetMappedData(vtkTypeInt64 position,
+                                                     size_t length)
+{
+  // Only raw appended data are stored as they are in the file.
+  if(!this->Mapping || this->DataStream != this->AppendedDataStream ||
+     this->DataStream->IsA("vtkBase64InputStream") || position < 0 ||
+     static_cast<vtkTypeUInt64>(position) > this->Mapping->GetSize() ||
+     length > this->Mapping->GetSize()-static_cast<size_t>(position))
+  {
+    return 0;
+  }
+  return this->Mapping->GetData()+position;
+}
+
+//----------------------------------------------------------------------------
+size_t vtkXMLDataParser::ReadUncompressedDataSMP(
+  unsigned char* data, const unsigned char* mappedData, size_t length,
+  size_t wordSize)
+{
+  // Copy the data in 2MB blocks, which are a multiple of any word size.
+  this->UpdateProgress(0);
+  CopyBlocks copy;
+  copy.Parser = this;
+  copy.Input = mappedData;
+  copy.Output = data;
+  copy.Length = length;
+  copy.WordSize = wordSize;
+  copy.BlockSize = 2097152;
+  vtkIdType numBlocks =
+    static_cast<vtkIdType>((length+copy.BlockSize-1) / copy.BlockSize);
+  vtkSMPTools::For(0, numBlocks, 1, copy);
+  this->UpdateProgress(1);
+  return length/wordSize;
+}
+
+//----------------------------------------------------------------------------
+size_t vtkXMLDataParser::ReadCompressedDataSMP(unsigned char* data,
+                                               vtkTypeUInt64 beginOffset,
+                                               vtkTypeUInt64 endOffset,
+                                               size_t wordSize)
+{
+  // An empty range has no block, and BlockStartOffsets may have no entry
+  // for its first one.
+  if(this->BlockUncompressedSize == 0 || beginOffset >= endOffset)
+  {
+    return 0;
+  }
+
+  // Find the range of compression blocks to read.
+  vtkTypeUInt64 firstBlock = beginOffset / this->BlockUncompressedSize;
+  vtkTypeUInt64 endBlock = (endOffset+this->BlockUncompressedSize-1) /
+    this->BlockUncompressedSize;
+  size_t numBlocks = static_cast<size_t>(endBlock-firstBlock);
+
+  DecompressBlocks decompress;
+  decompress.Parser = this;
+  decompress.Data = data;
+  decompress.BeginOffset = beginOffset;
+  decompress.EndOffset = endOffset;
+  decompress.WordSize = wordSize;
+  decompress.FirstBlock = firstBlock;
+  decompress.Failed.resize(numBlocks, 0);
+
+  // The stream is at the beginning of the blocks.  If they are in the
+  // mapped file, decompress them all at once.  Otherwise read them in
+  // windows of a few blocks per thread.
+  vtkTypeInt64 compressedStart = this->BlockStartOffsets[firstBlock];
+  size_t compressedSize = static_cast<size_t>(
+    this->BlockStartOffsets[endBlock-1] +
+    this->BlockCompressedSizes[endBlock-1] - compressedStart);
+  const unsigned char* mappedData =
+    this->GetMappedData(this->TellG()+compressedStart, compressedSize);
+  size_t windowSize = mappedData ? numBlocks :
+    2*static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<unsigned char> buffer;
+
+  this->UpdateProgress(0);
+  for(vtkTypeUInt64 block = firstBlock; block < endBlock && !this->Abort;)
+  {
+    vtkTypeUInt64 windowEnd = std::min(block+windowSize, endBlock);
+    decompress.CompressedStart = this->BlockStartOffsets[block];
+    if(mappedData)
+    {
+      decompress.Compressed =
+        mappedData + (decompress.CompressedStart-compressedStart);
+    }
+    else
+    {
+      size_t size = static_cast<size_t>(
+        this->BlockStartOffsets[windowEnd-1] +
+        this->BlockCompressedSizes[windowEnd-1] - decompress.CompressedStart);
+      // Keep the buffer non-empty so that its first element exists.
+      buffer.resize(size+1);
+      if(!this->DataStream->Seek(decompress.CompressedStart) ||
+         this->DataStream->Read(&buffer[0], size) < size)
+      {
+        return 0;
+      }
+      decompress.Compressed = &buffer[0];
+    }
+
+    vtkSMPTools::For(static_cast<vtkIdType>(block),
+                     static_cast<vtkIdType>(windowEnd), 1, decompress);
+    for(; block < windowEnd; ++block)
+    {
+      if(decompress.Failed[block-firstBlock])
+      {
+        return 0;
+      }
+    }
+
+    // Report progress.
+    this->UpdateProgress(float(block-firstBlock)/numBlocks);
+  }
+  this->UpdateProgress(1);
+
+  // Return the total words actually read.
+  return (endOffset - beginOffset)/wordSize;
+}
+
 //----------------------------------------------------------------------------
 vtkXMLDataElement* vtkXMLDataParser::GetRootElement()
 {
@@ -926,6 +1169,30 @@ size_t vtkXMLDataParser::ReadAppendedData(vtkTypeInt64 offset,
   return this->ReadBinaryData(buffer, startWord, numWords, wordType);
 }
 
+//----------------------------------------------------------------------------
+int vtkXMLDataParser::MapFile(const char* fileName)
+{
+  this->UnmapFile();
+  vtkMappedFile* mapping = vtkMappedFile::New();
+  if(!mapping->Map(fileName))
+  {
+    mapping->Delete();
+    return 0;
+  }
+  this->Mapping = mapping;
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkXMLDataParser::UnmapFile()
+{
+  if(this->Mapping)
+  {
+    this->Mapping->Delete();
+    this->Mapping = 0;
+  }
+}
+
 //----------------------------------------------------------------------------
 //----------------------------------------------------------------------------
 // Define a parsing function template.  The extra "long" argument is used
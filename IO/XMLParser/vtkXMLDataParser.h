@@ -22,6 +22,14 @@
  * representation is then used by vtkXMLReader and its subclasses to
  * traverse the structure of the file and extract data.
  *
+ * When EnableSMP is on, the blocks of compressed binary data are
+ * decompressed concurrently with vtkSMPTools, directly into the buffer
+ * given to ReadInlineData or ReadAppendedData.  The compressed bytes are
+ * read in windows of a few blocks per thread, so the memory used does not
+ * grow with the size of the array.  If the file was also memory-mapped
+ * with MapFile, raw appended data are decompressed or copied directly from
+ * the mapping, without going through the stream.
+ *
  * @sa
  * vtkXMLDataElement
 */
@@ -35,6 +43,7 @@
 
 class vtkInputStream;
 class vtkDataCompressor;
+class vtkMappedFile;
 
 class VTKIOXMLPARSER_EXPORT vtkXMLDataParser : public vtkXMLParser
 {
@@ -161,6 +170,29 @@ public:
     return this->AppendedDataPosition;
   }
 
+  //@{
+  /**
+   * Enable/disable the threaded decompression and copy of binary data
+   * (see the class documentation).  This flag is off by default.
+   */
+  vtkSetMacro(EnableSMP, int);
+  vtkGetMacro(EnableSMP, int);
+  vtkBooleanMacro(EnableSMP, int);
+  //@}
+
+  /**
+   * Memory-map the given file, which must be the file read by the stream
+   * of this parser, so that raw appended data are read from the mapping.
+   * Returns 1 for success, 0 if the file could not be mapped, in which
+   * case the data are read from the stream as usual.
+   */
+  int MapFile(const char* fileName);
+
+  /**
+   * Release the mapping created by MapFile, if any.
+   */
+  void UnmapFile();
+
 protected:
   vtkXMLDataParser();
   ~vtkXMLDataParser() VTK_OVERRIDE;
@@ -198,6 +230,18 @@ protected:
                             size_t numWords,
                             size_t wordSize);
 
+  // Threaded versions of the above, used when EnableSMP is on.
+  struct CopyBlocks;
+  struct DecompressBlocks;
+  const unsigned char* GetMappedData(vtkTypeInt64 position, size_t length);
+  size_t ReadUncompressedDataSMP(unsigned char* data,
+                                 const unsigned char* mappedData,
+                                 size_t length, size_t wordSize);
+  size_t ReadCompressedDataSMP(unsigned char* data,
+                               vtkTypeUInt64 beginOffset,
+                               vtkTypeUInt64 endOffset,
+                               size_t wordSize);
+
   // Go to the start of the inline data
   void SeekInlineDataPosition(vtkXMLDataElement *element);
 
@@ -261,6 +305,10 @@ protected:
 
   int AttributesEncoding;
 
+  // Threading of the data reading, and the memory-mapped file.
+  int EnableSMP;
+  vtkMappedFile* Mapping;
+
 private:
   vtkXMLDataParser(const vtkXMLDataParser&) VTK_DELETE_FUNCTION;
   void operator=(const vtkXMLDataParser&) VTK_DELETE_FUNCTION;
@@ -1,4 +1,5 @@
 vtk_module(vtkTestingCore
   DEPENDS
     vtkCommonCore
+    vtkCommonDataModel
   EXCLUDE_FROM_WRAPPING)
\ No newline at end of file
@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program:   Visualization Toolkit
+  Module:    vtkTestDataSetUtilities.h
+
+  Copyright (c) Ken Martin, Will Schroeder, Bill Lorensen
+  All rights reserved.
+  See Copyright.txt or http://www.kitware.com/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/**
+ * @class   vtkTestDataSetUtilities
+ * @brief   Utility functions comparing datasets in regression tests.
+ *
+ * vtkTestDataSetUtilities compares arrays, field data and datasets value by
+ * value, e.g. to check that the threaded and serial versions of an
+ * algorithm produce the same output. The first difference found is reported
+ * on cerr.
+*/
+
+#ifndef vtkTestDataSetUtilities_h
+#define vtkTestDataSetUtilities_h
+
+#include "vtkAbstractArray.h"
+#include "vtkCellData.h"
+#include "vtkDataArray.h"
+#include "vtkDataSet.h"
+#include "vtkFieldData.h"
+#include "vtkIdList.h"
+#include "vtkNew.h"
+#include "vtkPointData.h"
+
+#include <cmath>
+
+struct vtkTestDataSetUtilities
+{
+  /**
+   * Compare the type, the size and the values of two arrays. Two NULL
+   * arrays are the same. With a nonzero tolerance, real values may differ
+   * by tolerance * (1 + |value|), and integral values (e.g. rounded from
+   * sums computed in a different order) by one.
+   */
+  static inline bool SameArrays(vtkAbstractArray *a1, vtkAbstractArray *a2,
+                                double tolerance = 0.0);
+
+  /**
+   * Compare the arrays of two field data. The arrays of fd2 are looked up
+   * by the names of the arrays of fd1, or by index for unnamed arrays.
+   */
+  static inline bool SameFieldData(vtkFieldData *fd1, vtkFieldData *fd2,
+                                   double tolerance = 0.0);
+
+  /**
+   * Compare the points, the cells (types and point ids) and the point and
+   * cell data of two datasets. The point coordinates use the same tolerance
+   * as the real arrays.
+   */
+  static inline bool SameDataSets(vtkDataSet *ds1, vtkDataSet *ds2,
+                                  double tolerance = 0.0);
+};
+
+inline
+bool vtkTestDataSetUtilities::SameArrays(vtkAbstractArray *a1,
+                                         vtkAbstractArray *a2,
+                                         double tolerance)
+{
+  if (!a1 || !a2)
+  {
+    return a1 == a2;
+  }
+  const char *name = a1->GetName() ? a1->GetName() : "(unnamed)";
+  if (a1->GetDataType() != a2->GetDataType() ||
+      a1->GetNumberOfTuples() != a2->GetNumberOfTuples() ||
+      a1->GetNumberOfComponents() != a2->GetNumberOfComponents())
+  {
+    cerr << "Array " << name << " differs in type or size" << endl;
+    return false;
+  }
+
+  vtkDataArray *d1 = vtkArrayDownCast<vtkDataArray>(a1);
+  vtkDataArray *d2 = vtkArrayDownCast<vtkDataArray>(a2);
+  if (!d1 || !d2)
+  {
+    for (vtkIdType i = 0; i < a1->GetNumberOfValues(); ++i)
+    {
+      if (a1->GetVariantValue(i) != a2->GetVariantValue(i))
+      {
+        cerr << "Array " << name << " differs at value " << i << endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool real = d1->GetDataType() == VTK_FLOAT ||
+    d1->GetDataType() == VTK_DOUBLE;
+  for (vtkIdType t = 0; t < d1->GetNumberOfTuples(); ++t)
+  {
+    for (int c = 0; c < d1->GetNumberOfComponents(); ++c)
+    {
+      double v1 = d1->GetComponent(t, c);
+      double v2 = d2->GetComponent(t, c);
+      double tol = tolerance == 0.0 ? 0.0 :
+        (real ? tolerance * (1.0 + fabs(v1)) : 1.0);
+      if (fabs(v1 - v2) > tol)
+      {
+        cerr << "Array " << name << " differs at tuple " << t << ": "
+             << v1 << " != " << v2 << endl;
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+inline
+bool vtkTestDataSetUtilities::SameFieldData(vtkFieldData *fd1,
+                                            vtkFieldData *fd2,
+                                            double tolerance)
+{
+  if (fd1->GetNumberOfArrays() != fd2->GetNumberOfArrays())
+  {
+    cerr << "Different number of arrays: " << fd1->GetNumberOfArrays()
+         << " != " << fd2->GetNumberOfArrays() << endl;
+    return false;
+  }
+  for (int i = 0; i < fd1->GetNumberOfArrays(); ++i)
+  {
+    vtkAbstractArray *a1 = fd1->GetAbstractArray(i);
+    vtkAbstractArray *a2 = a1->GetName() ?
+      fd2->GetAbstractArray(a1->GetName()) : fd2->GetAbstractArray(i);
+    if (!a2)
+    {
+      cerr << "Missing array " << (a1->GetName() ? a1->GetName() : "")
+           << endl;
+      return false;
+    }
+    if (!vtkTestDataSetUtilities::SameArrays(a1, a2, tolerance))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+inline
+bool vtkTestDataSetUtilities::SameDataSets(vtkDataSet *ds1, vtkDataSet *ds2,
+                                           double tolerance)
+{
+  if (ds1->GetNumberOfPoints() != ds2->GetNumberOfPoints() ||
+      ds1->GetNumberOfCells() != ds2->GetNumberOfCells())
+  {
+    cerr << "Expected " << ds1->GetNumberOfPoints() << " points and "
+         << ds1->GetNumberOfCells() << " cells but got "
+         << ds2->GetNumberOfPoints() << " points and "
+         << ds2->GetNumberOfCells() << " cells" << endl;
+    return false;
+  }
+  double x1[3], x2[3];
+  for (vtkIdType i = 0; i < ds1->GetNumberOfPoints(); ++i)
+  {
+    ds1->GetPoint(i, x1);
+    ds2->GetPoint(i, x2);
+    for (int j = 0; j < 3; ++j)
+    {
+      if (fabs(x1[j] - x2[j]) > tolerance * (1.0 + fabs(x1[j])))
+      {
+        cerr << "Point " << i << " differs" << endl;
+        return false;
+      }
+    }
+  }
+  vtkNew<vtkIdList> pts1;
+  vtkNew<vtkIdList> pts2;
+  for (vtkIdType i = 0; i < ds1->GetNumberOfCells(); ++i)
+  {
+    ds1->GetCellPoints(i, pts1.Get());
+    ds2->GetCellPoints(i, pts2.Get());
+    bool same = ds1->GetCellType(i) == ds2->GetCellType(i) &&
+      pts1->GetNumberOfIds() == pts2->GetNumberOfIds();
+    for (vtkIdType j = 0; same && j < pts1->GetNumberOfIds(); ++j)
+    {
+      same = pts1->GetId(j) == pts2->GetId(j);
+    }
+    if (!same)
+    {
+      cerr << "Cell " << i << " differs" << endl;
+      return false;
+    }
+  }
+  return
+    vtkTestDataSetUtilities::SameFieldData(ds1->GetPointData(),
+                                           ds2->GetPointData(), tolerance) &&
+    vtkTestDataSetUtilities::SameFieldData(ds1->GetCellData(),
+                                           ds2->GetCellData(), tolerance);
+}
+
+#endif // vtkTestDataSetUtilities_h